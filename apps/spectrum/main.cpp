@@ -7,13 +7,21 @@
 // window (border + display, 3x). Headless mode (--shot FILE) renders N frames
 // and writes a PPM — no display needed — for verification.
 //
+// All host input (keys, tape transport, reset) goes through an InputRecorder,
+// so --record can save it as a deterministic movie; --replay drives the machine
+// from one instead of the keyboard (see spectrum/input_movie.h).
+//
 // Usage:
 //   spectrum [rom.rom] [--tape file.{tap,tzx}] [--frames N] [--shot FILE]
+//            [--record FILE | --replay FILE] [--no-boot-cache] [--snapshot FILE]
 // With no path it looks for $Z80_SPEC48_ROM, then spec48.rom / ../spec48.rom.
 //
 
 #include "spectrum/spectrum_machine.h"
+#include "spectrum/boot_cache.h"
+#include "spectrum/input_movie.h"
 #include "spectrum/screen.h"
+#include "spectrum/snapshot.h"
 #include "spectrum/keyboard.h"
 #include "spectrum/beeper.h"
 #include "audio_output.h"
@@ -48,11 +56,13 @@ std::vector<uint8_t> read_file(const std::string& path) {
                                 std::istreambuf_iterator<char>());
 }
 
-// Read @p path and load it as the machine's tape (.tap/.tzx auto-detected).
-// Logs the outcome; returns true on success.
-bool load_tape_file(sm::SpectrumMachine& machine, const std::string& path) {
+// Read @p path and load it as the machine's tape (.tap/.tzx auto-detected),
+// through the recorder so a movie embeds the image. Logs the outcome; returns
+// true on success.
+bool load_tape_file(sm::SpectrumMachine& machine, sm::InputRecorder& input,
+                    const std::string& path) {
     const std::vector<uint8_t> data = read_file(path);
-    if (data.empty() || !machine.load_tape(data)) {
+    if (data.empty() || !input.tape_insert(machine, data)) {
         std::cerr << "Failed to load tape: " << path << "\n";
         return false;
     }
@@ -61,15 +71,35 @@ bool load_tape_file(sm::SpectrumMachine& machine, const std::string& path) {
     return true;
 }
 
-// Open the native file picker for a tape image. Returns the chosen path, or ""
-// if cancelled or no backend is available.
+// Load a .sna/.z80 snapshot over the running machine. Logs the outcome.
+bool load_snapshot(sm::SpectrumMachine& machine, const std::string& path) {
+    std::string why;
+    if (!sm::load_snapshot_file(machine, path, &why)) {
+        std::cerr << "Failed to load snapshot: " << path << " (" << why << ")\n";
+        return false;
+    }
+    std::cout << "Snapshot: " << path << "\n";
+    return true;
+}
+
+// Open the native file picker for a tape image or snapshot. Returns the chosen
+// path, or "" if cancelled or no backend is available.
 std::string pick_tape_file() {
-    auto sel = pfd::open_file("Open tape", ".",
+    auto sel = pfd::open_file("Open tape or snapshot", ".",
                               {"ZX Spectrum tapes (.tap .tzx)", "*.tap *.tzx",
+                               "Snapshots (.sna .z80)", "*.sna *.z80",
                                "All files", "*"}).result();
     return sel.empty() ? std::string{} : sel.front();
 }
 
+// Native save picker for a snapshot (.z80 unless .sna is typed).
+std::string pick_snapshot_save_file() {
+    std::string path = pfd::save_file("Save snapshot", "snapshot.z80",
+                                      {"Snapshots (.z80 .sna)", "*.z80 *.sna"}).result();
+    if (!path.empty() && !sm::snapshot_format_for(path)) path += ".z80";
+    return path;
+}
+
 std::vector<uint8_t> find_rom(const std::string& explicit_path) {
     std::vector<std::string> paths;
     if (!explicit_path.empty()) paths.push_back(explicit_path);
@@ -127,35 +157,52 @@ void print_usage(const char* prog) {
         "  --writable-rom       Allow writes to ROM (0x0000-0x3FFF). Off by default\n"
         "                       (real hardware ROM is read-only).\n"
         "  --frames N           Run N frames before showing the window (or before\n"
-        "                       the screenshot in --shot mode).\n"
+        "                       the screenshot in --shot mode). Restored from the\n"
+        "                       boot snapshot cache after the first run, unless\n"
+        "                       recording or replaying.\n"
+        "  --no-boot-cache      Always run the --frames frames cold.\n"
+        "  --snapshot FILE      Start from a .sna/.z80 snapshot (48K) instead of\n"
+        "                       power-on. Not with --record/--replay.\n"
         "  --shot FILE          Headless: render to a PPM and exit (no display).\n"
+        "  --record FILE        Record all input (keys, tape, reset) as a movie,\n"
+        "                       saved on exit. Replays cycle-exactly.\n"
+        "  --replay FILE        Drive the machine from a recorded movie instead of\n"
+        "                       the keyboard; each frame's state hash is checked\n"
+        "                       and the first divergence reported. With --shot,\n"
+        "                       --frames defaults to the movie's length.\n"
         "  -h, --help           Show this help and exit.\n"
         "\n"
         "In-window keys:\n"
-        "  F3                   Open a tape file (native picker)\n"
+        "  F2                   Save a snapshot (.z80 or .sna)\n"
+        "  F3                   Open a tape or snapshot file (native picker)\n"
         "  F5                   Play the tape    F6   Stop the tape\n"
+        "  F9                   Reset (the Spectrum's reset button)\n"
         "  (keyboard)           Letters/digits/ENTER/SPACE; Shift=CAPS SHIFT,\n"
         "                       Ctrl=SYMBOL SHIFT, Backspace=DELETE.\n"
         "\n"
         "Examples:\n"
         "  " << prog << " spec48.rom\n"
         "  " << prog << " spec48.rom --tape \"Jetpac.tzx\"      # then LOAD\"\" + F5\n"
-        "  " << prog << " spec48.rom --shot boot.ppm --frames 200\n";
+        "  " << prog << " spec48.rom --shot boot.ppm --frames 200\n"
+        "  " << prog << " spec48.rom --record bug.zmv          # then attach bug.zmv\n"
+        "  " << prog << " spec48.rom --replay bug.zmv --shot end.ppm\n"
+        "  " << prog << " spec48.rom --snapshot manic.z80\n";
 }
 
 // Translate the host keyboard's current state into the Spectrum matrix. GLFW
 // key tokens for printable ASCII match uppercase ASCII (GLFW_KEY_A == 'A'), so
 // the matrix's ascii table maps straight through. Level-polled each frame — the
-// real keyboard is a level, not an edge, so this is exactly right.
-void poll_keyboard(GLFWwindow* window, sm::Ula& ula) {
+// real keyboard is a level, not an edge, so this is exactly right; the recorder
+// turns the level into key down/up events (only the changes are logged).
+void poll_keyboard(GLFWwindow* window, sm::SpectrumMachine& machine, sm::InputRecorder& input) {
     namespace kb = z80::machine::spectrum::keyboard;
-    ula.release_all_keys();
+    std::array<uint8_t, 8> rows{};   // bit set = pressed
 
-    const auto press = [&](kb::Key k) { ula.key_down(k.half_row, k.bit); };
+    const auto press = [&](kb::Key k) { rows[k.half_row] |= static_cast<uint8_t>(1u << k.bit); };
     const auto down  = [&](int glfw_key) { return glfwGetKey(window, glfw_key) == GLFW_PRESS; };
 
     for (const kb::AsciiKey& k : kb::kAsciiKeys)
-        if (down(k.c)) ula.key_down(k.half_row, k.bit);
+        if (down(k.c)) press({k.half_row, k.bit});
 
     if (down(GLFW_KEY_ENTER)) press(kb::kEnter);
     if (down(GLFW_KEY_SPACE)) press(kb::kSpace);
@@ -163,6 +210,7 @@ void poll_keyboard(GLFWwindow* window, sm::Ula& ula) {
     if (down(GLFW_KEY_LEFT_CONTROL) || down(GLFW_KEY_RIGHT_CONTROL)) press(kb::kSymbolShift);
     // Backspace = DELETE = CAPS SHIFT + 0.
     if (down(GLFW_KEY_BACKSPACE)) { press(kb::kCapsShift); press(kb::key_for_ascii('0')); }
+    input.set_keys(machine, rows);
 }
 
 } // namespace
@@ -171,9 +219,13 @@ int main(int argc, char** argv) {
     std::string rom_path;
     std::string shot_path;
     std::string tape_path;
+    std::string record_path;
+    std::string replay_path;
+    std::string snapshot_path;
     int frames = 0;
     bool turbo = false;
     bool writable_rom = false;
+    bool boot_cache = true;
 
     for (int i = 1; i < argc; ++i) {
         const std::string arg = argv[i];
@@ -181,18 +233,47 @@ int main(int argc, char** argv) {
         else if (arg == "--shot" && i + 1 < argc) shot_path = argv[++i];
         else if (arg == "--frames" && i + 1 < argc) frames = std::atoi(argv[++i]);
         else if (arg == "--tape" && i + 1 < argc) tape_path = argv[++i];
+        else if (arg == "--record" && i + 1 < argc) record_path = argv[++i];
+        else if (arg == "--replay" && i + 1 < argc) replay_path = argv[++i];
+        else if (arg == "--snapshot" && i + 1 < argc) snapshot_path = argv[++i];
         else if (arg == "--turbo") turbo = true;
         else if (arg == "--writable-rom") writable_rom = true;
+        else if (arg == "--no-boot-cache") boot_cache = false;
         else if (!arg.empty() && arg[0] != '-') rom_path = arg;
         else std::cerr << "Unknown argument: " << arg << "\n";
     }
 
+    if (!record_path.empty() && !replay_path.empty()) {
+        std::cerr << "--record and --replay are mutually exclusive.\n";
+        return 1;
+    }
+    if (!snapshot_path.empty() && (!record_path.empty() || !replay_path.empty())) {
+        std::cerr << "--snapshot can't be combined with --record/--replay (movies start at power-on).\n";
+        return 1;
+    }
+
     const std::vector<uint8_t> rom = find_rom(rom_path);
     if (rom.empty()) {
         std::cerr << "No ROM found. Pass a path or set Z80_SPEC48_ROM.\n";
         return 1;
     }
 
+    sm::InputMovie movie;
+    movie.rom_hash = sm::InputMovie::hash_rom(rom);
+    movie.flags = writable_rom ? 0 : sm::InputMovie::kRomWriteProtect;
+    if (!replay_path.empty()) {
+        std::string why;
+        if (!movie.load_file(replay_path, &why)) {
+            std::cerr << replay_path << ": " << why << "\n";
+            return 1;
+        }
+        if (movie.rom_hash != sm::InputMovie::hash_rom(rom))
+            std::cerr << "warning: movie was recorded on a different ROM; expect divergence\n";
+        writable_rom = (movie.flags & sm::InputMovie::kRomWriteProtect) == 0;
+        std::cout << "Replay: " << replay_path << " (" << movie.frames() << " frames, "
+                  << movie.events.size() << " events)\n";
+    }
+
     sm::SpectrumMachine machine;
     if (!machine.load_rom(rom)) {
         std::cerr << "Failed to load ROM (size must be <= 16 KB).\n";
@@ -201,19 +282,60 @@ int main(int argc, char** argv) {
     machine.set_rom_write_protect(!writable_rom);   // ROM is read-only by default
     if (writable_rom) std::cout << "ROM writable (writes land; --writable-rom)\n";
 
-    if (!tape_path.empty()) load_tape_file(machine, tape_path);
+    // Host input is recorded (or passed through); a replay ignores it.
+    sm::InputRecorder input(record_path.empty() ? nullptr : &movie);
+    sm::InputPlayer player(movie);
+    const bool replaying = !replay_path.empty();
+    if (!tape_path.empty() && !replaying) load_tape_file(machine, input, tape_path);
+    if (!snapshot_path.empty() && !load_snapshot(machine, snapshot_path)) return 1;
+
+    const auto save_movie = [&] {
+        if (record_path.empty()) return;
+        if (movie.save_file(record_path))
+            std::cout << "movie: wrote " << movie.frames() << " frames, " << movie.events.size()
+                      << " events to " << record_path << "\n";
+        else
+            std::cerr << "cannot write " << record_path << "\n";
+    };
+
+    // One emulated frame: from the movie when replaying (reporting the first
+    // divergence as it happens), otherwise from live input, hashed if recording.
+    const auto run_frame = [&] {
+        if (!replaying) {
+            machine.run_frame();
+            input.end_frame(machine);
+        } else if (!player.run_frame(machine)) {
+            std::cerr << "replay: state diverged from the recording at frame "
+                      << *player.diverged() << "\n";
+        } else if (player.frame() == movie.frames() && !player.diverged()) {
+            std::cout << "replay: all " << movie.frames() << " recorded frames matched\n";
+        }
+    };
+
+    // The first frames from power-on: from the boot snapshot cache when the run
+    // isn't a movie (movies start at power-on and hash every frame).
+    const auto boot = [&](int n) {
+        if (boot_cache && n > 0 && !replaying && record_path.empty() && snapshot_path.empty()) {
+            sm::BootCache().boot(machine, rom, static_cast<uint32_t>(n));
+            return;
+        }
+        for (int i = 0; i < n; ++i) run_frame();
+    };
 
     // -- Headless screenshot: no display needed ------------------------------
     if (!shot_path.empty()) {
-        const int n = frames > 0 ? frames : 200;
-        for (int i = 0; i < n; ++i) machine.run_frame();
+        const int n = frames > 0 ? frames
+                    : replaying ? static_cast<int>(movie.frames()) : 200;
+        boot(n);
         std::cout << "booted " << n << " frames; border colour = "
                   << static_cast<int>(machine.ula().border()) << "\n";
-        return write_ppm(shot_path, machine);
+        save_movie();
+        const int rc = write_ppm(shot_path, machine);
+        return player.diverged() ? 1 : rc;
     }
 
     // -- Live window ---------------------------------------------------------
-    if (frames > 0) for (int i = 0; i < frames; ++i) machine.run_frame();
+    boot(frames);
 
     glfwSetErrorCallback(glfw_error_callback);
     if (!glfwInit()) { std::cerr << "Failed to init GLFW\n"; return 1; }
@@ -266,7 +388,8 @@ int main(int argc, char** argv) {
     auto fps_mark = last;
     double accumulator = 0.0;
     int emulated = 0;
-    bool f3_prev = false, f5_prev = false, f6_prev = false;   // tape transport edge detection
+    bool f2_prev = false, f3_prev = false, f5_prev = false, f6_prev = false,
+         f9_prev = false;   // edge detection
 
     // Audio: the beeper edge timeline resampled to PCM and played via miniaudio.
     // Only fed on the real-time (non-turbo) path, where one frame == 1/50 s of
@@ -289,37 +412,61 @@ int main(int argc, char** argv) {
 
     while (!glfwWindowShouldClose(window)) {
         glfwPollEvents();
-        poll_keyboard(window, machine.ula());
-
-        // Tape transport: F3 = open a tape (native picker), F5 = play, F6 = stop
-        // (on key-down edge).
+        // F2 = save a snapshot; tape transport: F3 = open a tape or snapshot
+        // (native picker), F5 = play, F6 = stop; F9 = reset (on key-down edge).
+        // A replay takes none of this from the host.
+        const bool f2 = glfwGetKey(window, GLFW_KEY_F2) == GLFW_PRESS;
         const bool f3 = glfwGetKey(window, GLFW_KEY_F3) == GLFW_PRESS;
         const bool f5 = glfwGetKey(window, GLFW_KEY_F5) == GLFW_PRESS;
         const bool f6 = glfwGetKey(window, GLFW_KEY_F6) == GLFW_PRESS;
-        if (f3 && !f3_prev) {
-            const std::string path = pick_tape_file();   // modal; pauses the game
-            if (!path.empty()) load_tape_file(machine, path);
-            last = clock::now();                          // don't catch up the dialog's wall-time
+        const bool f9 = glfwGetKey(window, GLFW_KEY_F9) == GLFW_PRESS;
+        if (!replaying) {
+            poll_keyboard(window, machine, input);
+            if (f2 && !f2_prev) {
+                const std::string path = pick_snapshot_save_file();
+                std::string why;
+                if (!path.empty() && sm::save_snapshot_file(machine, path, &why))
+                    std::cout << "snapshot: saved " << path << "\n";
+                else if (!path.empty())
+                    std::cerr << "snapshot: " << path << ": " << why << "\n";
+                last = clock::now();
+            }
+            if (f3 && !f3_prev) {
+                const std::string path = pick_tape_file();   // modal; pauses the game
+                if (path.empty()) {
+                    // cancelled
+                } else if (!sm::snapshot_format_for(path)) {
+                    load_tape_file(machine, input, path);
+                } else if (!record_path.empty()) {
+                    std::cerr << "snapshot: can't load one while recording a movie\n";
+                } else {
+                    load_snapshot(machine, path);
+                }
+                last = clock::now();                          // don't catch up the dialog's wall-time
+            }
+            if (f5 && !f5_prev) { input.tape_play(machine); std::cout << "tape: play\n"; }
+            if (f6 && !f6_prev) { input.tape_stop(machine); std::cout << "tape: stop\n"; }
+            if (f9 && !f9_prev) { input.reset(machine); std::cout << "reset\n"; }
         }
-        if (f5 && !f5_prev) { machine.play_tape(); std::cout << "tape: play\n"; }
-        if (f6 && !f6_prev) { machine.stop_tape(); std::cout << "tape: stop\n"; }
+        f2_prev = f2;
         f3_prev = f3;
         f5_prev = f5;
         f6_prev = f6;
+        f9_prev = f9;
 
         const auto now = clock::now();
         const double dt = std::chrono::duration<double>(now - last).count();
         last = now;
 
         if (turbo) {
-            machine.run_frame();
+            run_frame();
             ++emulated;
         } else {
             accumulator += dt;
             if (accumulator > 0.25) accumulator = 0.25;        // don't spiral after a stall
             int ran = 0;
             while (accumulator >= frame_period && ran < 4) {    // real-time, capped catch-up
-                machine.run_frame();
+                run_frame();
                 pump_audio();                                    // drain this frame's beeper edges
                 accumulator -= frame_period;
                 ++ran;
@@ -363,6 +510,7 @@ int main(int argc, char** argv) {
         }
     }
 
+    save_movie();
     glDeleteTextures(1, &texture);
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
@@ -0,0 +1,241 @@
+//
+// Z80 Digital Twin - C API (libz80twin)
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// The register block is the machine's state between calls: each entry point
+// that touches the CPU loads it into the CPU first and stores it back last.
+// That is two dozen moves per call — nothing next to the thousands of
+// instructions a call is meant to run — and it is what lets the host read
+// and write registers in place without a getter per register.
+//
+
+#include "z80twin.h"
+
+#include "z80_cpu.h"
+#include "fnv.h"
+#include "io/port_table_io.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+using TwinCpu = z80::CPUImpl<z80::FastMemory, z80::PortTableIo>;
+
+struct z80twin {
+    TwinCpu cpu;
+    z80twin_regs regs{};
+    std::array<uint64_t, 1024> pc_traps{};   ///< One bit per address
+    std::size_t pc_trap_count = 0;           ///< 0: run on the fused bulk path
+};
+
+static_assert(std::is_standard_layout_v<z80twin_regs>);
+static_assert(offsetof(z80twin_regs, iff1) == 28 && offsetof(z80twin_regs, tstates) == 40 &&
+                  sizeof(z80twin_regs) == 48,
+              "z80twin_regs is part of the ABI");
+static_assert(Z80TWIN_MEMORY_SIZE == z80::FastMemory::SIZE);
+
+namespace {
+
+constexpr uint8_t kMagic[] = {'Z', '8', '0', 'T', 'W', 'N'};
+constexpr std::size_t kHeaderBytes = 8;
+constexpr std::size_t kRegisterBytes = 14 * 2 + 5 + 8;
+
+void load(z80twin& m) {
+    TwinCpu& cpu = m.cpu;
+    const z80twin_regs& r = m.regs;
+    cpu.AF() = r.af;
+    cpu.BC() = r.bc;
+    cpu.DE() = r.de;
+    cpu.HL() = r.hl;
+    cpu.AltAF() = r.af_alt;
+    cpu.AltBC() = r.bc_alt;
+    cpu.AltDE() = r.de_alt;
+    cpu.AltHL() = r.hl_alt;
+    cpu.IX() = r.ix;
+    cpu.IY() = r.iy;
+    cpu.SP() = r.sp;
+    cpu.PC() = r.pc;
+    cpu.IR() = r.ir;
+    cpu.WZ() = r.wz;
+    cpu.IFF1() = r.iff1 != 0;
+    cpu.IFF2() = r.iff2 != 0;
+    cpu.SetInterruptMode(r.im);
+    cpu.SetHalted(r.halted != 0);
+    cpu.SetInterruptShadow(r.ei_shadow != 0);
+    cpu.SetCycleCount(r.tstates);
+}
+
+void store(z80twin& m) {
+    TwinCpu& cpu = m.cpu;
+    z80twin_regs& r = m.regs;
+    r.af = cpu.AF();
+    r.bc = cpu.BC();
+    r.de = cpu.DE();
+    r.hl = cpu.HL();
+    r.af_alt = cpu.AltAF();
+    r.bc_alt = cpu.AltBC();
+    r.de_alt = cpu.AltDE();
+    r.hl_alt = cpu.AltHL();
+    r.ix = cpu.IX();
+    r.iy = cpu.IY();
+    r.sp = cpu.SP();
+    r.pc = cpu.PC();
+    r.ir = cpu.IR();
+    r.wz = cpu.WZ();
+    r.iff1 = cpu.IFF1();
+    r.iff2 = cpu.IFF2();
+    r.im = cpu.InterruptMode();
+    r.halted = cpu.IsHalted();
+    r.ei_shadow = cpu.InterruptShadow();
+    r.tstates = cpu.GetCycleCount();
+}
+
+/// run_until() on a loaded CPU; the caller stores.
+z80twin_stop run(z80twin& m, uint64_t target, z80twin_trap_fn trap, void* context) {
+    TwinCpu& cpu = m.cpu;
+    while (cpu.GetCycleCount() < target) {
+        bool at_pc = false;
+        if (!cpu.IsHalted()) {
+            if (m.pc_trap_count == 0) cpu.RunUntilCycle(target);
+            else at_pc = cpu.RunUntilCycleOrPc(target, m.pc_traps.data());
+            // RunUntilCycle() can stop between a prefix and its opcode; the
+            // register block has no room for that, so finish the instruction.
+            while (!cpu.InstructionComplete()) cpu.Step();
+        }
+        if (!at_pc && !cpu.IsHalted()) continue;
+        if (!trap) return at_pc ? Z80TWIN_STOP_PC : Z80TWIN_STOP_HALT;
+        store(m);
+        const int next = trap(context, &m);
+        load(m);
+        if (next != Z80TWIN_TRAP_RESUME) return Z80TWIN_STOP_TRAP;
+        if (!at_pc) cpu.SetHalted(false);
+    }
+    return Z80TWIN_STOP_BUDGET;
+}
+
+} // namespace
+
+extern "C" {
+
+uint32_t z80twin_abi_version(void) { return Z80TWIN_ABI_VERSION; }
+
+z80twin* z80twin_create(void) {
+    z80twin* m = new (std::nothrow) z80twin;
+    if (m) store(*m);
+    return m;
+}
+
+void z80twin_destroy(z80twin* machine) { delete machine; }
+
+void z80twin_reset(z80twin* machine) {
+    machine->cpu.Reset();
+    store(*machine);
+}
+
+uint8_t* z80twin_memory(z80twin* machine) { return machine->cpu.GetMemory().Data(); }
+
+z80twin_regs* z80twin_registers(z80twin* machine) { return &machine->regs; }
+
+void z80twin_map_ports(z80twin* machine, uint8_t first, uint8_t last, const z80twin_port_handler* handler) {
+    z80::PortTableIo& io = machine->cpu.GetIo();
+    if (handler)
+        io.Map(first, last, {handler->in, handler->out, handler->context});
+    else
+        io.Unmap(first, last);
+}
+
+void z80twin_set_pc_trap(z80twin* machine, uint16_t address, int on) {
+    uint64_t& word = machine->pc_traps[address >> 6];
+    const uint64_t bit = uint64_t{1} << (address & 63);
+    if (((word & bit) != 0) == (on != 0)) return;
+    word ^= bit;
+    if (on) ++machine->pc_trap_count;
+    else --machine->pc_trap_count;
+}
+
+void z80twin_clear_pc_traps(z80twin* machine) {
+    machine->pc_traps.fill(0);
+    machine->pc_trap_count = 0;
+}
+
+z80twin_stop z80twin_run_cycles(z80twin* machine, uint64_t tstates) {
+    load(*machine);
+    const z80twin_stop stop = run(*machine, machine->cpu.GetCycleCount() + tstates, nullptr, nullptr);
+    store(*machine);
+    return stop;
+}
+
+z80twin_stop z80twin_run_until(z80twin* machine, uint64_t target_tstate, z80twin_trap_fn trap, void* context) {
+    load(*machine);
+    const z80twin_stop stop = run(*machine, target_tstate, trap, context);
+    store(*machine);
+    return stop;
+}
+
+int z80twin_interrupt(z80twin* machine, uint8_t bus) {
+    load(*machine);
+    const bool accepted = machine->cpu.Interrupt(bus);
+    store(*machine);
+    return accepted ? 1 : 0;
+}
+
+size_t z80twin_state_size(void) { return Z80TWIN_STATE_SIZE; }
+
+size_t z80twin_save_state(z80twin* machine, void* buffer, size_t size) {
+    if (!buffer || size < Z80TWIN_STATE_SIZE) return 0;
+    uint8_t* out = static_cast<uint8_t*>(buffer);
+    std::size_t pos = 0;
+    const auto put = [out, &pos](uint64_t v, int n) {
+        for (int k = 0; k < n; ++k) out[pos++] = static_cast<uint8_t>(v >> (8 * k));
+    };
+    const z80twin_regs& r = machine->regs;
+    std::memcpy(out, kMagic, sizeof kMagic);
+    pos = sizeof kMagic;
+    put(Z80TWIN_STATE_VERSION, 1);
+    put(0, 1);
+    for (uint16_t v : {r.af, r.bc, r.de, r.hl, r.af_alt, r.bc_alt, r.de_alt, r.hl_alt, r.ix, r.iy, r.sp, r.pc,
+                       r.ir, r.wz})
+        put(v, 2);
+    for (uint8_t b : {r.iff1, r.iff2, r.im, r.halted, r.ei_shadow}) put(b, 1);
+    put(r.tstates, 8);
+    std::memcpy(out + pos, z80twin_memory(machine), Z80TWIN_MEMORY_SIZE);
+    pos += Z80TWIN_MEMORY_SIZE;
+    put(z80::fnv1a32({out, pos}), 4);
+    return pos;
+}
+
+z80twin_status z80twin_load_state(z80twin* machine, const void* buffer, size_t size) {
+    const uint8_t* in = static_cast<const uint8_t*>(buffer);
+    if (!in || size < kHeaderBytes || std::memcmp(in, kMagic, sizeof kMagic) != 0) return Z80TWIN_ERROR_FORMAT;
+    if (in[6] != Z80TWIN_STATE_VERSION) return Z80TWIN_ERROR_VERSION;
+    if (size != Z80TWIN_STATE_SIZE) return Z80TWIN_ERROR_FORMAT;
+    const std::size_t body = size - 4;
+    const uint32_t stored = static_cast<uint32_t>(in[body] | (in[body + 1] << 8) | (in[body + 2] << 16)) |
+                            (static_cast<uint32_t>(in[body + 3]) << 24);
+    if (stored != z80::fnv1a32({in, body})) return Z80TWIN_ERROR_CHECKSUM;
+
+    std::size_t pos = kHeaderBytes;
+    const auto get = [in, &pos](int n) {
+        uint64_t v = 0;
+        for (int k = 0; k < n; ++k) v |= static_cast<uint64_t>(in[pos++]) << (8 * k);
+        return v;
+    };
+    z80twin_regs r{};
+    for (uint16_t* v : {&r.af, &r.bc, &r.de, &r.hl, &r.af_alt, &r.bc_alt, &r.de_alt, &r.hl_alt, &r.ix, &r.iy,
+                        &r.sp, &r.pc, &r.ir, &r.wz})
+        *v = static_cast<uint16_t>(get(2));
+    for (uint8_t* b : {&r.iff1, &r.iff2, &r.im, &r.halted, &r.ei_shadow}) *b = static_cast<uint8_t>(get(1));
+    r.tstates = get(8);
+    if (r.im > 2) return Z80TWIN_ERROR_FORMAT;
+    static_assert(kHeaderBytes + kRegisterBytes + Z80TWIN_MEMORY_SIZE + 4 == Z80TWIN_STATE_SIZE);
+
+    machine->regs = r;
+    std::memcpy(z80twin_memory(machine), in + pos, Z80TWIN_MEMORY_SIZE);
+    return Z80TWIN_OK;
+}
+
+} // extern "C"
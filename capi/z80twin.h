@@ -0,0 +1,187 @@
+//
+// Z80 Digital Twin - C API (libz80twin)
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// A stable C ABI over one CPU configuration — z80::CPUImpl<FastMemory,
+// PortTableIo> — for runtimes that cannot instantiate the C++ templates
+// themselves. It is built for driving many machines with few calls:
+//
+//   - execution is batched: z80twin_run_cycles() and z80twin_run_until() run
+//     thousands of instructions on the bulk RunUntilCycle() path per call,
+//     and return only at an instruction boundary;
+//   - memory and registers are views, not copies: z80twin_memory() is the
+//     CPU's own 64 KB, and z80twin_registers() a register block that stays at
+//     the same address for the machine's life (see z80twin_regs);
+//   - ports are a table of C callbacks, installed once (z80twin_map_ports());
+//   - traps hand control to the host: z80twin_run_until() gives a callback
+//     each HALT (which it can service and resume, as CP/M's BDOS stubs do)
+//     and each arrival at a PC marked with z80twin_set_pc_trap(), so the host
+//     can stop on an address without patching guest code;
+//   - the whole machine saves to, and loads from, a fixed-size versioned blob.
+//
+// Machines are independent: one thread per machine needs no locking. The
+// library is compiled with hidden visibility; only the z80twin_* functions
+// are exported.
+//
+
+#ifndef Z80TWIN_H
+#define Z80TWIN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__GNUC__)
+#define Z80TWIN_API __attribute__((visibility("default")))
+#else
+#define Z80TWIN_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// The ABI this header describes; z80twin_abi_version() is the library's.
+#define Z80TWIN_ABI_VERSION 1
+
+#define Z80TWIN_MEMORY_SIZE 65536
+
+/// State blob layout (little-endian):
+///   "Z80TWN" u8 version u8 0 |
+///   u16 AF BC DE HL AF' BC' DE' HL' IX IY SP PC IR WZ |
+///   u8 IFF1 IFF2 IM halted EI-shadow | u64 T-states |
+///   65536 bytes memory | u32 FNV-1a of everything before it.
+/// The port table is the host's, and is not saved.
+#define Z80TWIN_STATE_VERSION 1
+#define Z80TWIN_STATE_SIZE (8 + 14 * 2 + 5 + 8 + Z80TWIN_MEMORY_SIZE + 4)
+
+typedef struct z80twin z80twin;
+
+/// The register block. z80twin_registers() points at the machine's copy,
+/// which is written back at the end of every call that runs or changes the
+/// CPU and read at the start of the next one — so between calls it can be
+/// read and written in place. Layout is part of the ABI.
+typedef struct z80twin_regs {
+    uint16_t af, bc, de, hl;
+    uint16_t af_alt, bc_alt, de_alt, hl_alt;
+    uint16_t ix, iy, sp, pc;
+    uint16_t ir;          ///< I in the high byte, R in the low
+    uint16_t wz;          ///< MEMPTR
+    uint8_t iff1, iff2;
+    uint8_t im;           ///< Interrupt mode, 0-2
+    uint8_t halted;
+    uint8_t ei_shadow;    ///< EI just ran: the next interrupt is refused
+    uint8_t reserved[7];
+    uint64_t tstates;     ///< T-states since reset
+} z80twin_regs;
+
+/// A port device: either function may be NULL (IN then reads 0xFF, OUT is
+/// dropped). @p port is the full 16-bit port the CPU put on the bus.
+typedef uint8_t (*z80twin_in_fn)(void* context, uint16_t port);
+typedef void (*z80twin_out_fn)(void* context, uint16_t port, uint8_t value);
+typedef struct z80twin_port_handler {
+    z80twin_in_fn in;
+    z80twin_out_fn out;
+    void* context;
+} z80twin_port_handler;
+
+/// Why a run returned.
+typedef enum z80twin_stop {
+    Z80TWIN_STOP_BUDGET = 0,   ///< Reached the T-state target
+    Z80TWIN_STOP_HALT = 1,     ///< The CPU halted and no trap handler took it
+    Z80TWIN_STOP_TRAP = 2,     ///< A trap handler returned Z80TWIN_TRAP_STOP
+    Z80TWIN_STOP_PC = 3,       ///< Reached a PC trap and no trap handler took it
+} z80twin_stop;
+
+/// What a trap handler wants next.
+enum {
+    Z80TWIN_TRAP_STOP = 0,     ///< End the run; a halted CPU stays halted
+    Z80TWIN_TRAP_RESUME = 1,   ///< Clear HALT and carry on from the registers
+};
+
+/// Called by z80twin_run_until() each time the CPU halts, and each time it
+/// reaches a PC trap, with the register block current. After a HALT `halted`
+/// is set and PC is already past the HALT; at a PC trap `halted` is clear and
+/// PC is the trapped instruction, not yet run. The handler may change
+/// registers and memory through the views (e.g. return from a stub by popping
+/// PC), but must not run the machine itself. A condition on registers or
+/// memory is a PC trap whose handler checks it and resumes when it does not
+/// hold.
+typedef int (*z80twin_trap_fn)(void* context, z80twin* machine);
+
+typedef enum z80twin_status {
+    Z80TWIN_OK = 0,
+    Z80TWIN_ERROR_FORMAT = 1,     ///< Not a state blob, or the wrong size
+    Z80TWIN_ERROR_VERSION = 2,    ///< A state version this library does not read
+    Z80TWIN_ERROR_CHECKSUM = 3,   ///< Corrupt
+} z80twin_status;
+
+/// @return Z80TWIN_ABI_VERSION as the library was built. A runtime binding
+///         by name should check it against the header it was written for.
+Z80TWIN_API uint32_t z80twin_abi_version(void);
+
+/// @return A machine with zeroed memory and the CPU reset, all ports open
+///         bus; NULL if it cannot be allocated.
+Z80TWIN_API z80twin* z80twin_create(void);
+Z80TWIN_API void z80twin_destroy(z80twin* machine);
+
+/// Reset the CPU (registers, T-states, interrupt state). Memory and the port
+/// table are kept.
+Z80TWIN_API void z80twin_reset(z80twin* machine);
+
+/// @return The machine's 64 KB, valid until z80twin_destroy(). Reads and
+///         writes are direct; do not touch it while the machine runs.
+Z80TWIN_API uint8_t* z80twin_memory(z80twin* machine);
+
+/// @return The machine's register block, valid until z80twin_destroy().
+Z80TWIN_API z80twin_regs* z80twin_registers(z80twin* machine);
+
+/// Route the ports whose low byte is in [first, last] to @p handler (copied),
+/// or back to the open bus if @p handler is NULL.
+Z80TWIN_API void z80twin_map_ports(z80twin* machine, uint8_t first, uint8_t last,
+                                   const z80twin_port_handler* handler);
+
+/// Run for @p tstates T-states. Stops early if the CPU halts or reaches a PC
+/// trap; a halted CPU does not run until an interrupt or the host clears
+/// `halted`. Returns at an instruction boundary, so it may overrun by the rest
+/// of one instruction.
+Z80TWIN_API z80twin_stop z80twin_run_cycles(z80twin* machine, uint64_t tstates);
+
+/// Run until the T-state count reaches @p target_tstate. Each HALT and PC
+/// trap goes to @p trap (see z80twin_trap_fn); with a NULL @p trap the first
+/// one stops the run. Between traps the CPU runs at bulk speed.
+Z80TWIN_API z80twin_stop z80twin_run_until(z80twin* machine, uint64_t target_tstate,
+                                           z80twin_trap_fn trap, void* context);
+
+/// Trap (@p on != 0) or stop trapping when PC reaches @p address at an
+/// instruction boundary, before the instruction there runs. A run, or a
+/// resumed trap, does not trap on the instruction it starts at, so calling
+/// again after a stop moves on. While any PC trap is set, runs check every
+/// instruction and do without superinstructions. Traps are the host's, like
+/// the port table: reset and the state blob leave them alone.
+Z80TWIN_API void z80twin_set_pc_trap(z80twin* machine, uint16_t address, int on);
+
+/// Remove every PC trap; runs go back to the fused bulk path.
+Z80TWIN_API void z80twin_clear_pc_traps(z80twin* machine);
+
+/// Request a maskable interrupt; @p bus is the byte on the data bus during
+/// acknowledge (IM 0 opcode, IM 2 vector low byte).
+/// @return 1 if accepted (IFF1 set, no EI shadow), else 0.
+Z80TWIN_API int z80twin_interrupt(z80twin* machine, uint8_t bus);
+
+/// @return Z80TWIN_STATE_SIZE.
+Z80TWIN_API size_t z80twin_state_size(void);
+
+/// Write the machine's state to @p buffer.
+/// @return The bytes written, or 0 if @p size is under z80twin_state_size().
+Z80TWIN_API size_t z80twin_save_state(z80twin* machine, void* buffer, size_t size);
+
+/// Replace the machine's state with a saved one. On error the machine is
+/// unchanged.
+Z80TWIN_API z80twin_status z80twin_load_state(z80twin* machine, const void* buffer, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // Z80TWIN_H
@@ -0,0 +1,588 @@
+//
+// Z80 Digital Twin Debugger - CodeClassifier implementation
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+
+#include "code_classifier.h"
+
+#include "debug_session.h"
+#include "disassembler.h"
+#include "symbol_table.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace z80::dbg {
+namespace {
+
+constexpr uint32_t kSpace = 0x10000;
+constexpr uint32_t kPage = 256;
+constexpr uint32_t kChunk = 1024;            // unit of re-marking and re-scanning
+constexpr uint32_t kChunks = kSpace / kChunk;
+constexpr unsigned kMaxThreads = 16;
+constexpr std::size_t kParallelSeeds = 64;   // fewer per trace round: stay on the caller
+constexpr std::size_t kParallelChunks = 8;   // fewer chunks to redo: likewise
+
+// Visit every maximal run overlapping [lo, hi) of positions s, s+step, ...
+// where member() holds for each position and joins() for each neighbour pair.
+// A unit is `unit` bytes wide; mark(s, e) receives the *whole* run [s, e) so
+// every region sees the same runs, and clips its own writes to [lo, hi).
+template <class Member, class Joins, class Mark>
+void for_each_run(uint32_t lo, uint32_t hi, uint32_t step, uint32_t unit,
+                  Member member, Joins joins, Mark mark) {
+    for (uint32_t phase = 0; phase < step; ++phase) {
+        uint32_t a = lo >= unit - 1 ? lo - (unit - 1) : 0;
+        while (a % step != phase) ++a;
+        // Back up to the start of a run already in progress at the boundary.
+        while (a >= step && member(a) && member(a - step) && joins(a - step, a)) a -= step;
+        while (a < hi && a + unit <= kSpace) {
+            if (!member(a)) { a += step; continue; }
+            const uint32_t s = a;
+            while (a + step + unit <= kSpace && member(a + step) && joins(a, a + step)) a += step;
+            const uint32_t e = a + unit;
+            a += step;
+            mark(s, e);
+        }
+    }
+}
+
+// Bytes that decode but are unlikely to be intended code when nothing has
+// executed them: reserved ED opcodes, RST 38 (0xFF fill) and runs of NOPs
+// (zeroed RAM).
+bool implausible(const Instruction& ins, const std::vector<uint8_t>& image) {
+    if (ins.bytes[0] == 0xED && ins.mnemonic == "NOP") return true;
+    if (ins.length == 1 && ins.bytes[0] == 0xFF) return true;
+    if (ins.length == 1 && ins.bytes[0] == 0x00) {
+        const uint32_t a = ins.address;
+        return a + 3 < kSpace && image[a + 1] == 0 && image[a + 2] == 0 && image[a + 3] == 0;
+    }
+    return false;
+}
+
+bool printable(uint8_t b) { return b >= 0x20 && b <= 0x7E; }
+
+} // namespace
+
+// The classifier's own threads: started on first use, reused by every pass,
+// joined with the classifier. Run() hands items [0, n) out to them and to the
+// caller until none are left, and returns when all are done.
+class CodeClassifier::WorkerPool {
+public:
+    explicit WorkerPool(unsigned workers) : workers_(workers) {}
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    ~WorkerPool() {
+        {
+            std::lock_guard lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (std::thread& t : threads_) t.join();
+    }
+
+    void Run(std::size_t items, bool parallel, const std::function<void(std::size_t)>& fn) {
+        if (!parallel || workers_ == 0 || items < 2) {
+            for (std::size_t i = 0; i < items; ++i) fn(i);
+            return;
+        }
+        if (threads_.empty())
+            for (unsigned w = 0; w < workers_; ++w) threads_.emplace_back([this] { Work(); });
+        {
+            std::lock_guard lock(mutex_);
+            job_ = &fn;
+            items_ = items;
+            next_.store(0, std::memory_order_relaxed);
+            busy_ = workers_;
+            ++generation_;
+        }
+        wake_.notify_all();
+        Drain();
+        std::unique_lock lock(mutex_);
+        done_.wait(lock, [this] { return busy_ == 0; });
+    }
+
+private:
+    void Work() {
+        uint64_t seen = 0;
+        std::unique_lock lock(mutex_);
+        for (;;) {
+            wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+            if (stop_) return;
+            seen = generation_;
+            lock.unlock();
+            Drain();
+            lock.lock();
+            if (--busy_ == 0) done_.notify_one();
+        }
+    }
+
+    void Drain() {
+        for (std::size_t i; (i = next_.fetch_add(1, std::memory_order_relaxed)) < items_;) (*job_)(i);
+    }
+
+    const unsigned workers_;
+    std::vector<std::thread> threads_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    const std::function<void(std::size_t)>* job_ = nullptr;
+    std::size_t items_ = 0;
+    std::atomic<std::size_t> next_{0};
+    unsigned busy_ = 0;
+    uint64_t generation_ = 0;
+    bool stop_ = false;
+};
+
+const char* ToString(ByteClass cls) {
+    switch (cls) {
+        case ByteClass::Unknown:      return "UNKNOWN";
+        case ByteClass::Code:         return "CODE";
+        case ByteClass::Data:         return "DATA";
+        case ByteClass::Text:         return "TEXT";
+        case ByteClass::PointerTable: return "POINTER_TABLE";
+        case ByteClass::Screen:       return "SCREEN";
+        case ByteClass::Attributes:   return "ATTRIBUTES";
+    }
+    return "UNKNOWN";
+}
+
+CodeClassifier::CodeClassifier(Options options)
+    : options_(options),
+      image_(kSpace, 0), coverage_(kSpace, 0), length_(kSpace, 0), targets_(kSpace, 0),
+      entries_(kSpace, 0), stops_(kSpace, 0), is_code_(kSpace, 0), class_(kSpace, ByteClass::Unknown),
+      confidence_(kSpace, 0), dirty_pages_(kSpace / kPage / 64, 0),
+      mark_chunks_(kChunks, 0), scan_chunks_(kChunks, 0) {
+    unsigned n = options_.threads ? options_.threads : std::thread::hardware_concurrency();
+    threads_ = std::clamp(n, 1u, kMaxThreads);
+    pool_ = std::make_unique<WorkerPool>(threads_ - 1);
+}
+
+CodeClassifier::~CodeClassifier() = default;
+
+// -- Inputs ------------------------------------------------------------------
+
+void CodeClassifier::SetImage(std::span<const uint8_t> image) {
+    const std::size_t n = std::min<std::size_t>(image.size(), kSpace);
+    for (std::size_t page = 0; page * kPage < n; ++page) {
+        const std::size_t off = page * kPage;
+        const std::size_t len = std::min<std::size_t>(kPage, n - off);
+        if (!have_image_ || std::memcmp(&image_[off], image.data() + off, len) != 0) {
+            dirty_pages_[page / 64] |= uint64_t{1} << (page % 64);
+            std::memcpy(&image_[off], image.data() + off, len);
+        }
+    }
+    have_image_ = true;
+}
+
+void CodeClassifier::SetCoverage(std::span<const uint8_t> flags) {
+    const std::size_t n = std::min<std::size_t>(flags.size(), kSpace);
+    for (std::size_t a = 0; a < n; ++a) {
+        if (flags[a] == coverage_[a]) continue;
+        if ((flags[a] & kExecOpcode) && !(coverage_[a] & kExecOpcode))
+            pending_.push_back(static_cast<uint16_t>(a));
+        coverage_[a] = flags[a];
+        mark_chunks_[a / kChunk] = 1;
+        coverage_changed_ = true;
+    }
+}
+
+void CodeClassifier::AddEntry(uint16_t address, bool call_target) {
+    const uint8_t bits = static_cast<uint8_t>(kEntry | (call_target ? kCallTarget : 0));
+    if ((entries_[address] & bits) == bits) return;
+    entries_[address] |= bits;
+    pending_.push_back(address);
+}
+
+void CodeClassifier::Observe(const DebugSession& session) {
+    std::vector<uint8_t> image(kSpace), flags(kSpace);
+    for (uint32_t a = 0; a < kSpace; ++a) {
+        image[a] = session.Cpu().ReadMemory(static_cast<uint16_t>(a));
+        flags[a] = session.CoverageFlags(static_cast<uint16_t>(a));
+    }
+    SetImage(image);
+    SetCoverage(flags);
+    for (const BasicBlock& b : session.Cfg().EntryPoints())
+        AddEntry(b.start, (b.entry & kEntryCall) != 0);
+}
+
+bool CodeClassifier::Executed(uint16_t address) const {
+    return (coverage_[address] & kExecOpcode) != 0;
+}
+
+bool CodeClassifier::TableWord(uint32_t a) const {
+    return a + 1 < kSpace && !is_code_[a] && !is_code_[a + 1] && length_[image_[a] | image_[a + 1] << 8] != 0;
+}
+
+bool CodeClassifier::MayJoin(uint32_t a) const {
+    if (is_code_[a - 1] || is_code_[a]) return false;
+    const uint8_t p = image_[a - 1], q = image_[a];
+    if (p == q) return true;                                            // fill
+    if (printable(p) && (printable(q) || (q >= 0x80 && printable(q & 0x7F)))) return true;   // text
+    return TableWord(a - 1) || (a >= 2 && TableWord(a - 2) && TableWord(a));
+}
+
+// -- Classification ----------------------------------------------------------
+
+bool CodeClassifier::Classify() {
+    if (!have_image_) return false;
+
+    bool dirty = false;
+    bool full = !traced_once_;
+    for (uint32_t page = 0; page < kSpace / kPage; ++page) {
+        if (!(dirty_pages_[page / 64] >> (page % 64) & 1)) continue;
+        dirty = true;
+        // Changed bytes under code invalidate whatever was traced through them.
+        const uint8_t* code = &is_code_[page * kPage];
+        if (std::find(code, code + kPage, uint8_t{1}) != code + kPage) full = true;
+    }
+    if (!full && !dirty && pending_.empty() && !coverage_changed_) return false;
+
+    std::vector<uint16_t> seeds;
+    if (full) {
+        std::fill(length_.begin(), length_.end(), uint8_t{0});
+        std::fill(targets_.begin(), targets_.end(), uint8_t{0});
+        std::fill(stops_.begin(), stops_.end(), uint8_t{0});
+        for (uint32_t a = 0; a < kSpace; ++a)
+            if (entries_[a] || Executed(static_cast<uint16_t>(a))) seeds.push_back(static_cast<uint16_t>(a));
+    } else {
+        seeds = std::move(pending_);
+        // A trace that stopped on bytes now rewritten may get further: re-seed
+        // every stop and every known target in the changed pages, and in the
+        // three bytes before each, whose decode (or NOP-run look-ahead) reads in.
+        for (uint32_t page = 0; page < kSpace / kPage; ++page) {
+            if (!(dirty_pages_[page / 64] >> (page % 64) & 1)) continue;
+            const uint32_t lo = page * kPage;
+            for (uint32_t a = lo >= 3 ? lo - 3 : 0; a < lo + kPage; ++a)
+                if (length_[a] == 0 && (stops_[a] || targets_[a] || entries_[a]))
+                    seeds.push_back(static_cast<uint16_t>(a));
+        }
+    }
+    pending_.clear();
+
+    stats_ = Stats{};
+    stats_.full = full;
+    stats_.threads = threads_;
+    const std::vector<uint16_t> started = Trace(std::move(seeds));
+
+    // What is stale: changed pages, chunks where coverage changed (noted by
+    // SetCoverage) or new instructions start or end, and words that now point
+    // at a new start (pointer tables).
+    if (full) {
+        std::fill(mark_chunks_.begin(), mark_chunks_.end(), uint8_t{1});
+        std::fill(scan_chunks_.begin(), scan_chunks_.end(), uint8_t{1});
+    } else {
+        for (uint32_t page = 0; page < kSpace / kPage; ++page)
+            if (dirty_pages_[page / 64] >> (page % 64) & 1) scan_chunks_[page * kPage / kChunk] = 1;
+        if (!started.empty()) {
+            std::vector<uint8_t> is_new(kSpace, 0);
+            for (uint16_t a : started) {
+                is_new[a] = 1;
+                mark_chunks_[a / kChunk] = 1;
+                mark_chunks_[(std::min<uint32_t>(a + length_[a], kSpace) - 1) / kChunk] = 1;
+            }
+            for (uint32_t a = 0; a + 1 < kSpace; ++a) {
+                if (!is_new[image_[a] | image_[a + 1] << 8]) continue;
+                scan_chunks_[a / kChunk] = 1;
+                scan_chunks_[(a + 1) / kChunk] = 1;
+            }
+        }
+    }
+
+    std::vector<uint32_t> chunks;
+    for (uint32_t c = 0; c < kChunks; ++c)
+        if (mark_chunks_[c]) chunks.push_back(c);
+    pool_->Run(chunks.size(), chunks.size() >= kParallelChunks, [&](std::size_t i) { MarkChunk(chunks[i]); });
+    for (uint32_t c : chunks) scan_chunks_[c] = 1;
+
+    ExpandScan();
+    chunks.clear();
+    for (uint32_t c = 0; c < kChunks; ++c)
+        if (scan_chunks_[c]) chunks.push_back(c);
+    pool_->Run(chunks.size(), chunks.size() >= kParallelChunks, [&](std::size_t i) { ScanChunk(chunks[i]); });
+    stats_.rescanned_bytes = static_cast<uint32_t>(chunks.size()) * kChunk;
+
+    for (uint32_t a = 0; a < kSpace; ++a) {
+        switch (class_[a]) {
+            case ByteClass::Code:    ++stats_.code_bytes; break;
+            case ByteClass::Unknown: ++stats_.unknown_bytes; break;
+            default:                 ++stats_.data_bytes; break;
+        }
+    }
+    std::fill(dirty_pages_.begin(), dirty_pages_.end(), uint64_t{0});
+    std::fill(mark_chunks_.begin(), mark_chunks_.end(), uint8_t{0});
+    std::fill(scan_chunks_.begin(), scan_chunks_.end(), uint8_t{0});
+    coverage_changed_ = false;
+    traced_once_ = true;
+    return true;
+}
+
+std::vector<uint16_t> CodeClassifier::Trace(std::vector<uint16_t> seeds) {
+    const uint32_t span = ((kSpace / threads_) + kPage - 1) / kPage * kPage;
+    const unsigned regions = (kSpace + span - 1) / span;
+
+    // Per region: its work stack in, and what it found outside itself out.
+    struct Work {
+        std::vector<uint16_t> stack;
+        std::vector<uint16_t> foreign;
+        std::vector<std::pair<uint16_t, uint8_t>> targets;
+        std::vector<uint16_t> started;
+        uint32_t decoded = 0;
+    };
+    std::vector<Work> work(regions);
+    for (uint16_t s : seeds) work[s / span].stack.push_back(s);
+
+    const Disassembler disasm;
+    const ByteReader read = [this](uint16_t a) { return image_[a]; };
+
+    auto trace_region = [&](unsigned r) {
+        Work& w = work[r];
+        const uint32_t lo = r * span, hi = std::min(kSpace, lo + span);
+        while (!w.stack.empty()) {
+            uint32_t a = w.stack.back();
+            w.stack.pop_back();
+            for (;;) {
+                if (a < lo || a >= hi) { w.foreign.push_back(static_cast<uint16_t>(a)); break; }
+                if (length_[a] != 0) break;   // already traced
+                const auto pc = static_cast<uint16_t>(a);
+                const bool ran = Executed(pc);
+                if (!ran && options_.spectrum_layout && a >= 0x4000 && a < 0x5B00) { stops_[a] = 1; break; }
+                const Instruction ins = disasm.Decode(read, pc);
+                if (!ran && implausible(ins, image_)) { stops_[a] = 1; break; }
+                length_[a] = ins.length;
+                w.started.push_back(pc);
+                ++w.decoded;
+
+                const FlowKind flow = ClassifyFlow(ins);
+                if (ins.branch_target) {
+                    const uint16_t t = *ins.branch_target;
+                    const bool call = flow == FlowKind::Call || flow == FlowKind::CondCall;
+                    w.targets.emplace_back(t, call ? kCallTarget : kJumpTarget);
+                    if (t >= lo && t < hi) w.stack.push_back(t);
+                    else w.foreign.push_back(t);
+                }
+                if (flow == FlowKind::Jump || flow == FlowKind::Return) break;
+                a += ins.length;
+                if (a >= kSpace) break;
+            }
+        }
+    };
+
+    std::vector<uint16_t> started;
+    for (;;) {
+        std::size_t queued = 0;
+        for (const Work& w : work) queued += w.stack.size();
+        pool_->Run(regions, queued >= kParallelSeeds, [&](std::size_t r) { trace_region(static_cast<unsigned>(r)); });
+        bool more = false;
+        for (Work& w : work) {
+            stats_.traced_instructions += w.decoded;
+            w.decoded = 0;
+            started.insert(started.end(), w.started.begin(), w.started.end());
+            w.started.clear();
+            for (const auto& [t, bit] : w.targets) targets_[t] |= bit;
+            w.targets.clear();
+            for (uint16_t f : w.foreign) {
+                if (length_[f] != 0) continue;
+                work[f / span].stack.push_back(f);
+                more = true;
+            }
+            w.foreign.clear();
+        }
+        if (!more) break;
+    }
+    return started;
+}
+
+void CodeClassifier::MarkChunk(uint32_t chunk) {
+    const uint32_t lo = chunk * kChunk, hi = lo + kChunk;
+    for (uint32_t a = lo; a < hi; ++a) is_code_[a] = (coverage_[a] & (kExecOpcode | kExecOperand)) != 0;
+    // Instructions starting up to 3 bytes before the chunk reach into it.
+    for (uint32_t a = lo >= 3 ? lo - 3 : 0; a < hi; ++a)
+        for (uint32_t i = 0; i < length_[a]; ++i)
+            if (a + i >= lo && a + i < hi) is_code_[a + i] = 1;
+}
+
+void CodeClassifier::ScanChunk(uint32_t chunk) {
+    const uint32_t lo = chunk * kChunk, hi = lo + kChunk;
+    const Disassembler disasm;
+    const ByteReader read = [this](uint16_t a) { return image_[a]; };
+
+    for (uint32_t a = lo; a < hi; ++a) {
+        const bool ran = (coverage_[a] & (kExecOpcode | kExecOperand)) != 0;
+        class_[a] = is_code_[a] ? ByteClass::Code : ByteClass::Unknown;
+        confidence_[a] = !is_code_[a] ? 0 : ran ? 100 : 80;   // seen executing / static flow only
+    }
+
+    // The chunk writes class_/confidence_ for its own bytes only. Run shapes
+    // are computed from read-only inputs (image_, is_code_, length_), so every
+    // chunk agrees on a run that straddles a boundary.
+    auto paint = [&](uint32_t s, uint32_t e, ByteClass cls, uint8_t conf) {
+        for (uint32_t a = std::max(s, lo); a < std::min(e, hi); ++a) {
+            class_[a] = cls;
+            confidence_[a] = conf;
+        }
+    };
+    auto data = [&](uint32_t a) { return !is_code_[a]; };
+    auto always = [](uint32_t, uint32_t) { return true; };
+
+    // Fill: a run of one repeated value.
+    for_each_run(lo, hi, 1, 1, data,
+                 [&](uint32_t p, uint32_t q) { return image_[p] == image_[q]; },
+                 [&](uint32_t s, uint32_t e) {
+                     if (e - s >= options_.min_fill) paint(s, e, ByteClass::Data, 90);
+                 });
+
+    // Text: printable ASCII, optionally closed by a bit-7-set final character
+    // (the Spectrum ROM's string convention).
+    for_each_run(lo, hi, 1, 1,
+                 [&](uint32_t a) { return data(a) && printable(image_[a]); }, always,
+                 [&](uint32_t s, uint32_t e) {
+                     if (e - s < options_.min_text) return;
+                     if (e < kSpace && data(e) && image_[e] >= 0x80 && printable(image_[e] & 0x7F)) ++e;
+                     paint(s, e, ByteClass::Text,
+                           static_cast<uint8_t>(std::min<uint32_t>(100, 60 + 2 * (e - s))));
+                 });
+
+    // Pointer tables: consecutive little-endian words that each point at a
+    // known instruction start (at least two distinct targets, so zero fill
+    // pointing at 0x0000 doesn't qualify).
+    auto word = [&](uint32_t a) { return static_cast<uint16_t>(image_[a] | image_[a + 1] << 8); };
+    for_each_run(lo, hi, 2, 2,
+                 [&](uint32_t a) { return data(a) && data(a + 1) && length_[word(a)] != 0; },
+                 always,
+                 [&](uint32_t s, uint32_t e) {
+                     const uint32_t words = (e - s) / 2;
+                     if (words < options_.min_table) return;
+                     bool distinct = false;
+                     for (uint32_t a = s + 2; a < e && !distinct; a += 2) distinct = word(a) != word(s);
+                     if (!distinct) return;
+                     paint(s, e, ByteClass::PointerTable,
+                           static_cast<uint8_t>(std::min<uint32_t>(100, 60 + 10 * words)));
+                 });
+
+    if (options_.spectrum_layout) {
+        for (uint32_t a = std::max(lo, 0x4000u); a < std::min(hi, 0x5B00u); ++a) {
+            if (is_code_[a]) continue;
+            class_[a] = a < 0x5800 ? ByteClass::Screen : ByteClass::Attributes;
+            confidence_[a] = 90;
+        }
+    }
+
+    // Score what is left: a linear sweep over each Unknown run (clipped to
+    // this chunk), counting instructions that look intentional. Capped
+    // below the static-trace confidence since nothing proves it's code.
+    uint32_t a = lo;
+    while (a < hi) {
+        if (class_[a] != ByteClass::Unknown) { ++a; continue; }
+        uint32_t e = a;
+        while (e < hi && class_[e] == ByteClass::Unknown) ++e;
+        uint32_t good = 0, total = 0;
+        for (uint32_t p = a; p < e;) {
+            const Instruction ins = disasm.Decode(read, static_cast<uint16_t>(p));
+            ++total;
+            // Running into known code mid-instruction is a strong "no".
+            bool ok = !implausible(ins, image_);
+            for (uint32_t i = 1; i < ins.length && p + i < kSpace; ++i)
+                if (is_code_[p + i] && length_[p + i] != 0) ok = false;
+            good += ok;
+            p += ins.length;
+        }
+        const auto score = static_cast<uint8_t>(total ? 70 * good / total : 0);
+        std::fill(confidence_.begin() + a, confidence_.begin() + e, score);
+        a = e;
+    }
+}
+
+void CodeClassifier::ExpandScan() {
+    // Fill and text depend on a change only this far from it; so does the
+    // confidence of text (saturating at 20 bytes) and tables (at 4 words).
+    const uint32_t radius = std::max({uint32_t{options_.min_fill}, uint32_t{options_.min_text}, 20u,
+                                      2u * std::max<uint32_t>(options_.min_table, 4)}) + 4;
+    const std::vector<uint8_t> changed = scan_chunks_;
+    for (uint32_t c = 0; c < kChunks; ++c) {
+        if (!changed[c]) continue;
+        // The neighbours always: runs and instructions cross into them. Past
+        // a neighbour only while a run can cross all of it and still matter.
+        for (uint32_t k = c, far = 1; k-- > 0 && !changed[k]; ++far) {
+            scan_chunks_[k] = 1;
+            if (!Bridges(k, far * kChunk < radius)) break;
+        }
+        for (uint32_t k = c + 1, far = 1; k < kChunks && !changed[k]; ++k, ++far) {
+            scan_chunks_[k] = 1;
+            if (!Bridges(k, far * kChunk < radius)) break;
+        }
+    }
+}
+
+bool CodeClassifier::Bridges(uint32_t chunk, bool near) const {
+    const uint32_t lo = chunk * kChunk, hi = lo + kChunk;
+    if (near) {
+        bool joined = true;
+        for (uint32_t a = lo + 1; joined && a < hi; ++a) joined = MayJoin(a);
+        if (joined) return true;
+    }
+    // Pointer tables: one distinct word anywhere makes a run a table, so a
+    // run of one repeated pointer carries a change any distance.
+    for (uint32_t phase = 0; phase < 2; ++phase) {
+        const uint32_t first = lo + phase;
+        bool same = true;
+        for (uint32_t a = first; same && a + 1 < hi; a += 2)
+            same = TableWord(a) && image_[a] == image_[first] && image_[a + 1] == image_[first + 1];
+        if (same) return true;
+    }
+    return false;
+}
+
+// -- Results -----------------------------------------------------------------
+
+std::vector<ClassifiedRegion> CodeClassifier::Regions() const {
+    std::vector<ClassifiedRegion> out;
+    uint32_t a = 0;
+    while (a < kSpace) {
+        uint32_t e = a;
+        uint64_t sum = 0;
+        while (e < kSpace && class_[e] == class_[a]) sum += confidence_[e++];
+        out.push_back({static_cast<uint16_t>(a), e, class_[a],
+                       static_cast<uint8_t>(sum / (e - a))});
+        a = e;
+    }
+    return out;
+}
+
+std::size_t CodeClassifier::ApplyLabels(SymbolTable& symbols) const {
+    std::size_t added = 0;
+    char name[16];
+    auto add = [&](uint32_t a, const char* prefix, SymbolType type, uint32_t size) {
+        const auto address = static_cast<uint16_t>(a);
+        if (symbols.Lookup(address)) return;
+        std::snprintf(name, sizeof(name), "%s_%04X", prefix, address);
+        symbols.Define(Symbol{address, name, type, "auto",
+                              static_cast<uint16_t>(std::min<uint32_t>(size, 0xFFFF))});
+        ++added;
+    };
+
+    for (uint32_t a = 0; a < kSpace; ++a) {
+        const uint8_t bits = targets_[a] | entries_[a];
+        if (length_[a] != 0 && (bits & kCallTarget))      add(a, "SUB", SymbolType::Function, 1);
+        else if (length_[a] != 0 && (bits & kJumpTarget)) add(a, "LOC", SymbolType::JumpTarget, 1);
+        if (coverage_[a] & kSelfModified) add(a, "SMC", SymbolType::ByteVariable, 1);
+    }
+    for (const ClassifiedRegion& r : Regions()) {
+        if (r.cls == ByteClass::Text)
+            add(r.start, "STR", SymbolType::DataRegion, r.end - r.start);
+        else if (r.cls == ByteClass::PointerTable)
+            add(r.start, "TBL", SymbolType::DataRegion, r.end - r.start);
+    }
+    return added;
+}
+
+} // namespace z80::dbg
@@ -0,0 +1,188 @@
+//
+// Z80 Digital Twin Debugger - CodeClassifier
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// Splits a 64K memory image into code and data -- the first step of the
+// RAM-to-source path. Dynamic evidence comes first: bytes the session saw
+// execute are code, full stop. From every executed instruction and every known
+// entry point a recursive-descent trace then follows static flow (branch and
+// call targets, fall-through) to find code that has not run yet. What remains
+// is scanned for data shapes: pointer tables into known code, text runs, fill,
+// and (optionally) the Spectrum screen/attribute file. Leftovers stay Unknown
+// with a score for how code-like they look.
+//
+// The work is split by address region across worker threads: each thread
+// traces the instruction starts and writes the class of bytes inside its own
+// region only, handing cross-region branch targets back for the next round, so
+// there is no shared mutable state. The threads are the classifier's own,
+// started on first use and kept for every later pass; passes too small to
+// gain from them run on the caller's thread. Re-classifying is incremental:
+// new coverage or entries only trace from the new seeds, and a write off code
+// re-seeds the places in the written pages where a trace stopped or a known
+// target lies; a full re-trace happens only when memory under statically
+// inferred code changed. Marking and the data scan work in 1 KB chunks and
+// redo only the chunks whose inputs changed, plus those a data run or an
+// instruction reaches from them.
+//
+
+#ifndef Z80_DBG_CODE_CLASSIFIER_H
+#define Z80_DBG_CODE_CLASSIFIER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace z80::dbg {
+
+class DebugSession;
+class SymbolTable;
+
+/// @brief What a byte of memory is believed to hold.
+enum class ByteClass : uint8_t {
+    Unknown,       ///< No evidence either way (see the code-likeness score).
+    Code,          ///< Executed, or reached by static flow from executed code.
+    Data,          ///< Fill (runs of one value) or otherwise non-code.
+    Text,          ///< Printable ASCII run (optionally bit-7 terminated).
+    PointerTable,  ///< Little-endian words pointing at known code.
+    Screen,        ///< Spectrum display file (0x4000-0x57FF).
+    Attributes,    ///< Spectrum attribute file (0x5800-0x5AFF).
+};
+
+/// @brief Display name for a ByteClass ("CODE", "TEXT", ...).
+const char* ToString(ByteClass cls);
+
+/// @brief A maximal run of bytes with the same class.
+struct ClassifiedRegion {
+    uint16_t start = 0;
+    uint32_t end = 0;           ///< One past the last byte (<= 0x10000).
+    ByteClass cls = ByteClass::Unknown;
+    uint8_t confidence = 0;     ///< 0..100 (for Unknown: how code-like it looks).
+};
+
+class CodeClassifier {
+public:
+    struct Options {
+        unsigned threads = 0;           ///< Worker threads (0 = hardware concurrency).
+        bool spectrum_layout = true;    ///< Recognise the Spectrum screen/attributes.
+        uint16_t min_text = 5;          ///< Shortest printable run taken as text.
+        uint16_t min_table = 3;         ///< Fewest words in a pointer table.
+        uint16_t min_fill = 8;          ///< Shortest run of one value taken as fill.
+    };
+
+    /// @brief Counters from the most recent Classify().
+    struct Stats {
+        uint32_t code_bytes = 0;
+        uint32_t data_bytes = 0;        ///< Data + Text + PointerTable + Screen + Attributes.
+        uint32_t unknown_bytes = 0;
+        uint32_t traced_instructions = 0;  ///< Instructions decoded this pass.
+        uint32_t rescanned_bytes = 0;      ///< Bytes re-marked or re-scanned this pass.
+        unsigned threads = 0;
+        bool full = false;              ///< Whether this pass re-traced everything.
+    };
+
+    CodeClassifier() : CodeClassifier(Options{}) {}
+    explicit CodeClassifier(Options options);
+    ~CodeClassifier();
+
+    // -- Inputs --------------------------------------------------------------
+
+    /// @brief Replace the memory image (64K bytes). Pages that changed are
+    ///        remembered so the next Classify() redoes only what depends on them.
+    void SetImage(std::span<const uint8_t> image);
+
+    /// @brief Replace the per-address CoverageFlag bits (64K bytes).
+    void SetCoverage(std::span<const uint8_t> flags);
+
+    /// @brief A known entry point (reset/interrupt vector, CFG entry, user hint).
+    void AddEntry(uint16_t address, bool call_target = false);
+
+    /// @brief Pull image, coverage and CFG entry points from a live session.
+    void Observe(const DebugSession& session);
+
+    // -- Classification ------------------------------------------------------
+
+    /// @brief Bring the map up to date with the inputs.
+    /// @return false if nothing had changed since the last pass.
+    bool Classify();
+
+    [[nodiscard]] ByteClass ClassAt(uint16_t address) const { return class_[address]; }
+    [[nodiscard]] uint8_t ConfidenceAt(uint16_t address) const { return confidence_[address]; }
+
+    /// @brief Whether an instruction starts at @p address (executed or traced).
+    [[nodiscard]] bool IsInstructionStart(uint16_t address) const {
+        return length_[address] != 0;
+    }
+
+    /// @brief The map as maximal same-class runs, in address order.
+    [[nodiscard]] std::vector<ClassifiedRegion> Regions() const;
+
+    /// @brief Add auto-labels for what was found: SUB_xxxx (call targets),
+    ///        LOC_xxxx (jump targets), TBL_xxxx / STR_xxxx (tables, text) and
+    ///        SMC_xxxx (code bytes rewritten at run time). Addresses that already
+    ///        carry a symbol are left alone.
+    /// @return Number of symbols added.
+    std::size_t ApplyLabels(SymbolTable& symbols) const;
+
+    [[nodiscard]] const Stats& LastStats() const noexcept { return stats_; }
+
+private:
+    enum TargetBit : uint8_t {
+        kJumpTarget = 1u << 0,
+        kCallTarget = 1u << 1,
+        kEntry      = 1u << 2,
+    };
+
+    class WorkerPool;
+
+    /// @brief Recursive descent from @p seeds, region-parallel.
+    /// @return The instruction starts it found.
+    std::vector<uint16_t> Trace(std::vector<uint16_t> seeds);
+
+    /// @brief Derive one chunk's is_code_ from coverage + traced starts.
+    void MarkChunk(uint32_t chunk);
+
+    /// @brief Classify one chunk: its code, then the data shapes in the rest.
+    void ScanChunk(uint32_t chunk);
+
+    /// @brief Add to scan_chunks_ every chunk whose classes can depend on one
+    ///        already in it (an instruction or a data run crossing between).
+    void ExpandScan();
+
+    /// @brief Whether a data run can carry a change across all of @p chunk
+    ///        (@p near: the change is close enough to matter for fill and text).
+    [[nodiscard]] bool Bridges(uint32_t chunk, bool near) const;
+
+    [[nodiscard]] bool Executed(uint16_t address) const;
+    [[nodiscard]] bool MayJoin(uint32_t address) const;     ///< address-1 and address in one run?
+    [[nodiscard]] bool TableWord(uint32_t address) const;   ///< A word pointing at a start?
+
+    Options options_;
+    unsigned threads_ = 1;
+
+    std::vector<uint8_t> image_;       ///< 64K memory snapshot.
+    std::vector<uint8_t> coverage_;    ///< 64K CoverageFlag bits.
+    std::vector<uint8_t> length_;      ///< Instruction length at each start; 0 = none.
+    std::vector<uint8_t> targets_;     ///< TargetBit per address, from tracing.
+    std::vector<uint8_t> entries_;     ///< TargetBit per address, from AddEntry().
+    std::vector<uint8_t> stops_;       ///< 1 where a trace stopped short of decoding.
+    std::vector<uint8_t> is_code_;     ///< Final code map (read-only during ScanData).
+    std::vector<ByteClass> class_;
+    std::vector<uint8_t> confidence_;
+
+    std::vector<uint16_t> pending_;        ///< Seeds not traced yet.
+    std::vector<uint64_t> dirty_pages_;    ///< 256 pages of 256 bytes, 1 bit each.
+    std::vector<uint8_t> mark_chunks_;     ///< Chunks whose is_code_ is stale.
+    std::vector<uint8_t> scan_chunks_;     ///< Chunks whose classes are stale.
+    std::unique_ptr<WorkerPool> pool_;
+    bool have_image_ = false;
+    bool traced_once_ = false;
+    bool coverage_changed_ = false;
+    Stats stats_;
+};
+
+} // namespace z80::dbg
+
+#endif // Z80_DBG_CODE_CLASSIFIER_H
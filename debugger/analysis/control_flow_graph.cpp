@@ -0,0 +1,269 @@
+//
+// Z80 Digital Twin Debugger - ControlFlowGraph implementation
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+
+#include "control_flow_graph.h"
+
+#include <algorithm>
+
+namespace z80::dbg {
+
+const char* ToString(EdgeKind kind) {
+    switch (kind) {
+        case EdgeKind::Fallthrough: return "FALLTHROUGH";
+        case EdgeKind::Jump:        return "JUMP";
+        case EdgeKind::Taken:       return "TAKEN";
+        case EdgeKind::NotTaken:    return "NOT_TAKEN";
+        case EdgeKind::Call:        return "CALL";
+        case EdgeKind::Return:      return "RETURN";
+        case EdgeKind::Interrupt:   return "INTERRUPT";
+    }
+    return "JUMP";
+}
+
+ControlFlowGraph::ControlFlowGraph()
+    : owner_(65536, kNone), insn_(65536, 0), epoch_(65536, 0) {}
+
+void ControlFlowGraph::Record(uint16_t pc, uint16_t next_pc, const ByteReader& read) {
+    uint8_t info = insn_[pc];
+    if (info == 0) {   // first execution of this start (or since its code changed)
+        const Instruction ins = disasm_.Decode(read, pc);
+        info = static_cast<uint8_t>(static_cast<uint8_t>(ClassifyFlow(ins)) << 4 | ins.length);
+        insn_[pc] = info;
+    }
+    const uint8_t length = info & 0x0F;
+    const FlowKind flow = static_cast<FlowKind>(info >> 4);
+
+    if (!have_prev_) {
+        pending_entry_ |= kEntryStart;
+    } else if (pc != expected_) {
+        AddEdge(prev_pc_, pc, EdgeKind::Interrupt);
+        pending_entry_ |= kEntryInterrupt;
+        open_ = kNone;
+    }
+
+    const uint32_t block = Enter(pc, length);
+
+    const auto fall = static_cast<uint16_t>(pc + length);
+    const bool taken = next_pc != fall;
+    open_ = kNone;
+    switch (flow) {
+        case FlowKind::Sequential:
+            open_ = block;
+            break;
+        case FlowKind::Jump:
+            AddEdge(pc, next_pc, EdgeKind::Jump);
+            break;
+        case FlowKind::CondJump:
+            AddEdge(pc, next_pc, taken ? EdgeKind::Taken : EdgeKind::NotTaken);
+            break;
+        case FlowKind::Call:
+        case FlowKind::CondCall:
+            AddEdge(pc, next_pc, taken ? EdgeKind::Call : EdgeKind::NotTaken);
+            if (taken) pending_entry_ |= kEntryCall;
+            break;
+        case FlowKind::Return:
+        case FlowKind::CondReturn:
+            AddEdge(pc, next_pc, taken ? EdgeKind::Return : EdgeKind::NotTaken);
+            break;
+        case FlowKind::Halt:
+            break;
+    }
+
+    have_prev_ = true;
+    prev_pc_ = pc;
+    expected_ = next_pc;
+}
+
+uint32_t ControlFlowGraph::Enter(uint16_t pc, uint8_t length) {
+    uint32_t block = owner_[pc];
+    if (block != kNone) {
+        // Known code. Sequential flow within the same block is the hot path;
+        // arriving in the middle of a block any other way is a new entry point.
+        if (blocks_[block].start != pc && open_ != block) block = Split(block, pc, length);
+        else if (blocks_[block].start == pc && open_ != kNone && open_ != block)
+            AddEdge(prev_pc_, pc, EdgeKind::Fallthrough);
+    } else if (open_ != kNone && blocks_[open_].end == pc &&
+               static_cast<uint32_t>(pc) + length <= 0x10000) {
+        // New code straight after the open block: grow it.
+        block = open_;
+        BasicBlock& b = blocks_[block];
+        b.end = static_cast<uint32_t>(pc) + length;
+        b.last = pc;
+        ++b.instructions;
+        for (uint32_t a = pc; a < b.end; ++a) owner_[a] = block;
+    } else {
+        if (open_ != kNone) AddEdge(prev_pc_, pc, EdgeKind::Fallthrough);
+        block = NewBlock(pc, length);
+    }
+
+    BasicBlock& b = blocks_[block];
+    if (b.start == pc) {
+        ++b.executions;
+        b.entry |= pending_entry_;
+    }
+    pending_entry_ = 0;
+    return block;
+}
+
+uint32_t ControlFlowGraph::NewBlock(uint16_t pc, uint8_t length) {
+    uint32_t block;
+    if (!free_.empty()) {
+        block = free_.back();
+        free_.pop_back();
+    } else {
+        block = static_cast<uint32_t>(blocks_.size());
+        blocks_.emplace_back();
+        live_.push_back(0);
+    }
+    const uint32_t end = std::min<uint32_t>(0x10000, static_cast<uint32_t>(pc) + length);
+    blocks_[block] = BasicBlock{pc, pc, end, 1, 0, 0};
+    live_[block] = 1;
+    ++live_blocks_;
+    for (uint32_t a = pc; a < end; ++a) owner_[a] = block;
+    return block;
+}
+
+uint32_t ControlFlowGraph::Split(uint32_t block, uint16_t pc, uint8_t length) {
+    // Find the instruction boundary at pc. If pc lands inside an instruction
+    // (overlapping decode, e.g. a jump into an operand), it's separate code.
+    uint32_t a = blocks_[block].start;
+    uint16_t before = blocks_[block].start;
+    uint32_t head = 0;
+    while (a < pc) {
+        const uint8_t len = insn_[a] & 0x0F;
+        if (len == 0) break;
+        before = static_cast<uint16_t>(a);
+        a += len;
+        ++head;
+    }
+    if (a != pc) return NewBlock(pc, length);
+
+    const uint32_t tail = NewBlock(pc, length);
+    BasicBlock& old = blocks_[block];
+    BasicBlock& rest = blocks_[tail];
+    rest.last = old.last;
+    rest.end = old.end;
+    rest.instructions = old.instructions - head;
+    rest.executions = old.executions;   // every earlier run went through pc
+    for (uint32_t x = pc; x < old.end; ++x)
+        if (owner_[x] == block) owner_[x] = tail;
+    old.end = pc;
+    old.last = before;
+    old.instructions = head;
+    AddEdge(before, pc, EdgeKind::Fallthrough, old.executions);
+    return tail;
+}
+
+void ControlFlowGraph::InvalidateBlock(uint32_t block) {
+    const BasicBlock& b = blocks_[block];
+    for (uint32_t a = b.start; a < b.end; ++a) {
+        if (owner_[a] != block) continue;
+        owner_[a] = kNone;
+        insn_[a] = 0;     // re-decode: the bytes may now be different code
+        ++epoch_[a];      // orphans edges leaving this code
+    }
+    live_[block] = 0;
+    free_.push_back(block);
+    --live_blocks_;
+    ++invalidations_;
+    if (open_ == block) open_ = kNone;
+}
+
+void ControlFlowGraph::AddEdge(uint16_t from, uint16_t to, EdgeKind kind, uint64_t count) {
+    const uint32_t key = static_cast<uint32_t>(from) << 16 | to;
+    const auto [it, inserted] = edge_index_.try_emplace(key, static_cast<uint32_t>(edges_.size()));
+    if (inserted) {
+        edges_.push_back({{from, to, kind, count}, epoch_[from]});
+        return;
+    }
+    EdgeSlot& slot = edges_[it->second];
+    if (slot.epoch != epoch_[from]) {
+        slot = {{from, to, kind, count}, epoch_[from]};   // source code was rewritten
+        return;
+    }
+    slot.edge.count += count;
+}
+
+bool ControlFlowGraph::EdgeLive(const EdgeSlot& e) const {
+    return owner_[e.edge.from] != kNone && e.epoch == epoch_[e.edge.from];
+}
+
+void ControlFlowGraph::Clear() {
+    std::fill(owner_.begin(), owner_.end(), kNone);
+    std::fill(insn_.begin(), insn_.end(), uint8_t{0});
+    std::fill(epoch_.begin(), epoch_.end(), uint64_t{0});
+    blocks_.clear();
+    live_.clear();
+    free_.clear();
+    live_blocks_ = 0;
+    edges_.clear();
+    edge_index_.clear();
+    have_prev_ = false;
+    open_ = kNone;
+    pending_entry_ = 0;
+    invalidations_ = 0;
+}
+
+std::optional<BasicBlock> ControlFlowGraph::BlockAt(uint16_t address) const {
+    const uint32_t block = owner_[address];
+    if (block == kNone) return std::nullopt;
+    return blocks_[block];
+}
+
+std::vector<BasicBlock> ControlFlowGraph::Blocks() const {
+    std::vector<BasicBlock> out;
+    out.reserve(live_blocks_);
+    for (std::size_t i = 0; i < blocks_.size(); ++i)
+        if (live_[i]) out.push_back(blocks_[i]);
+    std::sort(out.begin(), out.end(),
+              [](const BasicBlock& a, const BasicBlock& b) { return a.start < b.start; });
+    return out;
+}
+
+std::vector<CfgEdge> ControlFlowGraph::Edges() const {
+    std::vector<CfgEdge> out;
+    for (const EdgeSlot& e : edges_)
+        if (EdgeLive(e)) out.push_back(e.edge);
+    std::sort(out.begin(), out.end(), [](const CfgEdge& a, const CfgEdge& b) {
+        return a.from != b.from ? a.from < b.from : a.to < b.to;
+    });
+    return out;
+}
+
+std::vector<CfgEdge> ControlFlowGraph::EdgesFrom(uint16_t start) const {
+    std::vector<CfgEdge> out;
+    const uint32_t block = owner_[start];
+    if (block == kNone || blocks_[block].start != start) return out;
+    for (const EdgeSlot& e : edges_)
+        if (EdgeLive(e) && owner_[e.edge.from] == block) out.push_back(e.edge);
+    return out;
+}
+
+std::vector<CfgEdge> ControlFlowGraph::EdgesTo(uint16_t start) const {
+    std::vector<CfgEdge> out;
+    for (const EdgeSlot& e : edges_)
+        if (EdgeLive(e) && e.edge.to == start) out.push_back(e.edge);
+    return out;
+}
+
+std::vector<BasicBlock> ControlFlowGraph::HotBlocks(std::size_t n) const {
+    std::vector<BasicBlock> out = Blocks();
+    n = std::min(n, out.size());
+    std::partial_sort(out.begin(), out.begin() + static_cast<std::ptrdiff_t>(n), out.end(),
+                      [](const BasicBlock& a, const BasicBlock& b) {
+                          return a.executions > b.executions;
+                      });
+    out.resize(n);
+    return out;
+}
+
+std::vector<BasicBlock> ControlFlowGraph::EntryPoints() const {
+    std::vector<BasicBlock> out = Blocks();
+    std::erase_if(out, [](const BasicBlock& b) { return b.entry == 0; });
+    return out;
+}
+
+} // namespace z80::dbg
@@ -0,0 +1,171 @@
+//
+// Z80 Digital Twin Debugger - ControlFlowGraph
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// A control-flow graph built incrementally from execution evidence: basic
+// blocks, call/jump/return edges with taken counts, and observed entry points.
+// It is fed one executed instruction at a time (DebugSession does this after
+// every step) and never decodes statically, so it describes what the program
+// actually did rather than what a disassembly guesses it might do.
+//
+// Storage is flat so the graph stays live during a full-speed debugged run:
+// 64K per-address arrays map each byte to its owning block and cache each
+// instruction start's length/flow kind (decoded once), blocks live in a dense
+// vector, and edges in a dense vector indexed by (source, target). The common
+// case -- re-executing known code -- is a couple of array reads per
+// instruction plus one hash lookup per taken branch. Splitting a block on a
+// newly discovered target and invalidating a block hit by self-modifying code
+// touch only that block's bytes.
+//
+
+#ifndef Z80_DBG_CONTROL_FLOW_GRAPH_H
+#define Z80_DBG_CONTROL_FLOW_GRAPH_H
+
+#include "disassembler.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace z80::dbg {
+
+/// @brief How control left an edge's source instruction.
+enum class EdgeKind : uint8_t {
+    Fallthrough,  ///< Sequential flow into the next block (after a split).
+    Jump,         ///< Unconditional JP/JR/JP (rr).
+    Taken,        ///< Conditional branch taken (JP cc/JR cc/DJNZ/block repeat).
+    NotTaken,     ///< Conditional branch/call/return not taken.
+    Call,         ///< CALL/RST into a subroutine.
+    Return,       ///< RET/RETI/RETN back to a caller.
+    Interrupt,    ///< Control left between instructions (interrupt, PC poked).
+};
+
+/// @brief Display name for an EdgeKind ("JUMP", "CALL", ...).
+const char* ToString(EdgeKind kind);
+
+/// @brief How a block was observed being entered (bitmask).
+enum BlockEntry : uint8_t {
+    kEntryStart     = 1u << 0,  ///< First code executed after a Clear().
+    kEntryCall      = 1u << 1,  ///< Target of a CALL/RST.
+    kEntryInterrupt = 1u << 2,  ///< Reached by an interrupt / external PC change.
+};
+
+/// @brief A straight-line run of executed instructions with one entry point.
+struct BasicBlock {
+    uint16_t start = 0;         ///< First instruction.
+    uint16_t last = 0;          ///< Last instruction (the one that leaves it).
+    uint32_t end = 0;           ///< One past the block's last byte (<= 0x10000).
+    uint32_t instructions = 0;  ///< Instructions in the block.
+    uint64_t executions = 0;    ///< Times control entered at start.
+    uint8_t entry = 0;          ///< BlockEntry bits.
+};
+
+/// @brief An observed transfer between two instructions.
+struct CfgEdge {
+    uint16_t from = 0;          ///< Source instruction (last of its block).
+    uint16_t to = 0;            ///< Target instruction (start of its block).
+    EdgeKind kind = EdgeKind::Jump;
+    uint64_t count = 0;         ///< Times this transfer happened.
+};
+
+class ControlFlowGraph {
+public:
+    ControlFlowGraph();
+
+    // -- Recording -----------------------------------------------------------
+
+    /// @brief Record one executed instruction: it started at @p pc and control
+    ///        continued at @p next_pc. @p read is used (only) to decode a start
+    ///        address the first time it executes.
+    /// @details A @p pc other than where the previous instruction continued is
+    ///          recorded as an Interrupt edge (the CPU took an interrupt or the
+    ///          PC was changed externally between instructions).
+    void Record(uint16_t pc, uint16_t next_pc, const ByteReader& read);
+
+    /// @brief A byte was written: if it belongs to a block, that block's code
+    ///        changed, so drop the block (and its outgoing edges). It is rebuilt
+    ///        from fresh evidence the next time it runs. O(1) for data writes.
+    void Invalidate(uint16_t address) {
+        if (owner_[address] != kNone) InvalidateBlock(owner_[address]);
+    }
+
+    /// @brief Forget everything (e.g. on CPU reset).
+    void Clear();
+
+    // -- Queries -------------------------------------------------------------
+
+    /// @brief The live block containing @p address, if that byte has executed.
+    [[nodiscard]] std::optional<BasicBlock> BlockAt(uint16_t address) const;
+
+    /// @brief All live blocks, ordered by start address.
+    [[nodiscard]] std::vector<BasicBlock> Blocks() const;
+
+    /// @brief All live edges, ordered by (from, to).
+    [[nodiscard]] std::vector<CfgEdge> Edges() const;
+
+    /// @brief Live edges leaving / entering the block starting at @p start.
+    [[nodiscard]] std::vector<CfgEdge> EdgesFrom(uint16_t start) const;
+    [[nodiscard]] std::vector<CfgEdge> EdgesTo(uint16_t start) const;
+
+    /// @brief The @p n most-executed blocks, hottest first.
+    [[nodiscard]] std::vector<BasicBlock> HotBlocks(std::size_t n) const;
+
+    /// @brief Blocks with any BlockEntry bit set, ordered by start address.
+    [[nodiscard]] std::vector<BasicBlock> EntryPoints() const;
+
+    /// @brief Length of the instruction executed from @p start (0 if unknown).
+    [[nodiscard]] uint8_t InstructionLength(uint16_t start) const { return insn_[start] & 0x0F; }
+
+    [[nodiscard]] std::size_t BlockCount() const noexcept { return live_blocks_; }
+
+    /// @brief Blocks dropped because their code was overwritten.
+    [[nodiscard]] uint64_t Invalidations() const noexcept { return invalidations_; }
+
+private:
+    static constexpr uint32_t kNone = 0xFFFFFFFFu;
+
+    /// @brief Stored per-edge state; `epoch` ties it to the source byte's code.
+    struct EdgeSlot {
+        CfgEdge edge;
+        uint64_t epoch = 0;
+    };
+
+    /// @brief Find or create the block that starts at @p pc (splitting a known
+    ///        block when @p pc is a newly seen entry into its middle).
+    uint32_t Enter(uint16_t pc, uint8_t length);
+    uint32_t NewBlock(uint16_t pc, uint8_t length);
+    uint32_t Split(uint32_t block, uint16_t pc, uint8_t length);
+    void InvalidateBlock(uint32_t block);
+    void AddEdge(uint16_t from, uint16_t to, EdgeKind kind, uint64_t count = 1);
+    [[nodiscard]] bool EdgeLive(const EdgeSlot& e) const;
+
+    // Per-address state (64K each).
+    std::vector<uint32_t> owner_;   ///< Byte -> block index (kNone if unexecuted).
+    std::vector<uint8_t> insn_;     ///< Start -> (FlowKind << 4 | length); 0 = unknown.
+    std::vector<uint64_t> epoch_;   ///< Bumped when the byte's block is dropped (never wraps).
+
+    std::vector<BasicBlock> blocks_;
+    std::vector<uint8_t> live_;     ///< Parallel to blocks_.
+    std::vector<uint32_t> free_;    ///< Dropped block slots for reuse.
+    std::size_t live_blocks_ = 0;
+
+    std::vector<EdgeSlot> edges_;
+    std::unordered_map<uint32_t, uint32_t> edge_index_;   ///< from<<16|to -> edges_
+
+    Disassembler disasm_;
+
+    // Where the previous instruction left off.
+    bool have_prev_ = false;
+    uint16_t prev_pc_ = 0;
+    uint16_t expected_ = 0;        ///< Its continuation address.
+    uint32_t open_ = kNone;        ///< Block it may extend sequentially.
+    uint8_t pending_entry_ = 0;    ///< BlockEntry bits for the next block entered.
+    uint64_t invalidations_ = 0;
+};
+
+} // namespace z80::dbg
+
+#endif // Z80_DBG_CONTROL_FLOW_GRAPH_H
@@ -0,0 +1,364 @@
+//
+// Z80 Digital Twin Debugger - CoverageMap implementation
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+
+#include "coverage_map.h"
+#include "debug_session.h"
+#include "symbol_table.h"
+#include "fnv.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <ostream>
+#include <thread>
+
+namespace z80::dbg {
+namespace {
+
+constexpr uint32_t kSpace = 65536;
+constexpr char kMagic[6] = {'Z', '8', '0', 'C', 'O', 'V'};
+constexpr uint8_t kVersion = 1;
+constexpr uint8_t kCodeBits = kExecOpcode | kExecOperand;
+
+void put_u16(std::vector<uint8_t>& out, uint16_t v) {
+    out.push_back(static_cast<uint8_t>(v));
+    out.push_back(static_cast<uint8_t>(v >> 8));
+}
+
+void put_u32(std::vector<uint8_t>& out, uint32_t v) {
+    for (int i = 0; i < 4; ++i) out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+}
+
+void put_varint(std::vector<uint8_t>& out, uint32_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+/// @brief Bounds-checked little-endian / varint reader over a byte image.
+class Reader {
+public:
+    Reader(const uint8_t* data, std::size_t size) : p_(data), end_(data + size) {}
+
+    bool U8(uint8_t& v) {
+        if (p_ == end_) return false;
+        v = *p_++;
+        return true;
+    }
+    bool U16(uint16_t& v) {
+        uint8_t lo, hi;
+        if (!U8(lo) || !U8(hi)) return false;
+        v = static_cast<uint16_t>(lo | hi << 8);
+        return true;
+    }
+    bool U32(uint32_t& v) {
+        v = 0;
+        for (int i = 0; i < 4; ++i) {
+            uint8_t b;
+            if (!U8(b)) return false;
+            v |= static_cast<uint32_t>(b) << (8 * i);
+        }
+        return true;
+    }
+    bool Varint(uint32_t& v) {
+        v = 0;
+        for (int shift = 0; shift < 35; shift += 7) {
+            uint8_t b;
+            if (!U8(b)) return false;
+            v |= static_cast<uint32_t>(b & 0x7F) << shift;
+            if ((b & 0x80) == 0) return true;
+        }
+        return false;
+    }
+    bool Bytes(std::size_t n, const uint8_t*& at) {
+        if (static_cast<std::size_t>(end_ - p_) < n) return false;
+        at = p_;
+        p_ += n;
+        return true;
+    }
+    [[nodiscard]] bool AtEnd() const { return p_ == end_; }
+
+private:
+    const uint8_t* p_;
+    const uint8_t* end_;
+};
+
+uint32_t saturating_add(uint32_t a, uint32_t b) {
+    return a > std::numeric_limits<uint32_t>::max() - b ? std::numeric_limits<uint32_t>::max()
+                                                        : a + b;
+}
+
+std::string offset_label(std::string_view name, uint32_t offset) {
+    if (offset == 0) return std::string(name);
+    char buf[16];
+    std::snprintf(buf, sizeof(buf), "+0x%X", offset);
+    return std::string(name) + buf;
+}
+
+} // namespace
+
+CoverageMap::CoverageMap() : flags_(kSpace, 0), hits_(kSpace, 0) {}
+
+CoverageMap CoverageMap::FromSession(const DebugSession& session, std::string name) {
+    CoverageMap map;
+    const bool counted = session.GetProfileMode() == ProfileMode::Counters;
+    for (uint32_t a = 0; a < kSpace; ++a) {
+        const auto addr = static_cast<uint16_t>(a);
+        const uint8_t flags = session.CoverageFlags(addr);
+        map.flags_[a] = flags;
+        if (flags & kExecOpcode) {
+            const uint32_t n = counted ? session.Profiler().Count(HeatSource::Exec, addr) : 0;
+            map.hits_[a] = std::max<uint32_t>(n, 1);
+        }
+    }
+    map.runs_ = 1;
+    map.name_ = std::move(name);
+    return map;
+}
+
+bool CoverageMap::Executed(uint16_t address) const {
+    return (flags_[address] & kCodeBits) != 0;
+}
+
+uint32_t CoverageMap::CodeBytes() const {
+    return static_cast<uint32_t>(std::count_if(flags_.begin(), flags_.end(),
+                                               [](uint8_t f) { return (f & kCodeBits) != 0; }));
+}
+
+// -- Set operations -----------------------------------------------------------
+
+void CoverageMap::Merge(const CoverageMap& other) {
+    for (uint32_t a = 0; a < kSpace; ++a) {
+        flags_[a] |= other.flags_[a];
+        hits_[a] = saturating_add(hits_[a], other.hits_[a]);
+    }
+    runs_ += other.runs_;
+    if (name_.empty()) name_ = other.name_;
+}
+
+void CoverageMap::Intersect(const CoverageMap& other) {
+    for (uint32_t a = 0; a < kSpace; ++a) {
+        const auto addr = static_cast<uint16_t>(a);
+        if (Executed(addr) && other.Executed(addr)) {
+            flags_[a] |= other.flags_[a];
+            hits_[a] = std::min(hits_[a], other.hits_[a]);
+        } else {
+            flags_[a] = 0;
+            hits_[a] = 0;
+        }
+    }
+    runs_ += other.runs_;
+}
+
+std::vector<CoverageRange> CoverageMap::CodeOnlyIn(const CoverageMap& b, const CoverageMap& a,
+                                                   const SymbolTable* symbols) {
+    std::vector<CoverageRange> out;
+    // One ascending pass: the latest symbol seen names whatever follows it.
+    std::optional<std::string_view> sym;
+    uint32_t sym_at = 0;
+    for (uint32_t x = 0; x < kSpace; ++x) {
+        const auto addr = static_cast<uint16_t>(x);
+        bool boundary = false;   // a range never runs across a symbol
+        if (symbols) {
+            if (auto name = symbols->NameAt(addr)) {
+                sym = name;
+                sym_at = x;
+                boundary = true;
+            }
+        }
+        if (!b.Executed(addr) || a.Executed(addr)) continue;
+        if (!boundary && !out.empty() && out.back().end == x) {
+            out.back().end = x + 1;
+            continue;
+        }
+        out.push_back({addr, x + 1, sym ? offset_label(*sym, x - sym_at) : std::string{}});
+    }
+    return out;
+}
+
+// -- Persistence --------------------------------------------------------------
+
+std::vector<uint8_t> CoverageMap::Serialize() const {
+    std::vector<uint8_t> payload;
+    std::vector<std::pair<uint32_t, uint32_t>> runs;   // [start, end) of non-zero flags
+    for (uint32_t x = 0; x < kSpace;) {
+        if (flags_[x] == 0) { ++x; continue; }
+        const uint32_t start = x;
+        while (x < kSpace && flags_[x] != 0) ++x;
+        runs.emplace_back(start, x);
+    }
+    put_varint(payload, static_cast<uint32_t>(runs.size()));
+    uint32_t prev_end = 0;
+    for (const auto& [start, end] : runs) {
+        put_varint(payload, start - prev_end);
+        put_varint(payload, end - start);
+        payload.insert(payload.end(), flags_.begin() + start, flags_.begin() + end);
+        prev_end = end;
+    }
+    const auto hit_count = static_cast<uint32_t>(
+        std::count_if(hits_.begin(), hits_.end(), [](uint32_t h) { return h != 0; }));
+    put_varint(payload, hit_count);
+    uint32_t prev = 0;
+    for (uint32_t x = 0; x < kSpace; ++x) {
+        if (hits_[x] == 0) continue;
+        put_varint(payload, x - prev);
+        put_varint(payload, hits_[x]);
+        prev = x;
+    }
+
+    std::vector<uint8_t> out(std::begin(kMagic), std::end(kMagic));
+    out.push_back(kVersion);
+    out.push_back(0);
+    put_u32(out, runs_);
+    const auto name_len = static_cast<uint16_t>(std::min<std::size_t>(name_.size(), 0xFFFF));
+    put_u16(out, name_len);
+    out.insert(out.end(), name_.begin(), name_.begin() + name_len);
+    put_u32(out, static_cast<uint32_t>(payload.size()));
+    out.insert(out.end(), payload.begin(), payload.end());
+    put_u32(out, fnv1a32(payload));
+    return out;
+}
+
+bool CoverageMap::Deserialize(const std::vector<uint8_t>& bytes, std::string* error) {
+    auto fail = [&](const char* why) {
+        if (error) *error = why;
+        return false;
+    };
+    Reader in(bytes.data(), bytes.size());
+    const uint8_t* magic = nullptr;
+    if (!in.Bytes(sizeof(kMagic), magic) || !std::equal(magic, magic + sizeof(kMagic), kMagic))
+        return fail("not a coverage file");
+    uint8_t version = 0, reserved = 0;
+    if (!in.U8(version) || !in.U8(reserved)) return fail("truncated header");
+    if (version != kVersion) return fail("unsupported coverage file version");
+    uint32_t runs = 0, payload_size = 0, checksum = 0;
+    uint16_t name_len = 0;
+    const uint8_t* name = nullptr;
+    const uint8_t* payload = nullptr;
+    if (!in.U32(runs) || !in.U16(name_len) || !in.Bytes(name_len, name) ||
+        !in.U32(payload_size) || !in.Bytes(payload_size, payload) || !in.U32(checksum))
+        return fail("truncated file");
+    if (!in.AtEnd()) return fail("trailing bytes after checksum");
+    if (fnv1a32({payload, payload_size}) != checksum) return fail("checksum mismatch");
+
+    CoverageMap map;
+    Reader p(payload, payload_size);
+    uint32_t count = 0;
+    if (!p.Varint(count)) return fail("bad flag runs");
+    uint32_t at = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t gap = 0, len = 0;
+        const uint8_t* run = nullptr;
+        if (!p.Varint(gap) || !p.Varint(len) || at + gap + len > kSpace || !p.Bytes(len, run))
+            return fail("bad flag runs");
+        at += gap;
+        std::copy(run, run + len, map.flags_.begin() + at);
+        at += len;
+    }
+    if (!p.Varint(count)) return fail("bad hit counts");
+    at = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t delta = 0, hits = 0;
+        if (!p.Varint(delta) || !p.Varint(hits) || at + delta >= kSpace)
+            return fail("bad hit counts");
+        at += delta;
+        map.hits_[at] = hits;
+    }
+    if (!p.AtEnd()) return fail("trailing payload bytes");
+
+    map.runs_ = runs;
+    map.name_.assign(reinterpret_cast<const char*>(name), name_len);
+    *this = std::move(map);
+    return true;
+}
+
+bool CoverageMap::SaveToFile(const std::string& path) const {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) return false;
+    const std::vector<uint8_t> bytes = Serialize();
+    out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    return static_cast<bool>(out);
+}
+
+bool CoverageMap::LoadFromFile(const std::string& path, std::string* error) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        if (error) *error = "cannot open file";
+        return false;
+    }
+    const std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(in)),
+                                     std::istreambuf_iterator<char>());
+    return Deserialize(bytes, error);
+}
+
+CoverageMap CoverageMap::MergeFiles(const std::vector<std::string>& paths, unsigned jobs,
+                                    std::vector<std::string>* errors) {
+    if (jobs == 0) jobs = std::max(1u, std::thread::hardware_concurrency());
+    jobs = static_cast<unsigned>(std::min<std::size_t>(jobs, std::max<std::size_t>(paths.size(), 1)));
+
+    // Each worker reduces a strided share of the files into its own map, so the
+    // only shared state is the read-only path list; the partials are then
+    // folded together in worker order (deterministic for a given job count).
+    std::vector<CoverageMap> partial(jobs);
+    std::vector<std::vector<std::string>> failed(jobs);
+    auto work = [&](unsigned w) {
+        CoverageMap one;
+        std::string why;
+        for (std::size_t i = w; i < paths.size(); i += jobs) {
+            if (one.LoadFromFile(paths[i], &why)) partial[w].Merge(one);
+            else failed[w].push_back(paths[i] + ": " + why);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned w = 1; w < jobs; ++w) pool.emplace_back(work, w);
+    work(0);
+    for (std::thread& t : pool) t.join();
+
+    CoverageMap total;
+    for (unsigned w = 0; w < jobs; ++w) {
+        total.Merge(partial[w]);
+        if (errors) errors->insert(errors->end(), failed[w].begin(), failed[w].end());
+    }
+    return total;
+}
+
+// -- Export -------------------------------------------------------------------
+
+void CoverageMap::WriteLcov(std::ostream& out, const SymbolTable& symbols, const CoverageMap* code) const {
+    out << "TN:" << name_ << '\n';
+    std::string file = "0x0000";
+    std::vector<std::pair<uint16_t, uint32_t>> lines;   // (address, hits)
+    uint32_t first_line = 0;
+    auto flush = [&]() {
+        if (lines.empty()) return;
+        uint32_t hit = 0;
+        for (const auto& [addr, n] : lines) hit += n != 0;
+        out << "SF:" << file << '\n';
+        out << "FN:" << first_line << ',' << file << '\n';
+        out << "FNDA:" << hits_[first_line] << ',' << file << '\n';
+        out << "FNF:1\nFNH:" << (hits_[first_line] != 0 ? 1 : 0) << '\n';
+        for (const auto& [addr, n] : lines) out << "DA:" << addr << ',' << n << '\n';
+        out << "LF:" << lines.size() << "\nLH:" << hit << "\nend_of_record\n";
+        lines.clear();
+    };
+    for (uint32_t x = 0; x < kSpace; ++x) {
+        if (auto name = symbols.NameAt(static_cast<uint16_t>(x))) {
+            flush();
+            file.assign(*name);
+            first_line = x;
+        }
+        if ((flags_[x] | (code ? code->flags_[x] : 0)) & kExecOpcode)
+            lines.emplace_back(static_cast<uint16_t>(x), hits_[x]);
+    }
+    flush();
+}
+
+} // namespace z80::dbg
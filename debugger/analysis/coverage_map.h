@@ -0,0 +1,135 @@
+//
+// Z80 Digital Twin Debugger - CoverageMap
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// Execution coverage that outlives its DebugSession: the 64K CoverageFlag
+// array plus a per-address hit count (executions of each instruction start),
+// saved to a small ".cov" file so many runs of the same title -- different
+// input scripts, run in parallel -- can be combined afterwards.
+//
+// Maps combine as sets: Merge() is the union (flags OR'd, hits added),
+// Intersect() keeps code every run executed, and CodeOnlyIn() answers "what
+// did run B reach that run A never did?" as address ranges named from a
+// SymbolTable. MergeFiles() reduces hundreds of files on worker threads, and
+// WriteLcov() exports lcov tracefile records keyed by symbol.
+//
+// File format (little-endian):
+//   "Z80COV" u8 version u8 reserved | u32 runs | u16 name length, name bytes |
+//   u32 payload length | payload | u32 FNV-1a of payload.
+// The payload is LEB128 varints: the flags as (gap, length, bytes...) runs of
+// non-zero bytes, then the non-zero hit counts as (address delta, count) pairs.
+// Untouched memory therefore costs nothing; a typical ROM run is a few KB.
+//
+
+#ifndef Z80_DBG_COVERAGE_MAP_H
+#define Z80_DBG_COVERAGE_MAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace z80::dbg {
+
+class DebugSession;
+class SymbolTable;
+
+/// @brief A run of code bytes, labelled from the symbol table.
+struct CoverageRange {
+    uint16_t start = 0;
+    uint32_t end = 0;       ///< One past the last byte (<= 0x10000).
+    std::string label;      ///< "NAME" / "NAME+0x12" for start; empty if none.
+};
+
+class CoverageMap {
+public:
+    CoverageMap();
+
+    /// @brief Snapshot a session's coverage. Hit counts come from its profiler
+    ///        when that is counting (ProfileMode::Counters); otherwise each
+    ///        executed instruction start counts once.
+    static CoverageMap FromSession(const DebugSession& session, std::string name = {});
+
+    // -- Contents ------------------------------------------------------------
+
+    [[nodiscard]] uint8_t Flags(uint16_t address) const { return flags_[address]; }
+    [[nodiscard]] uint32_t Hits(uint16_t address) const { return hits_[address]; }
+    void Set(uint16_t address, uint8_t flags, uint32_t hits = 0) {
+        flags_[address] = flags;
+        hits_[address] = hits;
+    }
+
+    /// @brief Whether the byte executed as code (opcode or operand).
+    [[nodiscard]] bool Executed(uint16_t address) const;
+
+    /// @brief Bytes executed as code.
+    [[nodiscard]] uint32_t CodeBytes() const;
+
+    /// @brief Sessions combined into this map (1 for a snapshot, 0 if empty).
+    [[nodiscard]] uint32_t Runs() const noexcept { return runs_; }
+
+    /// @brief Free-form label (program / script name) stored in the file.
+    [[nodiscard]] const std::string& Name() const noexcept { return name_; }
+    void SetName(std::string name) { name_ = std::move(name); }
+
+    // -- Set operations ------------------------------------------------------
+
+    /// @brief Union: flags OR'd, hits added (saturating).
+    void Merge(const CoverageMap& other);
+
+    /// @brief Keep only code @p other also executed; hits become the smaller
+    ///        of the two.
+    void Intersect(const CoverageMap& other);
+
+    /// @brief Code bytes executed in @p b but never in @p a, as maximal ranges
+    ///        labelled from @p symbols (if given).
+    [[nodiscard]] static std::vector<CoverageRange> CodeOnlyIn(const CoverageMap& b,
+                                                               const CoverageMap& a,
+                                                               const SymbolTable* symbols = nullptr);
+
+    // -- Persistence ---------------------------------------------------------
+
+    [[nodiscard]] std::vector<uint8_t> Serialize() const;
+
+    /// @brief Replace this map with a serialized one.
+    /// @return false (with @p error set, if given) on a malformed or corrupt
+    ///         image; the map is left unchanged.
+    bool Deserialize(const std::vector<uint8_t>& bytes, std::string* error = nullptr);
+
+    /// @return false if the file cannot be written.
+    bool SaveToFile(const std::string& path) const;
+
+    /// @return false if the file cannot be read or is not a valid .cov file.
+    bool LoadFromFile(const std::string& path, std::string* error = nullptr);
+
+    /// @brief Load and union @p paths on @p jobs worker threads (0 = hardware
+    ///        concurrency). Files that fail to load are skipped and reported in
+    ///        @p errors as "path: reason".
+    static CoverageMap MergeFiles(const std::vector<std::string>& paths, unsigned jobs = 0,
+                                  std::vector<std::string>* errors = nullptr);
+
+    // -- Export --------------------------------------------------------------
+
+    /// @brief Write lcov tracefile records, one per symbol: the symbol is the
+    ///        source file (SF) and its function (FN/FNDA), each instruction
+    ///        start is a line (DA:address,hits). Code before the first symbol
+    ///        is grouped under "0x0000".
+    /// @param code  The known code, usually the union of every run: its
+    ///              instruction starts that this map never executed are
+    ///              listed with 0 hits. Without it only executed lines are
+    ///              listed, so every record reads as fully covered.
+    void WriteLcov(std::ostream& out, const SymbolTable& symbols, const CoverageMap* code = nullptr) const;
+
+private:
+    std::vector<uint8_t> flags_;     ///< 64K CoverageFlag bits.
+    std::vector<uint32_t> hits_;     ///< 64K executions per instruction start.
+    uint32_t runs_ = 0;
+    std::string name_;
+};
+
+} // namespace z80::dbg
+
+#endif // Z80_DBG_COVERAGE_MAP_H
@@ -0,0 +1,116 @@
+//
+// Z80 Digital Twin Debugger - HotspotProfiler implementation
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+
+#include "hotspot_profiler.h"
+#include "control_flow_graph.h"
+#include "symbol_table.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace z80::dbg {
+namespace {
+
+// How far back a report label may reach for a symbol ("NAME+0xNN").
+constexpr uint32_t kLabelReach = 0x100;
+
+std::string label_for(const SymbolTable& symbols, uint16_t address) {
+    for (uint32_t back = 0; back < kLabelReach && back <= address; ++back) {
+        const auto name = symbols.NameAt(static_cast<uint16_t>(address - back));
+        if (!name) continue;
+        if (back == 0) return std::string(*name);
+        char offset[16];
+        std::snprintf(offset, sizeof(offset), "+0x%X", back);
+        return std::string(*name) + offset;
+    }
+    return {};
+}
+
+} // namespace
+
+const char* ToString(HeatSource source) {
+    switch (source) {
+        case HeatSource::Exec:    return "exec";
+        case HeatSource::Read:    return "read";
+        case HeatSource::Write:   return "write";
+        case HeatSource::Samples: return "samples";
+    }
+    return "exec";
+}
+
+HotspotProfiler::HotspotProfiler()
+    : exec_(65536, 0), reads_(65536, 0), writes_(65536, 0), samples_(65536, 0) {}
+
+void HotspotProfiler::SetMode(ProfileMode mode, uint64_t now) noexcept {
+    mode_ = mode;
+    next_sample_ = now + interval_;
+}
+
+void HotspotProfiler::Clear(uint64_t now) {
+    std::fill(exec_.begin(), exec_.end(), 0u);
+    std::fill(reads_.begin(), reads_.end(), 0u);
+    std::fill(writes_.begin(), writes_.end(), 0u);
+    std::fill(samples_.begin(), samples_.end(), 0u);
+    instructions_ = 0;
+    samples_total_ = 0;
+    next_sample_ = now + interval_;
+}
+
+const std::vector<uint32_t>& HotspotProfiler::Table(HeatSource source) const {
+    switch (source) {
+        case HeatSource::Exec:    return exec_;
+        case HeatSource::Read:    return reads_;
+        case HeatSource::Write:   return writes_;
+        case HeatSource::Samples: return samples_;
+    }
+    return exec_;
+}
+
+uint32_t HotspotProfiler::Peak(HeatSource source) const {
+    const std::vector<uint32_t>& t = Table(source);
+    return *std::max_element(t.begin(), t.end());
+}
+
+std::vector<HotSpot> HotspotProfiler::HottestCode(std::size_t n, const ControlFlowGraph* cfg,
+                                                  const SymbolTable* symbols) const {
+    const bool exact = instructions_ != 0;
+    const std::vector<uint32_t>& weights = exact ? exec_ : samples_;
+    const uint64_t total = exact ? instructions_ : samples_total_;
+
+    // Blocks are contiguous, so one address-ordered pass groups them.
+    std::vector<HotSpot> spots;
+    for (uint32_t a = 0; a < 0x10000; ++a) {
+        const uint32_t w = weights[a];
+        if (w == 0) continue;
+        uint16_t start = static_cast<uint16_t>(a);
+        uint32_t end = a + 1;
+        if (cfg) {
+            if (auto block = cfg->BlockAt(static_cast<uint16_t>(a))) {
+                start = block->start;
+                end = block->end;
+            }
+        }
+        if (!spots.empty() && spots.back().start == start && spots.back().end == end) {
+            spots.back().hits += w;
+            continue;
+        }
+        spots.push_back(HotSpot{start, end, w, 0.0, {}});
+    }
+
+    n = std::min(n, spots.size());
+    std::partial_sort(spots.begin(), spots.begin() + static_cast<std::ptrdiff_t>(n), spots.end(),
+                      [](const HotSpot& x, const HotSpot& y) {
+                          return x.hits != y.hits ? x.hits > y.hits : x.start < y.start;
+                      });
+    spots.resize(n);
+    for (HotSpot& s : spots) {
+        s.percent = total ? 100.0 * static_cast<double>(s.hits) / static_cast<double>(total) : 0.0;
+        if (symbols) s.label = label_for(*symbols, s.start);
+    }
+    return spots;
+}
+
+} // namespace z80::dbg
@@ -0,0 +1,155 @@
+//
+// Z80 Digital Twin Debugger - HotspotProfiler
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// Where does the program spend its time, and what memory does it touch? The
+// profiler keeps flat 64K tables fed by the DebugSession while it is enabled:
+//
+//   * Counters mode: an exact 32-bit execution count per instruction start, and
+//     read / write counts per byte. Reads come from ObservableMemory's opt-in
+//     read counter; the bytes of each executed instruction are then taken back
+//     off, so the read table holds data reads only (operand fetches excluded).
+//   * Sampling mode: the PC of the instruction in flight is recorded once every
+//     N T-states. It costs one compare per instruction and leaves memory
+//     accesses alone, so it can stay on during long runs.
+//
+// Both feed the memory panel's heatmap (Count()/Peak()) and HottestCode(), a
+// ranked report that groups counts by CFG basic block and names each with the
+// nearest symbol. Profiling is off by default; no table is touched until a
+// mode is chosen.
+//
+
+#ifndef Z80_DBG_HOTSPOT_PROFILER_H
+#define Z80_DBG_HOTSPOT_PROFILER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace z80::dbg {
+
+class ControlFlowGraph;
+class SymbolTable;
+
+/// @brief What the profiler records.
+enum class ProfileMode : uint8_t {
+    Off,        ///< Nothing is recorded (the default).
+    Counters,   ///< Exact per-address execution, read and write counts.
+    Sampling,   ///< The executing PC, once every SampleInterval() T-states.
+};
+
+/// @brief Which table a heatmap or report reads.
+enum class HeatSource : uint8_t {
+    Exec,       ///< Executions per instruction start (Counters).
+    Read,       ///< Data reads per byte (Counters).
+    Write,      ///< Writes per byte, refused ROM writes included (Counters).
+    Samples,    ///< PC samples per instruction start (Sampling).
+};
+
+/// @brief Display name for a HeatSource ("exec", "read", ...).
+const char* ToString(HeatSource source);
+
+/// @brief One row of the hottest-code report.
+struct HotSpot {
+    uint16_t start = 0;       ///< Block (or instruction) start.
+    uint32_t end = 0;         ///< One past its last byte (<= 0x10000).
+    uint64_t hits = 0;        ///< Instructions executed / samples taken in it.
+    double percent = 0.0;     ///< Share of all hits.
+    std::string label;        ///< "NAME" or "NAME+0x12"; empty without a symbol.
+};
+
+class HotspotProfiler {
+public:
+    static constexpr uint32_t kDefaultSampleInterval = 1000;   ///< T-states.
+
+    HotspotProfiler();
+
+    // -- Control -------------------------------------------------------------
+
+    /// @brief Switch mode. @p now (the CPU's T-state count) arms the first
+    ///        sample one interval ahead. Recorded tables are kept.
+    void SetMode(ProfileMode mode, uint64_t now = 0) noexcept;
+    [[nodiscard]] ProfileMode Mode() const noexcept { return mode_; }
+
+    /// @brief T-states between samples (clamped to >= 1).
+    void SetSampleInterval(uint32_t tstates) noexcept {
+        interval_ = tstates == 0 ? 1 : tstates;
+    }
+    [[nodiscard]] uint32_t SampleInterval() const noexcept { return interval_; }
+
+    /// @brief Zero every table and re-arm sampling from @p now.
+    void Clear(uint64_t now = 0);
+
+    // -- Recording (driven by the DebugSession) ------------------------------
+
+    /// @brief One instruction of @p length bytes ran from @p pc; the T-state
+    ///        count is now @p cycle.
+    void OnInstruction(uint16_t pc, uint8_t length, uint64_t cycle) noexcept {
+        if (mode_ == ProfileMode::Counters) {
+            ++exec_[pc];
+            ++instructions_;
+            // Its own bytes were fetched through the read counter; take them
+            // back off so the table holds data reads only.
+            for (uint8_t i = 0; i < length; ++i) {
+                uint32_t& r = reads_[static_cast<uint16_t>(pc + i)];
+                if (r != 0) --r;
+            }
+        } else if (mode_ == ProfileMode::Sampling && cycle >= next_sample_) {
+            const uint64_t due = (cycle - next_sample_) / interval_ + 1;
+            samples_[pc] += static_cast<uint32_t>(due);
+            samples_total_ += due;
+            next_sample_ += due * interval_;
+        }
+    }
+
+    /// @brief A write (committed or refused) reached @p address.
+    void OnWrite(uint16_t address) noexcept {
+        if (mode_ == ProfileMode::Counters) ++writes_[address];
+    }
+
+    /// @brief The table ObservableMemory counts every bus read into.
+    [[nodiscard]] uint32_t* ReadCounterTable() noexcept { return reads_.data(); }
+
+    // -- Queries -------------------------------------------------------------
+
+    [[nodiscard]] uint32_t Count(HeatSource source, uint16_t address) const {
+        return Table(source)[address];
+    }
+
+    /// @brief Largest count in a table (heatmap scale). Scans 64K entries.
+    [[nodiscard]] uint32_t Peak(HeatSource source) const;
+
+    /// @brief Instructions counted / samples taken so far.
+    [[nodiscard]] uint64_t Instructions() const noexcept { return instructions_; }
+    [[nodiscard]] uint64_t Samples() const noexcept { return samples_total_; }
+
+    /// @brief The @p n hottest pieces of code, hottest first. Exact counts are
+    ///        used when any were recorded, samples otherwise. With @p cfg,
+    ///        counts are summed per live basic block; without it (or for code
+    ///        no longer in a block) per instruction. @p symbols, if given,
+    ///        labels each row with the nearest symbol at or before its start.
+    [[nodiscard]] std::vector<HotSpot> HottestCode(std::size_t n,
+                                                   const ControlFlowGraph* cfg = nullptr,
+                                                   const SymbolTable* symbols = nullptr) const;
+
+private:
+    [[nodiscard]] const std::vector<uint32_t>& Table(HeatSource source) const;
+
+    ProfileMode mode_ = ProfileMode::Off;
+    uint32_t interval_ = kDefaultSampleInterval;
+    uint64_t next_sample_ = 0;     ///< T-state of the next sample.
+
+    // Per-address tables (64K each).
+    std::vector<uint32_t> exec_;
+    std::vector<uint32_t> reads_;
+    std::vector<uint32_t> writes_;
+    std::vector<uint32_t> samples_;
+    uint64_t instructions_ = 0;
+    uint64_t samples_total_ = 0;
+};
+
+} // namespace z80::dbg
+
+#endif // Z80_DBG_HOTSPOT_PROFILER_H
@@ -0,0 +1,163 @@
+//
+// Z80 Digital Twin Debugger - MemoryScanner implementation
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// The kernels are plain loops the compiler vectorises: for each 64-address
+// bitmap word, compare into 64 0/1 bytes, then pack each group of eight into
+// bits with one multiply ((x * 0x0102040810204080) >> 56 gathers byte i's low
+// bit into bit i; the partial products never overlap, so nothing carries).
+//
+
+#include "memory_scanner.h"
+#include "debug_session.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace z80::dbg {
+namespace {
+
+constexpr std::size_t kSpace = 65536;
+
+template <class Value>
+inline Value load(const uint8_t* p) {
+    if constexpr (sizeof(Value) == 1) return *p;
+    else return static_cast<Value>(p[0] | p[1] << 8);
+}
+
+inline uint64_t pack(const uint8_t* hits) {
+    uint64_t out = 0;
+    for (int k = 0; k < 8; ++k) {
+        uint64_t x;
+        std::memcpy(&x, hits + 8 * k, sizeof(x));
+        out |= ((x * 0x0102040810204080ull) >> 56) << (8 * k);
+    }
+    return out;
+}
+
+// Branch-free compare of 64 consecutive addresses.
+template <class Value, class Pred>
+inline uint64_t match64(const uint8_t* cur, const uint8_t* prev, Pred pred) {
+    alignas(8) uint8_t hits[64];
+    for (int i = 0; i < 64; ++i)
+        hits[i] = static_cast<uint8_t>(pred(load<Value>(cur + i), load<Value>(prev + i)));
+    return pack(hits);
+}
+
+template <class Value, class Pred>
+std::size_t refine(std::vector<uint64_t>& bits, const uint8_t* cur, const uint8_t* prev,
+                   Pred pred) {
+    std::size_t count = 0;
+    for (std::size_t w = 0; w < bits.size(); ++w) {
+        if (bits[w] == 0) continue;   // nothing left here: skip the compare
+        bits[w] &= match64<Value>(cur + w * 64, prev + w * 64, pred);
+        count += static_cast<std::size_t>(std::popcount(bits[w]));
+    }
+    return count;
+}
+
+template <class Value>
+std::size_t refine_op(std::vector<uint64_t>& bits, const uint8_t* cur, const uint8_t* prev,
+                      ScanOp op, uint16_t operand) {
+    const auto k = static_cast<Value>(operand);
+    switch (op) {
+        case ScanOp::Equal:
+            return refine<Value>(bits, cur, prev, [k](Value n, Value) { return n == k; });
+        case ScanOp::Changed:
+            return refine<Value>(bits, cur, prev, [](Value n, Value o) { return n != o; });
+        case ScanOp::Unchanged:
+            return refine<Value>(bits, cur, prev, [](Value n, Value o) { return n == o; });
+        case ScanOp::Increased:
+            return refine<Value>(bits, cur, prev, [](Value n, Value o) { return n > o; });
+        case ScanOp::Decreased:
+            return refine<Value>(bits, cur, prev, [](Value n, Value o) { return n < o; });
+        case ScanOp::ChangedBy:
+            return refine<Value>(bits, cur, prev,
+                                 [k](Value n, Value o) { return static_cast<Value>(n - o) == k; });
+    }
+    return 0;
+}
+
+} // namespace
+
+const char* ToString(ScanOp op) {
+    switch (op) {
+        case ScanOp::Equal:     return "equal";
+        case ScanOp::Changed:   return "changed";
+        case ScanOp::Unchanged: return "unchanged";
+        case ScanOp::Increased: return "increased";
+        case ScanOp::Decreased: return "decreased";
+        case ScanOp::ChangedBy: return "changed by";
+    }
+    return "equal";
+}
+
+MemoryScanner::MemoryScanner()
+    : bits_(kWords, 0), snapshot_(kSpace + 1, 0), next_(kSpace + 1, 0) {}
+
+void MemoryScanner::Capture(std::span<const uint8_t> image, std::vector<uint8_t>& out) {
+    const std::size_t n = std::min(image.size(), kSpace);
+    std::copy_n(image.begin(), n, out.begin());
+    std::fill(out.begin() + static_cast<std::ptrdiff_t>(n), out.begin() + kSpace, uint8_t{0});
+    out[kSpace] = out[0];
+}
+
+void MemoryScanner::Capture(const DebugSession& session, std::vector<uint8_t>& out) {
+    for (uint32_t a = 0; a < kSpace; ++a)
+        out[a] = session.Cpu().ReadMemory(static_cast<uint16_t>(a));
+    out[kSpace] = out[0];
+}
+
+void MemoryScanner::Start(std::span<const uint8_t> image, ScanWidth width,
+                          uint16_t lo, uint16_t hi) {
+    Capture(image, snapshot_);
+    width_ = width;
+    std::fill(bits_.begin(), bits_.end(), 0);
+    count_ = 0;
+    for (uint32_t a = lo; a <= hi; ++a) {
+        bits_[a >> 6] |= uint64_t{1} << (a & 63);
+        ++count_;
+    }
+    steps_ = 0;
+    started_ = true;
+}
+
+void MemoryScanner::Start(const DebugSession& session, ScanWidth width,
+                          uint16_t lo, uint16_t hi) {
+    Capture(session, next_);
+    Start(std::span<const uint8_t>(next_.data(), kSpace), width, lo, hi);
+}
+
+std::size_t MemoryScanner::Refine(std::span<const uint8_t> image, ScanOp op, uint16_t operand) {
+    Capture(image, next_);
+    return RefineCaptured(op, operand);
+}
+
+std::size_t MemoryScanner::Refine(const DebugSession& session, ScanOp op, uint16_t operand) {
+    Capture(session, next_);
+    return RefineCaptured(op, operand);
+}
+
+std::size_t MemoryScanner::RefineCaptured(ScanOp op, uint16_t operand) {
+    if (!started_) return 0;
+    count_ = width_ == ScanWidth::Byte
+                 ? refine_op<uint8_t>(bits_, next_.data(), snapshot_.data(), op, operand)
+                 : refine_op<uint16_t>(bits_, next_.data(), snapshot_.data(), op, operand);
+    snapshot_.swap(next_);
+    ++steps_;
+    return count_;
+}
+
+std::vector<uint16_t> MemoryScanner::Candidates(std::size_t max) const {
+    std::vector<uint16_t> out;
+    out.reserve(std::min(max, count_));
+    for (std::size_t w = 0; w < kWords && out.size() < max; ++w) {
+        for (uint64_t m = bits_[w]; m != 0 && out.size() < max; m &= m - 1)
+            out.push_back(static_cast<uint16_t>(w * 64 + static_cast<std::size_t>(std::countr_zero(m))));
+    }
+    return out;
+}
+
+} // namespace z80::dbg
@@ -0,0 +1,123 @@
+//
+// Z80 Digital Twin Debugger - MemoryScanner
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// A cheat-finder style value scanner: find where a program keeps a variable
+// (lives, score, a tape counter) by taking successive RAM snapshots and
+// narrowing a candidate set with predicates -- "equal to 3", "changed",
+// "unchanged", "increased", "decreased", "changed by -1" -- in 8- or 16-bit
+// (little-endian) mode.
+//
+// Candidates are a 64K-bit bitmap, not a list of addresses, and each refinement
+// is one pass of branch-free compare kernels over the image: 64 addresses per
+// bitmap word, results packed to bits with a multiply. Words with no candidates
+// left are skipped, so the passes get cheaper as the set shrinks. A full pass is
+// well under a millisecond, so a live machine can refine every frame.
+//
+
+#ifndef Z80_DBG_MEMORY_SCANNER_H
+#define Z80_DBG_MEMORY_SCANNER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace z80::dbg {
+
+class DebugSession;
+
+/// @brief Width of the value at each candidate address.
+enum class ScanWidth : uint8_t {
+    Byte,   ///< The byte at the address.
+    Word,   ///< The little-endian word at address, address+1 (wrapping).
+};
+
+/// @brief How a refinement compares the new snapshot with the previous one.
+enum class ScanOp : uint8_t {
+    Equal,       ///< New value == operand.
+    Changed,     ///< New value != previous.
+    Unchanged,   ///< New value == previous.
+    Increased,   ///< New value > previous (unsigned).
+    Decreased,   ///< New value < previous (unsigned).
+    ChangedBy,   ///< New value - previous == operand (wrapping; -1 = 0xFF/0xFFFF).
+};
+
+/// @brief Display name for a ScanOp ("equal", "changed", ...).
+const char* ToString(ScanOp op);
+
+class MemoryScanner {
+public:
+    MemoryScanner();
+
+    /// @brief Begin a new scan: every address in [lo, hi] is a candidate and
+    ///        @p image (64K bytes) is the baseline snapshot.
+    void Start(std::span<const uint8_t> image, ScanWidth width,
+               uint16_t lo = 0x0000, uint16_t hi = 0xFFFF);
+    void Start(const DebugSession& session, ScanWidth width,
+               uint16_t lo = 0x0000, uint16_t hi = 0xFFFF);
+
+    /// @brief Keep the candidates whose value in @p image satisfies @p op
+    ///        against the previous snapshot (or @p operand); @p image becomes
+    ///        the new baseline.
+    /// @return Candidates left.
+    std::size_t Refine(std::span<const uint8_t> image, ScanOp op, uint16_t operand = 0);
+    std::size_t Refine(const DebugSession& session, ScanOp op, uint16_t operand = 0);
+
+    /// @brief Drop one address from the set (e.g. a known false positive).
+    void Exclude(uint16_t address) {
+        if (!IsCandidate(address)) return;
+        bits_[address >> 6] &= ~(uint64_t{1} << (address & 63));
+        --count_;
+    }
+
+    // -- Queries -------------------------------------------------------------
+
+    [[nodiscard]] bool Started() const noexcept { return started_; }
+    [[nodiscard]] ScanWidth Width() const noexcept { return width_; }
+    [[nodiscard]] std::size_t Count() const noexcept { return count_; }
+
+    [[nodiscard]] bool IsCandidate(uint16_t address) const {
+        return (bits_[address >> 6] >> (address & 63)) & 1u;
+    }
+
+    /// @brief The value at @p address in the latest snapshot (per Width()).
+    [[nodiscard]] uint16_t ValueAt(uint16_t address) const {
+        return width_ == ScanWidth::Byte
+                   ? snapshot_[address]
+                   : static_cast<uint16_t>(snapshot_[address] | snapshot_[address + 1u] << 8);
+    }
+
+    /// @brief Candidate addresses in ascending order, at most @p max of them.
+    [[nodiscard]] std::vector<uint16_t> Candidates(std::size_t max = SIZE_MAX) const;
+
+    /// @brief The candidate bitmap: bit (a & 63) of word (a >> 6) is address a.
+    [[nodiscard]] std::span<const uint64_t> Bitmap() const noexcept { return bits_; }
+
+    /// @brief Refinements since Start().
+    [[nodiscard]] unsigned Steps() const noexcept { return steps_; }
+
+private:
+    static constexpr std::size_t kWords = 65536 / 64;
+
+    /// @brief Copy @p image into @p out, repeating byte 0 at the end so a word
+    ///        read at 0xFFFF wraps like the Z80's address bus.
+    static void Capture(std::span<const uint8_t> image, std::vector<uint8_t>& out);
+    static void Capture(const DebugSession& session, std::vector<uint8_t>& out);
+
+    /// @brief Refine against next_ (already captured), then swap it in.
+    std::size_t RefineCaptured(ScanOp op, uint16_t operand);
+
+    ScanWidth width_ = ScanWidth::Byte;
+    std::vector<uint64_t> bits_;        ///< Candidate bitmap (1024 words).
+    std::vector<uint8_t> snapshot_;     ///< Baseline image (65536 + 1 wrap byte).
+    std::vector<uint8_t> next_;         ///< Image being compared (same layout).
+    std::size_t count_ = 0;
+    unsigned steps_ = 0;
+    bool started_ = false;
+};
+
+} // namespace z80::dbg
+
+#endif // Z80_DBG_MEMORY_SCANNER_H
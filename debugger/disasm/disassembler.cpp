@@ -66,7 +66,7 @@ std::string hex16(uint16_t v) { return std::format("0x{:04X}", v); }
 
 std::string addr(uint16_t a, const SymbolResolver& resolve) {
     if (resolve) {
-        if (auto label = resolve(a)) return *label;
+        if (auto label = resolve(a)) return std::string(*label);
     }
     return hex16(a);
 }
@@ -323,9 +323,9 @@ Instruction Disassembler::Decode(const ByteReader& read, uint16_t address,
     std::vector<std::string> used;
     SymbolResolver recording;
     if (resolve) {
-        recording = [&used, &resolve](uint16_t a) -> std::optional<std::string> {
+        recording = [&used, &resolve](uint16_t a) -> std::optional<std::string_view> {
             auto name = resolve(a);
-            if (name) used.push_back(*name);
+            if (name) used.emplace_back(*name);
             return name;
         };
     }
@@ -352,4 +352,21 @@ Instruction Disassembler::Decode(const ByteReader& read, uint16_t address,
     return out;
 }
 
+FlowKind ClassifyFlow(const Instruction& ins) {
+    const std::string_view m = ins.mnemonic;
+    const bool conditional = ins.operands.find(',') != std::string::npos;
+    if (m == "JP" || m == "JR") return conditional ? FlowKind::CondJump : FlowKind::Jump;
+    if (m == "DJNZ") return FlowKind::CondJump;
+    if (m == "CALL") return conditional ? FlowKind::CondCall : FlowKind::Call;
+    if (m == "RST") return FlowKind::Call;
+    if (m == "RET") return ins.operands.empty() ? FlowKind::Return : FlowKind::CondReturn;
+    if (m == "RETI" || m == "RETN") return FlowKind::Return;
+    if (m == "HALT") return FlowKind::Halt;
+    // Block repeats loop by re-executing themselves: a conditional self-branch.
+    if (m == "LDIR" || m == "LDDR" || m == "CPIR" || m == "CPDR" ||
+        m == "INIR" || m == "INDR" || m == "OTIR" || m == "OTDR")
+        return FlowKind::CondJump;
+    return FlowKind::Sequential;
+}
+
 } // namespace z80::dbg
@@ -23,6 +23,7 @@
 #include <functional>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace z80::dbg {
@@ -30,8 +31,10 @@ namespace z80::dbg {
 /// @brief Reads one byte of program memory at a 16-bit address (wraps at 64K).
 using ByteReader = std::function<uint8_t(uint16_t)>;
 
-/// @brief Maps an absolute address to a label, or nullopt for "no symbol".
-using SymbolResolver = std::function<std::optional<std::string>(uint16_t)>;
+/// @brief Maps an absolute address to a label, or nullopt for "no symbol". The
+///        view must stay valid for the duration of the Decode() call (the symbol
+///        table hands out views into its interned name pool).
+using SymbolResolver = std::function<std::optional<std::string_view>(uint16_t)>;
 
 /// @brief A decoded instruction.
 struct Instruction {
@@ -45,6 +48,21 @@ struct Instruction {
     std::optional<uint16_t> branch_target;  ///< Static target of a direct JP/JR/CALL/DJNZ/RST.
 };
 
+/// @brief Control-flow shape of an instruction (how execution may leave it).
+enum class FlowKind : uint8_t {
+    Sequential,  ///< Always continues at the next instruction.
+    Jump,        ///< JP/JR/JP (rr): never falls through.
+    CondJump,    ///< JP cc/JR cc/DJNZ and the repeating block ops (LDIR, ...).
+    Call,        ///< CALL/RST.
+    CondCall,    ///< CALL cc.
+    Return,      ///< RET/RETI/RETN.
+    CondReturn,  ///< RET cc.
+    Halt,        ///< HALT: waits for an interrupt, then resumes after it.
+};
+
+/// @brief Classify a decoded instruction's control flow.
+[[nodiscard]] FlowKind ClassifyFlow(const Instruction& ins);
+
 class Disassembler {
 public:
     /// @brief Decode the instruction beginning at @p address.
@@ -26,6 +26,7 @@ DebugSession::DebugSession(DebugCPU& cpu) : cpu_(cpu) {
 DebugSession::~DebugSession() {
     cpu_.GetMemory().RemoveWriteObserver(write_observer_id_);
     cpu_.GetMemory().RemoveBlockedWriteObserver(blocked_observer_id_);
+    if (profiler_.Mode() == ProfileMode::Counters) cpu_.GetMemory().SetReadCounter(nullptr);
 }
 
 void DebugSession::OnBlockedWrite(uint16_t address, uint8_t current_value,
@@ -34,6 +35,7 @@ void DebugSession::OnBlockedWrite(uint16_t address, uint8_t current_value,
     // Record it as its own category — it resembles SMC but is semantically
     // different (read-only memory, not self-modifying code).
     coverage_[address] |= kBlockedWrite;
+    profiler_.OnWrite(address);
     ++blocked_total_;
     if (blocked_writes_.size() < kMaxSmcEvents) {
         blocked_writes_.push_back({address, current_value, attempted_value,
@@ -44,6 +46,8 @@ void DebugSession::OnBlockedWrite(uint16_t address, uint8_t current_value,
 void DebugSession::OnMemoryWrite(uint16_t address, uint8_t old_value,
                                  uint8_t new_value) {
     dirty_.insert(address);
+    cfg_.Invalidate(address);   // O(1) unless the byte is known code
+    profiler_.OnWrite(address);
     if (watchpoints_.find(address) != watchpoints_.end()) {
         watch_hit_ = address;
     }
@@ -76,6 +80,17 @@ void DebugSession::ExecuteOneInstruction() {
     current_instruction_pc_ = cpu_.PC();
     RecordCoverage(current_instruction_pc_);
     StepRaw();
+    cfg_.Record(current_instruction_pc_, cpu_.PC(), reader_);
+    if (profiler_.Mode() != ProfileMode::Off)
+        profiler_.OnInstruction(current_instruction_pc_,
+                                cfg_.InstructionLength(current_instruction_pc_),
+                                cpu_.GetCycleCount());
+}
+
+void DebugSession::SetProfileMode(ProfileMode mode) {
+    profiler_.SetMode(mode, cpu_.GetCycleCount());
+    cpu_.GetMemory().SetReadCounter(mode == ProfileMode::Counters
+                                        ? profiler_.ReadCounterTable() : nullptr);
 }
 
 void DebugSession::StepRaw() {
@@ -291,6 +306,8 @@ void DebugSession::Reset() {
     blocked_writes_.clear();
     blocked_total_ = 0;
     smc_break_pending_ = false;
+    cfg_.Clear();
+    profiler_.Clear(cpu_.GetCycleCount());
 }
 
 void DebugSession::AddBreakpoint(uint16_t address, bool temporary) {
@@ -23,6 +23,8 @@
 #include "io/observable_io.h"
 #include "io/callback_io.h"
 #include "disassembler.h"
+#include "control_flow_graph.h"
+#include "hotspot_profiler.h"
 
 #include <array>
 #include <cstdint>
@@ -215,6 +217,29 @@ public:
     /// @brief Total refused writes to protected memory.
     [[nodiscard]] uint64_t BlockedWriteCount() const noexcept { return blocked_total_; }
 
+    // -- Control-flow graph (built live from executed instructions) ----------
+
+    /// @brief Basic blocks, edges and entry points observed so far. Kept current
+    ///        by every executed instruction; code overwritten by SMC drops out
+    ///        and is rebuilt when it next runs. Cleared by Reset().
+    [[nodiscard]] const ControlFlowGraph& Cfg() const noexcept { return cfg_; }
+
+    // -- Hot-spot profiling (off by default) ---------------------------------
+
+    /// @brief Choose what the profiler records. Counters mode also counts data
+    ///        reads through the memory plug; Off and Sampling leave reads alone.
+    void SetProfileMode(ProfileMode mode);
+    [[nodiscard]] ProfileMode GetProfileMode() const noexcept { return profiler_.Mode(); }
+
+    /// @brief T-states between PC samples in Sampling mode.
+    void SetSampleInterval(uint32_t tstates) noexcept { profiler_.SetSampleInterval(tstates); }
+
+    /// @brief Zero the profile (Reset() also does).
+    void ClearProfile() { profiler_.Clear(cpu_.GetCycleCount()); }
+
+    /// @brief Per-address counts / samples for heatmaps and the hot-code report.
+    [[nodiscard]] const HotspotProfiler& Profiler() const noexcept { return profiler_; }
+
     /// @brief Pause the run when code is overwritten.
     void SetBreakOnSmc(bool on) noexcept { break_on_smc_ = on; }
     [[nodiscard]] bool BreakOnSmc() const noexcept { return break_on_smc_; }
@@ -276,6 +301,8 @@ private:
     std::vector<BlockedWrite> blocked_writes_;///< Refused writes to protected memory (capped).
     uint64_t blocked_total_ = 0;              ///< Total refused writes detected.
     uint16_t current_instruction_pc_ = 0;     ///< PC of the instruction now executing.
+    ControlFlowGraph cfg_;                    ///< Live CFG from execution evidence.
+    HotspotProfiler profiler_;                ///< Exec/read/write counts, PC samples.
     bool break_on_smc_ = false;
     bool smc_break_pending_ = false;          ///< Set by the hook to stop a slice.
     static constexpr std::size_t kMaxSmcEvents = 8192;
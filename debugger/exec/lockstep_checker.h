@@ -0,0 +1,554 @@
+//
+// Z80 Digital Twin Debugger - LockstepChecker
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// LockstepChecker runs a candidate CPU engine and a reference CPUImpl side by
+// side and reports the first instruction on which they disagree. The
+// candidate is whatever a machine runs — its bulk RunUntilCycle() path, with
+// superinstructions, other traits or another memory/I/O policy; the reference
+// is the plain Step() interpreter over ObservableMemory, so the checker tests
+// the fast paths against the one every other test has checked.
+//
+// The candidate runs first and the reference follows over the same code. The
+// devices have already answered the candidate, so the reference gets its I/O
+// replayed (ReplayIo) from the candidate's ObservableIo transaction log; a
+// candidate without one is taken to sit on an open bus.
+//
+// Work is checked in blocks of T-states:
+//   * interval 0 — after every instruction, registers (and the I/O done) are
+//     compared; memory at the end of each kInstructionBlock T-states;
+//   * interval N — the candidate runs N T-states at full speed, then the
+//     reference catches up and registers and all 64 KB are compared;
+//   * sample S   — only one block in S is checked; the others run unchecked,
+//     at the candidate's own speed (the reference is re-synced from the
+//     candidate before the next checked one).
+// A checked block starts and ends on an instruction boundary: a partly run
+// prefix left by the caller's last budget is finished first. With interval 0
+// the candidate runs one instruction per RunUntilCycle() call, so an idiom it
+// fuses (a superinstruction) runs as its parts; interval N exercises it whole.
+//
+// On a mismatch the block is replayed from its start, bisecting over the
+// reference's instruction boundaries with the candidate run the same way, to
+// find the first instruction after which the two differ. The report gives its
+// address, disassembly and the state difference. Afterwards the candidate is
+// put back as the failed block left it, so the run carries on as if unchecked
+// (its devices do see the replayed I/O again), and checking stops.
+//
+// Run() is a stepper for Machine::RunFrame / SpectrumMachine::run_frame_with
+// and CpmMachine::run_until_with: `uint64_t(uint64_t tstates)`, stopping early
+// on HALT like RunUntilCycle(). The candidate must outlive the checker.
+//
+
+#ifndef Z80_DBG_LOCKSTEP_CHECKER_H
+#define Z80_DBG_LOCKSTEP_CHECKER_H
+
+#include "z80_cpu.h"
+#include "memory/observable_memory.h"
+#include "io/replay_io.h"
+#include "disassembler.h"
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace z80::dbg {
+
+/// @brief How closely a LockstepChecker follows the candidate.
+struct LockstepOptions {
+    /// T-states per checked block. 0: compare registers after every
+    /// instruction (memory every kInstructionBlock T-states).
+    uint64_t interval = 0;
+    /// Check one block in this many; 1 checks them all.
+    uint64_t sample = 1;
+};
+
+/// @brief What a LockstepChecker has done so far.
+struct LockstepStats {
+    uint64_t blocks = 0;         ///< Blocks run, checked or not.
+    uint64_t checked = 0;        ///< Blocks the reference followed.
+    uint64_t instructions = 0;   ///< Instructions the reference ran.
+    uint64_t unverifiable = 0;   ///< Checked blocks whose I/O outgrew the candidate's log.
+};
+
+/// @brief The first disagreement between candidate and reference.
+struct Divergence {
+    uint64_t block_start = 0;        ///< T-state the failing block started at
+    uint64_t block_end = 0;          ///< ... and where the candidate ended it
+    bool located = false;            ///< A single instruction was found (below)
+    uint64_t tstate = 0;             ///< T-state the instruction started at
+    uint16_t pc = 0;
+    std::string disassembly;         ///< e.g. "LD (HL), A"
+    /// "HL 8001h want 8000h": the candidate's value, then the reference's.
+    /// After the instruction if located, else at the end of the block.
+    std::vector<std::string> differences;
+
+    [[nodiscard]] std::string Report() const {
+        std::string s;
+        if (located) {
+            char head[96];
+            std::snprintf(head, sizeof head, "lockstep divergence at T-state %llu, PC %04Xh: ",
+                          static_cast<unsigned long long>(tstate), pc);
+            s = head + disassembly + "\n";
+        } else {
+            s = "lockstep divergence in T-states " + std::to_string(block_start) + ".." + std::to_string(block_end) +
+                ", not narrowed to one instruction\n";
+        }
+        for (const std::string& d : differences) s += "  " + d + "\n";
+        return s;
+    }
+};
+
+namespace lockstep_detail {
+
+/// The traits a candidate was built with (all tracking on for other engines):
+/// what the candidate does not keep is not compared.
+template <class Cpu>
+struct TraitsOf {
+    using type = DefaultCpuTraits;
+};
+template <class Memory, class Io, class Traits>
+struct TraitsOf<CPUImpl<Memory, Io, Traits>> {
+    using type = Traits;
+};
+
+/// The candidate keeps an ObservableIo-style transaction log.
+template <class Cpu>
+concept RecordsIo = requires(Cpu& cpu) {
+    cpu.GetIo().Transactions();
+    cpu.GetIo().TransactionCount();
+    cpu.GetIo().ClearTransactions();
+    cpu.GetIo().SetRecording(true);
+    { cpu.GetIo().Recording() } -> std::same_as<bool>;
+};
+
+/// Register file and CPU flags, without memory.
+struct Registers {
+    static constexpr std::size_t kPairs = 13;
+    static constexpr const char* kPairNames[kPairs] = {"AF", "BC", "DE", "HL", "AF'", "BC'", "DE'",
+                                                       "HL'", "IX", "IY", "SP", "PC", "WZ"};
+    static constexpr std::size_t kWz = 12;
+
+    std::array<uint16_t, kPairs> pairs{};
+    uint8_t i = 0, r = 0, im = 0;
+    bool iff1 = false, iff2 = false, halted = false, shadow = false;
+    uint64_t tstates = 0;
+
+    bool operator==(const Registers&) const = default;
+};
+
+template <class Cpu>
+Registers registers(Cpu& cpu) {
+    Registers s;
+    s.pairs = {cpu.AF(), cpu.BC(), cpu.DE(), cpu.HL(), cpu.AltAF(), cpu.AltBC(), cpu.AltDE(),
+               cpu.AltHL(), cpu.IX(), cpu.IY(), cpu.SP(), cpu.PC(), cpu.WZ()};
+    s.i = cpu.I();
+    s.r = cpu.R();
+    s.im = cpu.InterruptMode();
+    s.iff1 = cpu.IFF1();
+    s.iff2 = cpu.IFF2();
+    s.halted = cpu.IsHalted();
+    s.shadow = cpu.InterruptShadow();
+    s.tstates = cpu.GetCycleCount();
+    return s;
+}
+
+template <class Cpu>
+void set_registers(Cpu& cpu, const Registers& s) {
+    cpu.AF() = s.pairs[0];
+    cpu.BC() = s.pairs[1];
+    cpu.DE() = s.pairs[2];
+    cpu.HL() = s.pairs[3];
+    cpu.AltAF() = s.pairs[4];
+    cpu.AltBC() = s.pairs[5];
+    cpu.AltDE() = s.pairs[6];
+    cpu.AltHL() = s.pairs[7];
+    cpu.IX() = s.pairs[8];
+    cpu.IY() = s.pairs[9];
+    cpu.SP() = s.pairs[10];
+    cpu.PC() = s.pairs[11];
+    cpu.WZ() = s.pairs[12];
+    cpu.I() = s.i;
+    cpu.R() = s.r;
+    cpu.SetInterruptMode(s.im);
+    cpu.IFF1() = s.iff1;
+    cpu.IFF2() = s.iff2;
+    cpu.SetHalted(s.halted);
+    cpu.SetInterruptShadow(s.shadow);
+    cpu.SetCycleCount(s.tstates);
+}
+
+/// The 64 KB image: straight from memory that exposes it, else byte by byte.
+template <class Cpu>
+void read_memory(Cpu& cpu, std::vector<uint8_t>& out) {
+    out.resize(0x10000);
+    if constexpr (requires { cpu.GetMemory().Data(); }) {
+        std::memcpy(out.data(), cpu.GetMemory().Data(), out.size());
+    } else {
+        for (uint32_t a = 0; a < 0x10000; ++a) out[a] = cpu.ReadMemory(static_cast<uint16_t>(a));
+    }
+}
+
+inline std::string hex_byte(unsigned v) {
+    char buf[8];
+    std::snprintf(buf, sizeof buf, "%02Xh", v & 0xFF);
+    return buf;
+}
+inline std::string hex_word(unsigned v) {
+    char buf[8];
+    std::snprintf(buf, sizeof buf, "%04Xh", v & 0xFFFF);
+    return buf;
+}
+
+inline std::string describe(const ReplayIo::Access* a) {
+    if (!a) return "none";
+    return std::string(a->is_out ? "OUT (" : "IN (") + hex_word(a->port) + ")" + (a->is_out ? "," : "=") +
+           hex_byte(a->value);
+}
+
+} // namespace lockstep_detail
+
+template <class Candidate>
+class LockstepChecker {
+public:
+    /// @brief The reference: the Step() interpreter, replaying the candidate's I/O.
+    using Reference = CPUImpl<ObservableMemory, ReplayIo>;
+
+    /// @brief Memory is compared this often when registers are compared
+    ///        after every instruction (interval 0).
+    static constexpr uint64_t kInstructionBlock = 65536;
+
+    explicit LockstepChecker(Candidate& cpu, LockstepOptions options = {})
+        : cpu_(cpu), options_(options), reference_(std::make_unique<Reference>()) {
+        if (options_.sample == 0) options_.sample = 1;
+    }
+
+    /// @brief Advance the candidate @p tstates T-states (a little more to end
+    ///        on an instruction boundary; less if it halts), checking it.
+    /// @returns T-states run.
+    uint64_t Run(uint64_t tstates) {
+        const uint64_t start = cpu_.GetCycleCount();
+        const uint64_t end = start + tstates;
+        in_sync_ = false;   // between calls the owner may change the candidate (an interrupt, a host trap)
+        while (cpu_.GetCycleCount() < end && !cpu_.IsHalted()) {
+            const uint64_t block_end = std::min(end, cpu_.GetCycleCount() + block_length());
+            const bool checked = !divergence_ && stats_.blocks % options_.sample == 0;
+            ++stats_.blocks;
+            if (!checked) {
+                cpu_.RunUntilCycle(block_end);
+                in_sync_ = false;
+            } else {
+                check_block(block_end);
+            }
+        }
+        return cpu_.GetCycleCount() - start;
+    }
+
+    [[nodiscard]] bool Diverged() const noexcept { return divergence_.has_value(); }
+    /// @brief The first divergence; checking stops once there is one.
+    [[nodiscard]] const std::optional<Divergence>& GetDivergence() const noexcept { return divergence_; }
+    [[nodiscard]] const LockstepStats& Stats() const noexcept { return stats_; }
+    [[nodiscard]] const LockstepOptions& Options() const noexcept { return options_; }
+    [[nodiscard]] Reference& GetReference() noexcept { return *reference_; }
+
+private:
+    using Traits = typename lockstep_detail::TraitsOf<Candidate>::type;
+    using Registers = lockstep_detail::Registers;
+    static constexpr bool kRecordsIo = lockstep_detail::RecordsIo<Candidate>;
+
+    enum class Outcome { kMatch, kDiverged, kUnverifiable };
+
+    /// Machine state at an instruction boundary.
+    struct Snapshot {
+        Registers regs;
+        std::vector<uint8_t> memory;
+    };
+
+    [[nodiscard]] uint64_t block_length() const noexcept {
+        return options_.interval != 0 ? options_.interval : kInstructionBlock;
+    }
+
+    // -- Candidate I/O → the reference's script ------------------------------
+    //
+    // The candidate's log records while a block is checked. When recording
+    // was off the checker owns the log and clears it as it goes, so it never
+    // fills; otherwise the newest entries are taken from the tail.
+
+    void begin_io() {
+        if constexpr (kRecordsIo) {
+            auto& io = cpu_.GetIo();
+            was_recording_ = io.Recording();
+            io.SetRecording(true);
+            mark_io();
+        }
+    }
+    void mark_io() {
+        if constexpr (kRecordsIo) {
+            auto& io = cpu_.GetIo();
+            if (!was_recording_) io.ClearTransactions();
+            io_seen_ = io.TransactionCount();
+        }
+    }
+    /// Script the candidate's transactions since the mark; false if some have
+    /// already left its log.
+    bool take_io() {
+        auto& replay = reference_->GetIo();
+        replay.Clear();
+        if constexpr (kRecordsIo) {
+            const auto& log = cpu_.GetIo().Transactions();
+            const uint64_t n = cpu_.GetIo().TransactionCount() - io_seen_;
+            if (n > log.size()) return false;
+            for (auto it = log.end() - static_cast<std::ptrdiff_t>(n); it != log.end(); ++it)
+                replay.Expect({it->port, it->value, it->is_out});
+            mark_io();
+        }
+        return true;
+    }
+    void end_io() {
+        if constexpr (kRecordsIo) {
+            if (!was_recording_) cpu_.GetIo().ClearTransactions();
+            cpu_.GetIo().SetRecording(was_recording_);
+        }
+    }
+    [[nodiscard]] bool io_matches() const {
+        return !kRecordsIo || reference_->GetIo().Matches();
+    }
+
+    // -- Running ---------------------------------------------------------------
+
+    void finish_candidate_instruction() {
+        while (!cpu_.InstructionComplete()) cpu_.Step();
+    }
+    /// The candidate's own path to @p target: one instruction at a time with
+    /// interval 0, else one bulk run.
+    void advance_candidate(uint64_t target) {
+        if (options_.interval == 0) {
+            while (cpu_.GetCycleCount() < target && !cpu_.IsHalted()) {
+                cpu_.RunUntilCycle(cpu_.GetCycleCount() + 1);
+                finish_candidate_instruction();
+            }
+        } else {
+            cpu_.RunUntilCycle(target);
+            finish_candidate_instruction();
+        }
+    }
+    void reference_instruction() {
+        Reference& ref = *reference_;
+        do { ref.Step(); } while (!ref.InstructionComplete());
+        ++stats_.instructions;
+    }
+    /// Run the reference to @p target, noting each boundary when @p record.
+    void advance_reference(uint64_t target, bool record) {
+        Reference& ref = *reference_;
+        while (ref.GetCycleCount() < target && !ref.IsHalted()) {
+            reference_instruction();
+            if (record) boundaries_.push_back(ref.GetCycleCount());
+        }
+    }
+
+    // -- State -------------------------------------------------------------------
+
+    /// What the candidate keeps: R, WZ and the EI shadow only if its traits do.
+    [[nodiscard]] static Registers comparable(Registers s) {
+        if constexpr (!Traits::kTrackRefresh) s.r = 0;
+        if constexpr (!Traits::kTrackMemptr) s.pairs[Registers::kWz] = 0;
+        if constexpr (!Traits::kInterrupts) s.shadow = false;
+        return s;
+    }
+    [[nodiscard]] bool registers_match() {
+        return comparable(lockstep_detail::registers(cpu_)) == comparable(lockstep_detail::registers(*reference_));
+    }
+    [[nodiscard]] bool memory_matches() {
+        lockstep_detail::read_memory(cpu_, candidate_memory_);
+        return std::memcmp(candidate_memory_.data(), reference_->GetMemory().Data(), candidate_memory_.size()) == 0;
+    }
+
+    void capture(Snapshot& s) {
+        s.regs = lockstep_detail::registers(cpu_);
+        lockstep_detail::read_memory(cpu_, s.memory);
+    }
+    void restore_candidate(const Snapshot& s) {
+        lockstep_detail::set_registers(cpu_, s.regs);
+        for (uint32_t a = 0; a < 0x10000; ++a) {
+            const auto address = static_cast<uint16_t>(a);
+            if (cpu_.ReadMemory(address) != s.memory[a]) cpu_.WriteMemory(address, s.memory[a]);
+        }
+    }
+    void restore_reference(const Snapshot& s) {
+        Reference& ref = *reference_;
+        lockstep_detail::set_registers(ref, s.regs);
+        ref.GetMemory().RawLoad(0, std::span<const uint8_t>(s.memory));
+        if constexpr (requires { cpu_.GetMemory().WriteProtectRange(); }) {
+            if (const auto range = cpu_.GetMemory().WriteProtectRange())
+                ref.GetMemory().SetWriteProtect(range->first, range->second);
+            else
+                ref.GetMemory().ClearWriteProtect();
+        }
+    }
+
+    // -- Checking ------------------------------------------------------------------
+
+    void check_block(uint64_t block_end) {
+        finish_candidate_instruction();
+        if (cpu_.IsHalted()) return;
+        ++stats_.checked;
+        capture(start_);
+        if (!in_sync_) restore_reference(start_);
+        boundaries_.assign(1, start_.regs.tstates);
+        begin_io();
+
+        Outcome outcome = options_.interval == 0 ? follow_instructions(block_end) : follow_block(block_end);
+        if (outcome == Outcome::kMatch && !memory_matches()) outcome = Outcome::kDiverged;
+        in_sync_ = outcome == Outcome::kMatch;
+        if (outcome == Outcome::kUnverifiable) ++stats_.unverifiable;
+        if (outcome == Outcome::kDiverged) locate();
+        end_io();
+    }
+
+    Outcome follow_instructions(uint64_t block_end) {
+        while (cpu_.GetCycleCount() < block_end && !cpu_.IsHalted()) {
+            cpu_.RunUntilCycle(cpu_.GetCycleCount() + 1);
+            finish_candidate_instruction();
+            if (!take_io()) return Outcome::kUnverifiable;
+            if (!reference_->IsHalted()) {
+                reference_instruction();
+                boundaries_.push_back(reference_->GetCycleCount());
+            }
+            if (!registers_match() || !io_matches()) return Outcome::kDiverged;
+        }
+        return Outcome::kMatch;
+    }
+
+    Outcome follow_block(uint64_t block_end) {
+        advance_candidate(block_end);
+        if (!take_io()) return Outcome::kUnverifiable;
+        advance_reference(cpu_.GetCycleCount(), /*record=*/true);
+        return registers_match() && io_matches() ? Outcome::kMatch : Outcome::kDiverged;
+    }
+
+    /// Both CPUs back to the block start, then each run to @p target its own
+    /// way; true if they agree there.
+    bool probe(uint64_t target) {
+        restore_candidate(start_);
+        restore_reference(start_);
+        mark_io();
+        advance_candidate(target);
+        if (!take_io()) return false;
+        advance_reference(target, /*record=*/false);
+        return registers_match() && io_matches() && memory_matches();
+    }
+
+    void locate() {
+        Divergence d;
+        d.block_start = start_.regs.tstates;
+        d.block_end = cpu_.GetCycleCount();
+        d.differences = differences();
+        capture(after_);
+
+        // boundaries_[0] (the block start) agrees by construction. Bisect for
+        // the first boundary that does not, assuming that once the CPUs part
+        // they stay apart.
+        std::size_t good = 0;
+        std::size_t bad = boundaries_.size() - 1;
+        if (bad != 0 && !probe(boundaries_[bad])) {
+            while (bad - good > 1) {
+                const std::size_t mid = good + (bad - good) / 2;
+                (probe(boundaries_[mid]) ? good : bad) = mid;
+            }
+            // Both probed from the block start, so a fused idiom cut short
+            // at the boundary runs exactly as it did in the bisection.
+            probe(boundaries_[good]);
+            d.located = true;
+            d.tstate = boundaries_[good];
+            d.pc = reference_->PC();
+            const Reference& ref = *reference_;
+            d.disassembly = Disassembler{}.Decode([&ref](uint16_t a) { return ref.ReadMemory(a); }, d.pc).text;
+            probe(boundaries_[bad]);
+            d.differences = differences();
+        }
+
+        restore_candidate(after_);
+        divergence_ = std::move(d);
+    }
+
+    /// Candidate against reference, now: registers, I/O, then memory.
+    std::vector<std::string> differences() {
+        using lockstep_detail::hex_byte;
+        using lockstep_detail::hex_word;
+        std::vector<std::string> out;
+        const Registers c = comparable(lockstep_detail::registers(cpu_));
+        const Registers r = comparable(lockstep_detail::registers(*reference_));
+        for (std::size_t k = 0; k < Registers::kPairs; ++k) {
+            if (c.pairs[k] != r.pairs[k])
+                out.push_back(std::string(Registers::kPairNames[k]) + " " + hex_word(c.pairs[k]) + " want " +
+                              hex_word(r.pairs[k]));
+        }
+        const auto flag = [&out](const char* name, unsigned a, unsigned b) {
+            if (a != b) out.push_back(std::string(name) + " " + std::to_string(a) + " want " + std::to_string(b));
+        };
+        if (c.i != r.i) out.push_back("I " + hex_byte(c.i) + " want " + hex_byte(r.i));
+        if (c.r != r.r) out.push_back("R " + hex_byte(c.r) + " want " + hex_byte(r.r));
+        flag("IM", c.im, r.im);
+        flag("IFF1", c.iff1, r.iff1);
+        flag("IFF2", c.iff2, r.iff2);
+        flag("halted", c.halted, r.halted);
+        flag("EI shadow", c.shadow, r.shadow);
+        if (c.tstates != r.tstates)
+            out.push_back("T-state " + std::to_string(c.tstates) + " want " + std::to_string(r.tstates));
+
+        if (!io_matches()) {
+            const auto& expected = reference_->GetIo().Expected();
+            const auto& performed = reference_->GetIo().Performed();
+            std::size_t k = 0;
+            while (k < expected.size() && k < performed.size() && expected[k] == performed[k]) ++k;
+            out.push_back("I/O " + std::to_string(k) + ": " +
+                          lockstep_detail::describe(k < expected.size() ? &expected[k] : nullptr) + " want " +
+                          lockstep_detail::describe(k < performed.size() ? &performed[k] : nullptr));
+        }
+
+        lockstep_detail::read_memory(cpu_, candidate_memory_);
+        const uint8_t* ref_memory = reference_->GetMemory().Data();
+        std::size_t shown = 0, more = 0;
+        for (uint32_t a = 0; a < 0x10000; ++a) {
+            if (candidate_memory_[a] == ref_memory[a]) continue;
+            if (shown++ < kShownBytes) {
+                char line[32];
+                std::snprintf(line, sizeof line, "(%04Xh) %02Xh want %02Xh", static_cast<unsigned>(a),
+                              candidate_memory_[a], ref_memory[a]);
+                out.emplace_back(line);
+            } else {
+                ++more;
+            }
+        }
+        if (more != 0) out.push_back("... and " + std::to_string(more) + " more bytes");
+        return out;
+    }
+
+    static constexpr std::size_t kShownBytes = 8;
+
+    Candidate& cpu_;
+    LockstepOptions options_;
+    std::unique_ptr<Reference> reference_;   // 64 KB of memory: kept off the caller's stack
+    LockstepStats stats_;
+    std::optional<Divergence> divergence_;
+    bool in_sync_ = false;                   ///< The reference equals the candidate now.
+    Snapshot start_;                         ///< The checked block's start
+    Snapshot after_;                         ///< The candidate after a failed block
+    std::vector<uint64_t> boundaries_;       ///< The reference's instruction ends in the block
+    std::vector<uint8_t> candidate_memory_;
+    uint64_t io_seen_ = 0;
+    bool was_recording_ = false;
+};
+
+} // namespace z80::dbg
+
+#endif // Z80_DBG_LOCKSTEP_CHECKER_H
@@ -3,58 +3,43 @@
 // Copyright (c) 2025-2026 Larry Dawson
 // Licensed under the MIT License (see LICENSE file)
 //
-// Includes a compact, dependency-free recursive-descent JSON reader/writer
-// scoped to the .sym schema, keeping the debugger core self-contained.
+// Includes a compact, dependency-free single-pass JSON scanner/writer scoped to
+// the .sym schema, keeping the debugger core self-contained.
 //
 
 #include "symbol_table.h"
 
 #include <algorithm>
-#include <cctype>
+#include <charconv>
 #include <cstdio>
+#include <deque>
 #include <fstream>
 #include <sstream>
 #include <stdexcept>
+#include <system_error>
 
 namespace z80::dbg {
 namespace {
 
 // ===========================================================================
-// Minimal JSON value + recursive-descent parser
+// Zero-copy JSON scanner
 // ===========================================================================
-
-struct JValue {
-    enum class Type { Null, Bool, Number, String, Array, Object } type = Type::Null;
-    bool boolean = false;
+//
+// Symbol files are scanned in one pass without building a DOM. Strings come
+// back as views into the file text; only strings that carry escapes are decoded
+// into scratch storage the scanner owns (stable for the whole load). Values the
+// .sym schema doesn't care about are validated and skipped.
+
+/// @brief A scanned JSON value, reduced to what the schema inspects.
+struct Scalar {
+    enum class Kind : uint8_t { Null, Bool, Number, String, Composite } kind = Kind::Null;
+    std::string_view str;   ///< String payload (valid for the whole load).
     double number = 0.0;
-    std::string str;
-    std::vector<JValue> array;
-    std::vector<std::pair<std::string, JValue>> object;
-
-    [[nodiscard]] const JValue* find(std::string_view key) const {
-        if (type != Type::Object) return nullptr;
-        for (const auto& [k, v] : object) {
-            if (k == key) return &v;
-        }
-        return nullptr;
-    }
 };
 
-class JsonParser {
+class JsonScanner {
 public:
-    explicit JsonParser(std::string_view text) : s_(text) {}
-
-    JValue parse() {
-        skip_ws();
-        JValue v = parse_value();
-        skip_ws();
-        if (i_ != s_.size()) fail("trailing characters after JSON value");
-        return v;
-    }
-
-private:
-    std::string_view s_;
-    std::size_t i_ = 0;
+    explicit JsonScanner(std::string_view text) : s_(text) {}
 
     [[noreturn]] void fail(const char* msg) const {
         std::ostringstream os;
@@ -63,7 +48,6 @@ private:
     }
 
     char peek() const { return i_ < s_.size() ? s_[i_] : '\0'; }
-    char get() { return i_ < s_.size() ? s_[i_++] : '\0'; }
 
     void skip_ws() {
         while (i_ < s_.size()) {
@@ -74,137 +58,153 @@ private:
     }
 
     bool consume(char c) {
+        skip_ws();
         if (peek() == c) { ++i_; return true; }
         return false;
     }
 
-    JValue parse_value() {
+    void finish() {
         skip_ws();
-        switch (peek()) {
-            case '{': return parse_object();
-            case '[': return parse_array();
-            case '"': { JValue v; v.type = JValue::Type::String; v.str = parse_string(); return v; }
-            case 't': case 'f': return parse_bool();
-            case 'n': return parse_null();
-            default:  return parse_number();
-        }
+        if (i_ != s_.size()) fail("trailing characters after JSON value");
     }
 
-    JValue parse_object() {
-        JValue v; v.type = JValue::Type::Object;
-        get();  // '{'
-        skip_ws();
-        if (consume('}')) return v;
+    /// @brief Iterate an object's members: calls @p on_member(key) positioned
+    ///        at the value, which the callback must consume.
+    template <class OnMember>
+    void object(OnMember&& on_member) {
+        if (!consume('{')) fail("expected '{'");
+        if (consume('}')) return;
         for (;;) {
             skip_ws();
             if (peek() != '"') fail("expected string key");
-            std::string key = parse_string();
-            skip_ws();
+            const std::string_view key = string();
             if (!consume(':')) fail("expected ':'");
-            JValue val = parse_value();
-            v.object.emplace_back(std::move(key), std::move(val));
             skip_ws();
+            on_member(key);
             if (consume(',')) continue;
             if (consume('}')) break;
             fail("expected ',' or '}'");
         }
-        return v;
     }
 
-    JValue parse_array() {
-        JValue v; v.type = JValue::Type::Array;
-        get();  // '['
-        skip_ws();
-        if (consume(']')) return v;
+    /// @brief Iterate an array's elements: calls @p on_element() positioned at
+    ///        each element, which the callback must consume.
+    template <class OnElement>
+    void array(OnElement&& on_element) {
+        if (!consume('[')) fail("expected '['");
+        if (consume(']')) return;
         for (;;) {
-            v.array.push_back(parse_value());
             skip_ws();
+            on_element();
             if (consume(',')) continue;
             if (consume(']')) break;
             fail("expected ',' or ']'");
         }
+    }
+
+    /// @brief Scan any value; objects/arrays are validated and reported as
+    ///        Composite.
+    Scalar value() {
+        skip_ws();
+        Scalar v;
+        switch (peek()) {
+            case '{': object([this](std::string_view) { value(); }); v.kind = Scalar::Kind::Composite; break;
+            case '[': array([this] { value(); }); v.kind = Scalar::Kind::Composite; break;
+            case '"': v.kind = Scalar::Kind::String; v.str = string(); break;
+            case 't': literal("true");  v.kind = Scalar::Kind::Bool; break;
+            case 'f': literal("false"); v.kind = Scalar::Kind::Bool; break;
+            case 'n': literal("null"); break;
+            default:  v.kind = Scalar::Kind::Number; v.number = number(); break;
+        }
         return v;
     }
 
-    std::string parse_string() {
-        if (!consume('"')) fail("expected '\"'");
-        std::string out;
+    std::string_view string() {
+        if (peek() != '"') fail("expected '\"'");
+        const std::size_t begin = ++i_;
+        // Fast path: no escapes -> a view straight into the text.
+        while (i_ < s_.size() && s_[i_] != '"' && s_[i_] != '\\') ++i_;
+        if (i_ >= s_.size()) fail("unterminated string");
+        if (s_[i_] == '"') return s_.substr(begin, i_++ - begin);
+
+        std::string& out = decoded_.emplace_back(s_.substr(begin, i_ - begin));
         for (;;) {
             if (i_ >= s_.size()) fail("unterminated string");
-            char c = get();
+            const char c = s_[i_++];
             if (c == '"') break;
-            if (c == '\\') {
-                char e = get();
-                switch (e) {
-                    case '"':  out.push_back('"');  break;
-                    case '\\': out.push_back('\\'); break;
-                    case '/':  out.push_back('/');  break;
-                    case 'b':  out.push_back('\b'); break;
-                    case 'f':  out.push_back('\f'); break;
-                    case 'n':  out.push_back('\n'); break;
-                    case 'r':  out.push_back('\r'); break;
-                    case 't':  out.push_back('\t'); break;
-                    case 'u': {
-                        // Parse \uXXXX; emit UTF-8 for the basic plane.
-                        unsigned cp = 0;
-                        for (int k = 0; k < 4; ++k) {
-                            char h = get();
-                            cp <<= 4;
-                            if (h >= '0' && h <= '9') cp |= static_cast<unsigned>(h - '0');
-                            else if (h >= 'a' && h <= 'f') cp |= static_cast<unsigned>(h - 'a' + 10);
-                            else if (h >= 'A' && h <= 'F') cp |= static_cast<unsigned>(h - 'A' + 10);
-                            else fail("invalid \\u escape");
-                        }
-                        if (cp < 0x80) {
-                            out.push_back(static_cast<char>(cp));
-                        } else if (cp < 0x800) {
-                            out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
-                            out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
-                        } else {
-                            out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
-                            out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
-                            out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
-                        }
-                        break;
+            if (c != '\\') { out.push_back(c); continue; }
+            const char e = i_ < s_.size() ? s_[i_++] : '\0';
+            switch (e) {
+                case '"':  out.push_back('"');  break;
+                case '\\': out.push_back('\\'); break;
+                case '/':  out.push_back('/');  break;
+                case 'b':  out.push_back('\b'); break;
+                case 'f':  out.push_back('\f'); break;
+                case 'n':  out.push_back('\n'); break;
+                case 'r':  out.push_back('\r'); break;
+                case 't':  out.push_back('\t'); break;
+                case 'u': {
+                    // Parse \uXXXX; emit UTF-8 for the basic plane.
+                    unsigned cp = 0;
+                    for (int k = 0; k < 4; ++k) {
+                        const char h = i_ < s_.size() ? s_[i_++] : '\0';
+                        cp <<= 4;
+                        if (h >= '0' && h <= '9') cp |= static_cast<unsigned>(h - '0');
+                        else if (h >= 'a' && h <= 'f') cp |= static_cast<unsigned>(h - 'a' + 10);
+                        else if (h >= 'A' && h <= 'F') cp |= static_cast<unsigned>(h - 'A' + 10);
+                        else fail("invalid \\u escape");
+                    }
+                    if (cp < 0x80) {
+                        out.push_back(static_cast<char>(cp));
+                    } else if (cp < 0x800) {
+                        out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+                        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+                    } else {
+                        out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+                        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+                        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
                     }
-                    default: fail("invalid escape character");
+                    break;
                 }
-            } else {
-                out.push_back(c);
+                default: fail("invalid escape character");
             }
         }
         return out;
     }
 
-    JValue parse_number() {
+private:
+    std::string_view s_;
+    std::size_t i_ = 0;
+    std::deque<std::string> decoded_;   ///< Escaped strings (stable addresses).
+
+    static bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+    double number() {
         const std::size_t start = i_;
         if (peek() == '-' || peek() == '+') ++i_;
         bool any = false;
-        while (std::isdigit(static_cast<unsigned char>(peek()))) { ++i_; any = true; }
-        if (consume('.')) {
-            while (std::isdigit(static_cast<unsigned char>(peek()))) { ++i_; any = true; }
+        while (is_digit(peek())) { ++i_; any = true; }
+        if (peek() == '.') {
+            ++i_;
+            while (is_digit(peek())) { ++i_; any = true; }
         }
         if (peek() == 'e' || peek() == 'E') {
             ++i_;
             if (peek() == '-' || peek() == '+') ++i_;
-            while (std::isdigit(static_cast<unsigned char>(peek()))) ++i_;
+            while (is_digit(peek())) ++i_;
         }
         if (!any) fail("invalid number");
-        JValue v; v.type = JValue::Type::Number;
-        v.number = std::stod(std::string(s_.substr(start, i_ - start)));
+        std::size_t from = start;
+        if (s_[from] == '+') ++from;   // from_chars takes no explicit '+'
+        double v = 0.0;
+        const auto [ptr, ec] = std::from_chars(s_.data() + from, s_.data() + i_, v);
+        if (ec != std::errc{} || ptr != s_.data() + i_) fail("invalid number");
         return v;
     }
 
-    JValue parse_bool() {
-        JValue v; v.type = JValue::Type::Bool;
-        if (s_.substr(i_, 4) == "true")  { i_ += 4; v.boolean = true;  return v; }
-        if (s_.substr(i_, 5) == "false") { i_ += 5; v.boolean = false; return v; }
-        fail("invalid literal");
-    }
-
-    JValue parse_null() {
-        if (s_.substr(i_, 4) == "null") { i_ += 4; return JValue{}; }
-        fail("invalid literal");
+    void literal(std::string_view word) {
+        if (s_.substr(i_, word.size()) != word) fail("invalid literal");
+        i_ += word.size();
     }
 };
 
@@ -212,20 +212,27 @@ private:
 // Schema-level helpers
 // ===========================================================================
 
+// Parse an integer from text in the given base; nullopt unless some digits were
+// consumed and the value fits.
+std::optional<long long> parse_integer(std::string_view t, int base) {
+    long long value = 0;
+    const auto [ptr, ec] = std::from_chars(t.data(), t.data() + t.size(), value, base);
+    if (ec != std::errc{} || ptr == t.data()) return std::nullopt;
+    return value;
+}
+
 // Parse an address from a JSON value: hex string ("0x1234"), decimal string,
 // or a number. Returns nullopt on failure / out of 16-bit range.
-std::optional<uint16_t> parse_address(const JValue& v) {
-    long value = -1;
-    if (v.type == JValue::Type::Number) {
-        value = static_cast<long>(v.number);
-    } else if (v.type == JValue::Type::String) {
-        try {
-            const std::string& t = v.str;
-            const bool hex = t.size() > 2 && t[0] == '0' && (t[1] == 'x' || t[1] == 'X');
-            value = std::stol(t, nullptr, hex ? 16 : 10);
-        } catch (...) {
-            return std::nullopt;
-        }
+std::optional<uint16_t> parse_address(const Scalar& v) {
+    long long value = -1;
+    if (v.kind == Scalar::Kind::Number) {
+        value = static_cast<long long>(v.number);
+    } else if (v.kind == Scalar::Kind::String) {
+        const std::string_view t = v.str;
+        const bool hex = t.size() > 2 && t[0] == '0' && (t[1] == 'x' || t[1] == 'X');
+        const auto parsed = hex ? parse_integer(t.substr(2), 16) : parse_integer(t, 10);
+        if (!parsed) return std::nullopt;
+        value = *parsed;
     } else {
         return std::nullopt;
     }
@@ -233,13 +240,13 @@ std::optional<uint16_t> parse_address(const JValue& v) {
     return static_cast<uint16_t>(value);
 }
 
-std::optional<uint16_t> parse_size(const JValue& v) {
-    if (v.type == JValue::Type::Number) {
-        const long n = static_cast<long>(v.number);
+std::optional<uint16_t> parse_size(const Scalar& v) {
+    if (v.kind == Scalar::Kind::Number) {
+        const long long n = static_cast<long long>(v.number);
         if (n < 1 || n > 0x10000) return std::nullopt;
         return static_cast<uint16_t>(n > 0xFFFF ? 0xFFFF : n);
     }
-    if (v.type == JValue::Type::String) {
+    if (v.kind == Scalar::Kind::String) {
         if (auto a = parse_address(v)) return *a == 0 ? std::optional<uint16_t>(1) : a;
     }
     return std::nullopt;
@@ -293,142 +300,265 @@ std::optional<SymbolType> SymbolTypeFromString(std::string_view text) {
     return std::nullopt;
 }
 
+// ===========================================================================
+// SymbolTable::StringPool
+// ===========================================================================
+
+std::string_view SymbolTable::StringPool::Intern(std::string_view text) {
+    if (text.empty()) return {};
+    if (auto it = index_.find(text); it != index_.end()) return *it;
+    if (blocks_.empty() || block_size_ - block_used_ < text.size()) {
+        block_size_ = std::max(kBlockSize, text.size());
+        blocks_.push_back(std::make_unique<char[]>(block_size_));
+        block_used_ = 0;
+    }
+    char* dst = blocks_.back().get() + block_used_;
+    std::copy(text.begin(), text.end(), dst);
+    block_used_ += text.size();
+    const std::string_view stored(dst, text.size());
+    index_.insert(stored);
+    return stored;
+}
+
+void SymbolTable::StringPool::Clear() noexcept {
+    index_.clear();
+    blocks_.clear();
+    block_size_ = 0;
+    block_used_ = 0;
+}
+
 // ===========================================================================
 // SymbolTable
 // ===========================================================================
 
-void SymbolTable::Define(const Symbol& sym) {
-    // Drop any previous symbol at this address (and its old name index entry).
-    if (auto it = by_address_.find(sym.address); it != by_address_.end()) {
-        by_name_.erase(it->second.name);
+SymbolTable::SymbolTable() : slot_at_(65536, kNoSlot), cover_(65536, kNoSlot) {}
+
+Symbol SymbolTable::ToSymbol(const Entry& e) const {
+    return Symbol{e.address, std::string(e.name), e.type, std::string(e.description), e.size};
+}
+
+void SymbolTable::Insert(uint16_t address, std::string_view name, SymbolType type,
+                         std::string_view description, uint16_t size) {
+    if (size == 0) size = 1;
+    const Entry entry{address, size, type, pool_.Intern(name), pool_.Intern(description)};
+
+    bool rebuild = false;
+    if (const uint32_t slot = slot_at_[address]; slot != kNoSlot) {
+        // Replace in place, dropping the old name's index entry (if it is ours).
+        Entry& old = entries_[slot];
+        if (auto it = by_name_.find(old.name); it != by_name_.end() && it->second == address)
+            by_name_.erase(it);
+        rebuild = old.size > 1;   // the old region's coverage must go
+        old = entry;
+    } else {
+        slot_at_[address] = static_cast<uint32_t>(entries_.size());
+        entries_.push_back(entry);
+    }
+    by_name_.insert_or_assign(entry.name, address);
+
+    if (rebuild) RebuildCover();
+    else if (entry.size > 1) CoverRegion(address);
+}
+
+void SymbolTable::CoverRegion(uint16_t start) {
+    const Entry& e = entries_[slot_at_[start]];
+    const uint32_t end = std::min<uint32_t>(0x10000, static_cast<uint32_t>(start) + e.size);
+    for (uint32_t a = start; a < end; ++a) {
+        // Innermost wins: a region starting later is nested inside (or overlaps
+        // the tail of) any region already covering this byte.
+        if (cover_[a] == kNoSlot || cover_[a] < start) cover_[a] = start;
     }
-    Symbol s = sym;
-    if (s.size == 0) s.size = 1;
-    by_name_[s.name] = s.address;
-    by_address_[s.address] = std::move(s);
+}
+
+void SymbolTable::RebuildCover() {
+    // One sweep over the address space with a stack of open regions (innermost
+    // on top); regions that ended underneath are discarded as they surface.
+    std::fill(cover_.begin(), cover_.end(), kNoSlot);
+    std::vector<uint32_t> open;   // region start addresses
+    auto end_of = [this](uint32_t start) {
+        return start + entries_[slot_at_[start]].size;
+    };
+    for (uint32_t a = 0; a < 0x10000; ++a) {
+        if (const uint32_t slot = slot_at_[a]; slot != kNoSlot && entries_[slot].size > 1)
+            open.push_back(a);
+        while (!open.empty() && end_of(open.back()) <= a) open.pop_back();
+        if (!open.empty()) cover_[a] = open.back();
+    }
+}
+
+void SymbolTable::Define(const Symbol& sym) {
+    Insert(sym.address, sym.name, sym.type, sym.description, sym.size);
 }
 
 void SymbolTable::DefineLabel(uint16_t address, std::string name,
                               SymbolType type, std::string description) {
-    Define(Symbol{address, std::move(name), type, std::move(description), 1});
+    Insert(address, name, type, description, 1);
 }
 
 void SymbolTable::Remove(uint16_t address) {
-    if (auto it = by_address_.find(address); it != by_address_.end()) {
-        by_name_.erase(it->second.name);
-        by_address_.erase(it);
-    }
+    const uint32_t slot = slot_at_[address];
+    if (slot == kNoSlot) return;
+    const Entry removed = entries_[slot];
+    if (auto it = by_name_.find(removed.name); it != by_name_.end() && it->second == address)
+        by_name_.erase(it);
+
+    // Swap-and-pop keeps entries_ dense; re-point the moved entry's slot.
+    const Entry& last = entries_.back();
+    slot_at_[last.address] = slot;
+    entries_[slot] = last;
+    entries_.pop_back();
+    slot_at_[address] = kNoSlot;
+
+    if (removed.size > 1) RebuildCover();
 }
 
 void SymbolTable::Clear() noexcept {
-    by_address_.clear();
+    entries_.clear();
+    std::fill(slot_at_.begin(), slot_at_.end(), kNoSlot);
+    std::fill(cover_.begin(), cover_.end(), kNoSlot);
     by_name_.clear();
+    pool_.Clear();
 }
 
 std::optional<Symbol> SymbolTable::Lookup(uint16_t address) const {
-    if (auto it = by_address_.find(address); it != by_address_.end()) return it->second;
+    if (const uint32_t slot = slot_at_[address]; slot != kNoSlot) return ToSymbol(entries_[slot]);
     return std::nullopt;
 }
 
 std::optional<Symbol> SymbolTable::FindContaining(uint16_t address) const {
-    if (auto it = by_address_.find(address); it != by_address_.end()) return it->second;
-    // Largest symbol with address <= the query; check it covers `address`.
-    auto it = by_address_.upper_bound(address);
-    if (it == by_address_.begin()) return std::nullopt;
-    --it;
-    const Symbol& s = it->second;
-    const uint32_t end = static_cast<uint32_t>(s.address) + (s.size ? s.size : 1);
-    return address < end ? std::optional<Symbol>(s) : std::nullopt;
+    if (const uint32_t slot = slot_at_[address]; slot != kNoSlot) return ToSymbol(entries_[slot]);
+    if (const uint32_t start = cover_[address]; start != kNoSlot)
+        return ToSymbol(entries_[slot_at_[start]]);
+    return std::nullopt;
 }
 
 std::optional<std::string> SymbolTable::ResolveName(uint16_t address) const {
-    if (auto it = by_address_.find(address); it != by_address_.end()) return it->second.name;
+    if (auto name = NameAt(address)) return std::string(*name);
     return std::nullopt;
 }
 
 std::optional<uint16_t> SymbolTable::Resolve(std::string_view name) const {
-    if (auto it = by_name_.find(std::string(name)); it != by_name_.end()) return it->second;
+    if (auto it = by_name_.find(name); it != by_name_.end()) return it->second;
     return std::nullopt;
 }
 
 std::vector<Symbol> SymbolTable::List() const {
     std::vector<Symbol> out;
-    out.reserve(by_address_.size());
-    for (const auto& [addr, sym] : by_address_) out.push_back(sym);  // map is ordered
+    out.reserve(entries_.size());
+    for (uint32_t a = 0; a < 0x10000 && out.size() < entries_.size(); ++a) {
+        if (const uint32_t slot = slot_at_[a]; slot != kNoSlot) out.push_back(ToSymbol(entries_[slot]));
+    }
     return out;
 }
 
-SymbolResolver SymbolTable::MakeResolver() const {
-    return [this](uint16_t address) { return ResolveName(address); };
-}
-
 bool SymbolTable::LoadFromFile(const std::string& path, std::string* program,
                                std::vector<std::string>* warnings) {
-    std::ifstream in(path, std::ios::binary);
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
     if (!in) return false;
-    std::ostringstream ss;
-    ss << in.rdbuf();
-    const std::string text = ss.str();
-
-    JValue root;
+    std::string text(static_cast<std::size_t>(std::max<std::streamoff>(0, in.tellg())), '\0');
+    in.seekg(0);
+    in.read(text.data(), static_cast<std::streamsize>(text.size()));
+
+    // One validated symbol, viewing into the text (or the scanner's scratch).
+    struct Parsed {
+        uint16_t address;
+        uint16_t size;
+        SymbolType type;
+        std::string_view name;
+        std::string_view description;
+    };
+    std::vector<Parsed> parsed;
+    std::vector<std::string> entry_warnings;   // committed only if the file parses
+    std::optional<std::string_view> program_field;
+    bool top_is_object = false;
+    bool have_symbols = false;
+
+    JsonScanner js(text);
     try {
-        root = JsonParser(text).parse();
+        js.skip_ws();
+        if (js.peek() != '{') {
+            js.value();   // still report malformed JSON as a parse error
+        } else {
+            top_is_object = true;
+            js.object([&](std::string_view key) {
+                if (key == "program" && !program_field) {
+                    const Scalar p = js.value();
+                    program_field = p.kind == Scalar::Kind::String ? p.str : std::string_view{};
+                    return;
+                }
+                if (key != "symbols" || have_symbols) { js.value(); return; }
+                have_symbols = true;
+                if (js.peek() != '[') { js.value(); have_symbols = false; return; }
+
+                std::size_t index = 0;
+                js.array([&] {
+                    const std::size_t at = index++;
+                    auto warn = [&](const std::string& msg) {
+                        if (warnings)
+                            entry_warnings.emplace_back("symbols[" + std::to_string(at) + "]: " + msg);
+                    };
+                    if (js.peek() != '{') { js.value(); warn("not an object"); return; }
+
+                    // First occurrence of each field wins (matching a DOM lookup).
+                    Scalar addr_v, name_v, type_v, desc_v, size_v;
+                    bool has_addr = false, has_name = false, has_type = false,
+                         has_desc = false, has_size = false;
+                    auto take = [&](bool& seen, Scalar& slot) {
+                        if (seen) { js.value(); return; }
+                        seen = true;
+                        slot = js.value();
+                    };
+                    js.object([&](std::string_view field) {
+                        if (field == "address")          take(has_addr, addr_v);
+                        else if (field == "name")        take(has_name, name_v);
+                        else if (field == "type")        take(has_type, type_v);
+                        else if (field == "description") take(has_desc, desc_v);
+                        else if (field == "size")        take(has_size, size_v);
+                        else                             js.value();
+                    });
+
+                    if (!has_addr) { warn("missing \"address\""); return; }
+                    if (!has_name || name_v.kind != Scalar::Kind::String || name_v.str.empty()) {
+                        warn("missing or empty \"name\""); return;
+                    }
+                    const auto addr = parse_address(addr_v);
+                    if (!addr) { warn("invalid \"address\""); return; }
+
+                    Parsed sym{*addr, 1, SymbolType::Label, name_v.str, {}};
+                    if (has_type && type_v.kind == Scalar::Kind::String) {
+                        if (auto t = SymbolTypeFromString(type_v.str)) sym.type = *t;
+                        else warn("unknown \"type\" \"" + std::string(type_v.str) +
+                                  "\", defaulting to LABEL");
+                    }
+                    if (has_desc && desc_v.kind == Scalar::Kind::String) sym.description = desc_v.str;
+                    if (has_size) {
+                        if (auto sz = parse_size(size_v)) sym.size = *sz;
+                        else warn("invalid \"size\", defaulting to 1");
+                    }
+                    parsed.push_back(sym);
+                });
+            });
+        }
+        js.finish();
     } catch (const std::exception& e) {
         if (warnings) warnings->emplace_back(e.what());
         return false;
     }
 
-    if (root.type != JValue::Type::Object) {
+    if (!top_is_object) {
         if (warnings) warnings->emplace_back("top-level JSON is not an object");
         return false;
     }
-    if (program) {
-        if (const JValue* p = root.find("program"); p && p->type == JValue::Type::String) {
-            *program = p->str;
-        }
-    }
-
-    const JValue* syms = root.find("symbols");
-    if (!syms || syms->type != JValue::Type::Array) {
+    if (program && program_field && !program_field->empty()) *program = std::string(*program_field);
+    if (!have_symbols) {
         if (warnings) warnings->emplace_back("missing or invalid \"symbols\" array");
         return true;  // a valid object with no symbols is allowed
     }
 
-    std::size_t index = 0;
-    for (const JValue& entry : syms->array) {
-        const std::size_t at = index++;
-        auto warn = [&](const std::string& msg) {
-            if (warnings) warnings->emplace_back("symbols[" + std::to_string(at) + "]: " + msg);
-        };
-        if (entry.type != JValue::Type::Object) { warn("not an object"); continue; }
-
-        const JValue* addr_v = entry.find("address");
-        const JValue* name_v = entry.find("name");
-        if (!addr_v) { warn("missing \"address\""); continue; }
-        if (!name_v || name_v->type != JValue::Type::String || name_v->str.empty()) {
-            warn("missing or empty \"name\""); continue;
-        }
-        auto addr = parse_address(*addr_v);
-        if (!addr) { warn("invalid \"address\""); continue; }
-
-        Symbol sym;
-        sym.address = *addr;
-        sym.name = name_v->str;
-        sym.type = SymbolType::Label;
-        if (const JValue* t = entry.find("type"); t && t->type == JValue::Type::String) {
-            if (auto parsed = SymbolTypeFromString(t->str)) sym.type = *parsed;
-            else warn("unknown \"type\" \"" + t->str + "\", defaulting to LABEL");
-        }
-        if (const JValue* d = entry.find("description"); d && d->type == JValue::Type::String) {
-            sym.description = d->str;
-        }
-        sym.size = 1;
-        if (const JValue* sz = entry.find("size")) {
-            if (auto s = parse_size(*sz)) sym.size = *s;
-            else warn("invalid \"size\", defaulting to 1");
-        }
-        Define(sym);
-    }
+    if (warnings) warnings->insert(warnings->end(), entry_warnings.begin(), entry_warnings.end());
+    entries_.reserve(std::min<std::size_t>(0x10000, entries_.size() + parsed.size()));
+    by_name_.reserve(by_name_.size() + parsed.size());
+    for (const Parsed& p : parsed) Insert(p.address, p.name, p.type, p.description, p.size);
     return true;
 }
 
@@ -443,7 +573,10 @@ bool SymbolTable::SaveToFile(const std::string& path,
     out << "  \"symbols\": [";
 
     bool first = true;
-    for (const auto& [addr, sym] : by_address_) {
+    for (uint32_t a = 0; a < 0x10000; ++a) {
+        const uint32_t slot = slot_at_[a];
+        if (slot == kNoSlot) continue;
+        const Entry& sym = entries_[slot];
         out << (first ? "\n" : ",\n");
         first = false;
         char addr_buf[8];
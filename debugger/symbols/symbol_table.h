@@ -11,18 +11,27 @@
 // It plugs into the disassembler via MakeResolver(), which yields a
 // SymbolResolver (address -> label) for operand substitution.
 //
+// Storage is flat so it scales to symbol files with tens of thousands of
+// entries (ROM disassemblies plus game maps): a 64K address -> slot array gives
+// O(1) exact lookup, a per-address "innermost covering region" array answers
+// FindContaining() in O(1), and names/descriptions are interned in an
+// append-only pool so lookups and the resolver hand out string_views without
+// allocating. Address order comes for free by walking the 64K slot array.
+//
 
 #ifndef Z80_DBG_SYMBOL_TABLE_H
 #define Z80_DBG_SYMBOL_TABLE_H
 
 #include "disassembler.h"   // for SymbolResolver
 
+#include <cstddef>
 #include <cstdint>
-#include <map>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 namespace z80::dbg {
@@ -53,6 +62,23 @@ struct Symbol {
 
 class SymbolTable {
 public:
+    /// @brief The disassembler resolver: a plain function object holding only a
+    ///        pointer to the table. Fits std::function's small-object buffer and
+    ///        returns views into the interned name pool, so resolving an operand
+    ///        never touches the heap.
+    struct Resolver {
+        const SymbolTable* table = nullptr;
+        [[nodiscard]] std::optional<std::string_view> operator()(uint16_t address) const {
+            return table->NameAt(address);
+        }
+    };
+
+    SymbolTable();
+    SymbolTable(SymbolTable&&) = default;
+    SymbolTable& operator=(SymbolTable&&) = default;
+    SymbolTable(const SymbolTable&) = delete;   // views point into our own pool
+    SymbolTable& operator=(const SymbolTable&) = delete;
+
     // -- Mutation ------------------------------------------------------------
 
     /// @brief Add or replace the symbol at sym.address. The name index is kept
@@ -77,17 +103,25 @@ public:
     ///        multi-byte regions/variables.
     [[nodiscard]] std::optional<Symbol> FindContaining(uint16_t address) const;
 
-    /// @brief Label name at an exact address (for the disassembler resolver).
+    /// @brief Label name at an exact address (owning copy, for UI text).
     [[nodiscard]] std::optional<std::string> ResolveName(uint16_t address) const;
 
+    /// @brief Label name at an exact address as a view into the interned pool
+    ///        (valid until the symbol is removed/redefined or the table cleared).
+    [[nodiscard]] std::optional<std::string_view> NameAt(uint16_t address) const {
+        const uint32_t slot = slot_at_[address];
+        if (slot == kNoSlot) return std::nullopt;
+        return entries_[slot].name;
+    }
+
     /// @brief Address for a label name.
     [[nodiscard]] std::optional<uint16_t> Resolve(std::string_view name) const;
 
     /// @brief All symbols, ordered by address.
     [[nodiscard]] std::vector<Symbol> List() const;
 
-    [[nodiscard]] std::size_t Size() const noexcept { return by_address_.size(); }
-    [[nodiscard]] bool Empty() const noexcept { return by_address_.empty(); }
+    [[nodiscard]] std::size_t Size() const noexcept { return entries_.size(); }
+    [[nodiscard]] bool Empty() const noexcept { return entries_.empty(); }
 
     // -- Persistence ---------------------------------------------------------
 
@@ -110,11 +144,50 @@ public:
 
     /// @brief A resolver bound to this table. The returned callable holds a
     ///        pointer to this table; it must not outlive the table.
-    [[nodiscard]] SymbolResolver MakeResolver() const;
+    [[nodiscard]] Resolver MakeResolver() const { return Resolver{this}; }
 
 private:
-    std::map<uint16_t, Symbol> by_address_;          ///< Ordered by address.
-    std::unordered_map<std::string, uint16_t> by_name_;
+    static constexpr uint32_t kNoSlot = 0xFFFFFFFFu;
+
+    /// @brief Append-only string storage. Views stay valid until Clear(); equal
+    ///        strings share one copy. Removing a symbol does not reclaim its
+    ///        bytes (a reload clears the pool).
+    class StringPool {
+    public:
+        std::string_view Intern(std::string_view text);
+        void Clear() noexcept;
+
+    private:
+        static constexpr std::size_t kBlockSize = 64 * 1024;
+        std::vector<std::unique_ptr<char[]>> blocks_;
+        std::size_t block_size_ = 0;   ///< Capacity of blocks_.back().
+        std::size_t block_used_ = 0;   ///< Bytes used in blocks_.back().
+        std::unordered_set<std::string_view> index_;
+    };
+
+    /// @brief One stored symbol; text fields view into pool_.
+    struct Entry {
+        uint16_t address = 0;
+        uint16_t size = 1;
+        SymbolType type = SymbolType::Label;
+        std::string_view name;
+        std::string_view description;
+    };
+
+    [[nodiscard]] Symbol ToSymbol(const Entry& e) const;
+    void Insert(uint16_t address, std::string_view name, SymbolType type,
+                std::string_view description, uint16_t size);
+
+    /// @brief Extend the covering-region index with the region starting at
+    ///        @p start (innermost = latest start wins), or rebuild it from scratch.
+    void CoverRegion(uint16_t start);
+    void RebuildCover();
+
+    std::vector<Entry> entries_;                ///< Dense; order is not address order.
+    std::vector<uint32_t> slot_at_;             ///< 64K: address -> entries_ index.
+    std::vector<uint32_t> cover_;               ///< 64K: address -> innermost region start.
+    std::unordered_map<std::string_view, uint16_t> by_name_;
+    StringPool pool_;
 };
 
 } // namespace z80::dbg
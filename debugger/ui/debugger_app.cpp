@@ -12,6 +12,8 @@
 #include "panels/memory_panel.h"
 #include "panels/io_panel.h"
 #include "panels/smc_panel.h"
+#include "panels/profiler_panel.h"
+#include "panels/scanner_panel.h"
 #include "panels/screen_panel.h"
 #include "panels/keyboard_panel.h"
 
@@ -63,6 +65,8 @@ DebuggerApp::DebuggerApp() {
     panels_.push_back(std::make_unique<MemoryPanel>());
     panels_.push_back(std::make_unique<IoPanel>());
     panels_.push_back(std::make_unique<SmcPanel>());
+    panels_.push_back(std::make_unique<ProfilerPanel>());
+    panels_.push_back(std::make_unique<ScannerPanel>());
 }
 
 UiContext DebuggerApp::MakeContext() {
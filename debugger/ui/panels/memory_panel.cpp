@@ -10,6 +10,7 @@
 
 #include "imgui.h"
 
+#include <cmath>
 #include <cstdlib>
 #include <string>
 
@@ -25,6 +26,14 @@ bool parse_hex16(const char* s, uint16_t& out) {
     }
 }
 
+// Cold-to-hot ramp for a heatmap cell: blue (rare) -> yellow -> red (peak),
+// on a log scale so a few very hot loops don't wash out everything else.
+ImVec4 heat_colour(uint32_t count, uint32_t peak) {
+    const float t = peak > 1 ? static_cast<float>(std::log1p(count) / std::log1p(peak)) : 1.0f;
+    if (t < 0.5f) return ImVec4(0.35f + 1.3f * t, 0.55f + 0.8f * t, 1.0f - 1.8f * t, 1.0f);
+    return ImVec4(1.0f, 0.95f - 1.5f * (t - 0.5f), 0.1f, 1.0f);
+}
+
 } // namespace
 
 void MemoryPanel::Draw(UiContext& ctx) {
@@ -46,7 +55,15 @@ void MemoryPanel::Draw(UiContext& ctx) {
     ImGui::TextDisabled("changed bytes are highlighted");
 
     ImGui::SameLine();
-    ImGui::TextDisabled("| green=exec  magenta=SMC  amber=blocked-write  blue=read-only");
+    ImGui::SetNextItemWidth(90);
+    ImGui::Combo("heat", &heat_, "off\0exec\0read\0write\0samples\0");
+    ImGui::SameLine();
+    if (heat_ == 0)
+        ImGui::TextDisabled("| green=exec  magenta=SMC  amber=blocked-write  blue=read-only");
+    else if (ctx.session.GetProfileMode() == ProfileMode::Off)
+        ImGui::TextDisabled("| profiler is off (see the Profiler panel)");
+    else
+        ImGui::TextDisabled("| blue=cold .. red=hot (log scale)");
 
     DebugCPU& cpu = ctx.cpu();
     DebugSession& session = ctx.session;
@@ -57,6 +74,10 @@ void MemoryPanel::Draw(UiContext& ctx) {
     const ImVec4 exec_col(0.45f, 0.85f, 0.50f, 1.0f);    // executed as code
     const ImVec4 prot_col(0.50f, 0.62f, 0.95f, 1.0f);    // write-protected (e.g. ROM)
 
+    const HotspotProfiler& profile = session.Profiler();
+    const auto heat = static_cast<HeatSource>(heat_ > 0 ? heat_ - 1 : 0);
+    const uint32_t peak = heat_ > 0 ? profile.Peak(heat) : 0;
+
     if (ImGui::BeginChild("memscroll", ImVec2(0, 0), false,
                           ImGuiWindowFlags_HorizontalScrollbar)) {
         const float line_h = ImGui::GetTextLineHeightWithSpacing();
@@ -83,16 +104,21 @@ void MemoryPanel::Draw(UiContext& ctx) {
                     const uint16_t a = static_cast<uint16_t>(base + c);
                     const uint8_t v = cpu.ReadMemory(a);
                     const uint8_t cov = session.CoverageFlags(a);
-                    if (cov & kSelfModified)                  ImGui::TextColored(smc_col, "%02X", v);
+                    const uint32_t hits = peak ? profile.Count(heat, a) : 0;
+                    if (hits)                                 ImGui::TextColored(heat_colour(hits, peak), "%02X", v);
+                    else if (heat_ > 0)                       ImGui::TextDisabled("%02X", v);
+                    else if (cov & kSelfModified)             ImGui::TextColored(smc_col, "%02X", v);
                     else if (cov & kBlockedWrite)             ImGui::TextColored(blocked_col, "%02X", v);
                     else if (dirty.count(a))                  ImGui::TextColored(dirty_col, "%02X", v);
                     else if (cov & (kExecOpcode | kExecOperand)) ImGui::TextColored(exec_col, "%02X", v);
                     else if (cpu.GetMemory().WriteProtected(a)) ImGui::TextColored(prot_col, "%02X", v);
                     else                                      ImGui::Text("%02X", v);
                     // Hover a byte to see which symbol/region it belongs to.
-                    if (ImGui::IsItemHovered())
-                        if (auto sym = ctx.symbols.FindContaining(a))
+                    if (ImGui::IsItemHovered()) {
+                        if (hits) ImGui::SetTooltip("%s: %u", ToString(heat), hits);
+                        else if (auto sym = ctx.symbols.FindContaining(a))
                             SymbolTooltipIfHovered(*sym);
+                    }
                     ImGui::SameLine();
                 }
                 ImGui::Text(" ");
@@ -15,7 +15,7 @@
 namespace z80::dbg {
 
 /// @brief Hex/ASCII memory dump with jump-to-address, changed-cell highlight,
-///        and right-click address labeling.
+///        right-click address labeling, and an optional profiler heatmap.
 class MemoryPanel : public Panel {
 public:
     void Draw(UiContext& ctx) override;
@@ -25,6 +25,7 @@ private:
     bool goto_pending_ = false;
     uint16_t goto_addr_ = 0x0000;
     SymbolEditState edit_;
+    int heat_ = 0;   ///< 0 = coverage colours, else HeatSource + 1.
 };
 
 } // namespace z80::dbg
@@ -0,0 +1,90 @@
+//
+// Z80 Digital Twin Debugger - Profiler panel implementation
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// Exact counters see every instruction and every data read/write, which makes
+// a run slower; sampling only looks at the PC every N T-states and is cheap
+// enough to leave on. Either feeds the same report.
+//
+
+#include "profiler_panel.h"
+#include "ui_context.h"
+
+#include "imgui.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace z80::dbg {
+
+void ProfilerPanel::Draw(UiContext& ctx) {
+    ImGui::SetNextWindowPos(ImVec2(1290, 120), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowSize(ImVec2(310, 370), ImGuiCond_FirstUseEver);
+    ImGui::Begin("Profiler");
+
+    DebugSession& session = ctx.session;
+    int mode = static_cast<int>(session.GetProfileMode());
+    bool changed = ImGui::RadioButton("Off", &mode, static_cast<int>(ProfileMode::Off));
+    ImGui::SameLine();
+    changed |= ImGui::RadioButton("Counters", &mode, static_cast<int>(ProfileMode::Counters));
+    ImGui::SameLine();
+    changed |= ImGui::RadioButton("Sampling", &mode, static_cast<int>(ProfileMode::Sampling));
+    if (changed) session.SetProfileMode(static_cast<ProfileMode>(mode));
+
+    ImGui::SetNextItemWidth(100);
+    if (ImGui::InputInt("T-states/sample", &interval_, 100, 1000)) {
+        if (interval_ < 1) interval_ = 1;
+        session.SetSampleInterval(static_cast<uint32_t>(interval_));
+    }
+    if (ImGui::Button("Clear")) session.ClearProfile();
+
+    const HotspotProfiler& profile = session.Profiler();
+    ImGui::SameLine();
+    ImGui::Text("insns %llu  samples %llu",
+                static_cast<unsigned long long>(profile.Instructions()),
+                static_cast<unsigned long long>(profile.Samples()));
+
+    ImGui::Separator();
+    ImGui::SetNextItemWidth(100);
+    ImGui::SliderInt("rows", &rows_, 5, 100);
+
+    const std::vector<HotSpot> spots =
+        profile.HottestCode(static_cast<std::size_t>(rows_), &session.Cfg(), &ctx.symbols);
+    if (spots.empty()) {
+        ImGui::TextDisabled("Nothing recorded yet.");
+    } else if (ImGui::BeginTable("hot", 4,
+                                 ImGuiTableFlags_Borders | ImGuiTableFlags_ScrollY |
+                                 ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit)) {
+        ImGui::TableSetupColumn("Code");
+        ImGui::TableSetupColumn("Symbol");
+        ImGui::TableSetupColumn("Hits");
+        ImGui::TableSetupColumn("%");
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableHeadersRow();
+        for (std::size_t i = 0; i < spots.size(); ++i) {
+            const HotSpot& s = spots[i];
+            ImGui::TableNextRow();
+            ImGui::PushID(static_cast<int>(i));
+            ImGui::TableSetColumnIndex(0);
+            char range[16];
+            std::snprintf(range, sizeof(range), "%04X-%04X", s.start,
+                          static_cast<unsigned>(s.end - 1));
+            if (ImGui::Selectable(range, false, ImGuiSelectableFlags_SpanAllColumns))
+                ctx.disasm_goto = s.start;
+            ImGui::TableSetColumnIndex(1);
+            ImGui::TextUnformatted(s.label.c_str());
+            ImGui::TableSetColumnIndex(2);
+            ImGui::Text("%llu", static_cast<unsigned long long>(s.hits));
+            ImGui::TableSetColumnIndex(3);
+            ImGui::Text("%.1f", s.percent);
+            ImGui::PopID();
+        }
+        ImGui::EndTable();
+    }
+
+    ImGui::End();
+}
+
+} // namespace z80::dbg
@@ -0,0 +1,28 @@
+//
+// Z80 Digital Twin Debugger - Profiler panel
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+
+#ifndef Z80_DBG_PROFILER_PANEL_H
+#define Z80_DBG_PROFILER_PANEL_H
+
+#include "panel.h"
+
+namespace z80::dbg {
+
+/// @brief Hot-spot profiler controls (off / exact counters / PC sampling) and
+///        the ranked hottest-code list. Click a row to jump the disassembly.
+///        The per-byte view of the same data is the Memory panel's heatmap.
+class ProfilerPanel : public Panel {
+public:
+    void Draw(UiContext& ctx) override;
+
+private:
+    int interval_ = 1000;   ///< Sampling interval being edited (T-states).
+    int rows_ = 20;         ///< Rows in the hottest-code list.
+};
+
+} // namespace z80::dbg
+
+#endif // Z80_DBG_PROFILER_PANEL_H
@@ -0,0 +1,116 @@
+//
+// Z80 Digital Twin Debugger - Memory scanner panel implementation
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// Typical use: Start with "RAM only", lose a life, Refine "decreased"; play on
+// without dying, Refine "unchanged"; repeat until a handful of addresses remain.
+// "Every frame" re-applies the chosen predicate on each UI frame while the
+// machine runs (useful with "unchanged" to shed busy bytes quickly).
+//
+
+#include "scanner_panel.h"
+#include "ui_context.h"
+
+#include "imgui.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace z80::dbg {
+namespace {
+
+// Rows listed; the bitmap may hold far more candidates than are worth drawing.
+constexpr std::size_t kMaxRows = 256;
+
+} // namespace
+
+void ScannerPanel::Draw(UiContext& ctx) {
+    ImGui::SetNextWindowPos(ImVec2(10, 500), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowSize(ImVec2(505, 488), ImGuiCond_FirstUseEver);
+    ImGui::Begin("Memory Scanner");
+
+    DebugSession& session = ctx.session;
+    const ScanOp op = static_cast<ScanOp>(op_);
+
+    ImGui::SetNextItemWidth(70);
+    ImGui::Combo("##width", &width_, "8-bit\0" "16-bit\0");
+    ImGui::SameLine();
+    ImGui::Checkbox("RAM only", &ram_only_);
+    ImGui::SameLine();
+    if (ImGui::Button("Start")) {
+        scanner_.Start(session, width_ == 0 ? ScanWidth::Byte : ScanWidth::Word,
+                       ram_only_ ? 0x4000 : 0x0000, 0xFFFF);
+        every_frame_ = false;
+    }
+
+    ImGui::SetNextItemWidth(110);
+    ImGui::Combo("##op", &op_, "equal\0changed\0unchanged\0increased\0decreased\0changed by\0");
+    if (op == ScanOp::Equal || op == ScanOp::ChangedBy) {
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(90);
+        ImGui::InputInt("##operand", &operand_);
+    }
+    ImGui::SameLine();
+    ImGui::BeginDisabled(!scanner_.Started());
+    if (ImGui::Button("Refine")) scanner_.Refine(session, op, static_cast<uint16_t>(operand_));
+    ImGui::SameLine();
+    ImGui::Checkbox("Every frame", &every_frame_);
+    ImGui::EndDisabled();
+    if (every_frame_ && scanner_.Started() && session.State() == RunState::Running)
+        scanner_.Refine(session, op, static_cast<uint16_t>(operand_));
+
+    if (!scanner_.Started()) {
+        ImGui::TextDisabled("Press Start to snapshot memory.");
+        ImGui::End();
+        return;
+    }
+    ImGui::Text("%zu candidate(s) after %u step(s)", scanner_.Count(), scanner_.Steps());
+
+    const bool word = scanner_.Width() == ScanWidth::Word;
+    const std::vector<uint16_t> rows = scanner_.Candidates(kMaxRows);
+    const std::vector<uint16_t> watched = session.Watchpoints();   // sorted
+    if (!rows.empty() &&
+        ImGui::BeginTable("cands", 3,
+                          ImGuiTableFlags_Borders | ImGuiTableFlags_ScrollY |
+                          ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit)) {
+        ImGui::TableSetupColumn("Address");
+        ImGui::TableSetupColumn("Value");
+        ImGui::TableSetupColumn("Symbol");
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableHeadersRow();
+        for (const uint16_t a : rows) {
+            ImGui::TableNextRow();
+            ImGui::PushID(a);
+            ImGui::TableSetColumnIndex(0);
+            char addr[8];
+            std::snprintf(addr, sizeof(addr), "%04X", a);
+            const bool is_watched = std::binary_search(watched.begin(), watched.end(), a);
+            if (ImGui::Selectable(addr, is_watched, ImGuiSelectableFlags_SpanAllColumns)) {
+                if (is_watched) session.RemoveWatchpoint(a);
+                else            session.AddWatchpoint(a);
+            }
+            if (ImGui::BeginPopupContextItem("lbl")) {
+                if (ImGui::IsWindowAppearing()) PrimeSymbolEdit(edit_, a, ctx.symbols);
+                DrawSymbolEditForm(ctx, edit_);
+                ImGui::EndPopup();
+            }
+            ImGui::TableSetColumnIndex(1);
+            const uint16_t v = scanner_.ValueAt(a);
+            if (word) ImGui::Text("%04X (%u)", v, v);
+            else      ImGui::Text("%02X (%u)", v, v);
+            ImGui::TableSetColumnIndex(2);
+            if (auto sym = ctx.symbols.FindContaining(a)) ImGui::TextUnformatted(sym->name.c_str());
+            ImGui::PopID();
+        }
+        ImGui::EndTable();
+    }
+    if (scanner_.Count() > rows.size())
+        ImGui::TextDisabled("(showing the first %zu)", rows.size());
+
+    ImGui::End();
+}
+
+} // namespace z80::dbg
@@ -0,0 +1,36 @@
+//
+// Z80 Digital Twin Debugger - Memory scanner panel
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+
+#ifndef Z80_DBG_SCANNER_PANEL_H
+#define Z80_DBG_SCANNER_PANEL_H
+
+#include "panel.h"
+#include "memory_scanner.h"
+#include "symbol_edit.h"
+
+namespace z80::dbg {
+
+/// @brief Cheat-finder: start a scan, then narrow the candidates with
+///        equal / changed / unchanged / increased / decreased / changed-by
+///        between snapshots, by hand or every frame while the machine runs.
+///        Click a candidate to watch it; right-click to label it.
+class ScannerPanel : public Panel {
+public:
+    void Draw(UiContext& ctx) override;
+
+private:
+    MemoryScanner scanner_;
+    int width_ = 0;          ///< 0 = byte, 1 = word.
+    int op_ = 0;             ///< ScanOp index.
+    int operand_ = 0;        ///< Value for Equal / delta for ChangedBy.
+    bool ram_only_ = true;   ///< Start with 0x4000-0xFFFF only.
+    bool every_frame_ = false;
+    SymbolEditState edit_;
+};
+
+} // namespace z80::dbg
+
+#endif // Z80_DBG_SCANNER_PANEL_H
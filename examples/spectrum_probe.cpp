@@ -23,26 +23,38 @@
 //
 // Usage:
 //   spectrum_probe [rom.rom] [--tape FILE] [--load] [--type "KEYS"]
-//                  [--boot N] [--frames N] [--window N] [--screen] [-h]
+//                  [--boot N] [--frames N] [--window N] [--screen]
+//                  [--hot N] [--sample T | --counters] [--sym FILE]
+//                  [--coverage-out FILE] [--record FILE | --replay FILE]
+//                  [--hash-log FILE] [--no-boot-cache]
+//                  [--snapshot FILE] [--save-snapshot FILE]
+//                  [--lockstep N [--lockstep-sample S]] [-h]
 // See --help for the full list. With no ROM path it looks for $Z80_SPEC48_ROM,
 // then ./spec48.rom, ../spec48.rom.
 //
 
 #include "spectrum/spectrum_machine.h"
+#include "spectrum/boot_cache.h"
+#include "spectrum/input_movie.h"
 #include "spectrum/keyboard.h"
 #include "spectrum/screen.h"
+#include "spectrum/snapshot.h"
 #include "spectrum/video.h"
 #include "spectrum/timing.h"
+#include "coverage_map.h"
 #include "debug_session.h"
+#include "hotspot_profiler.h"
+#include "lockstep_checker.h"
+#include "symbol_table.h"
 
 #include <algorithm>
 #include <array>
 #include <cstdint>
+#include <cstdio>
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
 #include <iterator>
-#include <map>
 #include <string>
 #include <vector>
 
@@ -51,6 +63,8 @@ namespace {
 namespace sm = z80::machine::spectrum;
 namespace kb = z80::machine::spectrum::keyboard;
 using z80::dbg::DebugSession;
+using z80::dbg::HeatSource;
+using z80::dbg::ProfileMode;
 
 std::vector<uint8_t> read_file(const std::string& path) {
     std::ifstream f(path, std::ios::binary);
@@ -73,18 +87,50 @@ std::vector<uint8_t> find_rom(const std::string& explicit_path) {
 
 // -- The instrumented frame ------------------------------------------------
 //
-// Mirrors SpectrumMachine::run_frame(), but advances the CPU through the
-// DebugSession (the breakpoint-aware, coverage-tracking stepper) instead of the
-// machine's raw inner loop. begin_frame()/end_frame() keep the ULA's border
-// timeline and frame counter correct; Interrupt(0xFF) asserts the 50 Hz /INT
-// (and wakes the ROM from its idle HALT). The session measures everything that
-// happens in between.
-void run_instrumented_frame(sm::SpectrumMachine& machine, DebugSession& session) {
-    machine.ula().begin_frame();
-    machine.cpu().Interrupt(0xFF);       // frame interrupt; wakes HALT if IFF1 set
-    session.Run();
-    session.RunForTStates(sm::timing::kTPerFrame);
-    machine.ula().end_frame();
+// SpectrumMachine::run_frame_with() with the DebugSession (the breakpoint-aware,
+// coverage-tracking stepper) in place of the machine's raw inner loop: the same
+// frame budget, /INT and carry as the viewer, so a movie recorded there replays
+// here cycle for cycle. The session measures everything that happens in between.
+//
+// Host input goes through an InputRecorder (logging to a movie with --record),
+// or, with --replay, comes from an InputPlayer that applies the movie's events
+// at their T-states and checks the state hash after every frame. Either way
+// the frame's state hash is at hand (incremental: only written pages are
+// re-hashed), so --hash-log can write one line per frame for cheap diffing.
+//
+// With --lockstep the frames are run by a LockstepChecker instead: the CPU's
+// bulk RunUntilCycle() path, as the viewer runs it, checked against the
+// Step() reference. The session then sees nothing (no coverage or profile).
+struct Rig {
+    sm::SpectrumMachine& machine;
+    DebugSession& session;
+    sm::InputRecorder& input;
+    sm::InputPlayer* replay = nullptr;
+    std::FILE* hash_log = nullptr;
+    uint64_t frame = 0;
+    z80::dbg::LockstepChecker<z80::dbg::DebugCPU>* lockstep = nullptr;
+};
+
+void run_instrumented_frame(Rig& rig) {
+    const auto step = [&rig](uint64_t target) {
+        if (rig.lockstep) return rig.lockstep->Run(target);
+        rig.session.Run();
+        return rig.session.RunForTStates(target).cycles;
+    };
+    if (!rig.replay) {
+        rig.machine.run_frame_with(step);
+        rig.input.end_frame(rig.machine);
+    } else if (!rig.replay->run_frame(rig.machine, step)) {
+        std::cout << "replay: state DIVERGED from the recording at frame "
+                  << *rig.replay->diverged() << " (cycle " << rig.machine.cpu().GetCycleCount()
+                  << ")\n";
+    }
+    const uint64_t frame = rig.frame++;
+    if (rig.hash_log) {
+        const uint64_t hash = rig.replay ? rig.replay->last_hash() : rig.input.last_hash();
+        std::fprintf(rig.hash_log, "%llu %016llx\n", static_cast<unsigned long long>(frame),
+                     static_cast<unsigned long long>(hash));
+    }
 }
 
 // -- Keyboard injection (the 8x5 matrix) -----------------------------------
@@ -98,13 +144,13 @@ struct Chord {
     const char* note;   // for logging
 };
 
-void press_chord(sm::SpectrumMachine& machine, DebugSession& session, const Chord& chord,
-                 int hold_frames, int gap_frames) {
-    machine.ula().release_all_keys();
-    for (const kb::Key& k : chord.keys) machine.ula().key_down(k.half_row, k.bit);
-    for (int i = 0; i < hold_frames; ++i) run_instrumented_frame(machine, session);
-    machine.ula().release_all_keys();
-    for (int i = 0; i < gap_frames; ++i) run_instrumented_frame(machine, session);
+void press_chord(Rig& rig, const Chord& chord, int hold_frames, int gap_frames) {
+    std::array<uint8_t, 8> rows{};
+    for (const kb::Key& k : chord.keys) rows[k.half_row] |= static_cast<uint8_t>(1u << k.bit);
+    rig.input.set_keys(rig.machine, rows);
+    for (int i = 0; i < hold_frames; ++i) run_instrumented_frame(rig);
+    rig.input.set_keys(rig.machine, {});
+    for (int i = 0; i < gap_frames; ++i) run_instrumented_frame(rig);
 }
 
 // Translate a key-script string into chords. Most characters map to their letter
@@ -138,10 +184,10 @@ std::vector<Chord> script_to_chords(const std::string& in) {
     return out;
 }
 
-void type_script(sm::SpectrumMachine& machine, DebugSession& session, const std::string& script) {
+void type_script(Rig& rig, const std::string& script) {
     std::cout << "Typing on the keyboard matrix: \"" << script << "\"\n";
     for (const Chord& chord : script_to_chords(script))
-        press_chord(machine, session, chord, /*hold=*/4, /*gap=*/4);
+        press_chord(rig, chord, /*hold=*/4, /*gap=*/4);
 }
 
 // -- Screen as ASCII --------------------------------------------------------
@@ -184,27 +230,41 @@ void dump_screen_ascii(const sm::SpectrumMachine& machine) {
 // loop": a working loader keeps executing fresh code (coverage grows) and keeps
 // writing loaded bytes into RAM (dirty RAM outside the screen file grows). A
 // freeze executes the same handful of bytes forever — coverage and RAM writes
-// flatline while the PC stays pinned to a tiny address range.
+// flatline while the PC stays pinned to a tiny address range. The hot page is
+// where the session's profiler (sampling or exact counts) saw the most
+// execution during the window.
 struct Window {
     uint32_t cov_before = 0;
     uint16_t pc_min = 0xFFFF, pc_max = 0;
-    std::map<uint16_t, int> pc_pages;   // PC>>8 -> sample count (frame-boundary)
+    std::array<uint64_t, 256> page_hits{};   // PC>>8 -> profile total at window start
     int non_screen_writes = 0;
 };
 
-void report_window(DebugSession& session, sm::SpectrumMachine& machine, int frames, int window) {
+// Profile hits per 256-byte page so far (samples, or exact execution counts).
+std::array<uint64_t, 256> page_hits(const DebugSession& session) {
+    const HeatSource source = session.GetProfileMode() == ProfileMode::Counters
+                                  ? HeatSource::Exec : HeatSource::Samples;
+    std::array<uint64_t, 256> pages{};
+    for (uint32_t a = 0; a < 0x10000; ++a)
+        pages[a >> 8] += session.Profiler().Count(source, static_cast<uint16_t>(a));
+    return pages;
+}
+
+void report_window(Rig& rig, int frames, int window) {
+    DebugSession& session = rig.session;
+    sm::SpectrumMachine& machine = rig.machine;
     std::cout << "\nframe   +code   RAMwr  PC-range        hotpage  border  state\n";
     Window w;
     w.cov_before = session.CoveredBytes();
+    w.page_hits = page_hits(session);
     session.ClearDirty();
 
     for (int f = 1; f <= frames; ++f) {
-        run_instrumented_frame(machine, session);
+        run_instrumented_frame(rig);
 
         const uint16_t pc = machine.cpu().PC();
         w.pc_min = std::min(w.pc_min, pc);
         w.pc_max = std::max(w.pc_max, pc);
-        ++w.pc_pages[static_cast<uint16_t>(pc >> 8)];
 
         if (f % window == 0 || f == frames) {
             // Count RAM writes outside the display file (0x4000-0x5AFF): real load
@@ -215,8 +275,12 @@ void report_window(DebugSession& session, sm::SpectrumMachine& machine, int fram
             w.non_screen_writes = ram;
 
             const uint32_t new_code = session.CoveredBytes() - w.cov_before;
-            uint16_t hot = 0; int hot_n = -1;
-            for (auto [page, n] : w.pc_pages) if (n > hot_n) { hot_n = n; hot = page; }
+            const std::array<uint64_t, 256> pages = page_hits(session);
+            uint16_t hot = 0; uint64_t hot_n = 0;
+            for (uint16_t page = 0; page < 256; ++page) {
+                const uint64_t n = pages[page] - w.page_hits[page];
+                if (n > hot_n) { hot_n = n; hot = page; }
+            }
             const bool in_rom = w.pc_max < 0x4000;
             const bool tight = (w.pc_max - w.pc_min) < 0x100;
 
@@ -235,7 +299,7 @@ void report_window(DebugSession& session, sm::SpectrumMachine& machine, int fram
 
             // reset the window
             w.cov_before = session.CoveredBytes();
-            w.pc_min = 0xFFFF; w.pc_max = 0; w.pc_pages.clear();
+            w.pc_min = 0xFFFF; w.pc_max = 0; w.page_hits = pages;
             session.ClearDirty();
         }
     }
@@ -254,22 +318,54 @@ void print_usage(const char* prog) {
         "  --type \"KEYS\"   Type a key-script before running. Specials: L=LOAD token,\n"
         "                  \"=SYM+P quote, _ or space=SPACE, newline=ENTER.\n"
         "  --play          Start the tape (without typing LOAD).\n"
-        "  --boot N        Frames to boot before typing (default 100).\n"
+        "  --boot N        Frames to boot before typing (default 100). The booted\n"
+        "                  state comes from the boot snapshot cache after the first\n"
+        "                  run ($Z80_SNAPSHOT_CACHE), so boot frames aren't profiled.\n"
         "  --frames N      Frames to run and instrument after load (default 2500).\n"
         "  --window N      Report every N frames (default 100).\n"
         "  --screen        Dump the screen as ASCII at the end.\n"
+        "  --hot N         Print the N hottest code blocks at the end (default 10).\n"
+        "  --sample T      Sample the PC every T T-states (default 224, one line).\n"
+        "  --counters      Count every instruction exactly instead of sampling.\n"
+        "  --sym FILE      Name hot code with symbols from a .sym file.\n"
+        "  --coverage-out FILE  Save the run's coverage (.cov) for coverage_tool.\n"
+        "  --record FILE   Save the run's input (typing, tape) as a movie (.zmv).\n"
+        "  --replay FILE   Drive the machine from a movie (recorded here or in the\n"
+        "                  viewer) instead of --tape/--load/--type/--boot; every\n"
+        "                  frame is checked against the recorded state hash.\n"
+        "                  --frames defaults to the movie's length.\n"
+        "  --hash-log FILE Write \"frame hash\" per frame (machine state hash) —\n"
+        "                  diff two logs to find where runs diverge.\n"
+        "  --no-boot-cache Always cold-boot, instrumenting the boot frames too.\n"
+        "                  (Implied by --record and --hash-log, which start at\n"
+        "                  power-on.)\n"
+        "  --snapshot FILE Start from a .sna/.z80 snapshot instead of booting\n"
+        "                  (not with --record/--replay).\n"
+        "  --save-snapshot FILE  Save the final state as .sna/.z80.\n"
+        "  --lockstep N    Run the frames on the CPU's fast path, checked against the\n"
+        "                  Step() reference every N T-states (0: every instruction);\n"
+        "                  the first divergence is reported and fails the run. The\n"
+        "                  session is bypassed (no coverage or profile).\n"
+        "  --lockstep-sample S  Check only one block in S.\n"
         "  -h, --help      Show this help.\n\n"
         "Examples:\n"
         "  " << prog << " spec48.rom --tape underwurlde.tzx --load --screen\n"
-        "  " << prog << " spec48.rom --boot 200 --screen        # just boot to BASIC\n";
+        "  " << prog << " spec48.rom --boot 200 --screen        # just boot to BASIC\n"
+        "  " << prog << " spec48.rom --snapshot manic.z80 --frames 500 --hot 20\n"
+        "  " << prog << " spec48.rom --replay jetpac.zmv --counters  # profile a recorded game\n";
 }
 
 } // namespace
 
 int main(int argc, char** argv) {
     std::string rom_path, tape_path, type_script_str;
-    int boot = 100, frames = 2500, window = 100;
-    bool do_load = false, do_play = false, do_screen = false;
+    std::string sym_path, coverage_path, record_path, replay_path, hash_log_path;
+    std::string snapshot_path, save_snapshot_path;
+    int boot = 100, frames = -1, window = 100, hot = 10, sample = 224;
+    bool do_load = false, do_play = false, do_screen = false, counters = false;
+    bool boot_cache = true;
+    bool lockstep = false;
+    z80::dbg::LockstepOptions lockstep_options;
 
     for (int i = 1; i < argc; ++i) {
         const std::string a = argv[i];
@@ -279,52 +375,192 @@ int main(int argc, char** argv) {
         else if (a == "--load") do_load = true;
         else if (a == "--play") do_play = true;
         else if (a == "--screen") do_screen = true;
+        else if (a == "--counters") counters = true;
+        else if (a == "--no-boot-cache") boot_cache = false;
+        else if (a == "--sym" && i + 1 < argc) sym_path = argv[++i];
+        else if (a == "--coverage-out" && i + 1 < argc) coverage_path = argv[++i];
+        else if (a == "--record" && i + 1 < argc) record_path = argv[++i];
+        else if (a == "--replay" && i + 1 < argc) replay_path = argv[++i];
+        else if (a == "--hash-log" && i + 1 < argc) hash_log_path = argv[++i];
+        else if (a == "--snapshot" && i + 1 < argc) snapshot_path = argv[++i];
+        else if (a == "--save-snapshot" && i + 1 < argc) save_snapshot_path = argv[++i];
+        else if (a == "--hot" && i + 1 < argc) hot = std::atoi(argv[++i]);
+        else if (a == "--sample" && i + 1 < argc) sample = std::atoi(argv[++i]);
         else if (a == "--boot" && i + 1 < argc) boot = std::atoi(argv[++i]);
         else if (a == "--frames" && i + 1 < argc) frames = std::atoi(argv[++i]);
         else if (a == "--window" && i + 1 < argc) window = std::atoi(argv[++i]);
+        else if (a == "--lockstep" && i + 1 < argc) {
+            lockstep = true;
+            lockstep_options.interval = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (a == "--lockstep-sample" && i + 1 < argc)
+            lockstep_options.sample = std::max<uint64_t>(1, std::strtoull(argv[++i], nullptr, 10));
         else if (!a.empty() && a[0] != '-') rom_path = a;
         else std::cerr << "Unknown argument: " << a << "\n";
     }
+    if (!record_path.empty() && !replay_path.empty()) {
+        std::cerr << "--record and --replay are mutually exclusive.\n";
+        return 2;
+    }
+    if (!snapshot_path.empty() && (!record_path.empty() || !replay_path.empty())) {
+        std::cerr << "--snapshot can't be combined with --record/--replay (movies start at power-on).\n";
+        return 2;
+    }
     if (window < 1) window = 1;
+    if (sample < 1) sample = 1;
 
     const std::vector<uint8_t> rom = find_rom(rom_path);
     if (rom.empty()) { std::cerr << "No ROM found. Pass a path or set Z80_SPEC48_ROM.\n"; return 1; }
 
+    sm::InputMovie movie;
+    if (!replay_path.empty()) {
+        std::string why;
+        if (!movie.load_file(replay_path, &why)) {
+            std::cerr << replay_path << ": " << why << "\n";
+            return 1;
+        }
+        if (movie.rom_hash != sm::InputMovie::hash_rom(rom))
+            std::cerr << "warning: movie was recorded on a different ROM; expect divergence\n";
+        std::cout << "Replay: " << replay_path << " (" << movie.frames() << " frames, "
+                  << movie.events.size() << " events)\n";
+        if (frames < 0) frames = static_cast<int>(movie.frames());
+    } else {
+        movie.rom_hash = sm::InputMovie::hash_rom(rom);
+    }
+    if (frames < 0) frames = 2500;
+
     sm::SpectrumMachine machine;
     if (!machine.load_rom(rom)) { std::cerr << "Failed to load ROM (<=16 KB).\n"; return 1; }
-    machine.set_rom_write_protect(true);
+    machine.set_rom_write_protect(replay_path.empty() ||
+                                  (movie.flags & sm::InputMovie::kRomWriteProtect) != 0);
 
     // The DebugSession drives the very CPU the machine runs (same template config),
     // giving full instrumentation over the live machine.
     DebugSession session(machine.cpu());
+    // The recorder logs (and so hashes) when recording or when a hash log is
+    // wanted; the movie is only saved with --record.
+    const bool log_input = !record_path.empty() || (!hash_log_path.empty() && replay_path.empty());
+    sm::InputRecorder input(log_input ? &movie : nullptr);
+    sm::InputPlayer player(movie);
+    Rig rig{machine, session, input, replay_path.empty() ? nullptr : &player};
+    z80::dbg::LockstepChecker<z80::dbg::DebugCPU> checker(machine.cpu(), lockstep_options);
+    if (lockstep) rig.lockstep = &checker;
+    if (!hash_log_path.empty()) {
+        rig.hash_log = std::fopen(hash_log_path.c_str(), "w");
+        if (!rig.hash_log) { std::cerr << "Could not write " << hash_log_path << "\n"; return 1; }
+    }
 
-    if (!tape_path.empty()) {
+    if (!tape_path.empty() && !rig.replay) {
         const std::vector<uint8_t> tape = read_file(tape_path);
-        if (tape.empty() || !machine.load_tape(tape)) { std::cerr << "Failed to load tape.\n"; return 1; }
+        if (tape.empty() || !input.tape_insert(machine, tape)) { std::cerr << "Failed to load tape.\n"; return 1; }
         std::cout << "Tape: " << tape_path << " (" << machine.tape().block_count()
                   << " blocks, " << machine.tape().pulse_count() << " pulses, "
                   << machine.tape().total_tstates() / sm::timing::kCpuHz << "s)\n";
     }
 
-    std::cout << "Booting " << boot << " frames to BASIC...\n";
-    for (int i = 0; i < boot; ++i) run_instrumented_frame(machine, session);
+    if (!rig.replay) {
+        // A recorded or hash-logged run must start at power-on, frame by frame.
+        if (!snapshot_path.empty()) {
+            std::string why;
+            if (!sm::load_snapshot_file(machine, snapshot_path, &why)) {
+                std::cerr << snapshot_path << ": " << why << "\n";
+                return 1;
+            }
+            std::cout << "Snapshot: " << snapshot_path << " (PC=" << std::hex << machine.cpu().PC()
+                      << std::dec << ")\n";
+        } else if (boot_cache && !log_input && boot > 0) {
+            const bool hit = sm::BootCache().boot(machine, rom, static_cast<uint32_t>(boot));
+            std::cout << "Booted " << boot << " frames to BASIC ("
+                      << (hit ? "boot cache" : "cold boot, now cached") << ")\n";
+        } else {
+            std::cout << "Booting " << boot << " frames to BASIC...\n";
+            for (int i = 0; i < boot; ++i) run_instrumented_frame(rig);
+        }
 
-    if (do_load) type_script(machine, session, "L\"\"\n");
-    else if (!type_script_str.empty()) type_script(machine, session, type_script_str);
+        if (do_load) type_script(rig, "L\"\"\n");
+        else if (!type_script_str.empty()) type_script(rig, type_script_str);
 
-    if (do_load || do_play) {
-        machine.play_tape();
-        std::cout << "Tape: play (cycle " << machine.cpu().GetCycleCount() << ")\n";
+        if (do_load || do_play) {
+            input.tape_play(machine);
+            std::cout << "Tape: play (cycle " << machine.cpu().GetCycleCount() << ")\n";
+        }
     }
 
+    z80::dbg::SymbolTable symbols;
+    if (!sym_path.empty() && !symbols.LoadFromFile(sym_path))
+        std::cerr << "Could not read symbols from " << sym_path << "\n";
+
+    // Profile only the instrumented run, not the boot.
+    session.SetSampleInterval(static_cast<uint32_t>(sample));
+    session.SetProfileMode(counters ? ProfileMode::Counters : ProfileMode::Sampling);
+
     std::cout << "\nInstrumenting " << frames << " frames (~" << frames / 50 << "s emulated):";
-    report_window(session, machine, frames, window);
+    report_window(rig, frames, window);
 
     std::cout << "\nTotals: coverage " << session.CoveredBytes() << " bytes ("
               << session.CoveragePercent() << "%), SMC writes " << session.SmcCount()
               << ", frame " << machine.frame_count() << ", PC=" << std::hex << machine.cpu().PC()
               << std::dec << "\n";
 
+    if (hot > 0) {
+        const auto spots = session.Profiler().HottestCode(static_cast<std::size_t>(hot),
+                                                          &session.Cfg(), &symbols);
+        std::cout << "\nHottest code (" << (counters ? "exact counts" : "PC samples") << "):\n";
+        for (const auto& s : spots)
+            std::printf("  %04X-%04X  %10llu  %5.1f%%  %s\n", s.start,
+                        static_cast<unsigned>(s.end - 1),
+                        static_cast<unsigned long long>(s.hits), s.percent, s.label.c_str());
+    }
+
+    if (!coverage_path.empty()) {
+        const auto coverage = z80::dbg::CoverageMap::FromSession(
+            session, tape_path.empty() ? type_script_str : tape_path);
+        if (coverage.SaveToFile(coverage_path))
+            std::cout << "Coverage saved to " << coverage_path << "\n";
+        else
+            std::cerr << "Could not write " << coverage_path << "\n";
+    }
+
+    if (!record_path.empty()) {
+        if (movie.save_file(record_path))
+            std::cout << "Movie saved to " << record_path << " (" << movie.frames() << " frames, "
+                      << movie.events.size() << " events)\n";
+        else
+            std::cerr << "Could not write " << record_path << "\n";
+    }
+
+    if (!save_snapshot_path.empty()) {
+        std::string why;
+        if (sm::save_snapshot_file(machine, save_snapshot_path, &why))
+            std::cout << "Snapshot saved to " << save_snapshot_path << "\n";
+        else
+            std::cerr << save_snapshot_path << ": " << why << "\n";
+    }
+
+    if (rig.hash_log) {
+        std::fclose(rig.hash_log);
+        std::cout << "Hash log: " << rig.frame << " frames to " << hash_log_path << "\n";
+    }
+
     if (do_screen) { std::cout << "\n"; dump_screen_ascii(machine); }
+    if (lockstep) {
+        const auto& s = checker.Stats();
+        std::cout << "\nLockstep: " << s.checked << " of " << s.blocks << " blocks checked, "
+                  << s.instructions << " instructions";
+        if (s.unverifiable != 0) std::cout << ", " << s.unverifiable << " unverifiable";
+        std::cout << "\n";
+        if (checker.Diverged()) {
+            std::cout << checker.GetDivergence()->Report();
+            return 1;
+        }
+    }
+    if (rig.replay) {
+        if (player.diverged()) {
+            std::cout << "replay: FAILED, first divergence at frame " << *player.diverged() << "\n";
+            return 1;
+        }
+        std::cout << "replay: " << std::min(player.frame(), movie.frames())
+                  << " recorded frames matched\n";
+    }
     return 0;
 }
@@ -0,0 +1,476 @@
+//
+// Z80 Digital Twin - CP/M 2.2 machine
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// Runs a CP/M .COM program on a bare CPU with the BDOS and BIOS implemented
+// on the host. The page-zero layout is CP/M's own:
+//
+//   0000h  JP BIOS+3    warm boot (programs exit with JP 0)
+//   0005h  JP BDOS      the BDOS entry; (0006h) is the top of the TPA
+//   0080h  default DMA buffer / command tail
+//   0100h  the program (TPA)
+//   FE00h  BDOS         a HALT
+//   FF00h  BIOS         17 three-byte entries, each a HALT
+//
+// The HALTs are the traps. RunUntilCycle() already stops on HALT, so the
+// program runs at full bulk speed and nothing is compared per instruction:
+// a trap costs the guest one CALL and one HALT, and the host only looks
+// when the CPU stops. run_until() then identifies the entry from the halted
+// PC, performs the call, returns to the caller (as the stub's RET would)
+// and resumes. A HALT anywhere else is the program's own, and stops the run.
+//
+// BDOS calls supported: console I/O (1, 2, 6, 9, 10, 11), version, disk
+// reset/select, DMA, user code, and the file calls (15-23, 33-36) against a
+// host directory sandbox (host_directory.h). An unsupported call stops the
+// run with Stop::kUnsupported rather than guessing.
+//
+
+#ifndef Z80_MACHINE_CPM_CPM_MACHINE_H
+#define Z80_MACHINE_CPM_CPM_MACHINE_H
+
+#include "z80_cpu.h"
+#include "host_directory.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace z80::machine::cpm {
+
+inline constexpr uint16_t kTpa = 0x0100;
+inline constexpr uint16_t kDefaultDma = 0x0080;
+inline constexpr uint16_t kBdos = 0xFE00;
+inline constexpr uint16_t kBios = 0xFF00;
+inline constexpr int kBiosEntries = 17;
+
+/// @brief Why run_until() returned.
+enum class Stop {
+    kBudget,        ///< Reached the target T-state; call again to continue
+    kWarmBoot,      ///< Jumped to 0000h (or BIOS WBOOT): the program exited
+    kSystemReset,   ///< BDOS 0
+    kHalted,        ///< The program's own HALT
+    kUnsupported,   ///< A BDOS/BIOS call this machine does not implement
+};
+
+struct CpmState;
+
+template <class Cpu = z80::CPU>
+class BasicCpmMachine {
+public:
+    BasicCpmMachine() { reset(); }
+
+    /// @brief Clear memory, rebuild page zero and the trap stubs, reset the
+    ///        CPU, the console and the DMA address.
+    void reset() {
+        cpu_.LoadProgram(std::vector<uint8_t>(0x10000, 0), 0x0000);
+        cpu_.Reset();
+        write_jump(0x0000, kBios + 3);
+        write_jump(0x0005, kBdos);
+        cpu_.WriteMemory(kBdos, 0x76);
+        for (int i = 0; i < kBiosEntries; ++i) cpu_.WriteMemory(static_cast<uint16_t>(kBios + 3 * i), 0x76);
+        console_.clear();
+        input_pos_ = 0;
+        dma_ = kDefaultDma;
+        search_.clear();
+        search_next_ = 0;
+        reason_.clear();
+    }
+
+    /// @brief Load @p program at 0100h, with the stack just below the BDOS
+    ///        holding a return into the warm boot, as CP/M's CCP leaves it.
+    bool load_com(std::span<const uint8_t> program) {
+        if (program.empty() || program.size() > kBdos - kTpa - 2) return false;
+        for (std::size_t i = 0; i < program.size(); ++i)
+            cpu_.WriteMemory(static_cast<uint16_t>(kTpa + i), program[i]);
+        cpu_.SetHalted(false);
+        cpu_.PC() = kTpa;
+        cpu_.SP() = kBdos - 2;
+        cpu_.WriteMemory(kBdos - 2, 0x00);
+        cpu_.WriteMemory(kBdos - 1, 0x00);
+        return true;
+    }
+
+    /// @brief Attach the directory the file calls read and write.
+    void set_directory(std::filesystem::path root) { disk_ = HostDirectory(std::move(root)); }
+
+    /// @brief Text the console input calls read; past its end they see ^Z.
+    void set_input(std::string text) {
+        input_ = std::move(text);
+        input_pos_ = 0;
+    }
+
+    /// @brief Run until the CPU clock reaches @p target_tstate, or the
+    ///        program stops. @p instructions, if given, counts completed
+    ///        instructions — which costs the bulk path: the CPU is then
+    ///        stepped one instruction at a time. Once the program has
+    ///        stopped, calling again reports the same stop.
+    Stop run_until(uint64_t target_tstate, uint64_t* instructions = nullptr) {
+        while (cpu_.GetCycleCount() < target_tstate) {
+            if (instructions) {
+                while (cpu_.GetCycleCount() < target_tstate && !cpu_.IsHalted()) {
+                    do { cpu_.Step(); } while (!cpu_.InstructionComplete());
+                    ++*instructions;
+                }
+            } else {
+                cpu_.RunUntilCycle(target_tstate);
+            }
+            if (!cpu_.IsHalted()) continue;
+            if (const auto stop = trap()) return *stop;
+        }
+        return Stop::kBudget;
+    }
+
+    /// @brief run_until() advancing the CPU through @p step instead of
+    ///        RunUntilCycle() — e.g. a LockstepChecker checking it.
+    /// @param step  Callable `uint64_t(uint64_t tstates)` (see
+    ///              Machine::RunFrame) that stops early on HALT.
+    template <class Stepper>
+    Stop run_until_with(uint64_t target_tstate, Stepper&& step) {
+        while (cpu_.GetCycleCount() < target_tstate) {
+            step(target_tstate - cpu_.GetCycleCount());
+            if (!cpu_.IsHalted()) continue;
+            if (const auto stop = trap()) return *stop;
+        }
+        return Stop::kBudget;
+    }
+
+    /// @brief Everything written to the console, raw (CR LF as sent).
+    [[nodiscard]] const std::string& console() const { return console_; }
+    /// @brief What stopped the last run, in words (unsupported call, ...).
+    [[nodiscard]] const std::string& reason() const { return reason_; }
+    [[nodiscard]] uint16_t dma() const { return dma_; }
+
+    [[nodiscard]] Cpu& cpu() noexcept { return cpu_; }
+    [[nodiscard]] const Cpu& cpu() const noexcept { return cpu_; }
+
+private:
+    friend struct CpmState;
+
+    void write_jump(uint16_t at, uint16_t target) {
+        cpu_.WriteMemory(at, 0xC3);
+        cpu_.WriteMemory(static_cast<uint16_t>(at + 1), static_cast<uint8_t>(target));
+        cpu_.WriteMemory(static_cast<uint16_t>(at + 2), static_cast<uint8_t>(target >> 8));
+    }
+
+    uint16_t read_word(uint16_t addr) const {
+        return static_cast<uint16_t>(cpu_.ReadMemory(addr) | (cpu_.ReadMemory(static_cast<uint16_t>(addr + 1)) << 8));
+    }
+
+    void ret() {
+        cpu_.PC() = read_word(cpu_.SP());
+        cpu_.SP() = static_cast<uint16_t>(cpu_.SP() + 2);
+    }
+
+    /// BDOS convention: the result in A and L, B and H.
+    void result(uint8_t a) { result16(a); }
+    void result16(uint16_t hl) {
+        cpu_.HL() = hl;
+        cpu_.A() = cpu_.L();
+        cpu_.B() = cpu_.H();
+    }
+    /// Set the result and carry on running.
+    std::optional<Stop> returns(uint8_t a) {
+        result(a);
+        return std::nullopt;
+    }
+
+    int read_input() {
+        if (input_pos_ >= input_.size()) return -1;
+        return static_cast<unsigned char>(input_[input_pos_++]);
+    }
+
+    /// The CPU halted: serve the trap and return nullopt to keep running.
+    std::optional<Stop> trap() {
+        const uint16_t at = static_cast<uint16_t>(cpu_.PC() - 1);
+        if (at == kBdos) return serve(bdos(cpu_.C()));
+        if (at >= kBios && at < kBios + 3 * kBiosEntries && (at - kBios) % 3 == 0)
+            return serve(bios((at - kBios) / 3));
+        reason_ = "HALT at " + hex(at);
+        return Stop::kHalted;
+    }
+
+    /// Return from a served call. A call that stops the run leaves the CPU
+    /// halted on its trap, so run_until() again reports the same stop.
+    std::optional<Stop> serve(std::optional<Stop> stop) {
+        if (stop) return stop;
+        cpu_.SetHalted(false);
+        ret();
+        return std::nullopt;
+    }
+
+    std::optional<Stop> bios(int entry) {
+        switch (entry) {
+        case 0:
+        case 1: reason_ = "CP/M warm boot"; return Stop::kWarmBoot;
+        case 2: cpu_.A() = input_pos_ < input_.size() ? 0xFF : 0x00; return std::nullopt;
+        case 3: {
+            const int ch = read_input();
+            cpu_.A() = ch < 0 ? kEndOfText : static_cast<uint8_t>(ch);
+            return std::nullopt;
+        }
+        case 4: console_ += static_cast<char>(cpu_.C()); return std::nullopt;
+        case 5:
+        case 6: return std::nullopt;   // LIST, PUNCH: no device, output dropped
+        case 7: cpu_.A() = kEndOfText; return std::nullopt;   // READER
+        default:
+            reason_ = "unsupported BIOS entry " + std::to_string(entry);
+            return Stop::kUnsupported;
+        }
+    }
+
+    std::optional<Stop> bdos(uint8_t function) {
+        const uint16_t de = cpu_.DE();
+        switch (function) {
+        case 0: reason_ = "BDOS system reset"; return Stop::kSystemReset;
+        case 1: {   // console input, echoed
+            const int ch = read_input();
+            const auto c = ch < 0 ? kEndOfText : static_cast<uint8_t>(ch);
+            if (ch >= 0) console_ += static_cast<char>(c);
+            result(c);
+            break;
+        }
+        case 2: console_ += static_cast<char>(cpu_.E()); break;
+        case 3: result(kEndOfText); break;   // reader
+        case 4:
+        case 5: break;                       // punch, list
+        case 6:     // direct console I/O
+            if (cpu_.E() == 0xFF) {
+                const int ch = read_input();
+                result(ch < 0 ? 0 : static_cast<uint8_t>(ch));
+            } else {
+                console_ += static_cast<char>(cpu_.E());
+            }
+            break;
+        case 7:
+        case 8: result(0); break;            // IOBYTE
+        case 9:
+            for (uint16_t a = de, n = 0; n < 0xFFFF; ++a, ++n) {
+                const uint8_t ch = cpu_.ReadMemory(a);
+                if (ch == '$') break;
+                console_ += static_cast<char>(ch);
+            }
+            break;
+        case 10: read_line(de); break;
+        case 11: result(input_pos_ < input_.size() ? 0xFF : 0x00); break;
+        case 12: result16(0x0022); break;    // CP/M 2.2
+        case 13: dma_ = kDefaultDma; result(0); break;
+        case 14: result(0); break;           // select disk: there is only A:
+        case 15: return file(function, de);
+        case 16: return file(function, de);
+        case 17:
+        case 18: search(function == 17, de); break;
+        case 19:
+        case 20:
+        case 21:
+        case 22:
+        case 23: return file(function, de);
+        case 24: result16(0x0001); break;    // login vector: A:
+        case 25: result(0); break;           // current disk: A:
+        case 26: dma_ = de; break;
+        case 32: result(0); break;           // user code: always 0
+        case 33:
+        case 34:
+        case 35:
+        case 36: return file(function, de);
+        default:
+            reason_ = "unsupported BDOS call C=" + std::to_string(function);
+            return Stop::kUnsupported;
+        }
+        return std::nullopt;
+    }
+
+    /// BDOS 10: DE -> max length, count, text. Input ends at CR or LF.
+    void read_line(uint16_t buffer) {
+        const uint8_t max = cpu_.ReadMemory(buffer);
+        uint8_t n = 0;
+        for (int ch; n < max && (ch = read_input()) >= 0;) {
+            if (ch == '\r' || ch == '\n') {
+                if (ch == '\r' && input_pos_ < input_.size() && input_[input_pos_] == '\n') ++input_pos_;
+                break;
+            }
+            cpu_.WriteMemory(static_cast<uint16_t>(buffer + 2 + n++), static_cast<uint8_t>(ch));
+            console_ += static_cast<char>(ch);
+        }
+        cpu_.WriteMemory(static_cast<uint16_t>(buffer + 1), n);
+        console_ += "\r\n";
+    }
+
+    std::optional<FileName> fcb_name(uint16_t fcb, uint16_t offset = fcb::kName) const {
+        std::array<uint8_t, 11> bytes{};
+        for (uint16_t i = 0; i < 11; ++i) bytes[i] = cpu_.ReadMemory(static_cast<uint16_t>(fcb + offset + i));
+        return FileName::from_fcb(bytes);
+    }
+
+    uint8_t fcb_byte(uint16_t fcb, uint16_t field) const { return cpu_.ReadMemory(static_cast<uint16_t>(fcb + field)); }
+    void set_fcb_byte(uint16_t fcb, uint16_t field, uint8_t v) { cpu_.WriteMemory(static_cast<uint16_t>(fcb + field), v); }
+
+    uint32_t sequential_record(uint16_t fcb) const {
+        return ((fcb_byte(fcb, fcb::kS2) & 0x3Fu) * 32u + (fcb_byte(fcb, fcb::kExtent) & 0x1Fu)) * 128u +
+               (fcb_byte(fcb, fcb::kCurrent) & 0x7Fu);
+    }
+
+    /// Point EX/S2/CR at @p record and RC at the records of that extent.
+    void set_position(uint16_t fcb, uint32_t record, uint32_t file_records) {
+        set_fcb_byte(fcb, fcb::kCurrent, static_cast<uint8_t>(record & 0x7F));
+        set_fcb_byte(fcb, fcb::kExtent, static_cast<uint8_t>((record >> 7) & 0x1F));
+        set_fcb_byte(fcb, fcb::kS2, static_cast<uint8_t>(record >> 12));
+        const uint32_t extent_start = record & ~0x7Fu;
+        const uint32_t in_extent = file_records > extent_start ? file_records - extent_start : 0;
+        set_fcb_byte(fcb, fcb::kRecordCount, static_cast<uint8_t>(std::min<uint32_t>(in_extent, 128)));
+    }
+
+    uint32_t random_record(uint16_t fcb) const {
+        return fcb_byte(fcb, fcb::kRandom) | (fcb_byte(fcb, fcb::kRandom + 1) << 8);
+    }
+
+    void set_random_record(uint16_t fcb, uint32_t record) {
+        set_fcb_byte(fcb, fcb::kRandom, static_cast<uint8_t>(record));
+        set_fcb_byte(fcb, fcb::kRandom + 1, static_cast<uint8_t>(record >> 8));
+        set_fcb_byte(fcb, fcb::kRandom + 2, static_cast<uint8_t>(record >> 16));
+    }
+
+    std::array<uint8_t, kRecordBytes> dma_record() const {
+        std::array<uint8_t, kRecordBytes> data{};
+        for (std::size_t i = 0; i < kRecordBytes; ++i) data[i] = cpu_.ReadMemory(static_cast<uint16_t>(dma_ + i));
+        return data;
+    }
+
+    void to_dma(std::span<const uint8_t> data) {
+        for (std::size_t i = 0; i < data.size(); ++i) cpu_.WriteMemory(static_cast<uint16_t>(dma_ + i), data[i]);
+    }
+
+    /// The file calls. A = FFh (or the call's error code) when it fails.
+    std::optional<Stop> file(uint8_t function, uint16_t fcb) {
+        const auto name = fcb_name(fcb);
+        if (!name) return returns(0xFF);
+        const auto path = disk_.find_first(*name);
+
+        switch (function) {
+        case 15:    // open
+            if (!path) return returns(0xFF);
+            set_position(fcb, sequential_record(fcb) & ~0x7Fu, HostDirectory::records(*path));
+            result(0);
+            break;
+        case 16: result(path ? 0 : 0xFF); break;   // close: nothing is buffered
+        case 19: {  // delete
+            bool any = false;
+            std::error_code ec;
+            for (const auto& p : disk_.find(*name)) any = std::filesystem::remove(p, ec) || any;
+            result(any ? 0 : 0xFF);
+            break;
+        }
+        case 20:    // read sequential
+        case 21: {  // write sequential
+            if (!path) return returns(0xFF);
+            const uint32_t record = sequential_record(fcb);
+            bool ok = true;
+            if (function == 20) {
+                std::array<uint8_t, kRecordBytes> data{};
+                ok = HostDirectory::read_record(*path, record, data);
+                if (ok) to_dma(data);
+            } else {
+                ok = HostDirectory::write_record(*path, record, dma_record());
+            }
+            if (!ok) return returns(function == 20 ? 1 : 2);   // EOF / disk full
+            set_position(fcb, record + 1, HostDirectory::records(*path));
+            result(0);
+            break;
+        }
+        case 22: {  // make
+            const auto made = disk_.create(*name);
+            if (!made) return returns(0xFF);
+            set_position(fcb, sequential_record(fcb) & ~0x7Fu, 0);
+            result(0);
+            break;
+        }
+        case 23: {  // rename: new name in the FCB's second half
+            const auto to = fcb_name(fcb, fcb::kRename + fcb::kName);
+            if (!path || !to || to->wild() || disk_.find_first(*to)) return returns(0xFF);
+            std::error_code ec;
+            std::filesystem::rename(*path, disk_.root() / to->host(), ec);
+            result(ec ? 0xFF : 0);
+            break;
+        }
+        case 33:    // read random
+        case 34: {  // write random
+            if (!path) return returns(0xFF);
+            if (fcb_byte(fcb, fcb::kRandom + 2) != 0) return returns(6);   // out of range
+            const uint32_t record = random_record(fcb);
+            bool ok = true;
+            if (function == 33) {
+                std::array<uint8_t, kRecordBytes> data{};
+                ok = HostDirectory::read_record(*path, record, data);
+                if (ok) to_dma(data);
+            } else {
+                ok = HostDirectory::write_record(*path, record, dma_record());
+            }
+            if (!ok) return returns(function == 33 ? 1 : 2);   // unwritten data / disk full
+            set_position(fcb, record, HostDirectory::records(*path));   // random leaves CR on the record
+            result(0);
+            break;
+        }
+        case 35:    // compute file size
+            if (!path) return returns(0xFF);
+            set_random_record(fcb, HostDirectory::records(*path));
+            result(0);
+            break;
+        case 36:    // set random record from the sequential position
+            set_random_record(fcb, sequential_record(fcb));
+            break;
+        }
+        return std::nullopt;
+    }
+
+    /// BDOS 17/18: one 32-byte directory entry per matching file, at the DMA.
+    void search(bool first, uint16_t fcb) {
+        if (first) {
+            search_.clear();
+            search_next_ = 0;
+            if (const auto name = fcb_name(fcb)) search_ = disk_.find(*name);
+        }
+        // A search restored from a CpmState may hold names find() would not
+        // have returned; skip any that are not 8.3.
+        std::optional<FileName> name;
+        const std::filesystem::path* path = nullptr;
+        while (!name && search_next_ < search_.size()) {
+            path = &search_[search_next_++];
+            name = FileName::from_host(path->filename().string());
+        }
+        if (!name) return result(0xFF);
+        std::array<uint8_t, 32> entry{};
+        for (std::size_t i = 0; i < 11; ++i) entry[1 + i] = static_cast<uint8_t>(name->chars[i]);
+        entry[fcb::kRecordCount] = static_cast<uint8_t>(std::min<uint32_t>(HostDirectory::records(*path), 128));
+        to_dma(entry);
+        result(0);
+    }
+
+    static std::string hex(uint16_t v) {
+        static constexpr char kDigits[] = "0123456789ABCDEF";
+        std::string s = "0000h";
+        for (int i = 3; i >= 0; --i, v >>= 4) s[i] = kDigits[v & 0xF];
+        return s;
+    }
+
+    Cpu cpu_;
+    HostDirectory disk_;
+    std::string console_;
+    std::string input_;
+    std::size_t input_pos_ = 0;
+    uint16_t dma_ = kDefaultDma;
+    std::vector<std::filesystem::path> search_;
+    std::size_t search_next_ = 0;
+    std::string reason_;
+};
+
+using CpmMachine = BasicCpmMachine<>;
+
+} // namespace z80::machine::cpm
+
+#endif // Z80_MACHINE_CPM_CPM_MACHINE_H
@@ -0,0 +1,262 @@
+//
+// Z80 Digital Twin - CP/M machine state snapshots
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// CpmState is a CpmMachine frozen between instructions: every CPU register,
+// the interrupt flip-flops, mode, HALT and EI shadow, the T-state count, all
+// 64 KB of memory, and the host side of the BDOS — the console captured so
+// far, the input position, the DMA address and an open directory search.
+// Restoring it into a machine with the same input text and directory
+// continues the run exactly: the console it goes on to print is the one the
+// original would have printed.
+//
+// Not captured: the input text itself and the files in the host directory,
+// which belong to whoever set the machine up. Capture at an instruction
+// boundary (Cpu::InstructionComplete()), not between a prefix and its opcode.
+//
+// hash() fingerprints everything but the tag, so a restored machine can be
+// checked against the state it was saved from: capture it again and compare.
+//
+// File format (little-endian):
+//   "Z80CPM" u8 version u8 0 | u64 tag |
+//   u16 AF BC DE HL AF' BC' DE' HL' IX IY SP PC IR WZ |
+//   u8 IFF1 IFF2 IM halted EI-shadow | u64 T-states |
+//   u16 DMA | u64 input position | u32 search next | u32 n, n x (u8 len, name) |
+//   u32 console length, console | 65536 bytes memory | u32 FNV-1a.
+// The tag is the owner's to use (the suite runner stores the image hash).
+//
+
+#ifndef Z80_MACHINE_CPM_CPM_STATE_H
+#define Z80_MACHINE_CPM_CPM_STATE_H
+
+#include "cpm_machine.h"
+#include "fnv.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace z80::machine::cpm {
+
+struct CpmState {
+    static constexpr uint8_t kVersion = 1;
+
+    uint64_t tag = 0;   ///< Opaque to CpmState; saved and loaded as-is.
+
+    // CPU
+    std::array<uint16_t, 14> regs{};   ///< AF BC DE HL AF' BC' DE' HL' IX IY SP PC IR WZ.
+    bool iff1 = false;
+    bool iff2 = false;
+    uint8_t im = 0;
+    bool halted = false;
+    bool ei_shadow = false;
+    uint64_t tstates = 0;
+
+    // BDOS
+    uint16_t dma = kDefaultDma;
+    uint64_t input_pos = 0;
+    uint32_t search_next = 0;
+    std::vector<std::string> search;   ///< Host file names of the open search
+    std::string console;
+
+    std::vector<uint8_t> memory = std::vector<uint8_t>(0x10000, 0x00);
+
+    /// @brief Snapshot @p machine (at an instruction boundary).
+    template <class Cpu>
+    [[nodiscard]] static CpmState capture(BasicCpmMachine<Cpu>& machine) {
+        CpmState s;
+        Cpu& cpu = machine.cpu_;
+        s.regs = {cpu.AF(),    cpu.BC(),    cpu.DE(),    cpu.HL(),    cpu.AltAF(),
+                  cpu.AltBC(), cpu.AltDE(), cpu.AltHL(), cpu.IX(),    cpu.IY(),
+                  cpu.SP(),    cpu.PC(),    cpu.IR(),    cpu.WZ()};
+        s.iff1 = cpu.IFF1();
+        s.iff2 = cpu.IFF2();
+        s.im = cpu.InterruptMode();
+        s.halted = cpu.IsHalted();
+        s.ei_shadow = cpu.InterruptShadow();
+        s.tstates = cpu.GetCycleCount();
+
+        s.dma = machine.dma_;
+        s.input_pos = machine.input_pos_;
+        s.search_next = static_cast<uint32_t>(machine.search_next_);
+        for (const auto& path : machine.search_) s.search.push_back(path.filename().string());
+        s.console = machine.console_;
+
+        for (std::size_t a = 0; a < s.memory.size(); ++a) s.memory[a] = cpu.ReadMemory(static_cast<uint16_t>(a));
+        return s;
+    }
+
+    /// @brief Put @p machine into this state. Input text and directory are
+    ///        left as they are.
+    template <class Cpu>
+    void restore(BasicCpmMachine<Cpu>& machine) const {
+        Cpu& cpu = machine.cpu_;
+        cpu.LoadProgram(memory, 0x0000);
+        cpu.AF() = regs[0];
+        cpu.BC() = regs[1];
+        cpu.DE() = regs[2];
+        cpu.HL() = regs[3];
+        cpu.AltAF() = regs[4];
+        cpu.AltBC() = regs[5];
+        cpu.AltDE() = regs[6];
+        cpu.AltHL() = regs[7];
+        cpu.IX() = regs[8];
+        cpu.IY() = regs[9];
+        cpu.SP() = regs[10];
+        cpu.PC() = regs[11];
+        cpu.IR() = regs[12];
+        cpu.WZ() = regs[13];
+        cpu.IFF1() = iff1;
+        cpu.IFF2() = iff2;
+        cpu.SetInterruptMode(im);
+        cpu.SetHalted(halted);
+        cpu.SetInterruptShadow(ei_shadow);
+        cpu.SetCycleCount(tstates);
+
+        machine.dma_ = dma;
+        machine.input_pos_ = static_cast<std::size_t>(input_pos);
+        machine.search_.clear();
+        for (const std::string& name : search) machine.search_.push_back(machine.disk_.root() / name);
+        machine.search_next_ = search_next;
+        machine.console_ = console;
+        machine.reason_.clear();
+    }
+
+    /// @brief 64-bit fingerprint of the state (the tag excluded).
+    [[nodiscard]] uint64_t hash() const { return fnv1a64(body()); }
+
+    [[nodiscard]] std::vector<uint8_t> save() const {
+        std::vector<uint8_t> out = {'Z', '8', '0', 'C', 'P', 'M', kVersion, 0};
+        for (int k = 0; k < 8; ++k) out.push_back(static_cast<uint8_t>(tag >> (8 * k)));
+        const std::vector<uint8_t> b = body();
+        out.insert(out.end(), b.begin(), b.end());
+        const uint32_t sum = fnv1a32(out);
+        for (int k = 0; k < 4; ++k) out.push_back(static_cast<uint8_t>(sum >> (8 * k)));
+        return out;
+    }
+
+    /// @brief Replace this state with a saved one.
+    /// @return false (with @p error set, if given) on a malformed or corrupt
+    ///         image; the state is left unchanged.
+    bool load(std::span<const uint8_t> in, std::string* error = nullptr) {
+        const auto fail = [error](const char* why) {
+            if (error) *error = why;
+            return false;
+        };
+        static constexpr uint8_t kMagic[] = {'Z', '8', '0', 'C', 'P', 'M'};
+        if (in.size() < 8 || !std::equal(std::begin(kMagic), std::end(kMagic), in.begin()))
+            return fail("not a CP/M state file");
+        if (in[6] != kVersion) return fail("unsupported CP/M state version");
+        if (in.size() < 16 + kFixedBytes + 0x10000 + 4) return fail("truncated");
+        const std::size_t end = in.size() - 4;
+        const uint32_t stored = static_cast<uint32_t>(in[end] | (in[end + 1] << 8) | (in[end + 2] << 16)) |
+                                (static_cast<uint32_t>(in[end + 3]) << 24);
+        if (stored != fnv1a32(in.first(end))) return fail("checksum mismatch");
+
+        std::size_t pos = 8;
+        bool short_read = false;
+        const auto get = [&](int n) {
+            uint64_t v = 0;
+            if (pos + static_cast<std::size_t>(n) > end) {
+                short_read = true;
+                return v;
+            }
+            for (int k = 0; k < n; ++k) v |= static_cast<uint64_t>(in[pos++]) << (8 * k);
+            return v;
+        };
+        const auto get_string = [&](std::size_t n) {
+            if (pos + n > end) {
+                short_read = true;
+                return std::string{};
+            }
+            std::string s(reinterpret_cast<const char*>(in.data() + pos), n);
+            pos += n;
+            return s;
+        };
+        CpmState s;
+        s.tag = get(8);
+        for (uint16_t& r : s.regs) r = static_cast<uint16_t>(get(2));
+        s.iff1 = get(1) != 0;
+        s.iff2 = get(1) != 0;
+        s.im = static_cast<uint8_t>(get(1));
+        s.halted = get(1) != 0;
+        s.ei_shadow = get(1) != 0;
+        if (s.im > 2) return fail("bad interrupt mode");
+        s.tstates = get(8);
+        s.dma = static_cast<uint16_t>(get(2));
+        s.input_pos = get(8);
+        s.search_next = static_cast<uint32_t>(get(4));
+        const uint64_t names = get(4);
+        for (uint64_t i = 0; i < names && !short_read; ++i) {
+            std::string name = get_string(static_cast<std::size_t>(get(1)));
+            if (!FileName::from_host(name)) return fail("bad search entry");
+            s.search.push_back(std::move(name));
+        }
+        s.console = get_string(static_cast<std::size_t>(get(4)));
+        if (short_read || end - pos != 0x10000) return fail("wrong size");
+        std::memcpy(s.memory.data(), in.data() + pos, 0x10000);
+        *this = std::move(s);
+        return true;
+    }
+
+    /// @return false if the file cannot be written.
+    bool save_file(const std::string& path) const {
+        std::ofstream f(path, std::ios::binary);
+        if (!f) return false;
+        const std::vector<uint8_t> bytes = save();
+        f.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        return static_cast<bool>(f);
+    }
+
+    /// @return false if the file cannot be read or is not a valid state file.
+    bool load_file(const std::string& path, std::string* error = nullptr) {
+        std::ifstream f(path, std::ios::binary);
+        if (!f) {
+            if (error) *error = "cannot open file";
+            return false;
+        }
+        const std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+        return load(bytes, error);
+    }
+
+private:
+    /// Smallest body between the tag and the memory image: no search, no console.
+    static constexpr std::size_t kFixedBytes = 14 * 2 + 5 + 8 + 2 + 8 + 4 + 4 + 4;
+
+    /// Everything after the tag, as saved.
+    [[nodiscard]] std::vector<uint8_t> body() const {
+        std::vector<uint8_t> out;
+        out.reserve(kFixedBytes + console.size() + memory.size() + 16 * search.size());
+        const auto put = [&out](uint64_t v, int n) {
+            for (int k = 0; k < n; ++k) out.push_back(static_cast<uint8_t>(v >> (8 * k)));
+        };
+        for (uint16_t r : regs) put(r, 2);
+        for (bool b : {iff1, iff2}) put(b ? 1 : 0, 1);
+        put(im, 1);
+        for (bool b : {halted, ei_shadow}) put(b ? 1 : 0, 1);
+        put(tstates, 8);
+        put(dma, 2);
+        put(input_pos, 8);
+        put(search_next, 4);
+        put(search.size(), 4);
+        for (const std::string& name : search) {
+            put(name.size(), 1);
+            out.insert(out.end(), name.begin(), name.end());
+        }
+        put(console.size(), 4);
+        out.insert(out.end(), console.begin(), console.end());
+        out.insert(out.end(), memory.begin(), memory.end());
+        return out;
+    }
+};
+
+} // namespace z80::machine::cpm
+
+#endif // Z80_MACHINE_CPM_CPM_STATE_H
@@ -0,0 +1,188 @@
+//
+// Z80 Digital Twin - CP/M files in a host directory
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// The disk side of the CP/M BDOS: a file control block (FCB) names an 8.3
+// file, and HostDirectory maps it onto one host directory, the sandbox. A
+// name is built only from the FCB's 11 name bytes, and any byte that could
+// form a path ('/', '\\', '.', ':', ...) or a control character rejects the
+// name outright, so nothing outside the directory can be named. Matching is
+// case-insensitive; files the BDOS creates get upper-case names.
+//
+// CP/M's unit is the 128-byte record. A record number is the FCB's
+// (S2 * 32 + EX) * 128 + CR, and a partial last record reads padded with 1Ah
+// (^Z), the CP/M end-of-text mark.
+//
+
+#ifndef Z80_MACHINE_CPM_HOST_DIRECTORY_H
+#define Z80_MACHINE_CPM_HOST_DIRECTORY_H
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+namespace z80::machine::cpm {
+
+inline constexpr std::size_t kRecordBytes = 128;
+inline constexpr uint8_t kEndOfText = 0x1A;
+
+/// @brief Offsets into a 36-byte file control block.
+namespace fcb {
+inline constexpr uint16_t kDrive = 0;
+inline constexpr uint16_t kName = 1;    ///< 8 bytes, space padded
+inline constexpr uint16_t kType = 9;    ///< 3 bytes; bit 7 of each is an attribute
+inline constexpr uint16_t kExtent = 12; ///< EX: 16 KB extent within the module
+inline constexpr uint16_t kS2 = 14;     ///< Module (extent high bits)
+inline constexpr uint16_t kRecordCount = 15;  ///< RC: records in this extent
+inline constexpr uint16_t kRename = 16; ///< Rename: the new drive and name, as at 0
+inline constexpr uint16_t kCurrent = 32;  ///< CR: record within the extent
+inline constexpr uint16_t kRandom = 33;   ///< R0, R1, R2
+inline constexpr std::size_t kSize = 36;
+} // namespace fcb
+
+/// @brief An FCB's 8.3 name: 11 bytes, upper case, space padded. '?' is a
+///        wildcard (search and delete only).
+struct FileName {
+    std::array<char, 11> chars{};
+
+    /// @brief Read from FCB name bytes; nullopt if any byte cannot name a
+    ///        host file safely, or the name or type has a character after a
+    ///        space (host() stops at the first space, so "AB C" would open
+    ///        "AB").
+    static std::optional<FileName> from_fcb(std::span<const uint8_t, 11> bytes) {
+        FileName n;
+        for (std::size_t i = 0; i < 11; ++i) {
+            const auto ch = static_cast<char>(std::toupper(bytes[i] & 0x7F));
+            if (ch != ' ' && ch != '?' && !valid_char(ch)) return std::nullopt;
+            if (ch != ' ' && i != 0 && i != 8 && n.chars[i - 1] == ' ') return std::nullopt;
+            n.chars[i] = ch;
+        }
+        if (n.chars[0] == ' ') return std::nullopt;
+        return n;
+    }
+
+    /// @brief Parse a host file name ("GAME.DAT"); nullopt if it is not 8.3.
+    static std::optional<FileName> from_host(std::string_view host) {
+        const std::size_t dot = host.find('.');
+        const std::string_view base = host.substr(0, dot);
+        const std::string_view ext = dot == std::string_view::npos ? std::string_view{} : host.substr(dot + 1);
+        if (base.empty() || base.size() > 8 || ext.size() > 3) return std::nullopt;
+        FileName n;
+        n.chars.fill(' ');
+        for (std::size_t i = 0; i < base.size(); ++i) n.chars[i] = static_cast<char>(std::toupper(base[i]));
+        for (std::size_t i = 0; i < ext.size(); ++i) n.chars[8 + i] = static_cast<char>(std::toupper(ext[i]));
+        for (const char ch : n.chars) {
+            if (ch != ' ' && !valid_char(ch)) return std::nullopt;
+        }
+        return n;
+    }
+
+    [[nodiscard]] bool wild() const { return std::find(chars.begin(), chars.end(), '?') != chars.end(); }
+
+    [[nodiscard]] bool matches(const FileName& file) const {
+        for (std::size_t i = 0; i < 11; ++i) {
+            if (chars[i] != '?' && chars[i] != file.chars[i]) return false;
+        }
+        return true;
+    }
+
+    /// @brief "NAME.EXT" (or "NAME"), as created on the host.
+    [[nodiscard]] std::string host() const {
+        std::string out;
+        for (std::size_t i = 0; i < 8 && chars[i] != ' '; ++i) out += chars[i];
+        if (chars[8] != ' ') {
+            out += '.';
+            for (std::size_t i = 8; i < 11 && chars[i] != ' '; ++i) out += chars[i];
+        }
+        return out;
+    }
+
+    static bool valid_char(char ch) {
+        return ch > ' ' && ch < 0x7F && std::string_view("<>.,;:=?*[]%|()/\\\"").find(ch) == std::string_view::npos;
+    }
+};
+
+/// @brief The sandbox. Without a directory, every lookup fails (the BDOS
+///        then reports "no file", as for an empty disk).
+class HostDirectory {
+public:
+    HostDirectory() = default;
+    explicit HostDirectory(std::filesystem::path root) : root_(std::move(root)) {}
+
+    [[nodiscard]] bool attached() const { return !root_.empty(); }
+    [[nodiscard]] const std::filesystem::path& root() const { return root_; }
+
+    /// @brief Host files whose names match @p pattern, sorted by name.
+    [[nodiscard]] std::vector<std::filesystem::path> find(const FileName& pattern) const {
+        std::vector<std::filesystem::path> out;
+        if (!attached()) return out;
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::directory_iterator(root_, ec)) {
+            if (!entry.is_regular_file(ec)) continue;
+            const auto name = FileName::from_host(entry.path().filename().string());
+            if (name && pattern.matches(*name)) out.push_back(entry.path());
+        }
+        std::sort(out.begin(), out.end());
+        return out;
+    }
+
+    [[nodiscard]] std::optional<std::filesystem::path> find_first(const FileName& pattern) const {
+        auto all = find(pattern);
+        if (all.empty()) return std::nullopt;
+        return all.front();
+    }
+
+    /// @brief Create (or truncate) the file named @p name.
+    std::optional<std::filesystem::path> create(const FileName& name) const {
+        if (!attached() || name.wild()) return std::nullopt;
+        const std::filesystem::path path = find_first(name).value_or(root_ / name.host());
+        std::ofstream f(path, std::ios::binary | std::ios::trunc);
+        if (!f) return std::nullopt;
+        return path;
+    }
+
+    [[nodiscard]] static uint32_t records(const std::filesystem::path& path) {
+        std::error_code ec;
+        const auto size = std::filesystem::file_size(path, ec);
+        return ec ? 0 : static_cast<uint32_t>((size + kRecordBytes - 1) / kRecordBytes);
+    }
+
+    /// @brief Read record @p record into @p out (^Z-padded). false past the end.
+    static bool read_record(const std::filesystem::path& path, uint32_t record, std::span<uint8_t, kRecordBytes> out) {
+        std::ifstream f(path, std::ios::binary);
+        if (!f) return false;
+        f.seekg(static_cast<std::streamoff>(record) * kRecordBytes);
+        f.read(reinterpret_cast<char*>(out.data()), kRecordBytes);
+        const auto got = static_cast<std::size_t>(std::max<std::streamsize>(f.gcount(), 0));
+        if (got == 0) return false;
+        std::fill(out.begin() + static_cast<std::ptrdiff_t>(got), out.end(), kEndOfText);
+        return true;
+    }
+
+    /// @brief Write record @p record; a gap before it reads back as zeros.
+    static bool write_record(const std::filesystem::path& path, uint32_t record,
+                             std::span<const uint8_t, kRecordBytes> data) {
+        std::fstream f(path, std::ios::binary | std::ios::in | std::ios::out);
+        if (!f) return false;
+        f.seekp(static_cast<std::streamoff>(record) * kRecordBytes);
+        f.write(reinterpret_cast<const char*>(data.data()), kRecordBytes);
+        return static_cast<bool>(f);
+    }
+
+private:
+    std::filesystem::path root_;
+};
+
+} // namespace z80::machine::cpm
+
+#endif // Z80_MACHINE_CPM_HOST_DIRECTORY_H
@@ -58,9 +58,11 @@ public:
     uint64_t RunFrame(Stepper&& step) {
         // The ULA asserts /INT at the frame boundary; the CPU services it at the
         // next instruction (declined if interrupts are masked or in an EI shadow).
-        cpu_.Interrupt(int_bus_);
+        // A frame resumed part-way (ResumeMidFrame) had its interrupt already.
+        if (resume_ == 0) cpu_.Interrupt(int_bus_);
 
-        const uint64_t target = frame_tstates_ - carry_;
+        const uint64_t target = frame_tstates_ - carry_ - resume_;
+        resume_ = 0;
         const uint64_t ran = step(target);
         carry_ = ran > target ? ran - target : 0;
 
@@ -73,11 +75,27 @@ public:
     [[nodiscard]] uint64_t Carry() const noexcept { return carry_; }
     [[nodiscard]] uint64_t FrameTStates() const noexcept { return frame_tstates_; }
 
+    /// @brief Restore the frame clock from a snapshot (frames run, overrun owed).
+    void Restore(uint64_t frames, uint64_t carry) noexcept {
+        frames_ = frames;
+        carry_ = carry;
+    }
+
+    /// @brief Make the next RunFrame() pick up a frame @p position T-states in
+    ///        (e.g. a snapshot saved mid-frame): that frame's interrupt has
+    ///        already happened, so none is raised and only the remaining
+    ///        T-states are run. 0 (or >= a frame) = start at a frame boundary.
+    void ResumeMidFrame(uint64_t position) noexcept {
+        resume_ = position < frame_tstates_ ? position : 0;
+        carry_ = 0;
+    }
+
 private:
     Cpu& cpu_;
     uint64_t frame_tstates_;
     uint8_t int_bus_;
     uint64_t carry_ = 0;    ///< T-states the last frame overran, owed back next.
+    uint64_t resume_ = 0;   ///< Next frame starts this far in (no interrupt).
     uint64_t frames_ = 0;
     std::vector<Device*> devices_;
 };
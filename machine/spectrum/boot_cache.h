@@ -0,0 +1,194 @@
+//
+// Z80 Digital Twin - ZX Spectrum post-boot snapshot cache
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// Cold-booting the 48K ROM costs 100+ frames of RAM test and system-variable
+// setup before anything interesting happens, and every test, probe run and
+// viewer session pays it again. BootCache::boot() pays it once: the first
+// call cold-boots and saves a MachineState; later calls with the same key
+// restore it (a 64 KB read and copy).
+//
+// The key is everything the booted state depends on:
+//   * the ROM image (hash) and the number of boot frames;
+//   * whether ROM writes were blocked;
+//   * the snapshot format, the cache format and the project version;
+//   * a core fingerprint — the state_hash() of a canary program run on a
+//     scratch machine for two frames. The canary exercises block moves, ALU
+//     and DAA, rotates, index addressing, R, port I/O, IM 2 and HALT, so a
+//     change to the core's behaviour or timing changes the fingerprint and
+//     every cached boot is rebuilt without anyone having to bump a version.
+//
+// Entries live in $Z80_SNAPSHOT_CACHE, else <temp>/z80twin-boot-cache, named
+// boot-<rom hash>-<frames>-<key>.z80s. Writing an entry removes stale ones for
+// the same ROM and frame count. Writes go to a temporary file first and are
+// renamed into place, so concurrent test processes never read a torn file. The
+// cache is best-effort: an unreadable, corrupt or unwritable entry just means
+// a cold boot.
+//
+
+#ifndef Z80_MACHINE_SPECTRUM_BOOT_CACHE_H
+#define Z80_MACHINE_SPECTRUM_BOOT_CACHE_H
+
+#include "fnv.h"
+#include "machine_state.h"
+#include "state_hash.h"
+#include "spectrum_machine.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#ifndef Z80_TWIN_VERSION
+#define Z80_TWIN_VERSION "unknown"
+#endif
+
+namespace z80::machine::spectrum {
+
+class BootCache {
+public:
+    static constexpr uint8_t kFormat = 1;
+
+    /// @param dir  Cache directory; empty = default_dir().
+    explicit BootCache(std::string dir = {}) : dir_(dir.empty() ? default_dir() : std::move(dir)) {}
+
+    /// @brief $Z80_SNAPSHOT_CACHE, else a directory under the system temp dir.
+    [[nodiscard]] static std::string default_dir() {
+        if (const char* env = std::getenv("Z80_SNAPSHOT_CACHE"); env && *env) return env;
+        std::error_code ec;
+        const std::filesystem::path tmp = std::filesystem::temp_directory_path(ec);
+        return ((ec ? std::filesystem::path(".") : tmp) / "z80twin-boot-cache").string();
+    }
+
+    /// @brief Advance a freshly loaded @p machine (load_rom() done, nothing run)
+    ///        by @p frames frames: restored from the cache when possible,
+    ///        otherwise run with run_frame() and saved for next time.
+    /// @return true on a cache hit.
+    bool boot(SpectrumMachine& machine, std::span<const uint8_t> rom, uint32_t frames) {
+        const uint64_t key = this->key(machine, rom, frames);
+        const std::string path = this->path(rom, frames, key);
+
+        MachineState state;
+        if (state.load_file(path) && state.tag == key) {
+            state.restore(machine);
+            return true;
+        }
+        for (uint32_t i = 0; i < frames; ++i) machine.run_frame();
+        state = MachineState::capture(machine);
+        state.tag = key;
+        store(state, path, rom, frames);
+        return false;
+    }
+
+    /// @brief The cache key for booting @p rom on @p machine's configuration.
+    [[nodiscard]] static uint64_t key(SpectrumMachine& machine, std::span<const uint8_t> rom,
+                                      uint32_t frames) {
+        Fnv64 h;
+        const auto put = [&h](uint64_t v) {
+            for (int k = 0; k < 8; ++k) h.byte(static_cast<uint8_t>(v >> (8 * k)));
+        };
+        put(kFormat);
+        put(MachineState::kVersion);
+        for (const char c : std::string_view(Z80_TWIN_VERSION)) h.byte(static_cast<uint8_t>(c));
+        put(core_fingerprint());
+        put(fnv1a64(rom));
+        put(frames);
+        put(machine.cpu().GetMemory().WriteProtected(0x0000) ? 1 : 0);
+        return h.value();
+    }
+
+    /// @brief state_hash() of the canary run; computed once per process.
+    [[nodiscard]] static uint64_t core_fingerprint() {
+        static const uint64_t fingerprint = [] {
+            SpectrumMachine scratch;
+            scratch.load_rom(canary_program());
+            scratch.run_frame();
+            scratch.run_frame();
+            return state_hash(scratch);
+        }();
+        return fingerprint;
+    }
+
+    [[nodiscard]] std::string path(std::span<const uint8_t> rom, uint32_t frames, uint64_t key) const {
+        return (std::filesystem::path(dir_) / (prefix(rom, frames) + hex(key) + ".z80s")).string();
+    }
+
+    [[nodiscard]] const std::string& dir() const noexcept { return dir_; }
+
+private:
+    static std::string hex(uint64_t v) {
+        char buf[17];
+        std::snprintf(buf, sizeof buf, "%016llx", static_cast<unsigned long long>(v));
+        return buf;
+    }
+
+    static std::string prefix(std::span<const uint8_t> rom, uint32_t frames) {
+        return "boot-" + hex(fnv1a64(rom)) + "-" + std::to_string(frames) + "-";
+    }
+
+    void store(const MachineState& state, const std::string& path, std::span<const uint8_t> rom,
+               uint32_t frames) const {
+        namespace fs = std::filesystem;
+        std::error_code ec;
+        fs::create_directories(dir_, ec);
+        static std::atomic<uint32_t> serial{0};
+        const std::string tmp =
+            path + ".tmp" +
+            hex(static_cast<uint64_t>(
+                    std::chrono::steady_clock::now().time_since_epoch().count()) ^
+                (uint64_t{serial++} << 48));
+        if (!state.save_file(tmp)) {
+            fs::remove(tmp, ec);
+            return;
+        }
+        fs::rename(tmp, path, ec);
+        if (ec) {
+            fs::remove(tmp, ec);
+            return;
+        }
+        // Entries for this ROM and frame count under another key are stale.
+        const std::string stale = prefix(rom, frames);
+        const std::string keep = fs::path(path).filename().string();
+        for (const fs::directory_entry& e : fs::directory_iterator(dir_, ec)) {
+            const std::string name = e.path().filename().string();
+            if (name != keep && name.rfind(stale, 0) == 0 && name.ends_with(".z80s"))
+                fs::remove(e.path(), ec);
+        }
+    }
+
+    /// Canary ROM (see the file comment):
+    ///   0x0000  LD SP,0xFF00 / LD HL,0x4000 / LD DE,0x4001 / LD BC,0x0100 /
+    ///           LD (HL),0x5A / LDIR                           ; screen writes
+    ///   0x0010  LD A,0x99 / ADD A,1 / DAA / RLA / RRCA / SBC A,0x33
+    ///   0x0019  LD B,0x40
+    ///   0x001B  IN A,(0xFE) / XOR B / OUT (0xFE),A / ADD A,B / DAA / RL C / DJNZ 0x001B
+    ///   0x0026  LD IX,0x4000 / LD A,(IX+5) / LD IY,0x4010 / ADD A,(IY-2) / NEG /
+    ///           LD A,R / LD (0x9000),A
+    ///   0x003B  LD A,0x80 / LD I,A / IM 2 / LD HL,0xA000 / LD (0x80FF),HL
+    ///   0x0047  LD HL,0xA000 / LD (HL),0xF3 / INC HL / LD (HL),0x76 ; DI / HALT
+    ///   0x004F  EI / HALT                                     ; IM 2 -> 0xA000
+    static std::vector<uint8_t> canary_program() {
+        return {0x31, 0x00, 0xFF, 0x21, 0x00, 0x40, 0x11, 0x01, 0x40, 0x01, 0x00, 0x01,
+                0x36, 0x5A, 0xED, 0xB0, 0x3E, 0x99, 0xC6, 0x01, 0x27, 0x17, 0x0F, 0xDE,
+                0x33, 0x06, 0x40, 0xDB, 0xFE, 0xA8, 0xD3, 0xFE, 0x80, 0x27, 0xCB, 0x11,
+                0x10, 0xF5, 0xDD, 0x21, 0x00, 0x40, 0xDD, 0x7E, 0x05, 0xFD, 0x21, 0x10,
+                0x40, 0xFD, 0x86, 0xFE, 0xED, 0x44, 0xED, 0x5F, 0x32, 0x00, 0x90, 0x3E,
+                0x80, 0xED, 0x47, 0xED, 0x5E, 0x21, 0x00, 0xA0, 0x22, 0xFF, 0x80, 0x21,
+                0x00, 0xA0, 0x36, 0xF3, 0x23, 0x36, 0x76, 0xFB, 0x76};
+    }
+
+    std::string dir_;
+};
+
+} // namespace z80::machine::spectrum
+
+#endif // Z80_MACHINE_SPECTRUM_BOOT_CACHE_H
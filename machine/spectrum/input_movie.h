@@ -0,0 +1,362 @@
+//
+// Z80 Digital Twin - ZX Spectrum input movies (deterministic record / replay)
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// An input movie is everything the outside world did to a SpectrumMachine —
+// key presses, tape transport, the reset button — as events stamped with the
+// absolute CPU T-state they took effect at, plus a state hash per frame. Given
+// the same ROM, replaying the events reproduces the run cycle for cycle, so a
+// movie is both a benchmark workload ("play this game for 3000 frames") and a
+// bug report attachment.
+//
+//   * InputRecorder is the host's way in: the viewer (or a script) calls
+//     key_down()/tape_play()/… between frames; each call is stamped with the
+//     current T-state, applied, and logged. end_frame() appends the frame hash.
+//   * InputPlayer drives a machine from a movie. It splits each frame's
+//     T-state budget at the next event so events land on the first instruction
+//     boundary at or after their stamp — exactly where the recorder applied
+//     them — and compares the state hash after every frame, so a divergence is
+//     reported on the frame it happens, not thousands of frames later.
+//   * apply_event() is the single place an event touches the machine; both
+//     sides go through it.
+//
+// File format (little-endian):
+//   "Z80MOV" u8 version u8 flags | u64 ROM hash |
+//   u32 tape count, (u32 length, bytes)... |
+//   u32 event count, (u64 T-state, u8 kind, u8 half-row, u8 bit, u32 tape)... |
+//   u32 frame count, u64 hash... | u32 FNV-1a of everything before it.
+// Tape images are embedded, so a movie is self-contained apart from the ROM.
+//
+
+#ifndef Z80_MACHINE_SPECTRUM_INPUT_MOVIE_H
+#define Z80_MACHINE_SPECTRUM_INPUT_MOVIE_H
+
+#include "fnv.h"
+#include "spectrum_machine.h"
+#include "state_hash.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace z80::machine::spectrum {
+
+enum class InputKind : uint8_t {
+    KeyDown,      ///< Matrix key (half_row, bit) pressed.
+    KeyUp,        ///< Matrix key (half_row, bit) released.
+    TapePlay,     ///< Start the tape from its beginning.
+    TapeStop,     ///< Stop the tape.
+    TapeInsert,   ///< Load embedded tape image `tape` (stops playback).
+    Reset,        ///< The reset button (Z80 only; see SpectrumMachine::reset).
+};
+
+/// @brief One external input, effective from absolute CPU T-state @p tstate.
+struct InputEvent {
+    uint64_t tstate = 0;
+    InputKind kind = InputKind::KeyDown;
+    uint8_t half_row = 0;   ///< KeyDown/KeyUp: matrix half-row 0..7.
+    uint8_t bit = 0;        ///< KeyDown/KeyUp: data bit 0..4.
+    uint32_t tape = 0;      ///< TapeInsert: index into InputMovie::tapes.
+
+    friend bool operator==(const InputEvent&, const InputEvent&) = default;
+};
+
+class InputMovie {
+public:
+    static constexpr uint8_t kVersion = 3;   ///< 3: hashes cover EI shadow and tape.
+    static constexpr uint8_t kRomWriteProtect = 0x01;   ///< flags: ROM was read-only.
+
+    uint8_t flags = kRomWriteProtect;
+    uint64_t rom_hash = 0;                        ///< hash_rom() of the ROM recorded on.
+    std::vector<std::vector<uint8_t>> tapes;      ///< Images referenced by TapeInsert.
+    std::vector<InputEvent> events;               ///< In T-state order.
+    std::vector<uint64_t> frame_hashes;           ///< state_hash() after each frame.
+
+    [[nodiscard]] static uint64_t hash_rom(std::span<const uint8_t> rom) { return fnv1a64(rom); }
+
+    [[nodiscard]] std::size_t frames() const noexcept { return frame_hashes.size(); }
+
+    [[nodiscard]] std::vector<uint8_t> save() const {
+        std::vector<uint8_t> out = {'Z', '8', '0', 'M', 'O', 'V', kVersion, flags};
+        const auto put = [&out](uint64_t v, int n) {
+            for (int k = 0; k < n; ++k) out.push_back(static_cast<uint8_t>(v >> (8 * k)));
+        };
+        put(rom_hash, 8);
+        put(tapes.size(), 4);
+        for (const auto& t : tapes) {
+            put(t.size(), 4);
+            out.insert(out.end(), t.begin(), t.end());
+        }
+        put(events.size(), 4);
+        for (const InputEvent& e : events) {
+            put(e.tstate, 8);
+            out.push_back(static_cast<uint8_t>(e.kind));
+            out.push_back(e.half_row);
+            out.push_back(e.bit);
+            put(e.tape, 4);
+        }
+        put(frame_hashes.size(), 4);
+        for (uint64_t f : frame_hashes) put(f, 8);
+        put(fnv1a32(out), 4);
+        return out;
+    }
+
+    /// @brief Replace this movie with a saved one.
+    /// @return false (with @p error set, if given) on a malformed or corrupt
+    ///         image; the movie is left unchanged.
+    bool load(std::span<const uint8_t> in, std::string* error = nullptr) {
+        const auto fail = [error](const char* why) {
+            if (error) *error = why;
+            return false;
+        };
+        static constexpr uint8_t kMagic[] = {'Z', '8', '0', 'M', 'O', 'V'};
+        if (in.size() < 8 || !std::equal(std::begin(kMagic), std::end(kMagic), in.begin()))
+            return fail("not a movie file");
+        if (in[6] != kVersion) return fail("unsupported movie version");
+        if (in.size() < 12) return fail("truncated file");
+        // Check the whole image before interpreting any of it: a cut-off or
+        // bit-flipped file fails here rather than as a confusing parse error.
+        const std::size_t body = in.size() - 4;
+        const uint32_t stored = static_cast<uint32_t>(in[body] | (in[body + 1] << 8) |
+                                                      (in[body + 2] << 16)) |
+                                (static_cast<uint32_t>(in[body + 3]) << 24);
+        if (stored != fnv1a32(in.first(body))) return fail("checksum mismatch");
+        std::size_t pos = 8;
+        const auto get = [&](int n, uint64_t& v) {
+            if (body - pos < static_cast<std::size_t>(n)) return false;
+            v = 0;
+            for (int k = 0; k < n; ++k) v |= static_cast<uint64_t>(in[pos++]) << (8 * k);
+            return true;
+        };
+
+        InputMovie m;
+        m.flags = in[7];
+        uint64_t n = 0;
+        if (!get(8, m.rom_hash) || !get(4, n)) return fail("truncated file");
+        for (uint64_t i = 0; i < n; ++i) {
+            uint64_t len = 0;
+            if (!get(4, len) || body - pos < len) return fail("truncated file");
+            m.tapes.emplace_back(in.begin() + static_cast<std::ptrdiff_t>(pos),
+                                 in.begin() + static_cast<std::ptrdiff_t>(pos + len));
+            pos += len;
+        }
+        if (!get(4, n)) return fail("truncated file");
+        for (uint64_t i = 0; i < n; ++i) {
+            InputEvent e;
+            uint64_t kind = 0, row = 0, bit = 0, tape = 0;
+            if (!get(8, e.tstate) || !get(1, kind) || !get(1, row) || !get(1, bit) || !get(4, tape))
+                return fail("truncated file");
+            if (kind > static_cast<uint64_t>(InputKind::Reset)) return fail("unknown event kind");
+            e.kind = static_cast<InputKind>(kind);
+            e.half_row = static_cast<uint8_t>(row);
+            e.bit = static_cast<uint8_t>(bit);
+            e.tape = static_cast<uint32_t>(tape);
+            if (e.kind == InputKind::TapeInsert && e.tape >= m.tapes.size())
+                return fail("event references a missing tape");
+            if (!m.events.empty() && e.tstate < m.events.back().tstate)
+                return fail("events out of order");
+            m.events.push_back(e);
+        }
+        if (!get(4, n)) return fail("truncated file");
+        for (uint64_t i = 0; i < n; ++i) {
+            uint64_t f = 0;
+            if (!get(8, f)) return fail("truncated file");
+            m.frame_hashes.push_back(f);
+        }
+        if (pos != body) return fail("trailing bytes");
+        *this = std::move(m);
+        return true;
+    }
+
+    /// @return false if the file cannot be written.
+    bool save_file(const std::string& path) const {
+        std::ofstream f(path, std::ios::binary);
+        if (!f) return false;
+        const std::vector<uint8_t> bytes = save();
+        f.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        return static_cast<bool>(f);
+    }
+
+    /// @return false if the file cannot be read or is not a valid movie.
+    bool load_file(const std::string& path, std::string* error = nullptr) {
+        std::ifstream f(path, std::ios::binary);
+        if (!f) {
+            if (error) *error = "cannot open file";
+            return false;
+        }
+        const std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(f)),
+                                         std::istreambuf_iterator<char>());
+        return load(bytes, error);
+    }
+};
+
+/// @brief Apply one event to the machine. The only place movie input touches
+///        machine state, shared by recorder and player.
+inline void apply_event(SpectrumMachine& machine, const InputEvent& e, const InputMovie& movie) {
+    switch (e.kind) {
+    case InputKind::KeyDown:    machine.ula().key_down(e.half_row, e.bit); break;
+    case InputKind::KeyUp:      machine.ula().key_up(e.half_row, e.bit); break;
+    case InputKind::TapePlay:   machine.play_tape(); break;
+    case InputKind::TapeStop:   machine.stop_tape(); break;
+    case InputKind::TapeInsert:
+        if (e.tape < movie.tapes.size()) machine.load_tape(movie.tapes[e.tape]);
+        break;
+    case InputKind::Reset:      machine.reset(); break;
+    }
+}
+
+class InputRecorder {
+public:
+    /// @param movie  Where events and frame hashes are logged; nullptr makes the
+    ///               recorder a pass-through (inputs applied, nothing logged),
+    ///               so a host can route all input through it unconditionally.
+    explicit InputRecorder(InputMovie* movie = nullptr) : movie_(movie) {}
+
+    [[nodiscard]] bool recording() const noexcept { return movie_ != nullptr; }
+
+    void key_down(SpectrumMachine& m, uint8_t half_row, uint8_t bit) {
+        if (!m.ula().matrix_pressed(half_row, bit)) submit(m, {0, InputKind::KeyDown, half_row, bit, 0});
+    }
+    void key_up(SpectrumMachine& m, uint8_t half_row, uint8_t bit) {
+        if (m.ula().matrix_pressed(half_row, bit)) submit(m, {0, InputKind::KeyUp, half_row, bit, 0});
+    }
+
+    /// @brief Bring the matrix to @p rows (one byte per half-row, bit set =
+    ///        pressed), logging only the keys that changed — the level-polled
+    ///        host keyboard becomes a sparse stream of edges.
+    void set_keys(SpectrumMachine& m, const std::array<uint8_t, 8>& rows) {
+        for (uint8_t row = 0; row < 8; ++row)
+            for (uint8_t bit = 0; bit < 5; ++bit) {
+                if (rows[row] & (1u << bit)) key_down(m, row, bit);
+                else key_up(m, row, bit);
+            }
+    }
+
+    /// @brief Load a tape image (embedded in the movie when recording).
+    /// @return false if the image holds nothing playable (nothing is logged).
+    bool tape_insert(SpectrumMachine& m, std::span<const uint8_t> image) {
+        Tape probe;
+        if (!probe.load(image)) return false;
+        if (!movie_) return m.load_tape(image);
+        movie_->tapes.emplace_back(image.begin(), image.end());
+        submit(m, {0, InputKind::TapeInsert, 0, 0, static_cast<uint32_t>(movie_->tapes.size() - 1)});
+        return true;
+    }
+    void tape_play(SpectrumMachine& m) { submit(m, {0, InputKind::TapePlay, 0, 0, 0}); }
+    void tape_stop(SpectrumMachine& m) { submit(m, {0, InputKind::TapeStop, 0, 0, 0}); }
+    void reset(SpectrumMachine& m) { submit(m, {0, InputKind::Reset, 0, 0, 0}); }
+
+    /// @brief Call after each run_frame(): logs the frame's state hash.
+    void end_frame(SpectrumMachine& m) {
+        if (!movie_) return;
+        if (!hasher_) hasher_ = std::make_unique<StateHasher>(m);
+        movie_->frame_hashes.push_back(hasher_->hash());
+    }
+
+    /// @brief State hash logged by the last end_frame() (0 if none).
+    [[nodiscard]] uint64_t last_hash() const noexcept {
+        return movie_ && !movie_->frame_hashes.empty() ? movie_->frame_hashes.back() : 0;
+    }
+
+private:
+    void submit(SpectrumMachine& m, InputEvent e) {
+        e.tstate = m.cpu().GetCycleCount();
+        if (movie_) {
+            movie_->events.push_back(e);
+            apply_event(m, e, *movie_);
+        } else {
+            apply_event(m, e, InputMovie{});
+        }
+    }
+
+    InputMovie* movie_;
+    std::unique_ptr<StateHasher> hasher_;   ///< Attached on the first recorded frame.
+};
+
+class InputPlayer {
+public:
+    /// @param movie  Must outlive the player.
+    explicit InputPlayer(const InputMovie& movie) : movie_(movie) {}
+
+    /// @brief Run one frame with the raw stepper, applying due events.
+    /// @return false only for the frame where the replay first diverges (its
+    ///         state hash differs from the recording). Later frames return
+    ///         true whether or not they match; see diverged().
+    bool run_frame(SpectrumMachine& m) {
+        return run_frame(m, [&m](uint64_t target) {
+            SpectrumCpu& cpu = m.cpu();
+            const uint64_t before = cpu.GetCycleCount();
+            while (cpu.GetCycleCount() - before < target && !cpu.IsHalted()) {
+                do { cpu.Step(); } while (!cpu.InstructionComplete());
+            }
+            return cpu.GetCycleCount() - before;
+        });
+    }
+
+    /// @brief Run one frame advancing the CPU through @p step (see
+    ///        SpectrumMachine::run_frame_with), applying due events.
+    /// @return false only for the frame where the replay first diverges, as
+    ///         run_frame(m) does.
+    template <class Stepper>
+    bool run_frame(SpectrumMachine& m, Stepper&& step) {
+        apply_due(m);   // events stamped at the frame boundary precede the /INT
+        m.run_frame_with([&](uint64_t target) {
+            uint64_t ran = 0;
+            while (ran < target) {
+                apply_due(m);
+                uint64_t slice = target - ran;
+                if (next_ < movie_.events.size())
+                    slice = std::min(slice, movie_.events[next_].tstate - m.cpu().GetCycleCount());
+                const uint64_t r = step(slice);
+                ran += r;
+                if (r < slice) break;   // halted (or stopped by a debugger)
+            }
+            return ran;
+        });
+        const std::size_t f = frame_++;
+        if (!hasher_) hasher_ = std::make_unique<StateHasher>(m);
+        last_hash_ = hasher_->hash();
+        if (f < movie_.frame_hashes.size() && !diverged_ && last_hash_ != movie_.frame_hashes[f])
+            diverged_ = f;
+        return !diverged_ || *diverged_ != f;
+    }
+
+    /// @brief First frame (0-based) whose hash did not match, if any.
+    [[nodiscard]] std::optional<std::size_t> diverged() const noexcept { return diverged_; }
+
+    /// @brief State hash after the last frame run (also past the movie's end).
+    [[nodiscard]] uint64_t last_hash() const noexcept { return last_hash_; }
+
+    /// @brief Frames run so far.
+    [[nodiscard]] std::size_t frame() const noexcept { return frame_; }
+
+    /// @brief Every recorded frame has been played.
+    [[nodiscard]] bool done() const noexcept { return frame_ >= movie_.frame_hashes.size(); }
+
+private:
+    void apply_due(SpectrumMachine& m) {
+        const uint64_t now = m.cpu().GetCycleCount();
+        while (next_ < movie_.events.size() && movie_.events[next_].tstate <= now)
+            apply_event(m, movie_.events[next_++], movie_);
+    }
+
+    const InputMovie& movie_;
+    std::size_t next_ = 0;
+    std::size_t frame_ = 0;
+    std::optional<std::size_t> diverged_;
+    std::unique_ptr<StateHasher> hasher_;   ///< Attached on the first frame.
+    uint64_t last_hash_ = 0;
+};
+
+} // namespace z80::machine::spectrum
+
+#endif // Z80_MACHINE_SPECTRUM_INPUT_MOVIE_H
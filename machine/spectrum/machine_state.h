@@ -0,0 +1,244 @@
+//
+// Z80 Digital Twin - ZX Spectrum machine state snapshots
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// MachineState is a SpectrumMachine frozen at a frame boundary: every CPU
+// register, the interrupt flip-flops, mode, HALT and EI shadow, the T-state
+// count, all 64 KB of memory, the ULA latches (border, speaker, FLASH phase,
+// frame start, keyboard matrix) and the frame clock's carry. Restoring it
+// into another machine loaded with the same ROM continues the run exactly
+// where the original left off — same state_hash() now and on every later
+// frame.
+//
+// Not captured: the tape (deck contents and transport) and the per-frame
+// display/border timelines, which restart from the restored border. Capture
+// between frames, not mid-frame.
+//
+// Memory is restored with ObservableMemory::RawLoad — one memcpy, no write
+// observers, no write protection — so a restore costs about as much as
+// copying 64 KB.
+//
+// File format (little-endian):
+//   "Z80SNP" u8 version u8 0 | u64 tag |
+//   u16 AF BC DE HL AF' BC' DE' HL' IX IY SP PC IR WZ |
+//   u8 IFF1 IFF2 IM halted EI-shadow | u64 T-states |
+//   u8 border beeper, u8[8] key rows, u64 ULA frames, u64 frame start |
+//   u64 machine frames, u64 carry | 65536 bytes memory | u32 FNV-1a.
+// The tag is the owner's to use (the boot cache stores its key there).
+//
+
+#ifndef Z80_MACHINE_SPECTRUM_MACHINE_STATE_H
+#define Z80_MACHINE_SPECTRUM_MACHINE_STATE_H
+
+#include "fnv.h"
+#include "spectrum_machine.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace z80::machine::spectrum {
+
+struct MachineState {
+    static constexpr uint8_t kVersion = 1;
+
+    uint64_t tag = 0;   ///< Opaque to MachineState; saved and loaded as-is.
+
+    // CPU
+    std::array<uint16_t, 14> regs{};   ///< AF BC DE HL AF' BC' DE' HL' IX IY SP PC IR WZ.
+    bool iff1 = false;
+    bool iff2 = false;
+    uint8_t im = 0;
+    bool halted = false;
+    bool ei_shadow = false;
+    uint64_t tstates = 0;
+
+    // ULA
+    uint8_t border = 0;
+    uint8_t beeper = 0;
+    std::array<uint8_t, 8> key_rows{0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F};
+    uint64_t ula_frames = 0;
+    uint64_t frame_start = 0;
+
+    // Frame clock
+    uint64_t frames = 0;
+    uint64_t carry = 0;
+
+    std::vector<uint8_t> memory = std::vector<uint8_t>(0x10000, 0x00);
+
+    /// @brief Snapshot @p machine (between frames).
+    [[nodiscard]] static MachineState capture(SpectrumMachine& machine) {
+        MachineState s;
+        SpectrumCpu& cpu = machine.cpu();
+        s.regs = {cpu.AF(),    cpu.BC(),    cpu.DE(),    cpu.HL(),    cpu.AltAF(),
+                  cpu.AltBC(), cpu.AltDE(), cpu.AltHL(), cpu.IX(),    cpu.IY(),
+                  cpu.SP(),    cpu.PC(),    cpu.IR(),    cpu.WZ()};
+        s.iff1 = cpu.IFF1();
+        s.iff2 = cpu.IFF2();
+        s.im = cpu.InterruptMode();
+        s.halted = cpu.IsHalted();
+        s.ei_shadow = cpu.InterruptShadow();
+        s.tstates = cpu.GetCycleCount();
+
+        const Ula& ula = machine.ula();
+        s.border = ula.border();
+        s.beeper = ula.beeper_level();
+        for (uint8_t row = 0; row < 8; ++row) {
+            uint8_t bits = 0x1F;
+            for (uint8_t bit = 0; bit < 5; ++bit)
+                if (ula.matrix_pressed(row, bit)) bits = static_cast<uint8_t>(bits & ~(1u << bit));
+            s.key_rows[row] = bits;
+        }
+        s.ula_frames = ula.frame_counter();
+        s.frame_start = ula.frame_start();
+
+        s.frames = machine.frame_clock().Frames();
+        s.carry = machine.frame_clock().Carry();
+
+        const uint8_t* mem = cpu.GetMemory().Data();
+        std::copy(mem, mem + 0x10000, s.memory.begin());
+        return s;
+    }
+
+    /// @brief Put @p machine into this state. The tape is left as it is.
+    void restore(SpectrumMachine& machine) const {
+        SpectrumCpu& cpu = machine.cpu();
+        cpu.GetMemory().RawLoad(0x0000, memory);
+        cpu.AF() = regs[0];
+        cpu.BC() = regs[1];
+        cpu.DE() = regs[2];
+        cpu.HL() = regs[3];
+        cpu.AltAF() = regs[4];
+        cpu.AltBC() = regs[5];
+        cpu.AltDE() = regs[6];
+        cpu.AltHL() = regs[7];
+        cpu.IX() = regs[8];
+        cpu.IY() = regs[9];
+        cpu.SP() = regs[10];
+        cpu.PC() = regs[11];
+        cpu.IR() = regs[12];
+        cpu.WZ() = regs[13];
+        cpu.IFF1() = iff1;
+        cpu.IFF2() = iff2;
+        cpu.SetInterruptMode(im);
+        cpu.SetHalted(halted);
+        cpu.SetInterruptShadow(ei_shadow);
+        cpu.SetCycleCount(tstates);
+
+        Ula& ula = machine.ula();
+        ula.restore(border, beeper, ula_frames, frame_start);
+        ula.release_all_keys();
+        for (uint8_t row = 0; row < 8; ++row)
+            for (uint8_t bit = 0; bit < 5; ++bit)
+                if (!(key_rows[row] & (1u << bit))) ula.key_down(row, bit);
+
+        machine.frame_clock().Restore(frames, carry);
+    }
+
+    [[nodiscard]] std::vector<uint8_t> save() const {
+        std::vector<uint8_t> out = {'Z', '8', '0', 'S', 'N', 'P', kVersion, 0};
+        out.reserve(out.size() + kFixedBytes + memory.size() + 4);
+        const auto put = [&out](uint64_t v, int n) {
+            for (int k = 0; k < n; ++k) out.push_back(static_cast<uint8_t>(v >> (8 * k)));
+        };
+        put(tag, 8);
+        for (uint16_t r : regs) put(r, 2);
+        for (bool b : {iff1, iff2}) put(b ? 1 : 0, 1);
+        put(im, 1);
+        for (bool b : {halted, ei_shadow}) put(b ? 1 : 0, 1);
+        put(tstates, 8);
+        put(border, 1);
+        put(beeper, 1);
+        out.insert(out.end(), key_rows.begin(), key_rows.end());
+        put(ula_frames, 8);
+        put(frame_start, 8);
+        put(frames, 8);
+        put(carry, 8);
+        out.insert(out.end(), memory.begin(), memory.end());
+        put(fnv1a32(out), 4);
+        return out;
+    }
+
+    /// @brief Replace this state with a saved one.
+    /// @return false (with @p error set, if given) on a malformed or corrupt
+    ///         image; the state is left unchanged.
+    bool load(std::span<const uint8_t> in, std::string* error = nullptr) {
+        const auto fail = [error](const char* why) {
+            if (error) *error = why;
+            return false;
+        };
+        static constexpr uint8_t kMagic[] = {'Z', '8', '0', 'S', 'N', 'P'};
+        if (in.size() < 8 || !std::equal(std::begin(kMagic), std::end(kMagic), in.begin()))
+            return fail("not a snapshot file");
+        if (in[6] != kVersion) return fail("unsupported snapshot version");
+        if (in.size() != 8 + kFixedBytes + 0x10000 + 4) return fail("wrong size");
+        const std::size_t body = in.size() - 4;
+        const uint32_t stored = static_cast<uint32_t>(in[body] | (in[body + 1] << 8) |
+                                                      (in[body + 2] << 16)) |
+                                (static_cast<uint32_t>(in[body + 3]) << 24);
+        if (stored != fnv1a32(in.first(body))) return fail("checksum mismatch");
+
+        std::size_t pos = 8;
+        const auto get = [&](int n) {
+            uint64_t v = 0;
+            for (int k = 0; k < n; ++k) v |= static_cast<uint64_t>(in[pos++]) << (8 * k);
+            return v;
+        };
+        MachineState s;
+        s.tag = get(8);
+        for (uint16_t& r : s.regs) r = static_cast<uint16_t>(get(2));
+        s.iff1 = get(1) != 0;
+        s.iff2 = get(1) != 0;
+        s.im = static_cast<uint8_t>(get(1));
+        s.halted = get(1) != 0;
+        s.ei_shadow = get(1) != 0;
+        if (s.im > 2) return fail("bad interrupt mode");
+        s.tstates = get(8);
+        s.border = static_cast<uint8_t>(get(1));
+        s.beeper = static_cast<uint8_t>(get(1));
+        for (uint8_t& row : s.key_rows) row = static_cast<uint8_t>(get(1));
+        s.ula_frames = get(8);
+        s.frame_start = get(8);
+        s.frames = get(8);
+        s.carry = get(8);
+        std::memcpy(s.memory.data(), in.data() + pos, 0x10000);
+        *this = std::move(s);
+        return true;
+    }
+
+    /// @return false if the file cannot be written.
+    bool save_file(const std::string& path) const {
+        std::ofstream f(path, std::ios::binary);
+        if (!f) return false;
+        const std::vector<uint8_t> bytes = save();
+        f.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        return static_cast<bool>(f);
+    }
+
+    /// @return false if the file cannot be read or is not a valid snapshot.
+    bool load_file(const std::string& path, std::string* error = nullptr) {
+        std::ifstream f(path, std::ios::binary);
+        if (!f) {
+            if (error) *error = "cannot open file";
+            return false;
+        }
+        const std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(f)),
+                                         std::istreambuf_iterator<char>());
+        return load(bytes, error);
+    }
+
+private:
+    /// Bytes between the 8-byte header and the memory image.
+    static constexpr std::size_t kFixedBytes = 8 + 14 * 2 + 5 + 8 + 2 + 8 + 4 * 8;
+};
+
+} // namespace z80::machine::spectrum
+
+#endif // Z80_MACHINE_SPECTRUM_MACHINE_STATE_H
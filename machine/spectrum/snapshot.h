@@ -0,0 +1,433 @@
+//
+// Z80 Digital Twin - ZX Spectrum .sna / .z80 snapshots
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// Import and export of the two interchange formats most 48K software is
+// distributed in, so a game test can start from the title's own snapshot
+// instead of a real-time tape load:
+//   * .sna — 27-byte register header + 48 KB RAM. PC lives on the stack
+//     (popped on load, pushed on save), as with a RETN-from-NMI save;
+//   * .z80 — v1 (30-byte header, one 48 KB image, optionally RLE) and v2/v3
+//     (extended header, 16 KB pages, each RLE or stored). v3's T-state counter
+//     is honoured: the first frame after loading resumes at that position.
+// 128K, 16K and other hardware modes are rejected, not half-loaded.
+//
+// RLE ("ED ED count byte", a lone ED's next byte literal) is decoded straight
+// into memory through ObservableMemory::RawRegion — no observers, no write
+// protection, no staging buffer. Every block is first decoded once without
+// writing, so a corrupt file fails before the machine is touched.
+//
+// Neither format records HALT, the EI shadow, or the ULA's speaker, FLASH or
+// keyboard state. A halted CPU is saved with PC on its HALT, so it halts again
+// on load. The ROM, the tape and the T-state count's origin are left alone.
+//
+
+#ifndef Z80_MACHINE_SPECTRUM_SNAPSHOT_H
+#define Z80_MACHINE_SPECTRUM_SNAPSHOT_H
+
+#include "spectrum_machine.h"
+#include "timing.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace z80::machine::spectrum {
+
+enum class SnapshotFormat : uint8_t { Sna, Z80 };
+
+namespace snapshot_detail {
+
+inline constexpr std::size_t kRam = 0xC000;
+inline constexpr std::size_t kPage = 0x4000;
+inline constexpr std::size_t kSnaHeader = 27;
+inline constexpr std::size_t kBad = static_cast<std::size_t>(-1);
+
+/// @brief The CPU/ULA state both formats carry.
+struct Registers {
+    uint16_t af = 0, bc = 0, de = 0, hl = 0;
+    uint16_t af2 = 0, bc2 = 0, de2 = 0, hl2 = 0;
+    uint16_t ix = 0, iy = 0, sp = 0, pc = 0;
+    uint8_t i = 0, r = 0, im = 0, border = 0;
+    bool iff1 = false, iff2 = false;
+};
+
+[[nodiscard]] inline uint16_t word(std::span<const uint8_t> in, std::size_t at) noexcept {
+    return static_cast<uint16_t>(in[at] | (in[at + 1] << 8));
+}
+
+inline void put_word(std::vector<uint8_t>& out, std::size_t at, uint16_t v) {
+    out[at] = static_cast<uint8_t>(v);
+    out[at + 1] = static_cast<uint8_t>(v >> 8);
+}
+
+/// @brief Decode .z80 RLE from @p in until exactly @p size bytes are produced.
+/// @param out  Destination, or nullptr to validate only.
+/// @return Bytes of @p in consumed, or kBad if the input runs out or a run
+///         overshoots @p size.
+[[nodiscard]] inline std::size_t rle_decode(std::span<const uint8_t> in, uint8_t* out,
+                                            std::size_t size) noexcept {
+    const uint8_t* p = in.data();
+    const uint8_t* const end = p + in.size();
+    std::size_t o = 0;
+    while (o < size) {
+        if (end - p >= 2 && p[0] == 0xED && p[1] == 0xED) {
+            if (end - p < 4 || p[2] > size - o) return kBad;
+            if (out) std::memset(out + o, p[3], p[2]);
+            o += p[2];
+            p += 4;
+        } else {
+            if (p == end) return kBad;
+            if (out) out[o] = *p;
+            ++o;
+            ++p;
+        }
+    }
+    return static_cast<std::size_t>(p - in.data());
+}
+
+/// @brief RLE-encode @p in onto @p out: runs of 5+ (or 2+ EDs) become
+///        ED ED n b, and the byte after a lone ED is never folded into a run.
+inline void rle_encode(std::span<const uint8_t> in, std::vector<uint8_t>& out) {
+    std::size_t i = 0;
+    while (i < in.size()) {
+        const uint8_t b = in[i];
+        std::size_t run = 1;
+        while (i + run < in.size() && in[i + run] == b && run < 255) ++run;
+        if (run >= 5 || (b == 0xED && run >= 2)) {
+            out.insert(out.end(), {0xED, 0xED, static_cast<uint8_t>(run), b});
+            i += run;
+            continue;
+        }
+        out.push_back(b);
+        ++i;
+        if (b == 0xED && i < in.size()) out.push_back(in[i++]);
+    }
+}
+
+/// @brief Current CPU/ULA state in snapshot terms (PC stepped back onto a HALT).
+[[nodiscard]] inline Registers read_registers(SpectrumMachine& machine) {
+    SpectrumCpu& cpu = machine.cpu();
+    Registers r;
+    r.af = cpu.AF(); r.bc = cpu.BC(); r.de = cpu.DE(); r.hl = cpu.HL();
+    r.af2 = cpu.AltAF(); r.bc2 = cpu.AltBC(); r.de2 = cpu.AltDE(); r.hl2 = cpu.AltHL();
+    r.ix = cpu.IX(); r.iy = cpu.IY(); r.sp = cpu.SP();
+    r.pc = static_cast<uint16_t>(cpu.PC() - (cpu.IsHalted() ? 1 : 0));
+    r.i = cpu.I(); r.r = cpu.R();
+    r.im = cpu.InterruptMode();
+    r.iff1 = cpu.IFF1(); r.iff2 = cpu.IFF2();
+    r.border = machine.ula().border();
+    return r;
+}
+
+/// @brief Install @p r, @p position T-states into a frame (0 = the frame
+///        interrupt is due next). The T-state count carries on from now.
+inline void apply_registers(SpectrumMachine& machine, const Registers& r, uint64_t position) {
+    SpectrumCpu& cpu = machine.cpu();
+    cpu.AF() = r.af; cpu.BC() = r.bc; cpu.DE() = r.de; cpu.HL() = r.hl;
+    cpu.AltAF() = r.af2; cpu.AltBC() = r.bc2; cpu.AltDE() = r.de2; cpu.AltHL() = r.hl2;
+    cpu.IX() = r.ix; cpu.IY() = r.iy; cpu.SP() = r.sp; cpu.PC() = r.pc;
+    cpu.I() = r.i; cpu.R() = r.r;
+    cpu.WZ() = 0;
+    cpu.IFF1() = r.iff1;
+    cpu.IFF2() = r.iff2;
+    cpu.SetInterruptMode(r.im);
+    cpu.SetHalted(false);
+    cpu.SetInterruptShadow(false);
+
+    if (position >= timing::kTPerFrame) position = 0;
+    const uint64_t now = std::max(cpu.GetCycleCount(), position);
+    cpu.SetCycleCount(now);
+    Ula& ula = machine.ula();
+    ula.restore(r.border, 0, ula.frame_counter(), now - position);
+    machine.frame_clock().ResumeMidFrame(position);
+}
+
+/// @brief v3 T-state counter <-> position in the frame. The low word counts
+///        down through each quarter frame; the high byte numbers the quarters
+///        starting one before the interrupt.
+inline constexpr uint64_t kQuarter = timing::kTPerFrame / 4;
+
+[[nodiscard]] inline uint64_t z80_tstates(uint16_t low, uint8_t high) noexcept {
+    const uint64_t t = (static_cast<uint64_t>((high + 1) % 4) + 1) * kQuarter - (uint64_t{low} + 1);
+    return t < timing::kTPerFrame ? t : 0;
+}
+
+/// @brief Where a .z80 page lands in a 48K machine (0 = not a 48K RAM page).
+[[nodiscard]] inline uint16_t page_address(uint8_t page) noexcept {
+    switch (page) {
+        case 8: return 0x4000;
+        case 4: return 0x8000;
+        case 5: return 0xC000;
+        default: return 0;
+    }
+}
+
+[[nodiscard]] inline bool fail(std::string* error, const char* why) {
+    if (error) *error = why;
+    return false;
+}
+
+} // namespace snapshot_detail
+
+/// @brief Load a 48K .sna into @p machine (ROM already loaded).
+/// @return false (with @p error set, if given) on a malformed image; the
+///         machine is left unchanged.
+inline bool load_sna(SpectrumMachine& machine, std::span<const uint8_t> in,
+                     std::string* error = nullptr) {
+    using namespace snapshot_detail;
+    if (in.size() != kSnaHeader + kRam) {
+        return fail(error, in.size() > kSnaHeader + kRam ? "128K snapshots are not supported"
+                                                         : "not a 48K .sna file");
+    }
+    if (in[25] > 2) return fail(error, "bad interrupt mode");
+
+    Registers r;
+    r.i = in[0];
+    r.hl2 = word(in, 1); r.de2 = word(in, 3); r.bc2 = word(in, 5); r.af2 = word(in, 7);
+    r.hl = word(in, 9); r.de = word(in, 11); r.bc = word(in, 13);
+    r.iy = word(in, 15); r.ix = word(in, 17);
+    r.iff1 = r.iff2 = (in[19] & 0x04) != 0;
+    r.r = in[20];
+    r.af = word(in, 21);
+    r.sp = word(in, 23);
+    r.im = in[25];
+    r.border = static_cast<uint8_t>(in[26] & 0x07);
+
+    ObservableMemory& mem = machine.cpu().GetMemory();
+    mem.RawLoad(0x4000, in.subspan(kSnaHeader));
+    // PC was pushed by the saver; pop it (ROM and RAM both readable here).
+    const uint8_t* data = mem.Data();
+    r.pc = static_cast<uint16_t>(data[r.sp] | (data[static_cast<uint16_t>(r.sp + 1)] << 8));
+    r.sp = static_cast<uint16_t>(r.sp + 2);
+    apply_registers(machine, r, 0);
+    return true;
+}
+
+/// @brief Save @p machine as a 48K .sna. PC is pushed onto the saved RAM image
+///        (not the machine), so a load resumes via RETN semantics.
+[[nodiscard]] inline std::vector<uint8_t> save_sna(SpectrumMachine& machine) {
+    using namespace snapshot_detail;
+    const Registers r = read_registers(machine);
+    std::vector<uint8_t> out(kSnaHeader + kRam, 0);
+    const uint8_t* data = machine.cpu().GetMemory().Data();
+    std::copy(data + 0x4000, data + 0x10000, out.begin() + kSnaHeader);
+
+    const uint16_t sp = static_cast<uint16_t>(r.sp - 2);
+    const auto poke = [&out](uint16_t addr, uint8_t v) {
+        if (addr >= 0x4000) out[kSnaHeader + addr - 0x4000] = v;   // a push into ROM is lost
+    };
+    poke(sp, static_cast<uint8_t>(r.pc));
+    poke(static_cast<uint16_t>(sp + 1), static_cast<uint8_t>(r.pc >> 8));
+
+    out[0] = r.i;
+    put_word(out, 1, r.hl2); put_word(out, 3, r.de2); put_word(out, 5, r.bc2); put_word(out, 7, r.af2);
+    put_word(out, 9, r.hl); put_word(out, 11, r.de); put_word(out, 13, r.bc);
+    put_word(out, 15, r.iy); put_word(out, 17, r.ix);
+    out[19] = r.iff2 ? 0x04 : 0x00;
+    out[20] = r.r;
+    put_word(out, 21, r.af);
+    put_word(out, 23, sp);
+    out[25] = r.im;
+    out[26] = r.border;
+    return out;
+}
+
+/// @brief Load a 48K .z80 (v1, v2 or v3) into @p machine (ROM already loaded).
+/// @return false (with @p error set, if given) on a malformed image or an
+///         unsupported machine; the machine is left unchanged.
+inline bool load_z80(SpectrumMachine& machine, std::span<const uint8_t> in,
+                     std::string* error = nullptr) {
+    using namespace snapshot_detail;
+    if (in.size() < 30) return fail(error, "truncated file");
+    const uint8_t flags = in[12] == 0xFF ? 0x01 : in[12];
+    if ((in[29] & 0x03) > 2) return fail(error, "bad interrupt mode");
+
+    Registers r;
+    r.af = static_cast<uint16_t>((in[0] << 8) | in[1]);
+    r.bc = word(in, 2); r.hl = word(in, 4); r.pc = word(in, 6); r.sp = word(in, 8);
+    r.i = in[10];
+    r.r = static_cast<uint8_t>((in[11] & 0x7F) | ((flags & 0x01) << 7));
+    r.border = static_cast<uint8_t>((flags >> 1) & 0x07);
+    r.de = word(in, 13); r.bc2 = word(in, 15); r.de2 = word(in, 17); r.hl2 = word(in, 19);
+    r.af2 = static_cast<uint16_t>((in[21] << 8) | in[22]);
+    r.iy = word(in, 23); r.ix = word(in, 25);
+    r.iff1 = in[27] != 0;
+    r.iff2 = in[28] != 0;
+    r.im = static_cast<uint8_t>(in[29] & 0x03);
+
+    ObservableMemory& mem = machine.cpu().GetMemory();
+
+    if (r.pc != 0) {   // --- version 1: one 48 KB image -----------------------
+        const std::span<const uint8_t> body = in.subspan(30);
+        if (!(flags & 0x20)) {
+            if (body.size() < kRam) return fail(error, "truncated file");
+            mem.RawLoad(0x4000, body.first(kRam));
+        } else {
+            if (rle_decode(body, nullptr, kRam) == kBad) return fail(error, "corrupt memory block");
+            (void)rle_decode(body, mem.RawRegion(0x4000, kRam).data(), kRam);
+        }
+        apply_registers(machine, r, 0);
+        return true;
+    }
+
+    // --- versions 2 and 3: extended header + 16 KB pages ----------------------
+    if (in.size() < 32) return fail(error, "truncated file");
+    const std::size_t ext = word(in, 30);
+    const int version = ext == 23 ? 2 : (ext == 54 || ext == 55) ? 3 : 0;
+    if (version == 0) return fail(error, "unknown .z80 header length");
+    if (in.size() < 32 + ext) return fail(error, "truncated file");
+    r.pc = word(in, 32);
+    const uint8_t hw = in[34];
+    const bool is_48k = hw == 0 || hw == 1 || (version == 3 && hw == 3);
+    if (!is_48k || (in[37] & 0x80)) return fail(error, "only 48K snapshots are supported");
+    const uint64_t position = version == 3 ? z80_tstates(word(in, 55), in[57]) : 0;
+
+    struct Block { std::span<const uint8_t> data; uint16_t address; bool packed; };
+    std::array<Block, 3> blocks{};
+    int found = 0;
+    std::size_t pos = 32 + ext;
+    while (pos < in.size()) {
+        if (in.size() - pos < 3) return fail(error, "truncated file");
+        const std::size_t len = word(in, pos);
+        const uint16_t address = page_address(in[pos + 2]);
+        pos += 3;
+        const bool packed = len != 0xFFFF;
+        const std::size_t stored = packed ? len : kPage;
+        if (in.size() - pos < stored) return fail(error, "truncated file");
+        const std::span<const uint8_t> data = in.subspan(pos, stored);
+        pos += stored;
+        if (address == 0) continue;                        // not 48K RAM (e.g. a ROM page)
+        if (packed && rle_decode(data, nullptr, kPage) != stored)
+            return fail(error, "corrupt memory block");
+        const std::size_t slot = (address - 0x4000) / kPage;
+        if (blocks[slot].address == 0) ++found;
+        blocks[slot] = {data, address, packed};
+    }
+    if (found != 3) return fail(error, "missing memory page");
+
+    for (const Block& b : blocks) {
+        if (b.packed) (void)rle_decode(b.data, mem.RawRegion(b.address, kPage).data(), kPage);
+        else mem.RawLoad(b.address, b.data);
+    }
+    apply_registers(machine, r, position);
+    return true;
+}
+
+/// @brief Save @p machine as a 48K .z80.
+/// @param version  1 (single RLE image), 2 or 3 (paged; v3 adds the T-state
+///                 position so a mid-frame save resumes mid-frame). A v1 file
+///                 cannot hold PC 0000h (a zero PC there marks v2/v3), so
+///                 that machine is saved as v2 instead.
+[[nodiscard]] inline std::vector<uint8_t> save_z80(SpectrumMachine& machine, int version = 3) {
+    using namespace snapshot_detail;
+    version = std::clamp(version, 1, 3);
+    const Registers r = read_registers(machine);
+    if (version == 1 && r.pc == 0) version = 2;
+    const std::size_t ext = version == 1 ? 0 : version == 2 ? 23 : 54;
+    std::vector<uint8_t> out(version == 1 ? 30 : 32 + ext, 0);
+
+    out[0] = static_cast<uint8_t>(r.af >> 8);
+    out[1] = static_cast<uint8_t>(r.af);
+    put_word(out, 2, r.bc);
+    put_word(out, 4, r.hl);
+    put_word(out, 6, version == 1 ? r.pc : 0);
+    put_word(out, 8, r.sp);
+    out[10] = r.i;
+    out[11] = static_cast<uint8_t>(r.r & 0x7F);
+    out[12] = static_cast<uint8_t>((r.r >> 7) | (r.border << 1) | (version == 1 ? 0x20 : 0));
+    put_word(out, 13, r.de);
+    put_word(out, 15, r.bc2);
+    put_word(out, 17, r.de2);
+    put_word(out, 19, r.hl2);
+    out[21] = static_cast<uint8_t>(r.af2 >> 8);
+    out[22] = static_cast<uint8_t>(r.af2);
+    put_word(out, 23, r.iy);
+    put_word(out, 25, r.ix);
+    out[27] = r.iff1 ? 1 : 0;
+    out[28] = r.iff2 ? 1 : 0;
+    out[29] = r.im;
+
+    const uint8_t* data = machine.cpu().GetMemory().Data();
+    if (version == 1) {
+        rle_encode({data + 0x4000, kRam}, out);
+        out.insert(out.end(), {0x00, 0xED, 0xED, 0x00});
+        return out;
+    }
+
+    put_word(out, 30, static_cast<uint16_t>(ext));
+    put_word(out, 32, r.pc);
+    out[34] = 0;   // 48K
+    if (version == 3) {
+        uint64_t position = machine.cpu().GetCycleCount() - machine.ula().frame_start();
+        if (position >= timing::kTPerFrame) position = 0;
+        put_word(out, 55, static_cast<uint16_t>(kQuarter - position % kQuarter - 1));
+        out[57] = static_cast<uint8_t>((position / kQuarter + 3) % 4);
+        out[61] = out[62] = 0xFF;   // 0x0000-0x3FFF is ROM
+    }
+    std::vector<uint8_t> packed;
+    for (const auto& [page, address] : {std::pair<uint8_t, uint16_t>{8, 0x4000}, {4, 0x8000}, {5, 0xC000}}) {
+        packed.clear();
+        rle_encode({data + address, kPage}, packed);
+        const bool store = version == 3 && packed.size() >= kPage;   // v2 has no stored pages
+        const std::size_t at = out.size();
+        out.resize(at + 3);
+        put_word(out, at, store ? 0xFFFF : static_cast<uint16_t>(packed.size()));
+        out[at + 2] = page;
+        if (store) out.insert(out.end(), data + address, data + address + kPage);
+        else out.insert(out.end(), packed.begin(), packed.end());
+    }
+    return out;
+}
+
+/// @brief The format a file name implies (.sna / .z80, any case).
+[[nodiscard]] inline std::optional<SnapshotFormat> snapshot_format_for(std::string_view path) {
+    if (path.size() < 4) return std::nullopt;
+    std::string ext(path.substr(path.size() - 4));
+    for (char& c : ext) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    if (ext == ".sna") return SnapshotFormat::Sna;
+    if (ext == ".z80") return SnapshotFormat::Z80;
+    return std::nullopt;
+}
+
+/// @brief Load a .sna/.z80 file (format from its extension).
+inline bool load_snapshot_file(SpectrumMachine& machine, const std::string& path,
+                               std::string* error = nullptr) {
+    const std::optional<SnapshotFormat> format = snapshot_format_for(path);
+    if (!format) return snapshot_detail::fail(error, "not a .sna or .z80 file");
+    std::ifstream f(path, std::ios::binary);
+    if (!f) return snapshot_detail::fail(error, "cannot open file");
+    const std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(f)),
+                                     std::istreambuf_iterator<char>());
+    return *format == SnapshotFormat::Sna ? load_sna(machine, bytes, error)
+                                          : load_z80(machine, bytes, error);
+}
+
+/// @brief Save a .sna/.z80 file (format from its extension; .z80 is v3).
+inline bool save_snapshot_file(SpectrumMachine& machine, const std::string& path,
+                               std::string* error = nullptr) {
+    const std::optional<SnapshotFormat> format = snapshot_format_for(path);
+    if (!format) return snapshot_detail::fail(error, "not a .sna or .z80 file");
+    const std::vector<uint8_t> bytes =
+        *format == SnapshotFormat::Sna ? save_sna(machine) : save_z80(machine);
+    std::ofstream f(path, std::ios::binary);
+    f.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    if (!f) return snapshot_detail::fail(error, "cannot write file");
+    return true;
+}
+
+} // namespace z80::machine::spectrum
+
+#endif // Z80_MACHINE_SPECTRUM_SNAPSHOT_H
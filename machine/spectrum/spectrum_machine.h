@@ -36,19 +36,24 @@
 #include <array>
 #include <cstdint>
 #include <span>
+#include <utility>
 #include <vector>
 
 namespace z80::machine::spectrum {
 
 using SpectrumCpu = z80::CPUImpl<z80::ObservableMemory, z80::ObservableIo<z80::CallbackIo>>;
 
-class SpectrumMachine {
+/// @brief A 48K built around @p Cpu, which must have SpectrumCpu's Memory and
+///        Io policies; only its Traits may differ. Everything else — the
+///        debugger, snapshots, movies — works on SpectrumMachine.
+template <class Cpu = SpectrumCpu>
+class BasicSpectrumMachine {
 public:
     static constexpr int kWidth  = video::kFrameWidth;
     static constexpr int kHeight = video::kFrameHeight;
     static constexpr int kPixels = video::kFramePixels;
 
-    SpectrumMachine() : machine_(cpu_, timing::kTPerFrame) {
+    BasicSpectrumMachine() : machine_(cpu_, timing::kTPerFrame) {
         ula_.set_clock([this] { return cpu_.GetCycleCount(); });
         ula_.set_reader([this](uint16_t addr) { return cpu_.ReadMemory(addr); });
         cpu_.GetIo().inner().OnOut([this](uint16_t port, uint8_t value) { ula_.write_port(port, value); });
@@ -80,17 +85,37 @@ public:
 
     /// @brief Run one PAL frame (fires the frame interrupt) and advance the ULA.
     void run_frame() {
-        ula_.begin_frame();             // drop the previous frame's display-write history
-        machine_.RunFrame([this](uint64_t target) {
+        run_frame_with([this](uint64_t target) {
             const uint64_t before = cpu_.GetCycleCount();
             while (cpu_.GetCycleCount() - before < target && !cpu_.IsHalted()) {
                 do { cpu_.Step(); } while (!cpu_.InstructionComplete());
             }
             return cpu_.GetCycleCount() - before;
         });
+    }
+
+    /// @brief Run one PAL frame, advancing the CPU through @p step instead of
+    ///        the raw loop — e.g. a DebugSession's RunForTStates, or an input
+    ///        replayer that splits the frame at event T-states. Same frame
+    ///        budget and carry as run_frame(), so the two stay cycle-identical.
+    /// @param step  Callable `uint64_t(uint64_t target_tstates)` (see
+    ///              Machine::RunFrame).
+    template <class Stepper>
+    void run_frame_with(Stepper&& step) {
+        ula_.begin_frame();             // drop the previous frame's display-write history
+        machine_.RunFrame(std::forward<Stepper>(step));
         ula_.end_frame();
     }
 
+    /// @brief The reset button: resets the Z80 only. The ULA keeps its frame
+    ///        clock and the T-state count carries on, so input timestamps
+    ///        (InputMovie) stay monotonic across a reset. RAM is untouched.
+    void reset() {
+        const uint64_t now = cpu_.GetCycleCount();
+        cpu_.Reset();
+        cpu_.SetCycleCount(now);
+    }
+
     /// @brief Render the current frame as palette indices (kPixels values).
     void render_indices(std::span<uint8_t> out) const {
         video::render_frame(ula_, ula_.flash_on(), out);
@@ -114,17 +139,25 @@ public:
     void stop_tape() { tape_.stop(); }
     [[nodiscard]] Tape& tape() noexcept { return tape_; }
 
-    [[nodiscard]] SpectrumCpu& cpu() noexcept { return cpu_; }
+    [[nodiscard]] Cpu& cpu() noexcept { return cpu_; }
     [[nodiscard]] Ula& ula() noexcept { return ula_; }
+    [[nodiscard]] Machine<Cpu>& frame_clock() noexcept { return machine_; }
     [[nodiscard]] uint64_t frame_count() const noexcept { return ula_.frame_counter(); }
 
 private:
-    SpectrumCpu cpu_;
+    Cpu cpu_;
     Ula ula_;
     Tape tape_;
-    Machine<SpectrumCpu> machine_;
+    Machine<Cpu> machine_;
 };
 
+using SpectrumMachine = BasicSpectrumMachine<>;
+
+/// @brief A Spectrum whose CPU counts its instruction mix (cpu().Mix()).
+using InstrumentedSpectrumMachine =
+    BasicSpectrumMachine<z80::CPUImpl<z80::ObservableMemory, z80::ObservableIo<z80::CallbackIo>,
+                                      z80::InstrumentedCpuTraits>>;
+
 } // namespace z80::machine::spectrum
 
 #endif // Z80_MACHINE_SPECTRUM_SPECTRUM_MACHINE_H
@@ -0,0 +1,159 @@
+//
+// Z80 Digital Twin - ZX Spectrum machine state hash
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// A 64-bit fingerprint of everything that determines how a SpectrumMachine
+// runs from here on: the T-state count, CPU registers and interrupt state
+// (EI shadow included), all 64 KB of memory, the ULA's latches (border,
+// beeper, keyboard, FLASH phase) and the tape: the loaded image's fingerprint
+// and, while it plays, the T-state playback started at. Two machines with equal hashes at a frame boundary
+// behave identically given the same input — so comparing hashes answers "did
+// these runs diverge?" and a golden test can pin a hash instead of a frame.
+//
+// Memory dominates the cost, so StateHasher keeps one hash per 256-byte page
+// and re-hashes only the pages written since the last call. Dirty pages come
+// from ObservableMemory's opt-in bitmap (SetDirtyPages), set on the write path
+// itself, so nothing is missed and nothing is scanned. A frame that touches a
+// handful of pages costs a handful of page hashes plus a 256-entry fold.
+//
+// The hash is non-cryptographic: 64-bit multiply/xor-shift mixing over 8-byte
+// words in four independent lanes. state_hash() computes the same value from
+// scratch (for one-off checks and as the reference in tests).
+//
+
+#ifndef Z80_MACHINE_SPECTRUM_STATE_HASH_H
+#define Z80_MACHINE_SPECTRUM_STATE_HASH_H
+
+#include "spectrum_machine.h"
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace z80::machine::spectrum {
+
+namespace state_hash_detail {
+
+inline constexpr uint64_t kMul = 0x9E3779B97F4A7C15ull;
+
+/// @brief Final avalanche (splitmix64 finaliser).
+[[nodiscard]] constexpr uint64_t mix(uint64_t x) noexcept {
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBull;
+    x ^= x >> 31;
+    return x;
+}
+
+/// @brief Hash one 256-byte page: four lanes of (lane ^ word) * odd constant,
+///        rotated, so the multiply chains overlap; seeded by the page number so
+///        identical pages at different addresses differ.
+[[nodiscard]] inline uint64_t hash_page(const uint8_t* page, std::size_t index) noexcept {
+    uint64_t lane[4] = {index, index ^ 0x243F6A8885A308D3ull, index ^ 0x13198A2E03707344ull,
+                        index ^ 0xA4093822299F31D0ull};
+    for (std::size_t off = 0; off < ObservableMemory::kPageSize; off += 32) {
+        for (int k = 0; k < 4; ++k) {
+            uint64_t w;
+            std::memcpy(&w, page + off + 8 * k, sizeof w);
+            lane[k] = (lane[k] ^ w) * kMul;
+            lane[k] = (lane[k] << 29) | (lane[k] >> 35);
+        }
+    }
+    return mix(lane[0] ^ mix(lane[1] ^ mix(lane[2] ^ mix(lane[3]))));
+}
+
+/// @brief Fold the per-page hashes with the CPU, ULA and tape state.
+[[nodiscard]] inline uint64_t combine(const std::array<uint64_t, ObservableMemory::kPages>& pages,
+                                      SpectrumMachine& machine) noexcept {
+    uint64_t h = 0;
+    for (uint64_t p : pages) h = mix(h ^ p) + kMul;
+
+    SpectrumCpu& cpu = machine.cpu();
+    const auto pair = [](uint16_t a, uint16_t b, uint16_t c, uint16_t d) {
+        return uint64_t{a} | (uint64_t{b} << 16) | (uint64_t{c} << 32) | (uint64_t{d} << 48);
+    };
+    h = mix(h ^ cpu.GetCycleCount());
+    h = mix(h ^ pair(cpu.AF(), cpu.BC(), cpu.DE(), cpu.HL()));
+    h = mix(h ^ pair(cpu.AltAF(), cpu.AltBC(), cpu.AltDE(), cpu.AltHL()));
+    h = mix(h ^ pair(cpu.IX(), cpu.IY(), cpu.SP(), cpu.PC()));
+
+    const Ula& ula = machine.ula();
+    uint64_t keys = 0;
+    for (uint8_t row = 0; row < 8; ++row)
+        for (uint8_t bit = 0; bit < 5; ++bit)
+            if (ula.matrix_pressed(row, bit)) keys |= uint64_t{1} << (row * 5 + bit);
+    const uint64_t flags = (cpu.IFF1() ? 1u : 0u) | (cpu.IFF2() ? 2u : 0u) |
+                           (cpu.IsHalted() ? 4u : 0u) |
+                           (static_cast<uint64_t>(cpu.InterruptMode()) << 3) |
+                           (static_cast<uint64_t>(ula.border()) << 5) |
+                           (static_cast<uint64_t>(ula.beeper_level()) << 8) |
+                           (machine.tape().playing() ? uint64_t{1} << 9 : 0) |
+                           ((ula.frame_counter() & 0x1F) << 10) |
+                           (cpu.InterruptShadow() ? uint64_t{1} << 15 : 0);
+    h = mix(h ^ pair(cpu.IR(), cpu.WZ(), 0, 0) ^ (flags << 32));
+
+    const Tape& tape = machine.tape();
+    h = mix(h ^ tape.fingerprint());
+    if (tape.playing()) h = mix(h ^ tape.start_cycle());
+    return mix(h ^ keys);
+}
+
+} // namespace state_hash_detail
+
+/// @brief The machine's state hash, computed from scratch.
+[[nodiscard]] inline uint64_t state_hash(SpectrumMachine& machine) {
+    const uint8_t* mem = machine.cpu().GetMemory().Data();
+    std::array<uint64_t, ObservableMemory::kPages> pages{};
+    for (std::size_t p = 0; p < pages.size(); ++p)
+        pages[p] = state_hash_detail::hash_page(mem + p * ObservableMemory::kPageSize, p);
+    return state_hash_detail::combine(pages, machine);
+}
+
+/// @brief Incremental state_hash(): attaches to the machine's memory as its
+///        dirty-page tracker and re-hashes only written pages on each hash().
+///        One tracker per machine at a time; detaches on destruction.
+class StateHasher {
+public:
+    explicit StateHasher(SpectrumMachine& machine) : machine_(machine) {
+        dirty_.fill(~uint64_t{0});   // first hash() covers every page
+        machine_.cpu().GetMemory().SetDirtyPages(dirty_.data());
+    }
+    ~StateHasher() { machine_.cpu().GetMemory().SetDirtyPages(nullptr); }
+    StateHasher(const StateHasher&) = delete;
+    StateHasher& operator=(const StateHasher&) = delete;
+
+    /// @brief Equal to state_hash(machine), at the cost of the pages written
+    ///        since the previous call.
+    [[nodiscard]] uint64_t hash() {
+        const uint8_t* mem = machine_.cpu().GetMemory().Data();
+        rehashed_ = 0;
+        for (std::size_t w = 0; w < dirty_.size(); ++w) {
+            uint64_t bits = dirty_[w];
+            dirty_[w] = 0;
+            while (bits) {
+                const std::size_t p = w * 64 + static_cast<std::size_t>(std::countr_zero(bits));
+                bits &= bits - 1;
+                pages_[p] = state_hash_detail::hash_page(mem + p * ObservableMemory::kPageSize, p);
+                ++rehashed_;
+            }
+        }
+        return state_hash_detail::combine(pages_, machine_);
+    }
+
+    /// @brief Pages the last hash() had to re-hash (0..256).
+    [[nodiscard]] std::size_t pages_rehashed() const noexcept { return rehashed_; }
+
+private:
+    SpectrumMachine& machine_;
+    std::array<uint64_t, ObservableMemory::kDirtyWords> dirty_{};
+    std::array<uint64_t, ObservableMemory::kPages> pages_{};
+    std::size_t rehashed_ = 0;
+};
+
+} // namespace z80::machine::spectrum
+
+#endif // Z80_MACHINE_SPECTRUM_STATE_HASH_H
@@ -210,6 +210,11 @@ public:
     [[nodiscard]] std::size_t block_count() const noexcept { return blocks_; }
     [[nodiscard]] std::size_t pulse_count() const noexcept { return pulses_.size(); }
     [[nodiscard]] uint64_t total_tstates() const noexcept { return total_; }
+    /// @brief The CPU T-state playback started at (meaningful while playing()).
+    [[nodiscard]] uint64_t start_cycle() const noexcept { return start_cycle_; }
+    /// @brief A hash of the pulse train, kept as it is built: two loaded
+    ///        images give the same EAR signal only if their fingerprints match.
+    [[nodiscard]] uint64_t fingerprint() const noexcept { return fingerprint_; }
 
     /// @brief True once playback has run past the final pulse (load finished).
     [[nodiscard]] bool finished(uint64_t cpu_cycle) const noexcept {
@@ -247,6 +252,7 @@ private:
         pulses_.clear();
         total_ = 0;
         blocks_ = 0;
+        fingerprint_ = 0;
     }
 
     bool done() {
@@ -295,11 +301,14 @@ private:
         if (tstates == 0) return;
         pulses_.push_back(tstates);
         total_ += tstates;
+        fingerprint_ = (fingerprint_ ^ tstates) * 0x9E3779B97F4A7C15ull;
+        fingerprint_ ^= fingerprint_ >> 29;
     }
 
     std::vector<uint32_t> pulses_;
     uint64_t total_ = 0;
     std::size_t blocks_ = 0;
+    uint64_t fingerprint_ = 0;
     bool initial_level_ = false;   // signal starts low; toggles each pulse
     bool playing_ = false;
     uint64_t start_cycle_ = 0;
@@ -194,6 +194,23 @@ public:
         beeper_edges_.clear();
     }
 
+    /// @brief Restore the latches a machine snapshot carries, as of a frame
+    ///        boundary: border, speaker level, FLASH phase and frame start.
+    ///        The per-frame timelines restart from the restored border.
+    void restore(uint8_t border, uint8_t beeper_level, uint64_t frame_counter,
+                 uint64_t frame_start) {
+        current_border_ = static_cast<uint8_t>(border & 0x07);
+        beeper_level_ = static_cast<uint8_t>(beeper_level & 1);
+        frame_counter_ = frame_counter;
+        frame_start_ = frame_start;
+        border_events_.assign(1, BorderEvent{0, current_border_});
+        border_per_line_.fill(current_border_);
+        screen_writes_.clear();
+        beeper_edges_.clear();
+    }
+
+    [[nodiscard]] uint64_t frame_start() const noexcept { return frame_start_; }
+
     /// @brief Is this matrix position currently pressed? (0 bit = pressed.)
     [[nodiscard]] bool matrix_pressed(uint8_t half_row, uint8_t bit) const noexcept {
         if (half_row >= 8 || bit >= 5) return false;
@@ -0,0 +1,65 @@
+//
+// Z80 Digital Twin - CPU build traits
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// The third CPUImpl template parameter. Memory and Io choose the devices the
+// CPU talks to; Traits chooses what the CPU does besides executing — switches
+// read with `if constexpr`, so a disabled feature costs no code and (with
+// [[no_unique_address]] state) no space.
+//
+//   DefaultCpuTraits       every build: superinstructions in RunUntilCycle()
+//   InstrumentedCpuTraits  counts the dynamic instruction mix (instruction_mix.h)
+//   ComputeCpuTraits       pure computation: no R, WZ or interrupt bookkeeping
+//
+// A new traits type derives from DefaultCpuTraits and overrides only the
+// switches it changes, so adding a switch here never breaks existing traits.
+//
+
+#ifndef Z80_CPU_TRAITS_H
+#define Z80_CPU_TRAITS_H
+
+namespace z80 {
+
+struct DefaultCpuTraits {
+    /// @brief Count every executed opcode, its T-states and its prefix chain
+    ///        into an InstructionMix (CPUImpl::Mix()).
+    static constexpr bool kInstrumented = false;
+
+    /// @brief Let RunUntilCycle() run hot idioms (LD A,D / OR E / JR Z, a
+    ///        PUSH/POP block, ...) as one fused handler. Step() never fuses.
+    static constexpr bool kSuperinstructions = true;
+
+    /// @brief Advance R on every M1 fetch and interrupt acknowledge. Off, R
+    ///        holds whatever was last loaded into it (LD R,A, Reset()).
+    static constexpr bool kTrackRefresh = true;
+
+    /// @brief Keep WZ (MEMPTR) where instructions set it. Off, WZ is never
+    ///        written, so nothing that reads it (BIT n,(HL) flags) is exact.
+    static constexpr bool kTrackMemptr = true;
+
+    /// @brief Accept maskable interrupts and keep EI's one-instruction
+    ///        shadow. Off, Interrupt() always refuses and the shadow is never
+    ///        set; EI and DI still set IFF1/IFF2.
+    static constexpr bool kInterrupts = true;
+};
+
+struct InstrumentedCpuTraits : DefaultCpuTraits {
+    static constexpr bool kInstrumented = true;
+    // The mix is counted in Step(), so every instruction must go through it.
+    static constexpr bool kSuperinstructions = false;
+};
+
+/// @brief For code that only computes — the GCD sweeps, algorithm checks —
+///        and never reads R or WZ or takes an interrupt. Registers, flags,
+///        memory and T-states are the default CPU's; R, WZ and the EI shadow
+///        are not maintained.
+struct ComputeCpuTraits : DefaultCpuTraits {
+    static constexpr bool kTrackRefresh = false;
+    static constexpr bool kTrackMemptr = false;
+    static constexpr bool kInterrupts = false;
+};
+
+} // namespace z80
+
+#endif // Z80_CPU_TRAITS_H
@@ -0,0 +1,50 @@
+//
+// Z80 Digital Twin - FNV-1a hashing
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// The one hash behind every file format and fingerprint in the tree: the
+// 32-bit form is the trailing checksum of the state, checkpoint, movie and
+// coverage files, and the 64-bit form identifies ROMs, programs and states.
+// Fnv32/Fnv64 take bytes a piece at a time; fnv1a32()/fnv1a64() hash a
+// whole span. Not for anything adversarial.
+//
+
+#ifndef Z80_FNV_H
+#define Z80_FNV_H
+
+#include <cstdint>
+#include <span>
+
+namespace z80 {
+
+/// @brief Incremental FNV-1a over bytes, with @p Word's offset basis and prime.
+template <class Word, Word kBasis, Word kPrime>
+class Fnv1a {
+public:
+    constexpr void byte(uint8_t b) noexcept { h_ = (h_ ^ b) * kPrime; }
+    constexpr void bytes(std::span<const uint8_t> data) noexcept { for (uint8_t b : data) byte(b); }
+    [[nodiscard]] constexpr Word value() const noexcept { return h_; }
+
+private:
+    Word h_ = kBasis;
+};
+
+using Fnv32 = Fnv1a<uint32_t, 0x811C9DC5u, 0x01000193u>;
+using Fnv64 = Fnv1a<uint64_t, 0xCBF29CE484222325ull, 0x100000001B3ull>;
+
+[[nodiscard]] constexpr uint32_t fnv1a32(std::span<const uint8_t> data) noexcept {
+    Fnv32 h;
+    h.bytes(data);
+    return h.value();
+}
+
+[[nodiscard]] constexpr uint64_t fnv1a64(std::span<const uint8_t> data) noexcept {
+    Fnv64 h;
+    h.bytes(data);
+    return h.value();
+}
+
+} // namespace z80
+
+#endif // Z80_FNV_H
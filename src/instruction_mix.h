@@ -0,0 +1,140 @@
+//
+// Z80 Digital Twin - dynamic instruction mix
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// What an instrumented CPU (CPUImpl<..., InstrumentedCpuTraits>) records as it
+// runs: for each of the seven opcode tables, how many times every opcode
+// completed and the T-states those executions took (prefix fetches included,
+// so the totals add up to the CPU's clock); how long the prefix chains in
+// front of instructions were, and how many prefixes were wasted because
+// another DD/FD/ED replaced them; and the interrupts accepted.
+//
+// A block-repeat instruction (LDIR, CPIR, OTIR, ...) counts once per
+// iteration, as the CPU executes it. DDCB/FDCB instructions are counted under
+// their final opcode byte, the one that selects the operation.
+//
+// Plain data: Merge() adds runs together, Clear() starts over. The CPU only
+// calls the three On*() hooks; tools/instruction_mix prints the report.
+//
+
+#ifndef Z80_INSTRUCTION_MIX_H
+#define Z80_INSTRUCTION_MIX_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace z80 {
+
+/// @brief The opcode tables. Values match CPUState, so the CPU maps the state
+///        an instruction completed in straight onto its table.
+enum class OpcodeTable : uint8_t { Base, CB, DD, ED, FD, DDCB, FDCB };
+
+inline constexpr std::size_t kOpcodeTables = 7;
+
+/// @brief Table name as its prefix bytes ("base" for unprefixed).
+constexpr const char* OpcodeTableName(OpcodeTable table) {
+    constexpr const char* kNames[kOpcodeTables] = {"base", "CB", "DD", "ED", "FD", "DDCB", "FDCB"};
+    return kNames[static_cast<std::size_t>(table)];
+}
+
+struct InstructionMix {
+    /// @brief Chain-length buckets: 0, 1, 2, 3 and "4 or more" prefix bytes.
+    static constexpr std::size_t kChainBuckets = 5;
+
+    std::array<std::array<uint64_t, 256>, kOpcodeTables> count{};    ///< Executions per opcode
+    std::array<std::array<uint64_t, 256>, kOpcodeTables> tstates{};  ///< T-states per opcode
+    std::array<uint64_t, kChainBuckets> chain{};  ///< Instructions by prefix bytes in front
+    uint64_t redundant_prefixes = 0;  ///< DD/FD replaced by a following DD, FD or ED
+    uint64_t interrupts = 0;          ///< Interrupts accepted
+    uint64_t interrupt_tstates = 0;   ///< T-states of the acknowledge cycles
+
+    [[nodiscard]] uint64_t Count(OpcodeTable table, uint8_t opcode) const {
+        return count[static_cast<std::size_t>(table)][opcode];
+    }
+    [[nodiscard]] uint64_t TStates(OpcodeTable table, uint8_t opcode) const {
+        return tstates[static_cast<std::size_t>(table)][opcode];
+    }
+
+    /// @brief Instructions completed, interrupts excluded.
+    [[nodiscard]] uint64_t Instructions() const {
+        uint64_t n = 0;
+        for (const auto& table : count)
+            for (uint64_t c : table) n += c;
+        return n;
+    }
+
+    /// @brief T-states of completed instructions, interrupts excluded.
+    [[nodiscard]] uint64_t TStates() const {
+        uint64_t n = 0;
+        for (const auto& table : tstates)
+            for (uint64_t t : table) n += t;
+        return n;
+    }
+
+    /// @brief Zero every counter. Safe between the Step()s of a prefixed
+    ///        instruction: the one in flight is still counted when it ends.
+    void Clear() {
+        const uint64_t start = start_;
+        const uint32_t fetches = fetches_;
+        *this = InstructionMix{};
+        start_ = start;
+        fetches_ = fetches;
+    }
+
+    void Merge(const InstructionMix& other) {
+        for (std::size_t t = 0; t < kOpcodeTables; ++t) {
+            for (std::size_t op = 0; op < 256; ++op) {
+                count[t][op] += other.count[t][op];
+                tstates[t][op] += other.tstates[t][op];
+            }
+        }
+        for (std::size_t i = 0; i < kChainBuckets; ++i) chain[i] += other.chain[i];
+        redundant_prefixes += other.redundant_prefixes;
+        interrupts += other.interrupts;
+        interrupt_tstates += other.interrupt_tstates;
+    }
+
+    // -- CPU hooks ------------------------------------------------------------
+
+    /// @brief One opcode byte fetched (one Step()).
+    /// @param starts     No prefix was pending: a new instruction begins here.
+    /// @param redundant  A pending DD/FD prefix is being replaced.
+    void OnFetch(bool starts, bool redundant, uint64_t now) {
+        if (starts) {
+            start_ = now;
+            fetches_ = 0;
+        }
+        ++fetches_;
+        if (redundant) ++redundant_prefixes;
+    }
+
+    /// @brief The instruction begun at the last OnFetch(starts) completed.
+    void OnComplete(OpcodeTable table, uint8_t opcode, uint64_t now) {
+        const std::size_t t = static_cast<std::size_t>(table);
+        ++count[t][opcode];
+        tstates[t][opcode] += now - start_;
+        // DDCB/FDCB fetch displacement and opcode in their last Step(), so
+        // their prefix bytes are fetches - 1 like everything else.
+        const std::size_t prefixes = fetches_ - 1u;
+        ++chain[prefixes < kChainBuckets ? prefixes : kChainBuckets - 1];
+    }
+
+    void OnInterrupt(uint64_t cycles) {
+        ++interrupts;
+        interrupt_tstates += cycles;
+    }
+
+private:
+    uint64_t start_ = 0;
+    uint32_t fetches_ = 0;
+};
+
+/// @brief Stand-in for InstructionMix in uninstrumented builds: an empty
+///        [[no_unique_address]] member, so it takes no space in CPUImpl.
+struct NoInstructionMix {};
+
+} // namespace z80
+
+#endif // Z80_INSTRUCTION_MIX_H
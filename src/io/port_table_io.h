@@ -0,0 +1,62 @@
+//
+// Z80 Digital Twin - PortTableIo policy
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// A device table for embedding: 256 entries, one per low port byte (A0-A7,
+// which is all most Z80 peripherals decode), each a plain function pointer
+// pair with a context pointer. It is what the C API (capi/z80twin.h) plugs in:
+// handlers are installed once, and an IN or OUT then costs an indexed load and
+// an indirect call, with nothing allocated and no std::function in between.
+// The handler is given the full 16-bit port, so it can decode more if it
+// wants. A port with no handler is an open bus (OUT discarded, IN -> 0xFF).
+//
+
+#ifndef Z80_PORT_TABLE_IO_H
+#define Z80_PORT_TABLE_IO_H
+
+#include <array>
+#include <cstdint>
+
+namespace z80 {
+
+class PortTableIo {
+public:
+    using InFn  = uint8_t (*)(void* context, uint16_t port);
+    using OutFn = void (*)(void* context, uint16_t port, uint8_t value);
+
+    /// @brief One device's entry points. Either function may be null.
+    struct Handler {
+        InFn in = nullptr;
+        OutFn out = nullptr;
+        void* context = nullptr;
+    };
+
+    /// @brief Value a floating data bus reads as when no handler is installed.
+    static constexpr uint8_t kFloating = 0xFF;
+
+    [[nodiscard]] uint8_t In(uint16_t port) {
+        const Handler& h = table_[port & 0xFF];
+        return h.in ? h.in(h.context, port) : kFloating;
+    }
+    void Out(uint16_t port, uint8_t value) {
+        const Handler& h = table_[port & 0xFF];
+        if (h.out) h.out(h.context, port, value);
+    }
+
+    /// @brief Route low port bytes [first, last] to @p handler.
+    void Map(uint8_t first, uint8_t last, const Handler& handler) noexcept {
+        for (unsigned p = first; p <= last; ++p) table_[p] = handler;
+    }
+    /// @brief Return [first, last] to the open bus.
+    void Unmap(uint8_t first, uint8_t last) noexcept { Map(first, last, Handler{}); }
+
+    [[nodiscard]] const Handler& HandlerFor(uint8_t low_byte) const noexcept { return table_[low_byte]; }
+
+private:
+    std::array<Handler, 256> table_{};
+};
+
+} // namespace z80
+
+#endif // Z80_PORT_TABLE_IO_H
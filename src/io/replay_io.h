@@ -0,0 +1,71 @@
+//
+// Z80 Digital Twin - ReplayIo policy
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// Plays back another CPU's bus transactions. A lockstep checker runs a
+// reference CPU over code a candidate has just run; the devices have already
+// answered the candidate, and asking them again would repeat their side
+// effects (and may not give the same answer). So the reference is given the
+// candidate's transactions, in order: each In() returns the value the
+// candidate read at the same position, and every access is recorded so the
+// two sequences can be compared — same ports, same direction, same OUT values.
+//
+// Past the end of the script In() reads as an open bus (0xFF).
+//
+
+#ifndef Z80_REPLAY_IO_H
+#define Z80_REPLAY_IO_H
+
+#include "open_bus_io.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace z80 {
+
+class ReplayIo {
+public:
+    struct Access {
+        uint16_t port = 0;
+        uint8_t value = 0;
+        bool is_out = false;   ///< true = OUT (write), false = IN (read)
+
+        bool operator==(const Access&) const = default;
+    };
+
+    [[nodiscard]] uint8_t In(uint16_t port) {
+        const uint8_t value = next_ < script_.size() ? script_[next_].value : OpenBusIo::kFloating;
+        ++next_;
+        performed_.push_back({port, value, false});
+        return value;
+    }
+    void Out(uint16_t port, uint8_t value) {
+        ++next_;
+        performed_.push_back({port, value, true});
+    }
+
+    /// @brief Append a transaction to replay.
+    void Expect(const Access& access) { script_.push_back(access); }
+    /// @brief Forget the script and what was performed.
+    void Clear() noexcept {
+        script_.clear();
+        performed_.clear();
+        next_ = 0;
+    }
+
+    [[nodiscard]] const std::vector<Access>& Expected() const noexcept { return script_; }
+    [[nodiscard]] const std::vector<Access>& Performed() const noexcept { return performed_; }
+    /// @brief The CPU did exactly the scripted transactions, no more, no fewer.
+    [[nodiscard]] bool Matches() const noexcept { return performed_ == script_; }
+
+private:
+    std::vector<Access> script_;
+    std::vector<Access> performed_;
+    std::size_t next_ = 0;
+};
+
+} // namespace z80
+
+#endif // Z80_REPLAY_IO_H
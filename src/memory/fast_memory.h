@@ -38,6 +38,10 @@ public:
         return data_[address];
     }
 
+    /// @brief The raw 64 KB image, for bulk loads and zero-copy views.
+    [[nodiscard]] uint8_t* Data() noexcept { return data_.data(); }
+    [[nodiscard]] const uint8_t* Data() const noexcept { return data_.data(); }
+
 private:
     // Value-initialized so a freshly constructed CPU sees a deterministic,
     // zeroed address space (RAII: the object owns a fully-defined state on
@@ -9,18 +9,30 @@
 // observers can be attached at once — e.g. the debugger's dirty/SMC/watch
 // handler *and* a machine device — so a running machine stays fully debuggable.
 //
-// Its speed is intentionally irrelevant: tooling drives the CPU at interactive
-// rates, and the production/benchmark build never instantiates this type. Reads
-// are never hooked, so fetch/operand traffic is untouched.
+// It is not only for tooling: every Spectrum runs on it, including the many
+// instances spectrum_server hosts, and the benchmarks time its configurations
+// next to FastMemory's. So what nobody asked for must stay cheap. Reads are not
+// observed; a profiler may opt in to a flat per-address read counter
+// (SetReadCounter), which costs one null test per read while unset. Likewise a
+// state hasher may opt in to a dirty-page bitmap (SetDirtyPages) so it re-hashes
+// only the 256-byte pages written since it last looked.
+//
+// A host running many machines may map shared read-only pages over the start
+// of the 64 KB image — one ROM for all of them — and declare them with
+// SetReadOnlyPrefix (see shared_rom.h).
 //
 
 #ifndef Z80_OBSERVABLE_MEMORY_H
 #define Z80_OBSERVABLE_MEMORY_H
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <functional>
+#include <optional>
+#include <span>
 #include <utility>
 #include <vector>
 
@@ -49,7 +61,10 @@ public:
         Reference(ObservableMemory& owner, uint16_t address) noexcept
             : owner_(owner), address_(address) {}
 
-        operator uint8_t() const noexcept { return owner_.data_[address_]; }
+        operator uint8_t() const noexcept {
+            if (owner_.read_counts_) ++owner_.read_counts_[address_];
+            return owner_.data_[address_];
+        }
 
         Reference& operator=(uint8_t value) {
             // Write-protected region (e.g. ROM): a real bus ignores the write, so
@@ -61,6 +76,7 @@ public:
             }
             const uint8_t old_value = owner_.data_[address_];
             owner_.data_[address_] = value;
+            owner_.MarkDirty(address_);
             owner_.Notify(address_, old_value, value);
             return *this;
         }
@@ -119,22 +135,121 @@ public:
         }
     }
 
+    // -- Read counting (opt-in; profiling) -----------------------------------
+
+    /// @brief Count every CPU read (fetches included) into @p counts[address].
+    ///        @p counts must hold SIZE entries and outlive its registration;
+    ///        nullptr stops counting. Const (tooling) reads are never counted.
+    void SetReadCounter(uint32_t* counts) noexcept { read_counts_ = counts; }
+    [[nodiscard]] bool CountingReads() const noexcept { return read_counts_ != nullptr; }
+
+    // -- Dirty pages (opt-in; state hashing) ---------------------------------
+
+    static constexpr std::size_t kPageSize = 256;
+    static constexpr std::size_t kPages = SIZE / kPageSize;
+    static constexpr std::size_t kDirtyWords = kPages / 64;
+
+    /// @brief Set bit (address >> 8) of @p bits on every committed write —
+    ///        emulated or RawWrite — so a consumer can re-hash only the pages
+    ///        that changed. @p bits must hold kDirtyWords words and outlive its
+    ///        registration; the consumer clears them. nullptr stops tracking.
+    void SetDirtyPages(uint64_t* bits) noexcept { dirty_pages_ = bits; }
+    [[nodiscard]] bool TrackingDirtyPages() const noexcept { return dirty_pages_ != nullptr; }
+
+    /// @brief The raw 64 KB image (read-only; for hashing and snapshots).
+    [[nodiscard]] const uint8_t* Data() const noexcept { return data_.data(); }
+
     // -- Write protection (opt-in; e.g. ROM) ---------------------------------
 
     /// @brief Make writes in [lo, hi] no-ops (a real bus ignores writes to ROM).
     void SetWriteProtect(uint16_t lo, uint16_t hi) noexcept {
         protect_enabled_ = true; protect_lo_ = lo; protect_hi_ = hi;
     }
-    void ClearWriteProtect() noexcept { protect_enabled_ = false; }
+    void ClearWriteProtect() noexcept {
+        protect_enabled_ = data_.read_only_end != 0;   // read-only pages stay protected
+        protect_lo_ = 1;
+        protect_hi_ = 0;
+    }
     [[nodiscard]] bool WriteProtected(uint16_t address) const noexcept {
-        return protect_enabled_ && address >= protect_lo_ && address <= protect_hi_;
+        return protect_enabled_ &&
+               (address < data_.read_only_end || (address >= protect_lo_ && address <= protect_hi_));
+    }
+    /// @brief The protected [lo, hi], if any — to give another memory the same.
+    [[nodiscard]] std::optional<std::pair<uint16_t, uint16_t>> WriteProtectRange() const noexcept {
+        if (!protect_enabled_ || protect_lo_ > protect_hi_) return std::nullopt;
+        return std::pair{protect_lo_, protect_hi_};
+    }
+
+    // -- Read-only pages (opt-in; a shared ROM) ------------------------------
+
+    /// @brief The image, for a host mapping pages over it (shared_rom.h).
+    [[nodiscard]] uint8_t* ImagePages() noexcept { return data_.data(); }
+
+    /// @brief The host has mapped read-only pages over [0, @p end). From now
+    ///        on every write there is refused like a protected one, the Raw*
+    ///        loaders skip it, and @p restore(image, end) is called to make
+    ///        the pages private memory again before this memory is destroyed
+    ///        or assigned. A copy gets ordinary memory with the same bytes.
+    ///        The old and new prefixes are marked dirty. (0, nullptr) drops it.
+    void SetReadOnlyPrefix(uint16_t end, void (*restore)(uint8_t* image, std::size_t bytes)) noexcept {
+        MarkDirtyRange(0, std::max(data_.read_only_end, end));
+        data_.Release();
+        data_.read_only_end = end;
+        data_.restore = restore;
+        if (end != 0 && !protect_enabled_) {
+            protect_enabled_ = true;   // with an empty range of its own
+            protect_lo_ = 1;
+            protect_hi_ = 0;
+        }
     }
+    /// @brief The read-only prefix's end (0: none).
+    [[nodiscard]] uint16_t ReadOnlyEnd() const noexcept { return data_.read_only_end; }
 
     /// @brief Tooling-only direct write: bypasses observers AND write protection
     ///        (for loading ROM images / resetting RAM, not for emulated writes).
-    void RawWrite(uint16_t address, uint8_t value) noexcept { data_[address] = value; }
+    ///        Read-only pages are still skipped.
+    void RawWrite(uint16_t address, uint8_t value) noexcept {
+        if (address < data_.read_only_end) return;
+        data_[address] = value;
+        MarkDirty(address);
+    }
+
+    /// @brief Tooling-only bulk RawWrite: copy @p bytes to @p start (wrapping
+    ///        at 0xFFFF) in one memcpy per run — for snapshots and ROM images.
+    void RawLoad(uint16_t start, std::span<const uint8_t> bytes) noexcept {
+        std::size_t done = 0;
+        while (done < bytes.size()) {
+            const std::size_t at = (start + done) & (SIZE - 1);
+            const std::size_t n = std::min(bytes.size() - done, SIZE - at);
+            const std::size_t skip = at < data_.read_only_end ? std::min<std::size_t>(data_.read_only_end - at, n) : 0;
+            std::memcpy(data_.data() + at + skip, bytes.data() + done + skip, n - skip);
+            MarkDirtyRange(at + skip, n - skip);
+            done += n;
+        }
+    }
+
+    /// @brief Tooling-only writable view of [start, start + size) for bulk
+    ///        loaders that fill memory in place (snapshot decompression) — no
+    ///        observers, no write protection. The range is marked dirty up
+    ///        front. Clipped at 0xFFFF (no wrap); empty if it starts in the
+    ///        read-only pages.
+    [[nodiscard]] std::span<uint8_t> RawRegion(uint16_t start, std::size_t size) noexcept {
+        if (start < data_.read_only_end) return {};
+        size = std::min(size, SIZE - start);
+        MarkDirtyRange(start, size);
+        return {data_.data() + start, size};
+    }
 
 private:
+    void MarkDirty(uint16_t address) noexcept {
+        if (dirty_pages_) dirty_pages_[address >> 14] |= uint64_t{1} << ((address >> 8) & 63);
+    }
+    void MarkDirtyRange(std::size_t at, std::size_t n) noexcept {
+        if (!dirty_pages_ || n == 0) return;
+        for (std::size_t page = at / kPageSize; page <= (at + n - 1) / kPageSize; ++page)
+            dirty_pages_[page / 64] |= uint64_t{1} << (page % 64);
+    }
+
     void Notify(uint16_t address, uint8_t old_value, uint8_t new_value) {
         for (auto& [id, observer] : observers_) {
             if (observer) observer(address, old_value, new_value);
@@ -147,10 +262,41 @@ private:
         }
     }
 
-    std::array<uint8_t, SIZE> data_{};
+    /// The image (first, so a host can place it on a page boundary) and its
+    /// read-only prefix, which assignment makes writable before copying.
+    struct Image {
+        std::array<uint8_t, SIZE> bytes{};
+        uint16_t read_only_end = 0;
+        void (*restore)(uint8_t*, std::size_t) = nullptr;
+
+        Image() = default;
+        Image(const Image& other) noexcept : bytes(other.bytes) {}
+        Image& operator=(const Image& other) noexcept {
+            if (this != &other) {
+                Release();
+                bytes = other.bytes;
+            }
+            return *this;
+        }
+        ~Image() { Release(); }
+
+        void Release() noexcept {
+            if (read_only_end && restore) restore(bytes.data(), read_only_end);
+            read_only_end = 0;
+            restore = nullptr;
+        }
+        [[nodiscard]] uint8_t* data() noexcept { return bytes.data(); }
+        [[nodiscard]] const uint8_t* data() const noexcept { return bytes.data(); }
+        [[nodiscard]] uint8_t& operator[](std::size_t i) noexcept { return bytes[i]; }
+        [[nodiscard]] uint8_t operator[](std::size_t i) const noexcept { return bytes[i]; }
+    };
+
+    Image data_;
     std::vector<std::pair<int, WriteObserver>> observers_;
     std::vector<std::pair<int, BlockedWriteObserver>> blocked_observers_;
     int next_id_ = 0;
+    uint32_t* read_counts_ = nullptr;
+    uint64_t* dirty_pages_ = nullptr;
     bool protect_enabled_ = false;
     uint16_t protect_lo_ = 0;
     uint16_t protect_hi_ = 0;
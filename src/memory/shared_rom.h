@@ -0,0 +1,194 @@
+//
+// Z80 Digital Twin - SharedRom (POSIX)
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// One ROM image for any number of machines. Instead of copying the ROM into
+// every ObservableMemory, MapInto() maps the ROM file MAP_PRIVATE and
+// read-only over the start of the memory's own image. The page tables of
+// every machine then point at the same page-cache pages: one copy in RAM and
+// in the (physically tagged) L2/L3, whether the machines are threads of one
+// process or forked workers. Reads cost nothing extra — the image is still
+// the flat array the CPU indexes.
+//
+// Writes there are refused like write-protected ones (ObservableMemory::
+// SetReadOnlyPrefix), so the machine behaves as with set_rom_write_protect.
+// The file must not change while mapped.
+//
+// Pages can only be mapped over an image that starts on a page boundary, and
+// a machine's image sits wherever its object puts it. MakePageAligned() places
+// a machine so that it does; MapInto() refuses any other, saying why (copy the
+// ROM in). A type MakePageAligned() cannot place is reported the same way.
+//
+
+#ifndef Z80_SHARED_ROM_H
+#define Z80_SHARED_ROM_H
+
+#include "memory/observable_memory.h"
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace z80 {
+
+class SharedRom {
+public:
+    static constexpr std::size_t kMaxSize = 0x4000;   ///< The region a ROM may map over
+
+    /// @brief Open @p path (1 byte to kMaxSize). ok() is false on failure,
+    ///        with the reason in @p error.
+    static SharedRom Open(const std::string& path, std::string* error = nullptr) {
+        SharedRom rom;
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat st {};
+        if (fd < 0 || ::fstat(fd, &st) != 0) {
+            if (error) *error = path + ": " + std::strerror(errno);
+            if (fd >= 0) ::close(fd);
+            return rom;
+        }
+        if (st.st_size < 1 || static_cast<std::size_t>(st.st_size) > kMaxSize) {
+            if (error) *error = path + ": not a ROM image (1 byte to 16 KB)";
+            ::close(fd);
+            return rom;
+        }
+        rom.fd_ = fd;
+        rom.size_ = static_cast<std::size_t>(st.st_size);
+        return rom;
+    }
+
+    SharedRom() = default;
+    SharedRom(SharedRom&& other) noexcept
+        : fd_(std::exchange(other.fd_, -1)), size_(std::exchange(other.size_, 0)) {}
+    SharedRom& operator=(SharedRom&& other) noexcept {
+        if (this != &other) {
+            Close();
+            fd_ = std::exchange(other.fd_, -1);
+            size_ = std::exchange(other.size_, 0);
+        }
+        return *this;
+    }
+    SharedRom(const SharedRom&) = delete;
+    SharedRom& operator=(const SharedRom&) = delete;
+    /// Mappings already made stay valid.
+    ~SharedRom() { Close(); }
+
+    [[nodiscard]] bool ok() const noexcept { return fd_ >= 0; }
+    [[nodiscard]] std::size_t size() const noexcept { return size_; }
+
+    /// @brief Map the ROM read-only over @p memory's [0, kMaxSize); a short
+    ///        ROM is followed by read-only zeros. False, with the reason in
+    ///        @p error, if the image is not page-aligned (MakePageAligned) or
+    ///        the mapping fails — copy the ROM in instead. After a failed
+    ///        mapping [0, kMaxSize) is zeroed, writable memory again.
+    bool MapInto(ObservableMemory& memory, std::string* error = nullptr) const {
+        const std::size_t page = PageSize();
+        uint8_t* image = memory.ImagePages();
+        if (!ok()) {
+            if (error) *error = "shared ROM is not open";
+            return false;
+        }
+        if (kMaxSize % page != 0 || reinterpret_cast<uintptr_t>(image) % page != 0) {
+            if (error) *error = "memory image does not start on a page (not placed by MakePageAligned)";
+            return false;
+        }
+
+        memory.SetReadOnlyPrefix(0, nullptr);   // drop an earlier mapping first
+        const std::size_t file_bytes = (size_ + page - 1) / page * page;
+        // A MAP_FIXED that fails may already have unmapped the range: every
+        // failure from here on gives the image writable pages back.
+        const bool mapped =
+            ::mmap(image, file_bytes, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd_, 0) != MAP_FAILED &&
+            (file_bytes == kMaxSize || ::mmap(image + file_bytes, kMaxSize - file_bytes, PROT_READ,
+                                              MAP_PRIVATE | MAP_FIXED | MAP_ANONYMOUS, -1, 0) != MAP_FAILED);
+        if (!mapped) {
+            if (error) *error = std::string("mmap: ") + std::strerror(errno);
+            Restore(image, kMaxSize);
+            return false;
+        }
+        memory.SetReadOnlyPrefix(static_cast<uint16_t>(kMaxSize), &Restore);
+        return true;
+    }
+
+    [[nodiscard]] static std::size_t PageSize() noexcept {
+        static const auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        return page;
+    }
+
+private:
+    /// Give the image its own zeroed, writable pages back. Aborts if it
+    /// cannot: the pages belong to a heap object, and leaving them read-only
+    /// or unmapped would fault far from here.
+    static void Restore(uint8_t* image, std::size_t bytes) {
+        if (::mmap(image, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED | MAP_ANONYMOUS, -1, 0) ==
+            MAP_FAILED) {
+            std::perror("SharedRom: restoring writable pages");
+            std::abort();
+        }
+    }
+
+    void Close() noexcept {
+        if (fd_ >= 0) ::close(fd_);
+        fd_ = -1;
+        size_ = 0;
+    }
+
+    int fd_ = -1;
+    std::size_t size_ = 0;
+};
+
+/// @brief Frees what MakePageAligned() made.
+template <class T>
+struct PageAlignedDelete {
+    std::size_t shift = 0;   ///< From the start of the allocation to the T
+    bool placed = true;      ///< false: T could not be placed; MapInto() will refuse it
+    void operator()(T* p) const noexcept {
+        p->~T();
+        ::operator delete(reinterpret_cast<unsigned char*>(p) - shift, std::align_val_t{SharedRom::PageSize()});
+    }
+};
+
+/// @brief A default-constructed T on the heap, placed so that the image of
+///        the ObservableMemory @p memory_of(T&) returns starts on a page — so
+///        SharedRom::MapInto() can map over it. The image's offset in T is
+///        found once per T, by constructing a probe. If that offset leaves no
+///        aligned spot for T, T is allocated unplaced and get_deleter().placed
+///        is false.
+template <class T, class MemoryOf>
+std::unique_ptr<T, PageAlignedDelete<T>> MakePageAligned(MemoryOf memory_of) {
+    const std::size_t page = SharedRom::PageSize();
+    static const std::size_t placement = [&] {   // the shift, or page if T is unplaceable
+        const auto probe = std::make_unique<T>();
+        const auto offset = static_cast<std::size_t>(memory_of(*probe).ImagePages() -
+                                                     reinterpret_cast<uint8_t*>(probe.get()));
+        const std::size_t s = (page - offset % page) % page;
+        return s % alignof(T) == 0 ? s : page;
+    }();
+    const bool placed = placement != page;
+    const std::size_t shift = placed ? placement : 0;
+    void* base = ::operator new(shift + sizeof(T), std::align_val_t{page});
+    T* t = nullptr;
+    try {
+        t = new (static_cast<unsigned char*>(base) + shift) T();
+    } catch (...) {
+        ::operator delete(base, std::align_val_t{page});
+        throw;
+    }
+    return std::unique_ptr<T, PageAlignedDelete<T>>(t, PageAlignedDelete<T>{shift, placed});
+}
+
+} // namespace z80
+
+#endif // Z80_SHARED_ROM_H
@@ -8,6 +8,8 @@
 #include "io/latched_io.h"
 #include "io/observable_io.h"
 #include "io/callback_io.h"
+#include "io/replay_io.h"
+#include "io/port_table_io.h"
 #include <algorithm>
 
 namespace z80 {
@@ -16,17 +18,16 @@ namespace z80 {
 // Construction/Destruction
 // =============================================================================
 
-template <class Memory, class Io>
-CPUImpl<Memory, Io>::CPUImpl() {
+template <class Memory, class Io, class Traits>
+CPUImpl<Memory, Io, Traits>::CPUImpl() {
     Reset();
-    InitializeInstructionTables();
 }
 
-template <class Memory, class Io>
-CPUImpl<Memory, Io>::~CPUImpl() = default;
+template <class Memory, class Io, class Traits>
+CPUImpl<Memory, Io, Traits>::~CPUImpl() = default;
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::Reset() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::Reset() {
     // Initialize CPU state
     t_cycle = 0;
     _PC = 0;
@@ -63,11 +64,12 @@ void CPUImpl<Memory, Io>::Reset() {
     // Memory and I/O devices manage their own initial state (the policies).
 }
 
-template <class Memory, class Io>
-bool CPUImpl<Memory, Io>::Interrupt(uint8_t bus) {
+template <class Memory, class Io, class Traits>
+bool CPUImpl<Memory, Io, Traits>::Interrupt(uint8_t bus) {
     // Maskable interrupt: accepted only when enabled and not in the one-
     // instruction shadow of an EI (so an `EI : RET` handler tail can't be
     // re-entered between the two).
+    if constexpr (!Traits::kInterrupts) return false;
     if (!_IFF1 || ei_defer_) return false;
 
     // Acceptance wakes a halted CPU. PC already points past the HALT (the fetch
@@ -81,7 +83,7 @@ bool CPUImpl<Memory, Io>::Interrupt(uint8_t bus) {
 
     // The interrupt-acknowledge cycle is an M1, so it bumps R too (low 7 bits;
     // bit 7 preserved) — keeps R consistent for refresh-keyed code across an ISR.
-    R() = static_cast<uint8_t>((R() & 0x80u) | ((R() + 1u) & 0x7Fu));
+    Refresh();
 
     switch (_interrupt_mode) {
         case 2: {
@@ -105,6 +107,7 @@ bool CPUImpl<Memory, Io>::Interrupt(uint8_t bus) {
             t_cycle += 13;
             break;
     }
+    if constexpr (Traits::kInstrumented) mix_.OnInterrupt(_interrupt_mode == 2 ? 19 : 13);
     return true;
 }
 
@@ -112,22 +115,191 @@ bool CPUImpl<Memory, Io>::Interrupt(uint8_t bus) {
 // Core Execution
 // =============================================================================
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::RunUntilCycle(uint64_t target_cycle) {
+namespace {
+/// @brief First bytes of the idioms RunFused() knows (see Superinstructions
+///        below), so every other opcode costs RunUntilCycle one lookup.
+constexpr std::array<bool, 256> kFusedHead = [] {
+    std::array<bool, 256> head{};
+    for (uint8_t op : {0x7A, 0x78, 0xB7, 0x05, 0x7E, 0xC1, 0xC5, 0xD1, 0xD5, 0xE1, 0xE5, 0xF1, 0xF5})
+        head[op] = true;
+    return head;
+}();
+} // namespace
+
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::RunUntilCycle(uint64_t target_cycle) {
     while (t_cycle < target_cycle && !_halted) {
+        // At an instruction boundary outside an EI shadow, a hot idiom runs
+        // as one superinstruction; anything else is an ordinary Step().
+        if constexpr (Traits::kSuperinstructions) {
+            const uint8_t opcode = Peek(_PC);
+            if (kFusedHead[opcode] && current_state == CPUState::NORMAL &&
+                !(Traits::kInterrupts && ei_defer_) && RunFused(opcode, target_cycle))
+                continue;
+        }
+        Step();
+    }
+}
+
+template <class Memory, class Io, class Traits>
+bool CPUImpl<Memory, Io, Traits>::RunUntilCycleOrPc(uint64_t target_cycle, const uint64_t* stop_pcs) {
+    bool first = InstructionComplete();
+    while (t_cycle < target_cycle && !_halted) {
+        if (current_state == CPUState::NORMAL) {
+            if (!first && (stop_pcs[_PC >> 6] >> (_PC & 63) & 1)) return true;
+            first = false;
+        }
         Step();
     }
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+// Superinstructions
+// -----------------------------------------------------------------------------
+// The idioms that dominate the instruction mix (tools/instruction_mix on the
+// GCD and the 48K ROM), each run with direct calls to its handlers instead of
+// one table dispatch per instruction. A fused handler does exactly what the
+// Steps would: the same M1 bookkeeping (FetchM1), each handler's own
+// T-states, and after every part it checks the budget, so a run that must
+// stop inside the idiom stops on the same byte RunUntilCycle always did —
+// even between ED and its opcode. The rest then runs as ordinary Steps.
+//
+// Follow-on bytes are read only when their part is about to run, so code that
+// rewrites itself (a PUSH into the next opcode) still executes what is there.
+//
+// RunFused returns false, having done nothing, if the bytes at PC are not a
+// fusable idiom.
+
+template <class Memory, class Io, class Traits>
+bool CPUImpl<Memory, Io, Traits>::RunFused(uint8_t opcode, uint64_t target_cycle) {
+    const auto next = [this](uint16_t n) { return Peek(static_cast<uint16_t>(_PC + n)); };
+    const auto is_stack_op = [](uint8_t op) { return (op & 0xCB) == 0xC1; };  // PUSH/POP qq
+
+    switch (opcode) {
+    case 0x7A:  // LD A,D / OR E [/ JR Z|NZ,e] — "is DE zero?"
+        if (next(1) != 0xB3) return false;
+        FetchM1();
+        LD_A_D();
+        if (t_cycle >= target_cycle) return true;
+        FetchM1();
+        OR_E();
+        RunFusedJr(target_cycle);
+        return true;
+
+    case 0x78:  // LD A,B / OR C [/ JR Z|NZ,e] — "is BC zero?"
+        if (next(1) != 0xB1) return false;
+        FetchM1();
+        LD_A_B();
+        if (t_cycle >= target_cycle) return true;
+        FetchM1();
+        OR_C();
+        RunFusedJr(target_cycle);
+        return true;
+
+    case 0xB7:  // OR A / SBC HL,DE [/ JR NC|C,e] — 16-bit compare or subtract
+        if (next(1) != 0xED || next(2) != 0x52) return false;
+        FetchM1();
+        OR_A();
+        if (t_cycle >= target_cycle) return true;
+        FetchM1();  // ED
+        t_cycle += 4;
+        if (t_cycle >= target_cycle) {
+            current_state = CPUState::ED_PREFIX;
+            return true;
+        }
+        FetchM1();
+        SBC_HL_DE();
+        if (t_cycle >= target_cycle) return true;
+        if (next(0) == 0x30) {
+            FetchM1();
+            JR_NC();
+        } else if (next(0) == 0x38) {
+            FetchM1();
+            JR_C();
+        }
+        return true;
+
+    case 0x05:  // DEC B / JR NZ,e — a DJNZ written out
+        if (next(1) != 0x20) return false;
+        FetchM1();
+        DEC_B();
+        if (t_cycle >= target_cycle) return true;
+        FetchM1();
+        JR_NZ();
+        return true;
+
+    case 0x7E:  // LD A,(HL) / INC HL — read the next byte of a buffer
+        if (next(1) != 0x23) return false;
+        FetchM1();
+        LD_A_mHL();
+        if (t_cycle >= target_cycle) return true;
+        FetchM1();
+        INC_HL();
+        return true;
+
+    case 0xC1: case 0xC5: case 0xD1: case 0xD5:
+    case 0xE1: case 0xE5: case 0xF1: case 0xF5:
+        // A block of PUSH/POP (register save and restore): runs to its end.
+        if (!is_stack_op(next(1))) return false;
+        for (uint8_t op = opcode;;) {
+            FetchM1();
+            switch (op) {
+            case 0xC1: POP_BC(); break;
+            case 0xC5: PUSH_BC(); break;
+            case 0xD1: POP_DE(); break;
+            case 0xD5: PUSH_DE(); break;
+            case 0xE1: POP_HL(); break;
+            case 0xE5: PUSH_HL(); break;
+            case 0xF1: POP_AF(); break;
+            default:   PUSH_AF(); break;
+            }
+            if (t_cycle >= target_cycle) return true;
+            op = next(0);
+            if (!is_stack_op(op)) return true;
+        }
+
+    default:
+        return false;
+    }
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::Step() {
+/// @brief The optional JR Z|NZ,e that ends a zero test, if there is budget.
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::RunFusedJr(uint64_t target_cycle) {
+    if (t_cycle >= target_cycle) return;
+    const uint8_t op = Peek(_PC);
+    if (op == 0x28) {
+        FetchM1();
+        JR_Z();
+    } else if (op == 0x20) {
+        FetchM1();
+        JR_NZ();
+    }
+}
+
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::Step() {
     // EI defers interrupt acceptance until *after* the following instruction.
     // Capture the flag here; clear it once that following instruction completes.
-    const bool ei_was_pending = ei_defer_;
+    // Without interrupts (Traits::kInterrupts) there is no shadow to keep.
+    const bool ei_was_pending = Traits::kInterrupts && ei_defer_;
 
     // Fetch instruction opcode
     uint8_t opcode = memory[PC()++];
 
+    // Instrumentation: the state this byte was fetched in names the opcode
+    // table, and a DD/FD/ED arriving while DD/FD is pending wastes that prefix.
+    // `executed` is the byte that selects the operation (DDCB/FDCB: the last).
+    [[maybe_unused]] const CPUState entry_state = current_state;
+    [[maybe_unused]] uint8_t executed = opcode;
+    if constexpr (Traits::kInstrumented) {
+        mix_.OnFetch(entry_state == CPUState::NORMAL,
+                     (entry_state == CPUState::DD_PREFIX || entry_state == CPUState::FD_PREFIX) &&
+                         (opcode == 0xDD || opcode == 0xFD || opcode == 0xED),
+                     t_cycle);
+    }
+
     // R (memory-refresh) register: its low 7 bits increment on every M1 opcode
     // fetch; bit 7 is preserved (only LD R,A changes it). Each Step() fetches one
     // opcode/prefix byte = one M1, so increment once per Step — EXCEPT the
@@ -136,8 +308,9 @@ void CPUImpl<Memory, Io>::Step() {
     // DD/FD and CB bytes). R-keyed self-decrypting loaders (e.g. Speedlock, used by
     // Arkanoid) depend on this exact sequence via LD A,R — without it the key is
     // constant and the decrypt produces garbage. See FLOATING_BUS_DESIGN.md notes.
-    if (current_state != CPUState::DD_CB_PREFIX && current_state != CPUState::FD_CB_PREFIX)
-        R() = static_cast<uint8_t>((R() & 0x80u) | ((R() + 1u) & 0x7Fu));
+    if constexpr (Traits::kTrackRefresh) {
+        if (current_state != CPUState::DD_CB_PREFIX && current_state != CPUState::FD_CB_PREFIX) Refresh();
+    }
 
     // Execute based on current CPU state
     switch (current_state) {
@@ -157,7 +330,7 @@ void CPUImpl<Memory, Io>::Step() {
                 t_cycle += 4;
             } else {
                 // Execute normal instruction
-                (this->*basic_opcodes[opcode])();
+                (this->*kInstructionTables.basic[opcode])();
             }
             break;
             
@@ -187,7 +360,7 @@ void CPUImpl<Memory, Io>::Step() {
                 t_cycle += 4;
             } else {
                 // Execute DD-prefixed instruction (IX operations) using state-aware basic instructions
-                (this->*basic_opcodes[opcode])();
+                (this->*kInstructionTables.basic[opcode])();
                 current_state = CPUState::NORMAL;
             }
             break;
@@ -196,7 +369,7 @@ void CPUImpl<Memory, Io>::Step() {
             // Execute ED-prefixed instruction. The ED prefix fetch above charged
             // its 4 T M1; the body adds only the remaining cycles. Block-repeat
             // ops run one iteration per step.
-            (this->*ED_opcodes[opcode])();
+            (this->*kInstructionTables.ed[opcode])();
             current_state = CPUState::NORMAL;
             break;
             
@@ -216,7 +389,7 @@ void CPUImpl<Memory, Io>::Step() {
                 t_cycle += 4;
             } else {
                 // Execute FD-prefixed instruction (IY operations) using state-aware basic instructions
-                (this->*basic_opcodes[opcode])();
+                (this->*kInstructionTables.basic[opcode])();
                 current_state = CPUState::NORMAL;
             }
             break;
@@ -227,6 +400,7 @@ void CPUImpl<Memory, Io>::Step() {
             {
                 current_displacement = static_cast<int8_t>(opcode);  // Store displacement
                 uint8_t cb_opcode = memory[PC()++];  // Read the actual CB instruction
+                executed = cb_opcode;
 
                 // Execute the CB instruction with stored displacement. The DD and
                 // CB prefix fetches above each charged 4 T (two M1s); the body
@@ -243,7 +417,8 @@ void CPUImpl<Memory, Io>::Step() {
             {
                 current_displacement = static_cast<int8_t>(opcode);  // Store displacement
                 uint8_t cb_opcode = memory[PC()++];  // Read the actual CB instruction
-                
+                executed = cb_opcode;
+
                 // Execute the CB instruction with stored displacement. The FD and
                 // CB prefix fetches above each charged 4 T (two M1s); the body
                 // adds only the remaining cycles.
@@ -256,15 +431,22 @@ void CPUImpl<Memory, Io>::Step() {
 
     // If an EI was pending before this instruction (and this instruction was not
     // itself the EI), the one-instruction deferral window has now closed.
-    if (ei_was_pending) ei_defer_ = false;
+    if constexpr (Traits::kInterrupts) {
+        if (ei_was_pending) ei_defer_ = false;
+    }
+
+    if constexpr (Traits::kInstrumented) {
+        if (current_state == CPUState::NORMAL)
+            mix_.OnComplete(static_cast<OpcodeTable>(entry_state), executed, t_cycle);
+    }
 }
 
 // =============================================================================
 // Memory and I/O Access
 // =============================================================================
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LoadProgram(const std::vector<uint8_t>& program, uint16_t start_address) {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LoadProgram(const std::vector<uint8_t>& program, uint16_t start_address) {
     for (size_t i = 0; i < program.size() && (start_address + i) < Constants::MEMORY_SIZE; ++i) {
         memory[start_address + i] = program[i];
     }
@@ -274,8 +456,13 @@ void CPUImpl<Memory, Io>::LoadProgram(const std::vector<uint8_t>& program, uint1
 // Instruction Table Initialization
 // =============================================================================
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::InitializeInstructionTables() {
+template <class Memory, class Io, class Traits>
+constexpr typename CPUImpl<Memory, Io, Traits>::InstructionTables
+CPUImpl<Memory, Io, Traits>::BuildInstructionTables() {
+    InstructionTables tables{};
+    auto& basic_opcodes = tables.basic;
+    auto& ED_opcodes = tables.ed;
+
     // Initialize all tables to NOP
     basic_opcodes.fill(&CPUImpl::NOP);
     ED_opcodes.fill(&CPUImpl::ED_NOP);
@@ -633,14 +820,21 @@ void CPUImpl<Memory, Io>::InitializeInstructionTables() {
     ED_opcodes[0xB9] = &CPUImpl::CPDR;       // ED B9 - CPDR (compare, decrement, repeat)
     ED_opcodes[0xBA] = &CPUImpl::INDR;       // ED BA - INDR (input, decrement, repeat)
     ED_opcodes[0xBB] = &CPUImpl::OTDR;       // ED BB - OTDR (output, decrement, repeat)
+    return tables;
 }
 
+// Constant-initialized (no start-up code, no order-of-initialization
+// hazard) and instantiated with each configuration below.
+template <class Memory, class Io, class Traits>
+constinit const typename CPUImpl<Memory, Io, Traits>::InstructionTables
+    CPUImpl<Memory, Io, Traits>::kInstructionTables = CPUImpl<Memory, Io, Traits>::BuildInstructionTables();
+
 // =============================================================================
 // Helper Functions
 // =============================================================================
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::SetCarryFlag(bool value) {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::SetCarryFlag(bool value) {
     if (value) {
         F() |= Constants::Flags::CARRY;
     } else {
@@ -648,8 +842,8 @@ void CPUImpl<Memory, Io>::SetCarryFlag(bool value) {
     }
 }
 
-template <class Memory, class Io>
-bool CPUImpl<Memory, Io>::GetCarryFlag() const {
+template <class Memory, class Io, class Traits>
+bool CPUImpl<Memory, Io, Traits>::GetCarryFlag() const {
     return (_AF.r8.lo & Constants::Flags::CARRY) != 0;
 }
 
@@ -657,56 +851,56 @@ bool CPUImpl<Memory, Io>::GetCarryFlag() const {
 // Basic Instructions (0x00-0x3F)
 // =============================================================================
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::NOP() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::NOP() {
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_BC_nn() {
-    WZ() = memory[PC()] | (memory[PC()+1] << 8);
-    BC() = WZ();
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_BC_nn() {
+    BC() = memory[PC()] | (memory[PC()+1] << 8);
+    SetMemptr(BC());
     PC() += 2;
     t_cycle += 10;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_mBC_A() {
-    WZ() = BC();
-    memory[WZ()] = A();
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_mBC_A() {
+    SetMemptr(BC());
+    memory[BC()] = A();
     t_cycle += 7;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::INC_BC() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::INC_BC() {
     BC()++;
     t_cycle += 6;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::INC_B() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::INC_B() {
     uint8_t old_b = B();
     B()++;
     SetFlags_INC(B(), old_b);
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::DEC_B() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::DEC_B() {
     uint8_t old_b = B();
     B()--;
     SetFlags_DEC(B(), old_b);
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_B_n() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_B_n() {
     B() = memory[PC()++];
     t_cycle += 7;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::RLCA() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::RLCA() {
     uint8_t old_bit7 = (A() & 0x80) ? 1 : 0;
     A() = (A() << 1) | old_bit7;
     F() = (F() & (Constants::Flags::SIGN | Constants::Flags::ZERO | Constants::Flags::PARITY)) |
@@ -714,16 +908,16 @@ void CPUImpl<Memory, Io>::RLCA() {
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::EX_AF_AF() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::EX_AF_AF() {
     uint16_t temp = AF();
     AF() = _AF1.r16;
     _AF1.r16 = temp;
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::ADD_HL_BC() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::ADD_HL_BC() {
     uint16_t& hl_reg = GetEffectiveHL_Register();
     const uint16_t old_hl = hl_reg;
     const uint16_t operand = BC();
@@ -735,43 +929,43 @@ void CPUImpl<Memory, Io>::ADD_HL_BC() {
     t_cycle += 11;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_A_mBC() {
-    WZ() = BC();
-    A() = memory[WZ()];
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_A_mBC() {
+    SetMemptr(BC());
+    A() = memory[BC()];
     t_cycle += 7;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::DEC_BC() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::DEC_BC() {
     BC()--;
     t_cycle += 6;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::INC_C() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::INC_C() {
     uint8_t old_c = C();
     C()++;
     SetFlags_INC(C(), old_c);
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::DEC_C() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::DEC_C() {
     uint8_t old_c = C();
     C()--;
     SetFlags_DEC(C(), old_c);
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_C_n() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_C_n() {
     C() = memory[PC()++];
     t_cycle += 7;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::RRCA() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::RRCA() {
     uint8_t old_bit0 = A() & 0x01;
     A() = (A() >> 1) | (old_bit0 << 7);
     F() = (F() & (Constants::Flags::SIGN | Constants::Flags::ZERO | Constants::Flags::PARITY)) |
@@ -779,64 +973,64 @@ void CPUImpl<Memory, Io>::RRCA() {
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::DJNZ() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::DJNZ() {
     int8_t displacement = memory[PC()++];
     B()--;
     if (B() != 0) {
-        WZ() = PC() + displacement;
-        PC() = WZ();
+        PC() += displacement;
+        SetMemptr(PC());
         t_cycle += 13;
     } else {
         t_cycle += 8;
     }
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_DE_nn() {
-    WZ() = memory[PC()] | (memory[PC()+1] << 8);
-    DE() = WZ();
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_DE_nn() {
+    DE() = memory[PC()] | (memory[PC()+1] << 8);
+    SetMemptr(DE());
     PC() += 2;
     t_cycle += 10;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_mDE_A() {
-    WZ() = DE();
-    memory[WZ()] = A();
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_mDE_A() {
+    SetMemptr(DE());
+    memory[DE()] = A();
     t_cycle += 7;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::INC_DE() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::INC_DE() {
     DE()++;
     t_cycle += 6;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::INC_D() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::INC_D() {
     uint8_t old_d = D();
     D()++;
     SetFlags_INC(D(), old_d);
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::DEC_D() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::DEC_D() {
     uint8_t old_d = D();
     D()--;
     SetFlags_DEC(D(), old_d);
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_D_n() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_D_n() {
     D() = memory[PC()++];
     t_cycle += 7;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::RLA() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::RLA() {
     uint8_t old_carry = F() & 0x01;
     uint8_t new_carry = (A() & 0x80) ? 1 : 0;
     A() = (A() << 1) | old_carry;
@@ -845,16 +1039,16 @@ void CPUImpl<Memory, Io>::RLA() {
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::JR() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::JR() {
     int8_t displacement = memory[PC()++];
-    WZ() = PC() + displacement;
-    PC() = WZ();
+    PC() += displacement;
+    SetMemptr(PC());
     t_cycle += 12;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::ADD_HL_DE() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::ADD_HL_DE() {
     uint16_t& hl_reg = GetEffectiveHL_Register();
     const uint16_t old_hl = hl_reg;
     const uint16_t operand = DE();
@@ -866,43 +1060,43 @@ void CPUImpl<Memory, Io>::ADD_HL_DE() {
     t_cycle += 11;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_A_mDE() {
-    WZ() = DE();
-    A() = memory[WZ()];
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_A_mDE() {
+    SetMemptr(DE());
+    A() = memory[DE()];
     t_cycle += 7;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::DEC_DE() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::DEC_DE() {
     DE()--;
     t_cycle += 6;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::INC_E() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::INC_E() {
     uint8_t old_e = E();
     E()++;
     SetFlags_INC(E(), old_e);
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::DEC_E() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::DEC_E() {
     uint8_t old_e = E();
     E()--;
     SetFlags_DEC(E(), old_e);
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_E_n() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_E_n() {
     E() = memory[PC()++];
     t_cycle += 7;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::RRA() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::RRA() {
     uint8_t old_carry = F() & 0x01;
     uint8_t new_carry = A() & 0x01;
     A() = (A() >> 1) | (old_carry << 7);
@@ -911,44 +1105,46 @@ void CPUImpl<Memory, Io>::RRA() {
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::JR_NZ() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::JR_NZ() {
     int8_t displacement = memory[PC()++];
     if (!(F() & 0x40)) { // Zero flag not set
-        WZ() = PC() + displacement;
-        PC() = WZ();
+        PC() += displacement;
+        SetMemptr(PC());
         t_cycle += 12;
     } else {
         t_cycle += 7;
     }
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_HL_nn() {
-    WZ() = memory[PC()] | (memory[PC()+1] << 8);
-    GetEffectiveHL_Register() = WZ();
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_HL_nn() {
+    uint16_t& hl_reg = GetEffectiveHL_Register();
+    hl_reg = memory[PC()] | (memory[PC()+1] << 8);
+    SetMemptr(hl_reg);
     PC() += 2;
     t_cycle += 10; // Base instruction timing - prefix adds its own 4 cycles
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_mnn_HL() {
-    WZ() = memory[PC()] | (memory[PC()+1] << 8);
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_mnn_HL() {
+    const uint16_t address = static_cast<uint16_t>(memory[PC()] | (memory[PC()+1] << 8));
+    SetMemptr(address);
     PC() += 2;
     uint16_t& hl_reg = GetEffectiveHL_Register();
-    memory[WZ()] = hl_reg & 0xFF;        // Low byte
-    memory[WZ() + 1] = (hl_reg >> 8);    // High byte
+    memory[address] = hl_reg & 0xFF;        // Low byte
+    memory[address + 1] = (hl_reg >> 8);    // High byte
     t_cycle += 16;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::INC_HL() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::INC_HL() {
     GetEffectiveHL_Register()++;
     t_cycle += GetRegisterOpCycles();
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::INC_H() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::INC_H() {
     uint8_t& h_reg = GetEffectiveH();
     uint8_t old_h = h_reg;
     h_reg++;
@@ -956,8 +1152,8 @@ void CPUImpl<Memory, Io>::INC_H() {
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::DEC_H() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::DEC_H() {
     uint8_t& h_reg = GetEffectiveH();
     uint8_t old_h = h_reg;
     h_reg--;
@@ -965,14 +1161,14 @@ void CPUImpl<Memory, Io>::DEC_H() {
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_H_n() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_H_n() {
     GetEffectiveH() = memory[PC()++];
     t_cycle += 7;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::DAA() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::DAA() {
     // Decimal-adjust A after a BCD add/sub. The correction gates are evaluated
     // from the incoming A/H/C even for otherwise-invalid flag combinations; the
     // N flag only chooses whether that correction is added or subtracted.
@@ -1005,20 +1201,20 @@ void CPUImpl<Memory, Io>::DAA() {
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::JR_Z() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::JR_Z() {
     int8_t displacement = memory[PC()++];
     if (F() & 0x40) { // Zero flag set
-        WZ() = PC() + displacement;
-        PC() = WZ();
+        PC() += displacement;
+        SetMemptr(PC());
         t_cycle += 12;
     } else {
         t_cycle += 7;
     }
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::ADD_HL_HL() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::ADD_HL_HL() {
     uint16_t& hl_reg = GetEffectiveHL_Register();
     const uint16_t old_hl = hl_reg;
     hl_reg = static_cast<uint16_t>(old_hl + old_hl);
@@ -1029,23 +1225,24 @@ void CPUImpl<Memory, Io>::ADD_HL_HL() {
     t_cycle += 11;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_HL_mnn() {
-    WZ() = memory[PC()] | (memory[PC()+1] << 8);
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_HL_mnn() {
+    const uint16_t address = static_cast<uint16_t>(memory[PC()] | (memory[PC()+1] << 8));
+    SetMemptr(address);
     PC() += 2;
     uint16_t& hl_reg = GetEffectiveHL_Register();
-    hl_reg = memory[WZ()] | (memory[WZ() + 1] << 8);
+    hl_reg = memory[address] | (memory[address + 1] << 8);
     t_cycle += 16;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::DEC_HL() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::DEC_HL() {
     GetEffectiveHL_Register()--;
     t_cycle += GetRegisterOpCycles();
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::INC_L() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::INC_L() {
     uint8_t& l_reg = GetEffectiveL();
     uint8_t old_l = l_reg;
     l_reg++;
@@ -1053,8 +1250,8 @@ void CPUImpl<Memory, Io>::INC_L() {
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::DEC_L() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::DEC_L() {
     uint8_t& l_reg = GetEffectiveL();
     uint8_t old_l = l_reg;
     l_reg--;
@@ -1062,14 +1259,14 @@ void CPUImpl<Memory, Io>::DEC_L() {
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_L_n() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_L_n() {
     GetEffectiveL() = memory[PC()++];
     t_cycle += 7;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::CPL() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::CPL() {
     A() = ~A();
     F() = (F() & (Constants::Flags::SIGN | Constants::Flags::ZERO |
                   Constants::Flags::PARITY | Constants::Flags::CARRY)) |
@@ -1078,42 +1275,43 @@ void CPUImpl<Memory, Io>::CPL() {
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::JR_NC() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::JR_NC() {
     int8_t displacement = memory[PC()++];
     if (!(F() & 0x01)) { // Carry flag not set
-        WZ() = PC() + displacement;
-        PC() = WZ();
+        PC() += displacement;
+        SetMemptr(PC());
         t_cycle += 12;
     } else {
         t_cycle += 7;
     }
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_SP_nn() {
-    WZ() = memory[PC()] | (memory[PC()+1] << 8);
-    SP() = WZ();
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_SP_nn() {
+    SP() = memory[PC()] | (memory[PC()+1] << 8);
+    SetMemptr(SP());
     PC() += 2;
     t_cycle += 10;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_mnn_A() {
-    WZ() = memory[PC()] | (memory[PC()+1] << 8);
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_mnn_A() {
+    const uint16_t address = static_cast<uint16_t>(memory[PC()] | (memory[PC()+1] << 8));
+    SetMemptr(address);
     PC() += 2;
-    memory[WZ()] = A();
+    memory[address] = A();
     t_cycle += 13;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::INC_SP() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::INC_SP() {
     SP()++;
     t_cycle += 6;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::INC_mHL() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::INC_mHL() {
     uint16_t address = GetEffectiveHL_Memory();
     uint8_t value = memory[address];
     uint8_t old_value = value;
@@ -1124,8 +1322,8 @@ void CPUImpl<Memory, Io>::INC_mHL() {
     t_cycle += (current_state == CPUState::NORMAL) ? 11 : 19;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::DEC_mHL() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::DEC_mHL() {
     uint16_t address = GetEffectiveHL_Memory();
     uint8_t value = memory[address];
     uint8_t old_value = value;
@@ -1136,16 +1334,16 @@ void CPUImpl<Memory, Io>::DEC_mHL() {
     t_cycle += (current_state == CPUState::NORMAL) ? 11 : 19;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_mHL_n() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_mHL_n() {
     uint16_t address = GetEffectiveHL_Memory();
     memory[address] = memory[PC()++];
     // LD (HL),n=10 T; LD (IX/IY+d),n=19 T (body 15 + DD/FD prefix M1 charged above).
     t_cycle += (current_state == CPUState::NORMAL) ? 10 : 15;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::SCF() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::SCF() {
     F() = (F() & (Constants::Flags::SIGN | Constants::Flags::ZERO |
                   Constants::Flags::PARITY)) |
           (A() & (Constants::Flags::X | Constants::Flags::Y)) |
@@ -1153,20 +1351,20 @@ void CPUImpl<Memory, Io>::SCF() {
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::JR_C() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::JR_C() {
     int8_t displacement = memory[PC()++];
     if (F() & 0x01) { // Carry flag set
-        WZ() = PC() + displacement;
-        PC() = WZ();
+        PC() += displacement;
+        SetMemptr(PC());
         t_cycle += 12;
     } else {
         t_cycle += 7;
     }
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::ADD_HL_SP() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::ADD_HL_SP() {
     uint16_t& hl_reg = GetEffectiveHL_Register();
     const uint16_t old_hl = hl_reg;
     const uint16_t operand = SP();
@@ -1178,44 +1376,45 @@ void CPUImpl<Memory, Io>::ADD_HL_SP() {
     t_cycle += 11;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_A_mnn() {
-    WZ() = memory[PC()] | (memory[PC()+1] << 8);
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_A_mnn() {
+    const uint16_t address = static_cast<uint16_t>(memory[PC()] | (memory[PC()+1] << 8));
+    SetMemptr(address);
     PC() += 2;
-    A() = memory[WZ()];
+    A() = memory[address];
     t_cycle += 13;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::DEC_SP() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::DEC_SP() {
     SP()--;
     t_cycle += 6;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::INC_A() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::INC_A() {
     uint8_t old_a = A();
     A()++;
     SetFlags_INC(A(), old_a);
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::DEC_A() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::DEC_A() {
     uint8_t old_a = A();
     A()--;
     SetFlags_DEC(A(), old_a);
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_A_n() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_A_n() {
     A() = memory[PC()++];
     t_cycle += 7;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::CCF() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::CCF() {
     const bool old_carry = F() & Constants::Flags::CARRY;
     F() = (F() & (Constants::Flags::SIGN | Constants::Flags::ZERO |
                   Constants::Flags::PARITY)) |
@@ -1228,51 +1427,51 @@ void CPUImpl<Memory, Io>::CCF() {
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_B_B() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_B_B() {
     // B = B (NOP equivalent)
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_B_C() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_B_C() {
     B() = C();
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_B_D() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_B_D() {
     B() = D();
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_B_E() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_B_E() {
     B() = E();
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_B_H() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_B_H() {
     B() = GetEffectiveH();
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_B_L() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_B_L() {
     B() = GetEffectiveL();
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_B_mHL() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_B_mHL() {
     uint16_t address = GetEffectiveHL_Memory();
     B() = memory[address];
     t_cycle += GetMemoryAccessCycles();
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_B_A() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_B_A() {
     B() = A();
     t_cycle += 4;
 }
@@ -1281,352 +1480,352 @@ void CPUImpl<Memory, Io>::LD_B_A() {
 // Load Instructions (0x48-0x7F) - Remaining register-to-register transfers
 // =============================================================================
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_C_B() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_C_B() {
     C() = B();
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_C_C() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_C_C() {
     // C = C (NOP equivalent)
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_C_D() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_C_D() {
     C() = D();
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_C_E() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_C_E() {
     C() = E();
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_C_H() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_C_H() {
     C() = GetEffectiveH();
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_C_L() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_C_L() {
     C() = GetEffectiveL();
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_C_mHL() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_C_mHL() {
     uint16_t address = GetEffectiveHL_Memory();
     C() = memory[address];
     t_cycle += GetMemoryAccessCycles();
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_C_A() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_C_A() {
     C() = A();
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_D_B() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_D_B() {
     D() = B();
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_D_C() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_D_C() {
     D() = C();
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_D_D() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_D_D() {
     // D = D (NOP equivalent)
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_D_E() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_D_E() {
     D() = E();
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_D_H() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_D_H() {
     D() = GetEffectiveH();
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_D_L() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_D_L() {
     D() = GetEffectiveL();
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_D_mHL() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_D_mHL() {
     uint16_t address = GetEffectiveHL_Memory();
     D() = memory[address];
     t_cycle += GetMemoryAccessCycles();
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_D_A() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_D_A() {
     D() = A();
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_E_B() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_E_B() {
     E() = B();
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_E_C() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_E_C() {
     E() = C();
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_E_D() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_E_D() {
     E() = D();
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_E_E() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_E_E() {
     // E = E (NOP equivalent)
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_E_H() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_E_H() {
     E() = GetEffectiveH();
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_E_L() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_E_L() {
     E() = GetEffectiveL();
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_E_mHL() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_E_mHL() {
     uint16_t address = GetEffectiveHL_Memory();
     E() = memory[address];
     t_cycle += GetMemoryAccessCycles();
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_E_A() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_E_A() {
     E() = A();
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_H_B() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_H_B() {
     GetEffectiveH() = B();
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_H_C() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_H_C() {
     GetEffectiveH() = C();
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_H_D() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_H_D() {
     GetEffectiveH() = D();
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_H_E() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_H_E() {
     GetEffectiveH() = E();
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_H_H() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_H_H() {
     // H = H (NOP equivalent)
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_H_L() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_H_L() {
     GetEffectiveH() = GetEffectiveL();
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_H_mHL() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_H_mHL() {
     uint16_t address = GetEffectiveHL_Memory();
     H() = memory[address];
     t_cycle += GetMemoryAccessCycles();
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_H_A() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_H_A() {
     GetEffectiveH() = A();
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_L_B() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_L_B() {
     GetEffectiveL() = B();
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_L_C() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_L_C() {
     GetEffectiveL() = C();
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_L_D() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_L_D() {
     GetEffectiveL() = D();
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_L_E() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_L_E() {
     GetEffectiveL() = E();
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_L_H() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_L_H() {
     GetEffectiveL() = GetEffectiveH();
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_L_L() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_L_L() {
     // L = L (NOP equivalent)
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_L_mHL() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_L_mHL() {
     uint16_t address = GetEffectiveHL_Memory();
     L() = memory[address];
     t_cycle += GetMemoryAccessCycles();
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_L_A() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_L_A() {
     GetEffectiveL() = A();
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_mHL_B() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_mHL_B() {
     uint16_t address = GetEffectiveHL_Memory();
     memory[address] = B();
     t_cycle += GetMemoryAccessCycles();
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_mHL_C() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_mHL_C() {
     uint16_t address = GetEffectiveHL_Memory();
     memory[address] = C();
     t_cycle += GetMemoryAccessCycles();
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_mHL_D() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_mHL_D() {
     uint16_t address = GetEffectiveHL_Memory();
     memory[address] = D();
     t_cycle += GetMemoryAccessCycles();
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_mHL_E() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_mHL_E() {
     uint16_t address = GetEffectiveHL_Memory();
     memory[address] = E();
     t_cycle += GetMemoryAccessCycles();
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_mHL_H() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_mHL_H() {
     uint16_t address = GetEffectiveHL_Memory();
     memory[address] = H();
     t_cycle += GetMemoryAccessCycles();
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_mHL_L() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_mHL_L() {
     uint16_t address = GetEffectiveHL_Memory();
     memory[address] = L();
     t_cycle += GetMemoryAccessCycles();
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::HALT() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::HALT() {
     // HALT instruction - processor stops until interrupt
     _halted = true;
     t_cycle += 4;  // HALT instruction takes 4 cycles
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_mHL_A() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_mHL_A() {
     uint16_t address = GetEffectiveHL_Memory();
     memory[address] = A();
     t_cycle += GetMemoryAccessCycles();
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_A_B() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_A_B() {
     A() = B();
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_A_C() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_A_C() {
     A() = C();
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_A_D() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_A_D() {
     A() = D();
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_A_E() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_A_E() {
     A() = E();
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_A_H() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_A_H() {
     A() = GetEffectiveH();
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_A_L() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_A_L() {
     A() = GetEffectiveL();
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_A_mHL() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_A_mHL() {
     uint16_t address = GetEffectiveHL_Memory();
     A() = memory[address];
     t_cycle += GetMemoryAccessCycles();
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_A_A() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_A_A() {
     // A = A (NOP equivalent)
     t_cycle += 4;
 }
@@ -1635,28 +1834,28 @@ void CPUImpl<Memory, Io>::LD_A_A() {
 // Flag Helper Functions
 // =============================================================================
 
-template <class Memory, class Io>
-uint8_t CPUImpl<Memory, Io>::Flags_SZXY(uint8_t value) const {
+template <class Memory, class Io, class Traits>
+uint8_t CPUImpl<Memory, Io, Traits>::Flags_SZXY(uint8_t value) const {
     uint8_t flags = value & (Constants::Flags::SIGN | Constants::Flags::X | Constants::Flags::Y);
     if (value == 0) flags |= Constants::Flags::ZERO;
     return flags;
 }
 
-template <class Memory, class Io>
-uint8_t CPUImpl<Memory, Io>::Flags_SZXY16(uint16_t value) const {
+template <class Memory, class Io, class Traits>
+uint8_t CPUImpl<Memory, Io, Traits>::Flags_SZXY16(uint16_t value) const {
     uint8_t flags = static_cast<uint8_t>((value >> 8) &
                                          (Constants::Flags::SIGN | Constants::Flags::X | Constants::Flags::Y));
     if (value == 0) flags |= Constants::Flags::ZERO;
     return flags;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::SetFlags_ADD(uint8_t result, uint8_t operand1, uint8_t operand2) {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::SetFlags_ADD(uint8_t result, uint8_t operand1, uint8_t operand2) {
     SetFlags_ADC(result, operand1, operand2, 0);
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::SetFlags_ADC(uint8_t result, uint8_t operand1, uint8_t operand2, uint8_t carry) {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::SetFlags_ADC(uint8_t result, uint8_t operand1, uint8_t operand2, uint8_t carry) {
     const uint16_t full = static_cast<uint16_t>(operand1) + operand2 + carry;
     F() = Flags_SZXY(result);
     if (((operand1 ^ operand2 ^ result) & 0x10) != 0) F() |= Constants::Flags::HALF;
@@ -1664,13 +1863,13 @@ void CPUImpl<Memory, Io>::SetFlags_ADC(uint8_t result, uint8_t operand1, uint8_t
     if (full & 0x100) F() |= Constants::Flags::CARRY;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::SetFlags_SUB(uint8_t result, uint8_t operand1, uint8_t operand2) {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::SetFlags_SUB(uint8_t result, uint8_t operand1, uint8_t operand2) {
     SetFlags_SBC(result, operand1, operand2, 0);
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::SetFlags_SBC(uint8_t result, uint8_t operand1, uint8_t operand2, uint8_t carry) {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::SetFlags_SBC(uint8_t result, uint8_t operand1, uint8_t operand2, uint8_t carry) {
     const uint16_t subtrahend = static_cast<uint16_t>(operand2) + carry;
     F() = Flags_SZXY(result) | Constants::Flags::SUBTRACT;
     if (((operand1 ^ operand2 ^ result) & 0x10) != 0) F() |= Constants::Flags::HALF;
@@ -1678,36 +1877,36 @@ void CPUImpl<Memory, Io>::SetFlags_SBC(uint8_t result, uint8_t operand1, uint8_t
     if (static_cast<uint16_t>(operand1) < subtrahend) F() |= Constants::Flags::CARRY;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::SetFlags_CP(uint8_t result, uint8_t operand1, uint8_t operand2) {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::SetFlags_CP(uint8_t result, uint8_t operand1, uint8_t operand2) {
     SetFlags_SUB(result, operand1, operand2);
     F() = (F() & ~(Constants::Flags::X | Constants::Flags::Y)) |
           (operand2 & (Constants::Flags::X | Constants::Flags::Y));
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::SetFlags_LOGIC(uint8_t result, bool half_carry) {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::SetFlags_LOGIC(uint8_t result, bool half_carry) {
     F() = Flags_SZXY(result);
     if (half_carry) F() |= Constants::Flags::HALF;
     F() |= CalculateParity(result);
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::SetFlags_INC(uint8_t result, uint8_t old_value) {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::SetFlags_INC(uint8_t result, uint8_t old_value) {
     F() = (F() & Constants::Flags::CARRY) | Flags_SZXY(result);
     if ((old_value & 0x0F) == 0x0F) F() |= Constants::Flags::HALF;
     if (old_value == 0x7F) F() |= Constants::Flags::PARITY;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::SetFlags_DEC(uint8_t result, uint8_t old_value) {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::SetFlags_DEC(uint8_t result, uint8_t old_value) {
     F() = (F() & Constants::Flags::CARRY) | Flags_SZXY(result) | Constants::Flags::SUBTRACT;
     if ((old_value & 0x0F) == 0) F() |= Constants::Flags::HALF;
     if (old_value == 0x80) F() |= Constants::Flags::PARITY;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::SetFlags_ADD16(uint16_t result, uint16_t operand1, uint16_t operand2) {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::SetFlags_ADD16(uint16_t result, uint16_t operand1, uint16_t operand2) {
     const uint32_t full = static_cast<uint32_t>(operand1) + operand2;
     F() = (F() & (Constants::Flags::SIGN | Constants::Flags::ZERO | Constants::Flags::PARITY)) |
           (static_cast<uint8_t>(result >> 8) & (Constants::Flags::X | Constants::Flags::Y));
@@ -1715,8 +1914,8 @@ void CPUImpl<Memory, Io>::SetFlags_ADD16(uint16_t result, uint16_t operand1, uin
     if (full & 0x10000) F() |= Constants::Flags::CARRY;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::SetFlags_ADC16(uint16_t result, uint16_t operand1, uint16_t operand2, uint8_t carry) {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::SetFlags_ADC16(uint16_t result, uint16_t operand1, uint16_t operand2, uint8_t carry) {
     const uint32_t full = static_cast<uint32_t>(operand1) + operand2 + carry;
     F() = Flags_SZXY16(result);
     if (((operand1 ^ operand2 ^ result) & 0x1000) != 0) F() |= Constants::Flags::HALF;
@@ -1724,8 +1923,8 @@ void CPUImpl<Memory, Io>::SetFlags_ADC16(uint16_t result, uint16_t operand1, uin
     if (full & 0x10000) F() |= Constants::Flags::CARRY;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::SetFlags_SBC16(uint16_t result, uint16_t operand1, uint16_t operand2, uint8_t carry) {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::SetFlags_SBC16(uint16_t result, uint16_t operand1, uint16_t operand2, uint8_t carry) {
     const uint32_t subtrahend = static_cast<uint32_t>(operand2) + carry;
     F() = Flags_SZXY16(result) | Constants::Flags::SUBTRACT;
     if (((operand1 ^ operand2 ^ result) & 0x1000) != 0) F() |= Constants::Flags::HALF;
@@ -1733,8 +1932,8 @@ void CPUImpl<Memory, Io>::SetFlags_SBC16(uint16_t result, uint16_t operand1, uin
     if (static_cast<uint32_t>(operand1) < subtrahend) F() |= Constants::Flags::CARRY;
 }
 
-template <class Memory, class Io>
-uint8_t CPUImpl<Memory, Io>::CalculateParity(uint8_t value) {
+template <class Memory, class Io, class Traits>
+uint8_t CPUImpl<Memory, Io, Traits>::CalculateParity(uint8_t value) {
     uint8_t parity = 0;
     for (int i = 0; i < 8; ++i) {
         if (value & (1 << i)) parity++;
@@ -1746,40 +1945,40 @@ uint8_t CPUImpl<Memory, Io>::CalculateParity(uint8_t value) {
 // Arithmetic and Logic Instructions (0x80-0xBF)
 // =============================================================================
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::ADD_A_B() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::ADD_A_B() {
     uint8_t old_a = A();
     A() += B();
     SetFlags_ADD(A(), old_a, B());
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::ADD_A_C() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::ADD_A_C() {
     uint8_t old_a = A();
     A() += C();
     SetFlags_ADD(A(), old_a, C());
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::ADD_A_D() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::ADD_A_D() {
     uint8_t old_a = A();
     A() += D();
     SetFlags_ADD(A(), old_a, D());
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::ADD_A_E() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::ADD_A_E() {
     uint8_t old_a = A();
     A() += E();
     SetFlags_ADD(A(), old_a, E());
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::ADD_A_H() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::ADD_A_H() {
     uint8_t old_a = A();
     uint8_t h_val = GetEffectiveH();
     A() += h_val;
@@ -1787,8 +1986,8 @@ void CPUImpl<Memory, Io>::ADD_A_H() {
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::ADD_A_L() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::ADD_A_L() {
     uint8_t old_a = A();
     uint8_t l_val = GetEffectiveL();
     A() += l_val;
@@ -1796,8 +1995,8 @@ void CPUImpl<Memory, Io>::ADD_A_L() {
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::ADD_A_mHL() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::ADD_A_mHL() {
     uint8_t old_a = A();
     uint16_t address = GetEffectiveHL_Memory();
     uint8_t value = memory[address];
@@ -1806,16 +2005,16 @@ void CPUImpl<Memory, Io>::ADD_A_mHL() {
     t_cycle += GetMemoryAccessCycles();
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::ADD_A_A() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::ADD_A_A() {
     uint8_t old_a = A();
     A() += A();
     SetFlags_ADD(A(), old_a, old_a);
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::ADC_A_B() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::ADC_A_B() {
     uint8_t old_a = A();
     uint8_t carry = (F() & Constants::Flags::CARRY) ? 1 : 0;
     uint16_t result = static_cast<uint16_t>(A()) + static_cast<uint16_t>(B()) + carry;
@@ -1825,8 +2024,8 @@ void CPUImpl<Memory, Io>::ADC_A_B() {
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::ADC_A_C() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::ADC_A_C() {
     uint8_t old_a = A();
     uint8_t carry = (F() & Constants::Flags::CARRY) ? 1 : 0;
     uint16_t result = static_cast<uint16_t>(A()) + static_cast<uint16_t>(C()) + carry;
@@ -1836,8 +2035,8 @@ void CPUImpl<Memory, Io>::ADC_A_C() {
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::ADC_A_D() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::ADC_A_D() {
     uint8_t old_a = A();
     uint8_t carry = (F() & Constants::Flags::CARRY) ? 1 : 0;
     uint16_t result = static_cast<uint16_t>(A()) + static_cast<uint16_t>(D()) + carry;
@@ -1847,8 +2046,8 @@ void CPUImpl<Memory, Io>::ADC_A_D() {
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::ADC_A_E() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::ADC_A_E() {
     uint8_t old_a = A();
     uint8_t carry = (F() & Constants::Flags::CARRY) ? 1 : 0;
     uint16_t result = static_cast<uint16_t>(A()) + static_cast<uint16_t>(E()) + carry;
@@ -1858,8 +2057,8 @@ void CPUImpl<Memory, Io>::ADC_A_E() {
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::ADC_A_H() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::ADC_A_H() {
     uint8_t old_a = A();
     uint8_t carry = (F() & Constants::Flags::CARRY) ? 1 : 0;
     uint8_t h_val = GetEffectiveH();
@@ -1870,8 +2069,8 @@ void CPUImpl<Memory, Io>::ADC_A_H() {
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::ADC_A_L() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::ADC_A_L() {
     uint8_t old_a = A();
     uint8_t carry = (F() & Constants::Flags::CARRY) ? 1 : 0;
     uint8_t l_val = GetEffectiveL();
@@ -1882,8 +2081,8 @@ void CPUImpl<Memory, Io>::ADC_A_L() {
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::ADC_A_mHL() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::ADC_A_mHL() {
     uint8_t old_a = A();
     uint16_t address = GetEffectiveHL_Memory();
     uint8_t value = memory[address];
@@ -1895,8 +2094,8 @@ void CPUImpl<Memory, Io>::ADC_A_mHL() {
     t_cycle += GetMemoryAccessCycles();
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::ADC_A_A() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::ADC_A_A() {
     uint8_t old_a = A();
     uint8_t carry = (F() & Constants::Flags::CARRY) ? 1 : 0;
     uint16_t result = static_cast<uint16_t>(A()) + static_cast<uint16_t>(A()) + carry;
@@ -1906,40 +2105,40 @@ void CPUImpl<Memory, Io>::ADC_A_A() {
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::SUB_B() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::SUB_B() {
     uint8_t old_a = A();
     A() -= B();
     SetFlags_SUB(A(), old_a, B());
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::SUB_C() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::SUB_C() {
     uint8_t old_a = A();
     A() -= C();
     SetFlags_SUB(A(), old_a, C());
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::SUB_D() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::SUB_D() {
     uint8_t old_a = A();
     A() -= D();
     SetFlags_SUB(A(), old_a, D());
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::SUB_E() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::SUB_E() {
     uint8_t old_a = A();
     A() -= E();
     SetFlags_SUB(A(), old_a, E());
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::SUB_H() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::SUB_H() {
     uint8_t old_a = A();
     uint8_t h_val = GetEffectiveH();
     A() -= h_val;
@@ -1947,8 +2146,8 @@ void CPUImpl<Memory, Io>::SUB_H() {
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::SUB_L() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::SUB_L() {
     uint8_t old_a = A();
     uint8_t l_val = GetEffectiveL();
     A() -= l_val;
@@ -1956,8 +2155,8 @@ void CPUImpl<Memory, Io>::SUB_L() {
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::SUB_mHL() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::SUB_mHL() {
     uint8_t old_a = A();
     uint16_t address = GetEffectiveHL_Memory();
     uint8_t value = memory[address];
@@ -1966,16 +2165,16 @@ void CPUImpl<Memory, Io>::SUB_mHL() {
     t_cycle += GetMemoryAccessCycles();
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::SUB_A() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::SUB_A() {
     uint8_t old_a = A();
     A() -= A(); // Result is always 0
     SetFlags_SUB(A(), old_a, old_a);
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::SBC_A_B() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::SBC_A_B() {
     uint8_t old_a = A();
     uint8_t carry = (F() & Constants::Flags::CARRY) ? 1 : 0;
     int16_t result = static_cast<int16_t>(A()) - static_cast<int16_t>(B()) - carry;
@@ -1985,8 +2184,8 @@ void CPUImpl<Memory, Io>::SBC_A_B() {
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::SBC_A_C() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::SBC_A_C() {
     uint8_t old_a = A();
     uint8_t carry = (F() & Constants::Flags::CARRY) ? 1 : 0;
     int16_t result = static_cast<int16_t>(A()) - static_cast<int16_t>(C()) - carry;
@@ -1996,8 +2195,8 @@ void CPUImpl<Memory, Io>::SBC_A_C() {
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::SBC_A_D() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::SBC_A_D() {
     uint8_t old_a = A();
     uint8_t carry = (F() & Constants::Flags::CARRY) ? 1 : 0;
     int16_t result = static_cast<int16_t>(A()) - static_cast<int16_t>(D()) - carry;
@@ -2007,8 +2206,8 @@ void CPUImpl<Memory, Io>::SBC_A_D() {
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::SBC_A_E() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::SBC_A_E() {
     uint8_t old_a = A();
     uint8_t carry = (F() & Constants::Flags::CARRY) ? 1 : 0;
     int16_t result = static_cast<int16_t>(A()) - static_cast<int16_t>(E()) - carry;
@@ -2018,8 +2217,8 @@ void CPUImpl<Memory, Io>::SBC_A_E() {
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::SBC_A_H() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::SBC_A_H() {
     uint8_t old_a = A();
     uint8_t carry = (F() & Constants::Flags::CARRY) ? 1 : 0;
     uint8_t h_val = GetEffectiveH();
@@ -2030,8 +2229,8 @@ void CPUImpl<Memory, Io>::SBC_A_H() {
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::SBC_A_L() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::SBC_A_L() {
     uint8_t old_a = A();
     uint8_t carry = (F() & Constants::Flags::CARRY) ? 1 : 0;
     uint8_t l_val = GetEffectiveL();
@@ -2042,8 +2241,8 @@ void CPUImpl<Memory, Io>::SBC_A_L() {
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::SBC_A_mHL() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::SBC_A_mHL() {
     uint8_t old_a = A();
     uint16_t address = GetEffectiveHL_Memory();
     uint8_t value = memory[address];
@@ -2055,8 +2254,8 @@ void CPUImpl<Memory, Io>::SBC_A_mHL() {
     t_cycle += GetMemoryAccessCycles();
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::SBC_A_A() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::SBC_A_A() {
     uint8_t old_a = A();
     uint8_t carry = (F() & Constants::Flags::CARRY) ? 1 : 0;
     int16_t result = static_cast<int16_t>(A()) - static_cast<int16_t>(A()) - carry;
@@ -2066,223 +2265,223 @@ void CPUImpl<Memory, Io>::SBC_A_A() {
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::AND_B() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::AND_B() {
     A() &= B();
     SetFlags_LOGIC(A(), true);
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::AND_C() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::AND_C() {
     A() &= C();
     SetFlags_LOGIC(A(), true);
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::AND_D() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::AND_D() {
     A() &= D();
     SetFlags_LOGIC(A(), true);
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::AND_E() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::AND_E() {
     A() &= E();
     SetFlags_LOGIC(A(), true);
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::AND_H() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::AND_H() {
     A() &= GetEffectiveH();
     SetFlags_LOGIC(A(), true);
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::AND_L() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::AND_L() {
     A() &= GetEffectiveL();
     SetFlags_LOGIC(A(), true);
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::AND_mHL() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::AND_mHL() {
     uint16_t address = GetEffectiveHL_Memory();
     A() &= memory[address];
     SetFlags_LOGIC(A(), true);
     t_cycle += GetMemoryAccessCycles();
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::AND_A() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::AND_A() {
     A() &= A();
     SetFlags_LOGIC(A(), true);
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::XOR_B() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::XOR_B() {
     A() ^= B();
     SetFlags_LOGIC(A(), false);
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::XOR_C() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::XOR_C() {
     A() ^= C();
     SetFlags_LOGIC(A(), false);
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::XOR_D() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::XOR_D() {
     A() ^= D();
     SetFlags_LOGIC(A(), false);
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::XOR_E() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::XOR_E() {
     A() ^= E();
     SetFlags_LOGIC(A(), false);
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::XOR_H() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::XOR_H() {
     A() ^= GetEffectiveH();
     SetFlags_LOGIC(A(), false);
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::XOR_L() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::XOR_L() {
     A() ^= GetEffectiveL();
     SetFlags_LOGIC(A(), false);
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::XOR_mHL() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::XOR_mHL() {
     uint16_t address = GetEffectiveHL_Memory();
     A() ^= memory[address];
     SetFlags_LOGIC(A(), false);
     t_cycle += GetMemoryAccessCycles();
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::XOR_A() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::XOR_A() {
     A() ^= A(); // Result is always 0
     SetFlags_LOGIC(A(), false);
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::OR_B() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::OR_B() {
     A() |= B();
     SetFlags_LOGIC(A(), false);
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::OR_C() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::OR_C() {
     A() |= C();
     SetFlags_LOGIC(A(), false);
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::OR_D() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::OR_D() {
     A() |= D();
     SetFlags_LOGIC(A(), false);
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::OR_E() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::OR_E() {
     A() |= E();
     SetFlags_LOGIC(A(), false);
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::OR_H() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::OR_H() {
     A() |= GetEffectiveH();
     SetFlags_LOGIC(A(), false);
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::OR_L() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::OR_L() {
     A() |= GetEffectiveL();
     SetFlags_LOGIC(A(), false);
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::OR_mHL() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::OR_mHL() {
     uint16_t address = GetEffectiveHL_Memory();
     A() |= memory[address];
     SetFlags_LOGIC(A(), false);
     t_cycle += GetMemoryAccessCycles();
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::OR_A() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::OR_A() {
     A() |= A();
     SetFlags_LOGIC(A(), false);
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::CP_B() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::CP_B() {
     uint8_t result = A() - B();
     SetFlags_CP(result, A(), B());
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::CP_C() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::CP_C() {
     uint8_t result = A() - C();
     SetFlags_CP(result, A(), C());
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::CP_D() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::CP_D() {
     uint8_t result = A() - D();
     SetFlags_CP(result, A(), D());
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::CP_E() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::CP_E() {
     uint8_t result = A() - E();
     SetFlags_CP(result, A(), E());
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::CP_H() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::CP_H() {
     uint8_t h_val = GetEffectiveH();
     uint8_t result = A() - h_val;
     SetFlags_CP(result, A(), h_val);
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::CP_L() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::CP_L() {
     uint8_t l_val = GetEffectiveL();
     uint8_t result = A() - l_val;
     SetFlags_CP(result, A(), l_val);
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::CP_mHL() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::CP_mHL() {
     uint16_t address = GetEffectiveHL_Memory();
     uint8_t value = memory[address];
     uint8_t result = A() - value;
@@ -2290,8 +2489,8 @@ void CPUImpl<Memory, Io>::CP_mHL() {
     t_cycle += GetMemoryAccessCycles();
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::CP_A() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::CP_A() {
     uint8_t result = A() - A();
     SetFlags_CP(result, A(), A());
     t_cycle += 4;
@@ -2301,22 +2500,22 @@ void CPUImpl<Memory, Io>::CP_A() {
 // Stack and Condition Helper Functions
 // =============================================================================
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::PushWord(uint16_t value) {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::PushWord(uint16_t value) {
     SP() -= 2;
     memory[SP()] = value & 0xFF;        // Low byte
     memory[SP() + 1] = (value >> 8);    // High byte
 }
 
-template <class Memory, class Io>
-uint16_t CPUImpl<Memory, Io>::PopWord() {
+template <class Memory, class Io, class Traits>
+uint16_t CPUImpl<Memory, Io, Traits>::PopWord() {
     uint16_t value = memory[SP()] | (memory[SP() + 1] << 8);
     SP() += 2;
     return value;
 }
 
-template <class Memory, class Io>
-bool CPUImpl<Memory, Io>::CheckCondition(uint8_t condition) {
+template <class Memory, class Io, class Traits>
+bool CPUImpl<Memory, Io, Traits>::CheckCondition(uint8_t condition) {
     switch (condition) {
         case 0: return !(F() & Constants::Flags::ZERO);     // NZ - not zero
         case 1: return (F() & Constants::Flags::ZERO);      // Z - zero
@@ -2334,8 +2533,8 @@ bool CPUImpl<Memory, Io>::CheckCondition(uint8_t condition) {
 // State-Aware IX/IY Helper Functions
 // =============================================================================
 
-template <class Memory, class Io>
-uint16_t CPUImpl<Memory, Io>::GetEffectiveHL_Memory() {
+template <class Memory, class Io, class Traits>
+uint16_t CPUImpl<Memory, Io, Traits>::GetEffectiveHL_Memory() {
     switch (current_state) {
         case CPUState::NORMAL:
             return HL();
@@ -2356,8 +2555,8 @@ uint16_t CPUImpl<Memory, Io>::GetEffectiveHL_Memory() {
     }
 }
 
-template <class Memory, class Io>
-uint16_t& CPUImpl<Memory, Io>::GetEffectiveHL_Register() {
+template <class Memory, class Io, class Traits>
+uint16_t& CPUImpl<Memory, Io, Traits>::GetEffectiveHL_Register() {
     switch (current_state) {
         case CPUState::DD_PREFIX:
             return IX();
@@ -2368,8 +2567,8 @@ uint16_t& CPUImpl<Memory, Io>::GetEffectiveHL_Register() {
     }
 }
 
-template <class Memory, class Io>
-uint8_t& CPUImpl<Memory, Io>::GetEffectiveH() {
+template <class Memory, class Io, class Traits>
+uint8_t& CPUImpl<Memory, Io, Traits>::GetEffectiveH() {
     switch (current_state) {
         case CPUState::DD_PREFIX:
             return _IX.r8.hi; // IXH
@@ -2380,8 +2579,8 @@ uint8_t& CPUImpl<Memory, Io>::GetEffectiveH() {
     }
 }
 
-template <class Memory, class Io>
-uint8_t& CPUImpl<Memory, Io>::GetEffectiveL() {
+template <class Memory, class Io, class Traits>
+uint8_t& CPUImpl<Memory, Io, Traits>::GetEffectiveL() {
     switch (current_state) {
         case CPUState::DD_PREFIX:
             return _IX.r8.lo; // IXL
@@ -2392,22 +2591,22 @@ uint8_t& CPUImpl<Memory, Io>::GetEffectiveL() {
     }
 }
 
-template <class Memory, class Io>
-uint8_t CPUImpl<Memory, Io>::GetMemoryAccessCycles() {
+template <class Memory, class Io, class Traits>
+uint8_t CPUImpl<Memory, Io, Traits>::GetMemoryAccessCycles() {
     // (HL)=7 T; (IX/IY+d)=19 T. The body returns 15 for the indexed form (the
     // extra 8 over (HL) is the displacement read + internal add); the remaining 4
     // is the DD/FD prefix M1, charged at the prefix fetch.
     return (current_state == CPUState::NORMAL) ? 7 : 15;
 }
 
-template <class Memory, class Io>
-uint8_t CPUImpl<Memory, Io>::GetRegisterOpCycles() {
+template <class Memory, class Io, class Traits>
+uint8_t CPUImpl<Memory, Io, Traits>::GetRegisterOpCycles() {
     // Register operations: HL=6 cycles, IX/IY=6 cycles (prefix adds its own 4 cycles)
     return 6;
 }
 
-template <class Memory, class Io>
-uint8_t CPUImpl<Memory, Io>::GetArithmeticMemCycles() {
+template <class Memory, class Io, class Traits>
+uint8_t CPUImpl<Memory, Io, Traits>::GetArithmeticMemCycles() {
     // A,(HL)=7 T; A,(IX/IY+d)=19 T. Body returns 15 for the indexed form; the
     // remaining 4 is the DD/FD prefix M1, charged at the prefix fetch.
     return (current_state == CPUState::NORMAL) ? 7 : 15;
@@ -2417,8 +2616,8 @@ uint8_t CPUImpl<Memory, Io>::GetArithmeticMemCycles() {
 // Control Flow, Stack, and I/O Instructions (0xC0-0xFF)
 // =============================================================================
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::RET_NZ() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::RET_NZ() {
     if (CheckCondition(0)) { // NZ
         PC() = PopWord();
         t_cycle += 11;
@@ -2427,14 +2626,14 @@ void CPUImpl<Memory, Io>::RET_NZ() {
     }
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::POP_BC() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::POP_BC() {
     BC() = PopWord();
     t_cycle += 10;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::JP_NZ_nn() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::JP_NZ_nn() {
     uint16_t address = memory[PC()] | (memory[PC() + 1] << 8);
     PC() += 2;
     if (CheckCondition(0)) { // NZ
@@ -2443,15 +2642,15 @@ void CPUImpl<Memory, Io>::JP_NZ_nn() {
     t_cycle += 10;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::JP_nn() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::JP_nn() {
     uint16_t address = memory[PC()] | (memory[PC() + 1] << 8);
     PC() = address;
     t_cycle += 10;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::CALL_NZ_nn() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::CALL_NZ_nn() {
     uint16_t address = memory[PC()] | (memory[PC() + 1] << 8);
     PC() += 2;
     if (CheckCondition(0)) { // NZ
@@ -2463,14 +2662,14 @@ void CPUImpl<Memory, Io>::CALL_NZ_nn() {
     }
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::PUSH_BC() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::PUSH_BC() {
     PushWord(BC());
     t_cycle += 11;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::ADD_A_n() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::ADD_A_n() {
     uint8_t value = memory[PC()++];
     uint8_t old_a = A();
     A() += value;
@@ -2478,15 +2677,15 @@ void CPUImpl<Memory, Io>::ADD_A_n() {
     t_cycle += 7;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::RST_00() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::RST_00() {
     PushWord(PC());
     PC() = 0x00;
     t_cycle += 11;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::RET_Z() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::RET_Z() {
     if (CheckCondition(1)) { // Z
         PC() = PopWord();
         t_cycle += 11;
@@ -2495,14 +2694,14 @@ void CPUImpl<Memory, Io>::RET_Z() {
     }
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::RET() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::RET() {
     PC() = PopWord();
     t_cycle += 10;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::JP_Z_nn() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::JP_Z_nn() {
     uint16_t address = memory[PC()] | (memory[PC() + 1] << 8);
     PC() += 2;
     if (CheckCondition(1)) { // Z
@@ -2511,15 +2710,15 @@ void CPUImpl<Memory, Io>::JP_Z_nn() {
     t_cycle += 10;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::PREFIX_CB() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::PREFIX_CB() {
     // This should never be called - CB prefix is handled in Step()
     // If we reach here, it means the state machine has a bug
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::CALL_Z_nn() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::CALL_Z_nn() {
     uint16_t address = memory[PC()] | (memory[PC() + 1] << 8);
     PC() += 2;
     if (CheckCondition(1)) { // Z
@@ -2531,8 +2730,8 @@ void CPUImpl<Memory, Io>::CALL_Z_nn() {
     }
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::CALL_nn() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::CALL_nn() {
     uint16_t address = memory[PC()] | (memory[PC() + 1] << 8);
     PC() += 2;
     PushWord(PC());
@@ -2540,8 +2739,8 @@ void CPUImpl<Memory, Io>::CALL_nn() {
     t_cycle += 17;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::ADC_A_n() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::ADC_A_n() {
     uint8_t value = memory[PC()++];
     uint8_t old_a = A();
     uint8_t carry = (F() & Constants::Flags::CARRY) ? 1 : 0;
@@ -2552,15 +2751,15 @@ void CPUImpl<Memory, Io>::ADC_A_n() {
     t_cycle += 7;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::RST_08() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::RST_08() {
     PushWord(PC());
     PC() = 0x08;
     t_cycle += 11;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::RET_NC() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::RET_NC() {
     if (CheckCondition(2)) { // NC
         PC() = PopWord();
         t_cycle += 11;
@@ -2569,14 +2768,14 @@ void CPUImpl<Memory, Io>::RET_NC() {
     }
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::POP_DE() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::POP_DE() {
     DE() = PopWord();
     t_cycle += 10;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::JP_NC_nn() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::JP_NC_nn() {
     uint16_t address = memory[PC()] | (memory[PC() + 1] << 8);
     PC() += 2;
     if (CheckCondition(2)) { // NC
@@ -2585,8 +2784,8 @@ void CPUImpl<Memory, Io>::JP_NC_nn() {
     t_cycle += 10;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::OUT_n_A() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::OUT_n_A() {
     uint8_t port = memory[PC()++];
     // OUT (n),A drives A onto the high address byte (full 16-bit port).
     t_cycle += 7;
@@ -2594,8 +2793,8 @@ void CPUImpl<Memory, Io>::OUT_n_A() {
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::CALL_NC_nn() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::CALL_NC_nn() {
     uint16_t address = memory[PC()] | (memory[PC() + 1] << 8);
     PC() += 2;
     if (CheckCondition(2)) { // NC
@@ -2607,14 +2806,14 @@ void CPUImpl<Memory, Io>::CALL_NC_nn() {
     }
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::PUSH_DE() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::PUSH_DE() {
     PushWord(DE());
     t_cycle += 11;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::SUB_n() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::SUB_n() {
     uint8_t value = memory[PC()++];
     uint8_t old_a = A();
     A() -= value;
@@ -2622,15 +2821,15 @@ void CPUImpl<Memory, Io>::SUB_n() {
     t_cycle += 7;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::RST_10() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::RST_10() {
     PushWord(PC());
     PC() = 0x10;
     t_cycle += 11;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::RET_C() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::RET_C() {
     if (CheckCondition(3)) { // C
         PC() = PopWord();
         t_cycle += 11;
@@ -2639,8 +2838,8 @@ void CPUImpl<Memory, Io>::RET_C() {
     }
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::EXX() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::EXX() {
     // Exchange BC, DE, HL with BC', DE', HL'
     uint16_t temp;
     temp = BC(); BC() = _BC1.r16; _BC1.r16 = temp;
@@ -2649,8 +2848,8 @@ void CPUImpl<Memory, Io>::EXX() {
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::JP_C_nn() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::JP_C_nn() {
     uint16_t address = memory[PC()] | (memory[PC() + 1] << 8);
     PC() += 2;
     if (CheckCondition(3)) { // C
@@ -2659,8 +2858,8 @@ void CPUImpl<Memory, Io>::JP_C_nn() {
     t_cycle += 10;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::IN_A_n() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::IN_A_n() {
     uint8_t port = memory[PC()++];
     // IN A,(n) drives A onto the high address byte; A's old value forms the port.
     // I/O timing split (see FLOATING_BUS_DESIGN.md §5): charge the fetch M-cycles
@@ -2672,8 +2871,8 @@ void CPUImpl<Memory, Io>::IN_A_n() {
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::CALL_C_nn() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::CALL_C_nn() {
     uint16_t address = memory[PC()] | (memory[PC() + 1] << 8);
     PC() += 2;
     if (CheckCondition(3)) { // C
@@ -2685,14 +2884,14 @@ void CPUImpl<Memory, Io>::CALL_C_nn() {
     }
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::PREFIX_DD() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::PREFIX_DD() {
     // DD prefix handling is implemented in the main Step() state machine
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::SBC_A_n() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::SBC_A_n() {
     uint8_t value = memory[PC()++];
     uint8_t old_a = A();
     uint8_t carry = (F() & Constants::Flags::CARRY) ? 1 : 0;
@@ -2703,15 +2902,15 @@ void CPUImpl<Memory, Io>::SBC_A_n() {
     t_cycle += 7;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::RST_18() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::RST_18() {
     PushWord(PC());
     PC() = 0x18;
     t_cycle += 11;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::RET_PO() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::RET_PO() {
     if (CheckCondition(4)) { // PO
         PC() = PopWord();
         t_cycle += 11;
@@ -2720,14 +2919,14 @@ void CPUImpl<Memory, Io>::RET_PO() {
     }
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::POP_HL() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::POP_HL() {
     GetEffectiveHL_Register() = PopWord();
     t_cycle += 10;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::JP_PO_nn() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::JP_PO_nn() {
     uint16_t address = memory[PC()] | (memory[PC() + 1] << 8);
     PC() += 2;
     if (CheckCondition(4)) { // PO
@@ -2736,8 +2935,8 @@ void CPUImpl<Memory, Io>::JP_PO_nn() {
     t_cycle += 10;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::EX_mSP_HL() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::EX_mSP_HL() {
     uint16_t& hl_reg = GetEffectiveHL_Register();
     uint16_t temp = memory[SP()] | (memory[SP() + 1] << 8);
     memory[SP()] = hl_reg & 0xFF;        // Low byte
@@ -2746,8 +2945,8 @@ void CPUImpl<Memory, Io>::EX_mSP_HL() {
     t_cycle += 19;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::CALL_PO_nn() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::CALL_PO_nn() {
     uint16_t address = memory[PC()] | (memory[PC() + 1] << 8);
     PC() += 2;
     if (CheckCondition(4)) { // PO
@@ -2759,29 +2958,29 @@ void CPUImpl<Memory, Io>::CALL_PO_nn() {
     }
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::PUSH_HL() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::PUSH_HL() {
     PushWord(GetEffectiveHL_Register());
     t_cycle += 11;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::AND_n() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::AND_n() {
     uint8_t value = memory[PC()++];
     A() &= value;
     SetFlags_LOGIC(A(), true);
     t_cycle += 7;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::RST_20() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::RST_20() {
     PushWord(PC());
     PC() = 0x20;
     t_cycle += 11;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::RET_PE() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::RET_PE() {
     if (CheckCondition(5)) { // PE
         PC() = PopWord();
         t_cycle += 11;
@@ -2790,14 +2989,14 @@ void CPUImpl<Memory, Io>::RET_PE() {
     }
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::JP_HL() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::JP_HL() {
     PC() = GetEffectiveHL_Register();
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::JP_PE_nn() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::JP_PE_nn() {
     uint16_t address = memory[PC()] | (memory[PC() + 1] << 8);
     PC() += 2;
     if (CheckCondition(5)) { // PE
@@ -2806,8 +3005,8 @@ void CPUImpl<Memory, Io>::JP_PE_nn() {
     t_cycle += 10;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::EX_DE_HL() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::EX_DE_HL() {
     uint16_t& hl_reg = GetEffectiveHL_Register();
     uint16_t temp = DE();
     DE() = hl_reg;
@@ -2815,8 +3014,8 @@ void CPUImpl<Memory, Io>::EX_DE_HL() {
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::CALL_PE_nn() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::CALL_PE_nn() {
     uint16_t address = memory[PC()] | (memory[PC() + 1] << 8);
     PC() += 2;
     if (CheckCondition(5)) { // PE
@@ -2828,29 +3027,29 @@ void CPUImpl<Memory, Io>::CALL_PE_nn() {
     }
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::PREFIX_ED() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::PREFIX_ED() {
     // ED prefix handling is implemented in the main Step() state machine
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::XOR_n() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::XOR_n() {
     uint8_t value = memory[PC()++];
     A() ^= value;
     SetFlags_LOGIC(A(), false);
     t_cycle += 7;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::RST_28() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::RST_28() {
     PushWord(PC());
     PC() = 0x28;
     t_cycle += 11;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::RET_P() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::RET_P() {
     if (CheckCondition(6)) { // P
         PC() = PopWord();
         t_cycle += 11;
@@ -2859,14 +3058,14 @@ void CPUImpl<Memory, Io>::RET_P() {
     }
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::POP_AF() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::POP_AF() {
     AF() = PopWord();
     t_cycle += 10;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::JP_P_nn() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::JP_P_nn() {
     uint16_t address = memory[PC()] | (memory[PC() + 1] << 8);
     PC() += 2;
     if (CheckCondition(6)) { // P
@@ -2875,15 +3074,15 @@ void CPUImpl<Memory, Io>::JP_P_nn() {
     t_cycle += 10;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::DI() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::DI() {
     IFF1() = false;
     IFF2() = false;
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::CALL_P_nn() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::CALL_P_nn() {
     uint16_t address = memory[PC()] | (memory[PC() + 1] << 8);
     PC() += 2;
     if (CheckCondition(6)) { // P
@@ -2895,29 +3094,29 @@ void CPUImpl<Memory, Io>::CALL_P_nn() {
     }
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::PUSH_AF() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::PUSH_AF() {
     PushWord(AF());
     t_cycle += 11;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::OR_n() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::OR_n() {
     uint8_t value = memory[PC()++];
     A() |= value;
     SetFlags_LOGIC(A(), false);
     t_cycle += 7;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::RST_30() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::RST_30() {
     PushWord(PC());
     PC() = 0x30;
     t_cycle += 11;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::RET_M() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::RET_M() {
     if (CheckCondition(7)) { // M
         PC() = PopWord();
         t_cycle += 11;
@@ -2926,14 +3125,14 @@ void CPUImpl<Memory, Io>::RET_M() {
     }
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_SP_HL() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_SP_HL() {
     SP() = GetEffectiveHL_Register();
     t_cycle += 6;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::JP_M_nn() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::JP_M_nn() {
     uint16_t address = memory[PC()] | (memory[PC() + 1] << 8);
     PC() += 2;
     if (CheckCondition(7)) { // M
@@ -2942,16 +3141,17 @@ void CPUImpl<Memory, Io>::JP_M_nn() {
     t_cycle += 10;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::EI() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::EI() {
     IFF1() = true;
     IFF2() = true;
-    ei_defer_ = true;   // interrupts not accepted until after the next instruction
+    if constexpr (Traits::kInterrupts)
+        ei_defer_ = true;   // interrupts not accepted until after the next instruction
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::CALL_M_nn() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::CALL_M_nn() {
     uint16_t address = memory[PC()] | (memory[PC() + 1] << 8);
     PC() += 2;
     if (CheckCondition(7)) { // M
@@ -2963,22 +3163,22 @@ void CPUImpl<Memory, Io>::CALL_M_nn() {
     }
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::PREFIX_FD() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::PREFIX_FD() {
     // FD prefix handling is implemented in the main Step() state machine
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::CP_n() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::CP_n() {
     uint8_t value = memory[PC()++];
     uint8_t result = A() - value;
     SetFlags_CP(result, A(), value);
     t_cycle += 7;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::RST_38() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::RST_38() {
     PushWord(PC());
     PC() = 0x38;
     t_cycle += 11;
@@ -2988,8 +3188,8 @@ void CPUImpl<Memory, Io>::RST_38() {
 // CB Instruction Implementation - Compact Decoder
 // =============================================================================
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::ExecuteCBInstruction(uint8_t opcode) {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::ExecuteCBInstruction(uint8_t opcode) {
     // Decode CB instruction structure: OOORRRRR
     // OOO = Operation (bits 7-6-5 or 7-6 for bit operations)
     // RRR = Register/Memory target (bits 2-1-0)
@@ -3126,8 +3326,8 @@ void CPUImpl<Memory, Io>::ExecuteCBInstruction(uint8_t opcode) {
     }
 }
 
-template <class Memory, class Io>
-uint8_t& CPUImpl<Memory, Io>::GetCBRegister(uint8_t reg_code) {
+template <class Memory, class Io, class Traits>
+uint8_t& CPUImpl<Memory, Io, Traits>::GetCBRegister(uint8_t reg_code) {
     switch (reg_code) {
         case 0: return B();
         case 1: return C();
@@ -3152,8 +3352,8 @@ uint8_t& CPUImpl<Memory, Io>::GetCBRegister(uint8_t reg_code) {
     }
 }
 
-template <class Memory, class Io>
-uint8_t CPUImpl<Memory, Io>::GetCBMemory(uint8_t reg_code) {
+template <class Memory, class Io, class Traits>
+uint8_t CPUImpl<Memory, Io, Traits>::GetCBMemory(uint8_t reg_code) {
     if (reg_code == 6) {
         uint16_t address = GetEffectiveHL_Memory();
         return memory[address];
@@ -3161,8 +3361,8 @@ uint8_t CPUImpl<Memory, Io>::GetCBMemory(uint8_t reg_code) {
     return 0; // Should never happen
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::SetCBMemory(uint8_t reg_code, uint8_t value) {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::SetCBMemory(uint8_t reg_code, uint8_t value) {
     if (reg_code == 6) {
         uint16_t address = GetEffectiveHL_Memory();
         memory[address] = value;
@@ -3173,8 +3373,8 @@ void CPUImpl<Memory, Io>::SetCBMemory(uint8_t reg_code, uint8_t value) {
 // CB Instruction Helper Functions
 // =============================================================================
 
-template <class Memory, class Io>
-uint8_t CPUImpl<Memory, Io>::RotateLeftCircular(uint8_t value) {
+template <class Memory, class Io, class Traits>
+uint8_t CPUImpl<Memory, Io, Traits>::RotateLeftCircular(uint8_t value) {
     uint8_t bit7 = (value & 0x80) ? 1 : 0;
     uint8_t result = (value << 1) | bit7;
     
@@ -3185,8 +3385,8 @@ uint8_t CPUImpl<Memory, Io>::RotateLeftCircular(uint8_t value) {
     return result;
 }
 
-template <class Memory, class Io>
-uint8_t CPUImpl<Memory, Io>::RotateRightCircular(uint8_t value) {
+template <class Memory, class Io, class Traits>
+uint8_t CPUImpl<Memory, Io, Traits>::RotateRightCircular(uint8_t value) {
     uint8_t bit0 = value & 0x01;
     uint8_t result = (value >> 1) | (bit0 << 7);
     
@@ -3197,8 +3397,8 @@ uint8_t CPUImpl<Memory, Io>::RotateRightCircular(uint8_t value) {
     return result;
 }
 
-template <class Memory, class Io>
-uint8_t CPUImpl<Memory, Io>::RotateLeft(uint8_t value) {
+template <class Memory, class Io, class Traits>
+uint8_t CPUImpl<Memory, Io, Traits>::RotateLeft(uint8_t value) {
     uint8_t old_carry = (F() & Constants::Flags::CARRY) ? 1 : 0;
     uint8_t bit7 = (value & 0x80) ? 1 : 0;
     uint8_t result = (value << 1) | old_carry;
@@ -3210,8 +3410,8 @@ uint8_t CPUImpl<Memory, Io>::RotateLeft(uint8_t value) {
     return result;
 }
 
-template <class Memory, class Io>
-uint8_t CPUImpl<Memory, Io>::RotateRight(uint8_t value) {
+template <class Memory, class Io, class Traits>
+uint8_t CPUImpl<Memory, Io, Traits>::RotateRight(uint8_t value) {
     uint8_t old_carry = (F() & Constants::Flags::CARRY) ? 1 : 0;
     uint8_t bit0 = value & 0x01;
     uint8_t result = (value >> 1) | (old_carry << 7);
@@ -3223,8 +3423,8 @@ uint8_t CPUImpl<Memory, Io>::RotateRight(uint8_t value) {
     return result;
 }
 
-template <class Memory, class Io>
-uint8_t CPUImpl<Memory, Io>::ShiftLeftArithmetic(uint8_t value) {
+template <class Memory, class Io, class Traits>
+uint8_t CPUImpl<Memory, Io, Traits>::ShiftLeftArithmetic(uint8_t value) {
     uint8_t bit7 = (value & 0x80) ? 1 : 0;
     uint8_t result = value << 1;
     
@@ -3235,8 +3435,8 @@ uint8_t CPUImpl<Memory, Io>::ShiftLeftArithmetic(uint8_t value) {
     return result;
 }
 
-template <class Memory, class Io>
-uint8_t CPUImpl<Memory, Io>::ShiftRightArithmetic(uint8_t value) {
+template <class Memory, class Io, class Traits>
+uint8_t CPUImpl<Memory, Io, Traits>::ShiftRightArithmetic(uint8_t value) {
     uint8_t bit0 = value & 0x01;
     uint8_t bit7 = value & 0x80; // Preserve sign bit
     uint8_t result = (value >> 1) | bit7;
@@ -3248,8 +3448,8 @@ uint8_t CPUImpl<Memory, Io>::ShiftRightArithmetic(uint8_t value) {
     return result;
 }
 
-template <class Memory, class Io>
-uint8_t CPUImpl<Memory, Io>::ShiftLeftLogical(uint8_t value) {
+template <class Memory, class Io, class Traits>
+uint8_t CPUImpl<Memory, Io, Traits>::ShiftLeftLogical(uint8_t value) {
     // Undocumented instruction - same as SLA but sets bit 0
     uint8_t bit7 = (value & 0x80) ? 1 : 0;
     uint8_t result = (value << 1) | 0x01;
@@ -3261,8 +3461,8 @@ uint8_t CPUImpl<Memory, Io>::ShiftLeftLogical(uint8_t value) {
     return result;
 }
 
-template <class Memory, class Io>
-uint8_t CPUImpl<Memory, Io>::ShiftRightLogical(uint8_t value) {
+template <class Memory, class Io, class Traits>
+uint8_t CPUImpl<Memory, Io, Traits>::ShiftRightLogical(uint8_t value) {
     uint8_t bit0 = value & 0x01;
     uint8_t result = value >> 1; // Logical shift - bit 7 becomes 0
     
@@ -3273,8 +3473,8 @@ uint8_t CPUImpl<Memory, Io>::ShiftRightLogical(uint8_t value) {
     return result;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::TestBit(uint8_t value, uint8_t bit, uint8_t xy_source) {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::TestBit(uint8_t value, uint8_t bit, uint8_t xy_source) {
     uint8_t bit_mask = 1 << bit;
     bool bit_set = (value & bit_mask) != 0;
     
@@ -3287,14 +3487,14 @@ void CPUImpl<Memory, Io>::TestBit(uint8_t value, uint8_t bit, uint8_t xy_source)
     if (!bit_set) F() |= Constants::Flags::PARITY; // P/V flag = Z flag for BIT
 }
 
-template <class Memory, class Io>
-uint8_t CPUImpl<Memory, Io>::ResetBit(uint8_t value, uint8_t bit) {
+template <class Memory, class Io, class Traits>
+uint8_t CPUImpl<Memory, Io, Traits>::ResetBit(uint8_t value, uint8_t bit) {
     uint8_t bit_mask = ~(1 << bit);
     return value & bit_mask;
 }
 
-template <class Memory, class Io>
-uint8_t CPUImpl<Memory, Io>::SetBit(uint8_t value, uint8_t bit) {
+template <class Memory, class Io, class Traits>
+uint8_t CPUImpl<Memory, Io, Traits>::SetBit(uint8_t value, uint8_t bit) {
     uint8_t bit_mask = 1 << bit;
     return value | bit_mask;
 }
@@ -3303,14 +3503,14 @@ uint8_t CPUImpl<Memory, Io>::SetBit(uint8_t value, uint8_t bit) {
 // ED Instruction Implementations
 // =============================================================================
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::ED_NOP() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::ED_NOP() {
     // Default handler for undefined ED instructions
     t_cycle += 4; // ED prefix M1 was already charged
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::SBC_HL_DE() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::SBC_HL_DE() {
     // ED 52 - Subtract DE from HL with carry
     const uint16_t old_hl = HL();
     const uint16_t operand = DE();
@@ -3321,8 +3521,8 @@ void CPUImpl<Memory, Io>::SBC_HL_DE() {
     t_cycle += 11;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::ADC_HL_DE() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::ADC_HL_DE() {
     // ED 5A - Add DE to HL with carry
     const uint16_t old_hl = HL();
     const uint16_t operand = DE();
@@ -3337,8 +3537,8 @@ void CPUImpl<Memory, Io>::ADC_HL_DE() {
 // Additional 16-bit Arithmetic ED Instructions
 // =============================================================================
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::SBC_HL_BC() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::SBC_HL_BC() {
     // ED 42 - Subtract BC from HL with carry
     const uint16_t old_hl = HL();
     const uint16_t operand = BC();
@@ -3349,8 +3549,8 @@ void CPUImpl<Memory, Io>::SBC_HL_BC() {
     t_cycle += 11;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::ADC_HL_BC() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::ADC_HL_BC() {
     // ED 4A - Add BC to HL with carry
     const uint16_t old_hl = HL();
     const uint16_t operand = BC();
@@ -3361,8 +3561,8 @@ void CPUImpl<Memory, Io>::ADC_HL_BC() {
     t_cycle += 11;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::SBC_HL_HL() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::SBC_HL_HL() {
     // ED 62 - Subtract HL from HL with carry
     const uint16_t old_hl = HL();
     const uint8_t carry = (F() & Constants::Flags::CARRY) ? 1 : 0;
@@ -3372,8 +3572,8 @@ void CPUImpl<Memory, Io>::SBC_HL_HL() {
     t_cycle += 11;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::ADC_HL_HL() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::ADC_HL_HL() {
     // ED 6A - Add HL to HL with carry
     const uint16_t old_hl = HL();
     const uint8_t carry = (F() & Constants::Flags::CARRY) ? 1 : 0;
@@ -3383,8 +3583,8 @@ void CPUImpl<Memory, Io>::ADC_HL_HL() {
     t_cycle += 11;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::SBC_HL_SP() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::SBC_HL_SP() {
     // ED 72 - Subtract SP from HL with carry
     const uint16_t old_hl = HL();
     const uint16_t operand = SP();
@@ -3395,8 +3595,8 @@ void CPUImpl<Memory, Io>::SBC_HL_SP() {
     t_cycle += 11;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::ADC_HL_SP() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::ADC_HL_SP() {
     // ED 7A - Add SP to HL with carry
     const uint16_t old_hl = HL();
     const uint16_t operand = SP();
@@ -3411,8 +3611,8 @@ void CPUImpl<Memory, Io>::ADC_HL_SP() {
 // 16-bit Load/Store ED Instructions
 // =============================================================================
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_mnn_BC() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_mnn_BC() {
     // ED 43 - Load BC to memory at 16-bit address
     uint16_t address = memory[PC()] | (memory[PC() + 1] << 8);
     PC() += 2;
@@ -3421,8 +3621,8 @@ void CPUImpl<Memory, Io>::LD_mnn_BC() {
     t_cycle += 16;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_BC_mnn() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_BC_mnn() {
     // ED 4B - Load memory at 16-bit address to BC
     uint16_t address = memory[PC()] | (memory[PC() + 1] << 8);
     PC() += 2;
@@ -3430,8 +3630,8 @@ void CPUImpl<Memory, Io>::LD_BC_mnn() {
     t_cycle += 16;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_mnn_DE() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_mnn_DE() {
     // ED 53 - Load DE to memory at 16-bit address
     uint16_t address = memory[PC()] | (memory[PC() + 1] << 8);
     PC() += 2;
@@ -3440,8 +3640,8 @@ void CPUImpl<Memory, Io>::LD_mnn_DE() {
     t_cycle += 16;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_DE_mnn() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_DE_mnn() {
     // ED 5B - Load memory at 16-bit address to DE
     uint16_t address = memory[PC()] | (memory[PC() + 1] << 8);
     PC() += 2;
@@ -3449,8 +3649,8 @@ void CPUImpl<Memory, Io>::LD_DE_mnn() {
     t_cycle += 16;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_mnn_HL_ED() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_mnn_HL_ED() {
     // ED 63 - Load HL to memory at 16-bit address (ED version)
     uint16_t address = memory[PC()] | (memory[PC() + 1] << 8);
     PC() += 2;
@@ -3459,8 +3659,8 @@ void CPUImpl<Memory, Io>::LD_mnn_HL_ED() {
     t_cycle += 16;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_HL_mnn_ED() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_HL_mnn_ED() {
     // ED 6B - Load memory at 16-bit address to HL (ED version)
     uint16_t address = memory[PC()] | (memory[PC() + 1] << 8);
     PC() += 2;
@@ -3468,8 +3668,8 @@ void CPUImpl<Memory, Io>::LD_HL_mnn_ED() {
     t_cycle += 16;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_mnn_SP() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_mnn_SP() {
     // ED 73 - Load SP to memory at 16-bit address
     uint16_t address = memory[PC()] | (memory[PC() + 1] << 8);
     PC() += 2;
@@ -3478,8 +3678,8 @@ void CPUImpl<Memory, Io>::LD_mnn_SP() {
     t_cycle += 16;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_SP_mnn() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_SP_mnn() {
     // ED 7B - Load memory at 16-bit address to SP
     uint16_t address = memory[PC()] | (memory[PC() + 1] << 8);
     PC() += 2;
@@ -3491,8 +3691,8 @@ void CPUImpl<Memory, Io>::LD_SP_mnn() {
 // Special Operations and Register Transfer ED Instructions
 // =============================================================================
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::NEG() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::NEG() {
     // ED 44 - Negate A (2's complement)
     uint8_t old_a = A();
     A() = (~A()) + 1;  // 2's complement negation
@@ -3501,52 +3701,52 @@ void CPUImpl<Memory, Io>::NEG() {
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::RETN() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::RETN() {
     // ED 45 - Return from non-maskable interrupt
     PC() = PopWord();
     IFF1() = IFF2(); // Restore interrupt state
     t_cycle += 10;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::IM_0() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::IM_0() {
     // ED 46 - Set interrupt mode 0
     _interrupt_mode = 0;
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_I_A() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_I_A() {
     // ED 47 - Load A to I register
     I() = A();
     t_cycle += 5;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::RETI() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::RETI() {
     // ED 4D - Return from interrupt
     PC() = PopWord();
     IFF1() = IFF2(); // Restore interrupt state
     t_cycle += 10;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_R_A() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_R_A() {
     // ED 4F - Load A to R register
     R() = A();
     t_cycle += 5;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::IM_1() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::IM_1() {
     // ED 56 - Set interrupt mode 1
     _interrupt_mode = 1;
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_A_I() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_A_I() {
     // ED 57 - Load I register to A
     A() = I();
     
@@ -3559,15 +3759,15 @@ void CPUImpl<Memory, Io>::LD_A_I() {
     t_cycle += 5;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::IM_2() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::IM_2() {
     // ED 5E - Set interrupt mode 2
     _interrupt_mode = 2;
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LD_A_R() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LD_A_R() {
     // ED 5F - Load R register to A
     A() = R();
     
@@ -3580,8 +3780,8 @@ void CPUImpl<Memory, Io>::LD_A_R() {
     t_cycle += 5;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::RRD() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::RRD() {
     // ED 67 - Rotate right decimal (4-bit)
     uint8_t mem_val = memory[HL()];
     uint8_t a_low = A() & 0x0F;
@@ -3598,8 +3798,8 @@ void CPUImpl<Memory, Io>::RRD() {
     t_cycle += 14;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::RLD() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::RLD() {
     // ED 6F - Rotate left decimal (4-bit)
     uint8_t mem_val = memory[HL()];
     uint8_t a_low = A() & 0x0F;
@@ -3620,8 +3820,8 @@ void CPUImpl<Memory, Io>::RLD() {
 // Block Operation ED Instructions
 // =============================================================================
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LDI() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LDI() {
     // ED A0 - Load and increment
     const uint8_t value = memory[HL()];
     memory[DE()] = value;
@@ -3638,8 +3838,8 @@ void CPUImpl<Memory, Io>::LDI() {
     t_cycle += 12;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::CPI() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::CPI() {
     // ED A1 - Compare and increment
     const uint8_t value = memory[HL()];
     const uint8_t result = static_cast<uint8_t>(A() - value);
@@ -3660,8 +3860,8 @@ void CPUImpl<Memory, Io>::CPI() {
     t_cycle += 12;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::INI() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::INI() {
     // ED A2 - Input and increment
     // I/O timing split (see FLOATING_BUS_DESIGN.md §5): charge the opcode M1 (5 T
     // for block I/O; the prefix M1 was charged by Step's dispatch) before the port
@@ -3679,8 +3879,8 @@ void CPUImpl<Memory, Io>::INI() {
     t_cycle += 7;   // (5 charged before the I/O read; body total 12)
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::OUTI() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::OUTI() {
     // ED A3 - Output and increment
     t_cycle += 5;                   // opcode M1 before the I/O write (see INI split)
     io.Out(BC(), memory[HL()]);
@@ -3695,8 +3895,8 @@ void CPUImpl<Memory, Io>::OUTI() {
     t_cycle += 7;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LDD() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LDD() {
     // ED A8 - Load and decrement
     const uint8_t value = memory[HL()];
     memory[DE()] = value;
@@ -3713,8 +3913,8 @@ void CPUImpl<Memory, Io>::LDD() {
     t_cycle += 12;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::CPD() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::CPD() {
     // ED A9 - Compare and decrement
     const uint8_t value = memory[HL()];
     const uint8_t result = static_cast<uint8_t>(A() - value);
@@ -3735,8 +3935,8 @@ void CPUImpl<Memory, Io>::CPD() {
     t_cycle += 12;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::IND() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::IND() {
     // ED AA - Input and decrement
     t_cycle += 5;                   // opcode M1 before the I/O read (see INI split)
     memory[HL()] = io.In(BC());
@@ -3751,8 +3951,8 @@ void CPUImpl<Memory, Io>::IND() {
     t_cycle += 7;   // (5 charged before the I/O read; body total 12)
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::OUTD() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::OUTD() {
     // ED AB - Output and decrement
     t_cycle += 5;                   // opcode M1 before the I/O write (see INI split)
     io.Out(BC(), memory[HL()]);
@@ -3767,8 +3967,8 @@ void CPUImpl<Memory, Io>::OUTD() {
     t_cycle += 7;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LDIR() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LDIR() {
     // ED B0 - Load, increment and repeat.
     //
     // Executed ONE iteration per instruction step, the way a real Z80 does it:
@@ -3786,8 +3986,8 @@ void CPUImpl<Memory, Io>::LDIR() {
     if (BC() != 0) { PC() -= 2; t_cycle += 5; }
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::CPIR() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::CPIR() {
     // ED B1 - Compare, increment and repeat (one iteration per step; see LDIR).
     // Repeats while BC != 0 and no match was found (Z clear). Interruptible
     // between iterations.
@@ -3795,48 +3995,48 @@ void CPUImpl<Memory, Io>::CPIR() {
     if (BC() != 0 && !(F() & Constants::Flags::ZERO)) { PC() -= 2; t_cycle += 5; }
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::INIR() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::INIR() {
     // ED B2 - Input, increment and repeat (one iteration per step; see LDIR).
     // Repeats while B != 0. Interruptible between iterations.
     INI();
     if (B() != 0) { PC() -= 2; t_cycle += 5; }
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::OTIR() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::OTIR() {
     // ED B3 - Output, increment and repeat (one iteration per step; see LDIR).
     // Repeats while B != 0. Interruptible between iterations.
     OUTI();
     if (B() != 0) { PC() -= 2; t_cycle += 5; }
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::LDDR() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::LDDR() {
     // ED B8 - Load, decrement and repeat (one iteration per step; see LDIR).
     // Repeats while BC != 0. Interruptible between iterations.
     LDD();
     if (BC() != 0) { PC() -= 2; t_cycle += 5; }
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::CPDR() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::CPDR() {
     // ED B9 - Compare, decrement and repeat (one iteration per step; see CPIR).
     // Repeats while BC != 0 and no match (Z clear). Interruptible between iterations.
     CPD();
     if (BC() != 0 && !(F() & Constants::Flags::ZERO)) { PC() -= 2; t_cycle += 5; }
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::INDR() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::INDR() {
     // ED BA - Input, decrement and repeat (one iteration per step; see INIR).
     // Repeats while B != 0. Interruptible between iterations.
     IND();
     if (B() != 0) { PC() -= 2; t_cycle += 5; }
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::OTDR() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::OTDR() {
     // ED BB - Output, decrement and repeat (one iteration per step; see OTIR).
     // Repeats while B != 0. Interruptible between iterations.
     OUTD();
@@ -3847,8 +4047,8 @@ void CPUImpl<Memory, Io>::OTDR() {
 // Individual I/O ED Instructions
 // =============================================================================
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::IN_B_C() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::IN_B_C() {
     // ED 40 - Input from port C to B
     // I/O timing split (see FLOATING_BUS_DESIGN.md §5): the ED prefix M1 (4 T) was
     // charged by Step's dispatch; charge the opcode M1 (4 T) BEFORE the port read
@@ -3866,16 +4066,16 @@ void CPUImpl<Memory, Io>::IN_B_C() {
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::OUT_C_B() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::OUT_C_B() {
     // ED 41 - Output B to port C
     t_cycle += 4;
     io.Out(BC(), B());
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::IN_C_C() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::IN_C_C() {
     // ED 48 - Input from port C to C
     t_cycle += 4;                   // opcode M1 before the I/O read (see IN_B_C)
     C() = io.In(BC());
@@ -3889,16 +4089,16 @@ void CPUImpl<Memory, Io>::IN_C_C() {
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::OUT_C_C() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::OUT_C_C() {
     // ED 49 - Output C to port C
     t_cycle += 4;
     io.Out(BC(), C());
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::IN_D_C() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::IN_D_C() {
     // ED 50 - Input from port C to D
     t_cycle += 4;                   // opcode M1 before the I/O read (see IN_B_C)
     D() = io.In(BC());
@@ -3912,16 +4112,16 @@ void CPUImpl<Memory, Io>::IN_D_C() {
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::OUT_C_D() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::OUT_C_D() {
     // ED 51 - Output D to port C
     t_cycle += 4;
     io.Out(BC(), D());
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::IN_E_C() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::IN_E_C() {
     // ED 58 - Input from port C to E
     t_cycle += 4;                   // opcode M1 before the I/O read (see IN_B_C)
     E() = io.In(BC());
@@ -3935,16 +4135,16 @@ void CPUImpl<Memory, Io>::IN_E_C() {
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::OUT_C_E() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::OUT_C_E() {
     // ED 59 - Output E to port C
     t_cycle += 4;
     io.Out(BC(), E());
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::IN_H_C() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::IN_H_C() {
     // ED 60 - Input from port C to H
     t_cycle += 4;                   // opcode M1 before the I/O read (see IN_B_C)
     H() = io.In(BC());
@@ -3958,16 +4158,16 @@ void CPUImpl<Memory, Io>::IN_H_C() {
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::OUT_C_H() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::OUT_C_H() {
     // ED 61 - Output H to port C
     t_cycle += 4;
     io.Out(BC(), H());
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::IN_L_C() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::IN_L_C() {
     // ED 68 - Input from port C to L
     t_cycle += 4;                   // opcode M1 before the I/O read (see IN_B_C)
     L() = io.In(BC());
@@ -3981,16 +4181,16 @@ void CPUImpl<Memory, Io>::IN_L_C() {
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::OUT_C_L() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::OUT_C_L() {
     // ED 69 - Output L to port C
     t_cycle += 4;
     io.Out(BC(), L());
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::IN_F_C() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::IN_F_C() {
     // ED 70 - Input from port C (undocumented - sets flags only, doesn't store value)
     t_cycle += 4;                   // opcode M1 before the I/O read (see IN_B_C)
     uint8_t value = io.In(BC());
@@ -4004,16 +4204,16 @@ void CPUImpl<Memory, Io>::IN_F_C() {
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::OUT_C_0() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::OUT_C_0() {
     // ED 71 - Output 0 to port C (undocumented)
     t_cycle += 4;
     io.Out(BC(), 0);
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::IN_A_C() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::IN_A_C() {
     // ED 78 - Input from port C to A
     t_cycle += 4;                   // opcode M1 before the I/O read (see IN_B_C)
     A() = io.In(BC());
@@ -4027,8 +4227,8 @@ void CPUImpl<Memory, Io>::IN_A_C() {
     t_cycle += 4;
 }
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::OUT_C_A() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::OUT_C_A() {
     // ED 79 - Output A to port C
     t_cycle += 4;
     io.Out(BC(), A());
@@ -4039,8 +4239,8 @@ void CPUImpl<Memory, Io>::OUT_C_A() {
 // Undocumented ED Instructions
 // =============================================================================
 
-template <class Memory, class Io>
-void CPUImpl<Memory, Io>::SLL_mHL() {
+template <class Memory, class Io, class Traits>
+void CPUImpl<Memory, Io, Traits>::SLL_mHL() {
     // ED 76 - Shift Left Logical (HL) - undocumented instruction
     // This is like SLA but always sets bit 0 to 1
     uint8_t value = memory[HL()];
@@ -4061,7 +4261,7 @@ void CPUImpl<Memory, Io>::SLL_mHL() {
 // =============================================================================
 // Explicit Template Instantiations
 // =============================================================================
-// Emit the full CPU for each <Memory, Io> configuration used across the project
+// Emit the full CPU for each <Memory, Io, Traits> configuration used across the project
 // so translation units that only see the declarations in z80_cpu.h link against
 // these definitions. (Add a line here when a new configuration is introduced.)
 //  - <FastMemory, OpenBusIo>                   : z80::CPU — production / benchmark
@@ -4070,9 +4270,24 @@ void CPUImpl<Memory, Io>::SLL_mHL() {
 //  - <ObservableMemory, ObservableIo<CallbackIo>> : the debugger AND the ZX
 //      Spectrum (DebugCPU == SpectrumCpu — one config, so a DebugSession can
 //      drive a running Spectrum; the ULA hooks the inner CallbackIo's ports)
+// and, with InstrumentedCpuTraits, the two that tools/instruction_mix runs:
+//  - <FastMemory, OpenBusIo, Instrumented>     : z80::InstrumentedCpu
+//  - <ObservableMemory, ObservableIo<CallbackIo>, Instrumented> : a Spectrum
+//      whose instruction mix is counted (InstrumentedSpectrumMachine)
+// and, with ComputeCpuTraits:
+//  - <FastMemory, OpenBusIo, Compute>          : z80::ComputeCpu
+// and the reference CPU of the lockstep checker (debugger/exec):
+//  - <ObservableMemory, ReplayIo>              : replays a candidate's I/O
+// and the embedding C API (capi/):
+//  - <FastMemory, PortTableIo>                 : libz80twin's machine
 template class CPUImpl<FastMemory, OpenBusIo>;
 template class CPUImpl<ObservableMemory, OpenBusIo>;
 template class CPUImpl<ObservableMemory, ObservableIo<LatchedIo>>;
 template class CPUImpl<ObservableMemory, ObservableIo<CallbackIo>>;
+template class CPUImpl<FastMemory, OpenBusIo, InstrumentedCpuTraits>;
+template class CPUImpl<ObservableMemory, ObservableIo<CallbackIo>, InstrumentedCpuTraits>;
+template class CPUImpl<FastMemory, OpenBusIo, ComputeCpuTraits>;
+template class CPUImpl<ObservableMemory, ReplayIo>;
+template class CPUImpl<FastMemory, PortTableIo>;
 
 } // namespace z80
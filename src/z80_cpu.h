@@ -10,7 +10,11 @@
 #include <cstdint>
 #include <vector>
 #include <array>
+#include <type_traits>
+#include <utility>
 
+#include "cpu_traits.h"
+#include "instruction_mix.h"
 #include "memory/fast_memory.h"
 #include "io/open_bus_io.h"
 
@@ -33,7 +37,7 @@ union RegisterPair {
 };
 
 // Forward declaration of the CPU class template.
-template <class Memory, class Io> class CPUImpl;
+template <class Memory, class Io, class Traits> class CPUImpl;
 
 /// @brief Z80 CPU execution states for prefix instruction handling
 enum class CPUState : uint8_t {
@@ -46,6 +50,10 @@ enum class CPUState : uint8_t {
     FD_CB_PREFIX = 6   ///< FD CB prefix sequence - IY bit operations with displacement
 };
 
+// The instrumented CPU files an instruction under the state it completed in.
+static_assert(static_cast<int>(OpcodeTable::ED) == static_cast<int>(CPUState::ED_PREFIX) &&
+              static_cast<int>(OpcodeTable::FDCB) == static_cast<int>(CPUState::FD_CB_PREFIX));
+
 // =============================================================================
 // Constants
 // =============================================================================
@@ -71,7 +79,7 @@ namespace Constants {
 // Z80 CPU Class
 // =============================================================================
 
-template <class Memory = FastMemory, class Io = OpenBusIo>
+template <class Memory = FastMemory, class Io = OpenBusIo, class Traits = DefaultCpuTraits>
 class CPUImpl {
 public:
     // -------------------------------------------------------------------------
@@ -86,7 +94,21 @@ public:
     
     /// @brief Executes Z80 instructions until the specified cycle count
     /// @param target_cycle The cycle count to run until
+    /// @details The bulk path: nothing observes the CPU between instructions,
+    ///          so hot idioms run as superinstructions (Traits::
+    ///          kSuperinstructions). The result — registers, R, clock, and
+    ///          where it stops, even mid-prefix — is exactly that of calling
+    ///          Step() while t < target_cycle and not halted.
     void RunUntilCycle(uint64_t target_cycle);
+
+    /// @brief RunUntilCycle() that also stops at an instruction boundary whose
+    ///        PC has its bit set in @p stop_pcs (65536 bits, 1024 words), before
+    ///        that instruction runs.
+    /// @details Every boundary is checked, so nothing runs fused. The
+    ///          instruction it starts at is not checked: a caller resuming
+    ///          from a stop moves on instead of stopping there again.
+    /// @return true if it stopped on such a PC.
+    bool RunUntilCycleOrPc(uint64_t target_cycle, const uint64_t* stop_pcs);
     
     /// @brief Executes a single instruction
     void Step();
@@ -99,7 +121,8 @@ public:
     ///            (Spectrum bus floats to 0xFF). Used by IM 0 (as an RST opcode)
     ///            and IM 2 (low byte of the vector).
     /// @return true if accepted. Accepted only when IFF1 is set and the CPU is
-    ///         not in the one-instruction shadow of an EI. On acceptance: clears
+    ///         not in the one-instruction shadow of an EI, and never without
+    ///         Traits::kInterrupts. On acceptance: clears
     ///         IFF1/IFF2, wakes HALT, pushes PC, and jumps per interrupt mode
     ///         (IM0: RST vector from `bus`; IM1: 0x0038; IM2: [I:bus] vector).
     bool Interrupt(uint8_t bus = 0xFF);
@@ -164,6 +187,12 @@ public:
 
     /// @brief Current interrupt mode (0, 1, or 2).
     uint8_t InterruptMode() const { return _interrupt_mode; }
+    void SetInterruptMode(uint8_t mode) { _interrupt_mode = mode; }
+
+    /// @brief Whether an EI just ran, so an interrupt is refused until after
+    ///        the next instruction. Exposed for machine snapshots.
+    bool InterruptShadow() const { return ei_defer_; }
+    void SetInterruptShadow(bool pending) { ei_defer_ = pending; }
     
     // -------------------------------------------------------------------------
     // Memory and I/O Access
@@ -210,6 +239,12 @@ public:
     /// @param cycles New cycle count value
     void SetCycleCount(uint64_t cycles) { t_cycle = cycles; }
 
+    /// @brief The dynamic instruction mix counted so far (instrumented
+    ///        configurations only; see InstrumentedCpuTraits). Never reset by
+    ///        Reset() — call Mix().Clear() to start a new measurement.
+    InstructionMix& Mix() noexcept requires Traits::kInstrumented { return mix_; }
+    const InstructionMix& Mix() const noexcept requires Traits::kInstrumented { return mix_; }
+
 private:
     // -------------------------------------------------------------------------
     // CPU State
@@ -256,19 +291,51 @@ private:
     // Memory and I/O (pluggable compile-time policies)
     Memory memory;   ///< Memory device (policy)
     Io io;           ///< I/O device (policy)
+
+    // Instrumentation (empty and sizeless unless Traits::kInstrumented)
+    [[no_unique_address]] std::conditional_t<Traits::kInstrumented, InstructionMix, NoInstructionMix> mix_;
     
     // -------------------------------------------------------------------------
     // Instruction Dispatch Tables
     // -------------------------------------------------------------------------
     /// @brief Pointer to a member function implementing one Z80 instruction.
     using InstructionHandler = void (CPUImpl::*)();
-    std::array<InstructionHandler, 256> basic_opcodes;     ///< Basic instruction set
-    std::array<InstructionHandler, 256> ED_opcodes;        ///< ED-prefixed instructions
+    struct InstructionTables {
+        std::array<InstructionHandler, 256> basic;   ///< Basic instruction set
+        std::array<InstructionHandler, 256> ed;      ///< ED-prefixed instructions
+    };
+    /// One constant copy per configuration, built at compile time: 8 KB that
+    /// every CPU of the configuration shares instead of owning.
+    static constexpr InstructionTables BuildInstructionTables();
+    static const InstructionTables kInstructionTables;
     
     // -------------------------------------------------------------------------
     // Instruction Implementation Helpers
     // -------------------------------------------------------------------------
-    void InitializeInstructionTables();
+
+    // Superinstructions (RunUntilCycle only). Kept out of line so the
+    // inliner still folds Step() into RunUntilCycle's loop.
+    [[gnu::noinline]] bool RunFused(uint8_t opcode, uint64_t target_cycle);
+    void RunFusedJr(uint64_t target_cycle);
+    /// @brief Step()'s M1 bookkeeping for an opcode byte a fused handler
+    ///        executes, its read included (a read counter sees it once, as
+    ///        with Step()). Deciding what to fuse peeks with Peek() instead.
+    void FetchM1() {
+        static_cast<void>(static_cast<uint8_t>(memory[_PC]));
+        ++_PC;
+        Refresh();
+    }
+    /// @brief A byte at @p address, read without counting as a CPU read.
+    [[nodiscard]] uint8_t Peek(uint16_t address) const { return std::as_const(memory)[address]; }
+    /// @brief One memory-refresh cycle: R's low 7 bits count, bit 7 is kept.
+    void Refresh() {
+        if constexpr (Traits::kTrackRefresh) R() = static_cast<uint8_t>((R() & 0x80u) | ((R() + 1u) & 0x7Fu));
+    }
+    /// @brief WZ as an instruction leaves it (Traits::kTrackMemptr).
+    void SetMemptr(uint16_t value) {
+        if constexpr (Traits::kTrackMemptr) _WZ.r16 = value;
+    }
+
     void SetCarryFlag(bool value);
     bool GetCarryFlag() const;
     uint8_t Flags_SZXY(uint8_t value) const;
@@ -697,6 +764,15 @@ private:
 ///          The debugger instantiates CPUImpl<ObservableMemory> instead.
 using CPU = CPUImpl<FastMemory>;
 
+/// @brief The production CPU with instruction-mix counting compiled in.
+/// @details Same behaviour and timing as z80::CPU; Mix() reports what ran.
+using InstrumentedCpu = CPUImpl<FastMemory, OpenBusIo, InstrumentedCpuTraits>;
+
+/// @brief The production CPU without R, WZ or interrupt bookkeeping.
+/// @details Same results and timing as z80::CPU for code that never reads R
+///          or WZ and takes no interrupts (ComputeCpuTraits).
+using ComputeCpu = CPUImpl<FastMemory, OpenBusIo, ComputeCpuTraits>;
+
 } // namespace z80
 
 #endif // Z80_CPU_H
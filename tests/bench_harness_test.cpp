@@ -0,0 +1,221 @@
+//
+// Z80 Digital Twin - benchmark harness verification
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// Checks the parts of tools/benchmark that decide what a number means,
+// without timing anything slow:
+//   1. summarize(): median, scaled MAD and the order-statistic CI on known data;
+//   2. ProgramWorkload counts instructions (not prefix bytes) and T-states
+//      exactly, on every configuration, and rejects programs that never HALT;
+//   3. a report survives write_json / read_json, and malformed files are
+//      rejected;
+//   4. compare() calls a change significant only past the threshold with
+//      disjoint confidence intervals, and lists added/removed workloads;
+//   5. hardware counters are read where perf is available, degrade to an
+//      explanation where it is not, and round-trip through JSON.
+//
+
+#include "bench_harness.h"
+#include "cpu_workload.h"
+
+#include <cmath>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+namespace bench = z80::bench;
+
+int failures = 0;
+void check(bool ok, const char* what) {
+    std::cout << (ok ? "  ✓ " : "  ✗ ") << what << '\n';
+    if (!ok) ++failures;
+}
+
+bool near(double a, double b) { return std::fabs(a - b) < 1e-9; }
+
+bench::Result fake(const char* workload, const char* config, double centre, double spread) {
+    bench::Result r;
+    r.workload = workload;
+    r.config = config;
+    r.per_rep = {1000, 4000};
+    r.reps = 10;
+    for (int i = 0; i < 20; ++i) r.ns_per_instr.push_back(centre + spread * ((i % 5) - 2));
+    r.stats = bench::summarize(r.ns_per_instr);
+    return r;
+}
+
+} // namespace
+
+int main() {
+    std::cout << "Benchmark harness\n=================\n";
+
+    // --- 1. Statistics ----------------------------------------------------------
+    std::cout << "\n[1] Median, MAD and confidence interval\n";
+    {
+        const bench::Stats odd = bench::summarize({5, 1, 4, 2, 3});
+        check(near(odd.median, 3) && near(odd.mad, 1.4826) && near(odd.ci_low, 1) && near(odd.ci_high, 5),
+              "5 samples: median 3, MAD 1.4826, CI = [min, max]");
+        const bench::Stats even = bench::summarize({4, 1, 3, 2});
+        check(near(even.median, 2.5), "even count: mean of the middle pair");
+
+        std::vector<double> v;
+        for (int i = 1; i <= 100; ++i) v.push_back(i);
+        v.push_back(1e6);   // one wild outlier
+        const bench::Stats s = bench::summarize(v);
+        check(near(s.median, 51), "outlier does not move the median");
+        check(s.mad < 40, "nor inflate the MAD");
+        check(s.ci_low >= 40 && s.ci_low < 51 && s.ci_high > 51 && s.ci_high <= 62,
+              "101 samples: 95% CI brackets the median by about ±sqrt(n)");
+        check(bench::summarize({}).n == 0, "no samples: empty summary");
+    }
+
+    // --- 2. Program workloads -------------------------------------------------------
+    std::cout << "\n[2] Work per rep is counted exactly on every configuration\n";
+    {
+        // LD B,10 / loop: BIT 0,B (CB prefix) / LD IX,0 (DD prefix) / DJNZ loop / HALT
+        const std::vector<uint8_t> program = {0x06, 0x0A, 0xCB, 0x40, 0xDD, 0x21,
+                                              0x00, 0x00, 0x10, 0xF8, 0x76};
+        // Instructions: 1 + 10 * 3 + 1; T-states: 7 + 10 * (8 + 14) + 9 * 13 + 8 + 4.
+        const uint64_t want_instr = 32;
+        const uint64_t want_t = 7 + 10 * 22 + 9 * 13 + 8 + 4;
+        int configs = 0;
+        bool exact = true;
+        bench::for_each_config([&]<class Cpu>(std::type_identity<Cpu>, const char*) {
+            ++configs;
+            bench::ProgramWorkload<Cpu> w(program);
+            const std::optional<bench::Work> work = w.count();
+            exact = exact && work && work->instructions == want_instr && work->tstates == want_t;
+        });
+        check(configs == 9, "nine configurations: the four policy stacks, two instrumented, ComputeCpu, "
+                           "ReplayIo and PortTableIo");
+        check(exact, "32 instructions, 356 T-states on each (prefixes are not instructions)");
+
+        bench::ProgramWorkload<z80::CPU> spin({0x18, 0xFE});   // JR $
+        check(!spin.count(10'000), "a program that never halts is rejected");
+
+        bench::Settings quick;
+        quick.samples = 7;
+        quick.min_sample_s = 0.0005;
+        quick.warmup_s = 0.001;
+        quick.max_warmup_s = 0.01;
+        std::string error;
+        const std::optional<bench::Result> r =
+            bench::measure_program<z80::CPU>("tiny", "null", program, quick, &error);
+        check(r && r->ns_per_instr.size() == 7 && r->stats.median > 0 && r->reps >= 1,
+              "measure_program: 7 samples, positive ns/instr");
+        check(r && near(r->tstates_per_sec(), 1e9 * 356.0 / (32.0 * r->stats.median)),
+              "T-states/sec follows from ns/instr and the per-rep ratio");
+    }
+
+    // --- 3. JSON -------------------------------------------------------------------
+    std::cout << "\n[3] Reports round-trip through JSON\n";
+    {
+        bench::Report report;
+        report.env = bench::capture_environment(false);
+        report.env.compiler = "test \"quoted\"\tcompiler";
+        report.results = {fake("fibonacci", "FastMemory/OpenBusIo", 3.0, 0.01),
+                          fake("bubble_sort", "ObservableMemory/OpenBusIo", 5.0, 0.02)};
+        std::ostringstream os;
+        bench::write_json(os, report);
+
+        bench::Report back;
+        std::string error;
+        check(bench::read_json(os.str(), back, &error), "written report reads back");
+        check(back.results.size() == 2 && back.results[1].workload == "bubble_sort" &&
+                  back.results[1].per_rep.tstates == 4000 && back.results[1].reps == 10,
+              "names, counts and reps preserved");
+        check(back.results[0].ns_per_instr == report.results[0].ns_per_instr &&
+                  near(back.results[0].stats.median, report.results[0].stats.median),
+              "samples preserved exactly; statistics recomputed");
+        check(back.env.compiler == report.env.compiler && back.env.version == report.env.version,
+              "escaped strings survive");
+
+        check(!bench::read_json("{\"schema\": \"other\", \"results\": []}", back, &error),
+              "foreign schema rejected");
+        check(!bench::read_json("{\"schema\": \"z80twin-bench-1\", \"results\": [", back, &error),
+              "truncated file rejected");
+        check(back.results.size() == 2, "a failed read leaves the report unchanged");
+    }
+
+    // --- 4. Comparison ---------------------------------------------------------------
+    std::cout << "\n[4] Comparison verdicts\n";
+    {
+        bench::Report base;
+        base.results = {fake("a", "cfg", 10.0, 0.01), fake("b", "cfg", 10.0, 0.01),
+                        fake("c", "cfg", 10.0, 0.01), fake("d", "cfg", 10.0, 2.0),
+                        fake("gone", "cfg", 1.0, 0.01)};
+        bench::Report now;
+        now.results = {fake("a", "cfg", 11.0, 0.01),    // +10%, tight: slower
+                       fake("b", "cfg", 9.0, 0.01),     // -10%, tight: faster
+                       fake("c", "cfg", 10.2, 0.01),    // +2%: under threshold
+                       fake("d", "cfg", 11.0, 2.0),     // +10%, overlapping CIs
+                       fake("new", "cfg", 1.0, 0.01)};
+        const std::vector<bench::Comparison> rows = bench::compare(base, now, 3.0);
+        const auto verdict = [&](const char* w) {
+            for (const bench::Comparison& c : rows)
+                if (c.workload == w) return c.verdict;
+            return bench::Verdict::Same;
+        };
+        check(verdict("a") == bench::Verdict::Slower, "clear slowdown: SLOWER");
+        check(verdict("b") == bench::Verdict::Faster, "clear speed-up: faster");
+        check(verdict("c") == bench::Verdict::Same, "change under the threshold: same");
+        check(verdict("d") == bench::Verdict::Same, "noisy runs with overlapping CIs: same");
+        check(verdict("gone") == bench::Verdict::OnlyInBase && verdict("new") == bench::Verdict::OnlyInCurrent,
+              "removed and new workloads listed");
+        check(rows.size() == 6, "every workload from both reports appears once");
+    }
+
+    // --- 5. Hardware counters ------------------------------------------------------
+    std::cout << "\n[5] perf_event counters, or a reason why not\n";
+    {
+        bench::PerfCounters perf;
+        std::cout << "    " << perf.describe() << '\n';
+        check(perf.available() || !perf.reason().empty(), "either counters open or the reason is given");
+
+        bench::Settings quick;
+        quick.samples = 5;
+        quick.min_sample_s = 0.0005;
+        quick.warmup_s = 0.001;
+        quick.max_warmup_s = 0.01;
+        const std::vector<uint8_t> program = {0x06, 0x00, 0x10, 0xFE, 0x76};   // LD B,0 / DJNZ $ / HALT
+        const std::optional<bench::Result> r =
+            bench::measure_program<z80::CPU>("djnz", "null", program, quick, nullptr, false, &perf);
+        if (perf.available()) {
+            const bench::CounterRate* cycles = r ? r->counter("cycles") : nullptr;
+            check(!cycles || (cycles->per_instr > 0 && cycles->per_tstate > 0),
+                  "host cycles per emulated instruction and T-state are positive");
+            check(r && !r->counters.empty(), "counters attached to the result");
+        } else {
+            check(r && r->counters.empty() && r->stats.median > 0, "no counters: wall time still measured");
+        }
+
+        bench::Report report;
+        report.env.perf = perf.describe();
+        report.results = {fake("a", "cfg", 10.0, 0.01)};
+        report.results[0].counters = {{"cycles", 42.5, 3.5}, {"instructions", 120.0, 10.0}};
+        std::ostringstream os;
+        bench::write_json(os, report);
+        bench::Report back;
+        check(bench::read_json(os.str(), back) && back.env.perf == report.env.perf &&
+                  back.results[0].counters.size() == 2 && back.results[0].counter("cycles") &&
+                  near(back.results[0].counter("cycles")->per_tstate, 3.5),
+              "counters round-trip through JSON");
+        std::ostringstream table;
+        bench::print_counters(table, back.results);
+        check(table.str().find("2.82") != std::string::npos, "counter table shows IPC (120 / 42.5)");
+    }
+
+    std::cout << "\n=================\n";
+    if (failures == 0) {
+        std::cout << "✅ ALL BENCHMARK-HARNESS CHECKS PASSED\n";
+        return 0;
+    }
+    std::cout << "❌ " << failures << " check(s) FAILED\n";
+    return 1;
+}
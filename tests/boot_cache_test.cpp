@@ -0,0 +1,198 @@
+//
+// Z80 Digital Twin - ZX Spectrum boot snapshot cache verification
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// Verifies the post-boot snapshot cache without the copyrighted ROM: a
+// stand-in ROM "boots" (fills 48 KB of RAM, then idles under IM 1 counting
+// frames), and
+//   1. the first boot is cold and saved, the second is restored, and the
+//      restored machine is state-hash identical to a cold boot — then and on
+//      every later frame;
+//   2. MachineState survives a save/load round trip and rejects damage, and a
+//      damaged cache entry falls back to a cold boot and is rewritten;
+//   3. the key moves with the ROM, the frame count and ROM write protection,
+//      and a new entry evicts stale ones;
+//   4. a cache hit is a small fraction of a cold boot.
+//
+
+#include "spectrum/boot_cache.h"
+#include "spectrum_stand_in_rom.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+namespace sm = z80::machine::spectrum;
+namespace fs = std::filesystem;
+namespace zt = z80::test;
+
+int failures = 0;
+void check(bool ok, const char* what) {
+    std::cout << (ok ? "  ✓ " : "  ✗ ") << what << '\n';
+    if (!ok) ++failures;
+}
+
+// Stand-in ROM (spectrum_stand_in_rom.h) that fills RAM before settling:
+//   0x0000  LD HL,0x4000 / LD DE,0x4001 / LD BC,0xBFFF / LD (HL),0x24 / LDIR
+//   0x000D  DI / LD SP,0x8000 / IM 1 / EI
+//   0x0014  LD HL,(0x9002) / INC HL / LD (0x9002),HL / LD A,L / OUT (0xFE),A / JR 0x0014
+std::vector<uint8_t> test_rom() {
+    const std::vector<uint8_t> fill = {0x21, 0x00, 0x40, 0x11, 0x01, 0x40, 0x01,
+                                       0xFF, 0xBF, 0x36, 0x24, 0xED, 0xB0};
+    return zt::stand_in_rom({fill, zt::kStartIm1, zt::forever({zt::kBumpCounter, zt::kBorderFromL})});
+}
+
+constexpr uint32_t kBootFrames = 60;
+
+std::vector<uint8_t> read_file(const std::string& path) {
+    std::ifstream f(path, std::ios::binary);
+    return std::vector<uint8_t>((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+}
+
+void write_file(const std::string& path, const std::vector<uint8_t>& bytes) {
+    std::ofstream f(path, std::ios::binary);
+    f.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+}
+
+} // namespace
+
+int main() {
+    std::cout << "Boot snapshot cache\n===================\n";
+
+    const fs::path dir = fs::temp_directory_path() /
+                         ("z80twin-boot-cache-test-" +
+                          std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+    fs::remove_all(dir);
+    sm::BootCache cache(dir.string());
+    const std::vector<uint8_t> rom = test_rom();
+
+    sm::SpectrumMachine reference;
+    reference.load_rom(rom);
+    for (uint32_t i = 0; i < kBootFrames; ++i) reference.run_frame();
+
+    // --- 1. Miss, then hit ------------------------------------------------------
+    std::cout << "\n[1] First boot is cold and saved; the next is restored, identically\n";
+    {
+        sm::SpectrumMachine cold;
+        cold.load_rom(rom);
+        check(!cache.boot(cold, rom, kBootFrames), "empty cache: cold boot");
+        const std::string path = cache.path(rom, kBootFrames, sm::BootCache::key(cold, rom, kBootFrames));
+        check(fs::exists(path), "entry written");
+        check(sm::state_hash(cold) == sm::state_hash(reference), "cold boot through the cache == plain boot");
+
+        sm::SpectrumMachine warm;
+        warm.load_rom(rom);
+        check(cache.boot(warm, rom, kBootFrames), "second boot: cache hit");
+        check(sm::state_hash(warm) == sm::state_hash(reference), "restored state hash == cold boot");
+        check(warm.frame_count() == kBootFrames && warm.cpu().ReadMemory(0xC000) == 0x24,
+              "frame counter and RAM restored");
+
+        bool same = true;
+        for (int f = 0; f < 50; ++f) {
+            reference.run_frame();
+            warm.run_frame();
+            same = same && sm::state_hash(warm) == sm::state_hash(reference);
+        }
+        check(same, "and stays identical for 50 more frames");
+    }
+
+    // --- 2. Damage ------------------------------------------------------------------
+    std::cout << "\n[2] Snapshot round trip; damaged files are rejected\n";
+    {
+        sm::MachineState state = sm::MachineState::capture(reference);
+        state.tag = 0x1234;
+        const std::vector<uint8_t> bytes = state.save();
+        sm::MachineState back;
+        std::string why;
+        check(back.load(bytes, &why) && back.save() == bytes && back.tag == 0x1234,
+              "round trip is byte-identical");
+
+        std::vector<uint8_t> bad = bytes;
+        bad[bad.size() / 2] ^= 0x01;
+        check(!back.load(bad, &why) && why == "checksum mismatch", "flipped bit detected");
+        bad.assign(bytes.begin(), bytes.end() - 100);
+        check(!back.load(bad, &why) && why == "wrong size", "truncation detected");
+        check(!back.load(std::vector<uint8_t>{'N', 'O', 'P', 'E'}, &why) && why == "not a snapshot file",
+              "foreign file rejected");
+        check(back.tag == 0x1234, "a failed load leaves the state unchanged");
+
+        sm::SpectrumMachine probe;
+        probe.load_rom(rom);
+        const std::string path = cache.path(rom, kBootFrames, sm::BootCache::key(probe, rom, kBootFrames));
+        std::vector<uint8_t> entry = read_file(path);
+        entry[entry.size() - 10] ^= 0xFF;
+        write_file(path, entry);
+        sm::SpectrumMachine m;
+        m.load_rom(rom);
+        check(!cache.boot(m, rom, kBootFrames), "corrupt entry: falls back to a cold boot");
+        sm::SpectrumMachine again;
+        again.load_rom(rom);
+        check(cache.boot(again, rom, kBootFrames) && sm::state_hash(again) == sm::state_hash(m),
+              "entry rewritten and hit next time");
+    }
+
+    // --- 3. Keying ------------------------------------------------------------------
+    std::cout << "\n[3] Key covers ROM, frame count and write protection; stale entries go\n";
+    {
+        sm::SpectrumMachine m;
+        m.load_rom(rom);
+        const uint64_t base = sm::BootCache::key(m, rom, kBootFrames);
+        check(sm::BootCache::key(m, rom, kBootFrames + 1) != base, "frame count");
+        std::vector<uint8_t> other = rom;
+        other[0x20] = 0xAA;
+        check(sm::BootCache::key(m, other, kBootFrames) != base, "ROM image");
+        m.set_rom_write_protect(true);
+        check(sm::BootCache::key(m, rom, kBootFrames) != base, "ROM write protection");
+        check(sm::BootCache::core_fingerprint() != 0 &&
+                  sm::BootCache::core_fingerprint() == sm::BootCache::core_fingerprint(),
+              "core fingerprint is stable within a run");
+
+        // An entry under an old key (as if written by an older core) is evicted
+        // when the current key's entry is written.
+        const std::string stale = cache.path(rom, kBootFrames, 0);
+        write_file(stale, {0x00});
+        fs::remove(cache.path(rom, kBootFrames, base));
+        sm::SpectrumMachine n;
+        n.load_rom(rom);
+        check(!cache.boot(n, rom, kBootFrames), "missing entry: cold boot");
+        check(!fs::exists(stale) && fs::exists(cache.path(rom, kBootFrames, base)),
+              "stale entry for the same ROM and frame count removed");
+    }
+
+    // --- 4. Cost --------------------------------------------------------------------
+    std::cout << "\n[4] Cache hit vs cold boot\n";
+    {
+        auto t0 = std::chrono::steady_clock::now();
+        sm::SpectrumMachine cold;
+        cold.load_rom(rom);
+        for (uint32_t i = 0; i < kBootFrames; ++i) cold.run_frame();
+        const double cold_us = std::chrono::duration<double, std::micro>(
+                                   std::chrono::steady_clock::now() - t0).count();
+        t0 = std::chrono::steady_clock::now();
+        sm::SpectrumMachine warm;
+        warm.load_rom(rom);
+        const bool hit = cache.boot(warm, rom, kBootFrames);
+        const double warm_us = std::chrono::duration<double, std::micro>(
+                                   std::chrono::steady_clock::now() - t0).count();
+        std::cout << "    cold " << cold_us << " us, cached " << warm_us << " us\n";
+        check(hit && warm_us * 10 < cold_us, "a hit costs under a tenth of a cold boot");
+    }
+
+    fs::remove_all(dir);
+
+    std::cout << "\n===================\n";
+    if (failures == 0) {
+        std::cout << "✅ ALL BOOT-CACHE CHECKS PASSED\n";
+        return 0;
+    }
+    std::cout << "❌ " << failures << " check(s) FAILED\n";
+    return 1;
+}
@@ -0,0 +1,310 @@
+//
+// Z80 Digital Twin Debugger - CodeClassifier tests
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// Verifies the code/data classifier: recursive-descent tracing from entries
+// and coverage, data shapes (pointer tables, text, fill, Spectrum screen),
+// auto-labels, incremental re-classification (which redoes only the chunks
+// around a change, yet ends where a fresh pass would), and that the
+// region-parallel sweep gives the same map for any thread count.
+//
+
+#include "code_classifier.h"
+#include "debug_session.h"
+#include "symbol_table.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+using namespace z80;
+using namespace z80::dbg;
+
+int failures = 0;
+void check(bool ok, const char* what) {
+    std::cout << (ok ? "  ✓ " : "  ✗ ") << what << '\n';
+    if (!ok) ++failures;
+}
+
+void put(std::vector<uint8_t>& m, uint16_t at, std::initializer_list<uint8_t> bytes) {
+    for (uint8_t b : bytes) m[at++] = b;
+}
+
+// Image:
+//   0x8000  21 00 90     LD HL, 0x9000
+//   0x8003  CD 00 81     CALL 0x8100
+//   0x8006  18 FE        JR 0x8006           ; spin
+//   0x8100  3E 41        LD A, 'A'
+//   0x8102  C9           RET
+//   0x8200  C3 00 83     JP 0x8300           ; not reachable by static flow
+//   0x8300  C9           RET
+//   0x9000  00 80 00 81 06 80                ; table -> 0x8000, 0x8100, 0x8006
+//   0x9010  "HELLO WORLD" + ('!' | 0x80)     ; bit-7 terminated string
+//   0xA000  256 x 0xE5                       ; fill
+std::vector<uint8_t> make_image() {
+    std::vector<uint8_t> m(65536, 0x00);
+    put(m, 0x8000, {0x21, 0x00, 0x90, 0xCD, 0x00, 0x81, 0x18, 0xFE});
+    put(m, 0x8100, {0x3E, 0x41, 0xC9});
+    put(m, 0x8200, {0xC3, 0x00, 0x83});
+    put(m, 0x8300, {0xC9});
+    put(m, 0x9000, {0x00, 0x80, 0x00, 0x81, 0x06, 0x80});
+    const char* text = "HELLO WORLD";
+    uint16_t a = 0x9010;
+    for (const char* p = text; *p; ++p) m[a++] = static_cast<uint8_t>(*p);
+    m[a] = '!' | 0x80;
+    for (uint32_t i = 0; i < 256; ++i) m[0xA000 + i] = 0xE5;
+    return m;
+}
+
+} // namespace
+
+int main() {
+    std::cout << "CodeClassifier tests\n====================\n";
+
+    // --- Static trace + data shapes -----------------------------------------
+    std::cout << "\n[1] Recursive descent from an entry point, data shapes\n";
+    {
+        const std::vector<uint8_t> image = make_image();
+        CodeClassifier c;
+        c.SetImage(image);
+        c.AddEntry(0x8000);
+        check(c.Classify(), "first Classify() runs");
+        check(c.LastStats().full, "first pass is a full trace");
+
+        check(c.ClassAt(0x8000) == ByteClass::Code && c.ClassAt(0x8007) == ByteClass::Code,
+              "entry block is code");
+        check(c.IsInstructionStart(0x8003) && !c.IsInstructionStart(0x8004),
+              "instruction starts recorded");
+        check(c.ClassAt(0x8102) == ByteClass::Code, "CALL target traced");
+        check(c.ConfidenceAt(0x8100) == 80, "static-only code scored 80");
+        check(c.ClassAt(0x8200) != ByteClass::Code, "unreached code not claimed");
+        check(c.ClassAt(0x9000) == ByteClass::PointerTable &&
+              c.ClassAt(0x9005) == ByteClass::PointerTable, "pointer table found");
+        check(c.ClassAt(0x9010) == ByteClass::Text && c.ClassAt(0x901B) == ByteClass::Text,
+              "text run includes its bit-7 terminator");
+        check(c.ClassAt(0xA080) == ByteClass::Data, "fill run is data");
+        check(c.ClassAt(0x4000) == ByteClass::Screen && c.ClassAt(0x5800) == ByteClass::Attributes,
+              "Spectrum screen / attributes");
+    }
+
+    // --- Auto-labels ----------------------------------------------------------
+    std::cout << "\n[2] Auto-labels into the SymbolTable\n";
+    {
+        const std::vector<uint8_t> image = make_image();
+        CodeClassifier c;
+        c.SetImage(image);
+        c.AddEntry(0x8000);
+        c.Classify();
+
+        SymbolTable t;
+        t.DefineLabel(0x8006, "SPIN");
+        const std::size_t added = c.ApplyLabels(t);
+        check(t.Resolve("SUB_8100") == std::optional<uint16_t>(0x8100), "SUB_8100 for the call target");
+        check(t.Lookup(0x8100)->type == SymbolType::Function, "call target typed Function");
+        check(t.ResolveName(0x8006) == std::optional<std::string>("SPIN"), "existing symbol kept");
+        auto tbl = t.Lookup(0x9000);
+        check(tbl && tbl->name == "TBL_9000" && tbl->size == 6, "TBL_9000 spans 6 bytes");
+        auto str = t.Lookup(0x9010);
+        check(str && str->name == "STR_9010" && str->size == 12, "STR_9010 spans 12 bytes");
+        check(added == 3, "3 labels added");
+        check(c.ApplyLabels(t) == 0, "re-applying adds nothing");
+    }
+
+    // --- Incremental updates --------------------------------------------------
+    std::cout << "\n[3] Incremental re-classification\n";
+    {
+        std::vector<uint8_t> image = make_image();
+        CodeClassifier c;
+        c.SetImage(image);
+        c.AddEntry(0x8000);
+        c.Classify();
+        check(!c.Classify(), "no new inputs -> no pass");
+
+        std::vector<uint8_t> coverage(65536, 0);
+        coverage[0x8200] = kExecOpcode;
+        coverage[0x8201] = coverage[0x8202] = kExecOperand;
+        c.SetCoverage(coverage);
+        check(c.Classify() && !c.LastStats().full, "new coverage -> incremental pass");
+        check(c.ClassAt(0x8200) == ByteClass::Code && c.ConfidenceAt(0x8200) == 100,
+              "executed bytes are code at 100");
+        check(c.ClassAt(0x8300) == ByteClass::Code, "traced on from the new coverage");
+        check(c.LastStats().traced_instructions == 2, "only the new path was decoded");
+
+        image[0xB000] = 0x12;   // data-only change
+        c.SetImage(image);
+        check(c.Classify() && !c.LastStats().full, "data write -> no re-trace");
+        check(c.LastStats().rescanned_bytes <= 3 * 1024, "data write -> only the chunks around it re-scanned");
+        image[0x8101] = 0x42;   // under code
+        c.SetImage(image);
+        check(c.Classify() && c.LastStats().full, "write under code -> full re-trace");
+    }
+
+    // --- Thread-count independence + live session -----------------------------
+    std::cout << "\n[4] Region-parallel sweep is deterministic\n";
+    {
+        // Pseudo-random image: lots of ambiguous bytes and cross-region flow.
+        std::vector<uint8_t> image(65536);
+        uint32_t x = 0x12345678u;
+        for (uint8_t& b : image) { x = x * 1664525u + 1013904223u; b = static_cast<uint8_t>(x >> 24); }
+
+        auto regions_for = [&](unsigned threads, double* ms) {
+            CodeClassifier c(CodeClassifier::Options{.threads = threads});
+            c.SetImage(image);
+            for (uint32_t a = 0; a < 65536; a += 4096) c.AddEntry(static_cast<uint16_t>(a));
+            const auto t0 = std::chrono::steady_clock::now();
+            c.Classify();
+            *ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+            return c.Regions();
+        };
+        double ms1 = 0, ms4 = 0;
+        const auto one = regions_for(1, &ms1);
+        const auto four = regions_for(4, &ms4);
+        bool same = one.size() == four.size();
+        for (std::size_t i = 0; same && i < one.size(); ++i)
+            same = one[i].start == four[i].start && one[i].end == four[i].end &&
+                   one[i].cls == four[i].cls && one[i].confidence == four[i].confidence;
+        check(same, "1 thread and 4 threads give identical maps");
+        std::cout << "    full 64K pass: " << ms1 << " ms (1 thread), " << ms4 << " ms (4 threads)\n";
+
+        DebugCPU cpu;
+        const std::vector<uint8_t> program = make_image();
+        cpu.LoadProgram(std::vector<uint8_t>(program.begin() + 0x8000, program.end()), 0x8000);
+        cpu.PC() = 0x8000;
+        cpu.SP() = 0xF000;
+        DebugSession s(cpu);
+        for (int i = 0; i < 8; ++i) s.StepInstruction();
+        CodeClassifier c;
+        c.Observe(s);
+        c.Classify();
+        check(c.ConfidenceAt(0x8100) == 100, "Observe(): executed routine at 100");
+        SymbolTable t;
+        c.ApplyLabels(t);
+        check(t.Resolve("SUB_8100").has_value(), "Observe(): CFG call entry labelled");
+    }
+
+    // --- Incremental passes end where a fresh one would ---------------------------
+    std::cout << "\n[5] Incremental passes match a fresh classification\n";
+    {
+        std::vector<uint8_t> image(65536);
+        uint32_t x = 0x9E3779B9u;
+        auto next = [&x] { x = x * 1664525u + 1013904223u; return x; };
+        for (uint8_t& b : image) b = static_cast<uint8_t>(next() >> 24);
+        std::vector<uint8_t> coverage(65536, 0);
+        std::vector<uint16_t> entries;
+        for (uint32_t a = 0; a < 65536; a += 4096) entries.push_back(static_cast<uint16_t>(a));
+        // Each entry jumps into 0xFF fill, where the trace stops; code written
+        // there later must be picked up by the pass after the write.
+        std::vector<uint16_t> stopped;
+        for (uint16_t e : entries) {
+            const auto t = static_cast<uint16_t>(e + 0x800);
+            put(image, e, {0xC3, static_cast<uint8_t>(t), static_cast<uint8_t>(t >> 8)});
+            for (uint32_t i = 0; i < 16; ++i) image[t + i] = 0xFF;
+            stopped.push_back(t);
+        }
+
+        CodeClassifier c(CodeClassifier::Options{.threads = 4});
+        c.SetImage(image);
+        for (uint16_t e : entries) c.AddEntry(e);
+        c.Classify();
+
+        auto matches_fresh = [&] {
+            CodeClassifier fresh(CodeClassifier::Options{.threads = 1});
+            fresh.SetImage(image);
+            fresh.SetCoverage(coverage);
+            for (uint16_t e : entries) fresh.AddEntry(e);
+            fresh.Classify();
+            const auto want = fresh.Regions();
+            const auto got = c.Regions();
+            bool same = want.size() == got.size();
+            for (std::size_t i = 0; same && i < want.size(); ++i)
+                same = want[i].start == got[i].start && want[i].end == got[i].end && want[i].cls == got[i].cls &&
+                       want[i].confidence == got[i].confidence;
+            return same;
+        };
+
+        // What a debugger feeds it between passes: arbitrary writes, code
+        // written where a trace stopped, new coverage, new entry points.
+        uint32_t most = 0;
+        int mismatched = 0;
+        double ms = 0;
+        for (int round = 0; round < 60; ++round) {
+            const auto a = static_cast<uint16_t>(next() >> 16);
+            switch (round % 4) {
+                case 0:
+                    image[a] = static_cast<uint8_t>(next() >> 24);
+                    c.SetImage(image);
+                    break;
+                case 1: {
+                    const uint16_t t = stopped[(round / 4) % stopped.size()];
+                    put(image, t, {0x3E, static_cast<uint8_t>(next() >> 24), 0xC9});
+                    c.SetImage(image);
+                    break;
+                }
+                case 2:
+                    coverage[a] = kExecOpcode;
+                    c.SetCoverage(coverage);
+                    break;
+                default:
+                    entries.push_back(a);
+                    c.AddEntry(a);
+                    break;
+            }
+            const auto t0 = std::chrono::steady_clock::now();
+            c.Classify();
+            ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+            const auto& st = c.LastStats();
+            if (round % 4 == 0 && !st.full && st.traced_instructions == 0) most = std::max(most, st.rescanned_bytes);
+            if (!matches_fresh()) ++mismatched;
+        }
+        check(mismatched == 0, "each of 60 incremental passes gives the map a fresh pass gives");
+        std::cout << "    incremental pass: " << ms / 60 << " ms on average\n";
+        check(most > 0 && most <= 3 * 1024, "a data write off code re-scans at most 3 KB");
+
+        // Code written at a branch target the first trace stopped at.
+        std::vector<uint8_t> z(65536, 0x00);
+        put(z, 0x8000, {0xC3, 0x00, 0x90});
+        CodeClassifier e;
+        e.SetImage(z);
+        e.AddEntry(0x8000);
+        e.Classify();
+        check(e.ClassAt(0x9000) != ByteClass::Code, "a jump into zeroed RAM stops the trace");
+        put(z, 0x9000, {0x3E, 0x41, 0xC9});
+        e.SetImage(z);
+        e.Classify();
+        check(!e.LastStats().full && e.ClassAt(0x9000) == ByteClass::Code && e.ClassAt(0x9002) == ByteClass::Code,
+              "code written at the stopped target is traced without a full pass");
+
+        // Runs across chunks: a fill cut short on the far side of a boundary,
+        // and a 3 KB table of one pointer whose only distinct word goes.
+        std::vector<uint8_t> m = make_image();
+        for (uint32_t b = 0xC3FC; b < 0xC406; ++b) m[b] = 0xE5;
+        for (uint32_t b = 0xD000; b < 0xDC00; b += 2) put(m, static_cast<uint16_t>(b), {0x00, 0x80});
+        put(m, 0xDC00, {0x00, 0x81});
+        CodeClassifier d;
+        d.SetImage(m);
+        d.AddEntry(0x8000);
+        d.Classify();
+        check(d.ClassAt(0xC3FC) == ByteClass::Data && d.ClassAt(0xD000) == ByteClass::PointerTable,
+              "a fill and a table that cross chunk boundaries");
+        m[0xC401] = 0xFF;
+        put(m, 0xDC00, {0x00, 0x80});
+        d.SetImage(m);
+        d.Classify();
+        check(!d.LastStats().full && d.ClassAt(0xC3FC) == ByteClass::Unknown,
+              "cutting the fill redoes the chunk before the write");
+        check(d.ClassAt(0xD000) != ByteClass::PointerTable, "losing the distinct word redoes the whole table");
+    }
+
+    std::cout << "\n====================\n";
+    if (failures == 0) {
+        std::cout << "✅ ALL CODE-CLASSIFIER CHECKS PASSED\n";
+        return 0;
+    }
+    std::cout << "❌ " << failures << " check(s) FAILED\n";
+    return 1;
+}
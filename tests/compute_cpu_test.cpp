@@ -0,0 +1,181 @@
+//
+// Z80 Digital Twin - compute CPU (ComputeCpuTraits) verification
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// z80::ComputeCpu drops the bookkeeping pure computation never looks at: R,
+// WZ (MEMPTR) and the interrupt machinery. Checks that
+//   1. everything else — registers, flags, memory, T-states — matches
+//      z80::CPU on each program, by Step() and by RunUntilCycle();
+//   2. R keeps the value last loaded and WZ is never written;
+//   3. interrupts are refused and EI leaves no shadow, but sets IFF1/IFF2;
+//   4. the default traits still do all three.
+//
+
+#include "z80_cpu.h"
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using z80::ComputeCpu;
+using z80::CPU;
+
+int failures = 0;
+void check(bool ok, const std::string& what) {
+    std::cout << (ok ? "  ✓ " : "  ✗ ") << what << '\n';
+    if (!ok) ++failures;
+}
+
+struct Program {
+    const char* name;
+    std::vector<uint8_t> bytes;
+};
+
+// Each program ends in HALT. Data and stack live at 8000h and above.
+const std::vector<Program> kPrograms = {
+    {"GCD(1071, 462) by subtraction",
+     {0x21, 0x2F, 0x04,        // LD HL,1071
+      0x11, 0xCE, 0x01,        // LD DE,462
+      0xB7, 0xED, 0x52,        // loop: OR A / SBC HL,DE
+      0x28, 0x06,              // JR Z,done
+      0x30, 0xF9,              // JR NC,loop
+      0x19, 0xEB,              // ADD HL,DE / EX DE,HL
+      0x18, 0xF5,              // JR loop
+      0x19,                    // done: ADD HL,DE
+      0x22, 0x00, 0x80,        // LD (8000h),HL
+      0x76}},
+    {"DJNZ sum, (nn) loads and stores, CALL/RET",
+     {0x31, 0x00, 0x90,        // LD SP,9000h
+      0x06, 0x20, 0xAF,        // LD B,32 / XOR A
+      0x80, 0x10, 0xFD,        // loop: ADD A,B / DJNZ loop
+      0x32, 0x10, 0x80,        // LD (8010h),A
+      0xCD, 0x13, 0x00,        // CALL sub
+      0x76,                    // HALT
+      0x00, 0x00, 0x00,
+      0x3A, 0x10, 0x80,        // sub: LD A,(8010h)
+      0x2F, 0x12, 0xC9}},      // CPL / LD (DE),A / RET
+    {"LDIR, indexed and DDCB operations",
+     {0x21, 0x00, 0x00,        // LD HL,0
+      0x11, 0x00, 0x81,        // LD DE,8100h
+      0x01, 0x20, 0x00,        // LD BC,32
+      0xED, 0xB0,              // LDIR
+      0xDD, 0x21, 0x00, 0x81,  // LD IX,8100h
+      0xDD, 0x7E, 0x03,        // LD A,(IX+3)
+      0xDD, 0xCB, 0x05, 0x06,  // RLC (IX+5)
+      0xFD, 0x21, 0x10, 0x81,  // LD IY,8110h
+      0xFD, 0xCB, 0xFF, 0x46,  // BIT 0,(IY-1)
+      0xFD, 0x86, 0x02,        // ADD A,(IY+2)
+      0xED, 0x44,              // NEG
+      0x76}},
+};
+
+/// Everything ComputeCpu promises to keep: not R, not WZ, not the EI shadow.
+struct Snapshot {
+    uint64_t t;
+    uint16_t pc, sp, af, bc, de, hl, ix, iy, af2, bc2, de2, hl2;
+    uint8_t i;
+    bool iff1, iff2, halted;
+    uint32_t memory_sum;
+
+    bool operator==(const Snapshot&) const = default;
+};
+
+template <class Cpu>
+Snapshot snap(Cpu& c) {
+    uint32_t sum = 0;
+    for (uint32_t a = 0; a < 0x10000; ++a) sum = sum * 31u + c.ReadMemory(static_cast<uint16_t>(a));
+    return {c.GetCycleCount(), c.PC(), c.SP(), c.AF(), c.BC(), c.DE(), c.HL(), c.IX(), c.IY(), c.AltAF(),
+            c.AltBC(), c.AltDE(), c.AltHL(), c.I(), c.IFF1(), c.IFF2(), c.IsHalted(), sum};
+}
+
+template <class Cpu>
+void load(Cpu& c, const std::vector<uint8_t>& bytes) {
+    c.Reset();
+    c.LoadProgram(bytes, 0x0000);
+}
+
+template <class Cpu>
+void step_to_halt(Cpu& c) {
+    for (int n = 0; n < 1'000'000 && !c.IsHalted(); ++n) c.Step();
+}
+
+} // namespace
+
+int main() {
+    std::cout << "Compute CPU\n===========\n";
+
+    std::cout << "\n[1] Same registers, memory and T-states as z80::CPU\n";
+    for (const Program& p : kPrograms) {
+        CPU full;
+        ComputeCpu compute;
+        load(full, p.bytes);
+        load(compute, p.bytes);
+        step_to_halt(full);
+        step_to_halt(compute);
+        check(compute.IsHalted() && snap(compute) == snap(full), std::string(p.name) + " (Step)");
+
+        ComputeCpu bulk;
+        load(bulk, p.bytes);
+        bulk.RunUntilCycle(10'000'000);
+        check(snap(bulk) == snap(full), std::string(p.name) + " (RunUntilCycle)");
+    }
+    {
+        CPU full;
+        load(full, kPrograms[0].bytes);
+        step_to_halt(full);
+        check(full.ReadMemory(0x8000) == 21 && full.ReadMemory(0x8001) == 0, "and the GCD is 21");
+    }
+
+    std::cout << "\n[2] R and WZ are left alone\n";
+    {
+        ComputeCpu c;
+        load(c, kPrograms[1].bytes);
+        c.R() = 0x85;
+        c.WZ() = 0x1234;
+        step_to_halt(c);
+        check(c.R() == 0x85 && c.WZ() == 0x1234, "after a DJNZ loop, a CALL and (nn) accesses");
+
+        load(c, {0x3E, 0x4A, 0xED, 0x4F, 0x00, 0xED, 0x5F, 0x76});   // LD A,4Ah / LD R,A / NOP / LD A,R
+        step_to_halt(c);
+        check(c.R() == 0x4A && c.A() == 0x4A, "LD R,A still loads R; LD A,R reads it back unchanged");
+    }
+
+    std::cout << "\n[3] No interrupts\n";
+    {
+        ComputeCpu c;
+        load(c, {0xFB, 0x00, 0x76});   // EI / NOP / HALT
+        c.Step();
+        check(c.IFF1() && c.IFF2() && !c.InterruptShadow(), "EI sets IFF1/IFF2 and no shadow");
+        step_to_halt(c);
+        check(!c.Interrupt() && c.IsHalted() && c.PC() == 3, "Interrupt() refused with IFF1 set; HALT stays");
+    }
+
+    std::cout << "\n[4] The default traits keep all three\n";
+    {
+        CPU c;
+        load(c, kPrograms[1].bytes);
+        c.R() = 0x85;
+        c.WZ() = 0x1234;
+        step_to_halt(c);
+        check(c.R() != 0x85 && (c.R() & 0x80) && c.WZ() != 0x1234, "R counts (bit 7 kept) and WZ is set");
+
+        load(c, {0xFB, 0x00, 0x76});
+        c.Step();
+        check(c.InterruptShadow() && !c.Interrupt(), "EI shadow refuses the interrupt");
+        c.Step();
+        check(c.Interrupt() && c.PC() == 0x0038, "and it is accepted one instruction later");
+        check(sizeof(ComputeCpu) == sizeof(CPU), "same object layout (the switches cost no state)");
+    }
+
+    std::cout << "\n===========\n";
+    if (failures == 0) {
+        std::cout << "✅ ALL COMPUTE CPU CHECKS PASSED\n";
+        return 0;
+    }
+    std::cout << "❌ " << failures << " check(s) FAILED\n";
+    return 1;
+}
@@ -0,0 +1,203 @@
+//
+// Z80 Digital Twin Debugger - ControlFlowGraph tests
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// Verifies the live CFG a DebugSession builds while executing: block discovery
+// and splitting on a newly seen branch target, edge kinds and taken counts,
+// observed entry points, and invalidation of blocks hit by self-modifying code
+// (also after 65,536 rewrites of one byte, where a 16-bit epoch would wrap).
+//
+
+#include "debug_session.h"
+#include "control_flow_graph.h"
+
+#include <cstdint>
+#include <iostream>
+#include <optional>
+#include <vector>
+
+namespace {
+
+using namespace z80;
+using namespace z80::dbg;
+
+int failures = 0;
+void check(bool ok, const char* what) {
+    std::cout << (ok ? "  ✓ " : "  ✗ ") << what << '\n';
+    if (!ok) ++failures;
+}
+
+void run_to_halt(DebugSession& s) {
+    s.Run();
+    for (int i = 0; i < 1000 && s.State() == RunState::Running; ++i) s.RunSlice(1000);
+}
+
+std::optional<CfgEdge> find_edge(const ControlFlowGraph& g, uint16_t from, uint16_t to) {
+    for (const CfgEdge& e : g.Edges())
+        if (e.from == from && e.to == to) return e;
+    return std::nullopt;
+}
+
+// Program (loaded at 0x0000):
+//   0x0000  31 00 80     LD SP, 0x8000
+//   0x0003  06 03        LD B, 3
+//   0x0005  CD 10 00     CALL 0x0010       <- DJNZ target: splits the first block
+//   0x0008  10 FB        DJNZ 0x0005
+//   0x000A  76           HALT
+//   0x0010  3C           INC A
+//   0x0011  C9           RET
+std::vector<uint8_t> loop_program() {
+    std::vector<uint8_t> p(0x12, 0x00);
+    const uint8_t code[] = {0x31, 0x00, 0x80, 0x06, 0x03, 0xCD, 0x10, 0x00, 0x10, 0xFB, 0x76};
+    std::copy(std::begin(code), std::end(code), p.begin());
+    p[0x10] = 0x3C;
+    p[0x11] = 0xC9;
+    return p;
+}
+
+// Program (loaded at 0x0000): calls a routine, patches its LD A,n operand, calls again.
+//   0x0000  31 00 80     LD SP, 0x8000
+//   0x0003  CD 20 00     CALL 0x0020
+//   0x0006  3E 02        LD A, 2
+//   0x0008  32 21 00     LD (0x0021), A    <- rewrites code that already ran
+//   0x000B  CD 20 00     CALL 0x0020
+//   0x000E  76           HALT
+//   0x0020  3E 01        LD A, 1
+//   0x0022  C9           RET
+std::vector<uint8_t> smc_program() {
+    std::vector<uint8_t> p(0x23, 0x00);
+    const uint8_t code[] = {0x31, 0x00, 0x80, 0xCD, 0x20, 0x00, 0x3E, 0x02,
+                            0x32, 0x21, 0x00, 0xCD, 0x20, 0x00, 0x76};
+    std::copy(std::begin(code), std::end(code), p.begin());
+    p[0x20] = 0x3E; p[0x21] = 0x01; p[0x22] = 0xC9;
+    return p;
+}
+
+} // namespace
+
+int main() {
+    std::cout << "ControlFlowGraph tests\n======================\n";
+
+    // --- Blocks, splits and execution counts --------------------------------
+    std::cout << "\n[1] Blocks discovered and split on a new branch target\n";
+    {
+        DebugCPU cpu;
+        cpu.LoadProgram(loop_program(), 0x0000);
+        DebugSession s(cpu);
+        run_to_halt(s);
+        const ControlFlowGraph& g = s.Cfg();
+
+        const std::vector<BasicBlock> blocks = g.Blocks();
+        check(blocks.size() == 5, "5 blocks (prologue, call, routine, djnz, halt)");
+
+        auto head = g.BlockAt(0x0003);
+        check(head && head->start == 0x0000 && head->end == 0x0005 &&
+              head->instructions == 2, "split left [0x0000,0x0005) with 2 instructions");
+        auto call = g.BlockAt(0x0005);
+        check(call && call->start == 0x0005 && call->end == 0x0008 && call->executions == 3,
+              "CALL block starts at the DJNZ target, entered 3 times");
+        auto routine = g.BlockAt(0x0011);
+        check(routine && routine->start == 0x0010 && routine->executions == 3,
+              "subroutine block entered 3 times");
+        check(head && head->executions == 1, "prologue entered once");
+    }
+
+    // --- Edges: kinds and counts --------------------------------------------
+    std::cout << "\n[2] Edge kinds and taken / not-taken counts\n";
+    {
+        DebugCPU cpu;
+        cpu.LoadProgram(loop_program(), 0x0000);
+        DebugSession s(cpu);
+        run_to_halt(s);
+        const ControlFlowGraph& g = s.Cfg();
+
+        auto fall = find_edge(g, 0x0003, 0x0005);
+        check(fall && fall->kind == EdgeKind::Fallthrough && fall->count == 1,
+              "split adds FALLTHROUGH 0x0003 -> 0x0005 (x1)");
+        auto call = find_edge(g, 0x0005, 0x0010);
+        check(call && call->kind == EdgeKind::Call && call->count == 3, "CALL edge x3");
+        auto ret = find_edge(g, 0x0011, 0x0008);
+        check(ret && ret->kind == EdgeKind::Return && ret->count == 3, "RETURN edge x3");
+        auto taken = find_edge(g, 0x0008, 0x0005);
+        check(taken && taken->kind == EdgeKind::Taken && taken->count == 2, "DJNZ taken x2");
+        auto not_taken = find_edge(g, 0x0008, 0x000A);
+        check(not_taken && not_taken->kind == EdgeKind::NotTaken && not_taken->count == 1,
+              "DJNZ not taken x1");
+        check(g.EdgesFrom(0x0008).size() == 2, "EdgesFrom(DJNZ block) = 2");
+        check(g.EdgesTo(0x0005).size() == 2, "EdgesTo(CALL block) = 2");
+
+        auto hot = g.HotBlocks(1);
+        check(hot.size() == 1 && hot[0].executions == 3, "hottest block ran 3 times");
+    }
+
+    // --- Entry points ---------------------------------------------------------
+    std::cout << "\n[3] Observed entry points\n";
+    {
+        DebugCPU cpu;
+        cpu.LoadProgram(loop_program(), 0x0000);
+        DebugSession s(cpu);
+        s.StepInstruction();                 // LD SP
+        cpu.PC() = 0x0010;                   // external PC change between steps
+        s.StepInstruction();                 // INC A
+        const ControlFlowGraph& g = s.Cfg();
+
+        auto start = g.BlockAt(0x0000);
+        check(start && (start->entry & kEntryStart), "first block marked as start entry");
+        auto poked = g.BlockAt(0x0010);
+        check(poked && (poked->entry & kEntryInterrupt), "PC change marks an interrupt entry");
+        auto edge = find_edge(g, 0x0000, 0x0010);
+        check(edge && edge->kind == EdgeKind::Interrupt, "discontinuity recorded as INTERRUPT edge");
+
+        run_to_halt(s);
+        auto routine = g.BlockAt(0x0010);
+        check(routine && (routine->entry & kEntryCall), "CALL target marked as call entry");
+        check(g.EntryPoints().size() == 2, "2 entry points");
+
+        s.Reset();
+        check(g.BlockCount() == 0 && g.Edges().empty(), "Reset() clears the graph");
+    }
+
+    // --- Self-modifying code invalidates blocks -----------------------------
+    std::cout << "\n[4] SMC invalidates the rewritten block\n";
+    {
+        DebugCPU cpu;
+        cpu.LoadProgram(smc_program(), 0x0000);
+        DebugSession s(cpu);
+        run_to_halt(s);
+        const ControlFlowGraph& g = s.Cfg();
+
+        check(cpu.A() == 0x02, "patched routine loaded A = 2");
+        check(g.Invalidations() == 1, "one block invalidated");
+        auto routine = g.BlockAt(0x0020);
+        check(routine && routine->executions == 1, "rebuilt block counts only fresh runs");
+        check(g.EdgesTo(0x0006).empty(), "return edge from the old code dropped");
+        auto ret = find_edge(g, 0x0022, 0x000E);
+        check(ret && ret->kind == EdgeKind::Return && ret->count == 1, "new return edge live");
+        auto first = find_edge(g, 0x0003, 0x0020);
+        check(first && first->count == 1, "call edges into the rewritten block kept");
+    }
+
+    // --- Many rewrites of one byte -------------------------------------------
+    std::cout << "\n[5] An edge stays dead however often its code is rewritten\n";
+    {
+        const ByteReader read = [](uint16_t a) -> uint8_t { return a == 0x0010 ? 0xC3 : 0x00; };   // JP nn
+        ControlFlowGraph g;
+        g.Record(0x0010, 0x0020, read);
+        for (uint32_t i = 0; i < 0x10000; ++i) {
+            g.Invalidate(0x0010);
+            g.Record(0x0010, 0x0030, read);
+        }
+        check(!find_edge(g, 0x0010, 0x0020), "the first edge is not revived by 65,536 rewrites");
+        auto live = find_edge(g, 0x0010, 0x0030);
+        check(live && live->count == 1, "the live edge counts only runs of the current code");
+    }
+
+    std::cout << "\n======================\n";
+    if (failures == 0) {
+        std::cout << "✅ ALL CONTROL-FLOW-GRAPH CHECKS PASSED\n";
+        return 0;
+    }
+    std::cout << "❌ " << failures << " check(s) FAILED\n";
+    return 1;
+}
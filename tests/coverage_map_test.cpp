@@ -0,0 +1,181 @@
+//
+// Z80 Digital Twin Debugger - CoverageMap tests
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// Verifies coverage persistence and multi-run analysis: snapshots from a
+// session (with profiler hit counts), the compact file round trip and its
+// corruption checks, union / intersection / "only in run B" ranges named from
+// symbols, the threaded MergeFiles() reduction, and lcov export.
+//
+
+#include "coverage_map.h"
+#include "debug_session.h"
+#include "symbol_table.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace z80;
+using namespace z80::dbg;
+
+int failures = 0;
+void check(bool ok, const char* what) {
+    std::cout << (ok ? "  ✓ " : "  ✗ ") << what << '\n';
+    if (!ok) ++failures;
+}
+
+// Program (loaded at 0x0000); the byte at 0x8000 picks the path:
+//   0x0000  3A 00 80     LD A, (0x8000)
+//   0x0003  B7           OR A
+//   0x0004  20 03        JR NZ, 0x0009
+//   0x0006  3C           INC A            ; path A
+//   0x0007  76           HALT
+//   0x0009  3D           DEC A            ; path B
+//   0x000A  76           HALT
+CoverageMap run(uint8_t input, bool count = false) {
+    DebugCPU cpu;
+    cpu.LoadProgram({0x3A, 0x00, 0x80, 0xB7, 0x20, 0x03, 0x3C, 0x76, 0x00, 0x3D, 0x76}, 0x0000);
+    cpu.WriteMemory(0x8000, input);
+    DebugSession s(cpu);
+    if (count) s.SetProfileMode(ProfileMode::Counters);
+    s.Run();
+    for (int i = 0; i < 100 && s.State() == RunState::Running; ++i) s.RunSlice(1000);
+    return CoverageMap::FromSession(s, input ? "path-b" : "path-a");
+}
+
+} // namespace
+
+int main() {
+    std::cout << "CoverageMap tests\n=================\n";
+
+    // --- Snapshot + file round trip -----------------------------------------
+    std::cout << "\n[1] Snapshot a session, save and reload\n";
+    {
+        const CoverageMap a = run(0, /*count=*/true);
+        check(a.Runs() == 1 && a.Name() == "path-a", "one run, named");
+        check(a.Executed(0x0000) && a.Executed(0x0007) && !a.Executed(0x0009),
+              "path A executed, path B not");
+        check(a.CodeBytes() == 8, "8 code bytes");
+        check(a.Hits(0x0000) == 1 && a.Hits(0x0001) == 0, "hits on instruction starts only");
+
+        const std::vector<uint8_t> bytes = a.Serialize();
+        check(bytes.size() < 64, "compact: under 64 bytes for this run");
+        CoverageMap back;
+        std::string why;
+        check(back.Deserialize(bytes, &why), "round trip parses");
+        bool same = back.Runs() == a.Runs() && back.Name() == a.Name();
+        for (uint32_t x = 0; same && x < 65536; ++x)
+            same = back.Flags(static_cast<uint16_t>(x)) == a.Flags(static_cast<uint16_t>(x)) &&
+                   back.Hits(static_cast<uint16_t>(x)) == a.Hits(static_cast<uint16_t>(x));
+        check(same, "flags, hits, runs and name survive");
+
+        std::vector<uint8_t> bad = bytes;
+        bad[bad.size() / 2] ^= 0x40;
+        check(!back.Deserialize(bad, &why) && why == "checksum mismatch", "corruption detected");
+        bad = bytes;
+        bad.resize(bad.size() - 3);
+        check(!back.Deserialize(bad, &why) && why == "truncated file", "truncation detected");
+        check(!back.Deserialize({'N', 'O', 'P', 'E'}, &why) && why == "not a coverage file",
+              "foreign file rejected");
+        check(back.Executed(0x0000), "a failed load leaves the map unchanged");
+    }
+
+    // --- Union, intersection, difference ------------------------------------------
+    std::cout << "\n[2] Union, intersection and code only in run B\n";
+    {
+        const CoverageMap a = run(0), b = run(1);
+        CoverageMap all = a;
+        all.Merge(b);
+        check(all.Runs() == 2 && all.CodeBytes() == 10, "union: 10 code bytes over 2 runs");
+        check(all.Hits(0x0000) == 2, "shared entry hit by both runs");
+
+        CoverageMap common = a;
+        common.Intersect(b);
+        check(common.CodeBytes() == 6 && !common.Executed(0x0006) && !common.Executed(0x0009),
+              "intersection: the shared 6-byte prefix");
+
+        SymbolTable t;
+        t.DefineLabel(0x0000, "MAIN", SymbolType::Function);
+        const auto only_b = CoverageMap::CodeOnlyIn(b, a, &t);
+        check(only_b.size() == 1 && only_b[0].start == 0x0009 && only_b[0].end == 0x000B,
+              "only in B: [0x0009,0x000B)");
+        check(only_b[0].label == "MAIN+0x9", "labelled from the nearest symbol");
+        t.DefineLabel(0x0007, "STOP_A");
+        const auto only_a = CoverageMap::CodeOnlyIn(a, b, &t);
+        check(only_a.size() == 2 && only_a[0].label == "MAIN+0x6" && only_a[1].label == "STOP_A",
+              "only in A: ranges split at symbols");
+    }
+
+    // --- Threaded merge of many files -------------------------------------------------
+    std::cout << "\n[3] MergeFiles() over many files\n";
+    {
+        const auto dir = std::filesystem::temp_directory_path() / "z80_coverage_map_test";
+        std::filesystem::create_directories(dir);
+        const CoverageMap a = run(0), b = run(1);
+        std::vector<std::string> paths;
+        for (int i = 0; i < 40; ++i) {
+            paths.push_back((dir / ("run" + std::to_string(i) + ".cov")).string());
+            (i % 4 == 0 ? b : a).SaveToFile(paths.back());
+        }
+        std::vector<std::string> errors;
+        const CoverageMap one = CoverageMap::MergeFiles(paths, 1, &errors);
+        const CoverageMap four = CoverageMap::MergeFiles(paths, 4, &errors);
+        check(errors.empty(), "all files load");
+        check(one.Runs() == 40 && one.Hits(0x0000) == 40 && one.Hits(0x0009) == 10,
+              "40 runs merged, hits summed");
+        bool same = four.Runs() == one.Runs();
+        for (uint32_t x = 0; same && x < 65536; ++x)
+            same = four.Flags(static_cast<uint16_t>(x)) == one.Flags(static_cast<uint16_t>(x)) &&
+                   four.Hits(static_cast<uint16_t>(x)) == one.Hits(static_cast<uint16_t>(x));
+        check(same, "1 and 4 jobs agree");
+
+        paths.push_back((dir / "missing.cov").string());
+        errors.clear();
+        const CoverageMap partial = CoverageMap::MergeFiles(paths, 3, &errors);
+        check(errors.size() == 1 && partial.Runs() == 40, "unreadable file skipped and reported");
+        std::filesystem::remove_all(dir);
+    }
+
+    // --- lcov export ----------------------------------------------------------------------
+    std::cout << "\n[4] lcov export keyed by symbol\n";
+    {
+        CoverageMap all = run(0);
+        all.Merge(run(1));
+        SymbolTable t;
+        t.DefineLabel(0x0000, "MAIN", SymbolType::Function);
+        t.DefineLabel(0x0009, "PATH_B", SymbolType::Function);
+        std::ostringstream out;
+        all.WriteLcov(out, t);
+        const std::string text = out.str();
+        check(text.find("SF:MAIN\nFN:0,MAIN\nFNDA:2,MAIN\n") != std::string::npos,
+              "MAIN record with function hits");
+        check(text.find("DA:4,2\nDA:6,1\nDA:7,1\nLF:5\nLH:5\nend_of_record") != std::string::npos,
+              "MAIN lines: one per instruction start");
+        check(text.find("SF:PATH_B\nFN:9,PATH_B\nFNDA:1,PATH_B") != std::string::npos,
+              "PATH_B in its own record");
+
+        std::ostringstream a_only, a_of_all;
+        const CoverageMap a = run(0);
+        a.WriteLcov(a_only, t);
+        a.WriteLcov(a_of_all, t, &all);
+        check(a_only.str().find("PATH_B") == std::string::npos, "without known code, unrun symbols are left out");
+        check(a_of_all.str().find("SF:PATH_B\nFN:9,PATH_B\nFNDA:0,PATH_B\nFNF:1\nFNH:0\n"
+                                  "DA:9,0\nDA:10,0\nLF:2\nLH:0\nend_of_record") != std::string::npos,
+              "with the union as known code, unrun lines are listed with 0 hits");
+    }
+
+    std::cout << "\n=================\n";
+    if (failures == 0) {
+        std::cout << "✅ ALL COVERAGE-MAP CHECKS PASSED\n";
+        return 0;
+    }
+    std::cout << "❌ " << failures << " check(s) FAILED\n";
+    return 1;
+}
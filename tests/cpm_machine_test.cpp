@@ -0,0 +1,279 @@
+//
+// Z80 Digital Twin - CP/M machine verification
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// Checks machine/cpm: BDOS and BIOS calls reach the host through the HALT
+// traps in page zero, and the program runs in bulk in between.
+//   1. console output and input (BDOS 1, 2, 9, 10, 11; BIOS CONOUT);
+//   2. how a run stops: warm boot, system reset, the program's own HALT,
+//      an unsupported call, the T-state budget;
+//   3. file calls in a sandbox directory: make, write, close, open, read,
+//      random access, size, search, rename, delete;
+//   4. FCB names that could escape the sandbox are refused;
+//   5. CpmState: a run saved part-way and restored into a fresh machine
+//      finishes with the same console and T-states; damaged files are refused.
+//
+
+#include "cpm/cpm_machine.h"
+#include "cpm/cpm_state.h"
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace z80::machine::cpm;
+
+int failures = 0;
+void check(bool ok, const char* what) {
+    std::cout << (ok ? "  ✓ " : "  ✗ ") << what << '\n';
+    if (!ok) ++failures;
+}
+
+constexpr uint16_t kFcb = 0x005C;
+constexpr uint16_t kText = 0x0300;
+
+/// CALL 0005h / HALT: one BDOS call, then the program's own HALT stops the run.
+Stop bdos(CpmMachine& m, uint8_t function, uint16_t de = 0) {
+    m.load_com(std::vector<uint8_t>{0xCD, 0x05, 0x00, 0x76});
+    m.cpu().C() = function;
+    m.cpu().DE() = de;
+    return m.run_until(m.cpu().GetCycleCount() + 1'000'000);
+}
+
+void poke(CpmMachine& m, uint16_t at, const std::string& s) {
+    for (std::size_t i = 0; i < s.size(); ++i) m.cpu().WriteMemory(static_cast<uint16_t>(at + i), static_cast<uint8_t>(s[i]));
+}
+
+/// A clean FCB at 005Ch naming @p name11 (11 bytes, space padded).
+void set_fcb(CpmMachine& m, const std::string& name11) {
+    for (uint16_t i = 0; i < fcb::kSize; ++i) m.cpu().WriteMemory(static_cast<uint16_t>(kFcb + i), 0);
+    poke(m, kFcb + fcb::kName, name11);
+}
+
+std::string read_file(const std::filesystem::path& p) {
+    std::ifstream f(p, std::ios::binary);
+    return {std::istreambuf_iterator<char>(f), {}};
+}
+
+} // namespace
+
+int main() {
+    std::cout << "CP/M machine\n============\n";
+    CpmMachine m;
+
+    // --- 1. Console ------------------------------------------------------------
+    std::cout << "\n[1] Console\n";
+    poke(m, kText, "Hello, CP/M$");
+    check(bdos(m, 9, kText) == Stop::kHalted && m.console() == "Hello, CP/M", "BDOS 9 prints up to '$'");
+    check(m.cpu().PC() == 0x0104, "the trap returns to the caller");
+    bdos(m, 2, '!');
+    check(m.console() == "Hello, CP/M!", "BDOS 2 prints E");
+
+    m.reset();
+    m.set_input("xy\r\nrest");
+    check(bdos(m, 11) == Stop::kHalted && m.cpu().A() == 0xFF, "BDOS 11: input pending");
+    bdos(m, 1);
+    check(m.cpu().A() == 'x' && m.console() == "x", "BDOS 1 reads a character and echoes it");
+    m.cpu().WriteMemory(kText, 16);
+    bdos(m, 10, kText);
+    check(m.cpu().ReadMemory(kText + 1) == 1 && m.cpu().ReadMemory(kText + 2) == 'y',
+          "BDOS 10 reads a line into the buffer, CR LF not included");
+    m.cpu().WriteMemory(kText, 2);
+    bdos(m, 10, kText);
+    check(m.cpu().ReadMemory(kText + 1) == 2 && m.cpu().ReadMemory(kText + 3) == 'e', "BDOS 10 stops at the buffer size");
+    bdos(m, 1); bdos(m, 1); bdos(m, 1);
+    check(m.cpu().A() == kEndOfText, "past the end of the input: ^Z");
+    bdos(m, 12);
+    check(m.cpu().HL() == 0x0022 && m.cpu().A() == 0x22, "BDOS 12: version 2.2 in HL and A");
+
+    m.reset();
+    m.load_com(std::vector<uint8_t>{0x0E, 'B', 0xCD, 0x0C, 0xFF, 0x76});   // LD C,'B' / CALL CONOUT / HALT
+    check(m.run_until(1'000'000) == Stop::kHalted && m.console() == "B", "BIOS CONOUT through its jump table entry");
+
+    // --- 2. Stopping -----------------------------------------------------------
+    std::cout << "\n[2] How a run stops\n";
+    m.reset();
+    m.load_com(std::vector<uint8_t>{0xC3, 0x00, 0x00});   // JP 0
+    check(m.run_until(1'000'000) == Stop::kWarmBoot, "JP 0: warm boot");
+    m.reset();
+    m.load_com(std::vector<uint8_t>{0xC9});               // RET into the CCP's return address
+    check(m.run_until(1'000'000) == Stop::kWarmBoot, "RET from the program: warm boot");
+    check(bdos(m, 0) == Stop::kSystemReset && m.reason() == "BDOS system reset", "BDOS 0: system reset");
+    m.reset();
+    m.load_com(std::vector<uint8_t>{0x00, 0x76});
+    check(m.run_until(1'000'000) == Stop::kHalted && m.reason() == "HALT at 0101h", "the program's own HALT");
+    check(bdos(m, 99) == Stop::kUnsupported && m.reason() == "unsupported BDOS call C=99",
+          "an unsupported call stops the run instead of guessing");
+    m.reset();
+    m.load_com(std::vector<uint8_t>{0x18, 0xFE});         // JR $
+    check(m.run_until(10'000) == Stop::kBudget && m.cpu().GetCycleCount() >= 10'000, "an endless loop: the budget");
+    check(m.run_until(20'000) == Stop::kBudget && m.cpu().GetCycleCount() >= 20'000, "and it continues where it stopped");
+    {
+        CpmMachine counted;
+        uint64_t instructions = 0;
+        counted.load_com(std::vector<uint8_t>{0x00, 0x00, 0x76});
+        counted.run_until(1'000'000, &instructions);
+        check(instructions == 3, "instructions are counted on request");
+    }
+
+    // --- 3. Files --------------------------------------------------------------
+    std::cout << "\n[3] Files in the sandbox\n";
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() / "z80_cpm_machine_test";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    m.reset();
+    m.set_directory(dir);
+
+    set_fcb(m, "OUT     DAT");
+    check(bdos(m, 22, kFcb) == Stop::kHalted && m.cpu().A() == 0 && std::filesystem::exists(dir / "OUT.DAT"),
+          "BDOS 22 makes OUT.DAT");
+    for (int r = 0; r < 3; ++r) {
+        for (uint16_t i = 0; i < kRecordBytes; ++i)
+            m.cpu().WriteMemory(static_cast<uint16_t>(kDefaultDma + i), static_cast<uint8_t>('a' + r));
+        bdos(m, 21, kFcb);
+    }
+    check(m.cpu().A() == 0 && std::filesystem::file_size(dir / "OUT.DAT") == 3 * kRecordBytes,
+          "BDOS 21 writes three records");
+    check(m.cpu().ReadMemory(kFcb + fcb::kCurrent) == 3, "CR advances past each record");
+    bdos(m, 16, kFcb);
+    check(m.cpu().A() == 0, "BDOS 16 closes it");
+
+    set_fcb(m, "out     dat");
+    bdos(m, 15, kFcb);
+    check(m.cpu().A() == 0 && m.cpu().ReadMemory(kFcb + fcb::kRecordCount) == 3,
+          "BDOS 15 opens it case-insensitively, RC = 3 records");
+    bdos(m, 20, kFcb);
+    bdos(m, 20, kFcb);
+    check(m.cpu().A() == 0 && m.cpu().ReadMemory(kDefaultDma) == 'b', "BDOS 20 reads sequentially");
+    bdos(m, 20, kFcb);
+    bdos(m, 20, kFcb);
+    check(m.cpu().A() == 1, "then reports end of file");
+
+    bdos(m, 35, kFcb);
+    check(m.cpu().ReadMemory(kFcb + fcb::kRandom) == 3, "BDOS 35: size in records");
+    m.cpu().WriteMemory(kFcb + fcb::kRandom, 1);
+    bdos(m, 33, kFcb);
+    check(m.cpu().A() == 0 && m.cpu().ReadMemory(kDefaultDma + 127) == 'b', "BDOS 33 reads record 1");
+    m.cpu().WriteMemory(kFcb + fcb::kRandom, 4);
+    for (uint16_t i = 0; i < kRecordBytes; ++i) m.cpu().WriteMemory(static_cast<uint16_t>(kDefaultDma + i), 'z');
+    bdos(m, 34, kFcb);
+    const std::string written = read_file(dir / "OUT.DAT");
+    check(m.cpu().A() == 0 && written.size() == 5 * kRecordBytes && written[4 * kRecordBytes] == 'z',
+          "BDOS 34 writes record 4 past the end");
+    m.cpu().WriteMemory(kFcb + fcb::kRandom + 2, 1);
+    bdos(m, 33, kFcb);
+    check(m.cpu().A() == 6, "a random record past 65535: out of range");
+
+    {
+        std::ofstream(dir / "NOTES.TXT", std::ios::binary) << "abc";
+        set_fcb(m, "NOTES   TXT");
+        bdos(m, 15, kFcb);
+        bdos(m, 20, kFcb);
+        check(m.cpu().A() == 0 && m.cpu().ReadMemory(kDefaultDma + 2) == 'c' &&
+              m.cpu().ReadMemory(kDefaultDma + 3) == kEndOfText, "a partial record reads padded with ^Z");
+    }
+
+    set_fcb(m, "????????DAT");
+    bdos(m, 17, kFcb);
+    check(m.cpu().A() == 0 && m.cpu().ReadMemory(kDefaultDma + 1) == 'O', "BDOS 17 finds OUT.DAT with wildcards");
+    bdos(m, 18, kFcb);
+    check(m.cpu().A() == 0xFF, "BDOS 18: no more matches");
+
+    set_fcb(m, "OUT     DAT");
+    poke(m, kFcb + fcb::kRename, std::string(1, '\0') + "NEW     DAT");
+    bdos(m, 23, kFcb);
+    check(m.cpu().A() == 0 && std::filesystem::exists(dir / "NEW.DAT") && !std::filesystem::exists(dir / "OUT.DAT"),
+          "BDOS 23 renames OUT.DAT to NEW.DAT");
+    set_fcb(m, "NEW     DAT");
+    bdos(m, 19, kFcb);
+    check(m.cpu().A() == 0 && !std::filesystem::exists(dir / "NEW.DAT"), "BDOS 19 deletes it");
+    bdos(m, 15, kFcb);
+    check(m.cpu().A() == 0xFF, "opening a missing file: FFh");
+
+    // --- 4. Sandbox ------------------------------------------------------------
+    std::cout << "\n[4] Names that leave the sandbox\n";
+    set_fcb(m, "../ESC  TXT");
+    bdos(m, 22, kFcb);
+    check(m.cpu().A() == 0xFF && !std::filesystem::exists(dir.parent_path() / "ESC.TXT"), "'..' and '/' are refused");
+    set_fcb(m, "A:B     TXT");
+    bdos(m, 22, kFcb);
+    check(m.cpu().A() == 0xFF, "':' is refused");
+    set_fcb(m, "           ");
+    bdos(m, 22, kFcb);
+    check(m.cpu().A() == 0xFF, "an empty name is refused");
+    set_fcb(m, "AB C    TXT");
+    bdos(m, 22, kFcb);
+    check(m.cpu().A() == 0xFF && !std::filesystem::exists(dir / "AB.TXT"), "a space inside the name is refused");
+    set_fcb(m, "ABC      TX");
+    bdos(m, 22, kFcb);
+    check(m.cpu().A() == 0xFF && !std::filesystem::exists(dir / "ABC"), "a type after a blank type byte is refused");
+    {
+        CpmMachine detached;
+        detached.cpu().WriteMemory(kFcb + fcb::kName, 'X');
+        for (uint16_t i = 1; i < 11; ++i) detached.cpu().WriteMemory(static_cast<uint16_t>(kFcb + fcb::kName + i), ' ');
+        bdos(detached, 22, kFcb);
+        check(detached.cpu().A() == 0xFF, "without a directory, no file can be made");
+    }
+
+    std::filesystem::remove_all(dir);
+
+    // --- 5. State snapshots ----------------------------------------------------
+    std::cout << "\n[5] Saving and restoring a run\n";
+    {
+        // Print "TSRQ...A" one BDOS 2 call at a time, then JP 0.
+        const std::vector<uint8_t> program = {0x06, 0x14, 0xC5, 0x78, 0xC6, 0x40, 0x5F, 0x0E, 0x02,
+                                              0xCD, 0x05, 0x00, 0xC1, 0x10, 0xF3, 0xC3, 0x00, 0x00};
+        CpmMachine whole;
+        whole.load_com(program);
+        const Stop whole_stop = whole.run_until(1'000'000);
+        check(whole_stop == Stop::kWarmBoot && whole.console() == "TSRQPONMLKJIHGFEDCBA", "the program on its own");
+        check(whole.run_until(2'000'000) == Stop::kWarmBoot, "running a stopped machine again: the same stop");
+
+        CpmMachine first;
+        first.load_com(program);
+        first.run_until(400);
+        while (!first.cpu().InstructionComplete()) first.cpu().Step();
+        const CpmState saved = CpmState::capture(first);
+        const std::vector<uint8_t> bytes = saved.save();
+
+        CpmState loaded;
+        check(loaded.load(bytes) && loaded.hash() == saved.hash() && !saved.console.empty() &&
+              saved.console.size() < 20, "saved part-way; the file loads back with the same hash");
+        CpmMachine second;
+        loaded.restore(second);
+        check(CpmState::capture(second).hash() == saved.hash(), "a restored machine captures to the same hash");
+        check(second.run_until(1'000'000) == Stop::kWarmBoot && second.console() == whole.console() &&
+              second.cpu().GetCycleCount() == whole.cpu().GetCycleCount(),
+              "and finishes with the same console and T-states");
+
+        std::vector<uint8_t> damaged = bytes;
+        damaged[100] ^= 0x01;
+        std::string error;
+        check(!loaded.load(damaged, &error) && error == "checksum mismatch", "a damaged file is refused");
+        check(!loaded.load(std::span(bytes).first(bytes.size() - 10)), "a truncated file is refused");
+
+        CpmState odd = saved;
+        odd.search = {"NOT AN 8.3 NAME", "LONGER THAN8.TXT"};
+        odd.search_next = 0;
+        CpmMachine third;
+        odd.restore(third);
+        bdos(third, 18);
+        check(third.cpu().A() == 0xFF, "a restored search over names that are not 8.3 ends, not crashes");
+    }
+
+    std::cout << "\n============\n";
+    if (failures == 0) {
+        std::cout << "✅ ALL CP/M MACHINE CHECKS PASSED\n";
+        return 0;
+    }
+    std::cout << "❌ " << failures << " check(s) FAILED\n";
+    return 1;
+}
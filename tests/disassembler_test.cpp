@@ -138,9 +138,9 @@ int main() {
 
     // --- Symbol resolution ----------------------------------------------------
     std::cout << "\n[symbols]\n";
-    SymbolResolver resolve = [](uint16_t a) -> std::optional<std::string> {
-        if (a == 0x1234) return std::string("MAIN");
-        if (a == 0x000F) return std::string("DONE");
+    SymbolResolver resolve = [](uint16_t a) -> std::optional<std::string_view> {
+        if (a == 0x1234) return "MAIN";
+        if (a == 0x000F) return "DONE";
         return std::nullopt;
     };
     expect(0x0000, {0xC3, 0x34, 0x12}, "JP MAIN", 3, resolve);
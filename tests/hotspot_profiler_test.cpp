@@ -0,0 +1,158 @@
+//
+// Z80 Digital Twin Debugger - HotspotProfiler tests
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// Verifies the session-driven profiler: exact execution / data-read / write
+// counters (instruction fetches excluded from reads), PC sampling every N
+// T-states, the hottest-code report grouped by basic block with symbol names,
+// and that switching off or resetting leaves nothing behind.
+//
+
+#include "debug_session.h"
+#include "hotspot_profiler.h"
+#include "symbol_table.h"
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+using namespace z80;
+using namespace z80::dbg;
+
+int failures = 0;
+void check(bool ok, const char* what) {
+    std::cout << (ok ? "  ✓ " : "  ✗ ") << what << '\n';
+    if (!ok) ++failures;
+}
+
+void run_to_halt(DebugSession& s) {
+    s.Run();
+    for (int i = 0; i < 1000 && s.State() == RunState::Running; ++i) s.RunSlice(1000);
+}
+
+// Program (loaded at 0x0000):
+//   0x0000  31 00 80     LD SP, 0x8000
+//   0x0003  06 0A        LD B, 10
+//   0x0005  3A 00 40     LD A, (0x4000)    <- loop: one data read
+//   0x0008  32 01 40     LD (0x4001), A    <-       one data write
+//   0x000B  10 F8        DJNZ 0x0005
+//   0x000D  76           HALT
+std::vector<uint8_t> loop_program() {
+    return {0x31, 0x00, 0x80, 0x06, 0x0A, 0x3A, 0x00, 0x40,
+            0x32, 0x01, 0x40, 0x10, 0xF8, 0x76};
+}
+
+} // namespace
+
+int main() {
+    std::cout << "HotspotProfiler tests\n=====================\n";
+
+    // --- Exact counters -----------------------------------------------------
+    std::cout << "\n[1] Counters: executions, data reads and writes\n";
+    {
+        DebugCPU cpu;
+        cpu.LoadProgram(loop_program(), 0x0000);
+        DebugSession s(cpu);
+        s.SetProfileMode(ProfileMode::Counters);
+        check(cpu.GetMemory().CountingReads(), "counters mode attaches the read counter");
+        run_to_halt(s);
+        const HotspotProfiler& p = s.Profiler();
+
+        check(p.Count(HeatSource::Exec, 0x0005) == 10, "loop head executed 10 times");
+        check(p.Count(HeatSource::Exec, 0x0000) == 1, "prologue executed once");
+        check(p.Count(HeatSource::Exec, 0x0006) == 0, "operand bytes carry no executions");
+        check(p.Instructions() == 33, "33 instructions counted");
+        check(p.Count(HeatSource::Read, 0x4000) == 10, "10 data reads of 0x4000");
+        check(p.Count(HeatSource::Read, 0x0005) == 0 && p.Count(HeatSource::Read, 0x0007) == 0,
+              "instruction fetches are not data reads");
+        check(p.Count(HeatSource::Write, 0x4001) == 10, "10 writes to 0x4001");
+        check(p.Peak(HeatSource::Exec) == 10, "exec heatmap peak is 10");
+        check(p.Samples() == 0, "no samples taken in counters mode");
+    }
+
+    // --- Hottest-code report ----------------------------------------------------
+    std::cout << "\n[2] Hottest code by basic block, with symbol names\n";
+    {
+        DebugCPU cpu;
+        cpu.LoadProgram(loop_program(), 0x0000);
+        DebugSession s(cpu);
+        s.SetProfileMode(ProfileMode::Counters);
+        run_to_halt(s);
+
+        SymbolTable t;
+        t.DefineLabel(0x0000, "MAIN", SymbolType::Function);
+        t.DefineLabel(0x0005, "LOOP", SymbolType::JumpTarget);
+        const std::vector<HotSpot> hot = s.Profiler().HottestCode(3, &s.Cfg(), &t);
+        check(hot.size() == 3, "3 rows");
+        check(hot[0].start == 0x0005 && hot[0].end == 0x000D && hot[0].hits == 30,
+              "loop block [0x0005,0x000D) is hottest with 30 instructions");
+        check(hot[0].label == "LOOP", "loop named LOOP");
+        check(hot[0].percent > 90.0 && hot[0].percent < 91.0, "loop share is 30/33");
+        check(hot[1].start == 0x0000 && hot[1].hits == 2 && hot[1].label == "MAIN",
+              "prologue block second, named MAIN");
+        check(hot[2].start == 0x000D && hot[2].label == "LOOP+0x8",
+              "HALT named from the nearest preceding symbol");
+
+        const std::vector<HotSpot> flat = s.Profiler().HottestCode(10);
+        check(flat.size() == 6 && flat[0].hits == 10 && flat[0].label.empty(),
+              "without a CFG: one row per instruction, unlabelled");
+    }
+
+    // --- Sampling -------------------------------------------------------------
+    std::cout << "\n[3] Sampling the PC every N T-states\n";
+    {
+        DebugCPU cpu;
+        cpu.LoadProgram(loop_program(), 0x0000);
+        DebugSession s(cpu);
+        s.SetSampleInterval(10);
+        s.SetProfileMode(ProfileMode::Sampling);
+        check(!cpu.GetMemory().CountingReads(), "sampling leaves memory reads alone");
+        const uint64_t start = cpu.GetCycleCount();
+        run_to_halt(s);
+        const HotspotProfiler& p = s.Profiler();
+
+        check(p.Samples() == (cpu.GetCycleCount() - start) / 10, "one sample per 10 T-states");
+        uint64_t in_loop = 0;
+        for (uint16_t a = 0x0005; a < 0x000D; ++a) in_loop += p.Count(HeatSource::Samples, a);
+        check(in_loop * 10 > p.Samples() * 8, "most samples land in the loop");
+        check(p.Instructions() == 0 && p.Count(HeatSource::Write, 0x4001) == 0,
+              "no exact counts in sampling mode");
+        const std::vector<HotSpot> hot = p.HottestCode(1, &s.Cfg());
+        check(!hot.empty() && hot[0].start == 0x0005, "report falls back to samples");
+    }
+
+    // --- Off / reset ----------------------------------------------------------
+    std::cout << "\n[4] Off by default, detach and reset\n";
+    {
+        DebugCPU cpu;
+        cpu.LoadProgram(loop_program(), 0x0000);
+        DebugSession s(cpu);
+        check(s.GetProfileMode() == ProfileMode::Off && !cpu.GetMemory().CountingReads(),
+              "profiling is off by default");
+        run_to_halt(s);
+        check(s.Profiler().Peak(HeatSource::Exec) == 0 && s.Profiler().Samples() == 0,
+              "nothing recorded while off");
+
+        s.SetProfileMode(ProfileMode::Counters);
+        s.Reset();
+        cpu.LoadProgram(loop_program(), 0x0000);
+        run_to_halt(s);
+        check(s.Profiler().Instructions() == 33, "counts again after Reset()");
+        s.Reset();
+        check(s.Profiler().Instructions() == 0 && s.Profiler().Peak(HeatSource::Read) == 0,
+              "Reset() clears the profile");
+        s.SetProfileMode(ProfileMode::Off);
+        check(!cpu.GetMemory().CountingReads(), "switching off detaches the read counter");
+    }
+
+    std::cout << "\n=====================\n";
+    if (failures == 0) {
+        std::cout << "✅ ALL HOTSPOT-PROFILER CHECKS PASSED\n";
+        return 0;
+    }
+    std::cout << "❌ " << failures << " check(s) FAILED\n";
+    return 1;
+}
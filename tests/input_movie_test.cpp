@@ -0,0 +1,167 @@
+//
+// Z80 Digital Twin - ZX Spectrum input movie verification
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// Verifies deterministic record/replay without the copyrighted ROM: a tiny
+// stand-in ROM polls the keyboard and counts interrupts, a recorder logs keys,
+// tape transport and a reset over 60 frames, and a fresh machine replays the
+// movie to the same state hash on every frame. Also covers the file round
+// trip and its corruption checks, divergence caught on the frame it happens,
+// and events landing mid-frame at their exact T-state.
+//
+
+#include "spectrum/input_movie.h"
+#include "spectrum_stand_in_rom.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+namespace sm = z80::machine::spectrum;
+namespace zt = z80::test;
+
+int failures = 0;
+void check(bool ok, const char* what) {
+    std::cout << (ok ? "  ✓ " : "  ✗ ") << what << '\n';
+    if (!ok) ++failures;
+}
+
+// Stand-in ROM (spectrum_stand_in_rom.h) whose main loop polls the keyboard:
+//   0x0007  LD BC,0xFDFE / IN A,(C) / LD (0x9000),A      ; A..G half-row
+//           LD HL,(0x9002) / INC HL / LD (0x9002),HL / JR 0x0007
+std::vector<uint8_t> test_rom() {
+    const std::vector<uint8_t> poll = {0x01, 0xFE, 0xFD, 0xED, 0x78, 0x32, 0x00, 0x90};
+    return zt::stand_in_rom({zt::kStartIm1, zt::forever({poll, zt::kBumpCounter})});
+}
+
+// A one-block .tap image (flag 0xFF + two data bytes).
+const std::vector<uint8_t> kTap = {0x03, 0x00, 0xFF, 0xAA, 0x55};
+
+// 60 frames of scripted input through the recorder.
+sm::InputMovie record(sm::SpectrumMachine& m) {
+    sm::InputMovie movie;
+    movie.rom_hash = sm::InputMovie::hash_rom(test_rom());
+    sm::InputRecorder rec(&movie);
+    rec.tape_insert(m, kTap);
+    for (int f = 0; f < 60; ++f) {
+        if (f == 5) rec.key_down(m, 1, 0);           // A
+        if (f == 9) rec.key_up(m, 1, 0);
+        if (f == 12) rec.set_keys(m, {0, 0x05, 0, 0, 0, 0, 0, 0});   // A + D
+        if (f == 20) rec.set_keys(m, {});
+        if (f == 25) rec.tape_play(m);
+        if (f == 40) rec.tape_stop(m);
+        if (f == 45) rec.reset(m);
+        m.run_frame();
+        rec.end_frame(m);
+    }
+    return movie;
+}
+
+} // namespace
+
+int main() {
+    std::cout << "Input movie record/replay\n=========================\n";
+
+    sm::SpectrumMachine recorded;
+    recorded.load_rom(test_rom());
+    const sm::InputMovie movie = record(recorded);
+
+    // --- 1. Replay reproduces every frame --------------------------------------
+    std::cout << "\n[1] Replay on a fresh machine matches every frame hash\n";
+    {
+        check(movie.frames() == 60, "60 frame hashes recorded");
+        check(movie.events.size() == 10 && movie.tapes.size() == 1,
+              "10 events (edges only) and the embedded tape");
+        check(movie.events[1].kind == sm::InputKind::KeyDown &&
+                  movie.events[1].tstate > 0,
+              "events stamped with absolute T-states");
+
+        sm::SpectrumMachine m;
+        m.load_rom(test_rom());
+        sm::InputPlayer player(movie);
+        bool all = true;
+        while (!player.done()) all = player.run_frame(m) && all;
+        check(all && !player.diverged(), "no frame diverged");
+        check(sm::state_hash(m) == sm::state_hash(recorded), "final state identical");
+        check(m.cpu().GetCycleCount() == recorded.cpu().GetCycleCount() &&
+                  m.cpu().GetCycleCount() > 60ull * sm::timing::kTPerFrame - 100,
+              "reset kept the T-state count monotonic");
+    }
+
+    // --- 2. File round trip ------------------------------------------------------------
+    std::cout << "\n[2] Save / load round trip and corruption checks\n";
+    {
+        const std::vector<uint8_t> bytes = movie.save();
+        sm::InputMovie back;
+        std::string why;
+        check(back.load(bytes, &why), "round trip parses");
+        check(back.events == movie.events && back.tapes == movie.tapes &&
+                  back.frame_hashes == movie.frame_hashes && back.rom_hash == movie.rom_hash &&
+                  back.flags == movie.flags,
+              "events, tapes, hashes and header survive");
+
+        std::vector<uint8_t> bad = bytes;
+        bad[bad.size() / 2] ^= 0x10;
+        check(!back.load(bad, &why) && why == "checksum mismatch", "corruption detected");
+        bad = bytes;
+        bad.resize(bad.size() - 5);
+        check(!back.load(bad, &why), "truncation detected");
+        check(!back.load(std::vector<uint8_t>{'N', 'O', 'P', 'E'}, &why) && why == "not a movie file",
+              "foreign file rejected");
+        check(back.frames() == 60, "a failed load leaves the movie unchanged");
+    }
+
+    // --- 3. Divergence ----------------------------------------------------------------
+    std::cout << "\n[3] A divergence is reported on the frame it happens\n";
+    {
+        sm::InputMovie edited = movie;
+        edited.events.erase(edited.events.begin() + 3);   // drop the frame-12 press of A
+        sm::SpectrumMachine m;
+        m.load_rom(test_rom());
+        sm::InputPlayer player(edited);
+        std::vector<std::size_t> false_frames;
+        while (!player.done())
+            if (!player.run_frame(m)) false_frames.push_back(player.frame() - 1);
+        check(player.diverged() && *player.diverged() == 12, "frame 12 flagged");
+        check(false_frames == std::vector<std::size_t>{12}, "run_frame() returns false on that frame only");
+    }
+
+    // --- 4. Mid-frame events --------------------------------------------------------
+    std::cout << "\n[4] Mid-frame events land at their T-state\n";
+    {
+        sm::InputMovie mid;
+        mid.events.push_back({1000, sm::InputKind::KeyDown, 1, 0, 0});
+        mid.events.push_back({30000, sm::InputKind::KeyUp, 1, 0, 0});
+
+        sm::SpectrumMachine m;
+        m.load_rom(test_rom());
+        sm::InputPlayer player(mid);
+        std::vector<uint64_t> stops;
+        player.run_frame(m, [&m, &stops](uint64_t target) {
+            const uint64_t before = m.cpu().GetCycleCount();
+            while (m.cpu().GetCycleCount() - before < target && !m.cpu().IsHalted())
+                do { m.cpu().Step(); } while (!m.cpu().InstructionComplete());
+            stops.push_back(m.cpu().GetCycleCount());
+            return m.cpu().GetCycleCount() - before;
+        });
+        check(stops.size() == 3, "frame split into three slices at the two events");
+        check(stops.size() == 3 && stops[0] >= 1000 && stops[0] < 1000 + 23 &&
+                  stops[1] >= 30000 && stops[1] < 30000 + 23,
+              "each slice ends on the first instruction boundary at/after its event");
+        check(!m.ula().matrix_pressed(1, 0), "key pressed and released within the frame");
+        check(m.cpu().ReadMemory(0x9000) == 0xFF, "last poll saw the key released");
+    }
+
+    std::cout << "\n=========================\n";
+    if (failures == 0) {
+        std::cout << "✅ ALL INPUT-MOVIE CHECKS PASSED\n";
+        return 0;
+    }
+    std::cout << "❌ " << failures << " check(s) FAILED\n";
+    return 1;
+}
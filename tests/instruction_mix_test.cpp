@@ -0,0 +1,164 @@
+//
+// Z80 Digital Twin - instrumented CPU (InstructionMix) verification
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// Checks what CPUImpl<..., InstrumentedCpuTraits> records:
+//   1. every opcode table is counted under the right opcode, with T-states
+//      that add up to the CPU clock (DDCB/FDCB under their last byte);
+//   2. prefix chains: wasted DD/FD prefixes counted, and charged to the
+//      instruction that finally executes;
+//   3. interrupts, Clear() (also mid-instruction) and Merge();
+//   4. instrumentation changes nothing the program can see, and the default
+//      CPU has no Mix() at all.
+//
+
+#include "z80_cpu.h"
+
+#include <cstdint>
+#include <iostream>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+using z80::InstructionMix;
+using z80::InstrumentedCpu;
+using z80::OpcodeTable;
+
+int failures = 0;
+void check(bool ok, const char* what) {
+    std::cout << (ok ? "  ✓ " : "  ✗ ") << what << '\n';
+    if (!ok) ++failures;
+}
+
+template <class Cpu>
+concept HasMix = requires(Cpu& c) { c.Mix(); };
+
+template <class Cpu>
+void run_to_halt(Cpu& c, const std::vector<uint8_t>& bytes) {
+    c.Reset();
+    c.LoadProgram(bytes, 0x0000);
+    while (!c.IsHalted()) c.Step();
+}
+
+// LD IX,8000h / LD IY,8000h / LD B,2
+// loop: NOP / BIT 0,B / NEG / RLC (IX+1) / SET 1,(IY+2) / DJNZ loop / HALT
+const std::vector<uint8_t> kEveryTable = {
+    0xDD, 0x21, 0x00, 0x80, 0xFD, 0x21, 0x00, 0x80, 0x06, 0x02,
+    0x00, 0xCB, 0x40, 0xED, 0x44, 0xDD, 0xCB, 0x01, 0x06, 0xFD, 0xCB, 0x02, 0xCE,
+    0x10, 0xF1, 0x76,
+};
+
+} // namespace
+
+int main() {
+    std::cout << "Instruction mix\n===============\n";
+
+    // --- 1. Tables ---------------------------------------------------------------
+    std::cout << "\n[1] Executions and T-states per opcode, in every table\n";
+    {
+        InstrumentedCpu cpu;
+        run_to_halt(cpu, kEveryTable);
+        const InstructionMix& mix = cpu.Mix();
+        check(mix.Count(OpcodeTable::Base, 0x00) == 2 && mix.Count(OpcodeTable::Base, 0x06) == 1 &&
+                  mix.Count(OpcodeTable::Base, 0x76) == 1,
+              "base: NOP x2, LD B,n x1, HALT x1");
+        check(mix.Count(OpcodeTable::CB, 0x40) == 2 && mix.TStates(OpcodeTable::CB, 0x40) == 16,
+              "CB 40 (BIT 0,B): 2 executions, 8 T each");
+        check(mix.Count(OpcodeTable::ED, 0x44) == 2 && mix.TStates(OpcodeTable::ED, 0x44) == 16,
+              "ED 44 (NEG): 2 executions, 8 T each");
+        check(mix.Count(OpcodeTable::DD, 0x21) == 1 && mix.TStates(OpcodeTable::DD, 0x21) == 14 &&
+                  mix.Count(OpcodeTable::FD, 0x21) == 1 && mix.TStates(OpcodeTable::FD, 0x21) == 14,
+              "DD 21 / FD 21 (LD IX/IY,nn): 14 T, prefix included");
+        check(mix.Count(OpcodeTable::DDCB, 0x06) == 2 && mix.TStates(OpcodeTable::DDCB, 0x06) == 46,
+              "DD CB d 06 (RLC (IX+d)) filed under its last byte, 23 T each");
+        check(mix.Count(OpcodeTable::FDCB, 0xCE) == 2 && mix.TStates(OpcodeTable::FDCB, 0xCE) == 46,
+              "FD CB d CE (SET 1,(IY+d)), 23 T each");
+        check(mix.Count(OpcodeTable::DDCB, 0x01) == 0 && mix.Count(OpcodeTable::FDCB, 0x02) == 0,
+              "displacement bytes are not counted as opcodes");
+        check(mix.Count(OpcodeTable::Base, 0x10) == 2 && mix.TStates(OpcodeTable::Base, 0x10) == 13 + 8,
+              "DJNZ: taken 13 T, then falling through 8 T");
+        check(mix.Instructions() == 16, "16 instructions in all");
+        check(mix.TStates() == cpu.GetCycleCount(), "opcode T-states add up to the CPU clock");
+        check(mix.chain[0] == 6 && mix.chain[1] == 6 && mix.chain[2] == 4 && mix.chain[3] == 0,
+              "chains: 6 unprefixed, 6 with one prefix, 4 DDCB/FDCB with two");
+        check(mix.redundant_prefixes == 0 && mix.interrupts == 0, "nothing wasted, no interrupts");
+    }
+
+    // --- 2. Prefix chains ---------------------------------------------------------
+    std::cout << "\n[2] Redundant prefixes\n";
+    {
+        // DD DD 21 nn (LD IX,nn) / DD ED 44 (NEG) / FD DD 21 nn (LD IX,nn) / HALT
+        InstrumentedCpu cpu;
+        run_to_halt(cpu, {0xDD, 0xDD, 0x21, 0x34, 0x12, 0xDD, 0xED, 0x44, 0xFD, 0xDD, 0x21, 0x00, 0x00, 0x76});
+        const InstructionMix& mix = cpu.Mix();
+        check(mix.redundant_prefixes == 3, "DD DD, DD ED and FD DD each waste one prefix");
+        check(mix.Count(OpcodeTable::DD, 0x21) == 2 && mix.Count(OpcodeTable::FD, 0x21) == 0,
+              "the last DD/FD decides the table");
+        check(mix.TStates(OpcodeTable::DD, 0x21) == 2 * 18 && mix.TStates(OpcodeTable::ED, 0x44) == 12,
+              "a wasted prefix's 4 T are charged to the instruction it precedes");
+        check(mix.chain[2] == 3 && mix.chain[0] == 1 && mix.Instructions() == 4,
+              "three two-prefix chains and the HALT");
+        check(mix.TStates() == cpu.GetCycleCount(), "T-states still add up to the clock");
+    }
+
+    // --- 3. Interrupts, Clear, Merge -------------------------------------------------
+    std::cout << "\n[3] Interrupts, Clear() and Merge()\n";
+    {
+        InstrumentedCpu cpu;
+        run_to_halt(cpu, {0xED, 0x56, 0xFB, 0x76});   // IM 1 / EI / HALT
+        check(cpu.Interrupt(0xFF), "IM 1 interrupt accepted");
+        InstructionMix mix = cpu.Mix();
+        check(mix.interrupts == 1 && mix.interrupt_tstates == 13, "acceptance counted with its 13 T");
+        check(mix.Instructions() == 3 && mix.TStates() + mix.interrupt_tstates == cpu.GetCycleCount(),
+              "interrupts kept apart from instructions");
+
+        InstructionMix twice = mix;
+        twice.Merge(mix);
+        check(twice.Instructions() == 6 && twice.interrupts == 2 && twice.Count(OpcodeTable::ED, 0x56) == 2,
+              "Merge() adds two runs");
+
+        cpu.Mix().Clear();
+        check(cpu.Mix().Instructions() == 0 && cpu.Mix().interrupts == 0, "Clear() zeroes every counter");
+
+        cpu.Reset();
+        cpu.LoadProgram({0xDD, 0x21, 0x00, 0x00, 0x76}, 0x0000);
+        cpu.Step();                                   // the DD prefix only
+        cpu.Mix().Clear();
+        cpu.Step();
+        check(cpu.Mix().Count(OpcodeTable::DD, 0x21) == 1 && cpu.Mix().TStates(OpcodeTable::DD, 0x21) == 14 &&
+                  cpu.Mix().chain[1] == 1,
+              "an instruction in flight across Clear() is still counted whole");
+        check(cpu.Mix().Instructions() == 1 && cpu.Mix().redundant_prefixes == 0,
+              "Reset() leaves the mix alone");
+    }
+
+    // --- 4. Zero-cost when disabled ------------------------------------------------------
+    std::cout << "\n[4] Same behaviour; nothing in the default build\n";
+    {
+        z80::CPU plain;
+        InstrumentedCpu counted;
+        run_to_halt(plain, kEveryTable);
+        run_to_halt(counted, kEveryTable);
+        check(plain.GetCycleCount() == counted.GetCycleCount() && plain.PC() == counted.PC() &&
+                  plain.AF() == counted.AF() && plain.BC() == counted.BC() && plain.R() == counted.R() &&
+                  plain.ReadMemory(0x8001) == counted.ReadMemory(0x8001) &&
+                  plain.ReadMemory(0x8002) == counted.ReadMemory(0x8002),
+              "registers, clock, R and memory identical to z80::CPU");
+
+        check(!HasMix<z80::CPU> && HasMix<InstrumentedCpu>,
+              "Mix() exists only on instrumented configurations");
+        check(std::is_empty_v<z80::NoInstructionMix> &&
+                  sizeof(InstrumentedCpu) >= sizeof(z80::CPU) + sizeof(InstructionMix),
+              "the default CPU carries an empty stand-in, the instrumented one the counters");
+    }
+
+    std::cout << "\n===============\n";
+    if (failures == 0) {
+        std::cout << "✅ ALL INSTRUCTION-MIX CHECKS PASSED\n";
+        return 0;
+    }
+    std::cout << "❌ " << failures << " check(s) FAILED\n";
+    return 1;
+}
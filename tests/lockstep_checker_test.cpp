@@ -0,0 +1,223 @@
+//
+// Z80 Digital Twin - lockstep checker verification
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// Checks z80::dbg::LockstepChecker (debugger/exec/lockstep_checker.h):
+//   1. z80::CPU's bulk path agrees with the reference, checked after every
+//      instruction and every N T-states, and ends where an unchecked run does;
+//   2. sampled: one block in S is checked;
+//   3. a real difference — ComputeCpu does not keep R, so LD A,R differs — is
+//      located to its instruction, with disassembly and register diff, by
+//      every mode; the candidate carries on as if unchecked;
+//   4. the reference replays the candidate's I/O without asking the device
+//      again, and follows its ROM write protection;
+//   5. Run() as a stepper: Machine::RunFrame with frame interrupts, and
+//      CpmMachine::run_until_with with BDOS traps.
+//
+
+#include "lockstep_checker.h"
+#include "cpm/cpm_machine.h"
+#include "machine.h"
+#include "io/callback_io.h"
+#include "io/observable_io.h"
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using z80::ComputeCpu;
+using z80::CPU;
+using z80::dbg::LockstepChecker;
+using z80::dbg::LockstepOptions;
+using ObservedCpu = z80::CPUImpl<z80::ObservableMemory, z80::ObservableIo<z80::CallbackIo>>;
+
+int failures = 0;
+void check(bool ok, const std::string& what) {
+    std::cout << (ok ? "  ✓ " : "  ✗ ") << what << '\n';
+    if (!ok) ++failures;
+}
+
+// Fill 4 KB at 8000h with L xor H, then LDIR it to 9000h: about 280,000
+// T-states, several blocks of every size used here.
+const std::vector<uint8_t> kFill = {
+    0x21, 0x00, 0x80,   // LD HL,8000h
+    0x01, 0x00, 0x10,   // LD BC,1000h
+    0x7D, 0xAC, 0x77,   // loop: LD A,L / XOR H / LD (HL),A
+    0x23, 0x0B,         // INC HL / DEC BC
+    0x78, 0xB1,         // LD A,B / OR C
+    0x20, 0xF7,         // JR NZ,loop
+    0x21, 0x00, 0x80,   // LD HL,8000h
+    0x11, 0x00, 0x90,   // LD DE,9000h
+    0x01, 0x00, 0x10,   // LD BC,1000h
+    0xED, 0xB0,         // LDIR
+    0x76};              // HALT (at 001Ah)
+
+/// kFill, then LD A,R / LD (A000h),A / HALT at 001Ah.
+std::vector<uint8_t> fill_then_read_r() {
+    std::vector<uint8_t> p(kFill.begin(), kFill.end() - 1);
+    p.insert(p.end(), {0xED, 0x5F, 0x32, 0x00, 0xA0, 0x76});
+    return p;
+}
+
+struct Snapshot {
+    uint64_t t;
+    uint16_t pc, sp, af, bc, de, hl;
+    uint32_t memory_sum;
+    bool operator==(const Snapshot&) const = default;
+};
+
+template <class Cpu>
+Snapshot snap(Cpu& c) {
+    uint32_t sum = 0;
+    for (uint32_t a = 0; a < 0x10000; ++a) sum = sum * 31u + c.ReadMemory(static_cast<uint16_t>(a));
+    return {c.GetCycleCount(), c.PC(), c.SP(), c.AF(), c.BC(), c.DE(), c.HL(), sum};
+}
+
+template <class Cpu>
+void load(Cpu& c, const std::vector<uint8_t>& bytes) {
+    c.Reset();
+    c.LoadProgram(bytes, 0x0000);
+}
+
+/// An unchecked run of @p bytes to HALT.
+template <class Cpu>
+Snapshot plain(const std::vector<uint8_t>& bytes) {
+    Cpu c;
+    load(c, bytes);
+    c.RunUntilCycle(10'000'000);
+    return snap(c);
+}
+
+} // namespace
+
+int main() {
+    std::cout << "Lockstep checker\n================\n";
+
+    std::cout << "\n[1] z80::CPU agrees with the reference\n";
+    for (const uint64_t interval : {uint64_t{0}, uint64_t{1000}, uint64_t{65536}}) {
+        CPU cpu;
+        load(cpu, kFill);
+        LockstepChecker<CPU> checker(cpu, {.interval = interval});
+        checker.Run(10'000'000);
+        const auto& s = checker.Stats();
+        const std::string mode = interval == 0 ? "every instruction" : "every " + std::to_string(interval) + " T";
+        check(!checker.Diverged() && cpu.IsHalted() && s.checked == s.blocks && s.checked >= 4 &&
+                  s.instructions > 20'000,
+              mode + ": no divergence over " + std::to_string(s.checked) + " blocks");
+        check(snap(cpu) == plain<CPU>(kFill), mode + ": same end state as an unchecked run");
+    }
+
+    std::cout << "\n[2] Sampled\n";
+    {
+        CPU cpu;
+        load(cpu, kFill);
+        LockstepChecker<CPU> checker(cpu, {.interval = 1000, .sample = 10});
+        checker.Run(10'000'000);
+        const auto& s = checker.Stats();
+        check(!checker.Diverged() && s.blocks > 200 && s.checked == (s.blocks + 9) / 10,
+              "one block in 10 checked (" + std::to_string(s.checked) + " of " + std::to_string(s.blocks) + ")");
+        check(s.instructions < 6000, "the reference ran only the sampled blocks");
+        check(snap(cpu) == plain<CPU>(kFill), "same end state as an unchecked run");
+    }
+
+    std::cout << "\n[3] A divergence is located\n";
+    for (const uint64_t interval : {uint64_t{0}, uint64_t{100'000}}) {
+        const std::vector<uint8_t> program = fill_then_read_r();
+        ComputeCpu cpu;
+        load(cpu, program);
+        LockstepChecker<ComputeCpu> checker(cpu, {.interval = interval});
+        checker.Run(10'000'000);
+        const std::string mode = interval == 0 ? "every instruction" : "every 100000 T";
+        check(checker.Diverged() && checker.GetDivergence()->located, mode + ": diverged, located");
+        if (!checker.Diverged()) continue;
+        const z80::dbg::Divergence& d = *checker.GetDivergence();
+        check(d.pc == 0x001A && d.disassembly == "LD A, R", mode + ": at 001Ah, LD A, R");
+        check(!d.differences.empty() && d.differences[0].starts_with("AF ") &&
+                  d.differences[0].find(" want ") != std::string::npos,
+              mode + ": AF named with both values: " + (d.differences.empty() ? "" : d.differences[0]));
+        check(d.Report().starts_with("lockstep divergence at T-state ") &&
+                  d.Report().find("001Ah: LD A, R\n  AF ") != std::string::npos,
+              mode + ": report");
+        check(snap(cpu) == plain<ComputeCpu>(program), mode + ": the candidate ends as an unchecked run does");
+    }
+
+    std::cout << "\n[4] I/O replay and write protection\n";
+    {
+        ObservedCpu cpu;
+        int reads = 0;
+        std::vector<uint8_t> outs;
+        cpu.GetIo().inner().OnIn([&reads](uint16_t) { return static_cast<uint8_t>(0x10 + ++reads); });
+        cpu.GetIo().inner().OnOut([&outs](uint16_t, uint8_t v) { outs.push_back(v); });
+        cpu.GetIo().SetRecording(false);
+        load(cpu, {0xDB, 0xFE,          // IN A,(FEh)
+                   0x87,                // ADD A,A
+                   0xD3, 0xFE,          // OUT (FEh),A
+                   0xDB, 0xFE,          // IN A,(FEh)
+                   0x32, 0x00, 0x10,    // LD (1000h),A   (ROM: ignored)
+                   0x32, 0x00, 0x80,    // LD (8000h),A
+                   0x76});
+        cpu.GetMemory().SetWriteProtect(0x0000, 0x3FFF);
+        LockstepChecker<ObservedCpu> checker(cpu);
+        checker.Run(1000);
+        check(!checker.Diverged() && cpu.IsHalted(), "no divergence");
+        check(reads == 2 && outs == std::vector<uint8_t>{0x22}, "the device answered the candidate only");
+        check(cpu.ReadMemory(0x8000) == 0x12 && cpu.ReadMemory(0x1000) == 0x00 &&
+                  checker.GetReference().ReadMemory(0x1000) == 0x00,
+              "the reference kept the ROM write protection");
+        check(!cpu.GetIo().Recording() && cpu.GetIo().Transactions().empty(), "the I/O log left as it was (off)");
+    }
+
+    std::cout << "\n[5] Steppers\n";
+    {
+        // IM 1: the handler counts frame interrupts at 8000h.
+        std::vector<uint8_t> program(0x43, 0x00);
+        const std::vector<uint8_t> body = {0xF3, 0x31, 0x00, 0xF0,   // DI / LD SP,F000h
+                                           0xED, 0x56, 0xFB,         // IM 1 / EI
+                                           0x23, 0x18, 0xFD};        // loop: INC HL / JR loop
+        const std::vector<uint8_t> handler = {0x3A, 0x00, 0x80, 0x3C, 0x32, 0x00, 0x80,   // count
+                                              0xFB, 0xED, 0x4D};                          // EI / RETI
+        std::copy(body.begin(), body.end(), program.begin());
+        std::copy(handler.begin(), handler.end(), program.begin() + 0x38);
+
+        CPU checked_cpu;
+        CPU plain_cpu;
+        load(checked_cpu, program);
+        load(plain_cpu, program);
+        z80::machine::Machine<CPU> checked_machine(checked_cpu, 1000);
+        z80::machine::Machine<CPU> plain_machine(plain_cpu, 1000);
+        LockstepChecker<CPU> checker(checked_cpu, {.interval = 300});
+        for (int f = 0; f < 20; ++f) {
+            checked_machine.RunFrame([&checker](uint64_t t) { return checker.Run(t); });
+            plain_machine.RunFrame([&plain_cpu](uint64_t t) {
+                const uint64_t before = plain_cpu.GetCycleCount();
+                plain_cpu.RunUntilCycle(before + t);
+                return plain_cpu.GetCycleCount() - before;
+            });
+        }
+        check(!checker.Diverged() && checked_cpu.ReadMemory(0x8000) == 19,
+              "Machine::RunFrame: 20 frames, 19 interrupts taken, no divergence");
+        check(snap(checked_cpu) == snap(plain_cpu), "same state as the RunUntilCycle stepper");
+
+        z80::machine::cpm::CpmMachine cpm;
+        cpm.load_com(std::vector<uint8_t>{0x0E, 0x09, 0x11, 0x09, 0x01,   // LD C,9 / LD DE,0109h
+                                          0xCD, 0x05, 0x00, 0xC9,         // CALL 5 / RET
+                                          'L', 'o', 'c', 'k', 's', 't', 'e', 'p', '$'});
+        LockstepChecker<CPU> cpm_checker(cpm.cpu());
+        const auto stop = cpm.run_until_with(1'000'000, [&cpm_checker](uint64_t t) { return cpm_checker.Run(t); });
+        check(stop == z80::machine::cpm::Stop::kWarmBoot && cpm.console() == "Lockstep" && !cpm_checker.Diverged() &&
+                  cpm_checker.Stats().checked >= 2,
+              "CpmMachine::run_until_with: BDOS call served, no divergence");
+    }
+
+    std::cout << "\n================\n";
+    if (failures == 0) {
+        std::cout << "✅ ALL LOCKSTEP CHECKER CHECKS PASSED\n";
+        return 0;
+    }
+    std::cout << "❌ " << failures << " check(s) FAILED\n";
+    return 1;
+}
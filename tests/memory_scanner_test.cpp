@@ -0,0 +1,163 @@
+//
+// Z80 Digital Twin Debugger - MemoryScanner tests
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// Verifies the cheat-finder scanner: each refine predicate in 8- and 16-bit
+// mode (including wrapping deltas and the word at 0xFFFF), start ranges,
+// candidate listing, a live session finding a decrementing counter, and that a
+// full refinement pass stays well under a millisecond.
+//
+
+#include "memory_scanner.h"
+#include "debug_session.h"
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+using namespace z80;
+using namespace z80::dbg;
+
+int failures = 0;
+void check(bool ok, const char* what) {
+    std::cout << (ok ? "  ✓ " : "  ✗ ") << what << '\n';
+    if (!ok) ++failures;
+}
+
+// A pseudo-random 64K image, so few addresses match by accident.
+std::vector<uint8_t> noise(uint32_t seed) {
+    std::vector<uint8_t> m(65536);
+    for (uint8_t& b : m) { seed = seed * 1664525u + 1013904223u; b = static_cast<uint8_t>(seed >> 24); }
+    return m;
+}
+
+} // namespace
+
+int main() {
+    std::cout << "MemoryScanner tests\n===================\n";
+
+    // --- 8-bit predicates -----------------------------------------------------
+    std::cout << "\n[1] 8-bit: equal, changed-by, unchanged, increased\n";
+    {
+        std::vector<uint8_t> m = noise(1);
+        m[0x8123] = 3;
+        MemoryScanner s;
+        s.Start(m, ScanWidth::Byte);
+        check(s.Count() == 65536, "every address starts as a candidate");
+
+        s.Refine(m, ScanOp::Equal, 3);
+        check(s.IsCandidate(0x8123) && s.Count() < 600, "equal 3 keeps ~1/256 of memory");
+
+        std::vector<uint8_t> next = noise(2);
+        next[0x8123] = 2;                                  // lost a life
+        s.Refine(next, ScanOp::ChangedBy, static_cast<uint16_t>(-1));
+        check(s.IsCandidate(0x8123) && s.Count() < 10, "changed by -1 narrows to a handful");
+
+        s.Refine(next, ScanOp::Unchanged);
+        check(s.IsCandidate(0x8123), "unchanged keeps the counter");
+        next[0x8123] = 5;
+        s.Refine(next, ScanOp::Increased);
+        check(s.IsCandidate(0x8123) && s.Count() == 1, "increased: only the counter is left");
+        check(s.ValueAt(0x8123) == 5 && s.Steps() == 4, "value and step count track the scan");
+
+        next[0x8123] = 0;
+        check(s.Refine(next, ScanOp::ChangedBy, 0xFB) == 1, "changed by -5 wraps (5 -> 0)");
+        check(s.Refine(next, ScanOp::Changed) == 0, "changed on an identical image empties the set");
+    }
+
+    // --- 16-bit predicates ------------------------------------------------------
+    std::cout << "\n[2] 16-bit little-endian values\n";
+    {
+        std::vector<uint8_t> m = noise(3);
+        m[0x9000] = 0xFF; m[0x9001] = 0x00;                // score 0x00FF
+        m[0xFFFF] = 0x34; m[0x0000] = 0x12;                // word at 0xFFFF wraps
+        MemoryScanner s;
+        s.Start(m, ScanWidth::Word);
+        s.Refine(m, ScanOp::Equal, 0x00FF);
+        check(s.IsCandidate(0x9000), "equal 0x00FF finds the word");
+        m[0x9000] = 0x09; m[0x9001] = 0x01;                // +10 carries into the high byte
+        s.Refine(m, ScanOp::ChangedBy, 10);
+        check(s.IsCandidate(0x9000) && !s.IsCandidate(0x8FFF), "changed by +10 across a byte carry");
+        check(s.ValueAt(0x9000) == 0x0109, "word value read little-endian");
+        m[0x9001] = 0x00;
+        s.Refine(m, ScanOp::Decreased);
+        check(s.IsCandidate(0x9000), "decreased (0x0109 -> 0x0009)");
+
+        MemoryScanner w;
+        w.Start(m, ScanWidth::Word);
+        w.Refine(m, ScanOp::Equal, 0x1234);
+        check(w.IsCandidate(0xFFFF), "the word at 0xFFFF wraps to 0x0000");
+    }
+
+    // --- Ranges, listing, exclusion ---------------------------------------------
+    std::cout << "\n[3] Start range, candidate list, exclusion\n";
+    {
+        const std::vector<uint8_t> zeros(65536, 0);
+        MemoryScanner s;
+        s.Start(zeros, ScanWidth::Byte, 0x4000, 0x400F);
+        check(s.Count() == 16 && !s.IsCandidate(0x3FFF) && !s.IsCandidate(0x4010),
+              "range [0x4000,0x400F] only");
+        const std::vector<uint16_t> first = s.Candidates(4);
+        check(first.size() == 4 && first[0] == 0x4000 && first[3] == 0x4003, "Candidates(4) in order");
+        s.Exclude(0x4000);
+        s.Exclude(0x4000);
+        check(s.Count() == 15 && !s.IsCandidate(0x4000), "Exclude() drops one address once");
+        check(s.Refine(zeros, ScanOp::Unchanged) == 15, "refine leaves excluded out");
+
+        MemoryScanner idle;
+        check(idle.Refine(zeros, ScanOp::Unchanged) == 0 && !idle.Started(), "refine before Start() is a no-op");
+    }
+
+    // --- Live session --------------------------------------------------------------
+    std::cout << "\n[4] Finding a live counter in a running session\n";
+    {
+        // 0x0000  21 00 90   LD HL, 0x9000
+        // 0x0003  36 05      LD (HL), 5
+        // 0x0005  35         DEC (HL)         <- step 3 times between snapshots
+        // 0x0006  18 FD      JR 0x0005
+        DebugCPU cpu;
+        cpu.LoadProgram({0x21, 0x00, 0x90, 0x36, 0x05, 0x35, 0x18, 0xFD}, 0x0000);
+        DebugSession session(cpu);
+        session.StepInstruction();
+        session.StepInstruction();
+
+        MemoryScanner s;
+        s.Start(session, ScanWidth::Byte, 0x4000, 0xFFFF);
+        s.Refine(session, ScanOp::Equal, 5);
+        for (int i = 0; i < 2; ++i) {
+            session.StepInstruction();   // DEC (HL)
+            session.StepInstruction();   // JR
+            s.Refine(session, ScanOp::Decreased);
+        }
+        check(s.Count() == 1 && s.IsCandidate(0x9000), "decreased twice isolates 0x9000");
+        check(s.ValueAt(0x9000) == 3, "counter now reads 3");
+    }
+
+    // --- Speed ---------------------------------------------------------------------
+    std::cout << "\n[5] A full refinement pass is sub-millisecond\n";
+    {
+        const std::vector<uint8_t> m = noise(4);
+        MemoryScanner s;
+        s.Start(m, ScanWidth::Word);
+        constexpr int kPasses = 200;
+        const auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < kPasses; ++i) s.Refine(m, ScanOp::Unchanged);   // worst case: nothing drops
+        const double us = std::chrono::duration<double, std::micro>(
+                              std::chrono::steady_clock::now() - t0).count() / kPasses;
+        std::cout << "    16-bit pass over 64K candidates: " << us << " us\n";
+        check(s.Count() == 65536, "all candidates survive unchanged");
+        check(us < 1000.0, "under 1 ms per pass");
+    }
+
+    std::cout << "\n===================\n";
+    if (failures == 0) {
+        std::cout << "✅ ALL MEMORY-SCANNER CHECKS PASSED\n";
+        return 0;
+    }
+    std::cout << "❌ " << failures << " check(s) FAILED\n";
+    return 1;
+}
@@ -0,0 +1,474 @@
+//
+// Z80 Digital Twin - per-opcode-group microbenchmarks
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// Host nanoseconds per emulated instruction for each opcode class, on every
+// instantiated CPU configuration, through the benchmark harness. Each class
+// has a short body of representative instructions. The body is measured two
+// ways:
+//   straight  the body repeated to about 4 KB, then HALT — no emulated
+//             branches, every fetch from a new address;
+//   looped    the body repeated to about 32 instructions inside a loop whose
+//             counter lives in B' (EXX / DEC B / EXX / JP NZ), so the body
+//             keeps every main register. The tail's four instructions are
+//             included in the count.
+// The interrupt class is a HALT loop answered by the harness with an
+// interrupt, in IM 1 and IM 2, and counts each acceptance as an instruction
+// (not on the Compute configuration, which takes no interrupts).
+//
+// (HL)-operand forms are kept in their own class (ld8_mem) so a regression in
+// the memory-operand path shows up apart from register-only loads.
+//
+//   opcode_benchmark [--quick] [--perf] [--filter TEXT] [--json FILE]
+//   opcode_benchmark --compare base.json new.json [--threshold 3]
+//   opcode_benchmark --check      # verify every program, no timing (CTest)
+//
+
+#include "bench_harness.h"
+#include "cpu_workload.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+namespace bench = z80::bench;
+using Bytes = std::vector<uint8_t>;
+
+struct Group {
+    const char* name;
+    const char* what;
+    Bytes setup;   ///< Run once per rep; must not touch B'.
+    Bytes body;    ///< Must not use EXX or the alternate registers.
+};
+
+std::vector<Group> groups() {
+    return {
+        {"ld8", "LD r,r' / LD r,n", {},
+         {0x79,          // LD A,C
+          0x57,          // LD D,A
+          0x5A,          // LD E,D
+          0x63,          // LD H,E
+          0x6C,          // LD L,H
+          0x4D,          // LD C,L
+          0x3E, 0x12,    // LD A,0x12
+          0x1E, 0x34,    // LD E,0x34
+          0x67,          // LD H,A
+          0x44}},        // LD B,H
+        {"ld8_mem", "LD r,(HL) / LD (HL),r / (BC) / (DE) / (nn)",
+         {0x21, 0x00, 0x80,     // LD HL,0x8000
+          0x01, 0x00, 0x81,     // LD BC,0x8100
+          0x11, 0x00, 0x82},    // LD DE,0x8200
+         {0x7E,                 // LD A,(HL)
+          0x77,                 // LD (HL),A
+          0x0A,                 // LD A,(BC)
+          0x12,                 // LD (DE),A
+          0x1A,                 // LD A,(DE)
+          0x02,                 // LD (BC),A
+          0x36, 0x5A,           // LD (HL),0x5A
+          0x3A, 0x00, 0x83,     // LD A,(0x8300)
+          0x32, 0x01, 0x83}},   // LD (0x8301),A
+        {"alu8", "ADD/ADC/SUB/SBC/AND/XOR/OR/CP r,n,(HL); INC/DEC",
+         {0x21, 0x00, 0x80,     // LD HL,0x8000
+          0x3E, 0x35,           // LD A,0x35
+          0x0E, 0x17,           // LD C,0x17
+          0x16, 0x9A},          // LD D,0x9A
+         {0x81,                 // ADD A,C
+          0x8A,                 // ADC A,D
+          0x91,                 // SUB C
+          0x9E,                 // SBC A,(HL)
+          0xE6, 0xF7,           // AND 0xF7
+          0xAA,                 // XOR D
+          0xB6,                 // OR (HL)
+          0xB9,                 // CP C
+          0xC6, 0x11,           // ADD A,0x11
+          0x0C,                 // INC C
+          0x15,                 // DEC D
+          0x34,                 // INC (HL)
+          0xBE}},               // CP (HL)
+        {"arith16", "ADD HL,rr / INC,DEC rr / ADC,SBC HL,rr",
+         {0x21, 0x34, 0x12,     // LD HL,0x1234
+          0x11, 0x01, 0x01,     // LD DE,0x0101
+          0x01, 0x0F, 0x0F,     // LD BC,0x0F0F
+          0x31, 0x00, 0xF0},    // LD SP,0xF000
+         {0x19,                 // ADD HL,DE
+          0x09,                 // ADD HL,BC
+          0x13,                 // INC DE
+          0x0B,                 // DEC BC
+          0x39,                 // ADD HL,SP
+          0x23,                 // INC HL
+          0x1B,                 // DEC DE
+          0xED, 0x4A,           // ADC HL,BC
+          0xED, 0x52,           // SBC HL,DE
+          0xED, 0x7A,           // ADC HL,SP
+          0xED, 0x42,           // SBC HL,BC
+          0x33,                 // INC SP
+          0x3B}},               // DEC SP
+        {"cb", "CB rotates, shifts, BIT/SET/RES on r and (HL)",
+         {0x21, 0x00, 0x80,     // LD HL,0x8000
+          0x3E, 0x81,           // LD A,0x81
+          0x0E, 0x3C},          // LD C,0x3C
+         {0xCB, 0x07,           // RLC A
+          0xCB, 0x19,           // RR C
+          0xCB, 0x0E,           // RRC (HL)
+          0xCB, 0x46,           // BIT 0,(HL)
+          0xCB, 0x7F,           // BIT 7,A
+          0xCB, 0xD1,           // SET 2,C
+          0xCB, 0x91,           // RES 2,C
+          0xCB, 0x27,           // SLA A
+          0xCB, 0x3F,           // SRL A
+          0xCB, 0x16,           // RL (HL)
+          0xCB, 0xFE,           // SET 7,(HL)
+          0xCB, 0xBE}},         // RES 7,(HL)
+        {"indexed", "DD/FD: (IX+d)/(IY+d) loads and ALU, IX/IY arithmetic",
+         {0xDD, 0x21, 0x00, 0x80,   // LD IX,0x8000
+          0xFD, 0x21, 0x00, 0x81,   // LD IY,0x8100
+          0x31, 0x00, 0xF0,         // LD SP,0xF000
+          0x3E, 0x07},              // LD A,7
+         {0xDD, 0x7E, 0x05,         // LD A,(IX+5)
+          0xFD, 0x77, 0xFE,         // LD (IY-2),A
+          0xDD, 0x86, 0x01,         // ADD A,(IX+1)
+          0xFD, 0x34, 0x03,         // INC (IY+3)
+          0xDD, 0x36, 0x02, 0x44,   // LD (IX+2),0x44
+          0xFD, 0x46, 0x01,         // LD B,(IY+1)
+          0xFD, 0xBE, 0x04,         // CP (IY+4)
+          0xDD, 0x23,               // INC IX
+          0xDD, 0x2B,               // DEC IX
+          0xDD, 0xE5,               // PUSH IX
+          0xDD, 0xE1,               // POP IX
+          0xDD, 0x7C}},             // LD A,IXH
+        {"ddcb", "DDCB/FDCB rotates, BIT/SET/RES on (IX+d)/(IY+d)",
+         {0xDD, 0x21, 0x00, 0x80,   // LD IX,0x8000
+          0xFD, 0x21, 0x00, 0x81},  // LD IY,0x8100
+         {0xDD, 0xCB, 0x01, 0x06,   // RLC (IX+1)
+          0xFD, 0xCB, 0x02, 0x46,   // BIT 0,(IY+2)
+          0xDD, 0xCB, 0x03, 0xC6,   // SET 0,(IX+3)
+          0xFD, 0xCB, 0xFF, 0x86,   // RES 0,(IY-1)
+          0xDD, 0xCB, 0x04, 0x1E,   // RR (IX+4)
+          0xFD, 0xCB, 0x05, 0x7E,   // BIT 7,(IY+5)
+          0xDD, 0xCB, 0x06, 0x26,   // SLA (IX+6)
+          0xFD, 0xCB, 0x07, 0x3E}}, // SRL (IY+7)
+        {"block", "ED LDIR/LDDR/CPIR (64 iterations each) and LDI", {},
+         {0x21, 0x00, 0x80,         // LD HL,0x8000
+          0x11, 0x00, 0x90,         // LD DE,0x9000
+          0x01, 0x40, 0x00,         // LD BC,64
+          0xED, 0xB0,               // LDIR
+          0x21, 0x3F, 0x80,         // LD HL,0x803F
+          0x11, 0x3F, 0x90,         // LD DE,0x903F
+          0x01, 0x40, 0x00,         // LD BC,64
+          0xED, 0xB8,               // LDDR
+          0x21, 0x00, 0x80,         // LD HL,0x8000
+          0x01, 0x40, 0x00,         // LD BC,64
+          0x3E, 0x55,               // LD A,0x55 (absent: CPIR runs out)
+          0xED, 0xB1,               // CPIR
+          0x11, 0x00, 0xA0,         // LD DE,0xA000
+          0xED, 0xA0,               // LDI
+          0xED, 0xA0,               // LDI
+          0xED, 0xA0}},             // LDI
+        {"io", "IN/OUT (n) and (C) through the I/O policy",
+         {0x01, 0xFE, 0x10,         // LD BC,0x10FE
+          0x3E, 0x07},              // LD A,7
+         {0xD3, 0xFE,               // OUT (0xFE),A
+          0xDB, 0xFE,               // IN A,(0xFE)
+          0xED, 0x78,               // IN A,(C)
+          0xED, 0x79,               // OUT (C),A
+          0xED, 0x50,               // IN D,(C)
+          0xED, 0x51,               // OUT (C),D
+          0xDB, 0x1F,               // IN A,(0x1F)
+          0xED, 0x41}},             // OUT (C),B
+    };
+}
+
+constexpr std::size_t kStraightBytes = 4096;
+constexpr std::size_t kLoopedInstructions = 32;
+constexpr uint8_t kLoopCount = 64;
+
+/// Instructions in one copy of the body: setup + body, less setup alone.
+std::size_t count_instructions(const Group& g) {
+    const auto run = [](Bytes p) {
+        p.push_back(0x76);   // HALT
+        bench::ProgramWorkload<z80::CPU> w(p);
+        const std::optional<bench::Work> work = w.count();
+        return work ? work->instructions : 0;
+    };
+    Bytes both = g.setup;
+    both.insert(both.end(), g.body.begin(), g.body.end());
+    return std::max<std::size_t>(1, static_cast<std::size_t>(run(both) - run(g.setup)));
+}
+
+Bytes straight_line(const Group& g) {
+    Bytes p = g.setup;
+    while (p.size() + g.body.size() < kStraightBytes) p.insert(p.end(), g.body.begin(), g.body.end());
+    p.push_back(0x76);   // HALT
+    return p;
+}
+
+Bytes looped(const Group& g) {
+    Bytes p = g.setup;
+    const Bytes init = {0xD9, 0x06, kLoopCount, 0xD9};   // EXX / LD B,n / EXX
+    p.insert(p.end(), init.begin(), init.end());
+    const uint16_t loop = static_cast<uint16_t>(p.size());
+    const std::size_t copies = std::max<std::size_t>(1, kLoopedInstructions / count_instructions(g));
+    for (std::size_t i = 0; i < copies; ++i) p.insert(p.end(), g.body.begin(), g.body.end());
+    // EXX / DEC B / EXX / JP NZ,loop / HALT — EXX leaves the flags alone.
+    const Bytes tail = {0xD9, 0x05, 0xD9, 0xC2, static_cast<uint8_t>(loop), static_cast<uint8_t>(loop >> 8),
+                        0x76};
+    p.insert(p.end(), tail.begin(), tail.end());
+    return p;
+}
+
+/// HALT loop woken by the harness: 64 interrupts, each running EI / RETI.
+Bytes interrupt_program(bool im2) {
+    Bytes p(0x100, 0x00);
+    p[0] = 0xC3;   // JP 0x0100
+    p[2] = 0x01;
+    p[0x38] = 0xFB;   // 0x0038: EI
+    p[0x39] = 0xED;   //         RETI
+    p[0x3A] = 0x4D;
+    Bytes main = {0x31, 0x00, 0xF0};   // LD SP,0xF000
+    if (im2) {
+        const Bytes vector = {0x3E, 0x80,           // LD A,0x80
+                              0xED, 0x47,           // LD I,A
+                              0x21, 0x38, 0x00,     // LD HL,0x0038
+                              0x22, 0xFF, 0x80,     // LD (0x80FF),HL
+                              0xED, 0x5E};          // IM 2
+        main.insert(main.end(), vector.begin(), vector.end());
+    } else {
+        main.insert(main.end(), {0xED, 0x56});      // IM 1
+    }
+    main.insert(main.end(), {0x06, kLoopCount,      // LD B,64
+                             0xFB,                  // EI
+                             0x76,                  // loop: HALT
+                             0x10, 0xFD,            // DJNZ loop
+                             0xF3,                  // DI
+                             0x76});                // HALT (not woken: ends the rep)
+    p.insert(p.end(), main.begin(), main.end());
+    return p;
+}
+
+struct Workload {
+    std::string name;     ///< "<group>/<variant>"
+    Bytes program;
+    bool interrupts = false;
+};
+
+std::vector<Workload> workloads() {
+    std::vector<Workload> out;
+    for (const Group& g : groups()) {
+        out.push_back({std::string(g.name) + "/straight", straight_line(g)});
+        out.push_back({std::string(g.name) + "/looped", looped(g)});
+    }
+    out.push_back({"interrupt/im1", interrupt_program(false), true});
+    out.push_back({"interrupt/im2", interrupt_program(true), true});
+    return out;
+}
+
+/// Short column titles for the summary grid, in for_each_config() order.
+std::string short_config(const std::string& config) {
+    if (config == "FastMemory/OpenBusIo") return "Fast/OpenBus";
+    if (config == "ObservableMemory/OpenBusIo") return "Obs/OpenBus";
+    if (config == "ObservableMemory/ObservableIo<Latched>") return "Obs/Latched";
+    if (config == "ObservableMemory/ObservableIo<Callback>") return "Obs/Callback";
+    if (config == "FastMemory/OpenBusIo/Instrumented") return "Fast/Instr";
+    if (config == "ObservableMemory/ObservableIo<Callback>/Instrumented") return "Obs/Cb/Instr";
+    if (config == "ObservableMemory/ReplayIo") return "Obs/Replay";
+    if (config == "FastMemory/PortTableIo") return "Fast/PortTbl";
+    return config;
+}
+
+/// Workloads down, configurations across: median ns per instruction.
+void print_grid(const std::vector<bench::Result>& results) {
+    std::vector<std::string> configs;
+    std::vector<std::string> rows;
+    std::map<std::pair<std::string, std::string>, double> cell;
+    for (const bench::Result& r : results) {
+        if (std::find(configs.begin(), configs.end(), r.config) == configs.end()) configs.push_back(r.config);
+        if (std::find(rows.begin(), rows.end(), r.workload) == rows.end()) rows.push_back(r.workload);
+        cell[{r.workload, r.config}] = r.stats.median;
+    }
+    std::cout << "ns per emulated instruction (median)\n" << std::left << std::setw(20) << "Group" << std::right;
+    for (const std::string& c : configs) std::cout << std::setw(14) << short_config(c);
+    std::cout << '\n' << std::string(20 + 14 * configs.size(), '-') << '\n';
+    for (const std::string& row : rows) {
+        std::cout << std::left << std::setw(20) << row << std::right << std::fixed << std::setprecision(2);
+        for (const std::string& c : configs) {
+            const auto it = cell.find({row, c});
+            if (it == cell.end()) std::cout << std::setw(14) << "-";
+            else std::cout << std::setw(14) << it->second;
+        }
+        std::cout << '\n';
+    }
+}
+
+/// --check: every program halts, repeats exactly, and does the same work on
+/// every configuration.
+int check_programs() {
+    int bad = 0;
+    for (const Workload& w : workloads()) {
+        std::optional<bench::Work> reference;
+        bool same = true;
+        bench::for_each_config([&]<class Cpu>(std::type_identity<Cpu>, const char*) {
+            if (w.interrupts && !bench::TakesInterrupts<Cpu>::value) return;
+            bench::ProgramWorkload<Cpu> p(w.program);
+            if (w.interrupts) p.interrupt_on_halt();
+            const std::optional<bench::Work> work = p.count();
+            if (!work || work->instructions == 0) {
+                same = false;
+                return;
+            }
+            if (!reference) reference = work;
+            same = same && work->instructions == reference->instructions && work->tstates == reference->tstates;
+        });
+        std::cout << (same ? "  ✓ " : "  ✗ ") << std::left << std::setw(20) << w.name;
+        if (reference)
+            std::cout << reference->instructions << " instructions, " << reference->tstates << " T-states";
+        std::cout << '\n';
+        bad += !same;
+    }
+    if (bad) {
+        std::cout << "❌ " << bad << " program(s) failed\n";
+        return 1;
+    }
+    std::cout << "✅ ALL OPCODE-BENCHMARK PROGRAMS VALID\n";
+    return 0;
+}
+
+void usage(const char* prog) {
+    std::cout
+        << "Usage:\n"
+        << "  " << prog << " [--quick] [--samples N] [--filter TEXT] [--json FILE] [--no-pin] [--perf]\n"
+        << "  " << prog << " --compare BASE.json NEW.json [--threshold PCT]\n"
+        << "  " << prog << " --check\n"
+        << "  " << prog << " --list\n\n"
+        << "  --quick, -q       7 samples of >= 2 ms, short warm-up\n"
+        << "  --samples N       timed samples per workload and config (default 15)\n"
+        << "  --filter TEXT     only workloads or configs whose name contains TEXT\n"
+        << "  --json FILE       write the results (schema " << bench::kSchema << ")\n"
+        << "  --no-pin          do not pin the process to its current CPU\n"
+        << "  --perf            also read host hardware counters (Linux perf_event)\n"
+        << "  --compare A B     compare two result files; exit 1 on a significant slowdown\n"
+        << "  --threshold PCT   smallest change that counts (default 3)\n"
+        << "  --check           verify every program on every config, no timing\n"
+        << "  --list            list the opcode groups\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    bench::Settings settings;
+    settings.samples = 15;
+    settings.min_sample_s = 0.005;
+    settings.warmup_s = 0.1;
+    settings.max_warmup_s = 1.0;
+    std::string json;
+    std::string filter;
+    std::string compare_base;
+    std::string compare_current;
+    double threshold_pct = 3.0;
+    bool pin = true;
+    bool use_perf = false;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--quick" || arg == "-q") {
+            settings.samples = 7;
+            settings.min_sample_s = 0.002;
+            settings.warmup_s = 0.02;
+            settings.max_warmup_s = 0.2;
+        } else if (arg == "--samples" && i + 1 < argc) {
+            settings.samples = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--filter" && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (arg == "--json" && i + 1 < argc) {
+            json = argv[++i];
+        } else if (arg == "--no-pin") {
+            pin = false;
+        } else if (arg == "--perf") {
+            use_perf = true;
+        } else if (arg == "--compare" && i + 2 < argc) {
+            compare_base = argv[++i];
+            compare_current = argv[++i];
+        } else if (arg == "--threshold" && i + 1 < argc) {
+            threshold_pct = std::atof(argv[++i]);
+        } else if (arg == "--check") {
+            return check_programs();
+        } else if (arg == "--list") {
+            for (const Group& g : groups()) std::cout << std::left << std::setw(10) << g.name << g.what << '\n';
+            std::cout << std::left << std::setw(10) << "interrupt" << "IM 1 / IM 2 acceptance + EI / RETI\n";
+            return 0;
+        } else if (arg == "--help" || arg == "-h") {
+            usage(argv[0]);
+            return 0;
+        } else {
+            std::cerr << "unknown option: " << arg << "\n\n";
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (!compare_base.empty()) return bench::compare_files(compare_base, compare_current, threshold_pct, std::cout);
+
+    std::cout << "Z80 Digital Twin - Opcode Group Microbenchmarks\n"
+              << "===============================================\n";
+    bench::Report report;
+    report.env = bench::capture_environment(pin);
+    report.settings = settings;
+    std::optional<bench::PerfCounters> perf;
+    if (use_perf) {
+        perf.emplace();
+        report.env.perf = perf->describe();
+    }
+    std::cout << report.env.compiler << ", " << report.env.build << ", "
+              << (report.env.cpu >= 0 ? "pinned to CPU " + std::to_string(report.env.cpu) : "not pinned")
+              << (report.env.governor.empty() ? "" : ", governor " + report.env.governor) << "\n\n";
+
+    int errors = 0;
+    for (const Workload& w : workloads()) {
+        bench::for_each_config([&]<class Cpu>(std::type_identity<Cpu>, const char* config) {
+            if (w.interrupts && !bench::TakesInterrupts<Cpu>::value) return;
+            if (!filter.empty() && w.name.find(filter) == std::string::npos &&
+                std::string(config).find(filter) == std::string::npos)
+                return;
+            std::cout << "  " << w.name << " / " << config << "..." << std::flush;
+            std::string error;
+            if (std::optional<bench::Result> r =
+                    bench::measure_program<Cpu>(w.name, config, w.program, settings, &error, w.interrupts,
+                                                perf ? &*perf : nullptr)) {
+                std::cout << " " << r->stats.median << " ns/instr\n";
+                report.results.push_back(std::move(*r));
+            } else {
+                std::cout << " ❌ " << error << '\n';
+                ++errors;
+            }
+        });
+    }
+
+    std::cout << '\n';
+    print_grid(report.results);
+    std::cout << '\n';
+    bench::print_table(std::cout, report.results);
+    std::cout << '\n';
+    if (perf && perf->available()) {
+        bench::print_counters(std::cout, report.results);
+        std::cout << '\n';
+    }
+    bench::print_environment_warnings(std::cout, report);
+
+    if (!json.empty()) {
+        std::string error;
+        if (!bench::write_json_file(json, report, &error)) {
+            std::cerr << "error: " << error << '\n';
+            return 1;
+        }
+        std::cout << "results written to " << json << '\n';
+    }
+    return errors ? 1 : 0;
+}
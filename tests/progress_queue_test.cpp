@@ -0,0 +1,98 @@
+//
+// Z80 Digital Twin - suite runner progress queue verification
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// Checks tools/cpu_suite_runner/progress_queue.h:
+//   1. FIFO order on one thread, and a full queue drops instead of blocking;
+//   2. many producers racing one consumer: nothing lost or duplicated while
+//      there is room, and each producer's events arrive in the order pushed.
+//
+
+#include "progress_queue.h"
+
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using z80::suite::ProgressQueue;
+
+int failures = 0;
+void check(bool ok, const char* what) {
+    std::cout << (ok ? "  ✓ " : "  ✗ ") << what << '\n';
+    if (!ok) ++failures;
+}
+
+struct Event {
+    uint32_t producer = 0;
+    uint32_t sequence = 0;
+};
+
+} // namespace
+
+int main() {
+    std::cout << "Progress queue\n==============\n";
+
+    // --- 1. One thread ---------------------------------------------------------
+    std::cout << "\n[1] Order and overflow\n";
+    {
+        ProgressQueue<int, 4> q;
+        check(!q.try_pop(), "a new queue is empty");
+        bool pushed = true;
+        for (int i = 0; i < 4; ++i) pushed = q.try_push(i) && pushed;
+        check(pushed && !q.try_push(99) && q.dropped() == 1, "the fifth push into 4 slots is dropped and counted");
+        bool order = true;
+        for (int i = 0; i < 4; ++i) order = q.try_pop() == i && order;
+        check(order && !q.try_pop(), "pops come back in push order, then empty");
+        for (int lap = 0; lap < 10; ++lap) {
+            q.try_push(lap);
+            order = q.try_pop() == lap && order;
+        }
+        check(order && q.dropped() == 1, "slots are reused across many laps");
+    }
+
+    // --- 2. Threads ----------------------------------------------------------------
+    std::cout << "\n[2] Four producers, one consumer\n";
+    {
+        constexpr uint32_t kProducers = 4;
+        constexpr uint32_t kEach = 100'000;
+        ProgressQueue<Event, 1024> q;
+
+        std::vector<std::thread> producers;
+        for (uint32_t p = 0; p < kProducers; ++p) {
+            producers.emplace_back([&q, p] {
+                for (uint32_t n = 0; n < kEach;) {
+                    if (q.try_push({p, n})) ++n;
+                    else std::this_thread::yield();   // the test retries; the runner would drop
+                }
+            });
+        }
+
+        std::vector<uint32_t> expected(kProducers, 0);
+        bool in_order = true;
+        for (uint64_t received = 0; received < uint64_t{kProducers} * kEach;) {
+            if (const auto e = q.try_pop()) {
+                in_order = e->producer < kProducers && e->sequence == expected[e->producer] && in_order;
+                if (e->producer < kProducers) ++expected[e->producer];
+                ++received;
+            }
+        }
+        for (std::thread& t : producers) t.join();
+
+        bool all = true;
+        for (uint32_t n : expected) all = n == kEach && all;
+        check(all && !q.try_pop(), "every event received exactly once");
+        check(in_order, "each producer's events in push order");
+    }
+
+    std::cout << "\n==============\n";
+    if (failures == 0) {
+        std::cout << "✅ ALL PROGRESS-QUEUE CHECKS PASSED\n";
+        return 0;
+    }
+    std::cout << "❌ " << failures << " check(s) FAILED\n";
+    return 1;
+}
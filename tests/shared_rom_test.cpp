@@ -0,0 +1,225 @@
+//
+// Z80 Digital Twin - shared ROM page verification
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// Checks src/memory/shared_rom.h and ObservableMemory's read-only prefix:
+//   1. opening: a missing file and an oversized one are refused;
+//   2. mapping: the ROM (then zeros) over a page-aligned image, mapped from
+//      the file itself; a misaligned image, or a type MakePageAligned cannot
+//      place, is refused with a reason;
+//   3. writes there are refused — emulated (and reported), Raw*, and after
+//      ClearWriteProtect — while RAM stays writable;
+//   4. a copy is private writable memory with the same bytes; dropping the
+//      prefix gives the image writable pages back;
+//   5. a Spectrum on the shared ROM runs exactly like one with a loaded,
+//      write-protected ROM, in this process and in a forked child.
+//
+
+#include "memory/shared_rom.h"
+#include "spectrum/spectrum_machine.h"
+#include "spectrum/state_hash.h"
+#include "spectrum_stand_in_rom.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+namespace sm = z80::machine::spectrum;
+namespace zt = z80::test;
+using z80::ObservableMemory;
+using z80::SharedRom;
+
+int failures = 0;
+void check(bool ok, const char* what) {
+    std::cout << (ok ? "  ✓ " : "  ✗ ") << what << '\n';
+    if (!ok) ++failures;
+}
+
+// Stand-in ROM (spectrum_stand_in_rom.h) whose main loop also tries to store
+// its counter into the ROM at 0x0100 (which holds 0xA5):
+//   0x0007  LD HL,(0x9002) / INC HL / LD (0x9002),HL / LD (0x0100),HL /
+//           LD A,L / OUT (0xFE),A / JR 0x0007
+std::vector<uint8_t> test_rom() {
+    const std::vector<uint8_t> store_into_rom = {0x22, 0x00, 0x01};
+    std::vector<uint8_t> rom = zt::stand_in_rom(
+        {zt::kStartIm1, zt::forever({zt::kBumpCounter, store_into_rom, zt::kBorderFromL})}, 0x120);
+    rom[0x100] = 0xA5;
+    return rom;
+}
+
+std::string write_file(const std::string& path, const std::vector<uint8_t>& bytes) {
+    std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(bytes.data()),
+                                                static_cast<std::streamsize>(bytes.size()));
+    return path;
+}
+
+ObservableMemory& memory_of(ObservableMemory& m) { return m; }
+
+/// Over-aligned so no shift puts its image on a page and keeps it aligned.
+struct alignas(8192) Unplaceable {
+    unsigned char tag[64] = {};
+    ObservableMemory memory;
+};
+ObservableMemory& unplaceable_memory(Unplaceable& u) { return u.memory; }
+ObservableMemory& machine_memory(sm::SpectrumMachine& m) { return m.cpu().GetMemory(); }
+
+/// Is @p address inside a mapping of @p path, by /proc/self/maps?
+bool mapped_from(const void* address, const std::string& path) {
+    std::ifstream maps("/proc/self/maps");
+    for (std::string line; std::getline(maps, line);) {
+        unsigned long lo = 0, hi = 0;
+        if (std::sscanf(line.c_str(), "%lx-%lx", &lo, &hi) != 2) continue;
+        const auto a = reinterpret_cast<unsigned long>(address);
+        if (a >= lo && a < hi) return line.size() >= path.size() && line.ends_with(path);
+    }
+    return false;
+}
+
+uint64_t run_frames(sm::SpectrumMachine& m, int frames) {
+    for (int f = 0; f < frames; ++f) m.run_frame();
+    return sm::state_hash(m);
+}
+
+} // namespace
+
+int main() {
+    std::cout << "Shared ROM pages\n================\n";
+    const std::vector<uint8_t> rom = test_rom();
+    const std::string rom_path = write_file("/tmp/z80-shared-rom-test-" + std::to_string(::getpid()) + ".rom", rom);
+
+    // --- 1. Opening ----------------------------------------------------------------
+    std::cout << "\n[1] Opening\n";
+    {
+        std::string why;
+        check(!SharedRom::Open(rom_path + ".missing", &why).ok() && !why.empty(), "a missing file is refused");
+        const std::string big = write_file(rom_path + ".big", std::vector<uint8_t>(0x4001, 0));
+        check(!SharedRom::Open(big, &why).ok() && why.find("16 KB") != std::string::npos,
+              "a file over 16 KB is refused");
+        std::remove(big.c_str());
+        const SharedRom shared = SharedRom::Open(rom_path);
+        check(shared.ok() && shared.size() == rom.size(), "a ROM opens");
+    }
+
+    const SharedRom shared = SharedRom::Open(rom_path);
+
+    // --- 2. Mapping ----------------------------------------------------------------
+    std::cout << "\n[2] Mapping\n";
+    {
+        auto a = z80::MakePageAligned<ObservableMemory>(memory_of);
+        auto b = z80::MakePageAligned<ObservableMemory>(memory_of);
+        check(reinterpret_cast<uintptr_t>(a->ImagePages()) % SharedRom::PageSize() == 0,
+              "MakePageAligned puts the image on a page");
+        (*a)[0x9000] = 0x42;
+        check(shared.MapInto(*a) && shared.MapInto(*b) && a->ReadOnlyEnd() == 0x4000, "the ROM maps over two images");
+        check(std::equal(rom.begin(), rom.end(), a->Data()) && std::all_of(a->Data() + rom.size(), a->Data() + 0x4000,
+                                                                           [](uint8_t v) { return v == 0; }),
+              "they read the ROM, then zeros to 0x4000");
+        check((*a)[0x9000] == 0x42, "RAM is untouched");
+        check(mapped_from(a->Data(), rom_path) && mapped_from(b->Data(), rom_path),
+              "both map the file itself (one copy, in the page cache)");
+
+        alignas(4096) static unsigned char raw[sizeof(ObservableMemory) + 4096];
+        auto* skewed = new (raw + 64) ObservableMemory();
+        std::string why;
+        check(!shared.MapInto(*skewed, &why) && skewed->ReadOnlyEnd() == 0 && why.find("page") != std::string::npos,
+              "a misaligned image is refused, saying why");
+        skewed->~ObservableMemory();
+
+        auto u = z80::MakePageAligned<Unplaceable>(unplaceable_memory);
+        why.clear();
+        check(!u.get_deleter().placed && !shared.MapInto(u->memory, &why) && !why.empty(),
+              "a type that cannot be placed is flagged, and refused");
+    }
+
+    // --- 3. Refused writes -----------------------------------------------------------
+    std::cout << "\n[3] Writes to the shared pages\n";
+    {
+        auto m = z80::MakePageAligned<ObservableMemory>(memory_of);
+        shared.MapInto(*m);
+        int blocked = 0;
+        m->AddBlockedWriteObserver([&blocked](uint16_t, uint8_t, uint8_t) { ++blocked; });
+        (*m)[0x0100] = 0x00;
+        check((*m)[0x0100] == 0xA5 && blocked == 1, "an emulated write is refused and reported");
+        m->RawWrite(0x0101, 0x77);
+        std::vector<uint8_t> image(0x10000, 0xEE);
+        m->RawLoad(0x0000, image);
+        check((*m)[0x0101] == 0x00 && (*m)[0x0100] == 0xA5 && (*m)[0x4000] == 0xEE && (*m)[0xFFFF] == 0xEE,
+              "RawWrite and RawLoad skip them and load the rest");
+        check(m->RawRegion(0x0000, 16).empty() && m->RawRegion(0x4000, 16).size() == 16,
+              "RawRegion will not hand them out");
+        m->ClearWriteProtect();
+        (*m)[0x0100] = 0x00;
+        (*m)[0x8000] = 0x11;
+        check((*m)[0x0100] == 0xA5 && (*m)[0x8000] == 0x11 && !m->WriteProtectRange(),
+              "ClearWriteProtect leaves them protected, RAM writable");
+    }
+
+    // --- 4. Copies and release ---------------------------------------------------------
+    std::cout << "\n[4] Copies and release\n";
+    {
+        auto m = z80::MakePageAligned<ObservableMemory>(memory_of);
+        shared.MapInto(*m);
+        ObservableMemory copy = *m;
+        copy.RawWrite(0x0100, 0x00);
+        check(copy.ReadOnlyEnd() == 0 && copy[0x0100] == 0x00 && copy[0x0000] == rom[0] && (*m)[0x0100] == 0xA5,
+              "a copy is private, writable, with the same bytes");
+        copy = *m;
+        *m = copy;   // assigning over mapped pages makes them writable first
+        check(m->ReadOnlyEnd() == 0 && (*m)[0x0100] == 0xA5, "assignment over mapped pages is safe");
+        shared.MapInto(*m);
+        m->SetReadOnlyPrefix(0, nullptr);
+        m->RawWrite(0x0100, 0x33);
+        check(m->ReadOnlyEnd() == 0 && (*m)[0x0100] == 0x33 && (*m)[0x0000] == 0x00,
+              "dropping the prefix gives back zeroed, writable pages");
+    }
+
+    // --- 5. Machines -------------------------------------------------------------------
+    std::cout << "\n[5] A Spectrum on the shared ROM\n";
+    constexpr int kFrames = 50;
+    sm::SpectrumMachine loaded;
+    loaded.load_rom(rom);
+    loaded.set_rom_write_protect(true);
+    const uint64_t expected = run_frames(loaded, kFrames);
+    {
+        auto m = z80::MakePageAligned<sm::SpectrumMachine>(machine_memory);
+        check(shared.MapInto(m->cpu().GetMemory()), "the ROM maps into a placed machine");
+        m->cpu().Reset();
+        check(run_frames(*m, kFrames) == expected && m->cpu().GetMemory()[0x9004] > 0,
+              "it runs exactly as with a loaded, write-protected ROM");
+        check(m->cpu().GetMemory()[0x0100] == 0xA5, "its writes to the ROM were refused");
+    }
+    {
+        const pid_t child = ::fork();
+        if (child == 0) {
+            auto m = z80::MakePageAligned<sm::SpectrumMachine>(machine_memory);
+            const bool ok = shared.MapInto(m->cpu().GetMemory()) && (m->cpu().Reset(), run_frames(*m, kFrames)) == expected &&
+                            mapped_from(m->cpu().GetMemory().Data(), rom_path);
+            ::_exit(ok ? 0 : 1);
+        }
+        int status = -1;
+        ::waitpid(child, &status, 0);
+        check(child > 0 && WIFEXITED(status) && WEXITSTATUS(status) == 0,
+              "a forked worker maps the same file and gets the same run");
+    }
+
+    std::remove(rom_path.c_str());
+    std::cout << '\n';
+    if (failures == 0) {
+        std::cout << "✅ ALL SHARED ROM CHECKS PASSED\n";
+        return 0;
+    }
+    std::cout << "❌ " << failures << " check(s) FAILED\n";
+    return 1;
+}
@@ -0,0 +1,216 @@
+//
+// Z80 Digital Twin - single-step vector runner verification
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// Checks tools/single_step_runner on handcrafted vectors:
+//   1. JsonScanner walks nested values, skips what it is not asked for,
+//      and reports malformed text (a missing, leading or trailing comma, an
+//      unterminated string) with its offset;
+//   2. a correct vector passes, and a wrong register, wrong T-states or a
+//      wrong RAM byte is reported; an ignored register is not;
+//   3. a write the vector does not list is caught, and the next vector on
+//      the same runner starts from clean memory;
+//   4. IN takes its value from the vector's port list; OUT is compared;
+//   5. run_file counts the failures of a file and rejects a malformed one.
+//
+
+#include "single_step.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <initializer_list>
+#include <iostream>
+#include <string>
+#include <utility>
+
+namespace {
+
+using namespace z80::single_step;
+
+int failures = 0;
+void check(bool ok, const char* what) {
+    std::cout << (ok ? "  ✓ " : "  ✗ ") << what << '\n';
+    if (!ok) ++failures;
+}
+
+using Regs = std::initializer_list<std::pair<const char*, unsigned>>;
+using Ram = std::initializer_list<std::pair<unsigned, unsigned>>;
+
+std::string state_json(Regs regs, Ram ram) {
+    std::string s = "{";
+    for (const auto& [name, value] : regs) s += std::string("\"") + name + "\": " + std::to_string(value) + ", ";
+    s += "\"ram\": [";
+    bool first = true;
+    for (const auto& [address, value] : ram) {
+        s += (first ? "[" : ", [") + std::to_string(address) + ", " + std::to_string(value) + "]";
+        first = false;
+    }
+    return s + "]}";
+}
+
+/// One vector as the test files write it; @p cycles entries of bus activity.
+std::string vector_json(const std::string& name, const std::string& initial, const std::string& final_state,
+                        int cycles, const std::string& ports = "") {
+    std::string s = "{\"name\": \"" + name + "\", \"initial\": " + initial + ", \"final\": " + final_state +
+                    ", \"cycles\": [";
+    for (int i = 0; i < cycles; ++i) s += std::string(i ? ", " : "") + "[0, null, \"r-m-\"]";
+    s += "]";
+    if (!ports.empty()) s += ", \"ports\": " + ports;
+    return s + "}";
+}
+
+/// Parse and run the single vector in @p json.
+std::string run_one(VectorRunner& runner, const std::string& json) {
+    JsonScanner s(json);
+    s.expect('[');
+    Vector v;
+    if (!next_vector(s, v) || !s.ok()) return "parse error: " + s.error();
+    return runner.run(v);
+}
+
+} // namespace
+
+int main() {
+    std::cout << "Single-step vector runner\n";
+
+    std::cout << "\n[1] JsonScanner\n";
+    {
+        JsonScanner s(R"( {"a": [1, {"x": "y\"z"}, true, null, -1.5e3], "b" : 42 } )");
+        s.expect('{');
+        check(s.element('}') && s.key() == "a", "first key");
+        s.skip_value();
+        check(s.element('}') && s.key() == "b" && s.number() == 42, "nested value skipped, next key read");
+        check(!s.element('}') && s.ok() && s.at_end(), "object closes cleanly");
+
+        JsonScanner bad(R"([1, 2,])");
+        bad.expect('[');
+        while (bad.element(']')) bad.number();
+        check(!bad.ok() && bad.error().find("trailing comma") != std::string::npos, "trailing comma rejected");
+
+        const auto walk = [](std::string_view text) {
+            JsonScanner w(text);
+            w.skip_value();
+            return w;
+        };
+        const JsonScanner no_comma = walk("[1 2]");
+        check(!no_comma.ok() && no_comma.error().find("expected ','") != std::string::npos,
+              "missing comma between elements rejected");
+        check(!walk(R"({"a": 1 "b": 2})").ok(), "missing comma between members rejected");
+        const JsonScanner leading = walk("[,1]");
+        check(!leading.ok() && leading.error().find("leading comma") != std::string::npos, "leading comma rejected");
+        check(walk(R"([ [], {}, [1,[2 ,3]], {"a":{"b":[]} } ])").ok(), "empty and nested containers still pass");
+
+        JsonScanner open(R"(["abc)");
+        open.expect('[');
+        while (open.element(']')) open.skip_value();
+        check(!open.ok() && open.error().find("offset") != std::string::npos, "unterminated string reported");
+    }
+
+    VectorRunner runner;
+    const std::string nop_in = state_json({{"pc", 0x8000}, {"sp", 0xFFFF}, {"a", 0x12}, {"r", 0x7F}}, {{0x8000, 0x00}});
+
+    std::cout << "\n[2] Registers, T-states and RAM compared\n";
+    {
+        const std::string nop_out = state_json({{"pc", 0x8001}, {"sp", 0xFFFF}, {"a", 0x12}, {"r", 0x00}}, {{0x8000, 0x00}});
+        check(run_one(runner, "[" + vector_json("00 0", nop_in, nop_out, 4) + "]").empty(),
+              "NOP: PC, R (bit 7 kept) and 4 T-states match");
+
+        const std::string wrong_a =
+            state_json({{"pc", 0x8001}, {"sp", 0xFFFF}, {"a", 0x13}, {"r", 0x00}}, {{0x8000, 0x00}});
+        const std::string diff = run_one(runner, "[" + vector_json("00 1", nop_in, wrong_a, 4) + "]");
+        check(diff == "a 12h want 13h", "wrong register named with both values");
+
+        const std::string cycles = run_one(runner, "[" + vector_json("00 2", nop_in, nop_out, 5) + "]");
+        check(cycles == "cycles 4 want 5", "wrong T-state count reported");
+
+        const std::string wrong_ram =
+            state_json({{"pc", 0x8001}, {"sp", 0xFFFF}, {"a", 0x12}, {"r", 0x00}}, {{0x8000, 0x00}, {0x9000, 0x55}});
+        check(run_one(runner, "[" + vector_json("00 3", nop_in, wrong_ram, 4) + "]") == "(9000h) 00h want 55h",
+              "wrong RAM byte reported");
+
+        VectorRunner lenient;
+        lenient.ignore(find_reg("a"));
+        check(find_reg("a") == kA && find_reg("xy") == kRegCount, "registers found by vector name");
+        check(run_one(lenient, "[" + vector_json("00 1", nop_in, wrong_a, 4) + "]").empty(), "ignored register not compared");
+    }
+
+    std::cout << "\n[3] Stray writes and clean memory\n";
+    {
+        // LD (HL),A with HL = C000h; the final state forgets to list C000h.
+        const std::string in = state_json({{"pc", 0x8000}, {"a", 0xAA}, {"h", 0xC0}, {"l", 0x00}}, {{0x8000, 0x77}});
+        const std::string listed =
+            state_json({{"pc", 0x8001}, {"a", 0xAA}, {"h", 0xC0}, {"l", 0x00}, {"r", 1}}, {{0x8000, 0x77}, {0xC000, 0xAA}});
+        const std::string unlisted =
+            state_json({{"pc", 0x8001}, {"a", 0xAA}, {"h", 0xC0}, {"l", 0x00}, {"r", 1}}, {{0x8000, 0x77}});
+        check(run_one(runner, "[" + vector_json("77 0", in, listed, 7) + "]").empty(), "LD (HL),A with the write listed");
+        check(run_one(runner, "[" + vector_json("77 1", in, unlisted, 7) + "]") == "stray write (C000h)",
+              "unlisted write caught");
+
+        // The same with A = 00h: the byte stays zero, but the write happened.
+        const std::string in_zero = state_json({{"pc", 0x8000}, {"a", 0x00}, {"h", 0xC0}, {"l", 0x00}}, {{0x8000, 0x77}});
+        const std::string unlisted_zero =
+            state_json({{"pc", 0x8001}, {"a", 0x00}, {"h", 0xC0}, {"l", 0x00}, {"r", 1}}, {{0x8000, 0x77}});
+        check(run_one(runner, "[" + vector_json("77 2", in_zero, unlisted_zero, 7) + "]") == "stray write (C000h)",
+              "unlisted write of 00h caught");
+
+        const std::string nop_out = state_json({{"pc", 0x8001}, {"sp", 0xFFFF}, {"a", 0x12}, {"r", 0x00}}, {{0x8000, 0x00}});
+        check(run_one(runner, "[" + vector_json("00 4", nop_in, nop_out, 4) + "]").empty(),
+              "next vector sees no leftovers");
+        check(runner.cpu().GetMemory()[0xC000] == 0 && runner.cpu().GetMemory()[0x8000] == 0,
+              "written and loaded pages zeroed between vectors");
+    }
+
+    std::cout << "\n[4] Ports\n";
+    {
+        // WZ is set as the hardware's MEMPTR would be, but the CPU does not
+        // keep it for IN/OUT (n); ignore it here.
+        VectorRunner io;
+        io.ignore(kWz);
+        // IN A,(FEh) with A = 12h: port 12FEh reads 5Ah; WZ = 12FFh.
+        const std::string in = state_json({{"pc", 0x8000}, {"a", 0x12}}, {{0x8000, 0xDB}, {0x8001, 0xFE}});
+        const std::string out =
+            state_json({{"pc", 0x8002}, {"a", 0x5A}, {"r", 1}, {"wz", 0x12FF}}, {{0x8000, 0xDB}, {0x8001, 0xFE}});
+        check(run_one(io, "[" + vector_json("db 0", in, out, 11, R"([[4862, 90, "r"]])") + "]").empty(),
+              "IN A,(n) reads the vector's port value");
+
+        // OUT (FEh),A with A = 07h: port 07FEh written 07h; WZ = 07FFh.
+        const std::string oin = state_json({{"pc", 0x8000}, {"a", 0x07}}, {{0x8000, 0xD3}, {0x8001, 0xFE}});
+        const std::string oout =
+            state_json({{"pc", 0x8002}, {"a", 0x07}, {"r", 1}, {"wz", 0x07FF}}, {{0x8000, 0xD3}, {0x8001, 0xFE}});
+        check(run_one(io, "[" + vector_json("d3 0", oin, oout, 11, R"([[2046, 7, "w"]])") + "]").empty(),
+              "OUT (n),A matches the vector's write");
+        check(!run_one(io, "[" + vector_json("d3 1", oin, oout, 11, R"([[2046, 8, "w"]])") + "]").empty(),
+              "OUT of the wrong value reported");
+    }
+
+    std::cout << "\n[5] run_file\n";
+    {
+        const auto dir = std::filesystem::temp_directory_path() / "z80_single_step_test";
+        std::filesystem::create_directories(dir);
+        const std::string nop_out = state_json({{"pc", 0x8001}, {"sp", 0xFFFF}, {"a", 0x12}, {"r", 0x00}}, {{0x8000, 0x00}});
+        std::ofstream(dir / "00.json") << "[\n" << vector_json("00 0", nop_in, nop_out, 4) << ",\n"
+                                       << vector_json("00 1", nop_in, nop_out, 3) << ",\n"
+                                       << vector_json("00 2", nop_in, nop_out, 4) << "\n]\n";
+        const GroupResult ok = run_file(dir / "00.json", runner, 3);
+        check(ok.name == "00" && ok.vectors == 3 && ok.failed == 1 && ok.error.empty(), "3 vectors, 1 failure");
+        check(ok.examples.size() == 1 && ok.examples[0] == "00 1: cycles 4 want 3", "failure example names the vector");
+
+        std::ofstream(dir / "bad.json") << "[" << vector_json("00 0", nop_in, nop_out, 4) << "] x";
+        const GroupResult bad = run_file(dir / "bad.json", runner, 3);
+        check(bad.vectors == 1 && !bad.error.empty(), "trailing text is a file error");
+
+        const GroupResult missing = run_file(dir / "missing.json", runner, 3);
+        check(!missing.error.empty() && missing.vectors == 0, "missing file is a file error");
+        std::filesystem::remove_all(dir);
+    }
+
+    std::cout << "\n============\n";
+    if (failures == 0) {
+        std::cout << "✅ ALL SINGLE-STEP CHECKS PASSED\n";
+        return 0;
+    }
+    std::cout << "❌ " << failures << " check(s) FAILED\n";
+    return 1;
+}
@@ -0,0 +1,319 @@
+//
+// Z80 Digital Twin - ZX Spectrum .sna / .z80 snapshot verification
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// Verifies snapshot import/export against a stand-in ROM:
+//   1. The .z80 RLE codec: the format's edge cases (ED pairs, a lone ED before
+//      a run, 255-byte runs) encode as specified and decode back.
+//   2. .sna and .z80 v1/v2/v3 round trips restore every register, IFF/IM and
+//      the border exactly, and all 48 KB of RAM.
+//   3. A halted CPU saves with PC on its HALT and halts again on load; the two
+//      machines then run in step.
+//   4. A v3 T-state counter resumes mid-frame: no interrupt on the first frame,
+//      which runs only the rest of the frame.
+//   5. Damaged and unsupported files are rejected with the machine untouched.
+//   6. Loading bypasses write observers, keeps dirty-page tracking honest, and
+//      takes microseconds.
+//
+
+#include "spectrum/snapshot.h"
+#include "spectrum/state_hash.h"
+#include "spectrum_stand_in_rom.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+namespace sm = z80::machine::spectrum;
+namespace sd = z80::machine::spectrum::snapshot_detail;
+namespace zt = z80::test;
+
+int failures = 0;
+void check(bool ok, const char* what) {
+    std::cout << (ok ? "  ✓ " : "  ✗ ") << what << '\n';
+    if (!ok) ++failures;
+}
+
+// Stand-in ROMs (spectrum_stand_in_rom.h). A busy main loop, never halted:
+//   0x0007  LD HL,(0x9002) / INC HL / LD (0x9002),HL / LD A,L / OUT (0xFE),A / JR 0x0007
+std::vector<uint8_t> busy_rom() {
+    return zt::stand_in_rom({zt::kStartIm1, zt::forever({zt::kBumpCounter, zt::kBorderFromL})});
+}
+
+// Same, but the main loop idles on HALT between interrupts (like the 48K ROM).
+//   0x0007  HALT / LD HL,(0x9002) / INC HL / LD (0x9002),HL / JR 0x0007
+std::vector<uint8_t> halting_rom() {
+    const std::vector<uint8_t> halt = {0x76};
+    return zt::stand_in_rom({zt::kStartIm1, zt::forever({halt, zt::kBumpCounter})});
+}
+
+// A machine with some history: booted, RAM scribbled, alternate set and index
+// registers loaded, IM 1 with a non-trivial border and R bit 7 set.
+void prepare(sm::SpectrumMachine& m, const std::vector<uint8_t>& rom, int frames) {
+    m.load_rom(rom);
+    for (int f = 0; f < frames; ++f) m.run_frame();
+    z80::ObservableMemory& mem = m.cpu().GetMemory();
+    for (uint32_t a = 0x4000; a < 0x10000; a += 7)
+        mem.RawWrite(static_cast<uint16_t>(a), static_cast<uint8_t>(a * 13));
+    for (uint32_t a = 0xA000; a < 0xA400; ++a) mem.RawWrite(static_cast<uint16_t>(a), 0xED);
+    sm::SpectrumCpu& cpu = m.cpu();
+    cpu.AltAF() = 0x1234;
+    cpu.AltBC() = 0x5678;
+    cpu.AltDE() = 0x9ABC;
+    cpu.AltHL() = 0xDEF0;
+    cpu.IX() = 0x1111;
+    cpu.IY() = 0x2222;
+    cpu.I() = 0x3F;
+    cpu.R() = 0xA5;
+    m.ula().write_port(0xFE, 0x05);
+}
+
+bool same_registers(sm::SpectrumMachine& a, sm::SpectrumMachine& b, bool with_r = true) {
+    auto& x = a.cpu();
+    auto& y = b.cpu();
+    return x.AF() == y.AF() && x.BC() == y.BC() && x.DE() == y.DE() && x.HL() == y.HL() &&
+           x.AltAF() == y.AltAF() && x.AltBC() == y.AltBC() && x.AltDE() == y.AltDE() &&
+           x.AltHL() == y.AltHL() && x.IX() == y.IX() && x.IY() == y.IY() && x.SP() == y.SP() &&
+           x.PC() == y.PC() && x.I() == y.I() && (!with_r || x.R() == y.R()) &&
+           x.IFF1() == y.IFF1() && x.IFF2() == y.IFF2() &&
+           x.InterruptMode() == y.InterruptMode() && a.ula().border() == b.ula().border();
+}
+
+bool same_ram(sm::SpectrumMachine& a, sm::SpectrumMachine& b) {
+    const uint8_t* x = a.cpu().GetMemory().Data();
+    const uint8_t* y = b.cpu().GetMemory().Data();
+    return std::equal(x + 0x4000, x + 0x10000, y + 0x4000);
+}
+
+} // namespace
+
+int main() {
+    std::cout << "Snapshots (.sna / .z80)\n=======================\n";
+
+    // --- 1. RLE ------------------------------------------------------------------
+    std::cout << "\n[1] .z80 RLE codec\n";
+    {
+        const auto enc = [](std::vector<uint8_t> in) {
+            std::vector<uint8_t> out;
+            sd::rle_encode(in, out);
+            return out;
+        };
+        check(enc({0xAA, 0xAA, 0xAA, 0xAA}) == std::vector<uint8_t>{0xAA, 0xAA, 0xAA, 0xAA},
+              "4 repeats stay literal");
+        check(enc({0xAA, 0xAA, 0xAA, 0xAA, 0xAA}) == std::vector<uint8_t>{0xED, 0xED, 0x05, 0xAA},
+              "5 repeats become a run");
+        check(enc({0xED, 0xED}) == std::vector<uint8_t>{0xED, 0xED, 0x02, 0xED}, "ED ED is always a run");
+        check(enc({0xED, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}) ==
+                  std::vector<uint8_t>{0xED, 0x00, 0xED, 0xED, 0x05, 0x00},
+              "the byte after a lone ED stays literal");
+        std::vector<uint8_t> big(600, 0x11);
+        check(enc(big) == std::vector<uint8_t>{0xED, 0xED, 0xFF, 0x11, 0xED, 0xED, 0xFF, 0x11,
+                                               0xED, 0xED, 0x5A, 0x11},
+              "runs split at 255");
+
+        std::vector<uint8_t> mixed;
+        for (int i = 0; i < 5000; ++i)
+            mixed.push_back(static_cast<uint8_t>((i % 97 < 40) ? 0xED : (i % 13 < 6 ? 0 : i)));
+        const std::vector<uint8_t> packed = enc(mixed);
+        std::vector<uint8_t> back(mixed.size());
+        check(sd::rle_decode(packed, back.data(), back.size()) == packed.size() && back == mixed,
+              "ED-heavy data round-trips");
+        check(sd::rle_decode(std::vector<uint8_t>{0xED, 0xED, 0x09, 0x00}, back.data(), 8) == sd::kBad,
+              "a run past the end is rejected");
+        check(sd::rle_decode(std::vector<uint8_t>{0x01, 0x02}, back.data(), 3) == sd::kBad,
+              "short input is rejected");
+    }
+
+    // --- 2. Round trips --------------------------------------------------------------
+    std::cout << "\n[2] .sna and .z80 v1/v2/v3 round trips\n";
+    {
+        sm::SpectrumMachine src;
+        prepare(src, busy_rom(), 30);
+        const uint16_t sp = src.cpu().SP();
+        const uint8_t below[2] = {src.cpu().ReadMemory(static_cast<uint16_t>(sp - 2)),
+                                  src.cpu().ReadMemory(static_cast<uint16_t>(sp - 1))};
+
+        sm::SpectrumMachine sna;
+        sna.load_rom(busy_rom());
+        std::string why;
+        check(sm::load_sna(sna, sm::save_sna(src), &why) && same_registers(src, sna),
+              ".sna: registers, IFF, IM, border");
+        // The saver's PC push lands just below SP; everything else is identical.
+        sna.cpu().GetMemory().RawWrite(static_cast<uint16_t>(sp - 2), below[0]);
+        sna.cpu().GetMemory().RawWrite(static_cast<uint16_t>(sp - 1), below[1]);
+        check(same_ram(src, sna), ".sna: 48 KB RAM (bar the pushed PC)");
+
+        for (int version = 1; version <= 3; ++version) {
+            sm::SpectrumMachine z;
+            z.load_rom(busy_rom());
+            const std::vector<uint8_t> bytes = sm::save_z80(src, version);
+            const bool ok = sm::load_z80(z, bytes, &why) && same_registers(src, z) && same_ram(src, z);
+            const std::string what = ".z80 v" + std::to_string(version) + ": registers and RAM (" +
+                                     std::to_string(bytes.size()) + " bytes)";
+            check(ok, what.c_str());
+            check(sm::save_z80(z, version) == bytes, "  re-saving the loaded machine is byte-identical");
+        }
+
+        sm::SpectrumMachine blank;
+        const std::vector<uint8_t> v3 = sm::save_z80(blank, 3);
+        check(v3.size() < 1000, ".z80 v3 of empty RAM is under 1 KB (255-byte runs)");
+
+        // PC 0000h in a v1 header would read back as v2/v3: saved as v2.
+        sm::SpectrumMachine reset;
+        reset.load_rom(busy_rom());
+        reset.cpu().SP() = 0x8000;
+        const std::vector<uint8_t> v1 = sm::save_z80(reset, 1);
+        sm::SpectrumMachine back;
+        back.load_rom(busy_rom());
+        check(v1.size() >= 32 && sd::word(v1, 30) == 23 && sm::load_z80(back, v1, &why) &&
+                  back.cpu().PC() == 0 && same_registers(reset, back),
+              ".z80 v1 with PC 0000h falls back to v2 and loads");
+    }
+
+    // --- 3. HALT -------------------------------------------------------------------
+    std::cout << "\n[3] A halted CPU resumes halted, and both machines stay in step\n";
+    {
+        sm::SpectrumMachine src;
+        src.load_rom(halting_rom());
+        for (int f = 0; f < 20; ++f) src.run_frame();
+        check(src.cpu().IsHalted(), "stand-in ROM idles on HALT");
+
+        sm::SpectrumMachine dst;
+        dst.load_rom(halting_rom());
+        check(sm::load_z80(dst, sm::save_z80(src)), "loaded");
+        check(dst.cpu().PC() == src.cpu().PC() - 1, "PC on the HALT opcode");
+        dst.cpu().Step();
+        check(dst.cpu().IsHalted() && dst.cpu().PC() == src.cpu().PC(), "re-executes HALT");
+
+        bool step = true;
+        for (int f = 0; f < 30; ++f) {
+            src.run_frame();
+            dst.run_frame();
+            step = step && same_registers(src, dst, false) && same_ram(src, dst);
+        }
+        check(step && src.cpu().ReadMemory(0x9004) == dst.cpu().ReadMemory(0x9004),
+              "30 frames later: same registers (bar R) and RAM");
+    }
+
+    // --- 4. Mid-frame position ----------------------------------------------------
+    std::cout << "\n[4] A v3 T-state counter resumes mid-frame\n";
+    {
+        sm::SpectrumMachine src;
+        prepare(src, busy_rom(), 10);
+        std::vector<uint8_t> bytes = sm::save_z80(src, 3);
+        constexpr uint64_t kAt = 50000;
+        bytes[55] = static_cast<uint8_t>(sd::kQuarter - kAt % sd::kQuarter - 1);
+        bytes[56] = static_cast<uint8_t>((sd::kQuarter - kAt % sd::kQuarter - 1) >> 8);
+        bytes[57] = static_cast<uint8_t>((kAt / sd::kQuarter + 3) % 4);
+        check(sd::z80_tstates(static_cast<uint16_t>(bytes[55] | (bytes[56] << 8)), bytes[57]) == kAt,
+              "counter decodes to the position");
+
+        sm::SpectrumMachine m;
+        m.load_rom(busy_rom());
+        check(sm::load_z80(m, bytes), "loaded");
+        check(m.cpu().GetCycleCount() - m.ula().frame_start() == kAt, "ULA frame clock at the position");
+        check(sm::save_z80(m, 3) == bytes, "re-saved before running: same counter");
+
+        const uint8_t ints = m.cpu().ReadMemory(0x9004);
+        const uint64_t before = m.cpu().GetCycleCount();
+        m.run_frame();
+        const uint64_t ran = m.cpu().GetCycleCount() - before;
+        check(m.cpu().ReadMemory(0x9004) == ints, "no interrupt on the resumed frame");
+        check(ran >= sm::timing::kTPerFrame - kAt && ran < sm::timing::kTPerFrame - kAt + 23,
+              "only the rest of the frame ran");
+        m.run_frame();
+        check(m.cpu().ReadMemory(0x9004) == static_cast<uint8_t>(ints + 1), "next frame interrupts as usual");
+    }
+
+    // --- 5. Damage --------------------------------------------------------------------
+    std::cout << "\n[5] Damaged and unsupported files are rejected untouched\n";
+    {
+        sm::SpectrumMachine src;
+        prepare(src, busy_rom(), 5);
+        sm::SpectrumMachine m;
+        m.load_rom(busy_rom());
+        m.run_frame();
+        const uint64_t before = sm::state_hash(m);
+        std::string why;
+
+        std::vector<uint8_t> bad = sm::save_z80(src, 3);
+        bad.resize(bad.size() - 10);
+        check(!sm::load_z80(m, bad, &why) && why == "truncated file", "truncated page");
+        bad = sm::save_z80(src, 3);
+        bad[34] = 4;   // 128K
+        check(!sm::load_z80(m, bad, &why) && why == "only 48K snapshots are supported", "128K rejected");
+        bad = sm::save_z80(src, 2);
+        bad[32 + 23 + 3] = 0xED;   // first page: ED ED <big> ... overruns
+        bad[32 + 23 + 4] = 0xED;
+        bad[32 + 23 + 5] = 0xFF;
+        const bool rejected = !sm::load_z80(m, bad, &why);
+        check(rejected && (why == "corrupt memory block"), "corrupt RLE rejected");
+        bad = sm::save_z80(src, 1);
+        bad.resize(200);
+        check(!sm::load_z80(m, bad, &why) && why == "corrupt memory block", "v1 image cut short");
+        check(!sm::load_sna(m, std::vector<uint8_t>(100), &why) && why == "not a 48K .sna file",
+              ".sna of the wrong size");
+        check(sm::state_hash(m) == before, "machine unchanged by every failed load");
+    }
+
+    // --- 6. Fast path ---------------------------------------------------------------
+    std::cout << "\n[6] Loads bypass observers, mark pages dirty, and take microseconds\n";
+    {
+        sm::SpectrumMachine src;
+        prepare(src, busy_rom(), 50);
+        const std::vector<uint8_t> z80 = sm::save_z80(src, 3);
+        const std::vector<uint8_t> sna = sm::save_sna(src);
+
+        sm::SpectrumMachine m;
+        m.load_rom(busy_rom());
+        sm::StateHasher hasher(m);
+        (void)hasher.hash();
+        int observed = 0;
+        const int id = m.cpu().GetMemory().AddWriteObserver(
+            [&observed](uint16_t, uint8_t, uint8_t) { ++observed; });
+        check(sm::load_z80(m, z80), "loaded");
+        m.cpu().GetMemory().RemoveWriteObserver(id);
+        check(observed == 0, "no write observer saw the 48 KB load");
+        check(hasher.hash() == sm::state_hash(m), "dirty-page tracking saw every page");
+
+        constexpr int kReps = 500;
+        auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < kReps; ++i) (void)sm::load_z80(m, z80);
+        const double z80_us = std::chrono::duration<double, std::micro>(
+                                  std::chrono::steady_clock::now() - t0).count() / kReps;
+        t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < kReps; ++i) (void)sm::load_sna(m, sna);
+        const double sna_us = std::chrono::duration<double, std::micro>(
+                                  std::chrono::steady_clock::now() - t0).count() / kReps;
+        std::cout << "    .z80 v3 (" << z80.size() << " bytes) " << z80_us << " us, .sna " << sna_us
+                  << " us per load\n";
+        check(z80_us < 1000 && sna_us < 1000, "each load well under a millisecond");
+
+        const std::string path =
+            (std::filesystem::temp_directory_path() / "z80twin-snapshot-test.Z80").string();
+        std::string why;
+        check(sm::save_snapshot_file(src, path, &why), "save by extension (.Z80)");
+        sm::SpectrumMachine f;
+        f.load_rom(busy_rom());
+        check(sm::load_snapshot_file(f, path, &why) && same_registers(src, f) && same_ram(src, f),
+              "load by extension");
+        std::filesystem::remove(path);
+        check(!sm::load_snapshot_file(f, "game.tap", &why) && why == "not a .sna or .z80 file",
+              "other extensions refused");
+    }
+
+    std::cout << "\n=======================\n";
+    if (failures == 0) {
+        std::cout << "✅ ALL SNAPSHOT CHECKS PASSED\n";
+        return 0;
+    }
+    std::cout << "❌ " << failures << " check(s) FAILED\n";
+    return 1;
+}
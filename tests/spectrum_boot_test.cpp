@@ -9,10 +9,19 @@
 // (copyright); if it can't be found this test SKIPS (passes with a notice) so a
 // clean checkout still goes green.
 //
+// It also boots a second machine in lockstep and compares state hashes every
+// frame (incremental on one side, from scratch on the other): the boot must be
+// deterministic, and the cheap hash must agree with the full one. A third
+// machine boots through the snapshot cache (cold the first time, restored
+// after) and must land on the same hash — this test is what keeps the cache
+// honest for everything else that boots from it.
+//
 // Set Z80_SPEC48_ROM to point at the image, or run from the repo root.
 //
 
+#include "spectrum/boot_cache.h"
 #include "spectrum/spectrum_machine.h"
+#include "spectrum/state_hash.h"
 
 #include <array>
 #include <cstdint>
@@ -67,9 +76,25 @@ int main() {
     sm::SpectrumMachine machine;
     check(machine.load_rom(rom), "ROM loaded");
 
+    sm::SpectrumMachine twin;
+    twin.load_rom(rom);
+    sm::StateHasher hasher(machine);
+
     constexpr int kBootFrames = 200;   // ~4 s of emulated time
-    for (int i = 0; i < kBootFrames; ++i) machine.run_frame();
+    int diverged = -1;
+    for (int i = 0; i < kBootFrames; ++i) {
+        machine.run_frame();
+        twin.run_frame();
+        if (diverged < 0 && hasher.hash() != sm::state_hash(twin)) diverged = i;
+    }
     check(machine.frame_count() == kBootFrames, "ran the boot frames");
+    check(diverged < 0, "twin boot matches the state hash on every frame");
+
+    sm::SpectrumMachine cached;
+    cached.load_rom(rom);
+    const bool hit = sm::BootCache().boot(cached, rom, kBootFrames);
+    std::cout << "  (boot cache " << (hit ? "hit" : "miss: cold boot saved") << ")\n";
+    check(sm::state_hash(cached) == hasher.hash(), "boot via the snapshot cache matches the cold boot");
 
     std::array<uint8_t, sm::SpectrumMachine::kPixels> frame{};
     machine.render_indices(frame);
@@ -5,11 +5,13 @@
 //
 // Proves the unified config: a DebugSession wraps a running SpectrumMachine's CPU
 // (DebugCPU == SpectrumCpu) and can breakpoint the ROM. Boots a couple of seconds
-// of frames, then breaks at the IM 1 interrupt vector (0x0038) and resumes past
-// it. SKIPs cleanly when spec48.rom is absent.
+// of frames (from the boot snapshot cache when warm), then breaks at the IM 1
+// interrupt vector (0x0038) and resumes past it. SKIPs cleanly when spec48.rom
+// is absent.
 //
 
 #include "debug_session.h"
+#include "spectrum/boot_cache.h"
 #include "spectrum/spectrum_machine.h"
 
 #include <cstdint>
@@ -59,8 +61,9 @@ int main() {
     // A DebugSession drives the very same CPU the machine runs (one config).
     DebugSession session(machine.cpu());
 
-    // Boot to BASIC (interrupts enabled, ROM idling on HALT) via the machine.
-    for (int i = 0; i < 120; ++i) machine.run_frame();
+    // Boot to BASIC (interrupts enabled, ROM idling on HALT) via the machine —
+    // restored from the boot snapshot cache after the first run.
+    sm::BootCache().boot(machine, rom, 120);
     check(machine.frame_count() == 120, "booted 120 frames");
 
     // Break at the IM 1 interrupt handler. Firing the frame interrupt vectors the
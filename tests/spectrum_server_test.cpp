@@ -0,0 +1,328 @@
+//
+// Z80 Digital Twin - spectrum_server verification
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// Checks tools/spectrum_server:
+//   1. the status seqlock: a reader racing a writer only sees whole publications;
+//   2. frame buffers: the newest frame is read in place, and a view knows when
+//      it has been drawn over;
+//   3. the audio ring: reads across the wrap, a reader a ring behind loses
+//      exactly the oldest samples, and slots being overwritten count as lost;
+//   4. the command ring: order, full at capacity, space again once drained,
+//      a head more than a ring ahead clamped;
+//   5. segments: create/open, layout check, the name goes with the creator;
+//   6. an in-process server behind its setup socket: instances created over
+//      the socket run, publish frames and status, and pause and resume; an
+//      endless request line drops the client; a create that fails part way
+//      leaves nothing behind.
+//
+
+#include "server.h"
+#include "setup_socket.h"
+#include "shared_instance.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+namespace {
+
+using namespace z80::server;
+
+int failures = 0;
+void check(bool ok, const char* what) {
+    std::cout << (ok ? "  ✓ " : "  ✗ ") << what << '\n';
+    if (!ok) ++failures;
+}
+
+std::string unique(const std::string& stem) { return stem + std::to_string(::getpid()); }
+
+/// Wait (up to 5 s) for @p done.
+template <class Done>
+bool eventually(Done&& done) {
+    const auto until = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!done()) {
+        if (std::chrono::steady_clock::now() > until) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    return true;
+}
+
+} // namespace
+
+int main() {
+    std::cout << "Spectrum server\n===============\n";
+
+    // The blocks are ~300 KB: keep them off the stack.
+    auto block = std::make_unique<InstanceBlock>();
+
+    // --- 1. Status ---------------------------------------------------------------
+    std::cout << "\n[1] Status seqlock\n";
+    {
+        InstanceBlock& b = *block;
+        check(read_status(b).frame == 0 && !latest_frame(b), "a new block has no status and no frame");
+
+        // The writer publishes until the reader has seen 100,000 different
+        // publications or a second has passed, so the two overlap (on one
+        // core, by preemption).
+        std::atomic<bool> done{false};
+        uint64_t published = 0;
+        std::thread writer([&b, &done, &published] {
+            Status s;
+            for (uint64_t n = 1; !done.load(std::memory_order_relaxed); ++n) {
+                s.frame = n;
+                s.tstates = n * 3;
+                s.state_hash = n * 7;
+                s.buffer = static_cast<uint32_t>(n % kFrameBuffers);
+                s.border = static_cast<uint8_t>(n & 7);
+                s.paused = (n & 1) != 0;
+                publish_status(b, s);
+                published = n;
+            }
+        });
+        bool whole = true;
+        bool monotonic = true;
+        uint64_t last = 0;
+        uint64_t changes = 0;
+        uint64_t reads = 0;
+        const auto until = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        for (; changes < 100'000 && ((reads & 1023) || std::chrono::steady_clock::now() < until); ++reads) {
+            const Status s = read_status(b);
+            whole = s.tstates == s.frame * 3 && s.state_hash == s.frame * 7 && s.buffer == s.frame % kFrameBuffers &&
+                    s.border == (s.frame & 7) && s.paused == ((s.frame & 1) != 0) && whole;
+            monotonic = s.frame >= last && monotonic;
+            changes += s.frame != last;
+            last = s.frame;
+        }
+        done.store(true);
+        writer.join();
+        check(whole, "every read is one whole publication");
+        check(monotonic, "publications are seen in order");
+        check(read_status(b).frame == published, "the last publication is the one left");
+        std::cout << "    (" << reads << " reads saw " << changes << " publications)\n";
+    }
+
+    // --- 2. Frames ---------------------------------------------------------------
+    std::cout << "\n[2] Frame buffers\n";
+    {
+        block = std::make_unique<InstanceBlock>();
+        InstanceBlock& b = *block;
+        Status s;
+        const auto publish = [&b, &s](uint64_t frame) {
+            s.frame = frame;
+            s.buffer = draw_frame(b, frame, [frame](std::span<uint8_t> px) {
+                for (uint8_t& p : px) p = static_cast<uint8_t>(frame);
+            });
+            publish_status(b, s);
+        };
+        publish(1);
+        publish(2);
+        auto view = latest_frame(b);
+        check(view && view->frame == 2 && view->buffer == &b.frames[2] && view->pixels()[0] == 2 &&
+                  view->pixels()[kPixels - 1] == 2,
+              "the newest frame is read in place from buffer frame % 3");
+        publish(3);
+        publish(4);
+        check(view->valid() && view->pixels()[0] == 2, "two more frames leave it untouched");
+        publish(5);
+        check(!view->valid(), "the third draws over it, and the view says so");
+        view = latest_frame(b);
+        check(view && view->frame == 5 && view->valid() && view->pixels()[100] == 5, "a fresh view has the newest");
+    }
+
+    // --- 3. Audio ----------------------------------------------------------------
+    std::cout << "\n[3] Audio ring\n";
+    {
+        InstanceBlock& b = *block;
+        std::vector<int16_t> samples(kAudioCapacity - 10);
+        for (std::size_t i = 0; i < samples.size(); ++i) samples[i] = static_cast<int16_t>(i);
+        write_audio(b, samples);
+
+        uint64_t position = 0;
+        uint64_t lost = 0;
+        std::vector<int16_t> out(kAudioCapacity);
+        std::size_t n = read_audio(b, position, out, &lost);
+        check(n == samples.size() && position == samples.size() && lost == 0 && out[n - 1] == samples.back(),
+              "a reader gets everything written");
+
+        std::array<int16_t, 20> more{};
+        for (std::size_t i = 0; i < more.size(); ++i) more[i] = static_cast<int16_t>(1000 + i);
+        write_audio(b, more);
+        n = read_audio(b, position, out, &lost);
+        check(n == 20 && out[0] == 1000 && out[19] == 1019 && lost == 0, "reads continue across the wrap");
+
+        uint64_t behind = 0;   // a reader that never read
+        lost = 0;
+        n = read_audio(b, behind, out, &lost);
+        check(n == kAudioCapacity && lost == 10 && out[0] == 10 && out[n - 1] == 1019,
+              "a reader a ring behind loses exactly the oldest samples");
+        check(read_audio(b, behind, out, &lost) == 0, "and is then up to date");
+
+        // Mid-write: the server has claimed 5 slots (the oldest) but not yet
+        // published them. A reader copying the whole ring must drop those 5.
+        const uint64_t written = b.audio_written.load();
+        b.audio_writing.store(written + 5);
+        uint64_t oldest = written - kAudioCapacity;
+        lost = 0;
+        n = read_audio(b, oldest, out, &lost);
+        check(n == kAudioCapacity - 5 && lost == 5 && oldest == written && out[0] == 15 && out[n - 1] == 1019,
+              "slots being overwritten while copied are cut and counted lost");
+        b.audio_writing.store(written);
+    }
+
+    // --- 4. Commands -------------------------------------------------------------
+    std::cout << "\n[4] Command ring\n";
+    {
+        InstanceBlock& b = *block;
+        bool pushed = true;
+        for (uint32_t i = 0; i < kCommandCapacity; ++i) pushed = push_command(b, {Op::kKeyDown, 0, 0, i}) && pushed;
+        check(pushed && !push_command(b, {Op::kKeyUp}), "the ring takes kCommandCapacity commands, then refuses");
+        uint32_t expected = 0;
+        bool order = true;
+        const std::size_t n = drain_commands(b, [&](const Command& c) { order = c.value == expected++ && order; });
+        check(n == kCommandCapacity && order, "the server drains them in order");
+        check(push_command(b, {Op::kReset}) && drain_commands(b, [](const Command& c) { (void)c; }) == 1,
+              "and there is room again");
+
+        const uint32_t tail = b.command_tail.load();
+        b.command_head.store(tail + 100000);   // a broken controller
+        check(drain_commands(b, [](const Command& c) { (void)c; }) == kCommandCapacity &&
+                  b.command_tail.load() == tail + 100000,
+              "a head far past the tail is clamped to one ring");
+    }
+
+    // --- 5. Segments -------------------------------------------------------------
+    std::cout << "\n[5] Shared segments\n";
+    {
+        const std::string name = unique("/z80spectrum-test-segment-");
+        {
+            SharedSegment made = SharedSegment::create(name, 42);
+            check(made.ok() && made.block().id == 42 && made.block().magic == kMagic, "create constructs the block");
+            SharedSegment seen = SharedSegment::open(name);
+            check(seen.ok() && seen.block().id == 42 && &seen.block() != &made.block(),
+                  "open maps the same object elsewhere");
+            made.block().frames[1].pixels[7] = 0x5A;
+            check(seen.block().frames[1].pixels[7] == 0x5A, "writes are shared");
+            seen.block().version = kLayoutVersion + 1;
+            check(!SharedSegment::open(name).ok(), "another layout version is refused");
+            seen.block().version = kLayoutVersion;
+        }
+        check(!SharedSegment::open(name).ok(), "the name is gone with its creator");
+        check(!SharedSegment::open(unique("/z80spectrum-test-none-")).ok(), "a missing segment is refused");
+    }
+
+    // --- 6. Server ---------------------------------------------------------------
+    std::cout << "\n[6] Server behind its setup socket\n";
+    {
+        ServerOptions options;
+        options.rom = {0x3E, 0x02,          // LD A,2
+                       0xD3, 0xFE,          // OUT (0xFE),A   ; red border
+                       0x18, 0xFE};         // JR $
+        options.threads = 2;
+        options.realtime = false;
+        options.name_prefix = unique("/z80spectrum-test-") + "-";
+        Server server(options);
+
+        const std::string path = "/tmp/" + unique("z80spectrum-test-") + ".sock";
+        SetupListener listener;
+        std::string why;
+        check(listener.open(path, &why), "the setup socket listens");
+        std::atomic<bool> serving{true};
+        std::thread setup([&] {
+            while (serving.load())
+                listener.poll_once([&server](const std::string& line) { return server.request(line); },
+                                   std::chrono::milliseconds(20));
+        });
+        server.start();
+
+        SetupConnection client;
+        check(client.connect(path), "a client connects");
+        const auto hello = client.request("hello");
+        check(hello && hello->size() == 1 && hello->front().find("layout=2 width=320 height=256") != std::string::npos,
+              "hello reports the layout");
+        check(!client.request("frobnicate", &why) && why.find("unknown") != std::string::npos,
+              "an unknown request is an error");
+        const auto created = client.request("create 3");
+        check(created && created->size() == 3, "create 3 answers three instances");
+
+        std::vector<SharedSegment> segments;
+        for (const std::string& line : created ? *created : std::vector<std::string>{}) {
+            std::istringstream in(line);
+            std::string word, name;
+            uint32_t id = 0;
+            in >> word >> id >> name;
+            segments.push_back(SharedSegment::open(name));
+        }
+        const bool mapped = segments.size() == 3 && segments[0].ok() && segments[1].ok() && segments[2].ok();
+        check(mapped, "the client maps every instance");
+        if (mapped) {
+            check(eventually([&] { return read_status(segments[2].block()).frame >= 5; }), "instances publish frames");
+            const Status s = read_status(segments[0].block());
+            const auto view = latest_frame(segments[0].block());
+            check(s.border == 2 && s.tstates > 0 && s.state_hash != 0, "status carries border, T-states and hash");
+            check(view && view->pixels()[0] == 2 && view->valid(), "the frame shows the border the ROM set");
+
+            push_command(segments[1].block(), {Op::kPause});
+            check(eventually([&] { return read_status(segments[1].block()).paused; }), "a paused instance says so");
+            const uint64_t paused_at = read_status(segments[1].block()).frame;
+            const uint64_t other_at = read_status(segments[0].block()).frame;
+            check(eventually([&] { return read_status(segments[0].block()).frame > other_at + 5; }) &&
+                      read_status(segments[1].block()).frame == paused_at,
+                  "it stops while the others run on");
+            push_command(segments[1].block(), {Op::kResume});
+            check(eventually([&] { return read_status(segments[1].block()).frame > paused_at; }),
+                  "and runs again after resume");
+
+            const auto stats = client.request("stats");
+            check(stats && stats->size() == 1 && stats->front().starts_with("instances=3 ") &&
+                      stats->front().ends_with(" shared_rom=0"),
+                  "stats counts them (none on a shared ROM)");
+
+            SetupConnection flooder;
+            const bool flooding = flooder.connect(path);
+            std::string flood_why;
+            check(flooding && !flooder.request(std::string(kMaxRequest + 10, 'x'), &flood_why) &&
+                      flood_why.find("too long") != std::string::npos && !flooder.request("hello"),
+                  "an endless request line is refused and the client dropped");
+            check(client.request("hello").has_value(), "other clients are unaffected");
+
+            check(client.request("shutdown") && server.shutdown_requested(), "shutdown is passed to the owner");
+        }
+        server.stop();
+        serving.store(false);
+        setup.join();
+        listener.close();
+        check(::access(path.c_str(), F_OK) != 0, "closing removes the socket file");
+
+        // Names of 255 characters fit (ids 0-9); id 10's is one too long.
+        ServerOptions tight = options;
+        tight.name_prefix = unique("/z80spectrum-test-long-");
+        tight.name_prefix.resize(255, 'x');
+        Server partial(tight);
+        why.clear();
+        check(partial.create(12, &why).empty() && why.find("cannot create") != std::string::npos,
+              "a create that fails part way returns nothing, saying why");
+        check(partial.request("list") == "ok\n" && !SharedSegment::open(tight.name_prefix + "0").ok(),
+              "and leaves no instances or segments behind");
+        check(partial.create(3).size() == 3 && partial.request("list").starts_with("instance 0 "),
+              "the ids are free again");
+    }
+
+    std::cout << '\n';
+    if (failures == 0) {
+        std::cout << "✅ ALL SPECTRUM SERVER CHECKS PASSED\n";
+        return 0;
+    }
+    std::cout << "❌ " << failures << " check(s) FAILED\n";
+    return 1;
+}
@@ -0,0 +1,62 @@
+//
+// Z80 Digital Twin - stand-in Spectrum ROM for tests
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// The machine tests cannot ship the copyrighted 48K ROM, so they run a few
+// bytes that behave like it where it matters: IM 1 with interrupts on, an ISR
+// that counts frames, and a main loop that keeps changing RAM. Every stand-in
+// is built the same way:
+//   0x0000  the main program (usually kStartIm1, then a forever() loop)
+//   0x0038  PUSH AF / LD A,(0x9004) / INC A / LD (0x9004),A / POP AF / EI / RETI
+// and each test picks the main program it needs from the pieces below.
+//
+
+#ifndef Z80_TESTS_SPECTRUM_STAND_IN_ROM_H
+#define Z80_TESTS_SPECTRUM_STAND_IN_ROM_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+
+namespace z80::test {
+
+/// DI / LD SP,0x8000 / IM 1 / EI
+inline const std::vector<uint8_t> kStartIm1 = {0xF3, 0x31, 0x00, 0x80, 0xED, 0x56, 0xFB};
+
+/// LD HL,(0x9002) / INC HL / LD (0x9002),HL — the main loop's pass counter.
+inline const std::vector<uint8_t> kBumpCounter = {0x2A, 0x02, 0x90, 0x23, 0x22, 0x02, 0x90};
+
+/// LD A,L / OUT (0xFE),A — the border follows the counter's low byte.
+inline const std::vector<uint8_t> kBorderFromL = {0x7D, 0xD3, 0xFE};
+
+/// The interrupt handler at 0x0038: counts frames at 0x9004.
+inline const std::vector<uint8_t> kFrameCountIsr = {0xF5, 0x3A, 0x04, 0x90, 0x3C, 0x32,
+                                                    0x04, 0x90, 0xF1, 0xFB, 0xED, 0x4D};
+
+/// @brief @p parts back to back, then JR to the first byte.
+inline std::vector<uint8_t> forever(std::initializer_list<std::vector<uint8_t>> parts) {
+    std::vector<uint8_t> loop;
+    for (const std::vector<uint8_t>& p : parts) loop.insert(loop.end(), p.begin(), p.end());
+    const auto back = static_cast<int>(loop.size()) + 2;
+    loop.push_back(0x18);
+    loop.push_back(static_cast<uint8_t>(-back));
+    return loop;
+}
+
+/// @brief @p parts back to back from 0x0000, kFrameCountIsr at 0x0038,
+///        zero-filled up to at least @p size bytes.
+inline std::vector<uint8_t> stand_in_rom(std::initializer_list<std::vector<uint8_t>> parts,
+                                         std::size_t size = 0) {
+    std::vector<uint8_t> rom;
+    for (const std::vector<uint8_t>& p : parts) rom.insert(rom.end(), p.begin(), p.end());
+    rom.resize(std::max(size, 0x38 + kFrameCountIsr.size()), 0x00);
+    std::copy(kFrameCountIsr.begin(), kFrameCountIsr.end(), rom.begin() + 0x38);
+    return rom;
+}
+
+} // namespace z80::test
+
+#endif // Z80_TESTS_SPECTRUM_STAND_IN_ROM_H
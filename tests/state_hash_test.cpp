@@ -0,0 +1,169 @@
+//
+// Z80 Digital Twin - ZX Spectrum machine state hash verification
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// Verifies the determinism fingerprint:
+//   1. The incremental StateHasher equals the from-scratch state_hash() every
+//      frame, and re-hashes only the pages the frame wrote.
+//   2. Every ingredient moves the hash: a RAM byte (emulated or RawWrite), a
+//      register, the border, a key, the EI shadow, the loaded tape and the
+//      T-state it started playing at.
+//   3. A golden hash pins a short run of a stand-in ROM — the hash-instead-of-
+//      frame style golden test the 48K boot test also uses.
+//   4. An incremental hash is a small fraction of a full one.
+//
+
+#include "spectrum/state_hash.h"
+#include "spectrum_stand_in_rom.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+namespace sm = z80::machine::spectrum;
+namespace zt = z80::test;
+
+int failures = 0;
+void check(bool ok, const char* what) {
+    std::cout << (ok ? "  ✓ " : "  ✗ ") << what << '\n';
+    if (!ok) ++failures;
+}
+
+// Stand-in ROM (spectrum_stand_in_rom.h): the main loop bumps a 16-bit
+// counter at 0x9002 and the border each pass.
+//   0x0007  LD HL,(0x9002) / INC HL / LD (0x9002),HL / LD A,L / OUT (0xFE),A / JR 0x0007
+std::vector<uint8_t> test_rom() {
+    return zt::stand_in_rom({zt::kStartIm1, zt::forever({zt::kBumpCounter, zt::kBorderFromL})});
+}
+
+} // namespace
+
+int main() {
+    std::cout << "Machine state hash\n==================\n";
+
+    // --- 1. Incremental == full ---------------------------------------------------
+    std::cout << "\n[1] Incremental hash equals the full hash, re-hashing written pages only\n";
+    {
+        sm::SpectrumMachine m;
+        m.load_rom(test_rom());
+        sm::StateHasher hasher(m);
+        const uint64_t h0 = hasher.hash();
+        check(hasher.pages_rehashed() == 256 && h0 == sm::state_hash(m), "first hash covers all pages");
+
+        bool same = true;
+        std::size_t most = 0;
+        for (int f = 0; f < 50; ++f) {
+            m.run_frame();
+            same = same && hasher.hash() == sm::state_hash(m);
+            most = std::max(most, hasher.pages_rehashed());
+        }
+        check(same, "equal on 50 consecutive frames");
+        check(most <= 2, "a frame writing the stack and 0x90xx re-hashes <= 2 pages");
+        const uint64_t idle = hasher.hash();
+        check(hasher.pages_rehashed() == 0 && idle == sm::state_hash(m),
+              "no writes since the last call: nothing re-hashed");
+    }
+
+    // --- 2. Sensitivity -----------------------------------------------------------
+    std::cout << "\n[2] Memory, registers, border, keys, EI shadow and tape all move the hash\n";
+    {
+        sm::SpectrumMachine m;
+        m.load_rom(test_rom());
+        sm::StateHasher hasher(m);
+        const uint64_t base = hasher.hash();
+
+        m.cpu().WriteMemory(0xC123, 0x01);
+        const uint64_t ram = hasher.hash();
+        check(ram != base && hasher.pages_rehashed() == 1, "emulated write: one page re-hashed");
+        m.cpu().GetMemory().RawWrite(0xC123, 0x00);
+        check(hasher.hash() == base, "RawWrite is tracked too (back to the original)");
+
+        m.cpu().BC() = 0x1234;
+        check(hasher.hash() != base, "register");
+        m.cpu().BC() = 0;
+        m.ula().write_port(0xFE, 0x05);
+        check(hasher.hash() != base, "border");
+        m.ula().write_port(0xFE, 0x00);
+        m.ula().key_down(3, 2);
+        check(hasher.hash() != base, "keyboard matrix");
+        m.ula().key_up(3, 2);
+        m.cpu().SetInterruptShadow(true);
+        check(hasher.hash() != base, "EI shadow (an EI ending the frame)");
+        m.cpu().SetInterruptShadow(false);
+        check(hasher.hash() == base, "restoring everything restores the hash");
+
+        // Same tape played from two T-states, and a different tape: the EAR
+        // signal differs from here on, so must the hash.
+        const std::vector<uint8_t> tap = {0x03, 0x00, 0xFF, 0x12, 0xED};
+        const std::vector<uint8_t> other_tap = {0x03, 0x00, 0xFF, 0x13, 0xEC};
+        const auto with_tape = [&](const std::vector<uint8_t>& image, uint64_t played_at) {
+            sm::SpectrumMachine t;
+            t.load_rom(test_rom());
+            t.tape().load(image);
+            t.tape().play(played_at);
+            return sm::state_hash(t);
+        };
+        check(with_tape(tap, 100) != with_tape(tap, 200), "tape position (when playback started)");
+        check(with_tape(tap, 100) != with_tape(other_tap, 100), "tape contents");
+        check(with_tape(tap, 100) == with_tape(tap, 100), "the same tape at the same T-state hashes alike");
+
+        sm::SpectrumMachine other;
+        other.load_rom(test_rom());
+        other.cpu().WriteMemory(0x8000, 0xAA);
+        other.cpu().WriteMemory(0x8100, 0xAA);
+        sm::SpectrumMachine swapped;
+        swapped.load_rom(test_rom());
+        swapped.cpu().WriteMemory(0x8000, 0xAA);
+        swapped.cpu().WriteMemory(0x8101, 0xAA);
+        check(sm::state_hash(other) != sm::state_hash(swapped), "position within a page matters");
+    }
+
+    // --- 3. Golden ----------------------------------------------------------------
+    std::cout << "\n[3] Golden hash after 100 frames\n";
+    {
+        sm::SpectrumMachine m;
+        m.load_rom(test_rom());
+        for (int f = 0; f < 100; ++f) m.run_frame();
+        const uint64_t h = sm::state_hash(m);
+        std::cout << "    hash = 0x" << std::hex << h << std::dec << "\n";
+        check(h == 0xf3382b84a0ec578bull, "matches the pinned value");
+    }
+
+    // --- 4. Cost ----------------------------------------------------------------------
+    std::cout << "\n[4] Incremental vs full cost\n";
+    {
+        sm::SpectrumMachine m;
+        m.load_rom(test_rom());
+        sm::StateHasher hasher(m);
+        (void)hasher.hash();
+        constexpr int kReps = 2000;
+        uint64_t sink = 0;
+        auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < kReps; ++i) sink ^= sm::state_hash(m);
+        const double full_us = std::chrono::duration<double, std::micro>(
+                                   std::chrono::steady_clock::now() - t0).count() / kReps;
+        t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < kReps; ++i) {
+            m.cpu().WriteMemory(static_cast<uint16_t>(0x8000 + i), static_cast<uint8_t>(i));
+            sink ^= hasher.hash();
+        }
+        const double inc_us = std::chrono::duration<double, std::micro>(
+                                  std::chrono::steady_clock::now() - t0).count() / kReps;
+        std::cout << "    full " << full_us << " us, incremental (1 dirty page) " << inc_us
+                  << " us" << (sink ? "" : " ") << "\n";
+        check(inc_us * 2 < full_us, "incremental is a small fraction of a full hash");
+    }
+
+    std::cout << "\n==================\n";
+    if (failures == 0) {
+        std::cout << "✅ ALL STATE-HASH CHECKS PASSED\n";
+        return 0;
+    }
+    std::cout << "❌ " << failures << " check(s) FAILED\n";
+    return 1;
+}
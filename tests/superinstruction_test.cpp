@@ -0,0 +1,215 @@
+//
+// Z80 Digital Twin - superinstruction (fused RunUntilCycle) verification
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// RunUntilCycle() runs hot idioms as fused handlers; Step() never does. The
+// promise is that nobody can tell: for every program below and for EVERY
+// target T-state, RunUntilCycle(T) leaves the CPU exactly where a plain
+// `while (t < T && !halted) Step();` loop does — registers, flags, R, WZ,
+// clock, memory, and a pending prefix if the budget runs out inside one.
+//   1. each idiom, both branch outcomes, against the Step() loop;
+//   2. the same at every stopping point (splitting on demand);
+//   3. the EI shadow, and code that rewrites the rest of its idiom;
+//   4. the instrumented CPU does not fuse, so its mix is still complete;
+//   5. a read counter sees the same reads: deciding what to fuse reads nothing.
+//
+
+#include "z80_cpu.h"
+#include "memory/observable_memory.h"
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using z80::CPU;
+
+int failures = 0;
+void check(bool ok, const std::string& what) {
+    std::cout << (ok ? "  ✓ " : "  ✗ ") << what << '\n';
+    if (!ok) ++failures;
+}
+
+struct Program {
+    const char* name;
+    std::vector<uint8_t> bytes;
+};
+
+// Each program ends in HALT. Data and stack live at 8000h and above.
+const std::vector<Program> kPrograms = {
+    {"LD A,D / OR E / JR Z|NZ (DE zero test, loop of 3)",
+     {0x11, 0x03, 0x00,                 // LD DE,3
+      0x1B, 0x7A, 0xB3, 0x20, 0xFB,     // loop: DEC DE / LD A,D / OR E / JR NZ,loop
+      0x7A, 0xB3, 0x28, 0x01, 0x00,     // LD A,D / OR E / JR Z,+1 (taken) / NOP
+      0x76}},
+    {"LD A,B / OR C (BC zero test, no JR after it)",
+     {0x01, 0x00, 0x01, 0x78, 0xB1, 0x3C, 0x78, 0xB1, 0x28, 0x00, 0x76}},
+    {"OR A / SBC HL,DE / JR NC|C (the GCD inner loop)",
+     {0x21, 0x2A, 0x00, 0x11, 0x06, 0x00,  // LD HL,42 / LD DE,6
+      0xB7, 0xED, 0x52, 0x30, 0xFB,        // loop: OR A / SBC HL,DE / JR NC,loop
+      0x37, 0xB7, 0xED, 0x52, 0x38, 0x00,  // SCF / OR A / SBC HL,DE / JR C,+0
+      0x76}},
+    {"DEC B / JR NZ (written-out DJNZ)",
+     {0x06, 0x05, 0x3C, 0x05, 0x20, 0xFC, 0x76}},
+    {"LD A,(HL) / INC HL (buffer walk)",
+     {0x21, 0x00, 0x80, 0x36, 0x11, 0x7E, 0x23, 0x7E, 0x23, 0x86, 0x76}},
+    {"PUSH/POP blocks (save all, restore all, register copy)",
+     {0x31, 0x00, 0x90, 0x01, 0x34, 0x12, 0x11, 0x78, 0x56, 0x21, 0xBC, 0x9A,
+      0xF5, 0xC5, 0xD5, 0xE5,            // PUSH AF,BC,DE,HL
+      0x2C, 0x1C, 0x0C,                  // INC L / INC E / INC C
+      0xE1, 0xD1, 0xC1, 0xF1,            // POP HL,DE,BC,AF
+      0xE5, 0xD1,                        // PUSH HL / POP DE
+      0x76}},
+    {"idioms behind prefixes are left to Step() (DD 7E, FD E5)",
+     {0xDD, 0x21, 0x00, 0x80, 0xDD, 0x7E, 0x00, 0x23, 0xFD, 0xE5, 0xC5, 0xC1, 0xFD, 0xE1, 0x76}},
+};
+
+struct Snapshot {
+    uint64_t t;
+    uint16_t pc, sp, af, bc, de, hl, ix, iy, wz, ir;
+    bool halted, complete, shadow;
+    uint32_t memory_sum;
+
+    bool operator==(const Snapshot&) const = default;
+};
+
+Snapshot snap(CPU& c) {
+    uint32_t sum = 0;
+    for (uint32_t a = 0; a < 0x10000; ++a) sum = sum * 31u + c.ReadMemory(static_cast<uint16_t>(a));
+    return {c.GetCycleCount(), c.PC(), c.SP(), c.AF(), c.BC(), c.DE(), c.HL(), c.IX(), c.IY(), c.WZ(), c.IR(),
+            c.IsHalted(), c.InstructionComplete(), c.InterruptShadow(), sum};
+}
+
+void load(CPU& c, const std::vector<uint8_t>& bytes) {
+    c.Reset();
+    c.LoadProgram(bytes, 0x0000);
+}
+
+/// The unfused meaning of RunUntilCycle(target).
+void step_until(CPU& c, uint64_t target) {
+    while (c.GetCycleCount() < target && !c.IsHalted()) c.Step();
+}
+
+/// RunUntilCycle(T) == the Step() loop for every T up to the end; returns the
+/// first T that differs, or 0.
+uint64_t first_difference(const std::vector<uint8_t>& bytes) {
+    CPU whole;
+    load(whole, bytes);
+    step_until(whole, UINT64_MAX);
+    const uint64_t end = whole.GetCycleCount();
+    for (uint64_t t = 1; t <= end + 1; ++t) {
+        CPU fused, stepped;
+        load(fused, bytes);
+        load(stepped, bytes);
+        fused.RunUntilCycle(t);
+        step_until(stepped, t);
+        if (!(snap(fused) == snap(stepped))) return t;
+    }
+    return 0;
+}
+
+} // namespace
+
+int main() {
+    std::cout << "Superinstructions\n=================\n";
+
+    // --- 1. Whole runs ----------------------------------------------------------------
+    std::cout << "\n[1] Each idiom runs to the same state as the Step() loop\n";
+    for (const Program& p : kPrograms) {
+        CPU fused, stepped;
+        load(fused, p.bytes);
+        load(stepped, p.bytes);
+        fused.RunUntilCycle(1'000'000);
+        step_until(stepped, 1'000'000);
+        check(fused.IsHalted() && snap(fused) == snap(stepped), p.name);
+    }
+
+    // --- 2. Splitting -------------------------------------------------------------------
+    std::cout << "\n[2] Stopping at every T-state, including inside an idiom\n";
+    for (const Program& p : kPrograms) {
+        const uint64_t t = first_difference(p.bytes);
+        check(t == 0, std::string(p.name) + (t ? " — differs at T=" + std::to_string(t) : ""));
+    }
+    {
+        // OR A (4 T) then ED: a budget of 6 must stop with the ED prefix pending.
+        CPU c;
+        load(c, {0xB7, 0xED, 0x52, 0x76});
+        c.RunUntilCycle(6);
+        check(!c.InstructionComplete() && c.PC() == 2 && c.GetCycleCount() == 8,
+              "budget exhausted after ED: stops mid-instruction, as Step() would");
+        c.RunUntilCycle(100);
+        check(c.IsHalted() && c.GetCycleCount() == 4 + 15 + 4, "and resumes to the same end");
+    }
+
+    // --- 3. EI shadow, self-modifying code ------------------------------------------------
+    std::cout << "\n[3] EI shadow and code rewritten by the idiom itself\n";
+    {
+        // EI / LD A,D / OR E / HALT: the LD A,D runs in the EI shadow.
+        const std::vector<uint8_t> ei = {0xFB, 0x7A, 0xB3, 0x76};
+        check(first_difference(ei) == 0, "EI / LD A,D / OR E: every stopping point matches");
+        CPU c;
+        load(c, ei);
+        c.RunUntilCycle(4);
+        check(c.InterruptShadow() && !c.Interrupt(), "stopping right after EI keeps the shadow");
+
+        // SP = 000Eh; PUSH BC at 000Bh writes C = 76h (HALT) over the PUSH DE
+        // at 000Ch that the block was about to run.
+        const std::vector<uint8_t> smc = {0x31, 0x0E, 0x00, 0x01, 0x76, 0x00, 0x00, 0x00, 0x00, 0x00,
+                                          0x00, 0xC5, 0xD5, 0xD5, 0x00};
+        CPU fused, stepped;
+        load(fused, smc);
+        load(stepped, smc);
+        fused.RunUntilCycle(1000);
+        step_until(stepped, 1000);
+        check(fused.IsHalted() && fused.PC() == 0x000D && snap(fused) == snap(stepped),
+              "a PUSH that overwrites the next opcode: the new byte (HALT) runs");
+        check(first_difference(smc) == 0, "and every stopping point matches");
+    }
+
+    // --- 4. Instrumented CPU ------------------------------------------------------------------
+    std::cout << "\n[4] The instrumented CPU counts every instruction\n";
+    {
+        z80::InstrumentedCpu counted;
+        CPU plain;
+        load(plain, kPrograms[0].bytes);
+        counted.Reset();
+        counted.LoadProgram(kPrograms[0].bytes, 0x0000);
+        counted.RunUntilCycle(1'000'000);
+        plain.RunUntilCycle(1'000'000);
+        check(counted.GetCycleCount() == plain.GetCycleCount() && counted.Mix().Instructions() == 1 + 3 * 4 + 3 + 1,
+              "RunUntilCycle on InstrumentedCpu: same clock, all 17 instructions counted");
+    }
+
+    // --- 5. Read counts ------------------------------------------------------------------------
+    std::cout << "\n[5] RunUntilCycle counts the same reads as Step()\n";
+    {
+        using CountedCpu = z80::CPUImpl<z80::ObservableMemory, z80::OpenBusIo>;
+        bool all_same = true;
+        for (const Program& p : kPrograms) {
+            std::vector<uint32_t> fused_counts(0x10000, 0), stepped_counts(0x10000, 0);
+            CountedCpu fused, stepped;
+            for (auto [c, counts] : {std::pair{&fused, &fused_counts}, std::pair{&stepped, &stepped_counts}}) {
+                c->Reset();
+                c->LoadProgram(p.bytes, 0x0000);
+                c->GetMemory().SetReadCounter(counts->data());
+            }
+            fused.RunUntilCycle(1'000'000);
+            while (!stepped.IsHalted()) stepped.Step();
+            const bool same = fused_counts == stepped_counts;
+            if (!same) check(false, std::string(p.name) + ": read counts differ");
+            all_same = all_same && same;
+        }
+        check(all_same, "every program: the same count at every address");
+    }
+
+    std::cout << "\n=================\n";
+    if (failures == 0) {
+        std::cout << "✅ ALL SUPERINSTRUCTION CHECKS PASSED\n";
+        return 0;
+    }
+    std::cout << "❌ " << failures << " check(s) FAILED\n";
+    return 1;
+}
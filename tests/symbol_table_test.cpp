@@ -8,7 +8,9 @@
 #include "disassembler.h"
 
 #include <array>
+#include <chrono>
 #include <cstdint>
+#include <cstdio>
 #include <fstream>
 #include <iostream>
 #include <string>
@@ -175,6 +177,70 @@ int main() {
         check(without.text == "JP 0x1234", "no resolver -> hex");
     }
 
+    // --- Bulk load: large symbol files, nested regions, resolver views ------
+    std::cout << "\n[7] Bulk load (100K entries) and nested regions\n";
+    {
+        // 100K entries over a 64K space: later entries redefine earlier ones.
+        const std::string path = "/tmp/z80_symbols_bulk.sym";
+        {
+            std::ofstream f(path, std::ios::binary | std::ios::trunc);
+            f << "{\n  \"version\": \"1.0\",\n  \"program\": \"bulk\",\n  \"symbols\": [";
+            char buf[160];
+            for (uint32_t i = 0; i < 100000; ++i) {
+                std::snprintf(buf, sizeof(buf),
+                              "%s\n    { \"address\": \"0x%04X\", \"name\": \"L%u\", "
+                              "\"type\": \"LABEL\", \"description\": \"auto\" }",
+                              i ? "," : "", i & 0xFFFFu, i);
+                f << buf;
+            }
+            f << "\n  ]\n}\n";
+        }
+
+        SymbolTable t;
+        std::vector<std::string> warnings;
+        const auto t0 = std::chrono::steady_clock::now();
+        const bool ok = t.LoadFromFile(path, nullptr, &warnings);
+        const auto t1 = std::chrono::steady_clock::now();
+        check(ok && warnings.empty(), "100K-entry file loads cleanly");
+        check(t.Size() == 65536, "one symbol per address after redefinition");
+        check(t.Resolve("L99999") == std::optional<uint16_t>(99999 & 0xFFFF),
+              "last definition wins (L99999)");
+        check(!t.Resolve("L0").has_value(), "redefined name dropped (L0)");
+        check(t.Resolve("L65535") == std::optional<uint16_t>(0xFFFF), "L65535 -> 0xFFFF");
+
+        int hits = 0;
+        const auto t2 = std::chrono::steady_clock::now();
+        for (int pass = 0; pass < 16; ++pass)
+            for (uint32_t a = 0; a < 0x10000; ++a) hits += t.NameAt(static_cast<uint16_t>(a)).has_value();
+        const auto t3 = std::chrono::steady_clock::now();
+        check(hits == 16 * 65536, "NameAt hits every address");
+
+        using ms = std::chrono::duration<double, std::milli>;
+        std::cout << "    load: " << ms(t1 - t0).count() << " ms, 1M NameAt: "
+                  << ms(t3 - t2).count() << " ms\n";
+
+        SymbolTable n;
+        n.Define(Symbol{0x8000, "OUTER", SymbolType::DataRegion, {}, 0x100});
+        n.Define(Symbol{0x8010, "INNER", SymbolType::DataRegion, {}, 0x10});
+        n.DefineLabel(0x8040, "POINT");
+        auto inner = n.FindContaining(0x8015);
+        check(inner && inner->name == "INNER", "nested region: innermost wins");
+        auto outer = n.FindContaining(0x8020);
+        check(outer && outer->name == "OUTER", "past inner -> OUTER");
+        auto after_point = n.FindContaining(0x8041);
+        check(after_point && after_point->name == "OUTER",
+              "point symbol inside a region doesn't hide it");
+        n.Remove(0x8010);
+        auto gone = n.FindContaining(0x8015);
+        check(gone && gone->name == "OUTER", "removing INNER re-exposes OUTER");
+        n.Define(Symbol{0x8000, "OUTER", SymbolType::DataRegion, {}, 4});
+        check(!n.FindContaining(0x8020).has_value(), "shrinking OUTER drops coverage");
+
+        auto resolve = n.MakeResolver();
+        check(resolve(0x8040) == std::optional<std::string_view>("POINT"), "resolver view -> POINT");
+        check(!resolve(0x8041).has_value(), "resolver: no exact symbol -> none");
+    }
+
     std::cout << "\n=================\n";
     if (failures == 0) {
         std::cout << "✅ ALL SYMBOL-TABLE CHECKS PASSED\n";
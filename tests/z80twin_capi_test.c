@@ -0,0 +1,302 @@
+//
+// Z80 Digital Twin - C API (libz80twin) verification
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// Written in C and linked against the shared library only, so it checks the
+// ABI as another runtime sees it:
+//   1. create, the memory and register views (written in place, read back);
+//   2. batched runs: one call or a thousand small ones end in the same state,
+//      at an instruction boundary;
+//   3. port handler tables: full 16-bit port, context, open bus elsewhere;
+//   4. run_until() traps: HALT stubs serviced and resumed, or the run stopped;
+//   5. PC traps: a stop with no guest patching, a register condition checked
+//      in the handler, and the same end state as an untrapped run;
+//   6. interrupts;
+//   7. the state blob: round trip, and corrupt / wrong-version / short blobs
+//      refused without touching the machine.
+//
+
+#include "z80twin.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int failures = 0;
+
+static void check(int ok, const char* what) {
+    printf("%s%s\n", ok ? "  \xE2\x9C\x93 " : "  \xE2\x9C\x97 ", what);
+    if (!ok) ++failures;
+}
+
+static void load(z80twin* m, const uint8_t* bytes, size_t size) {
+    z80twin_reset(m);
+    memcpy(z80twin_memory(m), bytes, size);
+}
+
+// Fill 4 KB at 8000h with L xor H, then LDIR it to 9000h: about 280,000 T.
+static const uint8_t kFill[] = {
+    0x21, 0x00, 0x80,   // LD HL,8000h
+    0x01, 0x00, 0x10,   // LD BC,1000h
+    0x7D, 0xAC, 0x77,   // loop: LD A,L / XOR H / LD (HL),A
+    0x23, 0x0B,         // INC HL / DEC BC
+    0x78, 0xB1,         // LD A,B / OR C
+    0x20, 0xF7,         // JR NZ,loop
+    0x21, 0x00, 0x80,   // LD HL,8000h
+    0x11, 0x00, 0x90,   // LD DE,9000h
+    0x01, 0x00, 0x10,   // LD BC,1000h
+    0xED, 0xB0,         // LDIR
+    0x76};              // HALT
+
+// Ports: a device at 10h-1Fh that answers with the port's high byte plus
+// the number of reads so far, and records what it is sent.
+typedef struct device {
+    int reads;
+    uint16_t last_port;
+    uint8_t last_out;
+} device;
+
+static uint8_t device_in(void* context, uint16_t port) {
+    device* d = (device*)context;
+    d->last_port = port;
+    return (uint8_t)((port >> 8) + ++d->reads);
+}
+
+static void device_out(void* context, uint16_t port, uint8_t value) {
+    device* d = (device*)context;
+    d->last_port = port;
+    d->last_out = value;
+}
+
+// Traps: a host call is CALL 0010h, where a HALT / RET stub sits. The handler
+// adds 1 to B for each call; the program's own final HALT (at 0100h) ends it.
+typedef struct host {
+    int calls;
+    int stops;
+} host;
+
+static int host_trap(void* context, z80twin* m) {
+    host* h = (host*)context;
+    z80twin_regs* r = z80twin_registers(m);
+    if (r->pc - 1 == 0x0010) {
+        ++h->calls;
+        r->bc = (uint16_t)(r->bc + 0x0100);
+        return Z80TWIN_TRAP_RESUME;   // falls through to the stub's RET
+    }
+    ++h->stops;
+    return Z80TWIN_TRAP_STOP;
+}
+
+// PC traps on the fill loop's head (0006h): count every pass, and stop when
+// HL reaches `stop_at` (0 = never).
+typedef struct watch {
+    int passes;
+    uint16_t stop_at;
+} watch;
+
+static int watch_trap(void* context, z80twin* m) {
+    watch* w = (watch*)context;
+    const z80twin_regs* r = z80twin_registers(m);
+    if (r->halted) return Z80TWIN_TRAP_STOP;
+    ++w->passes;
+    return r->hl == w->stop_at ? Z80TWIN_TRAP_STOP : Z80TWIN_TRAP_RESUME;
+}
+
+int main(void) {
+    printf("libz80twin C API\n================\n");
+
+    printf("\n[1] Views\n");
+    z80twin* m = z80twin_create();
+    check(m != NULL && z80twin_abi_version() == Z80TWIN_ABI_VERSION, "created; ABI version matches the header");
+    uint8_t* memory = z80twin_memory(m);
+    z80twin_regs* regs = z80twin_registers(m);
+    check(regs->sp == 0xFFFF && regs->pc == 0 && regs->tstates == 0, "registers reset");
+    {
+        static const uint8_t program[] = {0x3A, 0x00, 0x80, 0x80, 0x32, 0x01, 0x80, 0x76};
+        // LD A,(8000h) / ADD A,B / LD (8001h),A / HALT, at 4000h
+        memcpy(memory + 0x4000, program, sizeof program);
+        memory[0x8000] = 0x21;
+        regs->pc = 0x4000;
+        regs->bc = 0x2100;
+        const z80twin_stop stop = z80twin_run_cycles(m, 1000);
+        check(stop == Z80TWIN_STOP_HALT && regs->halted && regs->pc == 0x4008, "ran from the PC written in place");
+        check(memory[0x8001] == 0x42 && (regs->af >> 8) == 0x42 && regs->tstates == 13 + 4 + 13 + 4,
+              "result in memory and A; T-states");
+        check(z80twin_memory(m) == memory && z80twin_registers(m) == regs, "the views do not move");
+    }
+
+    printf("\n[2] Batched runs\n");
+    {
+        load(m, kFill, sizeof kFill);
+        const z80twin_stop stop = z80twin_run_cycles(m, 10000000);
+        const z80twin_regs one = *regs;
+        uint8_t* image = malloc(Z80TWIN_MEMORY_SIZE);
+        memcpy(image, memory, Z80TWIN_MEMORY_SIZE);
+        check(stop == Z80TWIN_STOP_HALT && one.tstates > 250000 && memory[0x9FFF] == (0xFF ^ 0x8F),
+              "one call: the fill and copy ran to HALT");
+
+        load(m, kFill, sizeof kFill);
+        int calls = 0;
+        int boundaries = 1;
+        while (z80twin_run_cycles(m, 997) == Z80TWIN_STOP_BUDGET) {
+            ++calls;
+            boundaries &= regs->tstates >= (uint64_t)calls * 997 && !regs->halted;
+        }
+        check(calls > 250 && boundaries, "997 T-states a call: each returns at or past its target");
+        check(memcmp(regs, &one, sizeof one) == 0 && memcmp(memory, image, Z80TWIN_MEMORY_SIZE) == 0,
+              "same registers and memory as the single call");
+        free(image);
+
+        static const uint8_t prefixed[] = {0xDD, 0x21, 0x34, 0x12, 0x76};   // LD IX,1234h / HALT
+        load(m, prefixed, sizeof prefixed);
+        z80twin_run_cycles(m, 1);
+        check(regs->ix == 0x1234 && regs->pc == 4 && regs->tstates == 14,
+              "a 1 T-state budget still completes the prefixed instruction");
+    }
+
+    printf("\n[3] Port handlers\n");
+    {
+        device d = {0, 0, 0};
+        const z80twin_port_handler handler = {device_in, device_out, &d};
+        z80twin_map_ports(m, 0x10, 0x1F, &handler);
+        static const uint8_t program[] = {
+            0x3E, 0x40, 0xDB, 0x12,   // LD A,40h / IN A,(12h)
+            0x47,                     // LD B,A
+            0xD3, 0x1F,               // OUT (1Fh),A
+            0x3E, 0x40, 0xDB, 0x20,   // LD A,40h / IN A,(20h)   (unmapped)
+            0x76};
+        load(m, program, sizeof program);
+        z80twin_run_cycles(m, 1000);
+        check((regs->bc >> 8) == 0x41 && d.reads == 1, "IN reached the handler with its context");
+        check(d.last_port == 0x411F && d.last_out == 0x41, "OUT got the full port (A in the high byte) and value");
+        check((regs->af >> 8) == 0xFF && d.reads == 1, "an unmapped port reads as open bus");
+
+        z80twin_map_ports(m, 0x10, 0x1F, NULL);
+        load(m, program, sizeof program);
+        z80twin_run_cycles(m, 1000);
+        check((regs->bc >> 8) == 0xFF && d.reads == 1, "unmapped again: open bus");
+    }
+
+    printf("\n[4] Traps\n");
+    {
+        uint8_t program[0x101] = {0};
+        static const uint8_t body[] = {
+            0x31, 0x00, 0xF0,         // LD SP,F000h
+            0x06, 0x00,               // LD B,0
+            0x0E, 0x03,               // LD C,3
+            0xCD, 0x10, 0x00,         // loop: CALL 0010h
+            0x0D, 0x20, 0xFA,         // DEC C / JR NZ,loop
+            0xC3, 0x00, 0x01};        // JP 0100h
+        memcpy(program, body, sizeof body);
+        program[0x10] = 0x76;         // the stub: HALT / RET
+        program[0x11] = 0xC9;
+        program[0x100] = 0x76;        // the program's own HALT
+
+        load(m, program, sizeof program);
+        host h = {0, 0};
+        z80twin_stop stop = z80twin_run_until(m, 1000000, host_trap, &h);
+        check(stop == Z80TWIN_STOP_TRAP && h.calls == 3 && h.stops == 1, "three host calls served, then stopped");
+        check((regs->bc >> 8) == 3 && regs->pc == 0x0101 && regs->halted && regs->sp == 0xF000,
+              "each returned through the stub; halted at the end");
+
+        stop = z80twin_run_until(m, 1000000, host_trap, &h);
+        check(stop == Z80TWIN_STOP_TRAP && h.stops == 2 && h.calls == 3, "running again reports the same stop");
+
+        load(m, program, sizeof program);
+        stop = z80twin_run_until(m, 1000000, NULL, NULL);
+        check(stop == Z80TWIN_STOP_HALT && regs->pc == 0x0011, "no handler: the first HALT stops the run");
+    }
+
+    printf("\n[5] PC traps\n");
+    {
+        load(m, kFill, sizeof kFill);
+        z80twin_run_cycles(m, 10000000);
+        const z80twin_regs plain = *regs;
+
+        load(m, kFill, sizeof kFill);
+        memory[0x9FFF] = 0;
+        z80twin_set_pc_trap(m, 0x0018, 1);   // the LDIR
+        z80twin_stop stop = z80twin_run_until(m, 10000000, NULL, NULL);
+        check(stop == Z80TWIN_STOP_PC && regs->pc == 0x0018 && !regs->halted && memory[0x8FFF] == (0xFF ^ 0x8F) &&
+                  memory[0x9FFF] == 0,
+              "no handler: stops before the trapped instruction, no HALT patched in");
+        stop = z80twin_run_cycles(m, 10000000);
+        check(stop == Z80TWIN_STOP_PC && regs->pc == 0x0018 && regs->bc == 0x0FFF && memory[0x9000] == 0x80,
+              "running again runs it: LDIR copies one byte and is back at the trap");
+        z80twin_clear_pc_traps(m);
+        stop = z80twin_run_cycles(m, 10000000);
+        check(stop == Z80TWIN_STOP_HALT && memory[0x9FFF] == (0xFF ^ 0x8F), "cleared: runs to the end");
+
+        load(m, kFill, sizeof kFill);
+        z80twin_set_pc_trap(m, 0x0006, 1);
+        watch w = {0, 0x8100};
+        stop = z80twin_run_until(m, 10000000, watch_trap, &w);
+        check(stop == Z80TWIN_STOP_TRAP && regs->hl == 0x8100 && regs->pc == 0x0006 && w.passes == 0x101,
+              "a register condition, checked by the handler at a PC trap");
+        w.stop_at = 0;
+        stop = z80twin_run_until(m, 10000000, watch_trap, &w);
+        check(stop == Z80TWIN_STOP_TRAP && regs->halted && w.passes == 0x1000 &&
+                  memcmp(regs, &plain, sizeof plain) == 0,
+              "every pass seen once, and the run ends as an untrapped one does");
+        z80twin_set_pc_trap(m, 0x0006, 0);
+    }
+
+    printf("\n[6] Interrupts\n");
+    {
+        static const uint8_t program[] = {0xED, 0x56, 0xFB, 0x00, 0x18, 0xFE};   // IM 1 / EI / NOP / JR $
+        load(m, program, sizeof program);
+        regs->sp = 0xF000;
+        z80twin_run_cycles(m, 100);
+        check(z80twin_interrupt(m, 0xFF) == 1 && regs->pc == 0x0038 && !regs->iff1 && regs->sp == 0xEFFE,
+              "accepted: IM 1 to 0038h, IFF1 cleared, PC pushed");
+        check(z80twin_interrupt(m, 0xFF) == 0, "refused while IFF1 is clear");
+    }
+
+    printf("\n[7] State blob\n");
+    {
+        const size_t size = z80twin_state_size();
+        uint8_t* blob = malloc(size);
+        uint8_t* bad = malloc(size);
+        check(size == Z80TWIN_STATE_SIZE && z80twin_save_state(m, blob, size - 1) == 0,
+              "fixed size; a short buffer is refused");
+
+        load(m, kFill, sizeof kFill);
+        z80twin_run_cycles(m, 50000);
+        check(z80twin_save_state(m, blob, size) == size, "saved mid-run");
+        z80twin_run_cycles(m, 10000000);
+        const z80twin_regs end = *regs;
+        const uint8_t copy_end = memory[0x9FFF];
+
+        z80twin* other = z80twin_create();
+        check(z80twin_load_state(other, blob, size) == Z80TWIN_OK, "loaded into a new machine");
+        z80twin_run_cycles(other, 10000000);
+        check(memcmp(z80twin_registers(other), &end, sizeof end) == 0 && z80twin_memory(other)[0x9FFF] == copy_end,
+              "and it finished in the same state");
+
+        const z80twin_regs before = *regs;
+        memcpy(bad, blob, size);
+        bad[1000] ^= 1;
+        check(z80twin_load_state(m, bad, size) == Z80TWIN_ERROR_CHECKSUM, "corrupt: refused");
+        memcpy(bad, blob, size);
+        bad[6] = Z80TWIN_STATE_VERSION + 1;
+        check(z80twin_load_state(m, bad, size) == Z80TWIN_ERROR_VERSION, "newer version: refused");
+        check(z80twin_load_state(m, blob, size - 1) == Z80TWIN_ERROR_FORMAT &&
+                  z80twin_load_state(m, "Z80SNP", 6) == Z80TWIN_ERROR_FORMAT,
+              "wrong size or not a blob: refused");
+        check(memcmp(regs, &before, sizeof before) == 0, "the machine unchanged by the refusals");
+
+        z80twin_destroy(other);
+        free(bad);
+        free(blob);
+    }
+    z80twin_destroy(m);
+
+    printf("\n================\n");
+    if (failures == 0) {
+        printf("\xE2\x9C\x85 ALL LIBZ80TWIN CHECKS PASSED\n");
+        return 0;
+    }
+    printf("\xE2\x9D\x8C %d check(s) FAILED\n", failures);
+    return 1;
+}
@@ -0,0 +1,166 @@
+//
+// Z80 Digital Twin - ZEX test-table sharding verification
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// Checks tools/cpu_suite_runner/zex_shards.h on a small stand-in exerciser
+// built here with ZEXDOC's main loop and descriptor layout (the real
+// binaries are external assets):
+//   1. the test table and group names are found, and look-alikes rejected;
+//   2. a patched copy runs exactly the chosen groups;
+//   3. the frame plus per-group consoles merge into the sequential console,
+//      and output that does not fit the frame is refused.
+//
+
+#include "z80_cpu.h"
+#include "zex_shards.h"
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace z80::suite;
+
+int failures = 0;
+void check(bool ok, const char* what) {
+    std::cout << (ok ? "  ✓ " : "  ✗ ") << what << '\n';
+    if (!ok) ++failures;
+}
+
+/// A .COM image assembled in place: emit bytes, patch 16-bit addresses later.
+struct Image {
+    std::vector<uint8_t> bytes;
+
+    uint16_t here() const { return static_cast<uint16_t>(kCpmLoadAddress + bytes.size()); }
+    void emit(std::initializer_list<uint8_t> b) { bytes.insert(bytes.end(), b); }
+    void word(uint16_t w) { emit({static_cast<uint8_t>(w), static_cast<uint8_t>(w >> 8)}); }
+    void text(const std::string& s) { bytes.insert(bytes.end(), s.begin(), s.end()); }
+    void patch(uint16_t at, uint16_t w) {
+        bytes[at - kCpmLoadAddress] = static_cast<uint8_t>(w);
+        bytes[at - kCpmLoadAddress + 1] = static_cast<uint8_t>(w >> 8);
+    }
+};
+
+/// Banner, then for each group "<name>....  OK", then "Tests complete".
+std::vector<uint8_t> stand_in_exerciser() {
+    Image im;
+    im.emit({0xC3}); const uint16_t jp_start = im.here(); im.word(0);
+    const uint16_t tests = im.here();
+    im.word(0); im.word(0); im.word(0); im.word(0);
+
+    im.patch(jp_start, im.here());
+    im.emit({0x11}); const uint16_t ld_msg1 = im.here(); im.word(0);      // LD DE,msg1
+    im.emit({0x0E, 0x09, 0xCD, 0x05, 0x00});                               // LD C,9 / CALL 5
+    im.emit({0x21}); im.word(tests);                                       // LD HL,tests
+    const uint16_t loop = im.here();
+    im.emit({0x7E, 0x23, 0xB6, 0xCA}); const uint16_t jp_done = im.here(); im.word(0);
+    im.emit({0x2B, 0xCD}); const uint16_t call_stt = im.here(); im.word(0);
+    im.emit({0xC3}); im.word(loop);
+
+    im.patch(jp_done, im.here());
+    im.emit({0x11}); const uint16_t ld_msg2 = im.here(); im.word(0);
+    im.emit({0x0E, 0x09, 0xCD, 0x05, 0x00, 0xC3, 0x00, 0x00});             // ... / JP 0
+
+    im.patch(call_stt, im.here());
+    im.emit({0xE5, 0x5E, 0x23, 0x56});                                     // PUSH HL / LD DE,(HL)
+    im.emit({0x21, 0x41, 0x00, 0x19, 0xEB});                               // DE += 65
+    im.emit({0x0E, 0x09, 0xCD, 0x05, 0x00});                               // print the name
+    im.emit({0x11}); const uint16_t ld_ok = im.here(); im.word(0);
+    im.emit({0x0E, 0x09, 0xCD, 0x05, 0x00});
+    im.emit({0x06, 0x20, 0x10, 0xFE});                                     // LD B,32 / DJNZ $
+    im.emit({0xE1, 0x23, 0x23, 0xC9});                                     // POP HL / INC HL x2 / RET
+
+    im.patch(ld_msg1, im.here()); im.text("Stand-in exerciser\r\n$");
+    im.patch(ld_msg2, im.here()); im.text("Tests complete\r\n$");
+    im.patch(ld_ok, im.here()); im.text("  OK\r\n$");
+
+    uint16_t entry = tests;
+    for (const char* name : {"alpha....", "beta.....", "gamma...."}) {
+        im.patch(entry, im.here());
+        entry += 2;
+        im.bytes.insert(im.bytes.end(), 65, 0xAA);
+        im.text(std::string(name) + "$");
+    }
+    return im.bytes;
+}
+
+/// Console output of a CP/M run (BDOS 9 only), as the suite runner collects it.
+std::string console(const std::vector<uint8_t>& image) {
+    z80::CPU cpu;
+    cpu.Reset();
+    cpu.LoadProgram(image, kCpmLoadAddress);
+    cpu.PC() = kCpmLoadAddress;
+    cpu.SP() = 0xF000;
+    std::string out;
+    for (int n = 0; n < 100'000 && cpu.PC() != 0x0000; ++n) {
+        if (cpu.PC() == 0x0005) {
+            for (uint16_t a = cpu.DE(); cpu.ReadMemory(a) != '$'; ++a) out += static_cast<char>(cpu.ReadMemory(a));
+            cpu.PC() = static_cast<uint16_t>(cpu.ReadMemory(cpu.SP()) | (cpu.ReadMemory(cpu.SP() + 1) << 8));
+            cpu.SP() = static_cast<uint16_t>(cpu.SP() + 2);
+            continue;
+        }
+        do { cpu.Step(); } while (!cpu.InstructionComplete());
+    }
+    return out;
+}
+
+} // namespace
+
+int main() {
+    std::cout << "ZEX sharding\n============\n";
+    const std::vector<uint8_t> image = stand_in_exerciser();
+
+    // --- 1. Discovery ----------------------------------------------------------
+    std::cout << "\n[1] Finding the test table\n";
+    const auto table = find_zex_test_table(image);
+    check(table && table->address == 0x0103 && table->tests.size() == 3, "table at 0103h with three groups");
+    check(table && zex_test_name(image, table->tests[0]) == "alpha" && zex_test_name(image, table->tests[2]) == "gamma",
+          "group names read from the descriptors, dot padding trimmed");
+    check(!find_zex_test_table(std::vector<uint8_t>{0x3E, 0x01, 0xC9}), "a program without the loop: no table");
+    {
+        std::vector<uint8_t> broken = image;
+        broken[0x0103 - kCpmLoadAddress + 2] = 0x01;   // second entry -> 0x??01, not a descriptor
+        broken[0x0103 - kCpmLoadAddress + 3] = 0x00;
+        check(!find_zex_test_table(broken), "an entry that is not a named descriptor: no table");
+    }
+
+    // --- 2. Patching --------------------------------------------------------------
+    std::cout << "\n[2] Patched copies run only their groups\n";
+    const std::string sequential = console(image);
+    check(sequential == "Stand-in exerciser\r\nalpha....  OK\r\nbeta.....  OK\r\ngamma....  OK\r\nTests complete\r\n",
+          "the whole image runs all three groups");
+    const std::vector<uint16_t> only_beta = {table->tests[1]};
+    const std::string beta = console(with_zex_tests(image, *table, only_beta));
+    check(beta == "Stand-in exerciser\r\nbeta.....  OK\r\nTests complete\r\n", "a one-group copy runs just that group");
+    const std::string frame = console(with_zex_tests(image, *table, {}));
+    check(frame == "Stand-in exerciser\r\nTests complete\r\n", "the empty table leaves banner and closing message");
+    {
+        std::vector<uint8_t> copy = with_zex_tests(image, *table, only_beta);
+        const std::size_t table_begin = table->address - kCpmLoadAddress;
+        bool outside = false;
+        for (std::size_t i = 0; i < image.size(); ++i)
+            outside = outside || (copy[i] != image[i] && (i < table_begin || i >= table_begin + 8));
+        check(copy.size() == image.size() && !outside, "only the table bytes change");
+    }
+
+    // --- 3. Merging ------------------------------------------------------------------
+    std::cout << "\n[3] Merging group consoles\n";
+    std::vector<std::string> groups;
+    for (const uint16_t test : table->tests) groups.push_back(console(with_zex_tests(image, *table, {&test, 1})));
+    const auto merged = merge_zex_output(frame, groups);
+    check(merged && *merged == sequential, "frame + groups, in table order, equals the sequential console");
+    check(merge_zex_output(frame, std::vector<std::string>{}) == frame, "no groups: just the frame");
+    check(!merge_zex_output(frame, std::vector<std::string>{"something else entirely\r\n"}),
+          "a group console outside the frame is refused");
+
+    std::cout << "\n============\n";
+    if (failures == 0) {
+        std::cout << "✅ ALL ZEX-SHARD CHECKS PASSED\n";
+        return 0;
+    }
+    std::cout << "❌ " << failures << " check(s) FAILED\n";
+    return 1;
+}
@@ -0,0 +1,796 @@
+//
+// Z80 Digital Twin - benchmark harness
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// Statistics, timing and result files for the benchmark targets. A workload is
+// a batch function `run(reps)` plus the work one rep does (instructions and
+// T-states, counted once outside the timer). measure() then:
+//
+//   1. calibrates reps so one timed batch lasts at least min_sample_s;
+//   2. warms up — cache, branch predictors and the core clock — until
+//      warmup_s has passed AND two consecutive batches agree within 2%
+//      (frequency ramp-up shows as a falling batch time), capped at
+//      max_warmup_s;
+//   3. takes `samples` timed batches and summarises ns per emulated
+//      instruction as median, MAD and a distribution-free 95% confidence
+//      interval for the median;
+//   4. times a fixed host-only reference kernel before and after, so a clock
+//      change during the run shows up as drift rather than as a speed-up.
+//
+// The process pins itself to the CPU it started on (Linux) and records the
+// scaling governor, so results taken under "powersave" can be recognised.
+// Given a PerfCounters (perf_counters.h), measure() also counts host cycles,
+// instructions, branch misses, L1d and iTLB misses over the timed samples and
+// reports each per emulated instruction and per emulated T-state.
+// Reports are written as JSON and read back for compare(): a workload counts
+// as faster or slower only if its median moved by more than the threshold AND
+// the two confidence intervals do not overlap.
+//
+
+#ifndef Z80_TOOLS_BENCH_HARNESS_H
+#define Z80_TOOLS_BENCH_HARNESS_H
+
+#include "perf_counters.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+#ifndef Z80_TWIN_VERSION
+#define Z80_TWIN_VERSION "unknown"
+#endif
+
+namespace z80::bench {
+
+// =============================================================================
+// Statistics
+// =============================================================================
+
+struct Stats {
+    std::size_t n = 0;
+    double median = 0;
+    double mad = 0;       ///< Median absolute deviation, scaled by 1.4826 (≈ σ for normal data).
+    double ci_low = 0;    ///< 95% confidence interval for the median.
+    double ci_high = 0;
+    double min = 0;
+    double max = 0;
+};
+
+namespace detail {
+
+[[nodiscard]] inline double median_of_sorted(const std::vector<double>& v) {
+    const std::size_t n = v.size();
+    return n % 2 ? v[n / 2] : (v[n / 2 - 1] + v[n / 2]) / 2;
+}
+
+} // namespace detail
+
+/// @brief Summarise @p samples. The median's confidence interval uses order
+///        statistics (binomial, normal approximation), so it assumes nothing
+///        about the distribution; under six samples it is [min, max].
+[[nodiscard]] inline Stats summarize(std::vector<double> samples) {
+    Stats s;
+    s.n = samples.size();
+    if (samples.empty()) return s;
+    std::sort(samples.begin(), samples.end());
+    s.min = samples.front();
+    s.max = samples.back();
+    s.median = detail::median_of_sorted(samples);
+
+    std::vector<double> dev;
+    dev.reserve(samples.size());
+    for (double x : samples) dev.push_back(std::fabs(x - s.median));
+    std::sort(dev.begin(), dev.end());
+    s.mad = 1.4826 * detail::median_of_sorted(dev);
+
+    if (s.n < 6) {
+        s.ci_low = s.min;
+        s.ci_high = s.max;
+    } else {
+        const double n = static_cast<double>(s.n);
+        const double half = 1.96 * std::sqrt(n) / 2;
+        // 1-based ranks of the interval ends, clamped to the sample.
+        const auto rank = [&](double r) {
+            return static_cast<std::size_t>(std::clamp(std::round(r), 1.0, n)) - 1;
+        };
+        s.ci_low = samples[rank(n / 2 - half)];
+        s.ci_high = samples[rank(1 + n / 2 + half)];
+    }
+    return s;
+}
+
+// =============================================================================
+// Environment
+// =============================================================================
+
+struct Environment {
+    std::string version = Z80_TWIN_VERSION;
+    std::string compiler;
+    std::string build;
+    std::string governor;      ///< cpufreq scaling governor of the pinned CPU; empty if unknown.
+    int cpu = -1;              ///< CPU the process is pinned to; -1 = not pinned.
+    std::string perf;          ///< Hardware counters in use, or why there are none; empty = not asked for.
+    std::string timestamp;     ///< UTC, ISO 8601.
+};
+
+/// @brief Describe the host and (if @p pin) pin this thread to its current CPU.
+inline Environment capture_environment(bool pin) {
+    Environment env;
+#if defined(__clang__)
+    env.compiler = std::string("clang ") + __clang_version__;
+#elif defined(__GNUC__)
+    env.compiler = std::string("gcc ") + __VERSION__;
+#elif defined(_MSC_VER)
+    env.compiler = "msvc " + std::to_string(_MSC_VER);
+#else
+    env.compiler = "unknown";
+#endif
+#ifdef NDEBUG
+    env.build = "optimized";
+#else
+    env.build = "debug (assertions on)";
+#endif
+
+#if defined(__linux__)
+    const int cpu = sched_getcpu();
+    if (pin && cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        if (sched_setaffinity(0, sizeof set, &set) == 0) env.cpu = cpu;
+    }
+    if (cpu >= 0) {
+        std::ifstream f("/sys/devices/system/cpu/cpu" + std::to_string(cpu) +
+                        "/cpufreq/scaling_governor");
+        std::getline(f, env.governor);
+    }
+#else
+    (void)pin;
+#endif
+
+    const std::time_t now = std::time(nullptr);
+    char buf[32] = {};
+    if (const std::tm* utc = std::gmtime(&now))
+        std::strftime(buf, sizeof buf, "%Y-%m-%dT%H:%M:%SZ", utc);
+    env.timestamp = buf;
+    return env;
+}
+
+// =============================================================================
+// Measurement
+// =============================================================================
+
+struct Settings {
+    int samples = 30;
+    double min_sample_s = 0.010;
+    double warmup_s = 0.25;
+    double max_warmup_s = 3.0;
+};
+
+/// @brief A hardware counter over the timed samples, normalised.
+struct CounterRate {
+    std::string name;
+    double per_instr = 0;    ///< Per emulated instruction.
+    double per_tstate = 0;   ///< Per emulated T-state.
+};
+
+/// @brief Work done by one rep of a workload.
+struct Work {
+    uint64_t instructions = 0;
+    uint64_t tstates = 0;
+};
+
+struct Result {
+    std::string workload;
+    std::string config;
+    Work per_rep;
+    uint64_t reps = 0;                  ///< Reps per timed sample.
+    std::vector<double> ns_per_instr;   ///< One entry per sample.
+    Stats stats;                        ///< Of ns_per_instr.
+    double drift_pct = 0;               ///< Reference kernel, after vs before.
+    std::vector<CounterRate> counters;  ///< Empty without perf counters.
+
+    [[nodiscard]] const CounterRate* counter(std::string_view name) const {
+        for (const CounterRate& c : counters)
+            if (c.name == name) return &c;
+        return nullptr;
+    }
+
+    /// @brief Emulated T-states per host second at the median.
+    [[nodiscard]] double tstates_per_sec() const {
+        if (per_rep.instructions == 0 || stats.median <= 0) return 0;
+        return 1e9 * static_cast<double>(per_rep.tstates) /
+               (stats.median * static_cast<double>(per_rep.instructions));
+    }
+    /// @brief Emulated instructions per host second at the median.
+    [[nodiscard]] double instructions_per_sec() const {
+        return stats.median > 0 ? 1e9 / stats.median : 0;
+    }
+};
+
+struct Report {
+    Environment env;
+    Settings settings;
+    std::vector<Result> results;
+};
+
+namespace detail {
+
+using Clock = std::chrono::steady_clock;
+
+template <class Batch>
+double time_batch(Batch& batch, uint64_t reps) {
+    const Clock::time_point t0 = Clock::now();
+    batch(reps);
+    return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+/// Host-only integer loop: its time moves only with the core clock.
+inline double reference_kernel_s() {
+    double best = 1e9;
+    for (int round = 0; round < 5; ++round) {
+        const Clock::time_point t0 = Clock::now();
+        uint64_t x = 0x9E3779B97F4A7C15ull;
+        for (int i = 0; i < (1 << 20); ++i) {
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+        }
+        volatile uint64_t sink = x;
+        (void)sink;
+        best = std::min(best, std::chrono::duration<double>(Clock::now() - t0).count());
+    }
+    return best;
+}
+
+} // namespace detail
+
+/// @brief Measure one workload. @p batch(reps) runs the workload reps times;
+///        @p per_rep is what one rep executes (counted outside the timer).
+/// @param perf  If given and available, counted over the timed samples.
+template <class Batch>
+Result measure(std::string workload, std::string config, Work per_rep, Batch&& batch,
+               const Settings& settings = {}, PerfCounters* perf = nullptr) {
+    Result r;
+    r.workload = std::move(workload);
+    r.config = std::move(config);
+    r.per_rep = per_rep;
+    const double ref_before = detail::reference_kernel_s();
+
+    uint64_t reps = 1;
+    for (double t = detail::time_batch(batch, reps); t < settings.min_sample_s;
+         t = detail::time_batch(batch, reps)) {
+        const double scale = t > 0 ? 1.2 * settings.min_sample_s / t : 16;
+        reps = std::max(reps + 1, static_cast<uint64_t>(static_cast<double>(reps) * std::min(scale, 16.0)));
+    }
+    r.reps = reps;
+
+    double warm = 0;
+    double previous = 0;
+    while (warm < settings.max_warmup_s) {
+        const double t = detail::time_batch(batch, reps);
+        warm += t;
+        const bool steady = previous > 0 && std::fabs(t - previous) <= 0.02 * previous;
+        previous = t;
+        if (warm >= settings.warmup_s && steady) break;
+    }
+
+    const double instructions = static_cast<double>(per_rep.instructions * reps);
+    r.ns_per_instr.reserve(static_cast<std::size_t>(settings.samples));
+    const bool counting = perf && perf->available();
+    if (counting) perf->start();
+    for (int i = 0; i < settings.samples; ++i) {
+        const double t = detail::time_batch(batch, reps);
+        r.ns_per_instr.push_back(instructions > 0 ? 1e9 * t / instructions : 0);
+    }
+    if (counting) {
+        const double n = static_cast<double>(settings.samples);
+        const double tstates = static_cast<double>(per_rep.tstates * reps) * n;
+        for (const CounterReading& c : perf->stop())
+            r.counters.push_back({c.name, instructions > 0 ? c.value / (instructions * n) : 0,
+                                  tstates > 0 ? c.value / tstates : 0});
+    }
+    r.stats = summarize(r.ns_per_instr);
+
+    const double ref_after = detail::reference_kernel_s();
+    r.drift_pct = 100 * (ref_after - ref_before) / ref_before;
+    return r;
+}
+
+// =============================================================================
+// Text output
+// =============================================================================
+
+inline void print_table(std::ostream& os, const std::vector<Result>& results) {
+    os << std::left << std::setw(24) << "Workload" << std::setw(55) << "Config" << std::right
+       << std::setw(10) << "ns/instr" << std::setw(9) << "±MAD" << std::setw(21) << "95% CI"
+       << std::setw(10) << "MHz eq" << std::setw(9) << "drift" << '\n'
+       << std::string(138, '-') << '\n';
+    for (const Result& r : results) {
+        std::ostringstream ci;
+        ci << std::fixed << std::setprecision(3) << '[' << r.stats.ci_low << ", " << r.stats.ci_high << ']';
+        os << std::left << std::setw(24) << r.workload << std::setw(55) << r.config << std::right
+           << std::fixed << std::setprecision(3) << std::setw(10) << r.stats.median << std::setw(9)
+           << r.stats.mad << std::setw(21) << ci.str() << std::setprecision(1) << std::setw(10)
+           << r.tstates_per_sec() / 1e6 << std::setw(8) << r.drift_pct << "%\n";
+    }
+}
+
+/// @brief Hardware counters per emulated instruction (host cycles also per
+///        T-state); nothing if no result has counters.
+inline void print_counters(std::ostream& os, const std::vector<Result>& results) {
+    if (std::none_of(results.begin(), results.end(), [](const Result& r) { return !r.counters.empty(); }))
+        return;
+    os << "host counters per emulated instruction\n"
+       << std::left << std::setw(24) << "Workload" << std::setw(55) << "Config" << std::right
+       << std::setw(9) << "cycles" << std::setw(9) << "instr" << std::setw(7) << "IPC"
+       << std::setw(10) << "br-miss" << std::setw(10) << "L1d-miss" << std::setw(10) << "iTLB-miss"
+       << std::setw(9) << "cyc/T" << '\n'
+       << std::string(143, '-') << '\n';
+    const auto cell = [&os](const CounterRate* c, int width, int precision, bool per_tstate = false) {
+        if (c) os << std::setprecision(precision) << std::setw(width) << (per_tstate ? c->per_tstate : c->per_instr);
+        else os << std::setw(width) << "-";
+    };
+    for (const Result& r : results) {
+        if (r.counters.empty()) continue;
+        const CounterRate* cycles = r.counter("cycles");
+        const CounterRate* instr = r.counter("instructions");
+        os << std::left << std::setw(24) << r.workload << std::setw(55) << r.config << std::right << std::fixed;
+        cell(cycles, 9, 1);
+        cell(instr, 9, 1);
+        if (cycles && instr && cycles->per_instr > 0)
+            os << std::setprecision(2) << std::setw(7) << instr->per_instr / cycles->per_instr;
+        else
+            os << std::setw(7) << "-";
+        cell(r.counter("branch-misses"), 10, 4);
+        cell(r.counter("L1d-misses"), 10, 4);
+        cell(r.counter("iTLB-misses"), 10, 4);
+        cell(cycles, 9, 2, true);
+        os << '\n';
+    }
+}
+
+/// @brief Warnings about conditions that make numbers untrustworthy.
+inline void print_environment_warnings(std::ostream& os, const Report& report) {
+    if (!report.env.governor.empty() && report.env.governor != "performance")
+        os << "note: CPU frequency governor is '" << report.env.governor
+           << "'; set 'performance' for stable numbers\n";
+    if (report.env.build != "optimized") os << "note: assertions are on; use a Release build\n";
+    if (report.env.perf.starts_with("unavailable"))
+        os << "note: hardware counters " << report.env.perf << "; wall time only\n";
+    for (const Result& r : report.results)
+        if (std::fabs(r.drift_pct) > 5)
+            os << "note: " << r.workload << " / " << r.config << ": host clock drifted "
+               << std::fixed << std::setprecision(1) << r.drift_pct << "% during the run\n";
+}
+
+// =============================================================================
+// JSON
+// =============================================================================
+
+inline constexpr std::string_view kSchema = "z80twin-bench-1";
+
+namespace detail {
+
+inline std::string json_string(std::string_view s) {
+    std::string out = "\"";
+    for (const char c : s) {
+        switch (c) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char buf[8];
+                std::snprintf(buf, sizeof buf, "\\u%04x", static_cast<unsigned>(c));
+                out += buf;
+            } else {
+                out += c;
+            }
+        }
+    }
+    return out + '"';
+}
+
+inline std::string json_number(double v) {
+    if (!std::isfinite(v)) return "0";
+    std::ostringstream os;
+    os << std::setprecision(17) << v;
+    return os.str();
+}
+
+/// A parsed JSON value — just enough of JSON for reading reports back.
+struct Json {
+    enum class Kind { Null, Bool, Number, String, Array, Object } kind = Kind::Null;
+    bool boolean = false;
+    double number = 0;
+    std::string string;
+    std::vector<Json> items;
+    std::vector<std::pair<std::string, Json>> members;
+
+    [[nodiscard]] const Json* find(std::string_view key) const {
+        for (const auto& [k, v] : members)
+            if (k == key) return &v;
+        return nullptr;
+    }
+    [[nodiscard]] double num(std::string_view key) const {
+        const Json* v = find(key);
+        return v && v->kind == Kind::Number ? v->number : 0;
+    }
+    [[nodiscard]] std::string str(std::string_view key) const {
+        const Json* v = find(key);
+        return v && v->kind == Kind::String ? v->string : std::string();
+    }
+};
+
+class JsonParser {
+public:
+    explicit JsonParser(std::string_view text) : s_(text) {}
+
+    bool parse(Json& out, std::string* error) {
+        if (!value(out, 0)) {
+            if (error) *error = why_ + " at offset " + std::to_string(i_);
+            return false;
+        }
+        skip();
+        if (i_ != s_.size()) {
+            if (error) *error = "trailing characters at offset " + std::to_string(i_);
+            return false;
+        }
+        return true;
+    }
+
+private:
+    bool fail(const char* why) {
+        why_ = why;
+        return false;
+    }
+    void skip() {
+        while (i_ < s_.size() && (s_[i_] == ' ' || s_[i_] == '\n' || s_[i_] == '\r' || s_[i_] == '\t')) ++i_;
+    }
+    bool literal(std::string_view word) {
+        if (s_.substr(i_, word.size()) != word) return fail("invalid literal");
+        i_ += word.size();
+        return true;
+    }
+    bool string(std::string& out) {
+        ++i_;   // opening quote
+        while (i_ < s_.size() && s_[i_] != '"') {
+            char c = s_[i_++];
+            if (c == '\\') {
+                if (i_ >= s_.size()) break;
+                c = s_[i_++];
+                switch (c) {
+                case 'n': c = '\n'; break;
+                case 't': c = '\t'; break;
+                case 'r': c = '\r'; break;
+                case 'b': c = '\b'; break;
+                case 'f': c = '\f'; break;
+                case 'u': {
+                    if (i_ + 4 > s_.size()) return fail("bad \\u escape");
+                    const unsigned code = static_cast<unsigned>(std::stoul(std::string(s_.substr(i_, 4)), nullptr, 16));
+                    i_ += 4;
+                    c = code < 0x80 ? static_cast<char>(code) : '?';
+                    break;
+                }
+                default: break;   // \" \\ \/
+                }
+            }
+            out += c;
+        }
+        if (i_ >= s_.size()) return fail("unterminated string");
+        ++i_;
+        return true;
+    }
+    bool value(Json& out, int depth) {
+        if (depth > 32) return fail("nesting too deep");
+        skip();
+        if (i_ >= s_.size()) return fail("unexpected end of input");
+        const char c = s_[i_];
+        if (c == '{') {
+            out.kind = Json::Kind::Object;
+            ++i_;
+            skip();
+            if (i_ < s_.size() && s_[i_] == '}') return ++i_, true;
+            for (;;) {
+                skip();
+                if (i_ >= s_.size() || s_[i_] != '"') return fail("expected a key");
+                std::string key;
+                if (!string(key)) return false;
+                skip();
+                if (i_ >= s_.size() || s_[i_] != ':') return fail("expected ':'");
+                ++i_;
+                Json v;
+                if (!value(v, depth + 1)) return false;
+                out.members.emplace_back(std::move(key), std::move(v));
+                skip();
+                if (i_ < s_.size() && s_[i_] == ',') { ++i_; continue; }
+                if (i_ < s_.size() && s_[i_] == '}') return ++i_, true;
+                return fail("expected ',' or '}'");
+            }
+        }
+        if (c == '[') {
+            out.kind = Json::Kind::Array;
+            ++i_;
+            skip();
+            if (i_ < s_.size() && s_[i_] == ']') return ++i_, true;
+            for (;;) {
+                Json v;
+                if (!value(v, depth + 1)) return false;
+                out.items.push_back(std::move(v));
+                skip();
+                if (i_ < s_.size() && s_[i_] == ',') { ++i_; continue; }
+                if (i_ < s_.size() && s_[i_] == ']') return ++i_, true;
+                return fail("expected ',' or ']'");
+            }
+        }
+        if (c == '"') {
+            out.kind = Json::Kind::String;
+            return string(out.string);
+        }
+        if (c == 't' || c == 'f') {
+            out.kind = Json::Kind::Bool;
+            out.boolean = c == 't';
+            return literal(c == 't' ? "true" : "false");
+        }
+        if (c == 'n') return literal("null");
+        const std::size_t start = i_;
+        while (i_ < s_.size() && (std::isdigit(static_cast<unsigned char>(s_[i_])) || s_[i_] == '-' ||
+                                  s_[i_] == '+' || s_[i_] == '.' || s_[i_] == 'e' || s_[i_] == 'E'))
+            ++i_;
+        if (start == i_) return fail("unexpected character");
+        out.kind = Json::Kind::Number;
+        try {
+            out.number = std::stod(std::string(s_.substr(start, i_ - start)));
+        } catch (...) {
+            return fail("bad number");
+        }
+        return true;
+    }
+
+    std::string_view s_;
+    std::size_t i_ = 0;
+    std::string why_;
+};
+
+} // namespace detail
+
+inline void write_json(std::ostream& os, const Report& report) {
+    using detail::json_number;
+    using detail::json_string;
+    const Environment& e = report.env;
+    const Settings& s = report.settings;
+    os << "{\n  \"schema\": " << json_string(kSchema) << ",\n"
+       << "  \"environment\": {\"version\": " << json_string(e.version)
+       << ", \"compiler\": " << json_string(e.compiler) << ", \"build\": " << json_string(e.build)
+       << ", \"governor\": " << json_string(e.governor) << ", \"cpu\": " << e.cpu
+       << ", \"perf\": " << json_string(e.perf)
+       << ", \"timestamp\": " << json_string(e.timestamp) << "},\n"
+       << "  \"settings\": {\"samples\": " << s.samples << ", \"min_sample_s\": " << json_number(s.min_sample_s)
+       << ", \"warmup_s\": " << json_number(s.warmup_s) << ", \"max_warmup_s\": " << json_number(s.max_warmup_s)
+       << "},\n  \"results\": [";
+    for (std::size_t i = 0; i < report.results.size(); ++i) {
+        const Result& r = report.results[i];
+        os << (i ? ",\n" : "\n") << "    {\"workload\": " << json_string(r.workload)
+           << ", \"config\": " << json_string(r.config)
+           << ", \"instructions_per_rep\": " << r.per_rep.instructions
+           << ", \"tstates_per_rep\": " << r.per_rep.tstates << ", \"reps\": " << r.reps
+           << ",\n     \"median_ns_per_instr\": " << json_number(r.stats.median)
+           << ", \"mad_ns_per_instr\": " << json_number(r.stats.mad)
+           << ", \"ci_low\": " << json_number(r.stats.ci_low) << ", \"ci_high\": " << json_number(r.stats.ci_high)
+           << ",\n     \"instructions_per_sec\": " << json_number(r.instructions_per_sec())
+           << ", \"tstates_per_sec\": " << json_number(r.tstates_per_sec())
+           << ", \"drift_pct\": " << json_number(r.drift_pct) << ",\n     \"samples_ns_per_instr\": [";
+        for (std::size_t k = 0; k < r.ns_per_instr.size(); ++k)
+            os << (k ? ", " : "") << json_number(r.ns_per_instr[k]);
+        os << "]";
+        if (!r.counters.empty()) {
+            os << ",\n     \"counters\": [";
+            for (std::size_t k = 0; k < r.counters.size(); ++k)
+                os << (k ? ", " : "") << "{\"name\": " << json_string(r.counters[k].name)
+                   << ", \"per_instr\": " << json_number(r.counters[k].per_instr)
+                   << ", \"per_tstate\": " << json_number(r.counters[k].per_tstate) << "}";
+            os << "]";
+        }
+        os << "}";
+    }
+    os << "\n  ]\n}\n";
+}
+
+/// @return false (with @p error set) if the file cannot be written.
+inline bool write_json_file(const std::string& path, const Report& report, std::string* error = nullptr) {
+    std::ofstream f(path);
+    if (f) write_json(f, report);
+    if (!f) {
+        if (error) *error = "cannot write " + path;
+        return false;
+    }
+    return true;
+}
+
+/// @brief Read a report written by write_json(). Statistics are recomputed
+///        from the stored samples.
+/// @return false (with @p error set) on malformed input or a foreign schema.
+inline bool read_json(std::string_view text, Report& out, std::string* error = nullptr) {
+    detail::Json root;
+    if (!detail::JsonParser(text).parse(root, error)) return false;
+    if (root.kind != detail::Json::Kind::Object || root.str("schema") != kSchema) {
+        if (error) *error = "not a benchmark report (schema " + std::string(kSchema) + ")";
+        return false;
+    }
+    Report report;
+    if (const detail::Json* e = root.find("environment")) {
+        report.env.version = e->str("version");
+        report.env.compiler = e->str("compiler");
+        report.env.build = e->str("build");
+        report.env.governor = e->str("governor");
+        report.env.cpu = static_cast<int>(e->num("cpu"));
+        report.env.timestamp = e->str("timestamp");
+        report.env.perf = e->str("perf");
+    }
+    if (const detail::Json* s = root.find("settings")) {
+        report.settings.samples = static_cast<int>(s->num("samples"));
+        report.settings.min_sample_s = s->num("min_sample_s");
+        report.settings.warmup_s = s->num("warmup_s");
+        report.settings.max_warmup_s = s->num("max_warmup_s");
+    }
+    const detail::Json* results = root.find("results");
+    if (!results || results->kind != detail::Json::Kind::Array) {
+        if (error) *error = "missing results array";
+        return false;
+    }
+    for (const detail::Json& j : results->items) {
+        Result r;
+        r.workload = j.str("workload");
+        r.config = j.str("config");
+        r.per_rep.instructions = static_cast<uint64_t>(j.num("instructions_per_rep"));
+        r.per_rep.tstates = static_cast<uint64_t>(j.num("tstates_per_rep"));
+        r.reps = static_cast<uint64_t>(j.num("reps"));
+        r.drift_pct = j.num("drift_pct");
+        if (const detail::Json* samples = j.find("samples_ns_per_instr"))
+            for (const detail::Json& v : samples->items) r.ns_per_instr.push_back(v.number);
+        if (const detail::Json* counters = j.find("counters"))
+            for (const detail::Json& c : counters->items)
+                r.counters.push_back({c.str("name"), c.num("per_instr"), c.num("per_tstate")});
+        if (r.workload.empty() || r.ns_per_instr.empty()) {
+            if (error) *error = "result without a workload name or samples";
+            return false;
+        }
+        r.stats = summarize(r.ns_per_instr);
+        report.results.push_back(std::move(r));
+    }
+    out = std::move(report);
+    return true;
+}
+
+inline bool read_json_file(const std::string& path, Report& out, std::string* error = nullptr) {
+    std::ifstream f(path);
+    if (!f) {
+        if (error) *error = "cannot open " + path;
+        return false;
+    }
+    const std::string text((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+    if (!read_json(text, out, error)) {
+        if (error) *error = path + ": " + *error;
+        return false;
+    }
+    return true;
+}
+
+// =============================================================================
+// Comparison
+// =============================================================================
+
+enum class Verdict { Same, Faster, Slower, OnlyInBase, OnlyInCurrent };
+
+struct Comparison {
+    std::string workload;
+    std::string config;
+    double base_ns = 0;      ///< Median ns/instr; 0 if absent.
+    double current_ns = 0;
+    double change_pct = 0;   ///< (current - base) / base; positive = slower.
+    Verdict verdict = Verdict::Same;
+};
+
+/// @brief Pair up results by (workload, config). A change is significant when
+///        |change| > @p threshold_pct and the medians' confidence intervals
+///        are disjoint; anything else is Same.
+[[nodiscard]] inline std::vector<Comparison> compare(const Report& base, const Report& current,
+                                                     double threshold_pct) {
+    std::vector<Comparison> out;
+    const auto find = [](const Report& rep, const Result& r) -> const Result* {
+        for (const Result& x : rep.results)
+            if (x.workload == r.workload && x.config == r.config) return &x;
+        return nullptr;
+    };
+    for (const Result& b : base.results) {
+        Comparison c{b.workload, b.config, b.stats.median, 0, 0, Verdict::OnlyInBase};
+        if (const Result* n = find(current, b)) {
+            c.current_ns = n->stats.median;
+            c.change_pct = b.stats.median > 0 ? 100 * (n->stats.median - b.stats.median) / b.stats.median : 0;
+            const bool disjoint = n->stats.ci_low > b.stats.ci_high || n->stats.ci_high < b.stats.ci_low;
+            c.verdict = !disjoint || std::fabs(c.change_pct) <= threshold_pct ? Verdict::Same
+                        : c.change_pct > 0                                    ? Verdict::Slower
+                                                                              : Verdict::Faster;
+        }
+        out.push_back(std::move(c));
+    }
+    for (const Result& n : current.results)
+        if (!find(base, n)) out.push_back({n.workload, n.config, 0, n.stats.median, 0, Verdict::OnlyInCurrent});
+    return out;
+}
+
+inline const char* verdict_name(Verdict v) {
+    switch (v) {
+    case Verdict::Faster: return "faster";
+    case Verdict::Slower: return "SLOWER";
+    case Verdict::OnlyInBase: return "removed";
+    case Verdict::OnlyInCurrent: return "new";
+    case Verdict::Same: break;
+    }
+    return "~";
+}
+
+inline void print_comparison(std::ostream& os, const std::vector<Comparison>& rows) {
+    os << std::left << std::setw(24) << "Workload" << std::setw(55) << "Config" << std::right
+       << std::setw(11) << "base ns" << std::setw(11) << "new ns" << std::setw(10) << "change"
+       << std::setw(9) << "verdict" << '\n'
+       << std::string(120, '-') << '\n';
+    for (const Comparison& c : rows) {
+        os << std::left << std::setw(24) << c.workload << std::setw(55) << c.config << std::right
+           << std::fixed << std::setprecision(3) << std::setw(11) << c.base_ns << std::setw(11)
+           << c.current_ns << std::setprecision(1) << std::setw(9) << c.change_pct << '%'
+           << std::setw(9) << verdict_name(c.verdict) << '\n';
+    }
+}
+
+/// @brief The --compare mode of the benchmark targets: read two reports,
+///        print the comparison to @p os.
+/// @return 0 if nothing got significantly slower, 1 on a slowdown or an
+///         unreadable file.
+inline int compare_files(const std::string& base_path, const std::string& current_path,
+                         double threshold_pct, std::ostream& os) {
+    Report base;
+    Report current;
+    std::string error;
+    if (!read_json_file(base_path, base, &error) || !read_json_file(current_path, current, &error)) {
+        os << "error: " << error << '\n';
+        return 1;
+    }
+    os << "base:    " << base_path << " (" << base.env.version << ", " << base.env.timestamp << ")\n"
+       << "current: " << current_path << " (" << current.env.version << ", " << current.env.timestamp << ")\n"
+       << "threshold " << threshold_pct << "%, 95% CIs must not overlap\n\n";
+    const std::vector<Comparison> rows = compare(base, current, threshold_pct);
+    print_comparison(os, rows);
+    int slower = 0;
+    for (const Comparison& c : rows) slower += c.verdict == Verdict::Slower;
+    if (slower) {
+        os << "\n❌ " << slower << " significant slowdown(s)\n";
+        return 1;
+    }
+    os << "\n✅ no significant slowdowns\n";
+    return 0;
+}
+
+} // namespace z80::bench
+
+#endif // Z80_TOOLS_BENCH_HARNESS_H
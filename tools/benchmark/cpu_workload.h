@@ -0,0 +1,163 @@
+//
+// Z80 Digital Twin - benchmark CPU configurations and program workloads
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// for_each_config() visits every CPUImpl<Memory, Io> configuration that
+// z80_cpu.cpp instantiates, so a benchmark shows what each policy costs: the
+// null configuration, ObservableMemory with no observers attached, and the
+// two ObservableIo stacks, the null and the Callback stacks again with
+// InstrumentedCpuTraits (what counting the instruction mix costs), the null
+// configuration with ComputeCpuTraits (no R, WZ or interrupt bookkeeping),
+// ObservableMemory with ReplayIo, the lockstep checker's reference, and
+// FastMemory with PortTableIo, the machine libz80twin embeds. Keep the list in step with the explicit
+// instantiations at the end of z80_cpu.cpp.
+//
+// ProgramWorkload runs a self-initialising program to HALT. The instruction
+// and T-state counts of one rep are taken in an untimed pass; the timed
+// batch is only "reset PC, Step() until halted", with no per-step checks.
+// With interrupt_on_halt() set, every HALT is answered with an interrupt
+// (each acceptance counts as one instruction) and the rep ends at the first
+// HALT that cannot be woken — a DI / HALT tail.
+//
+
+#ifndef Z80_TOOLS_BENCH_CPU_WORKLOAD_H
+#define Z80_TOOLS_BENCH_CPU_WORKLOAD_H
+
+#include "bench_harness.h"
+#include "z80_cpu.h"
+#include "memory/observable_memory.h"
+#include "io/callback_io.h"
+#include "io/latched_io.h"
+#include "io/observable_io.h"
+#include "io/port_table_io.h"
+#include "io/replay_io.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace z80::bench {
+
+/// @brief Call `fn(std::type_identity<Cpu>{}, name)` for each instantiated
+///        CPU configuration, the null configuration first.
+template <class Fn>
+void for_each_config(Fn&& fn) {
+    fn(std::type_identity<CPUImpl<FastMemory, OpenBusIo>>{}, "FastMemory/OpenBusIo");
+    fn(std::type_identity<CPUImpl<ObservableMemory, OpenBusIo>>{}, "ObservableMemory/OpenBusIo");
+    fn(std::type_identity<CPUImpl<ObservableMemory, ObservableIo<LatchedIo>>>{},
+       "ObservableMemory/ObservableIo<Latched>");
+    fn(std::type_identity<CPUImpl<ObservableMemory, ObservableIo<CallbackIo>>>{},
+       "ObservableMemory/ObservableIo<Callback>");
+    fn(std::type_identity<InstrumentedCpu>{}, "FastMemory/OpenBusIo/Instrumented");
+    fn(std::type_identity<CPUImpl<ObservableMemory, ObservableIo<CallbackIo>, InstrumentedCpuTraits>>{},
+       "ObservableMemory/ObservableIo<Callback>/Instrumented");
+    fn(std::type_identity<ComputeCpu>{}, "FastMemory/OpenBusIo/Compute");
+    fn(std::type_identity<CPUImpl<ObservableMemory, ReplayIo>>{}, "ObservableMemory/ReplayIo");
+    fn(std::type_identity<CPUImpl<FastMemory, PortTableIo>>{}, "FastMemory/PortTableIo");
+}
+
+/// @brief Whether configuration @p Cpu accepts interrupts, so can run a
+///        workload that needs interrupt_on_halt() (not ComputeCpu).
+template <class Cpu> struct TakesInterrupts;
+template <class Memory, class Io, class Traits>
+struct TakesInterrupts<CPUImpl<Memory, Io, Traits>> : std::bool_constant<Traits::kInterrupts> {};
+
+template <class Cpu>
+class ProgramWorkload {
+public:
+    /// @param origin  Load and start address.
+    ProgramWorkload(const std::vector<uint8_t>& program, uint16_t origin = 0x0000)
+        : cpu_(std::make_unique<Cpu>()), origin_(origin) {
+        cpu_->Reset();
+        cpu_->LoadProgram(program, origin);
+    }
+
+    /// @brief Wake each HALT with Interrupt(@p bus) instead of ending the rep.
+    void interrupt_on_halt(uint8_t bus = 0xFF) {
+        interrupts_ = true;
+        bus_ = bus;
+    }
+
+    /// @brief Count one rep's work, untimed. The program runs twice and both
+    ///        runs must agree, so a workload whose second pass differs from
+    ///        its first (state left over from the previous rep) is caught.
+    /// @return nullopt if the program does not HALT within @p max_steps or
+    ///         is not repeatable.
+    std::optional<Work> count(uint64_t max_steps = 100'000'000) {
+        std::optional<Work> first;
+        for (int pass = 0; pass < 2; ++pass) {
+            restart();
+            Work w;
+            const uint64_t t0 = cpu_->GetCycleCount();
+            uint64_t steps = 0;
+            for (;;) {
+                while (!cpu_->IsHalted()) {
+                    if (++steps > max_steps) return std::nullopt;
+                    cpu_->Step();
+                    if (cpu_->InstructionComplete()) ++w.instructions;
+                }
+                if (!interrupts_ || !cpu_->Interrupt(bus_)) break;
+                ++w.instructions;
+            }
+            w.tstates = cpu_->GetCycleCount() - t0;
+            if (first && (first->instructions != w.instructions || first->tstates != w.tstates))
+                return std::nullopt;
+            first = w;
+        }
+        return first;
+    }
+
+    /// @brief The timed batch: run the program @p reps times.
+    void run(uint64_t reps) {
+        for (uint64_t i = 0; i < reps; ++i) {
+            restart();
+            for (;;) {
+                while (!cpu_->IsHalted()) cpu_->Step();
+                if (!interrupts_ || !cpu_->Interrupt(bus_)) break;
+            }
+        }
+    }
+
+    [[nodiscard]] Cpu& cpu() noexcept { return *cpu_; }
+
+private:
+    void restart() {
+        cpu_->PC() = origin_;
+        cpu_->SetHalted(false);
+        // ReplayIo records every access until cleared; the lockstep checker
+        // clears it per check, and so does each rep here.
+        if constexpr (requires { cpu_->GetIo().Clear(); }) cpu_->GetIo().Clear();
+    }
+
+    std::unique_ptr<Cpu> cpu_;
+    uint16_t origin_;
+    bool interrupts_ = false;
+    uint8_t bus_ = 0xFF;
+};
+
+/// @brief Measure @p program on configuration @p Cpu; nullopt (with @p error
+///        set) if it does not halt or is not repeatable.
+/// @param interrupts  Answer each HALT with an interrupt (see interrupt_on_halt()).
+/// @param perf        Hardware counters to read over the timed samples, or null.
+template <class Cpu>
+std::optional<Result> measure_program(const std::string& workload, const std::string& config,
+                                      const std::vector<uint8_t>& program, const Settings& settings,
+                                      std::string* error = nullptr, bool interrupts = false,
+                                      PerfCounters* perf = nullptr) {
+    ProgramWorkload<Cpu> w(program);
+    if (interrupts) w.interrupt_on_halt();
+    const std::optional<Work> per_rep = w.count();
+    if (!per_rep || per_rep->instructions == 0) {
+        if (error) *error = workload + ": program does not halt, or differs between runs";
+        return std::nullopt;
+    }
+    return measure(workload, config, *per_rep, [&w](uint64_t reps) { w.run(reps); }, settings, perf);
+}
+
+} // namespace z80::bench
+
+#endif // Z80_TOOLS_BENCH_CPU_WORKLOAD_H
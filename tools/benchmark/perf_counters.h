@@ -0,0 +1,165 @@
+//
+// Z80 Digital Twin - Linux perf_event hardware counters for the benchmarks
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// PerfCounters opens one perf_event_open counter per event for this thread,
+// user space only, so it works at perf_event_paranoid <= 2 without
+// privileges: host cycles, instructions, branch misses, L1d read misses and
+// iTLB read misses. The events are opened independently (not as a group), so
+// a PMU that lacks one event — common for the cache events in VMs — still
+// gives the rest. If the kernel has multiplexed an event, its count is
+// scaled by time_enabled / time_running.
+//
+// Anywhere perf is missing — another OS, a container with perf disabled, or
+// paranoid 3 — available() is false and reason() says why. The benchmarks
+// then report wall time only.
+//
+
+#ifndef Z80_TOOLS_BENCH_PERF_COUNTERS_H
+#define Z80_TOOLS_BENCH_PERF_COUNTERS_H
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace z80::bench {
+
+struct CounterReading {
+    std::string name;
+    double value = 0;
+};
+
+class PerfCounters {
+public:
+    PerfCounters() { open_all(); }
+    ~PerfCounters() { close_all(); }
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    /// @brief At least one counter opened.
+    [[nodiscard]] bool available() const noexcept { return !counters_.empty(); }
+    /// @brief Why nothing (or not everything) opened; empty if all did.
+    [[nodiscard]] const std::string& reason() const noexcept { return reason_; }
+
+    [[nodiscard]] std::vector<std::string> names() const {
+        std::vector<std::string> out;
+        for (const Counter& c : counters_) out.push_back(c.name);
+        return out;
+    }
+
+    /// @brief "cycles, instructions, ..." (plus what is missing), or
+    ///        "unavailable: <reason>" — for reports.
+    [[nodiscard]] std::string describe() const {
+        if (!available()) return "unavailable: " + reason_;
+        std::string out;
+        for (const Counter& c : counters_) out += (out.empty() ? "" : ", ") + c.name;
+        return reason_.empty() ? out : out + " (" + reason_ + ")";
+    }
+
+    /// @brief Zero and enable every counter.
+    void start() {
+#if defined(__linux__)
+        for (const Counter& c : counters_) {
+            ioctl(c.fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(c.fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    /// @brief Disable every counter and read it (scaled if multiplexed).
+    [[nodiscard]] std::vector<CounterReading> stop() {
+        std::vector<CounterReading> out;
+#if defined(__linux__)
+        for (const Counter& c : counters_) ioctl(c.fd, PERF_EVENT_IOC_DISABLE, 0);
+        for (const Counter& c : counters_) {
+            uint64_t v[3] = {};   // value, time_enabled, time_running
+            if (read(c.fd, v, sizeof v) != static_cast<ssize_t>(sizeof v) || v[2] == 0) continue;
+            const double scale = static_cast<double>(v[1]) / static_cast<double>(v[2]);
+            out.push_back({c.name, static_cast<double>(v[0]) * scale});
+        }
+#endif
+        return out;
+    }
+
+private:
+    struct Counter {
+        std::string name;
+        int fd = -1;
+    };
+
+    void open_all() {
+#if defined(__linux__)
+        const auto cache = [](uint64_t cache_id) {
+            return cache_id | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        };
+        const struct {
+            const char* name;
+            uint32_t type;
+            uint64_t config;
+        } events[] = {
+            {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {"branch-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+            {"L1d-misses", PERF_TYPE_HW_CACHE, cache(PERF_COUNT_HW_CACHE_L1D)},
+            {"iTLB-misses", PERF_TYPE_HW_CACHE, cache(PERF_COUNT_HW_CACHE_ITLB)},
+        };
+        std::string missing;
+        int first_errno = 0;
+        for (const auto& e : events) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof attr);
+            attr.size = sizeof attr;
+            attr.type = e.type;
+            attr.config = e.config;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            const long fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+            if (fd >= 0) {
+                counters_.push_back({e.name, static_cast<int>(fd)});
+            } else {
+                if (!first_errno) first_errno = errno;
+                missing += missing.empty() ? e.name : std::string(", ") + e.name;
+            }
+        }
+        if (counters_.empty()) {
+            reason_ = "perf_event_open failed: " + std::string(std::strerror(first_errno));
+            if (first_errno == EACCES || first_errno == EPERM) {
+                std::ifstream f("/proc/sys/kernel/perf_event_paranoid");
+                std::string level;
+                if (std::getline(f, level)) reason_ += " (perf_event_paranoid = " + level + ")";
+            }
+        } else if (!missing.empty()) {
+            reason_ = "not supported here: " + missing;
+        }
+#else
+        reason_ = "hardware counters need Linux perf_event_open";
+#endif
+    }
+
+    void close_all() {
+#if defined(__linux__)
+        for (const Counter& c : counters_) close(c.fd);
+#endif
+        counters_.clear();
+    }
+
+    std::vector<Counter> counters_;
+    std::string reason_;
+};
+
+} // namespace z80::bench
+
+#endif // Z80_TOOLS_BENCH_PERF_COUNTERS_H
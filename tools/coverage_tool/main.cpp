@@ -0,0 +1,191 @@
+//
+// Z80 Digital Twin - coverage merge / diff / export tool
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// Works on the .cov files a DebugSession's coverage is saved to (see
+// debugger/analysis/coverage_map.h; spectrum_probe --coverage-out writes one).
+// Typical flow: run the same title under many input scripts in parallel, then
+//
+//   coverage_tool merge -o all.cov --jobs 8 runs/*.cov     # union
+//   coverage_tool intersect -o core.cov runs/*.cov         # code every run hit
+//   coverage_tool diff base.cov run_b.cov --sym game.sym   # only in run B
+//   coverage_tool lcov all.cov --sym game.sym -o all.info  # lcov tracefile
+//   coverage_tool lcov run_b.cov --code all.cov            # ... with B's misses
+//
+// Exit codes: 0 success, 1 a file could not be read or written, 2 bad usage.
+//
+
+#include "coverage_map.h"
+#include "symbol_table.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using z80::dbg::CoverageMap;
+using z80::dbg::CoverageRange;
+using z80::dbg::SymbolTable;
+
+struct Options {
+    std::string command;
+    std::vector<std::string> inputs;
+    std::string output;
+    std::string symbols;
+    std::string code;
+    unsigned jobs = 0;
+};
+
+void usage(const char* prog) {
+    std::cout
+        << "Coverage merge / diff / export tool\n\n"
+        << "Usage:\n"
+        << "  " << prog << " merge -o OUT [--jobs N] FILE...\n"
+        << "  " << prog << " intersect -o OUT FILE...\n"
+        << "  " << prog << " diff A B [--sym FILE]\n"
+        << "  " << prog << " lcov FILE [--sym FILE] [--code FILE] [-o OUT]\n"
+        << "  " << prog << " info FILE...\n\n"
+        << "merge      union of all runs (hit counts added), on N threads\n"
+        << "intersect  code executed by every run\n"
+        << "diff       code only reached in B, then code only reached in A\n"
+        << "lcov       lcov tracefile, one record per symbol (stdout without -o);\n"
+        << "           --code also lists that map's code FILE never ran, at 0 hits\n"
+        << "info       runs, code bytes and name of each file\n";
+}
+
+Options parse_args(int argc, char** argv) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        const std::string a = argv[i];
+        if (a == "-h" || a == "--help") {
+            usage(argv[0]);
+            std::exit(0);
+        } else if (a == "-o" && i + 1 < argc) {
+            opt.output = argv[++i];
+        } else if (a == "--sym" && i + 1 < argc) {
+            opt.symbols = argv[++i];
+        } else if (a == "--code" && i + 1 < argc) {
+            opt.code = argv[++i];
+        } else if (a == "--jobs" && i + 1 < argc) {
+            opt.jobs = static_cast<unsigned>(std::stoul(argv[++i]));
+        } else if (!a.empty() && a[0] == '-') {
+            std::cerr << "Unknown or incomplete argument: " << a << "\n";
+            std::exit(2);
+        } else if (opt.command.empty()) {
+            opt.command = a;
+        } else {
+            opt.inputs.push_back(a);
+        }
+    }
+    return opt;
+}
+
+bool load(const std::string& path, CoverageMap& map) {
+    std::string why;
+    if (map.LoadFromFile(path, &why)) return true;
+    std::cerr << path << ": " << why << "\n";
+    return false;
+}
+
+SymbolTable load_symbols(const std::string& path) {
+    SymbolTable symbols;
+    if (!path.empty() && !symbols.LoadFromFile(path))
+        std::cerr << "warning: could not read symbols from " << path << "\n";
+    return symbols;
+}
+
+void print_ranges(const char* title, const std::vector<CoverageRange>& ranges) {
+    uint32_t bytes = 0;
+    for (const CoverageRange& r : ranges) bytes += r.end - r.start;
+    std::printf("%s: %zu range(s), %u byte(s)\n", title, ranges.size(), bytes);
+    for (const CoverageRange& r : ranges)
+        std::printf("  %04X-%04X  %5u  %s\n", r.start, static_cast<unsigned>(r.end - 1),
+                    static_cast<unsigned>(r.end - r.start), r.label.c_str());
+}
+
+int save(const CoverageMap& map, const std::string& path) {
+    if (map.SaveToFile(path)) return 0;
+    std::cerr << path << ": cannot write\n";
+    return 1;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const Options opt = parse_args(argc, argv);
+
+    if (opt.command == "merge" || opt.command == "intersect") {
+        if (opt.output.empty() || opt.inputs.empty()) { usage(argv[0]); return 2; }
+        if (opt.command == "merge") {
+            const auto t0 = std::chrono::steady_clock::now();
+            std::vector<std::string> errors;
+            const CoverageMap total = CoverageMap::MergeFiles(opt.inputs, opt.jobs, &errors);
+            const double ms = std::chrono::duration<double, std::milli>(
+                                  std::chrono::steady_clock::now() - t0).count();
+            for (const std::string& e : errors) std::cerr << e << "\n";
+            std::printf("merged %u run(s) from %zu file(s) in %.1f ms: %u code byte(s)\n",
+                        total.Runs(), opt.inputs.size() - errors.size(), ms, total.CodeBytes());
+            if (const int rc = save(total, opt.output)) return rc;
+            return errors.empty() ? 0 : 1;
+        }
+        CoverageMap common;
+        if (!load(opt.inputs[0], common)) return 1;
+        for (std::size_t i = 1; i < opt.inputs.size(); ++i) {
+            CoverageMap next;
+            if (!load(opt.inputs[i], next)) return 1;
+            common.Intersect(next);
+        }
+        std::printf("%u code byte(s) common to %u run(s)\n", common.CodeBytes(), common.Runs());
+        return save(common, opt.output);
+    }
+
+    if (opt.command == "diff") {
+        if (opt.inputs.size() != 2) { usage(argv[0]); return 2; }
+        CoverageMap a, b;
+        if (!load(opt.inputs[0], a) || !load(opt.inputs[1], b)) return 1;
+        const SymbolTable symbols = load_symbols(opt.symbols);
+        print_ranges(("only in " + opt.inputs[1]).c_str(), CoverageMap::CodeOnlyIn(b, a, &symbols));
+        print_ranges(("only in " + opt.inputs[0]).c_str(), CoverageMap::CodeOnlyIn(a, b, &symbols));
+        return 0;
+    }
+
+    if (opt.command == "lcov") {
+        if (opt.inputs.size() != 1) { usage(argv[0]); return 2; }
+        CoverageMap map, code;
+        if (!load(opt.inputs[0], map)) return 1;
+        if (!opt.code.empty() && !load(opt.code, code)) return 1;
+        const CoverageMap* known = opt.code.empty() ? nullptr : &code;
+        const SymbolTable symbols = load_symbols(opt.symbols);
+        if (opt.output.empty()) {
+            map.WriteLcov(std::cout, symbols, known);
+            return 0;
+        }
+        std::ofstream out(opt.output);
+        if (!out) { std::cerr << opt.output << ": cannot write\n"; return 1; }
+        map.WriteLcov(out, symbols, known);
+        return 0;
+    }
+
+    if (opt.command == "info") {
+        if (opt.inputs.empty()) { usage(argv[0]); return 2; }
+        int rc = 0;
+        for (const std::string& path : opt.inputs) {
+            CoverageMap map;
+            if (!load(path, map)) { rc = 1; continue; }
+            std::printf("%s: %u run(s), %u code byte(s) (%.2f%%)%s%s\n", path.c_str(), map.Runs(),
+                        map.CodeBytes(), 100.0 * map.CodeBytes() / 65536.0,
+                        map.Name().empty() ? "" : ", ", map.Name().c_str());
+        }
+        return rc;
+    }
+
+    usage(argv[0]);
+    return 2;
+}
@@ -0,0 +1,130 @@
+//
+// Z80 Digital Twin - CPU suite checkpoints
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// A checkpoint is one job's CpmMachine (machine/cpm/cpm_state.h) plus what the
+// runner needs to carry on: how many instructions it had counted, and the
+// state's hash at the moment it was written. The CpmState tag holds a hash of
+// the job's image, so a checkpoint is only ever resumed into the program it
+// came from.
+//
+// Resuming restores the state, captures the machine again and compares the
+// hash with the stored one: the file's checksum shows it was read intact, the
+// hash shows the machine really is where the checkpoint left it. The console
+// is part of the state, so the resumed run prints the same bytes the
+// uninterrupted one would.
+//
+// Files are written to a temporary name beside the target and renamed over
+// it, so a run killed mid-write leaves the previous checkpoint in place.
+//
+// File format (little-endian):
+//   "Z80CKP" u8 version u8 flags (bit 0: instructions counted) |
+//   u64 state hash | u64 instructions | u32 n, n bytes CpmState | u32 FNV-1a.
+//
+
+#ifndef Z80_TOOLS_CHECKPOINT_H
+#define Z80_TOOLS_CHECKPOINT_H
+
+#include "cpm/cpm_state.h"
+#include "fnv.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <span>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace z80::suite {
+
+struct Checkpoint {
+    static constexpr uint8_t kVersion = 1;
+
+    uint64_t state_hash = 0;
+    uint64_t instructions = 0;
+    bool counted = false;   ///< instructions is a count (--count-instructions)
+    z80::machine::cpm::CpmState state;
+};
+
+/// @brief Identifies a job's program; stored as the checkpoint state's tag.
+inline uint64_t image_hash(std::span<const uint8_t> image) noexcept { return fnv1a64(image); }
+
+/// @brief Write @p checkpoint to @p path atomically (temporary file, rename).
+/// @return false if it could not be written; any previous file is untouched.
+inline bool write_checkpoint(const std::filesystem::path& path, const Checkpoint& checkpoint) {
+    std::vector<uint8_t> out = {'Z', '8', '0', 'C', 'K', 'P', Checkpoint::kVersion,
+                                static_cast<uint8_t>(checkpoint.counted ? 1 : 0)};
+    const auto put = [&out](uint64_t v, int n) {
+        for (int k = 0; k < n; ++k) out.push_back(static_cast<uint8_t>(v >> (8 * k)));
+    };
+    put(checkpoint.state_hash, 8);
+    put(checkpoint.instructions, 8);
+    const std::vector<uint8_t> state = checkpoint.state.save();
+    put(state.size(), 4);
+    out.insert(out.end(), state.begin(), state.end());
+    put(fnv1a32(out), 4);
+
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+    std::filesystem::path tmp = path;
+    tmp += ".tmp";
+    {
+        std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+        f.write(reinterpret_cast<const char*>(out.data()), static_cast<std::streamsize>(out.size()));
+        if (!f.flush()) {
+            f.close();
+            std::filesystem::remove(tmp, ec);
+            return false;
+        }
+    }
+    std::filesystem::rename(tmp, path, ec);
+    if (ec) std::filesystem::remove(tmp, ec);
+    return !ec;
+}
+
+/// @brief Read a checkpoint; nullopt (with @p error set, if given) if the
+///        file is missing, truncated or corrupt.
+inline std::optional<Checkpoint> read_checkpoint(const std::filesystem::path& path, std::string* error = nullptr) {
+    const auto fail = [error](const std::string& why) {
+        if (error) *error = why;
+        return std::nullopt;
+    };
+    std::ifstream f(path, std::ios::binary);
+    if (!f) return fail("cannot open " + path.string());
+    const std::vector<uint8_t> in((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+
+    static constexpr uint8_t kMagic[] = {'Z', '8', '0', 'C', 'K', 'P'};
+    constexpr std::size_t kHeader = 8 + 8 + 8 + 4;
+    if (in.size() < kHeader + 4 || !std::equal(std::begin(kMagic), std::end(kMagic), in.begin()))
+        return fail("not a checkpoint");
+    if (in[6] != Checkpoint::kVersion) return fail("unsupported checkpoint version");
+    const std::size_t end = in.size() - 4;
+    const uint32_t stored = static_cast<uint32_t>(in[end] | (in[end + 1] << 8) | (in[end + 2] << 16)) |
+                            (static_cast<uint32_t>(in[end + 3]) << 24);
+    if (stored != fnv1a32(std::span(in).first(end))) return fail("checksum mismatch");
+
+    std::size_t pos = 8;
+    const auto get = [&](int n) {
+        uint64_t v = 0;
+        for (int k = 0; k < n; ++k) v |= static_cast<uint64_t>(in[pos++]) << (8 * k);
+        return v;
+    };
+    Checkpoint c;
+    c.counted = (in[7] & 1) != 0;
+    c.state_hash = get(8);
+    c.instructions = get(8);
+    const uint64_t state_bytes = get(4);
+    if (state_bytes != end - kHeader) return fail("wrong size");
+    std::string why;
+    if (!c.state.load(std::span(in).subspan(kHeader, state_bytes), &why)) return fail(why);
+    return c;
+}
+
+} // namespace z80::suite
+
+#endif // Z80_TOOLS_CHECKPOINT_H
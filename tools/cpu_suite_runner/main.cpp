@@ -4,25 +4,65 @@
 // Licensed under the MIT License (see LICENSE file)
 //
 // Runs freely available Z80 exerciser binaries as local assets. The first
-// adapter is CP/M .COM: load at 0x0100, intercept BDOS CALL 0005h console
-// output, and judge the emitted report. Missing assets are SKIP so a clean
-// checkout remains green.
+// adapter is CP/M .COM: the program runs on a CpmMachine (machine/cpm), whose
+// BDOS is a host trap, at full RunUntilCycle() speed; the runner judges the
+// console it printed. Missing assets are SKIP so a clean checkout remains
+// green.
+//
+// `--case all` runs every case, `--jobs N` of them at once, one CPU per worker
+// thread. Workers stream progress to the main thread through a lock-free
+// queue (progress_queue.h); each case writes a .log and a .json artifact with
+// its wall time and T-states/s, and `all` adds all.json. Budgets are in
+// T-states; `--count-instructions` also counts instructions (and reports
+// instructions/s) at the cost of stepping one instruction at a time.
+//
+// ZEXDOC/ZEXALL are sharded by default: the runner finds the exerciser's
+// test table and runs each test group as its own job, so one case spreads
+// over every worker. The group consoles are merged back into the output of
+// one sequential run (zex_shards.h). `--no-shard` runs the image unchanged.
+//
+// Long runs can checkpoint (`--checkpoint-tstates N`, `--checkpoint-seconds T`):
+// each job periodically writes its whole machine — CPU, memory, console so
+// far — under <artifacts>/checkpoints, atomically (checkpoint.h), and once
+// more when it stops. `--resume` continues every job from its checkpoint,
+// after checking the restored machine against the state hash saved with it;
+// the console, and so the log, comes out byte-identical to an uninterrupted
+// run. A finished job resumes straight to its result.
+//
+// `--lockstep` checks the run as it goes: a LockstepChecker (debugger/exec)
+// follows the CPU's bulk path with the Step() reference, comparing registers
+// after every instruction, or registers and memory every N T-states with
+// `--lockstep-interval N`; `--lockstep-sample S` checks one such block in S.
+// The first divergence fails the job, and its log names the instruction.
 //
 
+#include "checkpoint.h"
+#include "cpm/cpm_machine.h"
+#include "cpm/cpm_state.h"
+#include "lockstep_checker.h"
+#include "progress_queue.h"
 #include "z80_cpu.h"
+#include "zex_shards.h"
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cctype>
+#include <chrono>
 #include <cstdint>
+#include <cstdio>
 #include <cstdlib>
 #include <filesystem>
 #include <fstream>
+#include <functional>
 #include <iomanip>
 #include <iostream>
+#include <optional>
+#include <span>
 #include <sstream>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <vector>
 
 namespace {
@@ -40,15 +80,25 @@ struct Case {
     std::string asset;
     std::vector<std::string> expected_output;
     std::vector<std::string> reject_output;
-    uint64_t timeout_instructions = 200'000'000;
+    uint64_t timeout_tstates = 2'000'000'000;
 };
 
 struct Options {
     std::string case_name = "zexdoc";
     std::string assets_root;
     std::string artifact_root = "build/compat-artifacts/cpu";
-    uint64_t timeout_instructions = 0;
+    uint64_t timeout_tstates = 0;
+    unsigned jobs = 0;   ///< 0: one per hardware thread
+    bool shard = true;
+    bool count_instructions = false;
+    uint64_t checkpoint_tstates = 0;   ///< 0: no T-state interval
+    double checkpoint_seconds = 0;     ///< 0: no wall-clock interval
+    bool resume = false;
     bool list = false;
+    bool lockstep = false;
+    z80::dbg::LockstepOptions lockstep_options;
+
+    [[nodiscard]] bool checkpoints() const { return checkpoint_tstates != 0 || checkpoint_seconds > 0; }
 };
 
 std::vector<Case> cases() {
@@ -59,7 +109,7 @@ std::vector<Case> cases() {
             "cpu/zexdoc.com",
             {"Z80", "OK"},
             {"ERROR", "FAILED", "FAIL"},
-            10'000'000'000,
+            100'000'000'000,
         },
         {
             "zexall",
@@ -67,7 +117,7 @@ std::vector<Case> cases() {
             "cpu/zexall.com",
             {"Z80", "OK"},
             {"ERROR", "FAILED", "FAIL"},
-            10'000'000'000,
+            100'000'000'000,
         },
     };
 }
@@ -77,7 +127,14 @@ void usage(const char* prog) {
         << "CPU correctness suite runner\n\n"
         << "Usage:\n"
         << "  " << prog << " --case zexdoc [--assets DIR] [--artifacts DIR]\n"
-        << "  " << prog << " --case zexdoc --timeout-instructions N\n"
+        << "  " << prog << " --case zexdoc --timeout-tstates N [--count-instructions]\n"
+        << "  " << prog << " --case all [--jobs N]   every case, N at a time (default: all cores)\n"
+        << "  " << prog << " --case zexall --no-shard  one sequential run instead of one job per test group\n"
+        << "  " << prog << " --case all --checkpoint-seconds T [--checkpoint-tstates N]  checkpoint every job\n"
+        << "  " << prog << " --case all --resume [--checkpoint-seconds T]  continue from the last checkpoints\n"
+        << "  " << prog << " --case zexdoc --lockstep [--lockstep-interval N] [--lockstep-sample S]\n"
+        << "                  check the CPU against the Step() reference (every instruction, or every N T-states;\n"
+        << "                  one block in S)\n"
         << "  " << prog << " --list\n\n"
         << "Environment:\n"
         << "  Z80_COMPAT_ASSETS   root for external assets, e.g. cpu/zexdoc.com\n\n"
@@ -102,13 +159,37 @@ Options parse_args(int argc, char** argv) {
             opt.assets_root = argv[++i];
         } else if (a == "--artifacts" && i + 1 < argc) {
             opt.artifact_root = argv[++i];
-        } else if (a == "--timeout-instructions" && i + 1 < argc) {
-            opt.timeout_instructions = std::stoull(argv[++i]);
+        } else if (a == "--timeout-tstates" && i + 1 < argc) {
+            opt.timeout_tstates = std::stoull(argv[++i]);
+        } else if (a == "--count-instructions") {
+            opt.count_instructions = true;
+        } else if (a == "--checkpoint-tstates" && i + 1 < argc) {
+            opt.checkpoint_tstates = std::stoull(argv[++i]);
+        } else if (a == "--checkpoint-seconds" && i + 1 < argc) {
+            opt.checkpoint_seconds = std::stod(argv[++i]);
+        } else if (a == "--resume") {
+            opt.resume = true;
+        } else if (a == "--no-shard") {
+            opt.shard = false;
+        } else if (a == "--jobs" && i + 1 < argc) {
+            opt.jobs = static_cast<unsigned>(std::stoul(argv[++i]));
+        } else if (a == "--lockstep") {
+            opt.lockstep = true;
+        } else if (a == "--lockstep-interval" && i + 1 < argc) {
+            opt.lockstep = true;
+            opt.lockstep_options.interval = std::stoull(argv[++i]);
+        } else if (a == "--lockstep-sample" && i + 1 < argc) {
+            opt.lockstep = true;
+            opt.lockstep_options.sample = std::max<uint64_t>(1, std::stoull(argv[++i]));
         } else {
             std::cerr << "Unknown or incomplete argument: " << a << "\n";
             std::exit(static_cast<int>(Result::kHarnessError));
         }
     }
+    if (opt.lockstep && opt.count_instructions) {
+        std::cerr << "--lockstep and --count-instructions cannot be combined\n";
+        std::exit(static_cast<int>(Result::kHarnessError));
+    }
     return opt;
 }
 
@@ -153,25 +234,6 @@ std::string hex16(uint16_t v) {
     return os.str();
 }
 
-uint16_t pop_word(z80::CPU& cpu) {
-    const uint16_t sp = cpu.SP();
-    const uint16_t value = static_cast<uint16_t>(cpu.ReadMemory(sp) |
-                                                 (cpu.ReadMemory(sp + 1) << 8));
-    cpu.SP() = static_cast<uint16_t>(sp + 2);
-    return value;
-}
-
-std::string read_dollar_string(const z80::CPU& cpu, uint16_t addr, std::size_t limit = 4096) {
-    std::string out;
-    for (std::size_t i = 0; i < limit; ++i) {
-        const uint8_t ch = cpu.ReadMemory(static_cast<uint16_t>(addr + i));
-        if (ch == '$') return out;
-        out.push_back(static_cast<char>(ch));
-    }
-    out += "\n[HARNESS: unterminated BDOS 09 string]\n";
-    return out;
-}
-
 void append_printable(std::string& out, char ch) {
     if (ch == '\r') {
         out.push_back('\n');
@@ -185,100 +247,242 @@ struct RunReport {
     Result result = Result::kHarnessError;
     std::string reason;
     std::string output;
-    uint64_t instructions = 0;
+    uint64_t instructions = 0;   ///< Only with --count-instructions
     uint64_t tstates = 0;
     uint16_t pc = 0;
     uint16_t sp = 0;
+    uint64_t resumed_instructions = 0;   ///< Work done before --resume picked it up
+    uint64_t resumed_tstates = 0;
+    std::string checkpoint;              ///< What became of the checkpoint, if any
+    std::optional<z80::dbg::LockstepStats> lockstep;   ///< With --lockstep
+    std::string divergence;              ///< The lockstep report, if it diverged
 };
 
-RunReport run_cpm_com(const Case& c, const std::vector<uint8_t>& program) {
-    RunReport report;
-    z80::CPU cpu;
-    cpu.Reset();
-    cpu.LoadProgram(program, 0x0100);
-    cpu.PC() = 0x0100;
-    cpu.SP() = 0xF000;
-
-    bool terminated = false;
-    std::array<uint16_t, 16> recent_pc{};
-    std::size_t recent_i = 0;
-
-    while (report.instructions < c.timeout_instructions) {
-        if (cpu.PC() == 0x0000) {
-            terminated = true;
-            report.reason = "CP/M warm boot at 0000h";
-            break;
-        }
+/// "n of m blocks checked, k instructions", and the divergence if any.
+std::string lockstep_summary(const RunReport& r) {
+    if (!r.lockstep) return {};
+    const z80::dbg::LockstepStats& s = *r.lockstep;
+    std::string text = std::to_string(s.checked) + " of " + std::to_string(s.blocks) + " blocks checked, " +
+                       std::to_string(s.instructions) + " instructions";
+    if (s.unverifiable != 0) text += ", " + std::to_string(s.unverifiable) + " unverifiable";
+    if (!r.divergence.empty()) text += "\n" + r.divergence;
+    return text;
+}
 
-        if (cpu.PC() == 0x0005) {
-            const uint16_t ret = pop_word(cpu);
-            switch (cpu.C()) {
-            case 0x00:
-                terminated = true;
-                report.reason = "BDOS system reset";
-                break;
-            case 0x02:
-                append_printable(report.output, static_cast<char>(cpu.E()));
-                break;
-            case 0x09:
-                for (char ch : read_dollar_string(cpu, cpu.DE())) append_printable(report.output, ch);
-                break;
-            default:
-                report.result = Result::kHarnessError;
-                report.reason = "unsupported BDOS call C=" + hex16(cpu.C()).substr(2);
-                report.pc = cpu.PC();
-                report.sp = cpu.SP();
-                report.tstates = cpu.GetCycleCount();
-                return report;
-            }
-            cpu.PC() = ret;
-            if (terminated) break;
-            continue;
-        }
+/// Called by a running case every kProgressTStates T-states, with the work
+/// done since it started (or resumed).
+using ProgressFn = std::function<void(uint64_t instructions, uint64_t tstates)>;
+constexpr uint64_t kProgressTStates = uint64_t{1} << 30;
+
+using Clock = std::chrono::steady_clock;
+
+/// Continue from the job's checkpoint when there is a usable one; a missing,
+/// damaged or foreign checkpoint just means starting over. false only if a
+/// sound checkpoint does not restore to the state it was saved from.
+bool resume_from(z80::machine::cpm::CpmMachine& machine, const std::filesystem::path& file, uint64_t image,
+                 const Options& opt, RunReport& report) {
+    using z80::machine::cpm::CpmState;
+    if (!std::filesystem::exists(file)) {
+        report.checkpoint = "none to resume from; started from the beginning";
+        return true;
+    }
+    std::string why;
+    const auto checkpoint = z80::suite::read_checkpoint(file, &why);
+    if (checkpoint && checkpoint->state.tag != image) why = "made from a different image";
+    else if (checkpoint && checkpoint->counted != opt.count_instructions) why = "instruction counting differs";
+    if (!why.empty()) {
+        report.checkpoint = "ignored (" + why + "); started from the beginning";
+        return true;
+    }
 
-        recent_pc[recent_i++ % recent_pc.size()] = cpu.PC();
-        do { cpu.Step(); } while (!cpu.InstructionComplete());
-        ++report.instructions;
+    checkpoint->state.restore(machine);
+    if (CpmState::capture(machine).hash() != checkpoint->state_hash) {
+        report.reason = "checkpoint " + file.string() + " does not restore: state hash mismatch";
+        return false;
     }
+    report.instructions = report.resumed_instructions = checkpoint->instructions;
+    report.resumed_tstates = machine.cpu().GetCycleCount();
+    report.checkpoint = "resumed at " + std::to_string(report.resumed_tstates) + " T-states";
+    return true;
+}
 
-    report.pc = cpu.PC();
-    report.sp = cpu.SP();
-    report.tstates = cpu.GetCycleCount();
+RunReport run_cpm_com(const Case& c, const std::vector<uint8_t>& program, const std::filesystem::path& checkpoint,
+                      const Options& opt, const ProgressFn& progress) {
+    using z80::machine::cpm::CpmState;
+    using z80::machine::cpm::Stop;
+    RunReport report;
+    z80::machine::cpm::CpmMachine machine;
+    if (!machine.load_com(program)) {
+        report.reason = "image does not fit the CP/M TPA";
+        return report;
+    }
+    const uint64_t image = z80::suite::image_hash(program);
+    if (opt.resume) {
+        if (!resume_from(machine, checkpoint, image, opt, report)) return report;
+    } else {
+        std::error_code ec;
+        std::filesystem::remove(checkpoint, ec);   // stale: from an earlier run
+    }
 
-    if (!terminated && report.instructions >= c.timeout_instructions) {
-        std::ostringstream os;
-        os << "timeout at PC=" << hex16(report.pc) << ", recent PCs:";
-        for (uint16_t pc : recent_pc) os << " " << hex16(pc);
-        report.reason = os.str();
+    // Checkpoints are taken between instructions: a budget can stop the CPU
+    // between a prefix and its opcode, so finish that instruction first.
+    uint64_t saved_tstates = machine.cpu().GetCycleCount();
+    Clock::time_point saved_at = Clock::now();
+    const auto save = [&] {
+        auto& cpu = machine.cpu();
+        while (!cpu.InstructionComplete()) cpu.Step();
+        z80::suite::Checkpoint ck;
+        ck.state = CpmState::capture(machine);
+        ck.state.tag = image;
+        ck.state_hash = ck.state.hash();
+        ck.instructions = report.instructions;
+        ck.counted = opt.count_instructions;
+        if (!z80::suite::write_checkpoint(checkpoint, ck)) report.checkpoint = "could not write " + checkpoint.string();
+        saved_tstates = cpu.GetCycleCount();
+        saved_at = Clock::now();
+    };
+    const auto save_due = [&] {
+        return (opt.checkpoint_tstates != 0 && machine.cpu().GetCycleCount() - saved_tstates >= opt.checkpoint_tstates) ||
+               (opt.checkpoint_seconds > 0 &&
+                std::chrono::duration<double>(Clock::now() - saved_at).count() >= opt.checkpoint_seconds);
+    };
+
+    uint64_t* const counter = opt.count_instructions ? &report.instructions : nullptr;
+    std::optional<z80::dbg::LockstepChecker<z80::CPU>> lockstep;
+    if (opt.lockstep) lockstep.emplace(machine.cpu(), opt.lockstep_options);
+    Stop stop = Stop::kBudget;
+    while (machine.cpu().GetCycleCount() < c.timeout_tstates) {
+        uint64_t next = std::min(c.timeout_tstates, machine.cpu().GetCycleCount() + kProgressTStates);
+        if (opt.checkpoint_tstates != 0) next = std::min(next, saved_tstates + opt.checkpoint_tstates);
+        stop = lockstep ? machine.run_until_with(next, [&lockstep](uint64_t t) { return lockstep->Run(t); })
+                        : machine.run_until(next, counter);
+        if (stop != Stop::kBudget || (lockstep && lockstep->Diverged())) break;
+        if (progress)
+            progress(report.instructions - report.resumed_instructions,
+                     machine.cpu().GetCycleCount() - report.resumed_tstates);
+        if (opt.checkpoints() && save_due()) save();
+    }
+    // The final state too: resuming a finished job then stops at once, with
+    // the same result, and a timed-out one can resume with a larger budget.
+    if (opt.checkpoints()) save();
+
+    for (const char ch : machine.console()) append_printable(report.output, ch);
+    report.pc = machine.cpu().PC();
+    report.sp = machine.cpu().SP();
+    report.tstates = machine.cpu().GetCycleCount();
+
+    switch (stop) {
+    case Stop::kWarmBoot:
+    case Stop::kSystemReset:
+        // Ran to the end; judge() decides what the output means.
+        report.result = Result::kPass;
+        report.reason = machine.reason();
+        break;
+    case Stop::kBudget:
         report.result = Result::kFail;
-        return report;
+        report.reason = "timeout after " + std::to_string(report.tstates) + " T-states at PC=" + hex16(report.pc);
+        break;
+    case Stop::kHalted:
+        report.result = Result::kFail;
+        report.reason = "program stopped: " + machine.reason();
+        break;
+    case Stop::kUnsupported:
+        report.result = Result::kHarnessError;
+        report.reason = machine.reason();
+        break;
     }
 
+    if (lockstep) {
+        report.lockstep = lockstep->Stats();
+        if (const auto& d = lockstep->GetDivergence()) {
+            report.result = Result::kFail;
+            report.reason = d->located ? "lockstep divergence at PC=" + hex16(d->pc) + ": " + d->disassembly
+                                       : "lockstep divergence, not narrowed to one instruction";
+            report.divergence = d->Report();
+        }
+    }
+    return report;
+}
+
+/// Apply the case's output oracle to a run that ended normally.
+void judge(const Case& c, RunReport& report) {
+    if (report.result != Result::kPass) return;
     if (contains_any(report.output, c.reject_output)) {
         report.result = Result::kFail;
         report.reason = "reject token found in output";
-        return report;
-    }
-    if (!contains_all(report.output, c.expected_output)) {
+    } else if (!contains_all(report.output, c.expected_output)) {
         report.result = Result::kFail;
         report.reason = "expected output tokens not found";
-        return report;
     }
+}
 
-    report.result = Result::kPass;
-    report.reason = terminated ? report.reason : "expected output observed";
-    return report;
+const char* result_label(Result r) {
+    return r == Result::kPass ? "PASS" :
+           r == Result::kFail ? "FAIL" :
+           r == Result::kSkip ? "SKIP" : "HARNESS_ERROR";
+}
+
+std::string json_string(std::string_view s) {
+    std::string out = "\"";
+    for (const char ch : s) {
+        switch (ch) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(ch) < 0x20) {
+                char buf[8];
+                std::snprintf(buf, sizeof buf, "\\u%04x", static_cast<unsigned>(ch));
+                out += buf;
+            } else {
+                out += ch;
+            }
+        }
+    }
+    return out + '"';
 }
 
-std::string report_text(const Case& c, const std::filesystem::path& asset, const RunReport& r) {
+/// One ZEX test group of a sharded case.
+struct ShardRun {
+    std::string name;
+    uint64_t instructions = 0;
+    uint64_t tstates = 0;
+    double wall_seconds = 0;
+};
+
+/// One case, run: what it did and how long it took.
+struct CaseRun {
+    Case c;
+    std::filesystem::path asset;
+    RunReport report;
+    double wall_seconds = 0;
+    std::vector<ShardRun> shards;   ///< Empty unless the case ran sharded
+    bool counted = false;           ///< Instructions were counted (--count-instructions)
+
+    /// @brief Rate over this process's wall time, so work resumed from a
+    ///        checkpoint does not count.
+    [[nodiscard]] double per_second(uint64_t n) const { return wall_seconds > 0 ? n / wall_seconds : 0; }
+    [[nodiscard]] double tstates_per_second() const { return per_second(report.tstates - report.resumed_tstates); }
+    [[nodiscard]] double instructions_per_second() const {
+        return per_second(report.instructions - report.resumed_instructions);
+    }
+};
+
+std::string report_text(const CaseRun& run) {
+    const RunReport& r = run.report;
     std::ostringstream os;
-    os << "case: " << c.name << "\n"
-       << "adapter: " << c.adapter << "\n"
-       << "asset: " << asset.string() << "\n"
+    os << "case: " << run.c.name << "\n"
+       << "adapter: " << run.c.adapter << "\n"
+       << "asset: " << run.asset.string() << "\n"
        << "result: " << static_cast<int>(r.result) << "\n"
        << "reason: " << r.reason << "\n"
-       << "instructions: " << r.instructions << "\n"
+       << "instructions: " << (run.counted ? std::to_string(r.instructions) : "not counted") << "\n"
        << "tstates: " << r.tstates << "\n"
+       << "wall_seconds: " << run.wall_seconds << "\n"
+       << "shards: " << run.shards.size() << "\n"
+       << "checkpoint: " << (r.checkpoint.empty() ? "none" : r.checkpoint) << "\n"
+       << "lockstep: " << (r.lockstep ? lockstep_summary(r) : "off") << "\n"
        << "pc: " << hex16(r.pc) << "\n"
        << "sp: " << hex16(r.sp) << "\n"
        << "\n--- console ---\n"
@@ -286,6 +490,228 @@ std::string report_text(const Case& c, const std::filesystem::path& asset, const
     return os.str();
 }
 
+/// A JSON number, or null when instructions were not counted.
+template <class T>
+std::string counted(bool is_counted, T value) {
+    if (!is_counted) return "null";
+    std::ostringstream os;
+    os << std::setprecision(17) << value;
+    return os.str();
+}
+
+std::string report_json(const CaseRun& run) {
+    const RunReport& r = run.report;
+    std::ostringstream os;
+    os << std::setprecision(17)
+       << "{\"case\": " << json_string(run.c.name) << ", \"adapter\": " << json_string(run.c.adapter)
+       << ", \"asset\": " << json_string(run.asset.string()) << ",\n"
+       << " \"result\": " << json_string(result_label(r.result)) << ", \"exit_code\": " << static_cast<int>(r.result)
+       << ", \"reason\": " << json_string(r.reason) << ",\n"
+       << " \"instructions\": " << counted(run.counted, r.instructions) << ", \"tstates\": " << r.tstates
+       << ", \"wall_seconds\": " << run.wall_seconds << ",\n"
+       << " \"instructions_per_sec\": " << counted(run.counted, run.instructions_per_second())
+       << ", \"tstates_per_sec\": " << run.tstates_per_second() << ",\n"
+       << " \"resumed_tstates\": " << r.resumed_tstates << ", \"checkpoint\": " << json_string(r.checkpoint) << ",\n"
+       << " \"lockstep\": " << (r.lockstep ? json_string(lockstep_summary(r)) : "null") << ",\n"
+       << " \"pc\": " << json_string(hex16(r.pc)) << ", \"sp\": " << json_string(hex16(r.sp))
+       << ", \"shards\": [";
+    for (std::size_t i = 0; i < run.shards.size(); ++i) {
+        const ShardRun& s = run.shards[i];
+        os << (i ? ",\n  " : "\n  ") << "{\"name\": " << json_string(s.name)
+           << ", \"instructions\": " << counted(run.counted, s.instructions)
+           << ", \"tstates\": " << s.tstates << ", \"wall_seconds\": " << s.wall_seconds << "}";
+    }
+    os << "]}";
+    return os.str();
+}
+
+/// One CPU's worth of work: a whole case, or one test group of a sharded
+/// case (or its empty-table frame).
+struct Job {
+    std::size_t run = 0;   ///< Index of the CaseRun it belongs to
+    std::string label;     ///< Progress line prefix
+    std::string group;     ///< ZEX test group name; empty for a whole case or the frame
+    std::vector<uint8_t> image;
+    std::filesystem::path checkpoint;
+    RunReport report;
+    Clock::time_point start;
+    Clock::time_point end;
+};
+
+/// Where a case's jobs sit in the job list. A sharded case's first job is the
+/// frame, then one job per group in table order.
+struct CasePlan {
+    std::size_t first_job = 0;
+    std::size_t jobs = 0;
+    bool sharded = false;
+};
+
+/// Queue the jobs for one case: the whole image, or — when it is a
+/// ZEXDOC/ZEXALL-style exerciser and sharding is on — one copy per test group.
+/// Group checkpoints are numbered in table order (names are not file-safe).
+CasePlan plan_case(std::size_t run, const Case& c, const std::vector<uint8_t>& image, const Options& opt,
+                   std::vector<Job>& jobs) {
+    CasePlan plan{jobs.size(), 1, false};
+    const std::filesystem::path checkpoints = std::filesystem::path(opt.artifact_root) / "checkpoints";
+    const auto table = opt.shard && c.adapter == "cpm_com" ? z80::suite::find_zex_test_table(image) : std::nullopt;
+    if (!table || table->tests.size() < 2) {
+        jobs.push_back({run, c.name, {}, image, checkpoints / (c.name + ".ckpt"), {}, {}, {}});
+        return plan;
+    }
+
+    plan.sharded = true;
+    plan.jobs = 1 + table->tests.size();
+    jobs.push_back({run, c.name + " [frame]", {}, z80::suite::with_zex_tests(image, *table, {}),
+                    checkpoints / (c.name + ".frame.ckpt"), {}, {}, {}});
+    for (std::size_t i = 0; i < table->tests.size(); ++i) {
+        const uint16_t& test = table->tests[i];
+        std::string group = z80::suite::zex_test_name(image, test);
+        jobs.push_back({run, c.name + " [" + group + "]", std::move(group),
+                        z80::suite::with_zex_tests(image, *table, std::span(&test, 1)),
+                        checkpoints / (c.name + ".group" + std::to_string(i + 1) + ".ckpt"), {}, {}, {}});
+    }
+    return plan;
+}
+
+unsigned job_count(const Options& opt, std::size_t jobs) {
+    const unsigned n = opt.jobs != 0 ? opt.jobs : std::max(1u, std::thread::hardware_concurrency());
+    return static_cast<unsigned>(std::min<std::size_t>(n, jobs));
+}
+
+struct ProgressEvent {
+    uint32_t job = 0;
+    uint64_t instructions = 0;
+    uint64_t tstates = 0;
+    double seconds = 0;
+};
+
+/// Run @p jobs on up to opt.jobs worker threads, in order of the list. The
+/// calling thread prints progress until every job has finished.
+void run_jobs(std::vector<Job>& jobs, const std::vector<CaseRun>& runs, const Options& opt) {
+    z80::suite::ProgressQueue<ProgressEvent, 256> queue;
+    std::atomic<std::size_t> next{0};
+    std::atomic<std::size_t> finished{0};
+
+    const auto worker = [&] {
+        for (std::size_t i = next.fetch_add(1); i < jobs.size(); i = next.fetch_add(1)) {
+            Job& job = jobs[i];
+            job.start = Clock::now();
+            const ProgressFn progress = [&queue, &job, i](uint64_t instructions, uint64_t tstates) {
+                const double s = std::chrono::duration<double>(Clock::now() - job.start).count();
+                queue.try_push({static_cast<uint32_t>(i), instructions, tstates, s});
+            };
+            const Case& c = runs[job.run].c;
+            if (c.adapter == "cpm_com") {
+                job.report = run_cpm_com(c, job.image, job.checkpoint, opt, progress);
+            } else {
+                job.report.result = Result::kHarnessError;
+                job.report.reason = "unsupported adapter '" + c.adapter + "'";
+            }
+            job.end = Clock::now();
+            finished.fetch_add(1, std::memory_order_release);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned j = 0; j < job_count(opt, jobs.size()); ++j) workers.emplace_back(worker);
+
+    const auto drain = [&] {
+        while (const auto e = queue.try_pop()) {
+            std::cout << "  " << jobs[e->job].label << ": " << e->tstates << " T-states, " << std::fixed
+                      << std::setprecision(1) << e->tstates / e->seconds / 1e6 << " M T/s";
+            if (opt.count_instructions) std::cout << ", " << e->instructions / e->seconds / 1e6 << " M instr/s";
+            std::cout << "\n" << std::defaultfloat << std::flush;
+        }
+    };
+    while (finished.load(std::memory_order_acquire) < jobs.size()) {
+        drain();
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    for (std::thread& t : workers) t.join();
+    drain();
+    if (queue.dropped() != 0) std::cout << "  (" << queue.dropped() << " progress events dropped)\n";
+}
+
+/// Fold a case's finished jobs into its report and judge it. Sharded: every
+/// group must have run to the end, and their consoles are spliced into the
+/// frame in table order, so the oracle sees one sequential run's output.
+void finish_case(CaseRun& run, const CasePlan& plan, const std::vector<Job>& jobs) {
+    const auto first = jobs.begin() + static_cast<std::ptrdiff_t>(plan.first_job);
+    const auto last = first + static_cast<std::ptrdiff_t>(plan.jobs);
+    Clock::time_point start = first->start;
+    Clock::time_point end = first->end;
+    for (auto job = first; job != last; ++job) {
+        start = std::min(start, job->start);
+        end = std::max(end, job->end);
+    }
+    run.wall_seconds = std::chrono::duration<double>(end - start).count();
+
+    if (!plan.sharded) {
+        run.report = first->report;
+        judge(run.c, run.report);
+        return;
+    }
+
+    RunReport& merged = run.report;
+    const Job* failed = nullptr;
+    std::vector<std::string> consoles;
+    std::size_t resumed = 0;
+    for (auto job = first; job != last; ++job) {
+        merged.instructions += job->report.instructions;
+        merged.tstates += job->report.tstates;
+        merged.resumed_instructions += job->report.resumed_instructions;
+        merged.resumed_tstates += job->report.resumed_tstates;
+        if (job->report.resumed_tstates != 0) ++resumed;
+        merged.pc = job->report.pc;
+        if (const auto& s = job->report.lockstep) {
+            if (!merged.lockstep) merged.lockstep.emplace();
+            merged.lockstep->blocks += s->blocks;
+            merged.lockstep->checked += s->checked;
+            merged.lockstep->instructions += s->instructions;
+            merged.lockstep->unverifiable += s->unverifiable;
+        }
+        merged.sp = job->report.sp;
+        if (job != first) {
+            consoles.push_back(job->report.output);
+            run.shards.push_back({job->group, job->report.instructions, job->report.tstates,
+                                  std::chrono::duration<double>(job->end - job->start).count()});
+        }
+        if (!failed && job->report.result != Result::kPass) failed = &*job;
+    }
+    if (resumed != 0)
+        merged.checkpoint = std::to_string(resumed) + " of " + std::to_string(plan.jobs) + " jobs resumed";
+    if (failed) {
+        merged.result = failed->report.result;
+        merged.reason = failed->label + ": " + failed->report.reason;
+        merged.output = failed->report.output;
+        merged.divergence = failed->report.divergence;
+        return;
+    }
+
+    const auto console = z80::suite::merge_zex_output(first->report.output, consoles);
+    if (!console) {
+        merged.result = Result::kHarnessError;
+        merged.reason = "group output does not fit the exerciser's banner and closing message";
+        return;
+    }
+    merged.output = *console;
+    merged.result = Result::kPass;
+    merged.reason = "all " + std::to_string(run.shards.size()) + " groups ran to completion";
+    judge(run.c, merged);
+}
+
+/// The exit code for several cases: any harness error, else any failure, else
+/// pass — unless every case was skipped.
+Result combined_result(const std::vector<CaseRun>& runs) {
+    const auto any = [&](Result r) {
+        return std::any_of(runs.begin(), runs.end(), [r](const CaseRun& run) { return run.report.result == r; });
+    };
+    if (any(Result::kHarnessError)) return Result::kHarnessError;
+    if (any(Result::kFail)) return Result::kFail;
+    if (any(Result::kPass)) return Result::kPass;
+    return Result::kSkip;
+}
+
 } // namespace
 
 int main(int argc, char** argv) {
@@ -299,43 +725,82 @@ int main(int argc, char** argv) {
         return static_cast<int>(Result::kPass);
     }
 
-    const auto it = std::find_if(all_cases.begin(), all_cases.end(),
-                                 [&](const Case& c) { return c.name == opt.case_name; });
-    if (it == all_cases.end()) {
-        std::cerr << "HARNESS_ERROR: unknown case '" << opt.case_name << "'\n";
-        return static_cast<int>(Result::kHarnessError);
+    std::vector<Case> selected;
+    if (opt.case_name == "all") {
+        selected = all_cases;
+    } else {
+        const auto it = std::find_if(all_cases.begin(), all_cases.end(),
+                                     [&](const Case& c) { return c.name == opt.case_name; });
+        if (it == all_cases.end()) {
+            std::cerr << "HARNESS_ERROR: unknown case '" << opt.case_name << "'\n";
+            return static_cast<int>(Result::kHarnessError);
+        }
+        selected.push_back(*it);
+    }
+    for (Case& c : selected) {
+        if (opt.timeout_tstates != 0) c.timeout_tstates = opt.timeout_tstates;
     }
-    Case c = *it;
-    if (opt.timeout_instructions != 0) c.timeout_instructions = opt.timeout_instructions;
 
     if (opt.assets_root.empty()) {
         std::cout << "SKIP: Z80_COMPAT_ASSETS is not set and --assets was not provided\n";
         return static_cast<int>(Result::kSkip);
     }
 
-    const std::filesystem::path asset_path = std::filesystem::path(opt.assets_root) / c.asset;
-    const std::vector<uint8_t> image = read_file(asset_path);
-    if (image.empty()) {
-        std::cout << "SKIP: asset not found or empty: " << asset_path << "\n";
-        return static_cast<int>(Result::kSkip);
+    std::vector<CaseRun> runs;
+    std::vector<CasePlan> plans;
+    std::vector<Job> jobs;
+    for (const Case& c : selected) {
+        CaseRun& run = runs.emplace_back(
+            CaseRun{c, std::filesystem::path(opt.assets_root) / c.asset, {}, 0, {}, opt.count_instructions});
+        const std::vector<uint8_t> image = read_file(run.asset);
+        if (image.empty()) {
+            run.report.result = Result::kSkip;
+            run.report.reason = "asset not found or empty: " + run.asset.string();
+            plans.push_back({jobs.size(), 0, false});
+            continue;
+        }
+        plans.push_back(plan_case(runs.size() - 1, c, image, opt, jobs));
+        if (plans.back().sharded)
+            std::cout << c.name << ": " << plans.back().jobs - 1 << " test groups, one job each\n";
     }
 
-    RunReport report;
-    if (c.adapter == "cpm_com") {
-        report = run_cpm_com(c, image);
-    } else {
-        std::cerr << "HARNESS_ERROR: unsupported adapter '" << c.adapter << "'\n";
-        return static_cast<int>(Result::kHarnessError);
+    const auto start = Clock::now();
+    run_jobs(jobs, runs, opt);
+    const double wall_seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    for (std::size_t i = 0; i < runs.size(); ++i) {
+        if (plans[i].jobs != 0) finish_case(runs[i], plans[i], jobs);
     }
 
-    const std::filesystem::path report_path =
-        std::filesystem::path(opt.artifact_root) / (c.name + ".log");
-    write_text_file(report_path, report_text(c, asset_path, report));
+    const std::filesystem::path artifacts(opt.artifact_root);
+    for (const CaseRun& run : runs) {
+        const RunReport& r = run.report;
+        std::cout << result_label(r.result) << ": " << run.c.name << " - " << r.reason << "\n";
+        if (r.result == Result::kSkip) continue;
+
+        const std::filesystem::path log_path = artifacts / (run.c.name + ".log");
+        write_text_file(log_path, report_text(run));
+        write_text_file(artifacts / (run.c.name + ".json"), report_json(run) + "\n");
+        std::cout << "  " << r.tstates << " T-states in " << std::fixed << std::setprecision(2) << run.wall_seconds
+                  << " s (" << std::setprecision(1) << run.tstates_per_second() / 1e6 << " M T/s";
+        if (run.counted)
+            std::cout << "; " << r.instructions << " instructions, " << run.instructions_per_second() / 1e6
+                      << " M instr/s";
+        if (!r.checkpoint.empty()) std::cout << "; checkpoint: " << r.checkpoint;
+        std::cout << ")\n" << std::defaultfloat << "  log: " << log_path << "\n";
+    }
 
-    const char* label = report.result == Result::kPass ? "PASS" :
-                        report.result == Result::kFail ? "FAIL" :
-                        report.result == Result::kSkip ? "SKIP" : "HARNESS_ERROR";
-    std::cout << label << ": " << c.name << " - " << report.reason << "\n"
-              << "  log: " << report_path << "\n";
-    return static_cast<int>(report.result);
+    const Result result = combined_result(runs);
+    if (opt.case_name == "all") {
+        std::ostringstream os;
+        os << "{\"jobs\": " << job_count(opt, jobs.size())
+           << ", \"wall_seconds\": " << std::setprecision(17) << wall_seconds
+           << ", \"result\": " << json_string(result_label(result)) << ",\n \"cases\": [";
+        for (std::size_t i = 0; i < runs.size(); ++i) os << (i ? ",\n  " : "\n  ") << report_json(runs[i]);
+        os << "]}\n";
+        write_text_file(artifacts / "all.json", os.str());
+        std::cout << result_label(result) << ": all " << runs.size() << " cases in " << std::fixed
+                  << std::setprecision(2) << wall_seconds << " s\n"
+                  << "  summary: " << artifacts / "all.json" << "\n";
+    }
+    return static_cast<int>(result);
 }
@@ -0,0 +1,88 @@
+//
+// Z80 Digital Twin - lock-free progress queue for the suite runner
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// A bounded multi-producer / single-consumer queue. Worker threads push
+// progress events while they run cases; the main thread pops and prints them.
+// No locks: each slot carries a sequence number, producers claim a slot with
+// one compare-exchange on the tail and publish it with a release store, and
+// the consumer owns the head. (This is D. Vyukov's bounded queue, reduced to
+// one consumer.)
+//
+// Progress is advisory, so a full queue drops the event instead of blocking
+// the worker — a CPU case must never wait on the console. dropped() counts
+// what was lost.
+//
+
+#ifndef Z80_TOOLS_PROGRESS_QUEUE_H
+#define Z80_TOOLS_PROGRESS_QUEUE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace z80::suite {
+
+template <class T, std::size_t Capacity>
+class ProgressQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    ProgressQueue() {
+        for (std::size_t i = 0; i < Capacity; ++i) slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    ProgressQueue(const ProgressQueue&) = delete;
+    ProgressQueue& operator=(const ProgressQueue&) = delete;
+
+    /// @brief Any thread. Returns false (and counts a drop) when full.
+    bool try_push(const T& value) {
+        std::size_t pos = tail_.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = slots_[pos & (Capacity - 1)];
+            const std::size_t seq = slot.sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    slot.value = value;
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// @brief The consumer thread only.
+    std::optional<T> try_pop() {
+        Slot& slot = slots_[head_ & (Capacity - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != head_ + 1) return std::nullopt;
+        T value = slot.value;
+        slot.sequence.store(head_ + Capacity, std::memory_order_release);
+        ++head_;
+        return value;
+    }
+
+    [[nodiscard]] uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot {
+        std::atomic<std::size_t> sequence{0};
+        T value{};
+    };
+
+    std::array<Slot, Capacity> slots_;
+    alignas(64) std::atomic<std::size_t> tail_{0};
+    alignas(64) std::size_t head_ = 0;
+    std::atomic<uint64_t> dropped_{0};
+};
+
+} // namespace z80::suite
+
+#endif // Z80_TOOLS_PROGRESS_QUEUE_H
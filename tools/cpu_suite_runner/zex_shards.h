@@ -0,0 +1,155 @@
+//
+// Z80 Digital Twin - ZEXDOC/ZEXALL test-table sharding
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// The exercisers run a table of independent test groups. Their main loop is
+//
+//         ld   hl,tests        ; 21 lo hi
+//   loop: ld   a,(hl)          ; 7E
+//         inc  hl              ; 23
+//         or   (hl)            ; B6
+//         jp   z,done          ; CA ...
+//
+// over a zero-terminated list of descriptor addresses. Each descriptor ends
+// in its '$'-terminated name at offset 65 (flag mask, three 20-byte machine
+// states, 4-byte CRC). Finding that loop gives the table; rewriting the table
+// with a subset of the addresses gives a copy of the exerciser that runs only
+// those groups, unchanged otherwise.
+//
+// A sharded run executes one such copy per group, plus one with an empty
+// table, which prints only the banner and the closing message (the frame).
+// Every group's output is the frame with the group's lines in between, so
+// the lines are cut out and spliced back in table order: the merged console
+// is what one sequential run prints.
+//
+
+#ifndef Z80_TOOLS_ZEX_SHARDS_H
+#define Z80_TOOLS_ZEX_SHARDS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace z80::suite {
+
+/// CP/M loads a .COM image here; image offset = address - kCpmLoadAddress.
+inline constexpr uint16_t kCpmLoadAddress = 0x0100;
+
+struct ZexTestTable {
+    uint16_t address = 0;          ///< Where the descriptor addresses start
+    std::vector<uint16_t> tests;   ///< Descriptor addresses, in run order
+};
+
+namespace detail {
+
+inline constexpr std::size_t kZexNameOffset = 65;
+inline constexpr std::size_t kZexNameMax = 40;
+
+inline std::optional<std::size_t> image_offset(std::span<const uint8_t> image, uint32_t address, std::size_t bytes) {
+    if (address < kCpmLoadAddress) return std::nullopt;
+    const std::size_t offset = address - kCpmLoadAddress;
+    if (offset + bytes > image.size()) return std::nullopt;
+    return offset;
+}
+
+inline uint16_t word_at(std::span<const uint8_t> image, std::size_t offset) {
+    return static_cast<uint16_t>(image[offset] | (image[offset + 1] << 8));
+}
+
+inline std::size_t common_prefix(std::string_view a, std::string_view b) {
+    return static_cast<std::size_t>(std::mismatch(a.begin(), a.end(), b.begin(), b.end()).first - a.begin());
+}
+
+inline std::size_t common_suffix(std::string_view a, std::string_view b) {
+    return static_cast<std::size_t>(std::mismatch(a.rbegin(), a.rend(), b.rbegin(), b.rend()).first - a.rbegin());
+}
+
+} // namespace detail
+
+/// @brief A descriptor's name, without the dot padding; empty if unreadable.
+inline std::string zex_test_name(std::span<const uint8_t> image, uint16_t descriptor) {
+    const auto offset = detail::image_offset(image, uint32_t{descriptor} + detail::kZexNameOffset, 1);
+    if (!offset) return {};
+    std::string name;
+    for (std::size_t i = *offset; i < image.size() && i < *offset + detail::kZexNameMax; ++i) {
+        const char ch = static_cast<char>(image[i]);
+        if (ch == '$') {
+            while (!name.empty() && name.back() == '.') name.pop_back();
+            return name;
+        }
+        if (ch < 0x20 || ch > 0x7E) return {};
+        name.push_back(ch);
+    }
+    return {};
+}
+
+/// @brief Locate the test table of a ZEXDOC/ZEXALL-style image. Every entry
+///        must point at a descriptor with a readable name, or nullopt.
+inline std::optional<ZexTestTable> find_zex_test_table(std::span<const uint8_t> image) {
+    constexpr uint8_t kLoop[] = {0x7E, 0x23, 0xB6, 0xCA};
+    for (std::size_t i = 0; i + 3 + sizeof kLoop <= image.size(); ++i) {
+        if (image[i] != 0x21 || !std::equal(std::begin(kLoop), std::end(kLoop), image.begin() + i + 3)) continue;
+
+        ZexTestTable table;
+        table.address = detail::word_at(image, i + 1);
+        for (uint32_t entry = table.address;; entry += 2) {
+            const auto offset = detail::image_offset(image, entry, 2);
+            if (!offset) return std::nullopt;
+            const uint16_t test = detail::word_at(image, *offset);
+            if (test == 0) break;
+            if (zex_test_name(image, test).empty()) return std::nullopt;
+            table.tests.push_back(test);
+        }
+        return table;
+    }
+    return std::nullopt;
+}
+
+/// @brief A copy of @p image whose table runs only @p tests (at most as many
+///        as the original table holds).
+inline std::vector<uint8_t> with_zex_tests(std::span<const uint8_t> image, const ZexTestTable& table,
+                                           std::span<const uint16_t> tests) {
+    std::vector<uint8_t> out(image.begin(), image.end());
+    std::size_t offset = table.address - kCpmLoadAddress;
+    for (const uint16_t test : tests) {
+        out[offset++] = static_cast<uint8_t>(test);
+        out[offset++] = static_cast<uint8_t>(test >> 8);
+    }
+    out[offset++] = 0;
+    out[offset] = 0;
+    return out;
+}
+
+/// @brief Splice group outputs into one console. @p frame is the output of
+///        the empty-table run; each of @p shards is frame-with-lines-inside.
+///        nullopt if some shard does not fit the frame.
+inline std::optional<std::string> merge_zex_output(std::string_view frame, std::span<const std::string> shards) {
+    // Where the banner ends and the closing message starts is not marked, so
+    // find the split points every shard agrees with and take the last one.
+    std::size_t low = 0;
+    std::size_t high = frame.size();
+    for (const std::string& shard : shards) {
+        if (shard.size() < frame.size()) return std::nullopt;
+        const std::size_t suffix = std::min(detail::common_suffix(shard, frame), frame.size());
+        low = std::max(low, frame.size() - suffix);
+        high = std::min(high, detail::common_prefix(shard, frame));
+    }
+    if (low > high) return std::nullopt;
+
+    const std::size_t split = high;
+    const std::size_t tail = frame.size() - split;
+    std::string merged(frame.substr(0, split));
+    for (const std::string& shard : shards) merged += shard.substr(split, shard.size() - split - tail);
+    merged += frame.substr(split);
+    return merged;
+}
+
+} // namespace z80::suite
+
+#endif // Z80_TOOLS_ZEX_SHARDS_H
@@ -0,0 +1,381 @@
+//
+// Z80 Digital Twin - dynamic instruction mix report
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// Runs workloads on an instrumented CPU (InstrumentedCpuTraits) and prints
+// what actually executed: share of each opcode table, prefix-chain lengths,
+// and the hottest opcodes by count or by T-states. The numbers are for
+// choosing fast paths — a block cache or superinstructions pay off only for
+// what the workloads really spend their time on.
+//
+//   gcd       the cascading GCD of examples/gcd_stress_test.cpp
+//   zexdoc    CP/M exercisers from $Z80_COMPAT_ASSETS (cpu/zexdoc.com,
+//   zexall    cpu/zexall.com); the first --limit instructions
+//   spectrum  the 48K ROM ($Z80_SPEC48_ROM or spec48.rom) booting and then
+//             idling in its keyboard scan, --frames frames
+//
+//   instruction_mix                          # every workload whose assets exist
+//   instruction_mix gcd spectrum --top 40
+//   instruction_mix zexall --limit 0 --csv zexall.csv   # the whole run
+//
+// Exit codes: 0 success, 1 a named workload could not run, 2 bad usage.
+//
+
+#include "z80_cpu.h"
+#include "disassembler.h"
+#include "spectrum/spectrum_machine.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <regex>
+#include <string>
+#include <vector>
+
+namespace {
+
+using z80::InstructionMix;
+using z80::OpcodeTable;
+
+struct Options {
+    std::vector<std::string> workloads;
+    std::string assets_root;
+    std::string rom;
+    std::string csv;
+    uint64_t limit = 100'000'000;
+    uint32_t frames = 250;
+    uint16_t gcd_start = 2000;
+    std::size_t top = 25;
+    bool by_tstates = false;
+};
+
+void usage(const char* prog) {
+    std::cout
+        << "Dynamic instruction mix report\n\n"
+        << "Usage:\n"
+        << "  " << prog << " [options] [gcd|zexdoc|zexall|spectrum]...\n\n"
+        << "With no workload named, runs each one whose assets are present.\n\n"
+        << "Options:\n"
+        << "  --top N         hottest opcodes to list (default 25)\n"
+        << "  --by-tstates    rank opcodes by T-states instead of executions\n"
+        << "  --csv FILE      every executed opcode of every workload as CSV\n"
+        << "  --gcd N         cascading GCD from N down (default 2000)\n"
+        << "  --limit N       ZEX instructions to run, 0 = to completion (default 100000000)\n"
+        << "  --frames N      Spectrum frames to run (default 250)\n"
+        << "  --assets DIR    root for cpu/zexdoc.com etc. (default $Z80_COMPAT_ASSETS)\n"
+        << "  --rom FILE      48K ROM (default $Z80_SPEC48_ROM, then spec48.rom)\n\n"
+        << "Exit codes: 0 success, 1 a named workload could not run, 2 bad usage\n";
+}
+
+Options parse_args(int argc, char** argv) {
+    Options opt;
+    if (const char* env = std::getenv("Z80_COMPAT_ASSETS")) opt.assets_root = env;
+    for (int i = 1; i < argc; ++i) {
+        const std::string a = argv[i];
+        if (a == "-h" || a == "--help") {
+            usage(argv[0]);
+            std::exit(0);
+        } else if (a == "--top" && i + 1 < argc) {
+            opt.top = std::stoul(argv[++i]);
+        } else if (a == "--by-tstates") {
+            opt.by_tstates = true;
+        } else if (a == "--csv" && i + 1 < argc) {
+            opt.csv = argv[++i];
+        } else if (a == "--gcd" && i + 1 < argc) {
+            opt.gcd_start = static_cast<uint16_t>(std::clamp(std::stoul(argv[++i]), 2ul, 65535ul));
+        } else if (a == "--limit" && i + 1 < argc) {
+            opt.limit = std::stoull(argv[++i]);
+        } else if (a == "--frames" && i + 1 < argc) {
+            opt.frames = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (a == "--assets" && i + 1 < argc) {
+            opt.assets_root = argv[++i];
+        } else if (a == "--rom" && i + 1 < argc) {
+            opt.rom = argv[++i];
+        } else if (a == "gcd" || a == "zexdoc" || a == "zexall" || a == "spectrum") {
+            opt.workloads.push_back(a);
+        } else {
+            std::cerr << "Unknown or incomplete argument: " << a << "\n";
+            std::exit(2);
+        }
+    }
+    return opt;
+}
+
+std::vector<uint8_t> read_file(const std::filesystem::path& path) {
+    std::ifstream f(path, std::ios::binary);
+    if (!f) return {};
+    return std::vector<uint8_t>((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+}
+
+// -- Workloads ----------------------------------------------------------------
+
+/// A finished run: its mix, or why it could not run.
+struct Run {
+    std::string name;
+    std::string detail;
+    InstructionMix mix;
+    std::string skipped;
+};
+
+/// GCD(n, n-1) + GCD(n-1, n-2) + ... + GCD(2, 1) by repeated subtraction, the
+/// program gcd_stress_test times: a CALL per pair, PUSH/POP around a tight
+/// SBC HL,DE / JR loop.
+std::vector<uint8_t> gcd_program(uint16_t n) {
+    const uint16_t m = static_cast<uint16_t>(n - 1);
+    return {
+        0x01, static_cast<uint8_t>(n), static_cast<uint8_t>(n >> 8),   // LD BC,n
+        0x11, static_cast<uint8_t>(m), static_cast<uint8_t>(m >> 8),   // LD DE,n-1
+        0x60, 0x69,                                                    // outer: LD H,B / LD L,C
+        0xCD, 0x1F, 0x00,                                              // CALL gcd
+        0x2A, 0x00, 0x80, 0x09, 0x22, 0x00, 0x80,                      // (8000h) += BC
+        0x0B, 0x1B, 0x7A, 0xB3, 0x20, 0xEE,                            // DEC BC / DEC DE / until DE = 0
+        0x76,                                                          // HALT
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0xF5, 0xC5, 0xD5, 0xE5,                                        // gcd: PUSH AF,BC,DE,HL
+        0x7A, 0xB3, 0x28, 0x09,                                        // loop: DE = 0 -> done
+        0xB7, 0xED, 0x52, 0x30, 0x02,                                  // OR A / SBC HL,DE / JR NC
+        0x19, 0xEB,                                                    // ADD HL,DE / EX DE,HL
+        0x18, 0xF3,                                                    // JR loop
+        0x44, 0x4D, 0xE1, 0xD1, 0xC1, 0xF1, 0x60, 0x69, 0xC9,          // done: result in HL
+    };
+}
+
+Run run_gcd(const Options& opt) {
+    Run run{"gcd", "cascading GCD from " + std::to_string(opt.gcd_start), {}, {}};
+    z80::InstrumentedCpu cpu;
+    cpu.LoadProgram(gcd_program(opt.gcd_start), 0x0000);
+    while (!cpu.IsHalted()) cpu.Step();
+    run.mix = cpu.Mix();
+    return run;
+}
+
+/// The CP/M .COM adapter of cpu_suite_runner, reduced to what an exerciser
+/// needs: BDOS 2 and 9 print (discarded here), BDOS 0 or a jump to 0 ends.
+Run run_zex(const Options& opt, const std::string& name) {
+    Run run{name, "", {}, {}};
+    if (opt.assets_root.empty()) {
+        run.skipped = "Z80_COMPAT_ASSETS is not set and --assets was not given";
+        return run;
+    }
+    const std::filesystem::path path = std::filesystem::path(opt.assets_root) / "cpu" / (name + ".com");
+    const std::vector<uint8_t> program = read_file(path);
+    if (program.empty()) {
+        run.skipped = "cannot read " + path.string();
+        return run;
+    }
+
+    z80::InstrumentedCpu cpu;
+    cpu.LoadProgram(program, 0x0100);
+    cpu.PC() = 0x0100;
+    cpu.SP() = 0xF000;
+    bool finished = false;
+    for (uint64_t n = 0; opt.limit == 0 || n < opt.limit; ++n) {
+        if (cpu.PC() == 0x0000) {
+            finished = true;
+            break;
+        }
+        if (cpu.PC() == 0x0005) {
+            if (cpu.C() == 0x00) {
+                finished = true;
+                break;
+            }
+            const uint16_t ret = static_cast<uint16_t>(cpu.ReadMemory(cpu.SP()) |
+                                                       (cpu.ReadMemory(static_cast<uint16_t>(cpu.SP() + 1)) << 8));
+            cpu.SP() = static_cast<uint16_t>(cpu.SP() + 2);
+            cpu.PC() = ret;
+            continue;
+        }
+        do { cpu.Step(); } while (!cpu.InstructionComplete());
+    }
+    run.detail = finished ? "complete run" : "first " + std::to_string(opt.limit) + " instructions";
+    run.mix = cpu.Mix();
+    return run;
+}
+
+Run run_spectrum(const Options& opt) {
+    Run run{"spectrum", std::to_string(opt.frames) + " frames from power-on", {}, {}};
+    std::vector<std::string> paths;
+    if (!opt.rom.empty()) paths.push_back(opt.rom);
+    if (const char* env = std::getenv("Z80_SPEC48_ROM")) paths.emplace_back(env);
+    paths.insert(paths.end(), {"spec48.rom", "../spec48.rom", "../../spec48.rom"});
+    std::vector<uint8_t> rom;
+    for (const std::string& p : paths) {
+        rom = read_file(p);
+        if (!rom.empty()) break;
+    }
+    if (rom.empty()) {
+        run.skipped = "no 48K ROM (--rom, $Z80_SPEC48_ROM or ./spec48.rom)";
+        return run;
+    }
+
+    z80::machine::spectrum::InstrumentedSpectrumMachine machine;
+    if (!machine.load_rom(rom)) {
+        run.skipped = "ROM image is larger than 16 KB";
+        return run;
+    }
+    for (uint32_t f = 0; f < opt.frames; ++f) machine.run_frame();
+    run.mix = machine.cpu().Mix();
+    return run;
+}
+
+// -- Report -------------------------------------------------------------------
+
+/// The opcode as an assembler template: "LD A, (IX+d)", "JP NZ, nn".
+std::string opcode_name(OpcodeTable table, uint8_t opcode) {
+    std::array<uint8_t, 4> bytes{};
+    switch (table) {
+    case OpcodeTable::Base: bytes = {opcode, 0, 0, 0}; break;
+    case OpcodeTable::CB:   bytes = {0xCB, opcode, 0, 0}; break;
+    case OpcodeTable::DD:   bytes = {0xDD, opcode, 0, 0}; break;
+    case OpcodeTable::ED:   bytes = {0xED, opcode, 0, 0}; break;
+    case OpcodeTable::FD:   bytes = {0xFD, opcode, 0, 0}; break;
+    case OpcodeTable::DDCB: bytes = {0xDD, 0xCB, 0, opcode}; break;
+    case OpcodeTable::FDCB: bytes = {0xFD, 0xCB, 0, opcode}; break;
+    }
+    const z80::dbg::Instruction ins = z80::dbg::Disassembler{}.Decode(
+        [&bytes](uint16_t addr) { return addr < bytes.size() ? bytes[addr] : uint8_t{0}; }, 0);
+    if (ins.mnemonic == "RST") return ins.text;
+    static const std::regex kDisp(R"([+-]0x[0-9A-F]{2}\))");
+    static const std::regex kWord("0x[0-9A-F]{4}");
+    static const std::regex kByte("0x[0-9A-F]{2}");
+    std::string text = std::regex_replace(ins.text, kDisp, "+d)");
+    text = std::regex_replace(text, kWord, "nn");
+    return std::regex_replace(text, kByte, "n");
+}
+
+std::string opcode_bytes(OpcodeTable table, uint8_t opcode) {
+    char buf[16];
+    switch (table) {
+    case OpcodeTable::Base: std::snprintf(buf, sizeof buf, "%02X", opcode); break;
+    case OpcodeTable::DDCB: std::snprintf(buf, sizeof buf, "DD CB d %02X", opcode); break;
+    case OpcodeTable::FDCB: std::snprintf(buf, sizeof buf, "FD CB d %02X", opcode); break;
+    default: std::snprintf(buf, sizeof buf, "%s %02X", z80::OpcodeTableName(table), opcode); break;
+    }
+    return buf;
+}
+
+double pct(uint64_t part, uint64_t whole) {
+    return whole ? 100.0 * static_cast<double>(part) / static_cast<double>(whole) : 0.0;
+}
+
+void print_report(const Run& run, const Options& opt) {
+    const InstructionMix& mix = run.mix;
+    const uint64_t instructions = mix.Instructions();
+    const uint64_t tstates = mix.TStates();
+    std::printf("\n== %s (%s) ==\n", run.name.c_str(), run.detail.c_str());
+    std::printf("%llu instructions, %llu T-states (%.2f T/instruction), %llu interrupt(s)\n",
+                static_cast<unsigned long long>(instructions), static_cast<unsigned long long>(tstates),
+                instructions ? static_cast<double>(tstates) / static_cast<double>(instructions) : 0.0,
+                static_cast<unsigned long long>(mix.interrupts));
+
+    std::printf("\n  %-6s %14s %7s %16s %7s %8s\n", "table", "executions", "%", "T-states", "%", "opcodes");
+    for (std::size_t t = 0; t < z80::kOpcodeTables; ++t) {
+        uint64_t n = 0, ts = 0;
+        int distinct = 0;
+        for (std::size_t op = 0; op < 256; ++op) {
+            n += mix.count[t][op];
+            ts += mix.tstates[t][op];
+            distinct += mix.count[t][op] != 0;
+        }
+        std::printf("  %-6s %14llu %6.2f%% %16llu %6.2f%% %8d\n", z80::OpcodeTableName(static_cast<OpcodeTable>(t)),
+                    static_cast<unsigned long long>(n), pct(n, instructions), static_cast<unsigned long long>(ts),
+                    pct(ts, tstates), distinct);
+    }
+
+    std::printf("\n  prefix bytes per instruction:");
+    for (std::size_t i = 0; i < InstructionMix::kChainBuckets; ++i)
+        std::printf("  %zu%s: %.2f%%", i, i + 1 == InstructionMix::kChainBuckets ? "+" : "",
+                    pct(mix.chain[i], instructions));
+    std::printf("\n  redundant DD/FD prefixes: %llu\n", static_cast<unsigned long long>(mix.redundant_prefixes));
+
+    struct Row {
+        OpcodeTable table;
+        uint8_t opcode;
+        uint64_t count;
+        uint64_t tstates;
+    };
+    std::vector<Row> rows;
+    for (std::size_t t = 0; t < z80::kOpcodeTables; ++t)
+        for (std::size_t op = 0; op < 256; ++op)
+            if (mix.count[t][op])
+                rows.push_back({static_cast<OpcodeTable>(t), static_cast<uint8_t>(op), mix.count[t][op],
+                                mix.tstates[t][op]});
+    std::sort(rows.begin(), rows.end(), [&opt](const Row& a, const Row& b) {
+        return opt.by_tstates ? a.tstates > b.tstates : a.count > b.count;
+    });
+
+    std::printf("\n  top %zu of %zu opcodes by %s:\n", std::min(opt.top, rows.size()), rows.size(),
+                opt.by_tstates ? "T-states" : "executions");
+    std::printf("  %4s  %-12s %-20s %14s %7s %7s %6s %7s\n", "#", "bytes", "instruction", "executions", "%",
+                "cum %", "T", "T %");
+    double cumulative = 0;
+    for (std::size_t i = 0; i < rows.size() && i < opt.top; ++i) {
+        const Row& r = rows[i];
+        const double share = opt.by_tstates ? pct(r.tstates, tstates) : pct(r.count, instructions);
+        cumulative += share;
+        std::printf("  %4zu  %-12s %-20s %14llu %6.2f%% %6.2f%% %6.2f %6.2f%%\n", i + 1,
+                    opcode_bytes(r.table, r.opcode).c_str(), opcode_name(r.table, r.opcode).c_str(),
+                    static_cast<unsigned long long>(r.count), pct(r.count, instructions), cumulative,
+                    static_cast<double>(r.tstates) / static_cast<double>(r.count), pct(r.tstates, tstates));
+    }
+}
+
+bool write_csv(const std::string& path, const std::vector<Run>& runs) {
+    std::ofstream out(path);
+    if (!out) return false;
+    out << "workload,table,opcode,instruction,executions,tstates\n";
+    for (const Run& run : runs) {
+        if (!run.skipped.empty()) continue;
+        for (std::size_t t = 0; t < z80::kOpcodeTables; ++t) {
+            const auto table = static_cast<OpcodeTable>(t);
+            for (std::size_t op = 0; op < 256; ++op) {
+                if (!run.mix.count[t][op]) continue;
+                char hex[4];
+                std::snprintf(hex, sizeof hex, "%02X", static_cast<unsigned>(op));
+                out << run.name << ',' << z80::OpcodeTableName(table) << ',' << hex << ",\""
+                    << opcode_name(table, static_cast<uint8_t>(op)) << "\"," << run.mix.count[t][op] << ','
+                    << run.mix.tstates[t][op] << '\n';
+            }
+        }
+    }
+    return static_cast<bool>(out);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const Options opt = parse_args(argc, argv);
+    const bool named = !opt.workloads.empty();
+    const std::vector<std::string> workloads =
+        named ? opt.workloads : std::vector<std::string>{"gcd", "zexdoc", "zexall", "spectrum"};
+
+    std::cout << "Instruction mix\n===============\n";
+    std::vector<Run> runs;
+    int rc = 0;
+    for (const std::string& w : workloads) {
+        Run run = w == "gcd" ? run_gcd(opt) : w == "spectrum" ? run_spectrum(opt) : run_zex(opt, w);
+        if (!run.skipped.empty()) {
+            std::printf("\n== %s: skipped, %s ==\n", run.name.c_str(), run.skipped.c_str());
+            if (named) rc = 1;
+        } else {
+            print_report(run, opt);
+        }
+        runs.push_back(std::move(run));
+    }
+
+    if (!opt.csv.empty()) {
+        if (!write_csv(opt.csv, runs)) {
+            std::cerr << opt.csv << ": cannot write\n";
+            return 1;
+        }
+        std::cout << "\nCSV: " << opt.csv << "\n";
+    }
+    return rc;
+}
@@ -0,0 +1,187 @@
+//
+// Z80 Digital Twin - minimal streaming JSON scanner
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// A forward-only cursor over JSON text, for reading large machine-generated
+// files (the single-step test vectors) without building a DOM: the caller
+// walks the structure it expects and skips the rest. Nothing is allocated;
+// strings come back as views into the text, escapes left as written (keys and
+// test names never use them).
+//
+// Errors are sticky: the first one is kept with its offset, every later call
+// fails quietly, and loops over arrays and objects end — so a caller checks
+// ok() once, after walking.
+//
+//     JsonScanner s(text);
+//     s.expect('[');
+//     while (s.element(']')) { ... one value ... }
+//
+
+#ifndef Z80_TOOLS_JSON_SCANNER_H
+#define Z80_TOOLS_JSON_SCANNER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace z80::single_step {
+
+class JsonScanner {
+public:
+    explicit JsonScanner(std::string_view text) noexcept : text_(text) {}
+
+    [[nodiscard]] bool ok() const noexcept { return error_.empty(); }
+    [[nodiscard]] const std::string& error() const noexcept { return error_; }
+    [[nodiscard]] std::size_t offset() const noexcept { return pos_; }
+
+    /// @brief Only whitespace remains.
+    [[nodiscard]] bool at_end() noexcept {
+        skip_ws();
+        return pos_ >= text_.size();
+    }
+
+    /// @brief The next non-blank character, without consuming it (0 at the end).
+    [[nodiscard]] char peek() noexcept {
+        skip_ws();
+        return pos_ < text_.size() ? text_[pos_] : '\0';
+    }
+
+    void expect(char c) {
+        if (!ok()) return;
+        if (peek() != c) return fail(std::string("expected '") + c + "'");
+        ++pos_;
+    }
+
+    /// @brief Step to the next element of an array or member of an object:
+    ///        the first comes straight after the bracket, each later one after
+    ///        a ','. A missing, leading or trailing comma is an error.
+    /// @return false (having consumed @p close) when there is none, or on error.
+    bool element(char close) {
+        if (!ok()) return false;
+        const bool first = after_open();
+        const char c = peek();
+        if (c == close) {
+            ++pos_;
+            return false;
+        }
+        if (pos_ >= text_.size()) {
+            fail(std::string("unterminated, expected '") + close + "'");
+            return false;
+        }
+        if (first && c == ',') {
+            fail("leading comma");
+            return false;
+        }
+        if (!first) {
+            if (c != ',') {
+                fail(std::string("expected ',' or '") + close + "'");
+                return false;
+            }
+            ++pos_;
+            if (peek() == close) {
+                fail("trailing comma");
+                return false;
+            }
+            if (pos_ >= text_.size()) {
+                fail(std::string("unterminated, expected '") + close + "'");
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /// @brief An object key and its ':'.
+    std::string_view key() {
+        const std::string_view k = string();
+        expect(':');
+        return k;
+    }
+
+    std::string_view string() {
+        if (!ok()) return {};
+        if (peek() != '"') {
+            fail("expected a string");
+            return {};
+        }
+        const std::size_t start = ++pos_;
+        while (pos_ < text_.size() && text_[pos_] != '"') pos_ += text_[pos_] == '\\' ? 2 : 1;
+        if (pos_ >= text_.size()) {
+            fail("unterminated string");
+            return {};
+        }
+        return text_.substr(start, pos_++ - start);
+    }
+
+    /// @brief A non-negative integer (all the vectors hold).
+    uint64_t number() {
+        if (!ok()) return 0;
+        skip_ws();
+        const std::size_t start = pos_;
+        uint64_t v = 0;
+        while (pos_ < text_.size() && text_[pos_] >= '0' && text_[pos_] <= '9')
+            v = v * 10 + static_cast<uint64_t>(text_[pos_++] - '0');
+        if (pos_ == start) fail("expected an unsigned integer");
+        return v;
+    }
+
+    /// @brief Skip one value of any kind, nested ones included.
+    void skip_value() {
+        if (!ok()) return;
+        switch (peek()) {
+        case '"': string(); return;
+        case '[':
+            ++pos_;
+            while (element(']')) skip_value();
+            return;
+        case '{':
+            ++pos_;
+            while (element('}')) {
+                key();
+                skip_value();
+            }
+            return;
+        default: {
+            const std::size_t start = pos_;
+            while (pos_ < text_.size() && literal_char(text_[pos_])) ++pos_;
+            if (pos_ == start) fail("expected a value");
+            return;
+        }
+        }
+    }
+
+private:
+    static bool blank(char c) noexcept { return c == ' ' || c == '\n' || c == '\r' || c == '\t'; }
+
+    void skip_ws() noexcept {
+        while (pos_ < text_.size() && blank(text_[pos_])) ++pos_;
+    }
+
+    /// Nothing but blanks since an opening bracket: element() is at the first.
+    /// (Anything else before the cursor is the end of a value: a bracket that
+    /// closes, a quote, or a literal's last character.)
+    [[nodiscard]] bool after_open() const noexcept {
+        std::size_t p = pos_;
+        while (p > 0 && blank(text_[p - 1])) --p;
+        return p > 0 && (text_[p - 1] == '[' || text_[p - 1] == '{');
+    }
+
+    /// Characters of numbers, true, false and null.
+    static bool literal_char(char c) noexcept {
+        return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || c == '-' || c == '+' || c == '.' ||
+               c == 'E';
+    }
+
+    void fail(std::string why) {
+        if (ok()) error_ = std::move(why) + " at offset " + std::to_string(pos_);
+    }
+
+    std::string_view text_;
+    std::size_t pos_ = 0;
+    std::string error_;
+};
+
+} // namespace z80::single_step
+
+#endif // Z80_TOOLS_JSON_SCANNER_H
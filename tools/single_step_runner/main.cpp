@@ -0,0 +1,265 @@
+//
+// Z80 Digital Twin - per-instruction conformance runner
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// Runs SingleStepTests-style vectors (single_step.h): a directory of JSON
+// files, one per opcode, each holding vectors that give a machine state, one
+// instruction to execute, and the state it must end in. The files are
+// memory-mapped and scanned in place, with no DOM, and fanned out over worker
+// threads; each worker keeps one CPU for every vector it runs.
+//
+// Failures are reported by opcode (file), with how many of its vectors failed
+// and the first few differences. single_step.json in the artifact directory
+// holds the same per opcode, plus totals and vectors/s. A missing vector
+// directory is SKIP, like the suite runner's missing assets.
+//
+// `--ignore wz,r` leaves registers out of the comparison; the CPU keeps WZ
+// only as instructions need it, so vectors that check the full MEMPTR
+// behaviour fail on it.
+//
+
+#include "single_step.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+
+enum class Result {
+    kPass = 0,
+    kFail = 1,
+    kHarnessError = 2,
+    kSkip = 77,
+};
+
+const char* result_label(Result r) {
+    return r == Result::kPass ? "PASS" : r == Result::kFail ? "FAIL" : "HARNESS_ERROR";
+}
+
+struct Options {
+    std::string tests_dir;   ///< Empty: <assets>/cpu/singlestep
+    std::string assets_root;
+    std::string artifact_root = "build/compat-artifacts/cpu";
+    std::string filter;      ///< Only files whose name starts with this
+    std::vector<z80::single_step::Reg> ignored;
+    unsigned jobs = 0;       ///< 0: one per hardware thread
+    std::size_t examples = 3;
+};
+
+void usage(const char* prog) {
+    std::cout
+        << "Per-instruction (SingleStepTests) conformance runner\n\n"
+        << "Usage:\n"
+        << "  " << prog << " [--tests DIR] [--assets DIR] [--artifacts DIR]\n"
+        << "  " << prog << " --filter \"dd cb\" [--jobs N] [--examples N] [--ignore wz,r]\n\n"
+        << "  --tests DIR     directory of per-opcode .json files (default: <assets>/cpu/singlestep)\n"
+        << "  --filter TEXT   only files whose name starts with TEXT\n"
+        << "  --jobs N        worker threads (default: all cores)\n"
+        << "  --examples N    failures shown per opcode (default: 3)\n"
+        << "  --ignore REGS   registers not compared, by their vector names (p and q never are)\n\n"
+        << "Environment:\n"
+        << "  Z80_COMPAT_ASSETS   root for external assets, e.g. cpu/singlestep/00.json\n\n"
+        << "Exit codes:\n"
+        << "  0 pass, 1 vectors failed, 2 harness error, 77 skipped\n";
+}
+
+Options parse_args(int argc, char** argv) {
+    Options opt;
+    if (const char* env = std::getenv("Z80_COMPAT_ASSETS")) opt.assets_root = env;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string a = argv[i];
+        if (a == "-h" || a == "--help") {
+            usage(argv[0]);
+            std::exit(static_cast<int>(Result::kPass));
+        } else if (a == "--tests" && i + 1 < argc) {
+            opt.tests_dir = argv[++i];
+        } else if (a == "--assets" && i + 1 < argc) {
+            opt.assets_root = argv[++i];
+        } else if (a == "--artifacts" && i + 1 < argc) {
+            opt.artifact_root = argv[++i];
+        } else if (a == "--filter" && i + 1 < argc) {
+            opt.filter = argv[++i];
+        } else if (a == "--jobs" && i + 1 < argc) {
+            opt.jobs = static_cast<unsigned>(std::stoul(argv[++i]));
+        } else if (a == "--examples" && i + 1 < argc) {
+            opt.examples = std::stoul(argv[++i]);
+        } else if (a == "--ignore" && i + 1 < argc) {
+            std::istringstream names(argv[++i]);
+            for (std::string name; std::getline(names, name, ',');) {
+                const z80::single_step::Reg reg = z80::single_step::find_reg(name);
+                if (reg == z80::single_step::kRegCount) {
+                    std::cerr << "Unknown register for --ignore: " << name << "\n";
+                    std::exit(static_cast<int>(Result::kHarnessError));
+                }
+                opt.ignored.push_back(reg);
+            }
+        } else {
+            std::cerr << "Unknown or incomplete argument: " << a << "\n";
+            std::exit(static_cast<int>(Result::kHarnessError));
+        }
+    }
+    return opt;
+}
+
+std::string json_string(std::string_view s) {
+    std::string out = "\"";
+    for (const char ch : s) {
+        switch (ch) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(ch) < 0x20) {
+                char buf[8];
+                std::snprintf(buf, sizeof buf, "\\u%04x", static_cast<unsigned>(ch));
+                out += buf;
+            } else {
+                out += ch;
+            }
+        }
+    }
+    return out + '"';
+}
+
+/// The vector files to run, sorted so reports come out in opcode order.
+std::vector<std::filesystem::path> vector_files(const std::filesystem::path& dir, const std::string& filter) {
+    std::vector<std::filesystem::path> files;
+    for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+        if (!entry.is_regular_file() || entry.path().extension() != ".json") continue;
+        if (!entry.path().filename().string().starts_with(filter)) continue;
+        files.push_back(entry.path());
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+/// Run @p files on @p jobs threads, each taking the next file from a shared
+/// index. The calling thread prints progress until they finish.
+std::vector<z80::single_step::GroupResult> run_files(const std::vector<std::filesystem::path>& files,
+                                                     unsigned jobs, const Options& opt) {
+    std::vector<z80::single_step::GroupResult> results(files.size());
+    std::atomic<std::size_t> next{0};
+    std::atomic<std::size_t> done{0};
+    std::atomic<std::size_t> vectors{0};
+
+    std::vector<std::thread> workers;
+    for (unsigned w = 0; w < jobs; ++w) {
+        workers.emplace_back([&] {
+            z80::single_step::VectorRunner runner;
+            for (const z80::single_step::Reg reg : opt.ignored) runner.ignore(reg);
+            for (std::size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < files.size();) {
+                results[i] = z80::single_step::run_file(files[i], runner, opt.examples);
+                vectors.fetch_add(results[i].vectors, std::memory_order_relaxed);
+                done.fetch_add(1, std::memory_order_release);
+            }
+        });
+    }
+    while (done.load(std::memory_order_acquire) < files.size()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        std::cout << "\r  " << done.load(std::memory_order_acquire) << "/" << files.size() << " files, "
+                  << vectors.load(std::memory_order_relaxed) << " vectors" << std::flush;
+    }
+    for (std::thread& t : workers) t.join();
+    std::cout << "\r" << std::string(60, ' ') << "\r";
+    return results;
+}
+
+std::string report_json(const std::vector<z80::single_step::GroupResult>& groups, std::size_t vectors,
+                        std::size_t failed, unsigned jobs, double wall_seconds, Result result) {
+    std::ostringstream os;
+    os << std::setprecision(17) << "{\"result\": " << json_string(result_label(result))
+       << ", \"jobs\": " << jobs << ", \"files\": " << groups.size() << ", \"vectors\": " << vectors
+       << ", \"failed\": " << failed << ",\n \"wall_seconds\": " << wall_seconds
+       << ", \"vectors_per_second\": " << (wall_seconds > 0 ? vectors / wall_seconds : 0) << ",\n \"opcodes\": [";
+    bool first = true;
+    for (const auto& g : groups) {
+        if (g.failed == 0 && g.error.empty()) continue;
+        os << (first ? "\n  " : ",\n  ") << "{\"opcode\": " << json_string(g.name) << ", \"vectors\": " << g.vectors
+           << ", \"failed\": " << g.failed << ", \"error\": " << json_string(g.error) << ", \"examples\": [";
+        for (std::size_t i = 0; i < g.examples.size(); ++i) os << (i ? ", " : "") << json_string(g.examples[i]);
+        os << "]}";
+        first = false;
+    }
+    os << "]}\n";
+    return os.str();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const Options opt = parse_args(argc, argv);
+
+    std::filesystem::path dir = opt.tests_dir;
+    if (dir.empty()) {
+        if (opt.assets_root.empty()) {
+            std::cout << "SKIP: Z80_COMPAT_ASSETS is not set and neither --assets nor --tests was provided\n";
+            return static_cast<int>(Result::kSkip);
+        }
+        dir = std::filesystem::path(opt.assets_root) / "cpu" / "singlestep";
+    }
+    if (!std::filesystem::is_directory(dir)) {
+        std::cout << "SKIP: vector directory not found: " << dir.string() << "\n";
+        return static_cast<int>(Result::kSkip);
+    }
+    const std::vector<std::filesystem::path> files = vector_files(dir, opt.filter);
+    if (files.empty()) {
+        std::cout << "SKIP: no .json vector files in " << dir.string()
+                  << (opt.filter.empty() ? "" : " matching '" + opt.filter + "'") << "\n";
+        return static_cast<int>(Result::kSkip);
+    }
+
+    const unsigned jobs = static_cast<unsigned>(std::min<std::size_t>(
+        opt.jobs != 0 ? opt.jobs : std::max(1u, std::thread::hardware_concurrency()), files.size()));
+    std::cout << files.size() << " opcode files in " << dir.string() << ", " << jobs << " worker(s)\n";
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto groups = run_files(files, jobs, opt);
+    const double wall_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::size_t vectors = 0;
+    std::size_t failed = 0;
+    std::size_t failed_opcodes = 0;
+    bool harness_error = false;
+    for (const auto& g : groups) {
+        vectors += g.vectors;
+        failed += g.failed;
+        if (!g.error.empty()) {
+            harness_error = true;
+            std::cout << "ERROR: " << g.name << " - " << g.error << "\n";
+        }
+        if (g.failed == 0) continue;
+        ++failed_opcodes;
+        std::cout << "FAIL: " << g.name << " - " << g.failed << " of " << g.vectors << " vectors\n";
+        for (const std::string& e : g.examples) std::cout << "    " << e << "\n";
+    }
+
+    const Result result = harness_error ? Result::kHarnessError : failed != 0 ? Result::kFail : Result::kPass;
+    const std::filesystem::path artifacts(opt.artifact_root);
+    std::filesystem::create_directories(artifacts);
+    const std::filesystem::path json_path = artifacts / "single_step.json";
+    std::ofstream(json_path, std::ios::binary)
+        << report_json(groups, vectors, failed, jobs, wall_seconds, result);
+
+    std::cout << result_label(result) << ": "
+              << vectors - failed << "/" << vectors << " vectors";
+    if (failed_opcodes != 0) std::cout << " (" << failed_opcodes << " opcode(s) failing)";
+    std::cout << " in " << std::fixed << std::setprecision(2) << wall_seconds << " s (" << std::setprecision(0)
+              << (wall_seconds > 0 ? vectors / wall_seconds : 0) << " vectors/s)\n"
+              << std::defaultfloat << "  summary: " << json_path << "\n";
+    return static_cast<int>(result);
+}
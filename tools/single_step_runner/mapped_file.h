@@ -0,0 +1,87 @@
+//
+// Z80 Digital Twin - read-only memory-mapped files
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// MappedFile maps a whole file read-only, so a scanner walks it in place
+// with no copy and the kernel reads ahead (the mapping is advised
+// sequential). Where mmap is not available the file is read into memory
+// instead; text() is the same either way.
+//
+
+#ifndef Z80_TOOLS_MAPPED_FILE_H
+#define Z80_TOOLS_MAPPED_FILE_H
+
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace z80::single_step {
+
+class MappedFile {
+public:
+    explicit MappedFile(const std::filesystem::path& path) { open(path); }
+    ~MappedFile() { close(); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /// @brief The file could be opened (an empty file is ok, with empty text).
+    [[nodiscard]] bool ok() const noexcept { return ok_; }
+    [[nodiscard]] std::string_view text() const noexcept {
+        return map_ ? std::string_view(static_cast<const char*>(map_), size_) : std::string_view(copy_);
+    }
+
+private:
+    void open(const std::filesystem::path& path) {
+#if defined(__unix__) || defined(__APPLE__)
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat st{};
+        if (::fstat(fd, &st) == 0) {
+            size_ = static_cast<std::size_t>(st.st_size);
+            ok_ = true;
+            if (size_ != 0) {
+                void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (p != MAP_FAILED) {
+                    ::madvise(p, size_, MADV_SEQUENTIAL);
+                    map_ = p;
+                } else {
+                    ok_ = false;
+                }
+            }
+        }
+        ::close(fd);
+        if (ok_) return;
+#endif
+        std::ifstream f(path, std::ios::binary);
+        if (!f) return;
+        copy_.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+        ok_ = true;
+    }
+
+    void close() noexcept {
+#if defined(__unix__) || defined(__APPLE__)
+        if (map_) ::munmap(map_, size_);
+#endif
+        map_ = nullptr;
+    }
+
+    void* map_ = nullptr;
+    std::size_t size_ = 0;
+    std::string copy_;
+    bool ok_ = false;
+};
+
+} // namespace z80::single_step
+
+#endif // Z80_TOOLS_MAPPED_FILE_H
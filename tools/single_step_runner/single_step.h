@@ -0,0 +1,404 @@
+//
+// Z80 Digital Twin - per-instruction state-transition vectors
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// The SingleStepTests format: one JSON file per opcode (named for it, e.g.
+// "dd cb __ 46.json"), each a top-level array of vectors
+//
+//   {"name": "...",
+//    "initial": {"pc": 12345, "sp": ..., "a": ..., ..., "ram": [[addr, value], ...]},
+//    "final":   {... the same keys ...},
+//    "cycles":  [[addr, value, "r-m-"], ...],    one entry per T-state
+//    "ports":   [[port, value, "r" | "w"], ...]}
+//
+// A vector is run by loading the initial state into a CPU, executing one
+// whole instruction, and comparing every register, every listed RAM byte,
+// the T-states taken and the I/O performed with the final state. Writes the
+// vector does not list are caught too: a write observer marks every address
+// the instruction stores to, whatever the value (a stray 00h included), and
+// each marked address must be one of the listed ones. Not compared: P and Q (the CPU does not model them) and the
+// per-T-state bus activity (only the count). A runner can be told to ignore
+// more registers — WZ, say, which the CPU keeps only where an instruction
+// needs it rather than as the full MEMPTR.
+//
+// Parsing is streamed (json_scanner.h): next_vector() reads one vector into
+// reused buffers. A VectorRunner owns one CPU and reuses it for every
+// vector: between vectors it zeroes just the pages the last one touched
+// (loaded or written), found through ObservableMemory's dirty-page bitmap,
+// and clears the written-address bits on those pages.
+//
+
+#ifndef Z80_TOOLS_SINGLE_STEP_H
+#define Z80_TOOLS_SINGLE_STEP_H
+
+#include "io/callback_io.h"
+#include "io/observable_io.h"
+#include "json_scanner.h"
+#include "mapped_file.h"
+#include "memory/observable_memory.h"
+#include "z80_cpu.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace z80::single_step {
+
+enum Reg : uint8_t {
+    kPc, kSp, kA, kB, kC, kD, kE, kF, kH, kL, kI, kR, kEi, kWz, kIx, kIy,
+    kAf2, kBc2, kDe2, kHl2, kIm, kP, kQ, kIff1, kIff2, kRegCount
+};
+
+inline constexpr std::array<std::string_view, kRegCount> kRegNames = {
+    "pc", "sp", "a", "b", "c", "d", "e", "f", "h", "l", "i", "r", "ei", "wz", "ix", "iy",
+    "af_", "bc_", "de_", "hl_", "im", "p", "q", "iff1", "iff2"};
+
+/// @brief Registers never compared: the CPU does not model P and Q.
+inline constexpr uint32_t kUnmodelled = (1u << kP) | (1u << kQ);
+
+/// @brief The register a vector calls @p name, or kRegCount if none.
+[[nodiscard]] constexpr Reg find_reg(std::string_view name) noexcept {
+    for (std::size_t i = 0; i < kRegCount; ++i)
+        if (kRegNames[i] == name) return static_cast<Reg>(i);
+    return kRegCount;
+}
+
+struct RamByte {
+    uint16_t address = 0;
+    uint8_t value = 0;
+};
+
+struct PortEvent {
+    uint16_t port = 0;
+    uint8_t value = 0;
+    bool write = false;
+};
+
+struct State {
+    std::array<uint16_t, kRegCount> regs{};
+    std::vector<RamByte> ram;
+};
+
+struct Vector {
+    std::string_view name;   ///< Into the file text
+    State initial;
+    State expected;          ///< "final"
+    uint32_t cycles = 0;
+    std::vector<PortEvent> ports;
+};
+
+namespace detail {
+
+inline void read_state(JsonScanner& s, State& state) {
+    state.regs.fill(0);
+    state.ram.clear();
+    s.expect('{');
+    while (s.element('}')) {
+        const std::string_view key = s.key();
+        if (key == "ram") {
+            s.expect('[');
+            while (s.element(']')) {
+                s.expect('[');
+                RamByte b;
+                b.address = static_cast<uint16_t>(s.number());
+                s.element(']');
+                b.value = static_cast<uint8_t>(s.number());
+                while (s.element(']')) s.skip_value();
+                state.ram.push_back(b);
+            }
+            continue;
+        }
+        const Reg reg = find_reg(key);
+        if (reg == kRegCount) {
+            s.skip_value();
+            continue;
+        }
+        state.regs[reg] = static_cast<uint16_t>(s.number());
+    }
+}
+
+inline void read_ports(JsonScanner& s, std::vector<PortEvent>& ports) {
+    ports.clear();
+    s.expect('[');
+    while (s.element(']')) {
+        s.expect('[');
+        PortEvent e;
+        e.port = static_cast<uint16_t>(s.number());
+        s.element(']');
+        e.value = static_cast<uint8_t>(s.number());
+        s.element(']');
+        e.write = s.string() == "w";
+        while (s.element(']')) s.skip_value();
+        ports.push_back(e);
+    }
+}
+
+inline std::string hex(uint32_t v, int digits) {
+    char buf[12];
+    std::snprintf(buf, sizeof buf, "%0*Xh", digits, v);
+    return buf;
+}
+
+} // namespace detail
+
+/// @brief Read the next vector of a file's top-level array into @p v. The
+///        caller consumes the opening '[' first.
+/// @return false at the end of the array, or on a scan error (see s.ok()).
+inline bool next_vector(JsonScanner& s, Vector& v) {
+    if (!s.element(']')) return false;
+    v.name = {};
+    v.cycles = 0;
+    v.ports.clear();
+    s.expect('{');
+    while (s.element('}')) {
+        const std::string_view key = s.key();
+        if (key == "name") {
+            v.name = s.string();
+        } else if (key == "initial") {
+            detail::read_state(s, v.initial);
+        } else if (key == "final") {
+            detail::read_state(s, v.expected);
+        } else if (key == "cycles") {
+            s.expect('[');
+            while (s.element(']')) {
+                s.skip_value();
+                ++v.cycles;
+            }
+        } else if (key == "ports") {
+            detail::read_ports(s, v.ports);
+        } else {
+            s.skip_value();
+        }
+    }
+    return s.ok();
+}
+
+/// @brief One CPU, reused for every vector it runs. Not thread-safe: give
+///        each thread its own.
+class VectorRunner {
+public:
+    using Cpu = CPUImpl<ObservableMemory, ObservableIo<CallbackIo>>;
+
+    VectorRunner() : cpu_(std::make_unique<Cpu>()) {
+        cpu_->Reset();
+        cpu_->GetMemory().SetDirtyPages(dirty_.data());
+        cpu_->GetMemory().AddWriteObserver(
+            [this](uint16_t address, uint8_t, uint8_t) { written_[address >> 6] |= uint64_t{1} << (address & 63); });
+        cpu_->GetIo().inner().OnIn([this](uint16_t) { return next_in(); });
+    }
+    VectorRunner(const VectorRunner&) = delete;
+    VectorRunner& operator=(const VectorRunner&) = delete;
+
+    /// @brief Run @p v. Empty if the CPU ends in the final state, otherwise
+    ///        what differs ("f 54h want 50h; cycles 7 want 4").
+    std::string run(const Vector& v) {
+        load(v);
+        int bytes = 0;
+        do {
+            cpu_->Step();
+        } while (!cpu_->InstructionComplete() && ++bytes < 8);
+        std::string diff = compare(v);
+        clean();
+        return diff;
+    }
+
+    /// @brief Stop comparing @p reg.
+    void ignore(Reg reg) noexcept { ignored_ |= 1u << reg; }
+    [[nodiscard]] bool compared(Reg reg) const noexcept { return (ignored_ >> reg & 1u) == 0; }
+
+    [[nodiscard]] Cpu& cpu() noexcept { return *cpu_; }
+
+private:
+    void load(const Vector& v) {
+        Cpu& cpu = *cpu_;
+        const auto& r = v.initial.regs;
+        cpu.PC() = r[kPc];
+        cpu.SP() = r[kSp];
+        cpu.A() = static_cast<uint8_t>(r[kA]);
+        cpu.F() = static_cast<uint8_t>(r[kF]);
+        cpu.B() = static_cast<uint8_t>(r[kB]);
+        cpu.C() = static_cast<uint8_t>(r[kC]);
+        cpu.D() = static_cast<uint8_t>(r[kD]);
+        cpu.E() = static_cast<uint8_t>(r[kE]);
+        cpu.H() = static_cast<uint8_t>(r[kH]);
+        cpu.L() = static_cast<uint8_t>(r[kL]);
+        cpu.I() = static_cast<uint8_t>(r[kI]);
+        cpu.R() = static_cast<uint8_t>(r[kR]);
+        cpu.WZ() = r[kWz];
+        cpu.IX() = r[kIx];
+        cpu.IY() = r[kIy];
+        cpu.AltAF() = r[kAf2];
+        cpu.AltBC() = r[kBc2];
+        cpu.AltDE() = r[kDe2];
+        cpu.AltHL() = r[kHl2];
+        cpu.SetInterruptMode(static_cast<uint8_t>(r[kIm]));
+        cpu.IFF1() = r[kIff1] != 0;
+        cpu.IFF2() = r[kIff2] != 0;
+        cpu.SetInterruptShadow(r[kEi] != 0);
+        cpu.SetHalted(false);
+        cpu.SetCycleCount(0);
+        for (const RamByte& b : v.initial.ram) cpu.GetMemory().RawWrite(b.address, b.value);
+        cpu.GetIo().ClearTransactions();
+        ports_ = &v.ports;
+        next_port_ = 0;
+    }
+
+    [[nodiscard]] std::array<uint16_t, kRegCount> registers() {
+        Cpu& cpu = *cpu_;
+        std::array<uint16_t, kRegCount> r{};
+        r[kPc] = cpu.PC();
+        r[kSp] = cpu.SP();
+        r[kA] = cpu.A();
+        r[kF] = cpu.F();
+        r[kB] = cpu.B();
+        r[kC] = cpu.C();
+        r[kD] = cpu.D();
+        r[kE] = cpu.E();
+        r[kH] = cpu.H();
+        r[kL] = cpu.L();
+        r[kI] = cpu.I();
+        r[kR] = cpu.R();
+        r[kWz] = cpu.WZ();
+        r[kIx] = cpu.IX();
+        r[kIy] = cpu.IY();
+        r[kAf2] = cpu.AltAF();
+        r[kBc2] = cpu.AltBC();
+        r[kDe2] = cpu.AltDE();
+        r[kHl2] = cpu.AltHL();
+        r[kIm] = cpu.InterruptMode();
+        r[kIff1] = cpu.IFF1();
+        r[kIff2] = cpu.IFF2();
+        r[kEi] = cpu.InterruptShadow();
+        return r;
+    }
+
+    std::string compare(const Vector& v) {
+        std::string diff;
+        const auto note = [&diff](const std::string& what) { diff += (diff.empty() ? "" : "; ") + what; };
+
+        const auto got = registers();
+        for (std::size_t i = 0; i < kRegCount; ++i) {
+            const Reg reg = static_cast<Reg>(i);
+            if (!compared(reg) || got[i] == v.expected.regs[i]) continue;
+            const int digits = v.expected.regs[i] > 0xFF || got[i] > 0xFF ? 4 : 2;
+            note(std::string(kRegNames[i]) + " " + detail::hex(got[i], digits) + " want " +
+                 detail::hex(v.expected.regs[i], digits));
+        }
+        const ObservableMemory& mem = cpu_->GetMemory();
+        for (const RamByte& b : v.expected.ram) {
+            if (mem[b.address] != b.value)
+                note("(" + detail::hex(b.address, 4) + ") " + detail::hex(mem[b.address], 2) + " want " +
+                     detail::hex(b.value, 2));
+        }
+        for_each_dirty_page([&](std::size_t page) {
+            for (std::size_t w = page * kWrittenWordsPerPage; w < (page + 1) * kWrittenWordsPerPage; ++w)
+                for (uint64_t bits = written_[w]; bits != 0; bits &= bits - 1) {
+                    const std::size_t a = w * 64 + static_cast<std::size_t>(std::countr_zero(bits));
+                    const auto listed = [a](const RamByte& b) { return b.address == a; };
+                    if (std::none_of(v.expected.ram.begin(), v.expected.ram.end(), listed))
+                        note("stray write (" + detail::hex(static_cast<uint32_t>(a), 4) + ")");
+                }
+        });
+        if (cpu_->GetCycleCount() != v.cycles)
+            note("cycles " + std::to_string(cpu_->GetCycleCount()) + " want " + std::to_string(v.cycles));
+
+        const auto& io = cpu_->GetIo().Transactions();
+        bool ports_match = io.size() == v.ports.size();
+        for (std::size_t i = 0; ports_match && i < io.size(); ++i)
+            ports_match = io[i].port == v.ports[i].port && io[i].value == v.ports[i].value &&
+                          io[i].is_out == v.ports[i].write;
+        if (!ports_match)
+            note("ports: " + std::to_string(io.size()) + " transaction(s), want " + std::to_string(v.ports.size()));
+        return diff;
+    }
+
+    /// Zero every page the vector loaded or the instruction wrote, and its
+    /// written-address bits.
+    void clean() {
+        ObservableMemory& mem = cpu_->GetMemory();
+        for_each_dirty_page([&](std::size_t page) {
+            const std::span<uint8_t> bytes = mem.RawRegion(static_cast<uint16_t>(page * ObservableMemory::kPageSize),
+                                                           ObservableMemory::kPageSize);
+            std::fill(bytes.begin(), bytes.end(), uint8_t{0});
+            std::fill_n(written_.begin() + page * kWrittenWordsPerPage, kWrittenWordsPerPage, uint64_t{0});
+        });
+        dirty_.fill(0);
+    }
+
+    template <class F>
+    void for_each_dirty_page(F&& f) const {
+        for (std::size_t w = 0; w < dirty_.size(); ++w)
+            for (uint64_t bits = dirty_[w]; bits != 0; bits &= bits - 1)
+                f(w * 64 + static_cast<std::size_t>(std::countr_zero(bits)));
+    }
+
+    /// IN reads the vector's "r" port values in order (FFh once they run out).
+    uint8_t next_in() {
+        while (ports_ && next_port_ < ports_->size()) {
+            const PortEvent& e = (*ports_)[next_port_++];
+            if (!e.write) return e.value;
+        }
+        return CallbackIo::kFloating;
+    }
+
+    std::unique_ptr<Cpu> cpu_;
+    static constexpr std::size_t kWrittenWordsPerPage = ObservableMemory::kPageSize / 64;
+
+    std::array<uint64_t, ObservableMemory::kDirtyWords> dirty_{};
+    std::array<uint64_t, ObservableMemory::SIZE / 64> written_{};   ///< One bit per address the CPU stored to
+    const std::vector<PortEvent>* ports_ = nullptr;
+    std::size_t next_port_ = 0;
+    uint32_t ignored_ = kUnmodelled;
+};
+
+/// @brief The outcome of one file: one opcode's vectors.
+struct GroupResult {
+    std::string name;                    ///< The file's stem: the opcode
+    std::size_t vectors = 0;
+    std::size_t failed = 0;
+    std::vector<std::string> examples;   ///< "<vector name>: <diff>", the first few failures
+    std::string error;                   ///< Unreadable or malformed file
+    double seconds = 0;
+};
+
+/// @brief Run every vector in @p path on @p runner, keeping the first
+///        @p max_examples failures.
+inline GroupResult run_file(const std::filesystem::path& path, VectorRunner& runner, std::size_t max_examples) {
+    const auto start = std::chrono::steady_clock::now();
+    GroupResult result;
+    result.name = path.stem().string();
+    const MappedFile file(path);
+    if (!file.ok()) {
+        result.error = "cannot read " + path.string();
+        return result;
+    }
+    JsonScanner s(file.text());
+    s.expect('[');
+    Vector v;
+    while (next_vector(s, v)) {
+        ++result.vectors;
+        std::string diff = runner.run(v);
+        if (diff.empty()) continue;
+        ++result.failed;
+        if (result.examples.size() < max_examples) result.examples.push_back(std::string(v.name) + ": " + diff);
+    }
+    if (!s.ok()) result.error = s.error();
+    else if (!s.at_end()) result.error = "unexpected text after the vectors at offset " + std::to_string(s.offset());
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+} // namespace z80::single_step
+
+#endif // Z80_TOOLS_SINGLE_STEP_H
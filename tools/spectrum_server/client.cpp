@@ -0,0 +1,224 @@
+//
+// Z80 Digital Twin - spectrum_server test client
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// Asks a running spectrum_server for N instances, maps their segments and,
+// for --seconds, keeps reading every instance's newest frame in place, its
+// audio and its status, as a viewer or agent would. Then it checks the
+// command ring: key presses to every instance, and a pause and resume of
+// every other one, seen in their published status.
+//
+// Reports each instance's frame rate over the run, and how many frames were
+// drawn over while being read (and so read again). Exits 0 only if every
+// instance kept full speed (49 fps or better; the Spectrum runs at 50.08),
+// every frame read held palette indices, and every command took effect.
+//
+
+#include "setup_socket.h"
+#include "shared_instance.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace z80::server;
+using Clock = std::chrono::steady_clock;
+
+constexpr double kFullSpeedFps = 49.0;
+constexpr std::size_t kFrameWidth = z80::machine::spectrum::video::kFrameWidth;
+
+struct Options {
+    std::string socket = "/tmp/spectrum_server.sock";
+    std::size_t instances = 128;
+    double seconds = 5.0;
+    bool shutdown = false;
+};
+
+struct Watched {
+    SharedSegment segment;
+    uint64_t audio_position = 0;
+    uint64_t start_frame = 0;
+    uint64_t frames_seen = 0;   ///< Distinct frames read in place
+    uint64_t last_seen = 0;
+};
+
+void usage(const char* prog) {
+    std::cout << "spectrum_server test client\n\n"
+              << "Usage:\n"
+              << "  " << prog << " [--socket PATH] [--instances N] [--seconds S] [--shutdown]\n\n"
+              << "  --socket PATH   the server's setup socket (default: /tmp/spectrum_server.sock)\n"
+              << "  --instances N   instances to create and watch (default: 128)\n"
+              << "  --seconds S     how long to measure (default: 5)\n"
+              << "  --shutdown      ask the server to stop afterwards\n";
+}
+
+void sleep_for(double seconds) { std::this_thread::sleep_for(std::chrono::duration<double>(seconds)); }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        const std::string a = argv[i];
+        if (a == "-h" || a == "--help") {
+            usage(argv[0]);
+            return 0;
+        } else if (a == "--socket" && i + 1 < argc) {
+            opt.socket = argv[++i];
+        } else if (a == "--instances" && i + 1 < argc) {
+            opt.instances = std::strtoull(argv[++i], nullptr, 10);
+        } else if (a == "--seconds" && i + 1 < argc) {
+            opt.seconds = std::strtod(argv[++i], nullptr);
+        } else if (a == "--shutdown") {
+            opt.shutdown = true;
+        } else {
+            std::cerr << "Unknown or incomplete argument: " << a << "\n";
+            return 2;
+        }
+    }
+
+    SetupConnection server;
+    std::string why;
+    if (!server.connect(opt.socket)) {
+        std::cerr << "cannot connect to " << opt.socket << "\n";
+        return 2;
+    }
+    const auto hello = server.request("hello", &why);
+    if (!hello || hello->empty() ||
+        hello->front().find("layout=" + std::to_string(kLayoutVersion) + " ") == std::string::npos) {
+        std::cerr << "not a compatible spectrum_server" << (why.empty() ? "" : ": " + why) << "\n";
+        return 2;
+    }
+    const auto created = server.request("create " + std::to_string(opt.instances), &why);
+    if (!created) {
+        std::cerr << "create: " << why << "\n";
+        return 2;
+    }
+
+    std::vector<Watched> watched;
+    for (const std::string& line : *created) {
+        std::istringstream in(line);
+        std::string word, name;
+        uint32_t id = 0;
+        in >> word >> id >> name;
+        Watched w;
+        w.segment = SharedSegment::open(name);
+        if (!w.segment.ok()) {
+            std::cerr << "cannot map " << name << "\n";
+            return 2;
+        }
+        watched.push_back(std::move(w));
+    }
+    std::cout << "client: " << watched.size() << " instances mapped\n";
+
+    // Wait for every instance's first frame.
+    const auto wait_start = Clock::now();
+    while (std::any_of(watched.begin(), watched.end(), [](const Watched& w) { return read_status(w.segment.block()).frame == 0; })) {
+        if (Clock::now() - wait_start > std::chrono::seconds(10)) {
+            std::cerr << "instances did not start\n";
+            return 1;
+        }
+        sleep_for(0.01);
+    }
+
+    // Watch: read every instance's newest frame in place, and its audio.
+    for (Watched& w : watched) w.start_frame = w.last_seen = read_status(w.segment.block()).frame;
+    uint64_t torn = 0;
+    uint64_t audio_samples = 0;
+    uint64_t audio_lost = 0;
+    uint64_t bad_pixels = 0;   ///< Frames with an index outside the palette
+    std::array<int16_t, 4096> audio{};
+    const auto start = Clock::now();
+    while (Clock::now() - start < std::chrono::duration<double>(opt.seconds)) {
+        for (Watched& w : watched) {
+            const InstanceBlock& b = w.segment.block();
+            for (;;) {
+                const auto view = latest_frame(b);
+                if (!view || view->frame == w.last_seen) break;
+                // What a consumer would look at: here, the top row's palette indices.
+                bool in_range = true;
+                for (std::size_t x = 0; x < kFrameWidth; ++x) in_range &= view->pixels()[x] < 16;
+                if (!view->valid()) {
+                    ++torn;
+                    continue;
+                }
+                bad_pixels += !in_range;
+                w.frames_seen += 1;
+                w.last_seen = view->frame;
+                break;
+            }
+            audio_samples += read_audio(b, w.audio_position, audio, &audio_lost);
+        }
+        sleep_for(0.005);
+    }
+    const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<double> fps;
+    for (const Watched& w : watched)
+        fps.push_back(static_cast<double>(read_status(w.segment.block()).frame - w.start_frame) / elapsed);
+    std::sort(fps.begin(), fps.end());
+    uint64_t total_frames = 0;
+    uint64_t frames_seen = 0;
+    for (const Watched& w : watched) {
+        total_frames += read_status(w.segment.block()).frame - w.start_frame;
+        frames_seen += w.frames_seen;
+    }
+
+    // Commands: keys to everyone, then pause every other instance.
+    bool commands_ok = true;
+    for (Watched& w : watched) {
+        commands_ok &= push_command(w.segment.block(), {Op::kKeyDown, 7, 0, 0});   // SPACE
+        commands_ok &= push_command(w.segment.block(), {Op::kKeyUp, 7, 0, 0});
+    }
+    for (std::size_t i = 0; i < watched.size(); i += 2) commands_ok &= push_command(watched[i].segment.block(), {Op::kPause});
+    sleep_for(0.2);
+    std::vector<uint64_t> paused_at;
+    for (const Watched& w : watched) paused_at.push_back(read_status(w.segment.block()).frame);
+    sleep_for(0.3);
+    std::size_t paused_ok = 0;
+    std::size_t running_ok = 0;
+    for (std::size_t i = 0; i < watched.size(); ++i) {
+        const Status s = read_status(watched[i].segment.block());
+        if (i % 2 == 0) paused_ok += s.paused && s.frame == paused_at[i];
+        else running_ok += !s.paused && s.frame > paused_at[i];
+    }
+    for (std::size_t i = 0; i < watched.size(); i += 2) commands_ok &= push_command(watched[i].segment.block(), {Op::kResume});
+    sleep_for(0.2);
+    std::size_t resumed_ok = 0;
+    for (std::size_t i = 0; i < watched.size(); i += 2) {
+        const Status s = read_status(watched[i].segment.block());
+        resumed_ok += !s.paused && s.frame > paused_at[i];
+    }
+    const std::size_t half = (watched.size() + 1) / 2;
+    commands_ok &= paused_ok == half && running_ok == watched.size() - half && resumed_ok == half;
+
+    const double min_fps = fps.empty() ? 0.0 : fps.front();
+    const bool full_speed = min_fps >= kFullSpeedFps;
+    char line[256];
+    std::snprintf(line, sizeof line, "client: %zu instances, %.1f s: %.2f fps min, %.2f median, %.2f max (%.0f frames/s in all)",
+                  watched.size(), elapsed, min_fps, fps.empty() ? 0.0 : fps[fps.size() / 2],
+                  fps.empty() ? 0.0 : fps.back(), static_cast<double>(total_frames) / elapsed);
+    std::cout << line << "\n";
+    std::cout << "client: read " << frames_seen << " frames in place, " << torn << " torn (re-read), "
+              << bad_pixels << " with bad pixels, "
+              << audio_samples << " audio samples (" << audio_lost << " lost)\n";
+    std::cout << "client: commands: " << paused_ok << "/" << half << " paused, " << resumed_ok << "/" << half
+              << " resumed, " << running_ok << "/" << watched.size() - half << " others kept running\n";
+    if (opt.shutdown) server.request("shutdown");
+
+    const bool pass = full_speed && commands_ok && bad_pixels == 0;
+    std::cout << (pass ? "PASS" : "FAIL") << (full_speed ? "" : " (below full speed)")
+              << (commands_ok ? "" : " (commands not honoured)") << (bad_pixels ? " (bad pixels)" : "") << "\n";
+    return pass ? 0 : 1;
+}
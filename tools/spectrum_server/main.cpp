@@ -0,0 +1,155 @@
+//
+// Z80 Digital Twin - headless Spectrum server
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// Hosts many 48K Spectrums for other processes — viewers, test drivers,
+// agents. Each instance is a SharedSegment (shared_instance.h): frame
+// buffers read in place, an audio ring, a seqlocked status with the state
+// hash, and a command ring for input. The UNIX socket (setup_socket.h) is
+// only for creating and listing instances. See docs/users/spectrum-server.md.
+//
+// The instances run on a worker pool in 50.08 Hz ticks (server.h); with
+// --unthrottled the ticks run back to back instead. --shared-rom maps the ROM
+// file into every instance instead of copying it (memory/shared_rom.h).
+//
+
+#include "server.h"
+#include "setup_socket.h"
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+namespace {
+
+std::atomic<bool> g_interrupted{false};
+
+void on_signal(int) { g_interrupted.store(true); }
+
+void usage(const char* prog) {
+    std::cout
+        << "Headless ZX Spectrum server (shared-memory frames, audio and input)\n\n"
+        << "Usage:\n"
+        << "  " << prog << " --rom spec48.rom [--socket PATH] [--instances N] [--threads N]\n"
+        << "  " << prog << " --rom spec48.rom --unthrottled [--shared-rom | --no-rom-protect] [--name PREFIX]\n\n"
+        << "  --rom FILE        16 KB ROM loaded into every instance (required)\n"
+        << "  --socket PATH     setup socket (default: /tmp/spectrum_server.sock)\n"
+        << "  --instances N     instances to create at start (default: 0; clients send \"create N\")\n"
+        << "  --threads N       worker threads (default: all cores)\n"
+        << "  --unthrottled     run frames as fast as the workers can, not at 50.08 Hz\n"
+        << "  --shared-rom      map the ROM file read-only into every instance: one copy\n"
+        << "                    in RAM and cache for all of them\n"
+        << "  --no-rom-protect  let the CPU write to the ROM region\n"
+        << "  --name PREFIX     shared memory names (default: /z80spectrum-<pid>-)\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    z80::server::ServerOptions options;
+    options.name_prefix = "/z80spectrum-" + std::to_string(::getpid()) + "-";
+    std::string rom_path;
+    std::string socket_path = "/tmp/spectrum_server.sock";
+    std::size_t initial = 0;
+    bool shared_rom = false;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string a = argv[i];
+        if (a == "-h" || a == "--help") {
+            usage(argv[0]);
+            return 0;
+        } else if (a == "--rom" && i + 1 < argc) {
+            rom_path = argv[++i];
+        } else if (a == "--socket" && i + 1 < argc) {
+            socket_path = argv[++i];
+        } else if (a == "--instances" && i + 1 < argc) {
+            initial = std::strtoull(argv[++i], nullptr, 10);
+        } else if (a == "--threads" && i + 1 < argc) {
+            options.threads = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (a == "--unthrottled") {
+            options.realtime = false;
+        } else if (a == "--shared-rom") {
+            shared_rom = true;
+        } else if (a == "--no-rom-protect") {
+            options.rom_write_protect = false;
+        } else if (a == "--name" && i + 1 < argc) {
+            options.name_prefix = argv[++i];
+        } else {
+            std::cerr << "Unknown or incomplete argument: " << a << "\n";
+            return 2;
+        }
+    }
+    if (rom_path.empty()) {
+        usage(argv[0]);
+        return 2;
+    }
+    std::ifstream rom_file(rom_path, std::ios::binary);
+    options.rom.assign(std::istreambuf_iterator<char>(rom_file), std::istreambuf_iterator<char>());
+    if (!rom_file && !rom_file.eof()) {
+        std::cerr << "cannot read " << rom_path << "\n";
+        return 2;
+    }
+    if (options.rom.empty() || options.rom.size() > 0x4000) {
+        std::cerr << rom_path << ": not a ROM image (1 byte to 16 KB)\n";
+        return 2;
+    }
+    z80::SharedRom rom;
+    if (shared_rom) {
+        if (!options.rom_write_protect) {
+            std::cerr << "--shared-rom is read-only; it cannot be used with --no-rom-protect\n";
+            return 2;
+        }
+        std::string why;
+        rom = z80::SharedRom::Open(rom_path, &why);
+        if (!rom.ok()) {
+            std::cerr << why << "\n";
+            return 2;
+        }
+        options.shared_rom = &rom;
+    }
+
+    z80::server::Server server(options);
+    std::string why;
+    if (initial && server.create(initial, &why).size() != initial) {
+        std::cerr << "create: " << why << "\n";
+        return 1;
+    }
+    if (shared_rom && initial && !server.shared_rom_error().empty())
+        std::cerr << "spectrum_server: --shared-rom not used, ROM copied instead: " << server.shared_rom_error() << "\n";
+    z80::server::SetupListener listener;
+    if (!listener.open(socket_path, &why)) {
+        std::cerr << why << "\n";
+        return 1;
+    }
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+
+    server.start();
+    std::cout << "spectrum_server: listening on " << socket_path << " (" << initial << " instances, "
+              << (options.realtime ? "real time" : "unthrottled") << (shared_rom ? ", shared ROM" : "") << ")"
+              << std::endl;
+    auto report = std::chrono::steady_clock::now();
+    while (!g_interrupted.load() && !server.shutdown_requested()) {
+        listener.poll_once([&server](const std::string& line) { return server.request(line); },
+                           std::chrono::milliseconds(200));
+        if (std::chrono::steady_clock::now() - report >= std::chrono::seconds(10)) {
+            report = std::chrono::steady_clock::now();
+            const std::string stats = server.request("stats");
+            std::cout << "spectrum_server: " << stats.substr(0, stats.find('\n')) << std::endl;
+        }
+    }
+    server.stop();
+    listener.close();
+    std::cout << "spectrum_server: stopped after " << server.ticks() << " ticks (" << server.late_ticks()
+              << " late)" << std::endl;
+    return 0;
+}
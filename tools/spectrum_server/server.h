@@ -0,0 +1,328 @@
+//
+// Z80 Digital Twin - spectrum_server instance host
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// Runs N SpectrumMachines on a pool of worker threads, one frame per
+// instance per tick, and publishes each through its SharedSegment
+// (shared_instance.h). The tick is a std::barrier: workers take instances
+// off a shared counter until none are left, then meet at the barrier, whose
+// completion step adopts newly created instances and — in real time — sleeps
+// to the next 50.08 Hz deadline. So a slow instance delays nobody but the
+// tick, and the instance list only changes while every worker is waiting.
+//
+// With ServerOptions::shared_rom every instance maps the same ROM pages
+// read-only (memory/shared_rom.h) instead of holding its own copy. One that
+// cannot falls back to a copy; "stats" counts the instances that share, and
+// shared_rom_error() says why the first fallback happened.
+//
+// A frame for one instance: drain its command ring, run_frame(), resample the
+// beeper edges into the audio ring, render the palette indices straight into
+// the next frame buffer, hash the state (incrementally, StateHasher) and
+// publish the status. Nothing is copied between the machine and the segment
+// but the rendered pixels and samples themselves.
+//
+// Setup requests (setup_socket.h) come in on another thread and reach the
+// host through request(); they never touch a running instance.
+//
+
+#ifndef Z80_TOOLS_SPECTRUM_SERVER_SERVER_H
+#define Z80_TOOLS_SPECTRUM_SERVER_SERVER_H
+
+#include "shared_instance.h"
+
+#include "memory/shared_rom.h"
+#include "spectrum/beeper.h"
+#include "spectrum/spectrum_machine.h"
+#include "spectrum/state_hash.h"
+#include "spectrum/timing.h"
+
+#include <atomic>
+#include <barrier>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace z80::server {
+
+struct ServerOptions {
+    std::vector<uint8_t> rom;          ///< 16 KB image loaded into every instance
+    const SharedRom* shared_rom = nullptr;   ///< Or mapped, one copy for all (outlives the Server)
+    unsigned threads = 0;              ///< 0: one per hardware thread
+    bool realtime = true;              ///< false: run ticks back to back
+    bool rom_write_protect = true;
+    std::string name_prefix = "/z80spectrum-";   ///< Segment names: prefix + id
+    std::size_t max_instances = 4096;
+};
+
+/// @brief One machine and its segment. Lives at a fixed address (the
+///        StateHasher and the machine's callbacks point into it).
+class Instance {
+public:
+    Instance(uint32_t id, SharedSegment segment, const ServerOptions& options)
+        : id_(id), segment_(std::move(segment)), machine_(MakePageAligned<machine::spectrum::SpectrumMachine>(
+              [](machine::spectrum::SpectrumMachine& m) -> ObservableMemory& { return m.cpu().GetMemory(); })),
+          hasher_(*machine_),
+          beeper_(machine::spectrum::timing::kCpuHz, kAudioRate) {
+        // The ROM goes in before the protection, which would drop it.
+        rom_shared_ = options.shared_rom && options.shared_rom->MapInto(machine_->cpu().GetMemory(), &rom_error_);
+        if (rom_shared_) machine_->cpu().Reset();
+        else machine_->load_rom(options.rom);
+        machine_->set_rom_write_protect(options.rom_write_protect);   // a shared ROM stays read-only
+        samples_.reserve(1024);
+    }
+    Instance(const Instance&) = delete;
+    Instance& operator=(const Instance&) = delete;
+
+    /// @brief Worker threads only, one at a time per instance.
+    void run_frame() {
+        InstanceBlock& b = segment_.block();
+        drain_commands(b, [this](const Command& c) { apply(c); });
+        if (paused_) return;
+
+        machine_->run_frame();
+        samples_.clear();
+        for (const auto& e : machine_->ula().beeper_edges()) beeper_.edge(e.cycle, e.level, samples_);
+        beeper_.advance(machine_->cpu().GetCycleCount(), samples_);
+        write_audio(b, samples_);
+
+        ++status_.frame;
+        status_.buffer = draw_frame(b, status_.frame, [this](std::span<uint8_t> pixels) {
+            machine_->render_indices(pixels);
+        });
+        status_.tstates = machine_->cpu().GetCycleCount();
+        status_.state_hash = hasher_.hash();
+        status_.border = machine_->ula().border();
+        publish_status(b, status_);
+    }
+
+    [[nodiscard]] uint32_t id() const noexcept { return id_; }
+    [[nodiscard]] const std::string& name() const noexcept { return segment_.name(); }
+    [[nodiscard]] const InstanceBlock& block() const noexcept { return segment_.block(); }
+    /// @brief Whether the ROM is ServerOptions::shared_rom's mapping.
+    [[nodiscard]] bool rom_shared() const noexcept { return rom_shared_; }
+    /// @brief Why a requested shared ROM was not mapped (copied instead).
+    [[nodiscard]] const std::string& rom_error() const noexcept { return rom_error_; }
+
+private:
+    void apply(const Command& c) {
+        switch (c.op) {
+        case Op::kKeyDown:
+            if (c.a < 8 && c.b < 5) machine_->ula().key_down(c.a, c.b);
+            break;
+        case Op::kKeyUp:
+            if (c.a < 8 && c.b < 5) machine_->ula().key_up(c.a, c.b);
+            break;
+        case Op::kReleaseKeys: machine_->ula().release_all_keys(); break;
+        case Op::kReset: machine_->reset(); break;
+        case Op::kPause:
+        case Op::kResume:
+            paused_ = c.op == Op::kPause;
+            status_.paused = paused_;
+            publish_status(segment_.block(), status_);
+            break;
+        }
+    }
+
+    uint32_t id_;
+    SharedSegment segment_;
+    /// Placed so its memory image starts on a page, for a shared ROM.
+    std::unique_ptr<machine::spectrum::SpectrumMachine, PageAlignedDelete<machine::spectrum::SpectrumMachine>> machine_;
+    machine::spectrum::StateHasher hasher_;
+    machine::spectrum::BeeperResampler beeper_;
+    std::vector<int16_t> samples_;
+    Status status_;
+    bool rom_shared_ = false;
+    std::string rom_error_;
+    bool paused_ = false;
+};
+
+class Server {
+public:
+    explicit Server(ServerOptions options) : options_(std::move(options)) {}
+    ~Server() { stop(); }
+    Server(const Server&) = delete;
+    Server& operator=(const Server&) = delete;
+
+    /// @brief Start the workers. Instances created before or after join at
+    ///        the next tick.
+    void start() {
+        if (!workers_.empty()) return;
+        unsigned n = options_.threads ? options_.threads : std::thread::hardware_concurrency();
+        if (n == 0) n = 1;
+        running_.store(true, std::memory_order_relaxed);
+        stop_requested_.store(false, std::memory_order_relaxed);
+        deadline_ = std::chrono::steady_clock::now();
+        barrier_.emplace(static_cast<std::ptrdiff_t>(n), Tick{this});
+        for (unsigned i = 0; i < n; ++i) workers_.emplace_back([this] { work(); });
+    }
+
+    /// @brief Finish the current tick and join the workers. Segments stay
+    ///        mapped until the Server is destroyed.
+    void stop() {
+        stop_requested_.store(true, std::memory_order_relaxed);
+        for (std::thread& t : workers_) t.join();
+        workers_.clear();
+        barrier_.reset();
+    }
+
+    /// @brief Set by a "shutdown" request; the owner then calls stop().
+    [[nodiscard]] bool shutdown_requested() const noexcept { return shutdown_.load(std::memory_order_relaxed); }
+
+    /// @brief Any thread. Make @p count instances (segments ready, machines
+    ///        reset); they run from the next tick. All or none: on failure the
+    ///        ones already made are removed again, and @p error is set.
+    std::vector<Instance*> create(std::size_t count, std::string* error = nullptr) {
+        std::vector<Instance*> made;
+        std::lock_guard lock(mutex_);
+        if (all_.size() + count > options_.max_instances) {
+            if (error) *error = "instance limit (" + std::to_string(options_.max_instances) + ")";
+            return made;
+        }
+        for (std::size_t i = 0; i < count; ++i) {
+            const auto id = static_cast<uint32_t>(all_.size());
+            SharedSegment segment = SharedSegment::create(options_.name_prefix + std::to_string(id), id);
+            if (!segment.ok()) {
+                if (error) *error = "cannot create shared memory " + options_.name_prefix + std::to_string(id);
+                // Still pending (the mutex kept the tick out), and last in all_.
+                pending_.resize(pending_.size() - made.size());
+                all_.resize(all_.size() - made.size());
+                made.clear();
+                break;
+            }
+            all_.push_back(std::make_unique<Instance>(id, std::move(segment), options_));
+            if (shared_rom_error_.empty()) shared_rom_error_ = all_.back()->rom_error();
+            pending_.push_back(all_.back().get());
+            made.push_back(all_.back().get());
+        }
+        return made;
+    }
+
+    /// @brief Answer one setup request (see setup_socket.h for the protocol):
+    ///        reply lines, the last "ok" or "error <why>".
+    std::string request(const std::string& line) {
+        std::istringstream in(line);
+        std::string verb;
+        in >> verb;
+        std::ostringstream out;
+        if (verb == "hello") {
+            out << "spectrum_server layout=" << kLayoutVersion << " width=" << machine::spectrum::video::kFrameWidth
+                << " height=" << machine::spectrum::video::kFrameHeight << " audio=" << kAudioRate
+                << " frame_hz=" << machine::spectrum::timing::kFrameRateHz << "\nok\n";
+        } else if (verb == "create") {
+            long long count = 1;
+            in >> count;
+            if (!in || count < 1) return "error usage: create N\n";
+            std::string why;
+            const std::vector<Instance*> made = create(static_cast<std::size_t>(count), &why);
+            if (made.size() != static_cast<std::size_t>(count))
+                return "error " + (why.empty() ? std::string("create failed") : why) + "\n";
+            for (const Instance* i : made) out << "instance " << i->id() << ' ' << i->name() << '\n';
+            out << "ok\n";
+        } else if (verb == "list") {
+            std::lock_guard lock(mutex_);
+            for (const auto& i : all_) out << "instance " << i->id() << ' ' << i->name() << '\n';
+            out << "ok\n";
+        } else if (verb == "stats") {
+            uint64_t frames = 0;
+            std::size_t count = 0;
+            std::size_t shared = 0;
+            {
+                std::lock_guard lock(mutex_);
+                count = all_.size();
+                for (const auto& i : all_) {
+                    frames += read_status(i->block()).frame;
+                    shared += i->rom_shared();
+                }
+            }
+            out << "instances=" << count << " ticks=" << ticks_.load(std::memory_order_relaxed)
+                << " late=" << late_.load(std::memory_order_relaxed) << " frames=" << frames
+                << " shared_rom=" << shared << "\nok\n";
+        } else if (verb == "shutdown") {
+            shutdown_.store(true, std::memory_order_relaxed);
+            out << "ok\n";
+        } else {
+            return "error unknown request: " + verb + "\n";
+        }
+        return out.str();
+    }
+
+    [[nodiscard]] uint64_t ticks() const noexcept { return ticks_.load(std::memory_order_relaxed); }
+    /// @brief Why the first instance that asked for the shared ROM got a
+    ///        copy instead; empty if none did.
+    [[nodiscard]] std::string shared_rom_error() {
+        std::lock_guard lock(mutex_);
+        return shared_rom_error_;
+    }
+    /// @brief Real-time ticks that started more than 5 frames behind.
+    [[nodiscard]] uint64_t late_ticks() const noexcept { return late_.load(std::memory_order_relaxed); }
+
+private:
+    struct Tick {
+        Server* server;
+        void operator()() noexcept { server->tick(); }
+    };
+
+    void work() {
+        while (running_.load(std::memory_order_relaxed)) {
+            for (std::size_t i; (i = next_.fetch_add(1, std::memory_order_relaxed)) < active_.size();)
+                active_[i]->run_frame();
+            barrier_->arrive_and_wait();
+        }
+    }
+
+    /// The barrier's completion: every worker is waiting.
+    void tick() {
+        {
+            std::lock_guard lock(mutex_);
+            active_.insert(active_.end(), pending_.begin(), pending_.end());
+            pending_.clear();
+        }
+        ticks_.fetch_add(1, std::memory_order_relaxed);
+        if (options_.realtime) {
+            using namespace std::chrono;
+            static const auto period = duration_cast<steady_clock::duration>(
+                duration<double>(1.0 / machine::spectrum::timing::kFrameRateHz));
+            deadline_ += period;
+            const auto now = steady_clock::now();
+            if (now > deadline_ + 5 * period) {
+                late_.fetch_add(1, std::memory_order_relaxed);
+                deadline_ = now;   // don't try to catch up a stall
+            } else {
+                std::this_thread::sleep_until(deadline_);
+            }
+        }
+        if (stop_requested_.load(std::memory_order_relaxed)) running_.store(false, std::memory_order_relaxed);
+        next_.store(0, std::memory_order_relaxed);
+    }
+
+    ServerOptions options_;
+
+    std::mutex mutex_;                              ///< all_ and pending_
+    std::vector<std::unique_ptr<Instance>> all_;
+    std::string shared_rom_error_;                  ///< See shared_rom_error()
+    std::vector<Instance*> pending_;                ///< Created, not yet running
+    std::vector<Instance*> active_;                 ///< Changed only in tick()
+
+    std::vector<std::thread> workers_;
+    std::optional<std::barrier<Tick>> barrier_;
+    std::atomic<std::size_t> next_{0};
+    std::atomic<bool> running_{false};
+    std::atomic<bool> stop_requested_{false};
+    std::atomic<bool> shutdown_{false};
+    std::chrono::steady_clock::time_point deadline_;
+    std::atomic<uint64_t> ticks_{0};
+    std::atomic<uint64_t> late_{0};
+};
+
+} // namespace z80::server
+
+#endif // Z80_TOOLS_SPECTRUM_SERVER_SERVER_H
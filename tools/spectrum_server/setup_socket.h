@@ -0,0 +1,205 @@
+//
+// Z80 Digital Twin - spectrum_server setup socket
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// The UNIX stream socket a client uses to set up instances, and nothing
+// else: frames, audio, status and input all go through shared memory. The
+// protocol is text, one request per line; the reply is zero or more lines
+// followed by "ok" or "error <why>":
+//
+//   hello          spectrum_server layout=2 width=320 height=256 audio=44100 frame_hz=50.08
+//   create N       instance <id> <shared memory name>   (N lines)
+//   list           instance <id> <shared memory name>   (every instance)
+//   stats          instances=N ticks=T late=L frames=F shared_rom=S
+//   shutdown       stop the server
+//
+// SetupListener serves any number of connections from one thread with
+// poll(); SetupConnection is the client end. A request line longer than
+// kMaxRequest gets "error request too long" and the connection is closed.
+//
+
+#ifndef Z80_TOOLS_SPECTRUM_SERVER_SETUP_SOCKET_H
+#define Z80_TOOLS_SPECTRUM_SERVER_SETUP_SOCKET_H
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace z80::server {
+
+inline constexpr std::size_t kMaxRequest = 4096;   ///< Bytes in one request line
+
+namespace setup_detail {
+
+inline bool make_address(const std::string& path, sockaddr_un& addr) {
+    std::memset(&addr, 0, sizeof addr);
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof addr.sun_path) return false;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+inline bool write_all(int fd, const std::string& text) {
+    std::size_t done = 0;
+    while (done < text.size()) {
+        const ssize_t n = ::send(fd, text.data() + done, text.size() - done, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        done += static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+} // namespace setup_detail
+
+class SetupListener {
+public:
+    using Handler = std::function<std::string(const std::string& line)>;
+
+    SetupListener() = default;
+    SetupListener(const SetupListener&) = delete;
+    SetupListener& operator=(const SetupListener&) = delete;
+    ~SetupListener() { close(); }
+
+    /// @brief Bind @p path (replacing a stale socket file) and listen.
+    bool open(const std::string& path, std::string* error = nullptr) {
+        sockaddr_un addr{};
+        if (!setup_detail::make_address(path, addr)) {
+            if (error) *error = "socket path too long";
+            return false;
+        }
+        ::unlink(path.c_str());
+        fd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd_ < 0 || ::bind(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof addr) != 0 || ::listen(fd_, 16) != 0) {
+            if (error) *error = std::string("cannot listen on ") + path + ": " + std::strerror(errno);
+            close();
+            return false;
+        }
+        path_ = path;
+        return true;
+    }
+
+    /// @brief Wait up to @p timeout for connections and requests, answering
+    ///        each complete line with @p handle.
+    void poll_once(const Handler& handle, std::chrono::milliseconds timeout) {
+        std::vector<pollfd> fds{{fd_, POLLIN, 0}};
+        for (const Client& c : clients_) fds.push_back({c.fd, POLLIN, 0});
+        if (::poll(fds.data(), fds.size(), static_cast<int>(timeout.count())) <= 0) return;
+
+        for (std::size_t i = 1; i < fds.size(); ++i) {
+            if (!(fds[i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+            Client& c = clients_[i - 1];
+            char buf[512];
+            const ssize_t n = ::recv(c.fd, buf, sizeof buf, 0);
+            if (n <= 0) {
+                ::close(c.fd);
+                c.fd = -1;
+                continue;
+            }
+            c.pending.append(buf, static_cast<std::size_t>(n));
+            std::size_t eol = 0;
+            while ((eol = c.pending.find('\n')) != std::string::npos && eol <= kMaxRequest) {
+                std::string line = c.pending.substr(0, eol);
+                c.pending.erase(0, eol + 1);
+                if (!line.empty() && line.back() == '\r') line.pop_back();
+                if (!setup_detail::write_all(c.fd, handle(line))) break;
+            }
+            if (std::min(eol, c.pending.size()) > kMaxRequest) {   // a line too long: drop the client
+                setup_detail::write_all(c.fd, "error request too long\n");
+                ::close(c.fd);
+                c.fd = -1;
+            }
+        }
+        std::erase_if(clients_, [](const Client& c) { return c.fd < 0; });
+
+        if (fds[0].revents & POLLIN) {
+            const int client = ::accept(fd_, nullptr, nullptr);
+            if (client >= 0) clients_.push_back({client, {}});
+        }
+    }
+
+    void close() {
+        for (const Client& c : clients_) ::close(c.fd);
+        clients_.clear();
+        if (fd_ >= 0) ::close(fd_);
+        fd_ = -1;
+        if (!path_.empty()) ::unlink(path_.c_str());
+        path_.clear();
+    }
+
+private:
+    struct Client {
+        int fd;
+        std::string pending;
+    };
+
+    int fd_ = -1;
+    std::string path_;
+    std::vector<Client> clients_;
+};
+
+class SetupConnection {
+public:
+    SetupConnection() = default;
+    SetupConnection(const SetupConnection&) = delete;
+    SetupConnection& operator=(const SetupConnection&) = delete;
+    ~SetupConnection() {
+        if (fd_ >= 0) ::close(fd_);
+    }
+
+    bool connect(const std::string& path) {
+        sockaddr_un addr{};
+        if (!setup_detail::make_address(path, addr)) return false;
+        fd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        return fd_ >= 0 && ::connect(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof addr) == 0;
+    }
+
+    /// @brief Send @p line and collect the reply lines before "ok"; nullopt
+    ///        on "error ..." (the reason in @p error) or a broken connection.
+    std::optional<std::vector<std::string>> request(const std::string& line, std::string* error = nullptr) {
+        if (!setup_detail::write_all(fd_, line + "\n")) return fail(error, "connection lost");
+        std::vector<std::string> lines;
+        for (;;) {
+            const std::size_t eol = pending_.find('\n');
+            if (eol == std::string::npos) {
+                char buf[4096];
+                const ssize_t n = ::recv(fd_, buf, sizeof buf, 0);
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) return fail(error, "connection lost");
+                pending_.append(buf, static_cast<std::size_t>(n));
+                continue;
+            }
+            std::string reply = pending_.substr(0, eol);
+            pending_.erase(0, eol + 1);
+            if (reply == "ok") return lines;
+            if (reply.starts_with("error")) return fail(error, reply.size() > 6 ? reply.substr(6) : reply);
+            lines.push_back(std::move(reply));
+        }
+    }
+
+private:
+    static std::nullopt_t fail(std::string* error, std::string why) {
+        if (error) *error = std::move(why);
+        return std::nullopt;
+    }
+
+    int fd_ = -1;
+    std::string pending_;
+};
+
+} // namespace z80::server
+
+#endif // Z80_TOOLS_SPECTRUM_SERVER_SETUP_SOCKET_H
@@ -0,0 +1,348 @@
+//
+// Z80 Digital Twin - spectrum_server shared-memory layout
+// Copyright (c) 2025-2026 Larry Dawson
+// Licensed under the MIT License (see LICENSE file)
+//
+// One POSIX shared-memory segment per Spectrum instance, laid out as an
+// InstanceBlock. The server is the only writer of everything but the command
+// ring; any number of processes may map a segment and read it, and one
+// (the instance's controller) pushes commands. Nothing here takes a lock:
+//
+//   status   A seqlock. The server makes status_seq odd, stores the fields
+//            (each a relaxed atomic, so a torn read is a retry, not UB) and
+//            makes it even again. A reader retries until it sees the same
+//            even sequence before and after. read_status().
+//
+//   frames   Three frame buffers of palette indices (video::kFramePixels),
+//            each with its own sequence. Frame f is drawn into buffer f % 3,
+//            so a buffer is rewritten only two frames after it was published:
+//            a reader uses the pixels in place — zero copies — and checks
+//            FrameView::valid() afterwards to know nobody drew over them.
+//
+//   audio    A ring of signed 16-bit mono samples with two monotonic counts:
+//            audio_writing, raised before samples are stored, and
+//            audio_written, after. Each reader keeps its own position; one
+//            that falls more than a ring behind skips ahead, and a copy that
+//            audio_writing shows was being overwritten is cut. read_audio().
+//
+//   commands A single-producer / single-consumer ring: the controller owns
+//            the head, the server the tail. push_command() / drain_commands().
+//            The server does not trust the head: a controller claiming more
+//            than a ring of commands gets only the newest ring's worth.
+//
+// The layout is fixed by kLayoutVersion, which the setup socket reports and
+// the header carries; a client built against another version must not map it.
+//
+
+#ifndef Z80_TOOLS_SPECTRUM_SERVER_SHARED_INSTANCE_H
+#define Z80_TOOLS_SPECTRUM_SERVER_SHARED_INSTANCE_H
+
+#include "spectrum/video.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <optional>
+#include <span>
+#include <string>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace z80::server {
+
+inline constexpr uint32_t kMagic = 0x5A385353;   // "Z8SS"
+inline constexpr uint32_t kLayoutVersion = 2;
+inline constexpr int kFrameBuffers = 3;
+inline constexpr std::size_t kPixels = machine::spectrum::video::kFramePixels;
+inline constexpr std::size_t kAudioCapacity = 16384;   ///< Samples; about 18 frames at 44.1 kHz
+inline constexpr std::size_t kCommandCapacity = 256;
+inline constexpr uint32_t kAudioRate = 44100;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+              "the shared atomics must be address-free");
+static_assert((kAudioCapacity & (kAudioCapacity - 1)) == 0 && (kCommandCapacity & (kCommandCapacity - 1)) == 0);
+
+enum class Op : uint16_t {
+    kKeyDown = 1,      ///< a = half-row (0-7), b = bit (0-4)
+    kKeyUp = 2,
+    kReleaseKeys = 3,
+    kReset = 4,        ///< The reset button (Z80 only; RAM kept)
+    kPause = 5,
+    kResume = 6,
+};
+
+struct Command {
+    Op op = Op::kReleaseKeys;
+    uint8_t a = 0;
+    uint8_t b = 0;
+    uint32_t value = 0;
+};
+
+/// @brief What read_status() returns: one consistent publication.
+struct Status {
+    uint64_t frame = 0;        ///< Frames published; 0 = none yet
+    uint64_t tstates = 0;
+    uint64_t state_hash = 0;   ///< StateHasher at the end of the frame
+    uint32_t buffer = 0;       ///< frames[buffer] holds `frame`
+    uint8_t border = 0;
+    bool paused = false;
+};
+
+struct alignas(64) InstanceBlock {
+    // Written once, before the segment's name is handed out.
+    uint32_t magic = kMagic;
+    uint32_t version = kLayoutVersion;
+    uint32_t id = 0;
+    uint32_t width = machine::spectrum::video::kFrameWidth;
+    uint32_t height = machine::spectrum::video::kFrameHeight;
+    uint32_t audio_rate = kAudioRate;
+    uint64_t bytes = sizeof(InstanceBlock);
+
+    alignas(64) std::atomic<uint64_t> status_seq{0};
+    std::atomic<uint64_t> frame{0};
+    std::atomic<uint64_t> tstates{0};
+    std::atomic<uint64_t> state_hash{0};
+    std::atomic<uint32_t> buffer{0};
+    std::atomic<uint32_t> flags{0};   ///< border | paused << 8
+
+    struct alignas(64) FrameBuffer {
+        std::atomic<uint64_t> seq{0};   ///< Odd while being drawn
+        std::atomic<uint64_t> frame{0};
+        alignas(64) uint8_t pixels[kPixels];
+    };
+    FrameBuffer frames[kFrameBuffers];
+
+    alignas(64) std::atomic<uint64_t> audio_written{0};
+    std::atomic<uint64_t> audio_writing{0};   ///< audio_written plus the samples being stored
+    int16_t audio[kAudioCapacity];
+
+    alignas(64) std::atomic<uint32_t> command_head{0};   ///< The controller's
+    alignas(64) std::atomic<uint32_t> command_tail{0};   ///< The server's
+    Command commands[kCommandCapacity];
+};
+
+// -- Server side (the one writer) ---------------------------------------------
+
+/// @brief Publish @p s; readers see all of it or retry.
+inline void publish_status(InstanceBlock& b, const Status& s) noexcept {
+    const uint64_t seq = b.status_seq.load(std::memory_order_relaxed);
+    b.status_seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    b.frame.store(s.frame, std::memory_order_relaxed);
+    b.tstates.store(s.tstates, std::memory_order_relaxed);
+    b.state_hash.store(s.state_hash, std::memory_order_relaxed);
+    b.buffer.store(s.buffer, std::memory_order_relaxed);
+    b.flags.store(s.border | (s.paused ? 0x100u : 0u), std::memory_order_relaxed);
+    b.status_seq.store(seq + 2, std::memory_order_release);
+}
+
+/// @brief Draw frame @p frame into its buffer with @p draw(std::span<uint8_t>)
+///        and return the buffer index, for publish_status().
+template <class Draw>
+uint32_t draw_frame(InstanceBlock& b, uint64_t frame, Draw&& draw) {
+    const auto index = static_cast<uint32_t>(frame % kFrameBuffers);
+    InstanceBlock::FrameBuffer& fb = b.frames[index];
+    const uint64_t seq = fb.seq.load(std::memory_order_relaxed);
+    fb.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    draw(std::span<uint8_t>(fb.pixels, kPixels));
+    fb.frame.store(frame, std::memory_order_relaxed);
+    fb.seq.store(seq + 2, std::memory_order_release);
+    return index;
+}
+
+inline void write_audio(InstanceBlock& b, std::span<const int16_t> samples) noexcept {
+    uint64_t w = b.audio_written.load(std::memory_order_relaxed);
+    // Announce the slots first, so a reader copying them knows they changed.
+    b.audio_writing.store(w + samples.size(), std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (int16_t s : samples) b.audio[w++ & (kAudioCapacity - 1)] = s;
+    b.audio_written.store(w, std::memory_order_release);
+}
+
+/// @brief Hand each pending command to @p apply(const Command&), in order.
+///        A head more than a ring ahead of the tail (a broken controller)
+///        is clamped: only the newest kCommandCapacity are applied.
+template <class Apply>
+std::size_t drain_commands(InstanceBlock& b, Apply&& apply) {
+    const uint32_t head = b.command_head.load(std::memory_order_acquire);
+    uint32_t tail = b.command_tail.load(std::memory_order_relaxed);
+    if (head - tail > kCommandCapacity) tail = head - static_cast<uint32_t>(kCommandCapacity);
+    std::size_t n = 0;
+    for (; tail != head; ++tail, ++n) apply(b.commands[tail & (kCommandCapacity - 1)]);
+    b.command_tail.store(tail, std::memory_order_release);
+    return n;
+}
+
+// -- Client side ----------------------------------------------------------------
+
+[[nodiscard]] inline Status read_status(const InstanceBlock& b) noexcept {
+    for (;;) {
+        const uint64_t before = b.status_seq.load(std::memory_order_acquire);
+        if (before & 1) continue;
+        Status s;
+        s.frame = b.frame.load(std::memory_order_relaxed);
+        s.tstates = b.tstates.load(std::memory_order_relaxed);
+        s.state_hash = b.state_hash.load(std::memory_order_relaxed);
+        s.buffer = b.buffer.load(std::memory_order_relaxed);
+        const uint32_t flags = b.flags.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (b.status_seq.load(std::memory_order_relaxed) != before) continue;
+        s.border = static_cast<uint8_t>(flags);
+        s.paused = (flags & 0x100u) != 0;
+        return s;
+    }
+}
+
+/// @brief A published frame, read in place.
+struct FrameView {
+    const InstanceBlock::FrameBuffer* buffer = nullptr;
+    uint64_t seq = 0;
+    uint64_t frame = 0;
+
+    [[nodiscard]] const uint8_t* pixels() const noexcept { return buffer->pixels; }
+    /// @brief The pixels read since latest_frame() were not drawn over.
+    [[nodiscard]] bool valid() const noexcept {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return buffer->seq.load(std::memory_order_relaxed) == seq;
+    }
+};
+
+/// @brief The newest frame, or nullopt before the first one. Use the pixels,
+///        then check valid(); if it is false, they may be torn — read again.
+[[nodiscard]] inline std::optional<FrameView> latest_frame(const InstanceBlock& b) noexcept {
+    for (;;) {
+        const Status s = read_status(b);
+        if (s.frame == 0) return std::nullopt;
+        const InstanceBlock::FrameBuffer& fb = b.frames[s.buffer % kFrameBuffers];
+        const uint64_t seq = fb.seq.load(std::memory_order_acquire);
+        if (!(seq & 1) && fb.frame.load(std::memory_order_relaxed) == s.frame) return FrameView{&fb, seq, s.frame};
+    }
+}
+
+/// @brief Copy out the samples after @p position (the reader's own count),
+///        at most out.size(), and advance it. A reader more than a ring
+///        behind loses the oldest; @p lost, if given, counts them.
+inline std::size_t read_audio(const InstanceBlock& b, uint64_t& position, std::span<int16_t> out,
+                              uint64_t* lost = nullptr) noexcept {
+    const uint64_t written = b.audio_written.load(std::memory_order_acquire);
+    if (written - position > kAudioCapacity) {
+        if (lost) *lost += written - kAudioCapacity - position;
+        position = written - kAudioCapacity;
+    }
+    const std::size_t n = static_cast<std::size_t>(std::min<uint64_t>(written - position, out.size()));
+    for (std::size_t i = 0; i < n; ++i) out[i] = b.audio[(position + i) & (kAudioCapacity - 1)];
+    // The writer may have lapped the start of what was just copied, or be
+    // storing over it now: audio_writing covers the slots it has claimed.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint64_t now = b.audio_writing.load(std::memory_order_relaxed);
+    if (now - position > kAudioCapacity) {
+        const std::size_t overwritten = static_cast<std::size_t>(std::min<uint64_t>(now - kAudioCapacity - position, n));
+        if (lost) *lost += overwritten;
+        std::copy(out.begin() + static_cast<std::ptrdiff_t>(overwritten), out.begin() + static_cast<std::ptrdiff_t>(n),
+                  out.begin());
+        position += n;
+        return n - overwritten;
+    }
+    position += n;
+    return n;
+}
+
+/// @brief Controller only. Returns false when the ring is full.
+inline bool push_command(InstanceBlock& b, const Command& c) noexcept {
+    const uint32_t head = b.command_head.load(std::memory_order_relaxed);
+    if (head - b.command_tail.load(std::memory_order_acquire) == kCommandCapacity) return false;
+    b.commands[head & (kCommandCapacity - 1)] = c;
+    b.command_head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+// -- Mapping ----------------------------------------------------------------------
+
+/// @brief An InstanceBlock mapped from a named POSIX shared-memory object.
+class SharedSegment {
+public:
+    /// @brief Server: create @p name (replacing a stale one) and construct
+    ///        the block. ok() is false on failure.
+    static SharedSegment create(const std::string& name, uint32_t id) {
+        SharedSegment s;
+        ::shm_unlink(name.c_str());
+        const int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0) return s;
+        if (::ftruncate(fd, sizeof(InstanceBlock)) == 0) s.map(fd);
+        ::close(fd);
+        if (!s.block_) {
+            ::shm_unlink(name.c_str());
+            return s;
+        }
+        s.name_ = name;
+        s.owner_ = true;
+        s.block_ = new (s.block_) InstanceBlock;
+        s.block_->id = id;
+        return s;
+    }
+
+    /// @brief Client: map an existing segment; ok() is false if it cannot be
+    ///        opened or is not a block of this layout version.
+    static SharedSegment open(const std::string& name) {
+        SharedSegment s;
+        const int fd = ::shm_open(name.c_str(), O_RDWR, 0);
+        if (fd < 0) return s;
+        struct stat st {};
+        if (::fstat(fd, &st) == 0 && static_cast<std::size_t>(st.st_size) >= sizeof(InstanceBlock)) s.map(fd);
+        ::close(fd);
+        if (s.block_ && (s.block_->magic != kMagic || s.block_->version != kLayoutVersion)) s.unmap();
+        s.name_ = name;
+        return s;
+    }
+
+    SharedSegment() = default;
+    SharedSegment(SharedSegment&& other) noexcept { *this = std::move(other); }
+    SharedSegment& operator=(SharedSegment&& other) noexcept {
+        if (this != &other) {
+            release();
+            block_ = std::exchange(other.block_, nullptr);
+            name_ = std::move(other.name_);
+            owner_ = std::exchange(other.owner_, false);
+        }
+        return *this;
+    }
+    SharedSegment(const SharedSegment&) = delete;
+    SharedSegment& operator=(const SharedSegment&) = delete;
+    ~SharedSegment() { release(); }
+
+    [[nodiscard]] bool ok() const noexcept { return block_ != nullptr; }
+    [[nodiscard]] InstanceBlock& block() noexcept { return *block_; }
+    [[nodiscard]] const InstanceBlock& block() const noexcept { return *block_; }
+    [[nodiscard]] const std::string& name() const noexcept { return name_; }
+
+private:
+    void map(int fd) {
+        void* p = ::mmap(nullptr, sizeof(InstanceBlock), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (p != MAP_FAILED) block_ = static_cast<InstanceBlock*>(p);
+    }
+    void unmap() {
+        if (block_) ::munmap(block_, sizeof(InstanceBlock));
+        block_ = nullptr;
+    }
+    /// The creator removes the name; mappings already made stay valid.
+    void release() {
+        if (owner_ && !name_.empty()) ::shm_unlink(name_.c_str());
+        unmap();
+        owner_ = false;
+    }
+
+    InstanceBlock* block_ = nullptr;
+    std::string name_;
+    bool owner_ = false;
+};
+
+} // namespace z80::server
+
+#endif // Z80_TOOLS_SPECTRUM_SERVER_SHARED_INSTANCE_H